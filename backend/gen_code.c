@@ -13,6 +13,8 @@
 #include "machine_code.h"
 #include "string.h"
 #include "virtual_machine.h"
+#include "flow_graph.h"
+#include "ssa.h"
 
 #define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
 
@@ -38,6 +40,14 @@
 #define LR_REG_ID           (14)
 #define PC_REG_ID           (15)
 #define PSR_REG_ID          (16)
+#define TABLE_JUMP_REG      (0)     //计算跳转表表项地址的寄存器，和其他四元式的临时结果一样用R0
+
+/*
+ * 提升的变量常驻的寄存器。R2、R3在每个函数开始时都会保存，R4、R5、R12只在函数用到时
+ * 保存，所以跨函数调用时都不会被破坏。
+ **/
+#define HOME_REG_CNT        (5)
+#define HOME_SAVE_REG_CNT   (3)     /*按需保存的寄存器个数，在gcHomeRegArr的末尾*/
 
 #define PC_ADDR(piArr)      ((piArr)->idx * 4)  //当前伪代码地址
 
@@ -63,6 +73,7 @@ typedef struct _Register {
     uint32_t indirFlag: 1;      /*间接寻址*/
     Type *dataType;                /*关联的内存对应的变量类型*/
     uint8_t spReg;              /*堆栈指针寄存器*/
+    uint8_t homeReg;            /*关联的变量常驻的寄存器，0表示关联内存*/
     QRAccessMbrOffset *amOffset;    /*偏移量信息，用于访问基于某地址的相对位置上的数据。*/
 } Register;
 
@@ -80,10 +91,17 @@ typedef struct {
     PInstructArr *piArr;    /*伪指令容器*/
     AddrMapTable *amTable;  /*中间代码和伪指令代码地址映射表*/
     MCInstArr *miArr;       /*机器指令容器*/
-    VMachine *vm;           /*虚拟机*/
     struct list_head setActSpList;  /*设置活动记录栈基地址链表*/
+    Bison *ctx;             /*编译上下文*/
+    const QRRecord *record; /*正在翻译的四元式记录*/
+    FlowGraph *graph;       /*当前函数的控制流图*/
+    SSAFunction *ssa;       /*当前函数的SSA形式，变量分配寄存器用*/
+    uint8_t *homeArr;       /*按SSA变量编号索引的常驻寄存器，0表示在栈上*/
+    uint8_t homeNum;        /*当前函数用到的常驻寄存器个数*/
 } GCInfo;
 
+static const uint8_t gcHomeRegArr[HOME_REG_CNT] = {2, 3, 4, 5, 12};
+
 static void *GCMAlloc(size_t size)
 {
     void *p;
@@ -91,7 +109,7 @@ static void *GCMAlloc(size_t size)
     p = CplAlloc(size);
     if (!p) {
         PrErr("no memory");
-        exit(-1);
+        CplExit(-1);
     }
     return p;
 }
@@ -184,12 +202,16 @@ const QuadRuple *GCParamListPop(struct list_head *paramList)
 
     if (list_empty(paramList)) {
         PrErr("param List empty");
-        exit(-1);
+        CplExit(-1);
     }
     pos = list_get_tail(paramList);
+    const QuadRuple *ruple;
+
     piNode = container_of(pos, ParamInsNode, node);
     list_del(&piNode->node);
-    return piNode->ruple;
+    ruple = piNode->ruple;
+    GCMFree(piNode);
+    return ruple;
 }
 
 #if 0
@@ -206,12 +228,12 @@ static void GCEmit(GCInfo *info, const char *fmt, ...)
 }
 #endif
 
-static Type *GCFunParamType(Type *type)
+static Type *GCFunParamType(Bison *ctx, Type *type)
 {
     if (type->type == TT_ARRAY) {
-        return ATreeNewPointerType(type->array.type);
+        return ATreeNewPointerType(ctx, type->array.type);
     } else if (type->type == TT_FUNCTION) {
-        return ATreeNewPointerType(type);
+        return ATreeNewPointerType(ctx, type);
     } else {
         return type;
     }
@@ -232,7 +254,7 @@ static size_t GCFunArgAddrAlignByType(size_t addr, const Type *type)
         addr = Align4Byte(addr);
     } else {
         PrErr("type->type: %d", type->type);
-        exit(-1);
+        CplExit(-1);
     }
     return addr;
 }
@@ -241,16 +263,16 @@ static size_t GCFunArgAddrAlignByType(size_t addr, const Type *type)
  * 功能：计算函数的形式参数的偏移量。
  * 返回值：
  **/
-static size_t GCGetFunArgsOffset(size_t offset, const FunArgs *funArgs)
+static size_t GCGetFunArgsOffset(Bison *ctx, size_t offset, const FunArgs *funArgs)
 {
     if (funArgs) {
         FunArg *funArg = funArgs->funArg;
         Type *funParamType;
 
-        funParamType = GCFunParamType(funArg->type);
+        funParamType = GCFunParamType(ctx, funArg->type);
         offset = ATreeAddrAlignByType(offset, funParamType);
         offset += ATreeTypeSize(funParamType);
-        offset = GCGetFunArgsOffset(offset, funArgs->next);
+        offset = GCGetFunArgsOffset(ctx, offset, funArgs->next);
     }
     return offset;
 }
@@ -270,18 +292,18 @@ static size_t GCGetFunArgsCount(const FunArgs *funArgs)
  * 功能：计算函数形式参id的偏移量
  * 返回值：
  **/
-static size_t GCGetFunArgOffset(const FunType *funType, const Token *id)
+static size_t GCGetFunArgOffset(Bison *ctx, const FunType *funType, const Token *id)
 {
     size_t offset = 0;
     FunArgs *funArgs;
 
-    funArgs = ATreeFunArgsReverse(funType->funArgs);
+    funArgs = ATreeFunArgsReverse(ctx, funType->funArgs);
     while (funArgs) {
         FunArg *funArg;
         Type *funParamType;
 
         funArg = funArgs->funArg;
-        funParamType = GCFunParamType(funArg->type);
+        funParamType = GCFunParamType(ctx, funArg->type);
         offset = ATreeAddrAlignByType(offset, funParamType);
         if (funArg->id == id) {
             return offset;
@@ -290,23 +312,23 @@ static size_t GCGetFunArgOffset(const FunType *funType, const Token *id)
         funArgs = funArgs->next;
     }
     PrErr("funArgs: %p", funArgs);
-    exit(-1);
+    CplExit(-1);
 }
 
 /*
  * 功能：计算函数返回值在活动记录栈帧上的偏移位置
  * 返回值：
  **/
-static size_t GCGetFunRetOffset(const FunType *funType)
+static size_t GCGetFunRetOffset(Bison *ctx, const FunType *funType)
 {
     size_t offset = 0;
     FunArgs *funArgs;
     Type *funRetType;
 
-    funArgs = ATreeFunArgsReverse(funType->funArgs);
-    offset = GCGetFunArgsOffset(offset, funArgs);
+    funArgs = ATreeFunArgsReverse(ctx, funType->funArgs);
+    offset = GCGetFunArgsOffset(ctx, offset, funArgs);
     if (funType->retType->typeType != ERTT_VOID) {
-        funRetType = GCFunParamType(funType->retType->type);
+        funRetType = GCFunParamType(ctx, funType->retType->type);
         offset = ATreeAddrAlignByType(offset, funRetType);
     }
     return offset;
@@ -316,15 +338,15 @@ static size_t GCGetFunRetOffset(const FunType *funType)
  * 功能：计算函数形式参数加返回值所占内存空间的大小。
  * 返回值：
  **/
-static size_t GCGetFunTypeSize(const FunType *funType)
+static size_t GCGetFunTypeSize(Bison *ctx, const FunType *funType)
 {
     size_t offset;
 
-    offset = GCGetFunRetOffset(funType);
+    offset = GCGetFunRetOffset(ctx, funType);
     if (funType->retType->typeType != ERTT_VOID) {
         Type *funRetType;
 
-        funRetType = GCFunParamType(funType->retType->type);
+        funRetType = GCFunParamType(ctx, funType->retType->type);
         //offset = ATreeAddrAlignByType(offset, funRetType);
         return offset + ATreeTypeSize(funRetType);
     } else {
@@ -336,11 +358,11 @@ static size_t GCGetFunTypeSize(const FunType *funType)
  * 功能：计算寄存器在活动记录帧的偏移位置。
  * 返回值：
  **/
-static size_t GCGetFrameRegBase(const FunType *funType)
+static size_t GCGetFrameRegBase(Bison *ctx, const FunType *funType)
 {
     size_t offset;
 
-    offset = GCGetFunTypeSize(funType);
+    offset = GCGetFunTypeSize(ctx, funType);
     offset = Align8Byte(offset);
     return offset;
 }
@@ -350,11 +372,11 @@ static size_t GCGetFrameRegBase(const FunType *funType)
  * 功能：计算寄存器R0在活动记录栈帧的偏移位置。
  * 返回值：
  **/
-static size_t GCGetSpR0Offset(const FunType *funType)
+static size_t GCGetSpR0Offset(Bison *ctx, const FunType *funType)
 {
     size_t offset;
 
-    offset = GCGetFrameRegBase(funType);
+    offset = GCGetFrameRegBase(ctx, funType);
     offset += 4;    //LR
     offset += 4;    //SP
     offset += 4;    //PSR
@@ -366,15 +388,16 @@ static size_t GCGetSpR0Offset(const FunType *funType)
 #endif
 
 /*
- * 功能：获取函数作用域局部变量区域在活动记录上的开始偏移位置。
+ * 功能：获取函数作用域局部变量区域在活动记录上的开始偏移位置。寄存器区域依次是LR、SP、
+ *      PSR、R3、R2、R1、R0和按需保存的常驻寄存器。
  * 返回值：
  **/
-static size_t GCGetFunLocalOffsetBase(const FunType *funType)
+static size_t GCGetFunLocalOffsetBase(Bison *ctx, const FunType *funType)
 {
     size_t offset;
 
-    offset = GCGetFrameRegBase(funType);
-    offset += 7 * 4;
+    offset = GCGetFrameRegBase(ctx, funType);
+    offset += (7 + HOME_SAVE_REG_CNT) * 4;
     offset = Align8Byte(offset);
     return offset;
 }
@@ -383,21 +406,21 @@ static size_t GCGetFunLocalOffsetBase(const FunType *funType)
  * 功能：获取作用域中局部变量区域在活动记录上的开始偏移位置。
  * 返回值：
  **/
-static size_t GCGetLocalDomainOffsetBase(Domain *domain)
+static size_t GCGetLocalDomainOffsetBase(Bison *ctx, Domain *domain)
 {
     size_t offset = 0;
 
     if (domain->type == DT_FUN) {
-        offset = GCGetFunLocalOffsetBase(domain->funType);
+        offset = GCGetFunLocalOffsetBase(ctx, domain->funType);
     } else if (domain->type == DT_BLK) {
-        offset = GCGetLocalDomainOffsetBase(domain->prev);
+        offset = GCGetLocalDomainOffsetBase(ctx, domain->prev);
         offset += domain->prev->offset_num;
         offset = Align8Byte(offset);
         offset += domain->prev->tmp_offset_num;
         offset = Align8Byte(offset);
     } else {
         PrErr("error: %d", domain->type);
-        exit(-1);
+        CplExit(-1);
     }
     return offset;
 }
@@ -406,25 +429,25 @@ static size_t GCGetLocalDomainOffsetBase(Domain *domain)
  * 功能：获取作用域中局部变量在活动记录上的偏移位置。
  * 返回值：
  **/
-static size_t GCGetLocalTokenOffset(Domain *domain, const Token *token)
+static size_t GCGetLocalTokenOffset(Bison *ctx, Domain *domain, const Token *token)
 {
     DomainEntry *domainEntry;
     size_t offset;
 
     domainEntry = EnvDomainGetEntry(domain, token);
     if (domainEntry->funArgFlag == 0) {    //非形式参数变量
-        offset = GCGetLocalDomainOffsetBase(domainEntry->domain) + domainEntry->offset;
+        offset = GCGetLocalDomainOffsetBase(ctx, domainEntry->domain) + domainEntry->offset;
         return offset;
     } else {    //形式参数变量
         FunType *funType;
 
         if (domain->type == DT_FUN) {
             funType = domain->funType;
-            offset = GCGetFunArgOffset(funType, token);
+            offset = GCGetFunArgOffset(ctx, funType, token);
             return offset;
         } else {
             PrErr("domain->type: %d", domain->type);
-            exit(-1);
+            CplExit(-1);
         }
     }
 }
@@ -433,11 +456,11 @@ static size_t GCGetLocalTokenOffset(Domain *domain, const Token *token)
  * 功能：获取作用域临时变量区域在活动记录上的开始偏移位置。
  * 返回值：
  **/
-static size_t GCGetLocalDomainTmpOffsetBase(Domain *domain)
+static size_t GCGetLocalDomainTmpOffsetBase(Bison *ctx, Domain *domain)
 {
     size_t offset;
 
-    offset = GCGetLocalDomainOffsetBase(domain) + domain->offset_num;
+    offset = GCGetLocalDomainOffsetBase(ctx, domain) + domain->offset_num;
     return Align8Byte(offset);
 }
 
@@ -459,7 +482,7 @@ static size_t GCGetTmpOffset(Domain *domain, Temp *temp)
             domain->tmp_offset_num += ATreeTypeSize(temp->type);
         } else {
             PrErr("temp->type->type error: %d", temp->type->type);
-            exit(-1);
+            CplExit(-1);
         }
         return temp->offset;
     }
@@ -469,17 +492,17 @@ static size_t GCGetTmpOffset(Domain *domain, Temp *temp)
  * 功能：获取作用域中临时变量在活动记录栈帧上的偏移位置。
  * 返回值：
  **/
-static size_t GCGetDomainTmpOffset(Domain *domain, Temp *temp)
+static size_t GCGetDomainTmpOffset(Bison *ctx, Domain *domain, Temp *temp)
 {
     size_t offset;
 
     if (domain->type == DT_FUN
             || domain->type == DT_BLK) {
         offset = GCGetTmpOffset(domain, temp);
-        return GCGetLocalDomainTmpOffsetBase(domain) + offset;
+        return GCGetLocalDomainTmpOffsetBase(ctx, domain) + offset;
     } else {
         PrErr("domain->type error: %d", domain->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -488,16 +511,40 @@ static size_t GCGetDomainTmpOffset(Domain *domain, Temp *temp)
  * 功能：获取作用域中当有函数调用时新的活动记录相对于当前活动记录的开始偏移位置。
  * 返回值：函数调用的新的活动记录相对于当前活动记录的开始偏移位置。
  **/
-static size_t GCGetFunSpOffset(Domain *domain)
+static size_t GCGetFunSpOffset(Bison *ctx, Domain *domain)
 {
     size_t offset;
 
-    offset = GCGetLocalDomainTmpOffsetBase(domain) + domain->tmp_offset_num;
+    offset = GCGetLocalDomainTmpOffsetBase(ctx, domain) + domain->tmp_offset_num;
     offset = Align8Byte(offset);
     return offset;
 }
 #endif
 
+/*
+ * 功能：获取操作数常驻的寄存器。
+ * 返回值：寄存器编号，操作数不是常驻寄存器的变量时返回0。
+ **/
+static uint8_t GCOperandHome(GCInfo *info, const QROperand *operand)
+{
+    uint32_t var;
+
+    if (!info->ssa || (operand->type != QROT_ID && operand->type != QROT_TEMP))
+        return 0;
+    var = SSAVarOfOperand(info->ssa, operand);
+    return var == SSA_NONE ? 0 : info->homeArr[var];
+}
+
+static uint8_t GCExprHome(GCInfo *info, const Expr *expr)
+{
+    uint32_t var;
+
+    if (!info->ssa || (expr->type != ET_ID && expr->type != ET_TEMP))
+        return 0;
+    var = SSAVarOfExpr(info->ssa, expr);
+    return var == SSA_NONE ? 0 : info->homeArr[var];
+}
+
 static void GCRegLdId(GCInfo *info, uint8_t reg, Domain *idDomain, QRId *id, uint8_t spReg, int extraOffset);
 static void GCRegLdAccessMem(GCInfo *info, uint8_t reg, QROperand *operand, uint8_t spReg, int extraOffset);
 static void GCRegLdTemp(GCInfo *info, uint8_t reg, Domain *domain, Temp *temp, uint8_t spReg);
@@ -518,7 +565,7 @@ static PIStType GCTypePIStType(const Type *type)
         return PISTT_4BYTE;
     default:
         PrErr("alignType error: %d", alignType);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -536,7 +583,7 @@ static PILdType GCTypePILdType(const Type *type)
         return PILDT_4BYTE;
     default:
         PrErr("alignType error: %d", alignType);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -555,7 +602,11 @@ static void GCRegSt(GCInfo *info, uint8_t regId, int extraOffset)
 {
     Register *reg = &info->reg[regId];
 
-    if (reg->syncFlag) {
+    if (reg->syncFlag && reg->homeReg) {
+        reg->syncFlag = 0;
+        if (reg->homeReg != regId)
+            PCInsArrAddMovReg(info->piArr, reg->homeReg, regId);
+    } else if (reg->syncFlag) {
         Type *dataType = reg->dataType;
         PIStType pistType;
 
@@ -619,7 +670,7 @@ static void GCRegSt(GCInfo *info, uint8_t regId, int extraOffset)
             }
         } else {
             PrErr("reg->memAddrType error: %d", reg->memAddrType);
-            exit(-1);
+            CplExit(-1);
         }
     }
 }
@@ -636,11 +687,11 @@ static void GCRegLdMbrOffset(GCInfo *info, uint8_t reg, QRAccessMbrOffset *mbrOf
         GCRegLdTemp(info, reg, mbrOffset->tempOffset.domain, mbrOffset->tempOffset.temp, spReg);
     } else {
         PrErr("amOffset->offsetType error: %d", mbrOffset->offsetType);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
-static Type *GCGetQRIdDataType(Domain *domain, QRId *id)
+static Type *GCGetQRIdDataType(Bison *ctx, Domain *domain, QRId *id)
 {
     DomainEntry *entry;
     Type *type;
@@ -649,9 +700,9 @@ static Type *GCGetQRIdDataType(Domain *domain, QRId *id)
     type = id->dataType;
     if (entry->funArgFlag) {
         if (type->type == TT_ARRAY) {
-            return ATreeNewPointerType(type->array.type);
+            return ATreeNewPointerType(ctx, type->array.type);
         } else if (type->type == TT_FUNCTION) {
-            return ATreeNewPointerType(type);
+            return ATreeNewPointerType(ctx, type);
         } else {
             return type;
         }
@@ -669,7 +720,7 @@ static void GCRegLdId(GCInfo *info, uint8_t reg, Domain *idDomain, QRId *id, uin
 
     domainEntry = EnvDomainGetEntry(idDomain, id->token);
     declDomain = domainEntry->domain;
-    type = GCGetQRIdDataType(idDomain, id);
+    type = GCGetQRIdDataType(info->ctx, idDomain, id);
     pildType = GCTypePILdType(type);
     if (declDomain->type == DT_GLOBAL) {
         PCInsArrAddLdWPseudo(info->piArr, reg, GLOBAL_BASE + domainEntry->offset + extraOffset);
@@ -678,12 +729,12 @@ static void GCRegLdId(GCInfo *info, uint8_t reg, Domain *idDomain, QRId *id, uin
                || declDomain->type == DT_BLK) {
         size_t offset;
 
-        offset = GCGetLocalTokenOffset(declDomain, id->token);
+        offset = GCGetLocalTokenOffset(info->ctx, declDomain, id->token);
         offset += extraOffset;
         PCInsArrAddLd(info->piArr, pildType, reg, spReg, offset);
     } else {
         PrErr("var domain->type error: %d", declDomain->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -697,7 +748,7 @@ static void GCRegLdAccessMem(GCInfo *info, uint8_t reg, QROperand *operand, uint
 
     amDomain = operand->domain;
     accessMbr = &operand->accessMbr;
-    piLdType = GCTypePILdType(QROperandDataType(operand));
+    piLdType = GCTypePILdType(QROperandDataType(info->ctx, operand));
     if (accessMbr->baseType == QRAMBT_ID) {
         Domain *declDomain;
 
@@ -725,7 +776,7 @@ static void GCRegLdAccessMem(GCInfo *info, uint8_t reg, QROperand *operand, uint
                    || declDomain->type == DT_BLK) {
             int offset;
 
-            offset = GCGetLocalTokenOffset(declDomain, accessMbr->baseId.token);
+            offset = GCGetLocalTokenOffset(info->ctx, declDomain, accessMbr->baseId.token);
             if (accessMbr->offset || extraOffset) {
                 if (accessMbr->offset) {
                     GCRegLdMbrOffset(info, SCRATCH_REG0, accessMbr->offset, spReg);
@@ -743,7 +794,7 @@ static void GCRegLdAccessMem(GCInfo *info, uint8_t reg, QROperand *operand, uint
                     PCInsArrAddLdOffsetReg(piArr, piLdType, reg, reg, SCRATCH_REG0);
                 } else {
                     PrErr("accessMem->type error: %d", accessMbr->type);
-                    exit(-1);
+                    CplExit(-1);
                 }
             } else {
                 if (accessMbr->type == QRAMT_DIRECT) {
@@ -753,12 +804,12 @@ static void GCRegLdAccessMem(GCInfo *info, uint8_t reg, QROperand *operand, uint
                     PCInsArrAddLd(piArr, piLdType, reg, reg, 0);
                 } else {
                     PrErr("accessMem->type error: %d", accessMbr->type);
-                    exit(-1);
+                    CplExit(-1);
                 }
             }
         } else {
             PrErr("declDomain->type error: %d", declDomain->type);
-            exit(-1);
+            CplExit(-1);
         }
     } else if (accessMbr->baseType == QRAMBT_TEMP) {
         if (amDomain->type == DT_BLK
@@ -766,7 +817,7 @@ static void GCRegLdAccessMem(GCInfo *info, uint8_t reg, QROperand *operand, uint
             if (accessMbr->type == QRAMT_INDIRECT) {
                 size_t offset;
 
-                offset = GCGetDomainTmpOffset(amDomain, accessMbr->baseTemp);
+                offset = GCGetDomainTmpOffset(info->ctx, amDomain, accessMbr->baseTemp);
                 PCInsArrAddLd(piArr, PILDT_4BYTE, reg, spReg, offset);
                 if (accessMbr->offset || extraOffset) {
                     if (accessMbr->offset) {
@@ -783,15 +834,15 @@ static void GCRegLdAccessMem(GCInfo *info, uint8_t reg, QROperand *operand, uint
                 }
             } else {
                 PrErr("accessMem->type error: %d", accessMbr->type);
-                exit(-1);
+                CplExit(-1);
             }
         } else {
             PrErr("amDomain->type error: %d", amDomain->type);
-            exit(-1);
+            CplExit(-1);
         }
     } else {
         PrErr("accessMem->baseType error: %d", accessMbr->baseType);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -803,9 +854,9 @@ static void GCRegLdTemp(GCInfo *info, uint8_t reg, Domain *domain, Temp *temp, u
     pildType = GCTypePILdType(temp->type);
     if (domain->type == DT_GLOBAL) {
         PrErr("temp domain->type error: %d", domain->type);
-        exit(-1);
+        CplExit(-1);
     } else {
-        offset = GCGetDomainTmpOffset(domain, temp);
+        offset = GCGetDomainTmpOffset(info->ctx, domain, temp);
         PCInsArrAddLd(info->piArr, pildType, reg, spReg, offset);
     }
 }
@@ -818,10 +869,10 @@ static void GCRegLdVal(GCInfo *info, uint8_t reg, QRValue *val)
         PCInsArrAddLdWPseudo(piArr, reg, val->ival);
     } else if (val->type == QRVT_FLOAT) {
         PrErr("val->type error: %d", val->type);
-        exit(-1);
+        CplExit(-1);
     } else {
         PrErr("val->type error: %d", val->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -840,12 +891,12 @@ static void GCRegLdGetAddr(GCInfo *info, uint8_t reg, Domain *gaDomain, QRGetAdd
                    || declDomain->type == DT_BLK) {
             size_t offset;
 
-            offset = GCGetLocalTokenOffset(declDomain, id->token);
+            offset = GCGetLocalTokenOffset(info->ctx, declDomain, id->token);
             PCInsArrAddLdWPseudo(info->piArr, reg, offset);
             PCInsArrAddAdd(info->piArr, reg, reg, SP_REG_ID);
         } else {
             PrErr("var domain->type error: %d", declDomain->type);
-            exit(-1);
+            CplExit(-1);
         }
     } else if (getAddr->type == QRGAT_ACCESS_MEM) {
         QRAccessMbr *accessmbr = &getAddr->accessMbr;
@@ -869,7 +920,7 @@ static void GCRegLdGetAddr(GCInfo *info, uint8_t reg, Domain *gaDomain, QRGetAdd
                        || declDomain->type == DT_BLK) {
                 size_t offset;
 
-                offset = GCGetLocalTokenOffset(declDomain, accessmbr->baseId.token);
+                offset = GCGetLocalTokenOffset(info->ctx, declDomain, accessmbr->baseId.token);
                 if (accessmbr->type == QRAMT_DIRECT) {
                     PCInsArrAddLdWPseudo(info->piArr, reg, offset);
 
@@ -878,7 +929,7 @@ static void GCRegLdGetAddr(GCInfo *info, uint8_t reg, Domain *gaDomain, QRGetAdd
                     PCInsArrAddLd(info->piArr, PILDT_4BYTE, reg, SP_REG_ID, offset);
                 } else {
                     PrErr("accessmbr->type error: %d", accessmbr->type);
-                    exit(-1);
+                    CplExit(-1);
                 }
                 if (accessmbr->offset) {
                     GCRegLdMbrOffset(info, SCRATCH_REG0, accessmbr->offset, SP_REG_ID);
@@ -886,7 +937,7 @@ static void GCRegLdGetAddr(GCInfo *info, uint8_t reg, Domain *gaDomain, QRGetAdd
                 }
             } else {
                 PrErr("var domain->type error: %d", declDomain->type);
-                exit(-1);
+                CplExit(-1);
             }
         } else if (accessmbr->baseType == QRAMBT_TEMP) {
             if (accessmbr->type == QRAMT_INDIRECT) {
@@ -899,25 +950,32 @@ static void GCRegLdGetAddr(GCInfo *info, uint8_t reg, Domain *gaDomain, QRGetAdd
                     }
                 } else {
                     PrErr("gaDomain->type error: %d", gaDomain->type);
-                    exit(-1);
+                    CplExit(-1);
                 }
             } else {
                 PrErr("accessmbr->type error: %d", accessmbr->type);
-                exit(-1);
+                CplExit(-1);
             }
         } else {
             PrErr("accessmbr->baseType error: %d", accessmbr->baseType);
-            exit(-1);
+            CplExit(-1);
         }
     } else {
         PrErr("getAddr->gaType error: %d", getAddr->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
 static void GCRegLdSpRegExtraOffset(GCInfo *info, uint8_t reg, QROperand *operand, uint8_t spReg, int extraOffset)
 {
-    if (operand->type == QROT_ID) {
+    uint8_t homeReg;
+
+    homeReg = GCOperandHome(info, operand);
+    if (homeReg) {
+        /*常驻寄存器的变量都是4字节的，extraOffset只能是0*/
+        if (homeReg != reg)
+            PCInsArrAddMovReg(info->piArr, reg, homeReg);
+    } else if (operand->type == QROT_ID) {
         GCRegLdId(info, reg, operand->domain, &operand->id, spReg, extraOffset);
     } else if (operand->type == QROT_ACCESS_MBR) {
         GCRegLdAccessMem(info, reg, operand, spReg, extraOffset);
@@ -929,7 +987,7 @@ static void GCRegLdSpRegExtraOffset(GCInfo *info, uint8_t reg, QROperand *operan
         GCRegLdGetAddr(info, reg, operand->domain, &operand->getAddr);
     } else {
         PrErr("operand->type error: %d", operand->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -952,10 +1010,10 @@ static void GCRegBoundId(GCInfo *info, uint8_t regId, Domain *idDomain, QRId *id
     } else if (declDomain->type == DT_FUN
                 || declDomain->type == DT_BLK) {
         reg->memAddrType = MAT_LOCAL;
-        reg->memAddr = GCGetLocalTokenOffset(declDomain, id->token);
+        reg->memAddr = GCGetLocalTokenOffset(info->ctx, declDomain, id->token);
     } else {
         PrErr("domain->type error: %d", declDomain->type);
-        exit(-1);
+        CplExit(-1);
     }
     reg->dataType = type;
 }
@@ -966,14 +1024,14 @@ static void GCRegBoundTemp(GCInfo *info, uint8_t regId, Domain *domain, Temp *te
 
     if (domain->type == DT_GLOBAL) {
         PrErr("domain->type: %d", domain->type);
-        exit(-1);
+        CplExit(-1);
     } else if (domain->type == DT_FUN
                || domain->type == DT_BLK) {
         reg->memAddrType = MAT_LOCAL;
-        reg->memAddr = GCGetDomainTmpOffset(domain, temp);
+        reg->memAddr = GCGetDomainTmpOffset(info->ctx, domain, temp);
     } else {
         PrErr("expr->domain->type error: %d", domain->type);
-        exit(-1);
+        CplExit(-1);
     }
     reg->dataType = type;
 }
@@ -988,7 +1046,7 @@ static void GCRegBoundAccessMem(GCInfo *info, uint8_t regId, Domain *amDomain, Q
         GCRegBoundTemp(info, regId, amDomain, accessMem->baseTemp, type);
     } else {
         PrErr("accessMem->baseType error: %d", accessMem->baseType);
-        exit(-1);
+        CplExit(-1);
     }
     reg->dataType = accessMem->dataType;
     reg->amOffset = accessMem->offset;
@@ -998,7 +1056,7 @@ static void GCRegBoundAccessMem(GCInfo *info, uint8_t regId, Domain *amDomain, Q
         reg->indirFlag = 1;
     } else {
         PrErr("accessMem->accessType error: %d", accessMem->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -1011,15 +1069,18 @@ static void GCRegBoundAssignSp(GCInfo *info, uint8_t regId, QROperand *operand,
     reg->indirFlag = 0;
     reg->syncFlag = 1;
     reg->spReg = spReg;
-    if (operand->type == QROT_ID) {
-        GCRegBoundId(info, regId, operand->domain, &operand->id, QROperandDataType(operand));
+    reg->homeReg = GCOperandHome(info, operand);
+    if (reg->homeReg) {
+        return;
+    } else if (operand->type == QROT_ID) {
+        GCRegBoundId(info, regId, operand->domain, &operand->id, QROperandDataType(info->ctx, operand));
     } else if (operand->type == QROT_ACCESS_MBR) {
-        GCRegBoundAccessMem(info, regId, operand->domain, &operand->accessMbr, QROperandDataType(operand));
+        GCRegBoundAccessMem(info, regId, operand->domain, &operand->accessMbr, QROperandDataType(info->ctx, operand));
     } else if (operand->type == QROT_TEMP) {
-        GCRegBoundTemp(info, regId, operand->domain, operand->temp, QROperandDataType(operand));
+        GCRegBoundTemp(info, regId, operand->domain, operand->temp, QROperandDataType(info->ctx, operand));
     } else {
         PrErr("operand->type error: %d", operand->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -1048,12 +1109,22 @@ static int GCGenArithInstruct(GCInfo *info, const QuadRuple *quadRuple)
     PInstType pInstType;
     uint8_t dstReg, src1Reg, src2Reg;
 
-    dstReg = 0;
-    src1Reg = 0;
-    src2Reg = 1;
-    GCRegLd(info, src1Reg, quadRuple->binOp.arg1);
-    GCRegLd(info, src2Reg, quadRuple->binOp.arg2);
-    GCRegBound(info, dstReg, quadRuple->binOp.result);
+    /*常驻寄存器的操作数直接参与运算，不需要加载和保存*/
+    src1Reg = GCOperandHome(info, quadRuple->binOp.arg1);
+    if (!src1Reg) {
+        src1Reg = 0;
+        GCRegLd(info, src1Reg, quadRuple->binOp.arg1);
+    }
+    src2Reg = GCOperandHome(info, quadRuple->binOp.arg2);
+    if (!src2Reg) {
+        src2Reg = 1;
+        GCRegLd(info, src2Reg, quadRuple->binOp.arg2);
+    }
+    dstReg = GCOperandHome(info, quadRuple->binOp.result);
+    if (!dstReg) {
+        dstReg = 0;
+        GCRegBound(info, dstReg, quadRuple->binOp.result);
+    }
     switch (quadRuple->op) {
     case QROC_ADD:
         pInstType = PIT_ADD;
@@ -1072,11 +1143,12 @@ static int GCGenArithInstruct(GCInfo *info, const QuadRuple *quadRuple)
         break;
     default:
         PrErr("quadRuple->op error: %d", quadRuple->op);
-        exit(-1);
+        CplExit(-1);
     }
     //opc rx, ry, rz
     PCInsArrAddArith(info->piArr, pInstType, dstReg, src1Reg, src2Reg, PIAS2T_REG);
-    GCRegSt(info, dstReg, 0);
+    if (dstReg == 0)
+        GCRegSt(info, dstReg, 0);
     return 0;
 }
 
@@ -1093,7 +1165,7 @@ static int GCGenUncondJumpInstruct(GCInfo *info, const QuadRuple *quadRuple)
  */
 static int GCGenCondJumpInstuct(GCInfo *info, const QuadRuple *quadRuple)
 {
-    const Expr *cond;
+    Expr *cond;
     uint8_t dstReg, src1Reg, src2Reg;
     PInstructArr *piArr = info->piArr;
     PIBCondType piBCondType;
@@ -1109,8 +1181,17 @@ static int GCGenCondJumpInstuct(GCInfo *info, const QuadRuple *quadRuple)
             || cond->type == ET_GE
             || cond->type == ET_LT
             || cond->type == ET_LE) {
-        GCRegLd(info, src1Reg, QROperandFromExpr(cond->binOp.lExpr));
-        GCRegLd(info, src2Reg, QROperandFromExpr(cond->binOp.rExpr));
+        Expr *lExpr = ATreeExpr(info->ctx, cond->binOp.lExpr);
+        Expr *rExpr = ATreeExpr(info->ctx, cond->binOp.rExpr);
+
+        if (GCExprHome(info, lExpr))
+            src1Reg = GCExprHome(info, lExpr);
+        else
+            GCRegLd(info, src1Reg, QROperandFromExpr(info->ctx, lExpr));
+        if (GCExprHome(info, rExpr))
+            src2Reg = GCExprHome(info, rExpr);
+        else
+            GCRegLd(info, src2Reg, QROperandFromExpr(info->ctx, rExpr));
         //sub rx, ry, rz
         PCInsArrAddSub(piArr, dstReg, src1Reg, src2Reg);
 
@@ -1136,7 +1217,7 @@ static int GCGenCondJumpInstuct(GCInfo *info, const QuadRuple *quadRuple)
                 break;
             default:
                 PrErr("error exprType: %d", cond->type);
-                exit(-1);
+                CplExit(-1);
                 break;
             }
         } else if (quadRuple->op == QROC_FALSE_JUMP) {
@@ -1161,12 +1242,12 @@ static int GCGenCondJumpInstuct(GCInfo *info, const QuadRuple *quadRuple)
                 break;
             default:
                 PrErr("error exprType: %d", cond->type);
-                exit(-1);
+                CplExit(-1);
                 break;
             }
         } else {
             PrErr("error quadRuple->op: %d", quadRuple->op);
-            exit(-1);
+            CplExit(-1);
         }
         //bcz rx, #v
         PCInsArrAddBCond(piArr, piBCondType, dstReg, quadRuple->condJump.dstLabel, PC_ADDR(info->piArr));
@@ -1177,7 +1258,10 @@ static int GCGenCondJumpInstuct(GCInfo *info, const QuadRuple *quadRuple)
                || cond->type == ET_CONST_SPC
                || cond->type == ET_ACCESS_MBR
                || cond->type == ET_REF_POINTER) {
-        GCRegLd(info, dstReg, QROperandFromExpr(quadRuple->condJump.cond));
+        if (GCExprHome(info, cond))
+            dstReg = GCExprHome(info, cond);
+        else
+            GCRegLd(info, dstReg, QROperandFromExpr(info->ctx, cond));
         if (quadRuple->op == QROC_TRUE_JUMP) {
             //bnez rx, #v
             PCInsArrAddBCond(piArr, PIBCT_NE, dstReg, quadRuple->condJump.dstLabel, PC_ADDR(info->piArr));
@@ -1186,16 +1270,54 @@ static int GCGenCondJumpInstuct(GCInfo *info, const QuadRuple *quadRuple)
             PCInsArrAddBCond(piArr, PIBCT_EQ, dstReg, quadRuple->condJump.dstLabel, PC_ADDR(info->piArr));
         } else {
             PrErr("error quadRuple->op: %d", quadRuple->op);
-            exit(-1);
+            CplExit(-1);
         }
     } else {
         PrErr("exprType error: %d", cond->type);
-        exit(-1);
+        CplExit(-1);
     }
 
     return 0;
 }
 
+/*
+ * 功能：生成跳转表跳转指令。跳转表紧跟在br指令之后，表项是跳转到各目标标号的b指令，
+ *      br根据下标跳转到对应的表项。表项用相对跳转，不需要在生成目标代码映像时重定位。
+ * 返回值：
+ */
+static int GCGenTableJumpInstruct(GCInfo *info, const QuadRuple *quadRuple)
+{
+    PInstructArr *piArr = info->piArr;
+    uint8_t idxReg = TABLE_JUMP_REG, srcReg;
+    size_t i;
+
+    /*
+     * 下面的指令会改写idxReg，它不能是常驻寄存器。常驻寄存器编号从不为0（GCOperandHome用0
+     * 表示不常驻），常驻在寄存器中的下标直接作为mul的源操作数，不需要先复制。
+     **/
+    srcReg = GCOperandHome(info, quadRuple->tableJump.idx);
+    if (srcReg == idxReg) {
+        PrErr("table jump register is a home register: %u", idxReg);
+        CplExit(-1);
+    }
+    if (!srcReg) {
+        srcReg = idxReg;
+        GCRegLd(info, idxReg, quadRuple->tableJump.idx);
+    }
+    //mul rx, ry, #4
+    PCInsArrAddArith(piArr, PIT_MUL, idxReg, srcReg, 4, PIAS2T_IMM);
+    //add rx, rx, pc        pc是本条指令的地址，本条指令之后还有add和br两条指令
+    PCInsArrAddArith(piArr, PIT_ADD, idxReg, idxReg, PC_REG_ID, PIAS2T_REG);
+    PCInsArrAddArith(piArr, PIT_ADD, idxReg, idxReg, 4 * 3, PIAS2T_IMM);
+    //br rx
+    PCInsArrAddBr(piArr, idxReg);
+    for (i = 0; i < quadRuple->tableJump.labelNum; i++) {
+        //b #v
+        PCInsArrAddB(piArr, quadRuple->tableJump.labelArr[i], PC_ADDR(piArr));
+    }
+    return 0;
+}
+
 static size_t GCAlignTypeStep(AlignType align)
 {
     switch (align) {
@@ -1209,7 +1331,7 @@ static size_t GCAlignTypeStep(AlignType align)
         return 8;
     default:
         PrErr("align error:%d", align);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -1227,9 +1349,20 @@ static int GCGenAssignInstruct(GCInfo *info, const QuadRuple *quadRuple)
     dstReg = 0;
     rValue = quadRuple->unaryOp.arg1;
     lValue = quadRuple->unaryOp.result;
-    type = QROperandDataType(rValue);
+    type = QROperandDataType(info->ctx, rValue);
     size = ATreeTypeSize(type);
     step = GCAlignTypeStep(ATreeTypeGetAlignType(type));
+    if (GCOperandHome(info, lValue)) {
+        /*直接加载到左值常驻的寄存器*/
+        GCRegLd(info, GCOperandHome(info, lValue), rValue);
+        return 0;
+    }
+    if (GCOperandHome(info, rValue)) {
+        dstReg = GCOperandHome(info, rValue);
+        GCRegBound(info, dstReg, lValue);
+        GCRegSt(info, dstReg, 0);
+        return 0;
+    }
     for (size_t i = 0; i < size; i += step) {
         GCRegLdSpRegExtraOffset(info, dstReg, rValue, SP_REG_ID, i);
         GCRegBound(info, dstReg, lValue);
@@ -1246,6 +1379,7 @@ static int GCGenReturnInstruct(GCInfo *info, const QuadRuple *quadRuple)
 {
     uint8_t dstReg;
     FunType *funType;
+    uint32_t k;
     size_t regOffset, lrOffset;
     PInstructArr *piArr = info->piArr;
 
@@ -1258,7 +1392,7 @@ static int GCGenReturnInstruct(GCInfo *info, const QuadRuple *quadRuple)
         retType = funType->retType->type;
         if (funType->retType->typeType == ERTT_VOID) {
             PrErr("funType->retType->typeType error: %d", funType->retType->typeType);
-            exit(-1);
+            CplExit(-1);
         }
 
         dstReg = TMP_REG;
@@ -1271,7 +1405,7 @@ static int GCGenReturnInstruct(GCInfo *info, const QuadRuple *quadRuple)
             size = ATreeTypeSize(retType);
             piStType = GCTypePIStType(retType);
             step = GCAlignTypeStep(ATreeTypeGetAlignType(retType));
-            retOffset = GCGetFunRetOffset(funType);
+            retOffset = GCGetFunRetOffset(info->ctx, funType);
             for (size_t i = 0; i < size; i += step) {
                 GCRegLdSpRegExtraOffset(info, dstReg, quadRuple->returnObj.expr, SP_REG_ID, i);
                 PCInsArrAddSt(piArr, piStType, dstReg, SP_REG_ID, retOffset + i);
@@ -1280,7 +1414,7 @@ static int GCGenReturnInstruct(GCInfo *info, const QuadRuple *quadRuple)
     }
 
     /*恢复上一级活动的上下文*/
-    regOffset = GCGetFrameRegBase(funType);
+    regOffset = GCGetFrameRegBase(info->ctx, funType);
     lrOffset = regOffset;
     regOffset += 4;     //LR寄存器
     regOffset += 4;     //SP寄存器
@@ -1298,6 +1432,12 @@ static int GCGenReturnInstruct(GCInfo *info, const QuadRuple *quadRuple)
     regOffset += 4;
     //ld r0, [sp, #i]
     PCInsArrAddLdW(piArr, 0, SP_REG_ID, regOffset);
+    regOffset += 4;
+    for (k = HOME_REG_CNT - HOME_SAVE_REG_CNT; k < info->homeNum; k++) {
+        //ld rx, [sp, #i]
+        PCInsArrAddLdW(piArr, gcHomeRegArr[k], SP_REG_ID, regOffset);
+        regOffset += 4;
+    }
     //ld pc, [sp, #i]
     PCInsArrAddLdW(piArr, PC_REG_ID, SP_REG_ID, lrOffset);
 
@@ -1335,7 +1475,7 @@ static int GCGenFunCallParam(GCInfo *info, size_t *spOffset, size_t paramCnt, ch
         paramRuple = GCParamListPop(&info->paramList);
 
         operand = paramRuple->funParam.expr;
-        paramType = GCFunParamType(QROperandDataType(operand));
+        paramType = GCFunParamType(info->ctx, QROperandDataType(info->ctx, operand));
         *spOffset = GCFunArgAddrAlignByType(*spOffset, paramType);
         {
             size_t typeSize;
@@ -1414,7 +1554,7 @@ static int GCGenFunCallInstruct(GCInfo *info, const QuadRuple *quadRuple)
     setActSp->piSetActSp.vArgSize = vArgSize;
 
     /*设置返回地址*/
-    regOffset = GCGetFrameRegBase(funType);
+    regOffset = GCGetFrameRegBase(info->ctx, funType);
     //st r0, [sp, #i]
     PCInsArrAddStW(piArr, spOffsetReg, SP_REG_ID, regOffset + 4);     //保存上一级活动记录栈基地址。
     //ld r0, =v
@@ -1427,7 +1567,7 @@ static int GCGenFunCallInstruct(GCInfo *info, const QuadRuple *quadRuple)
 
     /*恢复堆栈基地址*/
     PCInsArrAddMovReg(piArr, spOffsetReg, SP_REG_ID);
-    regOffset = GCGetFrameRegBase(funType);
+    regOffset = GCGetFrameRegBase(info->ctx, funType);
     regOffset += 4;
     PCInsArrAddLd(piArr, PILDT_4BYTE, SP_REG_ID, SP_REG_ID, regOffset);
 
@@ -1438,9 +1578,9 @@ static int GCGenFunCallInstruct(GCInfo *info, const QuadRuple *quadRuple)
 
         if (funType->retType->typeType == ERTT_VOID) {
             PrErr("funType->retType->typeType error: %d", funType->retType->typeType);
-            exit(-1);
+            CplExit(-1);
         }
-        retOffset = GCGetFunRetOffset(funType);
+        retOffset = GCGetFunRetOffset(info->ctx, funType);
         funRetType = funType->retType->type;
         if (funRetType->type != TT_STRUCTURE) {
             piLdType = GCTypePILdType(funRetType);
@@ -1466,21 +1606,187 @@ static int GCGenFunCallInstruct(GCInfo *info, const QuadRuple *quadRuple)
     return 0;
 }
 
+/*
+ * 功能：释放当前函数的SSA形式和寄存器分配结果。
+ * 返回值：
+ **/
+static void GCReleaseHomes(GCInfo *info)
+{
+    SSAFree(info->ssa);
+    FGFree(info->graph);
+    if (info->homeArr)
+        GCMFree(info->homeArr);
+    info->ssa = NULL;
+    info->graph = NULL;
+    info->homeArr = NULL;
+    info->homeNum = 0;
+}
+
+/*
+ * 功能：判断给不足4字节的变量赋值时是否不需要截断，寄存器中的值总是和内存中的值相同。
+ *      赋值的右边只能是类型相同的操作数或者类型能表示的非负常量。
+ * 返回值：不需要截断时返回1，否则返回0。
+ **/
+static int GCNarrowAssignExact(Bison *ctx, const QuadRuple *qr, const Type *type)
+{
+    QROperand *rValue;
+    Type *rType;
+    int maxVal;
+
+    if (qr->op != QROC_ASSIGN)
+        return 0;
+    rValue = qr->unaryOp.arg1;
+    if (rValue->type == QROT_VAL) {
+        switch (type->baseType.type) {
+        case BTT_BOOL:
+            maxVal = 1;
+            break;
+        case BTT_CHAR:
+            maxVal = 127;
+            break;
+        default:
+            maxVal = 32767;
+            break;
+        }
+        return rValue->val.type == QRVT_INT && rValue->val.ival >= 0 && rValue->val.ival <= maxVal;
+    }
+    rType = QROperandDataType(ctx, rValue);
+    return rType->type == TT_BASE && rType->baseType.type == type->baseType.type;
+}
+
+/*
+ * 功能：判断变量的类型能否常驻寄存器。4字节的整数和指针都可以，不足4字节的临时变量和
+ *      局部变量还要求每次赋值都不需要截断，见GCNarrowAssignExact。
+ * 返回值：不能时返回0，可以时返回1，需要检查赋值时返回2。
+ **/
+static int GCHomeTypeEligible(const SSAVar *var)
+{
+    if (!var->promoted)
+        return 0;
+    if (var->type->type == TT_POINTER)
+        return 1;
+    if (var->type->type != TT_BASE || var->type->baseType.type == BTT_FLOAT)
+        return 0;
+    if (ATreeTypeSize(var->type) == 4)
+        return 1;
+    return var->param ? 0 : 2;
+}
+
+/*
+ * 功能：为从start开始的函数选择常驻寄存器的变量。构造SSA形式找出可以提升的变量，
+ *      按循环嵌套深度加权的定义和使用次数排序，权重最大的几个变量常驻寄存器。
+ *      变量的所有SSA版本合并回变量本身，不需要在phi处插入复制。
+ *      构造失败时所有变量仍然在栈上。
+ * 返回值：
+ **/
+static void GCAssignHomes(GCInfo *info, size_t start)
+{
+    const FGBlock *block;
+    SSAInstr *ins;
+    SSAVar *var;
+    uint8_t *eligibleArr;
+    uint32_t *weightArr;
+    uint32_t b, v, k, best, depth, weight;
+    size_t i;
+
+    if (FGBuild(info->record, start, &info->graph) != -ENOERR) {
+        info->graph = NULL;
+        return;
+    }
+    if (SSABuild(info->ctx, info->graph, &info->ssa) != -ENOERR) {
+        info->ssa = NULL;
+        GCReleaseHomes(info);
+        return;
+    }
+    info->homeArr = GCMAlloc(info->ssa->varNum + 1);
+    memset(info->homeArr, 0, info->ssa->varNum + 1);
+    weightArr = GCMAlloc((info->ssa->varNum + 1) * sizeof (*weightArr));
+    memset(weightArr, 0, (info->ssa->varNum + 1) * sizeof (*weightArr));
+
+    for (b = 0; b < info->graph->blockNum; b++) {
+        block = &info->graph->blockArr[b];
+        if (block->rpoIdx == FG_NONE)
+            continue;
+        depth = block->loopDepth < 5 ? block->loopDepth : 5;
+        weight = 1u << (3 * depth);
+        for (i = block->start; i < block->end; i++) {
+            ins = SSAInstrOf(info->ssa, i);
+            if (ins->def.var != SSA_NONE)
+                weightArr[ins->def.var] += weight;
+            for (k = 0; k < SSA_USE_MAX; k++) {
+                if (ins->useArr[k].var != SSA_NONE)
+                    weightArr[ins->useArr[k].var] += weight;
+            }
+        }
+    }
+    eligibleArr = GCMAlloc(info->ssa->varNum + 1);
+    for (v = 0; v < info->ssa->varNum; v++)
+        eligibleArr[v] = GCHomeTypeEligible(&info->ssa->varArr[v]);
+    for (i = info->graph->start; i < info->graph->end; i++) {
+        v = SSAInstrOf(info->ssa, i)->def.var;
+        if (v == SSA_NONE || eligibleArr[v] != 2)
+            continue;
+        var = &info->ssa->varArr[v];
+        if (!GCNarrowAssignExact(info->ctx, &info->record->qrArr[i], var->type))
+            eligibleArr[v] = 0;
+    }
+    for (k = 0; k < HOME_REG_CNT; k++) {
+        best = SSA_NONE;
+        for (v = 0; v < info->ssa->varNum; v++) {
+            /*只出现一次的变量放在寄存器中没有好处*/
+            if (info->homeArr[v] || !eligibleArr[v] || weightArr[v] < 2)
+                continue;
+            if (best == SSA_NONE || weightArr[v] > weightArr[best])
+                best = v;
+        }
+        if (best == SSA_NONE)
+            break;
+        info->homeArr[best] = gcHomeRegArr[k];
+        info->homeNum++;
+    }
+    GCMFree(eligibleArr);
+    GCMFree(weightArr);
+}
+
+/*
+ * 功能：把常驻寄存器的形式参数从活动记录加载到寄存器。
+ * 返回值：
+ **/
+static void GCLoadParamHomes(GCInfo *info, const FunType *funType)
+{
+    SSAVar *var;
+    uint32_t v;
+
+    if (!info->ssa)
+        return;
+    for (v = 0; v < info->ssa->varNum; v++) {
+        var = &info->ssa->varArr[v];
+        if (!info->homeArr[v] || !var->param)
+            continue;
+        //ld rx, [sp, #i]
+        PCInsArrAddLd(info->piArr, GCTypePILdType(var->type), info->homeArr[v], SP_REG_ID,
+                      GCGetFunArgOffset(info->ctx, funType, var->entry->id));
+    }
+}
+
 /*
  * 功能：生成函数定义开始处的指令
  * 返回值：
  **/
 static int GCGenFunStartInstruct(GCInfo *info, const QuadRuple *quadRuple)
 {
+    uint32_t k;
     size_t regOffset;
     FunType *funType;
     PInstructArr *piArr = info->piArr;
 
     funType = quadRuple->funStartFlag.funType;
     funType->addr = PC_ADDR(piArr);
+    GCReleaseHomes(info);
+    GCAssignHomes(info, quadRuple - info->record->qrArr);
 
     /*保存上一级调用的机器状态*/
-    regOffset = GCGetFrameRegBase(funType);
+    regOffset = GCGetFrameRegBase(info->ctx, funType);
     regOffset += 4; //LR寄存器
     regOffset += 4; //SP寄存器
     //st psr [sp, #i]
@@ -1497,6 +1803,13 @@ static int GCGenFunStartInstruct(GCInfo *info, const QuadRuple *quadRuple)
     regOffset += 4; //R1寄存器
     //st r0 [sp, #i]
     PCInsArrAddStW(piArr, 0, SP_REG_ID, regOffset);
+    regOffset += 4; //R0寄存器
+    for (k = HOME_REG_CNT - HOME_SAVE_REG_CNT; k < info->homeNum; k++) {
+        //st rx [sp, #i]
+        PCInsArrAddStW(piArr, gcHomeRegArr[k], SP_REG_ID, regOffset);
+        regOffset += 4;
+    }
+    GCLoadParamHomes(info, funType);
 
     return 0;
 }
@@ -1536,7 +1849,7 @@ static int GCGenFunEndInstruct(GCInfo *info, const QuadRuple *quadRuple)
     size_t offset;
     PInstruct *pInst;
 
-    offset = GCGetFunLocalOffsetBase(funType);
+    offset = GCGetFunLocalOffsetBase(info->ctx, funType);
     offset = Align8Byte(offset);
 
     offset += GCGetDomainSize(funDomain);
@@ -1548,6 +1861,7 @@ static int GCGenFunEndInstruct(GCInfo *info, const QuadRuple *quadRuple)
         pos = pos->next;
         list_del(&sasNode->node);
         pInst = &info->piArr->insArr[sasNode->instNum];
+        GCMFree(sasNode);
         vArgSize = pInst->piSetActSp.vArgSize;
 
         pInst->type = PIT_ADD;
@@ -1556,6 +1870,7 @@ static int GCGenFunEndInstruct(GCInfo *info, const QuadRuple *quadRuple)
         pInst->piArith.src2Type = PIAS2T_IMM;
         pInst->piArith.src2 = offset + vArgSize;
     }
+    GCReleaseHomes(info);
     return 0;
 }
 
@@ -1593,6 +1908,8 @@ static int GCGenInstruct(GCInfo *info, const QuadRuple *quadRuple)
     case QROC_TRUE_JUMP:
     case QROC_FALSE_JUMP:
         return GCGenCondJumpInstuct(info, quadRuple);
+    case QROC_TABLE_JUMP:
+        return GCGenTableJumpInstruct(info, quadRuple);
     case QROC_ASSIGN:
         return GCGenAssignInstruct(info, quadRuple);
     case QROC_RETURN_VOID:
@@ -1617,7 +1934,7 @@ static int GCGenInstruct(GCInfo *info, const QuadRuple *quadRuple)
         return 0;
     default:
         PrErr("quadRuple->op error: %u", quadRuple->op);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -1632,16 +1949,50 @@ static GCInfo *GCAllocInfo(void)
         gcInfo->reg[k].id = k;
         gcInfo->reg[k].syncFlag = 0;
         gcInfo->reg[k].dataType = NULL;
+        gcInfo->reg[k].homeReg = 0;
     }
     INIT_LIST_HEAD(&gcInfo->paramList);
     gcInfo->piArr = PCAllocInsArr();
     gcInfo->amTable = GCAMTableAlloc();
     gcInfo->miArr = MCALLocInsArr();
-    gcInfo->vm = VMAllocMachine();
     INIT_LIST_HEAD(&gcInfo->setActSpList);
+    gcInfo->record = NULL;
+    gcInfo->graph = NULL;
+    gcInfo->ssa = NULL;
+    gcInfo->homeArr = NULL;
+    gcInfo->homeNum = 0;
     return gcInfo;
 }
 
+/*
+ * 功能：释放生成代码过程中的信息。
+ * 返回值：
+ **/
+static void GCFreeInfo(GCInfo *info)
+{
+    struct list_head *pos;
+    ParamInsNode *piNode;
+    SetActSpNode *sasNode;
+
+    for (pos = info->paramList.next; pos != &info->paramList; ) {
+        piNode = container_of(pos, ParamInsNode, node);
+        pos = pos->next;
+        list_del(&piNode->node);
+        GCMFree(piNode);
+    }
+    for (pos = info->setActSpList.next; pos != &info->setActSpList; ) {
+        sasNode = container_of(pos, SetActSpNode, node);
+        pos = pos->next;
+        list_del(&sasNode->node);
+        GCMFree(sasNode);
+    }
+    GCReleaseHomes(info);
+    PCFreeInsArr(info->piArr);
+    GCAMTableFree(info->amTable);
+    MCFreeInsArr(info->miArr);
+    GCMFree(info);
+}
+
 /*
  * 功能：生成启动指令
  * 返回值：
@@ -1679,7 +2030,7 @@ static int GCGenBootInstructs(GCInfo *info)
     //st rx, [sp, #i]
     PCInsArrAddStW(piArr, dstReg->id, SP_REG_ID, offset);
     //call main
-    PCInsArrAddCall(piArr, bison->mainToken, bison->mainFunType, PC_ADDR(info->piArr));
+    PCInsArrAddCall(piArr, info->ctx->mainToken, info->ctx->mainFunType, PC_ADDR(info->piArr));
 
     //halt
     PCInsArrAddHalt(piArr);
@@ -1700,7 +2051,7 @@ static int GCFillPCDstAddr(GCInfo *info, PInstructArr *piArr)
                 piB->pcAddrFlag = 1;
                 if (piB->icDstAddr >= info->amTable->idx) {
                     PrErr("piB->icDstAddr too big: 0x%04x", piB->icDstAddr);
-                    exit(-1);
+                    CplExit(-1);
                 }
                 piB->pcDstAddr = info->amTable->maps[piB->icDstAddr];
             }
@@ -1709,7 +2060,7 @@ static int GCFillPCDstAddr(GCInfo *info, PInstructArr *piArr)
 
             if (piBCond->icDstAddr >= info->amTable->idx) {
                 PrErr("piBCond->icDstAddr too big: 0x%04x", piBCond->icDstAddr);
-                exit(-1);
+                CplExit(-1);
             }
             piBCond->pcDstAddr = info->amTable->maps[piBCond->icDstAddr];
         } else if (pInstruct->type == PIT_CALL) {
@@ -1747,39 +2098,145 @@ void GCHandleLdPseudo(PInstructArr *piArr)
     }
 }
 
-int GCGenCode(const QRRecord *record)
+/*
+ * 功能：把四元式翻译成机器指令，保存在info->miArr中。
+ * dumpFlag：是否输出伪指令和机器指令
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int GCTranslate(GCInfo *info, const QRRecord *record, unsigned int dumpFlag)
 {
     size_t i;
-    GCInfo *info;
 
-    if (!record)
-        return -EINVAL;
-    info = GCAllocInfo();
+    info->record = record;
     GCGenBootInstructs(info);
     for (i = 0; i < record->idx; i++) {
         GCAMTableAdd(info->amTable, PC_ADDR(info->piArr));
         GCGenInstruct(info, &record->qrArr[i]);
     }
-    PCInsArrPrint(info->piArr);
+    if (dumpFlag)
+        PCInsArrPrint(info->piArr);
 
-#if 1
     GCFillPCDstAddr(info, info->piArr);
     PCInstArrSetDataStart(info->piArr, info->piArr->idx);
     GCHandleLdPseudo(info->piArr);
-    printf("=================================\n");
-    PCInsArrPrint(info->piArr);
+    if (dumpFlag) {
+        printf("=================================\n");
+        PCInsArrPrint(info->piArr);
+    }
 
     MCGenInstructs(info->miArr, info->piArr);
-    printf("------------------------------\n");
-    MCInsArrPrint(info->miArr);
-
-    printf("++++++++++++++++++++++++++++++++++\n");
-    VMachineExec(info->vm, info->miArr->insArr, info->miArr->idx);
-#endif
+    if (dumpFlag) {
+        printf("------------------------------\n");
+        MCInsArrPrint(info->miArr);
+    }
+    return 0;
+}
 
+/*
+ * 功能：把编译上下文中的四元式翻译成机器指令，并在虚拟机中执行。生成期间ctx是当前线程的
+ *      上下文，四元式操作数的类型查询会用到上下文中的环境。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int GCGenCode(Bison *ctx)
+{
+    GCImage *image;
+    VMachine *vm;
+    int error = 0;
+
+    error = GCGenImage(ctx, &image);
+    if (error != -ENOERR)
+        return error;
+
+    vm = VMAllocMachine();
+    if (ctx->dumpFlag)
+        printf("++++++++++++++++++++++++++++++++++\n");
+    VMachineExec(vm, image->insArr, image->insNum);
+    VMFreeMachine(vm);
+    GCImageFree(image);
     return 0;
 }
 
+/*
+ * 功能：把编译上下文中的四元式翻译成内存中的目标代码映像，不执行。翻译错误只中止本次翻译。
+ * pImage：输出型参数，目标代码映像，由调用者用GCImageFree释放
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int GCGenImage(Bison *ctx, GCImage **pImage)
+{
+    GCInfo *info;
+    GCImage *image;
+    volatile int error = 0;
+    jmp_buf exitPoint, *prevExitPoint;
+
+    if (!ctx || !ctx->record || !pImage)
+        return -EINVAL;
+
+    prevExitPoint = cplExitPoint;
+    info = GCAllocInfo();
+    info->ctx = ctx;
+    cplExitPoint = &exitPoint;
+    if (setjmp(exitPoint) == 0)
+        error = GCTranslate(info, ctx->record, ctx->dumpFlag);
+    else
+        error = -ECOMPILE;
+    cplExitPoint = prevExitPoint;
+    if (error != -ENOERR)
+        goto err;
+
+    image = GCMAlloc(sizeof (*image));
+    image->insNum = info->miArr->idx;
+    image->dataStart = info->miArr->dataStart;
+    image->insArr = GCMAlloc((image->insNum ? image->insNum : 1) * sizeof (*image->insArr));
+    memcpy(image->insArr, info->miArr->insArr, image->insNum * sizeof (*image->insArr));
+    *pImage = image;
+
+err:
+    GCFreeInfo(info);
+    return error;
+}
+
+void GCImageFree(GCImage *image)
+{
+    if (image) {
+        GCMFree(image->insArr);
+        GCMFree(image);
+    }
+}
+
+static int GCImageWriteWord(uint32_t word, FILE *fp)
+{
+    unsigned char buf[4];
+
+    buf[0] = word & 0xff;
+    buf[1] = (word >> 8) & 0xff;
+    buf[2] = (word >> 16) & 0xff;
+    buf[3] = (word >> 24) & 0xff;
+    return fwrite(buf, sizeof (buf), 1, fp) == 1 ? 0 : -EIO;
+}
+
+/*
+ * 功能：把目标代码映像写入文件。文件格式：魔数GC_IMAGE_MAGIC、指令数、数据区起始下标，
+ *      然后是所有的指令和数据，每个字都按小端序存储。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int GCImageWrite(const GCImage *image, FILE *fp)
+{
+    size_t i;
+    int error = 0;
+
+    if (!image || !fp)
+        return -EINVAL;
+
+    error = GCImageWriteWord(GC_IMAGE_MAGIC, fp);
+    if (error == -ENOERR)
+        error = GCImageWriteWord(image->insNum, fp);
+    if (error == -ENOERR)
+        error = GCImageWriteWord(image->dataStart, fp);
+    for (i = 0; i < image->insNum && error == -ENOERR; i++)
+        error = GCImageWriteWord(image->insArr[i], fp);
+    return error;
+}
+
 /**
  * 1. 生成4字节的记录形式。
  * 2. 翻译4字节的记录，生成代码。
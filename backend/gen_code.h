@@ -5,9 +5,24 @@
 extern "C" {
 #endif
 
-typedef struct _QRRecord QRRecord;
+#include "stdio.h"
+#include "stdint.h"
 
-int GCGenCode(const QRRecord *record);
+typedef struct _Bison Bison;
+
+#define GC_IMAGE_MAGIC      (0x494c5043)    /*目标代码映像文件的魔数，按小端序存储为"CPLI"*/
+
+/*目标代码映像*/
+typedef struct _GCImage {
+    uint32_t *insArr;       /*指令和数据*/
+    size_t insNum;
+    size_t dataStart;       /*数据区的起始下标*/
+} GCImage;
+
+int GCGenCode(Bison *ctx);
+int GCGenImage(Bison *ctx, GCImage **pImage);
+void GCImageFree(GCImage *image);
+int GCImageWrite(const GCImage *image, FILE *fp);
 
 #ifdef __cplusplus
 }
@@ -31,7 +31,7 @@ static void *MCMalloc(size_t size)
     p = CplAlloc(size);
     if (!p) {
         PrErr("no memory");
-        exit(-1);
+        CplExit(-1);
     }
     return p;
 }
@@ -118,12 +118,12 @@ static int MCGenLdInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
         break;
     default:
         PrErr("pld->type error: %d", pld->type);
-        exit(-1);
+        CplExit(-1);
         break;
     }
     if (pld->pseudoFlag == 1) {
         PrErr("pld->pseudoFlag error: %d", pld->pseudoFlag);
-        exit(-1);
+        CplExit(-1);
     }
     mld.dstReg = pld->dstRegId;
     mld.memBaseReg = pld->machine.memRegId;
@@ -135,7 +135,7 @@ static int MCGenLdInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
         mld.offset = pld->machine.offset.reg;
     } else {
         PrErr("pld->machine.offsetType error: %d", pld->machine.offsetType);
-        exit(-1);
+        CplExit(-1);
     }
 
     instruct = *(uint32_t *)&mld;
@@ -165,7 +165,7 @@ static int MCGenStInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
         break;
     default:
         PrErr("pst->type error: %d", pst->type);
-        exit(-1);
+        CplExit(-1);
     }
     mst.srcReg = pst->srcRegId;
     mst.memBaseReg = pst->memRegId;
@@ -177,7 +177,7 @@ static int MCGenStInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
         mst.offset = pst->offset.reg;
     } else {
         PrErr("pst->offsetType error: %d", pst->offsetType);
-        exit(-1);
+        CplExit(-1);
     }
 
     instruct = *(uint32_t *)&mst;
@@ -196,7 +196,7 @@ static int MCGenMovInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
     if (pInstruct->piMov.type == PIMT_IMM){
         if (MCDataIsOverflow(pmov->imm, 19)) {
             PrErr("data overflow error", pmov->imm);
-            exit(-1);
+            CplExit(-1);
         }
         mmov.srcType = PIMT_IMM;
         mmov.src = *(uint32_t *)&pmov->imm;
@@ -205,7 +205,7 @@ static int MCGenMovInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
         mmov.src = pmov->srcReg;
     } else {
         PrErr("pInstruct->piMov.type error: %d", pInstruct->piMov.type);
-        exit(-1);
+        CplExit(-1);
     }
     instruct = *(uint32_t *)&mmov;
     MCInsArrAdd(mciArr, instruct);
@@ -223,7 +223,7 @@ static int MCGenCallInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
     offset = pcall->dstAddr - pcall->curAddr;
     if (MCDataIsOverflow(offset, 24)) {
         PrErr("offset error: %d", offset);
-        exit(-1);
+        CplExit(-1);
     }
     mb.pcOffset = *(uint32_t *)&offset;
     instruct = *(uint32_t *)&mb;
@@ -241,7 +241,7 @@ static int MCGenBInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
     offset = pb->pcDstAddr - pb->curAddr;
     if (MCDataIsOverflow(offset, 24)) {
         PrErr("offset error: %d", offset);
-        exit(-1);
+        CplExit(-1);
     }
     mb.opCode = MOC_B;
     mb.pcOffset = *(uint32_t *)&offset;
@@ -250,6 +250,18 @@ static int MCGenBInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
     return 0;
 }
 
+static int MCGenBrInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
+{
+    MBrInstruct mbr = {0};
+    uint32_t instruct;
+
+    mbr.opCode = MOC_BR;
+    mbr.reg = pInstruct->piBr.regId;
+    memcpy(&instruct, &mbr, sizeof (instruct));
+    MCInsArrAdd(mciArr, instruct);
+    return 0;
+}
+
 static int MCGenArithInstruct(MCInstArr *mciArr, PInstType type, const PInstruct *pInstruct)
 {
     MArithInstruct marith;
@@ -274,13 +286,13 @@ static int MCGenArithInstruct(MCInstArr *mciArr, PInstType type, const PInstruct
         break;
     default:
         PrErr("type error: %d", type);
-        exit(-1);
+        CplExit(-1);
     }
     marith.dstReg = parith->dstRegId;
     marith.src1Reg = parith->src1RegId;
     if (MCDataIsOverflow(parith->src2, 15)) {
         PrErr("num: 0x%04x, MCDataIsOverflow error: %d", mciArr->idx * 4, parith->src2);
-        exit(-1);
+        CplExit(-1);
     }
     marith.src2 = *(uint32_t *)&parith->src2;
     marith.src2Type = parith->src2Type;
@@ -301,7 +313,7 @@ static int MCGenBCondInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
     offset = pbcond->pcDstAddr - pbcond->curAddr;
     if (MCDataIsOverflow(offset, 17)) {
         PrErr("offset error: %d", offset);
-        exit(-1);
+        CplExit(-1);
     }
     mbcond.pcOffset = *(uint32_t *)&offset;
     switch (pbcond->type) {
@@ -325,7 +337,7 @@ static int MCGenBCondInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
         break;
     default:
         PrErr("pbcond->type error: %d", pbcond->type);
-        exit(-1);
+        CplExit(-1);
     }
     instruct = *(uint32_t *)&mbcond;
     MCInsArrAdd(mciArr, instruct);
@@ -369,6 +381,9 @@ static int MCGenInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
     case PIT_B:
         MCGenBInstruct(mciArr, pInstruct);
         break;
+    case PIT_BR:
+        MCGenBrInstruct(mciArr, pInstruct);
+        break;
     case PIT_ADD:
     case PIT_SUB:
     case PIT_MUL:
@@ -384,7 +399,7 @@ static int MCGenInstruct(MCInstArr *mciArr, const PInstruct *pInstruct)
         break;
     default:
         PrErr("pInstruct->type error: %d", pInstruct->type);
-        exit(-1);
+        CplExit(-1);
     }
     return 0;
 }
@@ -430,7 +445,7 @@ static void MCLdInsPrint(MLdInstruct mld)
         break;
     default:
         PrErr("mld.type error: %d", mld.type);
-        exit(-1);
+        CplExit(-1);
     }
 
     if (mld.offsetType == MCOT_IMM) {
@@ -451,7 +466,7 @@ static void MCLdInsPrint(MLdInstruct mld)
                RSTR(mld.offset));
     } else {
         PrErr("mld.offsetType error: %d", mld.offsetType);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -474,7 +489,7 @@ static void MCStInsPrint(MStInstruct mst)
         break;
     default:
         PrErr("mst.type error: %d", mst.type);
-        exit(-1);
+        CplExit(-1);
     }
 
     if (mst.offsetType == MCOT_IMM) {
@@ -495,7 +510,7 @@ static void MCStInsPrint(MStInstruct mst)
                RSTR(mst.offset));
     } else {
         PrErr("mst.offsetType error: %d", mst.offsetType);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -513,7 +528,7 @@ static void MCMovInsPrint(MMovInstruct mmov)
         MCEmit("mov %s %s", RSTR(mmov.dstReg), RSTR(mmov.src));
     } else {
         PrErr("mmov.srcType error: %d", mmov.srcType);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -555,7 +570,7 @@ static void MCArithInsPrint(MArithInstruct marith)
         break;
     default:
         PrErr("marith.opCode error: %d", marith.opCode);
-        exit(-1);
+        CplExit(-1);
     }
     if (marith.src2Type == PIAS2T_REG) {
         MCEmit("%s %s, %s, %s", opStr, RSTR(marith.dstReg),
@@ -570,7 +585,7 @@ static void MCArithInsPrint(MArithInstruct marith)
         }
     } else {
         PrErr("marith.src2Type error: %d", marith.src2Type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -640,7 +655,7 @@ static void MCInsPrint(uint32_t instruct)
         return MCHaltPrint(*(MHalt *)&instruct);
     default:
         PrErr("opCode error: %d", opCode);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
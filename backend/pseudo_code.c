@@ -28,7 +28,7 @@ static void *PCMalloc(size_t size)
     p = CplAlloc(size);
     if (!p) {
         PrErr("no memory");
-        exit(-1);
+        CplExit(-1);
     }
     return p;
 }
@@ -283,6 +283,16 @@ int PCInsArrAddB(PInstructArr *piArr, uint32_t icDstAddr, uint32_t curAddr)
     return 0;
 }
 
+int PCInsArrAddBr(PInstructArr *piArr, uint8_t regId)
+{
+    PInstruct *pIns;
+
+    pIns = PCInsArrAlloc(piArr);
+    pIns->type = PIT_BR;
+    pIns->piBr.regId = regId;
+    return 0;
+}
+
 int PCInsArrAddArith(PInstructArr *piArr, PInstType type, uint8_t dstRegID, uint8_t src1RegId, int32_t src2, PIArithSrc2Type src2Type)
 {
     PInstruct *pIns;
@@ -434,7 +444,7 @@ static void PCLdInsPrint(const PInstruct *pInstruct)
                    REG_STR(piLd->machine.memRegId), REG_STR(piLd->machine.offset.reg));
         } else {
             PrErr("piLd->machine.offsetType error: %d", piLd->machine.offsetType);
-            exit(-1);
+            CplExit(-1);
         }
     }
 }
@@ -476,7 +486,7 @@ static void PCStInsPrint(const PInstruct *pInstruct)
                REG_STR(piSt->memRegId), REG_STR(piSt->offset.reg));
     } else {
         PrErr("piSt->offsetType error: %d", piSt->offsetType);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -495,7 +505,7 @@ static void PCMovInsPrint(const PInstruct *pInstruct)
         PCEmit("MOV %s, %s", REG_STR(piMov->dstRegId), REG_STR(piMov->srcReg));
     } else {
         PrErr("piMov->type error: %d", piMov->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -515,6 +525,11 @@ static void PCBInsPrint(const PInstruct *pInstruct)
     PCEmit("B 0x%04x [0x%04x]", piB->pcDstAddr, piB->icDstAddr);
 }
 
+static void PCBrInsPrint(const PInstruct *pInstruct)
+{
+    PCEmit("BR %s", REG_STR(pInstruct->piBr.regId));
+}
+
 static void PCArithInsPrint(const PInstruct *pInstruct)
 {
     const PIArith *piArith;
@@ -553,7 +568,7 @@ static void PCArithInsPrint(const PInstruct *pInstruct)
         }
     } else {
         PrErr("piArith->src2Type error: %d", piArith->src2Type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -613,6 +628,8 @@ static void PCInstructPrint(const PInstruct *pInstruct)
         return PCCallInsPrint(pInstruct);
     case PIT_B:
         return PCBInsPrint(pInstruct);
+    case PIT_BR:
+        return PCBrInsPrint(pInstruct);
     case PIT_ADD:
     case PIT_SUB:
     case PIT_MUL:
@@ -627,7 +644,7 @@ static void PCInstructPrint(const PInstruct *pInstruct)
         return PCHaltInsPrint(pInstruct);
     default:
         PrErr("pInstruct->type error: %d", pInstruct->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -96,6 +96,10 @@ typedef struct {
     uint32_t curAddr;
 } PIB;
 
+typedef struct {
+    uint8_t regId;      //目标地址寄存器
+} PIBr;
+
 typedef enum {
     PIAS2T_IMM,
     PIAS2T_REG,
@@ -130,6 +134,7 @@ typedef enum {
     PIT_MOV,
     PIT_CALL,
     PIT_B,
+    PIT_BR,     //br rx     跳转到寄存器中的地址
     PIT_ADD,
     PIT_SUB,
     PIT_MUL,
@@ -149,6 +154,7 @@ typedef struct {
         PIMov piMov;
         PICall piCall;
         PIB piB;
+        PIBr piBr;
         PIArith piArith;
         PIBCond piBCond;
         PILDData piLdData;
@@ -186,6 +192,7 @@ int PCInsArrAddMov(PInstructArr *piArr, uint8_t dstRegId, int32_t immData);
 int PCInsArrAddMovReg(PInstructArr *piArr, uint8_t dstRegId, uint8_t srcReg);
 int PCInsArrAddCall(PInstructArr *piArr, const Token *funToken, FunType *funType, uint32_t curAddr);
 int PCInsArrAddB(PInstructArr *piArr, uint32_t icDstAddr, uint32_t curAddr);
+int PCInsArrAddBr(PInstructArr *piArr, uint8_t regId);
 int PCInsArrAddArith(PInstructArr *piArr, PInstType type, uint8_t dstRegID, uint8_t src1RegId, int32_t src2, PIArithSrc2Type src2Type);
 int PCInsArrAddAdd(PInstructArr *piArr, uint8_t dstRegID, uint8_t src1RegId, uint8_t src2RegId);
 int PCInsArrAddSub(PInstructArr *piArr, uint8_t dstRegID, uint8_t src1RegId, uint8_t src2RegId);
@@ -0,0 +1,64 @@
+#ifndef __CPL_BITSET_H__
+#define __CPL_BITSET_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "string.h"
+
+/*容纳bits个位需要的32位字数*/
+#define CPL_BITSET_WORDS(bits)      (((bits) + 31) >> 5)
+
+static inline void CplBitsetSet(uint32_t *set, unsigned int bit)
+{
+    set[bit >> 5] |= (uint32_t)1 << (bit & 31);
+}
+
+static inline void CplBitsetClr(uint32_t *set, unsigned int bit)
+{
+    set[bit >> 5] &= ~((uint32_t)1 << (bit & 31));
+}
+
+static inline int CplBitsetTest(const uint32_t *set, unsigned int bit)
+{
+    return (set[bit >> 5] >> (bit & 31)) & 1;
+}
+
+static inline void CplBitsetZero(uint32_t *set, unsigned int words)
+{
+    memset(set, 0, words * sizeof (*set));
+}
+
+static inline void CplBitsetCopy(uint32_t *lSet, const uint32_t *rSet, unsigned int words)
+{
+    memcpy(lSet, rSet, words * sizeof (*lSet));
+}
+
+/*
+ * 功能：lSet |= rSet
+ * 返回值：如果lSet发生了变化返回1，否则返回0。
+ **/
+static inline int CplBitsetOr(uint32_t *lSet, const uint32_t *rSet, unsigned int words)
+{
+    unsigned int w;
+    uint32_t changed = 0;
+
+    for (w = 0; w < words; w++) {
+        changed |= rSet[w] & ~lSet[w];
+        lSet[w] |= rSet[w];
+    }
+    return changed != 0;
+}
+
+static inline int CplBitsetIsEqual(const uint32_t *lSet, const uint32_t *rSet, unsigned int words)
+{
+    return memcmp(lSet, rSet, words * sizeof (*lSet)) == 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__CPL_BITSET_H__*/
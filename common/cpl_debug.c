@@ -0,0 +1,4 @@
+#include "cpl_debug.h"
+
+__thread FILE *cplPrStream;
+__thread jmp_buf *cplExitPoint;
@@ -7,6 +7,13 @@ extern "C" {
 
 #include "stdarg.h"
 #include "stdio.h"
+#include "stdlib.h"
+#include "setjmp.h"
+
+/*当前线程的诊断信息输出流，为NULL时输出到标准输出*/
+extern __thread FILE *cplPrStream;
+/*当前线程的编译错误退出点，为NULL时CplExit退出进程*/
+extern __thread jmp_buf *cplExitPoint;
 
 static inline int Pr(const char *file, int line, const char *func, const char *errStr,
                  const char *fmt, ...)
@@ -14,14 +21,27 @@ static inline int Pr(const char *file, int line, const char *func, const char *e
     char buf[1024] = {0};
     va_list ap;
     int ret;
+    FILE *fp = cplPrStream ? cplPrStream : stdout;
 
     va_start(ap, fmt);
     vsnprintf(buf, sizeof (buf), fmt, ap);
-    ret = printf("%s %d %s [%s] %s\n", file, line, func, errStr, buf);
-    fflush(stdout);
+    ret = fprintf(fp, "%s %d %s [%s] %s\n", file, line, func, errStr, buf);
+    fflush(fp);
     return ret;
 }
 
+/*
+ * 功能：编译中遇到无法继续的错误时调用。当前线程设置了退出点时跳转到退出点，
+ *      只结束当前的编译，否则退出进程。
+ * 返回值：不返回
+ **/
+static inline __attribute__((noreturn)) void CplExit(int status)
+{
+    if (cplExitPoint)
+        longjmp(*cplExitPoint, status ? status : -1);
+    exit(status);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,6 +24,7 @@ extern "C" {
 #define ENOPDTB         269   /*ûҵƥĲʽ*/
 #define ENOITEM         270   /*ûҵе*/
 #define EEOF            271   /*ļĩβ*/
+#define ECOMPILE        272   /*󣬱ֹ*/
 
 #ifdef __cplusplus
 }
@@ -1,5 +1,19 @@
 #include "cpl_mm.h"
 #include "stdlib.h"
+#include "string.h"
+
+/*区域分配器返回的内存按这个字节数对齐*/
+#define CPL_ARENA_ALIGN     16
+
+struct _CplArenaBlock {
+    CplArenaBlock *next;    /*前一个内存块*/
+    size_t size;            /*数据区的字节数*/
+};
+
+/*内存块头之后是数据区*/
+#define CPL_ARENA_HEAD_SIZE \
+    ((sizeof (CplArenaBlock) + CPL_ARENA_ALIGN - 1) & ~(size_t)(CPL_ARENA_ALIGN - 1))
+#define CplArenaBlockData(block)    ((unsigned char *)(block) + CPL_ARENA_HEAD_SIZE)
 
 void *CplAlloc(size_t size)
 {
@@ -10,3 +24,121 @@ void CplFree(void *p)
 {
     return free(p);
 }
+
+/*
+ * 功能：创建区域分配器，blockSize为0时使用默认大小。
+ * 返回值：成功时返回分配器，否则返回NULL。
+ **/
+CplArena *CplArenaCreate(size_t blockSize)
+{
+    CplArena *arena;
+
+    arena = malloc(sizeof (*arena));
+    if (!arena)
+        return NULL;
+    arena->block = NULL;
+    arena->used = 0;
+    arena->blockSize = blockSize ? blockSize : CPL_ARENA_DEFAULT_BLOCK_SIZE;
+    arena->totalSize = 0;
+    return arena;
+}
+
+/*
+ * 功能：销毁区域分配器，释放从分配器中申请的所有内存。
+ * 返回值：无
+ **/
+void CplArenaDestroy(CplArena *arena)
+{
+    CplArenaBlock *block;
+
+    if (!arena)
+        return;
+    while (arena->block) {
+        block = arena->block;
+        arena->block = block->next;
+        free(block);
+    }
+    free(arena);
+}
+
+/*
+ * 功能：释放从分配器中申请的所有内存，保留一个默认大小的内存块，
+ *      反复申请和丢弃临时对象时不必每次重新申请内存块。
+ * 返回值：无
+ **/
+void CplArenaReset(CplArena *arena)
+{
+    CplArenaBlock *block, *keep = NULL;
+
+    if (!arena)
+        return;
+    while (arena->block) {
+        block = arena->block;
+        arena->block = block->next;
+        if (!keep && block->size == arena->blockSize)
+            keep = block;
+        else
+            free(block);
+    }
+    if (keep)
+        keep->next = NULL;
+    arena->block = keep;
+    arena->used = 0;
+    arena->totalSize = keep ? keep->size : 0;
+}
+
+/*
+ * 功能：从区域分配器中申请内存，当前内存块不够时申请新的内存块，
+ *      大于默认块大小的对象单独占用一个内存块。
+ * 返回值：成功时返回按CPL_ARENA_ALIGN对齐的内存，否则返回NULL。
+ **/
+void *CplArenaAlloc(CplArena *arena, size_t size)
+{
+    CplArenaBlock *block;
+
+    size = (size + CPL_ARENA_ALIGN - 1) & ~(size_t)(CPL_ARENA_ALIGN - 1);
+    if (!size)
+        size = CPL_ARENA_ALIGN;
+    if (arena->block && arena->block->size - arena->used >= size) {
+        arena->used += size;
+        return CplArenaBlockData(arena->block) + arena->used - size;
+    }
+
+    if (size > arena->blockSize) {
+        /*大对象单独占用一个内存块，挂在当前内存块后面，当前内存块的剩余空间继续使用。*/
+        block = malloc(CPL_ARENA_HEAD_SIZE + size);
+        if (!block)
+            return NULL;
+        block->size = size;
+        arena->totalSize += size;
+        if (arena->block) {
+            block->next = arena->block->next;
+            arena->block->next = block;
+        } else {
+            block->next = NULL;
+            arena->block = block;
+            arena->used = size;
+        }
+        return CplArenaBlockData(block);
+    }
+
+    block = malloc(CPL_ARENA_HEAD_SIZE + arena->blockSize);
+    if (!block)
+        return NULL;
+    block->size = arena->blockSize;
+    block->next = arena->block;
+    arena->block = block;
+    arena->used = size;
+    arena->totalSize += arena->blockSize;
+    return CplArenaBlockData(block);
+}
+
+void *CplArenaCalloc(CplArena *arena, size_t size)
+{
+    void *p;
+
+    p = CplArenaAlloc(arena, size);
+    if (p)
+        memset(p, 0, size);
+    return p;
+}
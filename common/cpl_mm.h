@@ -5,14 +5,35 @@
 extern "C" {
 #endif
 
+#include "stddef.h"
 #include "stdint.h"
 
 void *CplAlloc(size_t size);
 void CplFree(void *p);
 
+/*
+ * 区域分配器：从大块内存中顺序切分小对象，对象不能单独释放，
+ * 销毁分配器时一次释放所有内存块。分配器不加锁，一个分配器只能在一个线程中使用。
+ **/
+typedef struct _CplArenaBlock CplArenaBlock;
+
+typedef struct _CplArena {
+    CplArenaBlock *block;   /*当前内存块，块之间用next链接*/
+    size_t used;            /*当前内存块已经使用的字节数*/
+    size_t blockSize;       /*默认内存块的大小*/
+    size_t totalSize;       /*所有内存块的总大小*/
+} CplArena;
+
+#define CPL_ARENA_DEFAULT_BLOCK_SIZE    (64 * 1024)
+
+CplArena *CplArenaCreate(size_t blockSize);
+void CplArenaDestroy(CplArena *arena);
+void CplArenaReset(CplArena *arena);
+void *CplArenaAlloc(CplArena *arena, size_t size);
+void *CplArenaCalloc(CplArena *arena, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
 
 #endif /*__CPL_MM_H__*/
-
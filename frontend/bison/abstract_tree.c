@@ -6,6 +6,7 @@
 #include "cpl_errno.h"
 #include "cpl_debug.h"
 #include "stdlib.h"
+#include "string.h"
 #include "bison.h"
 #include "environ.h"
 #include "backpatch.h"
@@ -13,40 +14,233 @@
 
 #define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
 
+#define ATREE_SEQ_INIT_SIZE     4   /*序列数组的初始容量*/
+#define ATREE_ARR_INIT_SIZE     64  /*节点表页数组和序列下标数组的初始容量*/
+
 #define AT_DEBUG
 #ifdef AT_DEBUG
 #define PrDbg(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "debug", __VA_ARGS__)
 #endif
 
 /*
- * 功能：分配内存，如果失败则程序直接退出。
+ * 功能：从编译单元的区域分配器中分配内存，如果失败则程序直接退出。
+ *      语法树节点和类型随编译单元一起释放，ATreeFree*不再逐个释放节点。
  * 返回值：
  **/
-static void *ATreeMAlloc(size_t size)
+static void *ATreeMAlloc(Bison *ctx, size_t size)
 {
     void *p;
 
-    p = CplAlloc(size);
+    p = CplArenaAlloc(ctx->arena, size);
     if (!p) {
         PrErr("no memory\n");
-        exit(-1);
+        CplExit(-1);
     }
     return p;
 }
 
 void ATreeFreeType(Type *type);
 
+/*
+ * 功能：保证序列数组还能追加一个元素，容量不足时从区域分配器中分配两倍容量的数组并复制已有元素，
+ *      旧数组随编译单元一起释放。
+ * arr：序列数组，可以为空
+ * elemSize：元素大小
+ * num：已有元素个数
+ * pSize：输入输出型参数，数组容量
+ * 返回值：可以追加元素的数组
+ **/
+static void *ATreeSeqReserve(Bison *ctx, void *arr, size_t elemSize, uint32_t num, uint32_t *pSize)
+{
+    void *newArr;
+    uint32_t size;
+
+    if (num < *pSize)
+        return arr;
+    if (*pSize > UINT32_MAX / 2) {
+        PrErr("sequence too long\n");
+        CplExit(-1);
+    }
+    size = *pSize ? *pSize * 2 : ATREE_SEQ_INIT_SIZE;
+    newArr = ATreeMAlloc(ctx, size * elemSize);
+    if (num)
+        memcpy(newArr, arr, num * elemSize);
+    *pSize = size;
+    return newArr;
+}
+
+/*
+ * 功能：保证数组还能追加n个元素，容量不足时分配两倍容量的数组，复制已有元素后释放旧数组。
+ *      内存不足时程序直接退出。
+ * arr：数组，可以为空
+ * elemSize：元素大小
+ * num：已有元素个数
+ * pSize：输入输出型参数，数组容量
+ * 返回值：可以追加n个元素的数组
+ **/
+static void *ATreeArrReserve(void *arr, size_t elemSize, uint32_t num, uint32_t n, uint32_t *pSize)
+{
+    void *newArr;
+    uint32_t size = *pSize;
+
+    if (n <= size - num)
+        return arr;
+    if (n > UINT32_MAX - num) {
+        PrErr("array too long\n");
+        CplExit(-1);
+    }
+    if (size == 0)
+        size = ATREE_ARR_INIT_SIZE;
+    while (size < num + n) {
+        if (size > UINT32_MAX / 2) {
+            size = UINT32_MAX;
+            break;
+        }
+        size *= 2;
+    }
+    newArr = CplAlloc(size * elemSize);
+    if (!newArr) {
+        PrErr("no memory\n");
+        CplExit(-1);
+    }
+    if (num)
+        memcpy(newArr, arr, num * elemSize);
+    CplFree(arr);
+    *pSize = size;
+    return newArr;
+}
+
+/*
+ * 功能：分配编译单元的语法树，节点表的下标0保留给空节点。
+ * 返回值：成功时返回语法树，否则返回NULL。
+ **/
+ATree *ATreeAlloc(void)
+{
+    ATree *tree;
+
+    tree = CplAlloc(sizeof (*tree));
+    if (!tree)
+        return NULL;
+    memset(tree, 0, sizeof (*tree));
+    tree->exprTable.nodeSize = sizeof (Expr);
+    tree->exprTable.nodeNum = 1;
+    tree->stmtTable.nodeSize = sizeof (Stmt);
+    tree->stmtTable.nodeNum = 1;
+    tree->caseStmtTable.nodeSize = sizeof (CaseStmt);
+    tree->caseStmtTable.nodeNum = 1;
+    return tree;
+}
+
+/*
+ * 功能：释放语法树，节点页在编译单元的区域分配器中，随区域分配器一起释放。
+ * 返回值：
+ **/
+void ATreeFree(ATree *tree)
+{
+    if (!tree)
+        return;
+    CplFree(tree->exprTable.pageArr);
+    CplFree(tree->stmtTable.pageArr);
+    CplFree(tree->caseStmtTable.pageArr);
+    CplFree(tree->seqArr);
+    CplFree(tree->openArr);
+    CplFree(tree);
+}
+
+/*
+ * 功能：在节点表中分配节点，当前页用完时从编译单元的区域分配器中分配新页。
+ * pId：输出型参数，节点的下标
+ * 返回值：节点
+ **/
+static void *ATreeTableAlloc(Bison *ctx, ATreeNodeTable *table, uint32_t *pId)
+{
+    uint32_t id = table->nodeNum;
+
+    if (id == UINT32_MAX) {
+        PrErr("too many nodes\n");
+        CplExit(-1);
+    }
+    if ((id >> ATREE_PAGE_SHIFT) == table->pageNum) {
+        table->pageArr = ATreeArrReserve(table->pageArr, sizeof (*table->pageArr),
+                                         table->pageNum, 1, &table->pageSize);
+        table->pageArr[table->pageNum++] = ATreeMAlloc(ctx, (size_t)table->nodeSize << ATREE_PAGE_SHIFT);
+    }
+    table->nodeNum++;
+    *pId = id;
+    return (char *)table->pageArr[id >> ATREE_PAGE_SHIFT] + (size_t)(id & ATREE_PAGE_MASK) * table->nodeSize;
+}
+
+/*
+ * 功能：在正在归约的序列末尾追加节点下标。序列不在openArr的栈顶时（错误恢复丢弃了内层的序列），
+ *      先把序列复制到栈顶。
+ * pFirst：输入输出型参数，序列在openArr中的开始位置
+ * num：序列已有的元素个数
+ * 返回值：
+ **/
+static void ATreeSeqPush(Bison *ctx, uint32_t *pFirst, uint32_t num, uint32_t id)
+{
+    ATree *tree = ctx->tree;
+
+    if (*pFirst + num != tree->openNum) {
+        tree->openArr = ATreeArrReserve(tree->openArr, sizeof (*tree->openArr),
+                                        tree->openNum, num, &tree->openSize);
+        memcpy(tree->openArr + tree->openNum, tree->openArr + *pFirst, num * sizeof (*tree->openArr));
+        *pFirst = tree->openNum;
+        tree->openNum += num;
+    }
+    tree->openArr = ATreeArrReserve(tree->openArr, sizeof (*tree->openArr),
+                                    tree->openNum, 1, &tree->openSize);
+    tree->openArr[tree->openNum++] = id;
+}
+
+/*
+ * 功能：结束序列的归约，把序列从openArr移到seqArr。
+ * first：序列在openArr中的开始位置
+ * 返回值：序列在seqArr中的开始位置
+ **/
+static uint32_t ATreeSeqClose(Bison *ctx, uint32_t first, uint32_t num)
+{
+    ATree *tree = ctx->tree;
+    uint32_t seqFirst;
+
+    tree->seqArr = ATreeArrReserve(tree->seqArr, sizeof (*tree->seqArr),
+                                   tree->seqNum, num, &tree->seqSize);
+    if (num)
+        memcpy(tree->seqArr + tree->seqNum, tree->openArr + first, num * sizeof (*tree->seqArr));
+    if (first + num == tree->openNum)
+        tree->openNum = first;
+    seqFirst = tree->seqNum;
+    tree->seqNum += num;
+    return seqFirst;
+}
+
+/*
+ * 功能：结束语句序列的归约，stmts为空时返回空序列。
+ * 返回值：归约完成的语句序列
+ **/
+static Stmts ATreeCloseStmts(Bison *ctx, Stmts *stmts)
+{
+    Stmts closed = {0, 0};
+
+    if (stmts) {
+        closed.first = ATreeSeqClose(ctx, stmts->first, stmts->num);
+        closed.num = stmts->num;
+    }
+    return closed;
+}
+
+
 /*
  * 功能：创建数组解引用时的维度数据结构。
  * 返回值：
  **/
-AEDims *ATreeNewAEDims(Type *type, Expr *idx, AEDims *nextDims)
+AEDims *ATreeNewAEDims(Bison *ctx, Type *type, Expr *idx, AEDims *nextDims)
 {
     AEDims *dims;
 
-    dims = ATreeMAlloc(sizeof (*dims));
+    dims = ATreeMAlloc(ctx, sizeof (*dims));
     dims->type = type;
-    dims->idx = idx;
+    dims->idx = ATREE_ID(idx);
     dims->nextDims = nextDims;
     return dims;
 }
@@ -57,22 +251,18 @@ AEDims *ATreeNewAEDims(Type *type, Expr *idx, AEDims *nextDims)
  **/
 void ATreeFreeAEDims(AEDims *dims)
 {
-    if (!dims)
-        return;
-    ATreeFreeAEDims(dims->nextDims);
-    ATreeFreeType(dims->type);
-    CplFree(dims);
+    (void)dims;
 }
 
 /*
  * 功能：创建左值。
  * 返回值：
  **/
-LValue *ATreeNewLValue(Type *type, const Token *id, AEDims *dims)
+LValue *ATreeNewLValue(Bison *ctx, Type *type, const Token *id, AEDims *dims)
 {
     LValue *lValue;
 
-    lValue = ATreeMAlloc(sizeof (*lValue));
+    lValue = ATreeMAlloc(ctx, sizeof (*lValue));
     lValue->type = type;
     lValue->id = id;
     lValue->dims = dims;
@@ -85,23 +275,21 @@ LValue *ATreeNewLValue(Type *type, const Token *id, AEDims *dims)
  **/
 void ATreeFreeLValue(LValue *lValue)
 {
-    if (!lValue)
-        return;
-    ATreeFreeType(lValue->type);
-    ATreeFreeAEDims(lValue->dims);
-    CplFree(lValue);
+    (void)lValue;
 }
 
 /*
  * 功能：分配表达式
  * 返回值：
  **/
-static Expr *ATreeAllocExpr(ExprType type)
+static Expr *ATreeAllocExpr(Bison *ctx, ExprType type)
 {
     Expr *expr;
+    ExprId id;
 
-    expr = ATreeMAlloc(sizeof (*expr));
+    expr = ATreeTableAlloc(ctx, &ctx->tree->exprTable, &id);
     expr->type = type;
+    expr->nodeId = id;
     return expr;
 }
 
@@ -109,11 +297,11 @@ static Expr *ATreeAllocExpr(ExprType type)
  * 功能：新建id表达式
  * 返回值：
  */
-Expr *ATreeNewIdExpr(Domain *domain, const Token *token, Type *type)
+Expr *ATreeNewIdExpr(Bison *ctx, Domain *domain, const Token *token, Type *type)
 {
     Expr *newExpr;
 
-    newExpr = ATreeAllocExpr(ET_ID);
+    newExpr = ATreeAllocExpr(ctx, ET_ID);
     newExpr->domain = domain;
     newExpr->id.token = token;
     newExpr->id.type = type;
@@ -124,13 +312,13 @@ Expr *ATreeNewIdExpr(Domain *domain, const Token *token, Type *type)
  * 功能：新建访问元素表达式
  * 返回值：
  */
-Expr *ATreeNewAccessElmExpr(Domain *domain, Expr *baseExpr, AEDims *dims, Type *type)
+Expr *ATreeNewAccessElmExpr(Bison *ctx, Domain *domain, Expr *baseExpr, AEDims *dims, Type *type)
 {
     Expr *newExpr;
 
-    newExpr = ATreeAllocExpr(ET_ACCESS_ELM);
+    newExpr = ATreeAllocExpr(ctx, ET_ACCESS_ELM);
     newExpr->domain = domain;
-    newExpr->accessElm.base = baseExpr;
+    newExpr->accessElm.base = ATREE_ID(baseExpr);
     newExpr->accessElm.dims = dims;
     newExpr->accessElm.type = type;
     return newExpr;
@@ -140,15 +328,15 @@ Expr *ATreeNewAccessElmExpr(Domain *domain, Expr *baseExpr, AEDims *dims, Type *
  * 功能：新建二目运算符表达式。
  * 返回值：
  **/
-Expr *ATreeNewBinExpr(Domain *domain, ExprType exprtype, Type *type, Expr *lExpr, Expr *rExpr)
+Expr *ATreeNewBinExpr(Bison *ctx, Domain *domain, ExprType exprtype, Type *type, Expr *lExpr, Expr *rExpr)
 {
     Expr *newExpr;
 
-    newExpr = ATreeAllocExpr(exprtype);
+    newExpr = ATreeAllocExpr(ctx, exprtype);
     newExpr->domain = domain;
     newExpr->binOp.type = type;
-    newExpr->binOp.lExpr = lExpr;
-    newExpr->binOp.rExpr = rExpr;
+    newExpr->binOp.lExpr = ATREE_ID(lExpr);
+    newExpr->binOp.rExpr = ATREE_ID(rExpr);
     return newExpr;
 }
 
@@ -160,26 +348,21 @@ void ATreeFreeExpr(Expr *expr);
  **/
 void ATreeFreeBinExpr(Expr *expr)
 {
-    if (!expr)
-        return;
-    ATreeFreeType(expr->binOp.type);
-    ATreeFreeExpr(expr->binOp.lExpr);
-    ATreeFreeExpr(expr->binOp.rExpr);
-    CplFree(expr);
+    (void)expr;
 }
 
 /*
  * 功能：新建单目运算符表达式
  * 返回值：
  **/
-Expr *ATreeNewUnaryExpr(Domain *domain, ExprType exprType, Type *type, Expr *expr)
+Expr *ATreeNewUnaryExpr(Bison *ctx, Domain *domain, ExprType exprType, Type *type, Expr *expr)
 {
     Expr *newExpr;
 
-    newExpr = ATreeAllocExpr(exprType);
+    newExpr = ATreeAllocExpr(ctx, exprType);
     newExpr->domain = domain;
     newExpr->unaryOp.type = type;
-    newExpr->unaryOp.expr = expr;
+    newExpr->unaryOp.expr = ATREE_ID(expr);
     return newExpr;
 }
 
@@ -189,22 +372,18 @@ Expr *ATreeNewUnaryExpr(Domain *domain, ExprType exprType, Type *type, Expr *exp
  **/
 void ATreeFreeUnaryExpr(Expr *expr)
 {
-    if (!expr)
-        return;
-    ATreeFreeType(expr->unaryOp.type);
-    ATreeFreeExpr(expr->unaryOp.expr);
-    CplFree(expr);
+    (void)expr;
 }
 
 /*
  * 功能：新建常量值表达式
  * 返回值：
  **/
-Expr *ATreeNewCValueExpr(Domain *domain, CValueType type, const Token *token)
+Expr *ATreeNewCValueExpr(Bison *ctx, Domain *domain, CValueType type, const Token *token)
 {
     Expr *newExpr;
 
-    newExpr = ATreeAllocExpr(ET_CONST);
+    newExpr = ATreeAllocExpr(ctx, ET_CONST);
     newExpr->domain = domain;
     newExpr->cValue.type = type;
     newExpr->cValue.token = token;
@@ -215,11 +394,11 @@ Expr *ATreeNewCValueExpr(Domain *domain, CValueType type, const Token *token)
  * 功能：新建常量值表达式
  * 返回值：
  **/
-Expr *ATreeNewCValueSpcIntExpr(Domain *domain, int iValue)
+Expr *ATreeNewCValueSpcIntExpr(Bison *ctx, Domain *domain, int iValue)
 {
     Expr *newExpr;
 
-    newExpr = ATreeAllocExpr(ET_CONST_SPC);
+    newExpr = ATreeAllocExpr(ctx, ET_CONST_SPC);
     newExpr->domain = domain;
     newExpr->cValueSpc.type = CVTS_IDIGIT;
     newExpr->cValueSpc.iValue = iValue;
@@ -230,11 +409,11 @@ Expr *ATreeNewCValueSpcIntExpr(Domain *domain, int iValue)
  * 功能：新建常量值表达式
  * 返回值：
  **/
-Expr *ATreeNewCValueSpcFloatExpr(Domain *domain, float fValue)
+Expr *ATreeNewCValueSpcFloatExpr(Bison *ctx, Domain *domain, float fValue)
 {
     Expr *newExpr;
 
-    newExpr = ATreeAllocExpr(ET_CONST_SPC);
+    newExpr = ATreeAllocExpr(ctx, ET_CONST_SPC);
     newExpr->domain = domain;
     newExpr->cValueSpc.type = CVTS_FDIGIT;
     newExpr->cValueSpc.fValue = fValue;
@@ -245,11 +424,11 @@ Expr *ATreeNewCValueSpcFloatExpr(Domain *domain, float fValue)
  * 功能：新建常量值表达式
  * 返回值：
  **/
-Expr *ATreeNewCValueSpcBoolExpr(Domain *domain, CValueSpcType type)
+Expr *ATreeNewCValueSpcBoolExpr(Bison *ctx, Domain *domain, CValueSpcType type)
 {
     Expr *newExpr;
 
-    newExpr = ATreeAllocExpr(ET_CONST_SPC);
+    newExpr = ATreeAllocExpr(ctx, ET_CONST_SPC);
     newExpr->domain = domain;
     newExpr->cValueSpc.type = type;
     return newExpr;
@@ -261,49 +440,45 @@ Expr *ATreeNewCValueSpcBoolExpr(Domain *domain, CValueSpcType type)
  **/
 void ATreeFreeCValueExpr(Expr *expr)
 {
-    CplFree(expr);
+    (void)expr;
 }
 
 /*
  * 功能：新建临时量表达式
  * 返回值：
  **/
-Expr *ATreeNewTemp(Domain *domain, Type *type)
+Expr *ATreeNewTemp(Bison *ctx, Domain *domain, Type *type)
 {
     Expr *expr;
-    static size_t num = 1;
 
-    expr = ATreeMAlloc(sizeof (*expr));
-    expr->type = ET_TEMP;
+    expr = ATreeAllocExpr(ctx, ET_TEMP);
     expr->domain = domain;
     expr->temp.type = type;
-    expr->temp.num = num++;
+    expr->temp.num = ctx->tempNum++;
     expr->temp.offsetFlag = 0;
     expr->temp.offset = 0;
     return expr;
 }
 
-Expr *ATreeNewAccessMem(Domain *domain, AccessMbrType type, Expr *base, const Token *memId, Type *memType, Expr *offset)
+Expr *ATreeNewAccessMem(Bison *ctx, Domain *domain, AccessMbrType type, Expr *base, const Token *memId, Type *memType, Expr *offset)
 {
     Expr *expr;
-    expr = ATreeMAlloc(sizeof (*expr));
+    expr = ATreeAllocExpr(ctx, ET_ACCESS_MBR);
     expr->domain = domain;
-    expr->type = ET_ACCESS_MBR;
     expr->accessMbr.type = type;
-    expr->accessMbr.base = base;
+    expr->accessMbr.base = ATREE_ID(base);
     expr->accessMbr.memId = memId;
     expr->accessMbr.memtype = memType;
-    expr->accessMbr.memOffset = offset;
+    expr->accessMbr.memOffset = ATREE_ID(offset);
     return expr;
 }
 
-Expr *ATreeNewFunRefExpr(Domain *domain, FunRef *funRef)
+Expr *ATreeNewFunRefExpr(Bison *ctx, Domain *domain, FunRef *funRef)
 {
     Expr *expr;
 
-    expr = ATreeMAlloc(sizeof (*expr));
+    expr = ATreeAllocExpr(ctx, ET_FUN_REF);
     expr->domain = domain;
-    expr->type = ET_FUN_REF;
     expr->funRef = funRef;
     return expr;
 }
@@ -314,10 +489,7 @@ Expr *ATreeNewFunRefExpr(Domain *domain, FunRef *funRef)
  **/
 void ATreeFreeTemp(Expr *expr)
 {
-    if (!expr)
-        return;
-    ATreeFreeType(expr->temp.type);
-    CplFree(expr);
+    (void)expr;
 }
 
 /*
@@ -362,7 +534,7 @@ void ATreeFreeExpr(Expr *expr)
  * 功能：判断表达式类型。
  * 返回值：
  **/
-Type *ATreeExprType(Expr *expr)
+Type *ATreeExprType(Bison *ctx, Expr *expr)
 {
     switch (expr->type) {
     case ET_ASSIGN:
@@ -384,16 +556,16 @@ Type *ATreeExprType(Expr *expr)
         return expr->unaryOp.type;
     case ET_CONST:
         if (expr->cValue.type == CVT_IDIGIT) {
-            return bison->env->intType;
+            return ctx->env->intType;
         } else if (expr->cValue.type == CVT_FDIGIT) {
-            return bison->env->floatType;
+            return ctx->env->floatType;
         } else if (expr->cValue.type == CVT_TRUE) {
-            return bison->env->boolType;
+            return ctx->env->boolType;
         } else if (expr->cValue.type == CVT_FALSE) {
-            return bison->env->boolType;
+            return ctx->env->boolType;
         } else {
             PrErr("unknown type");
-            exit(-1);
+            CplExit(-1);
         }
     case ET_TEMP:
         return expr->temp.type;
@@ -405,16 +577,16 @@ Type *ATreeExprType(Expr *expr)
         }
     case ET_CONST_SPC:
         if (expr->cValueSpc.type == CVTS_IDIGIT) {
-            return bison->env->intType;
+            return ctx->env->intType;
         } else if (expr->cValueSpc.type == CVTS_FDIGIT) {
-            return bison->env->floatType;
+            return ctx->env->floatType;
         } else if (expr->cValueSpc.type == CVTS_TRUE) {
-            return bison->env->boolType;
+            return ctx->env->boolType;
         } else if (expr->cValueSpc.type == CVTS_FALSE) {
-            return bison->env->boolType;
+            return ctx->env->boolType;
         } else {
             PrErr("unknown type");
-            exit(-1);
+            CplExit(-1);
         }
     case ET_ACCESS_MBR:
         return expr->accessMbr.memtype;
@@ -430,19 +602,21 @@ Type *ATreeExprType(Expr *expr)
         return expr->accessElm.type;
     }
     PrErr("expression type error");
-    exit(-1);
+    CplExit(-1);
 }
 
 /*
  * 功能：分配语句
  * 返回值：
  **/
-static inline Stmt *ATreeAllocStmt(StmtType type)
+static inline Stmt *ATreeAllocStmt(Bison *ctx, StmtType type)
 {
     Stmt *stmt;
+    StmtId id;
 
-    stmt = ATreeMAlloc(sizeof (*stmt));
+    stmt = ATreeTableAlloc(ctx, &ctx->tree->stmtTable, &id);
     stmt->type = type;
+    stmt->nodeId = id;
     return stmt;
 }
 
@@ -450,13 +624,13 @@ static inline Stmt *ATreeAllocStmt(StmtType type)
  * 功能：新建表达式语句。
  * 返回值：
  **/
-Stmt *ATreeNewExprStmt(Domain *domain, Expr *expr)
+Stmt *ATreeNewExprStmt(Bison *ctx, Domain *domain, Expr *expr)
 {
     Stmt *stmt;
 
-    stmt = ATreeAllocStmt(ST_EXPR);
+    stmt = ATreeAllocStmt(ctx, ST_EXPR);
     stmt->domain = domain;
-    stmt->exprStmt.expr = expr;
+    stmt->exprStmt.expr = ATREE_ID(expr);
     return stmt;
 }
 
@@ -464,14 +638,14 @@ Stmt *ATreeNewExprStmt(Domain *domain, Expr *expr)
  * 功能：新建if语句
  * 返回值：
  **/
-Stmt *ATreeNewIfStmt(Domain *domain, Cond *cond, Stmt *stmt)
+Stmt *ATreeNewIfStmt(Bison *ctx, Domain *domain, Cond *cond, Stmt *stmt)
 {
     Stmt *newStmt;
 
-    newStmt = ATreeAllocStmt(ST_IF);
+    newStmt = ATreeAllocStmt(ctx, ST_IF);
     newStmt->domain = domain;
-    newStmt->ifStmt.cond = cond;
-    newStmt->ifStmt.stmt = stmt;
+    newStmt->ifStmt.cond = ATREE_ID(cond);
+    newStmt->ifStmt.stmt = ATREE_ID(stmt);
     return newStmt;
 }
 
@@ -479,15 +653,15 @@ Stmt *ATreeNewIfStmt(Domain *domain, Cond *cond, Stmt *stmt)
  * 功能：新建if else语句
  * 返回值：
  **/
-Stmt *ATreeNewElseStmt(Domain *domain, Cond *cond, Stmt *ifStmt, Stmt *elseStmt)
+Stmt *ATreeNewElseStmt(Bison *ctx, Domain *domain, Cond *cond, Stmt *ifStmt, Stmt *elseStmt)
 {
     Stmt *newStmt;
 
-    newStmt = ATreeAllocStmt(ST_ELSE);
+    newStmt = ATreeAllocStmt(ctx, ST_ELSE);
     newStmt->domain = domain;
-    newStmt->elseStmt.cond = cond;
-    newStmt->elseStmt.ifStmt = ifStmt;
-    newStmt->elseStmt.elseStmt = elseStmt;
+    newStmt->elseStmt.cond = ATREE_ID(cond);
+    newStmt->elseStmt.ifStmt = ATREE_ID(ifStmt);
+    newStmt->elseStmt.elseStmt = ATREE_ID(elseStmt);
     return newStmt;
 }
 
@@ -495,14 +669,14 @@ Stmt *ATreeNewElseStmt(Domain *domain, Cond *cond, Stmt *ifStmt, Stmt *elseStmt)
  * 功能：新建while语句
  * 返回值：
  **/
-Stmt *ATreeNewWhileStmt(Domain *domain, Cond *cond, Stmt *stmt)
+Stmt *ATreeNewWhileStmt(Bison *ctx, Domain *domain, Cond *cond, Stmt *stmt)
 {
     Stmt *newStmt;
 
-    newStmt = ATreeAllocStmt(ST_WHILE);
+    newStmt = ATreeAllocStmt(ctx, ST_WHILE);
     newStmt->domain = domain;
-    newStmt->whileStmt.cond = cond;
-    newStmt->whileStmt.stmt = stmt;
+    newStmt->whileStmt.cond = ATREE_ID(cond);
+    newStmt->whileStmt.stmt = ATREE_ID(stmt);
     newStmt->whileStmt.breakList = BPAllocInsList();
     newStmt->whileStmt.continueList = BPAllocInsList();
     return newStmt;
@@ -512,30 +686,30 @@ Stmt *ATreeNewWhileStmt(Domain *domain, Cond *cond, Stmt *stmt)
  * 功能：新建do while 语句
  * 返回值：
  **/
-Stmt *ATreeNewDoStmt(Domain *domain, Cond *cond, Stmt *stmt)
+Stmt *ATreeNewDoStmt(Bison *ctx, Domain *domain, Cond *cond, Stmt *stmt)
 {
     Stmt *newStmt;
 
-    newStmt = ATreeAllocStmt(ST_DO);
+    newStmt = ATreeAllocStmt(ctx, ST_DO);
     newStmt->domain = domain;
-    newStmt->doStmt.cond = cond;
-    newStmt->doStmt.stmt = stmt;
+    newStmt->doStmt.cond = ATREE_ID(cond);
+    newStmt->doStmt.stmt = ATREE_ID(stmt);
     newStmt->doStmt.breakList = BPAllocInsList();
     newStmt->doStmt.continueList = BPAllocInsList();
     return newStmt;
 }
 
 /*
- * 功能：新建块语句
+ * 功能：新建块语句，结束语句序列的归约
  * 返回值：
  **/
-Stmt *ATreeNewBlockStmt(Domain *domain, Stmts *stmts)
+Stmt *ATreeNewBlockStmt(Bison *ctx, Domain *domain, Stmts *stmts)
 {
     Stmt *newStmt;
 
-    newStmt = ATreeAllocStmt(ST_BLOCK);
+    newStmt = ATreeAllocStmt(ctx, ST_BLOCK);
     newStmt->domain = domain;
-    newStmt->blockStmt.stmts = stmts;
+    newStmt->blockStmt.stmts = ATreeCloseStmts(ctx, stmts);
     return newStmt;
 }
 
@@ -543,11 +717,11 @@ Stmt *ATreeNewBlockStmt(Domain *domain, Stmts *stmts)
  * 功能：新建break语句
  * 返回值：
  **/
-Stmt *ATreeNewBreakStmt(Domain *domain, size_t after)
+Stmt *ATreeNewBreakStmt(Bison *ctx, Domain *domain, size_t after)
 {
     Stmt *newStmt;
 
-    newStmt = ATreeAllocStmt(ST_BREAK);
+    newStmt = ATreeAllocStmt(ctx, ST_BREAK);
     newStmt->domain = domain;
     newStmt->breakStmt.lastLevelAfter = after;
     return newStmt;
@@ -557,88 +731,120 @@ Stmt *ATreeNewBreakStmt(Domain *domain, size_t after)
  * 功能：新建continue语句
  * 返回值：
  **/
-Stmt *ATreeNewContinueStmt(Domain *domain, size_t begin)
+Stmt *ATreeNewContinueStmt(Bison *ctx, Domain *domain, size_t begin)
 {
     Stmt *newStmt;
 
-    newStmt = ATreeAllocStmt(ST_CONTINUE);
+    newStmt = ATreeAllocStmt(ctx, ST_CONTINUE);
     newStmt->domain = domain;
     newStmt->continueStmt.lastLevelBegin = begin;
     return newStmt;
 }
 
-Stmt *ATreeNewReturnVoidStmt(Domain *domain)
+Stmt *ATreeNewReturnVoidStmt(Bison *ctx, Domain *domain)
 {
     Stmt *newStmt;
 
-    newStmt = ATreeAllocStmt(ST_RETURN_VOID);
+    newStmt = ATreeAllocStmt(ctx, ST_RETURN_VOID);
     newStmt->domain = domain;
     return newStmt;
 }
 
-Stmt *ATreeNewReturnValueStmt(Domain *domain, Expr *expr)
+Stmt *ATreeNewReturnValueStmt(Bison *ctx, Domain *domain, Expr *expr)
 {
     Stmt *newStmt;
 
-    newStmt = ATreeAllocStmt(ST_RETURN_VALUE);
+    newStmt = ATreeAllocStmt(ctx, ST_RETURN_VALUE);
     newStmt->domain = domain;
-    newStmt->returnStmt.expr = expr;
+    newStmt->returnStmt.expr = ATREE_ID(expr);
     return newStmt;
 }
 
-CaseStmt *ATreeNewCaseExprStmt(Expr *expr, Stmts *stmts)
+/*
+ * 功能：分配case语句
+ * 返回值：
+ **/
+static CaseStmt *ATreeAllocCaseStmt(Bison *ctx, CaseStmtType type)
 {
     CaseStmt *caseStmt;
+    CaseStmtId id;
 
-    caseStmt = ATreeMAlloc(sizeof (*caseStmt));
-    caseStmt->type = CST_CASE_EXPR;
-    caseStmt->caseExpr.expr = expr;
-    caseStmt->caseExpr.stmts = stmts;
+    caseStmt = ATreeTableAlloc(ctx, &ctx->tree->caseStmtTable, &id);
+    caseStmt->type = type;
+    caseStmt->nodeId = id;
     return caseStmt;
 }
 
-CaseStmt *ATreeNewCaseDefaultStmt(Stmts *stmts)
+CaseStmt *ATreeNewCaseExprStmt(Bison *ctx, Expr *expr, Stmts *stmts)
 {
     CaseStmt *caseStmt;
 
-    caseStmt = ATreeMAlloc(sizeof (*caseStmt));
-    caseStmt->type = CST_CASE_DEFAULT;
-    caseStmt->stmts = stmts;
+    caseStmt = ATreeAllocCaseStmt(ctx, CST_CASE_EXPR);
+    caseStmt->caseExpr.expr = ATREE_ID(expr);
+    caseStmt->caseExpr.stmts = ATreeCloseStmts(ctx, stmts);
     return caseStmt;
 }
 
-CaseStmts *ATreeNewCaseStmts(CaseStmts *prev, CaseStmt *caseStmt)
+CaseStmt *ATreeNewCaseDefaultStmt(Bison *ctx, Stmts *stmts)
 {
-    CaseStmts *newCaseStmts;
+    CaseStmt *caseStmt;
 
-    newCaseStmts = ATreeMAlloc(sizeof (*newCaseStmts));
-    newCaseStmts->prev = prev;
-    newCaseStmts->caseStmt = caseStmt;
-    return newCaseStmts;
+    caseStmt = ATreeAllocCaseStmt(ctx, CST_CASE_DEFAULT);
+    caseStmt->stmts = ATreeCloseStmts(ctx, stmts);
+    return caseStmt;
+}
+
+/*
+ * 功能：在case语句序列末尾追加case语句，prev为空时新建序列。
+ * 返回值：正在归约的case语句序列
+ **/
+CaseStmts *ATreeNewCaseStmts(Bison *ctx, CaseStmts *prev, CaseStmt *caseStmt)
+{
+    CaseStmts *caseStmts = prev;
+
+    if (!caseStmts) {
+        caseStmts = ATreeMAlloc(ctx, sizeof (*caseStmts));
+        caseStmts->first = ctx->tree->openNum;
+        caseStmts->num = 0;
+    }
+    ATreeSeqPush(ctx, &caseStmts->first, caseStmts->num, ATREE_ID(caseStmt));
+    caseStmts->num++;
+    return caseStmts;
 }
 
-Stmt *ATreeNewSwitchStmt(Expr *expr, CaseStmts *caseStmts)
+/*
+ * 功能：新建switch语句，结束case语句序列的归约
+ * 返回值：
+ **/
+Stmt *ATreeNewSwitchStmt(Bison *ctx, Expr *expr, CaseStmts *caseStmts)
 {
     Stmt *newStmt;
 
-    newStmt = ATreeAllocStmt(ST_SWITCH);
-    newStmt->switchStmt.expr = expr;
-    newStmt->switchStmt.caseStmts = caseStmts;
+    newStmt = ATreeAllocStmt(ctx, ST_SWITCH);
+    newStmt->switchStmt.expr = ATREE_ID(expr);
+    newStmt->switchStmt.caseStmts.first = 0;
+    newStmt->switchStmt.caseStmts.num = 0;
+    if (caseStmts) {
+        newStmt->switchStmt.caseStmts.first = ATreeSeqClose(ctx, caseStmts->first, caseStmts->num);
+        newStmt->switchStmt.caseStmts.num = caseStmts->num;
+    }
     newStmt->switchStmt.breakList = BPAllocInsList();
     return newStmt;
 }
 
 /*
- * 功能：新建语句序列
- * 返回值：
+ * 功能：在语句序列末尾追加语句，stmts为空时新建语句序列。
+ * 返回值：正在归约的语句序列
  **/
-Stmts *ATreeNewStmts(Stmts *prevStmts, Stmt *stmt)
+Stmts *ATreeNewStmts(Bison *ctx, Stmts *stmts, Stmt *stmt)
 {
-    Stmts *stmts;
-
-    stmts = ATreeMAlloc(sizeof (*stmts));
-    stmts->prevStmts = prevStmts;
-    stmts->stmt = stmt;
+    if (!stmts) {
+        stmts = ATreeMAlloc(ctx, sizeof (*stmts));
+        stmts->first = ctx->tree->openNum;
+        stmts->num = 0;
+    }
+    ATreeSeqPush(ctx, &stmts->first, stmts->num, ATREE_ID(stmt));
+    stmts->num++;
     return stmts;
 }
 
@@ -646,12 +852,13 @@ Stmts *ATreeNewStmts(Stmts *prevStmts, Stmt *stmt)
  * 功能：分配类型
  * 返回值：
  **/
-static inline Type *ATreeAllocType(TypeType type)
+static inline Type *ATreeAllocType(Bison *ctx, TypeType type)
 {
     Type *newType;
 
-    newType = ATreeMAlloc(sizeof (*newType));
+    newType = ATreeMAlloc(ctx, sizeof (*newType));
     newType->type = type;
+    INIT_LIST_HEAD(&newType->hashNode);
     return newType;
 }
 
@@ -659,11 +866,11 @@ static inline Type *ATreeAllocType(TypeType type)
  * 功能：新建基本类型。
  * 返回值：
  **/
-Type *ATreeNewBaseType(BaseTypeType type, size_t size, AlignType alignType)
+Type *ATreeNewBaseType(Bison *ctx, BaseTypeType type, size_t size, AlignType alignType)
 {
     Type *newType;
 
-    newType = ATreeAllocType(TT_BASE);
+    newType = ATreeAllocType(ctx, TT_BASE);
     newType->baseType.type = type;
     newType->size = size;
     newType->alignType = alignType;
@@ -676,7 +883,7 @@ Type *ATreeNewBaseType(BaseTypeType type, size_t size, AlignType alignType)
  **/
 void ATreeFreeBaseType(Type *type)
 {
-    CplFree(type);
+    (void)type;
 }
 
 /*
@@ -687,7 +894,7 @@ size_t ATreeTypeSize(const Type *type)
 {
     if (!type) {
         PrErr("type error invalid param: %p", type);
-        exit(-1);
+        CplExit(-1);
     }
     switch (type->type) {
     case TT_BASE:
@@ -698,23 +905,152 @@ size_t ATreeTypeSize(const Type *type)
         return type->size;
     default:
         PrErr("type->type error: %d", type->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
 /*
- * 功能：新建数组类型
+ * 功能：初始化类型驻留表，散列表在第一次驻留类型时创建。
+ * 返回值：
+ **/
+void ATreeTypeTableInit(TypeTable *table)
+{
+    table->hashTable = NULL;
+    table->hashSize = 0;
+    table->typeNum = 0;
+}
+
+/*
+ * 功能：释放类型驻留表，类型本身在编译单元的区域分配器中。
+ * 返回值：
+ **/
+void ATreeTypeTableFree(TypeTable *table)
+{
+    CplFree(table->hashTable);
+    ATreeTypeTableInit(table);
+}
+
+/*
+ * 功能：计算数组或者指针类型的散列值，subType是元素类型或者指向的类型，指针类型的count为0。
+ * 返回值：散列值
+ **/
+static inline unsigned int ATreeTypeHash(TypeType type, const Type *subType, size_t count)
+{
+    unsigned int hash;
+
+    hash = (unsigned int)((uintptr_t)subType >> 3) * 2654435761u;
+    hash ^= (unsigned int)count * 40503u + (unsigned int)type;
+    return hash ^ (hash >> 16);
+}
+
+static inline unsigned int ATreeTypeHashOf(const Type *type)
+{
+    if (type->type == TT_ARRAY)
+        return ATreeTypeHash(TT_ARRAY, type->array.type, type->array.count);
+    return ATreeTypeHash(TT_POINTER, type->pointer.type, 0);
+}
+
+/*
+ * 功能：散列表的桶数不够时扩大为原来的2倍，重新散列所有类型。
  * 返回值：
  **/
-Type *ATreeNewArrayType(Type *elementType, size_t count, AlignType alignType)
+static void ATreeTypeTableGrow(TypeTable *table)
 {
+    struct list_head *hashTable;
+    unsigned int size;
+    unsigned int i;
+    struct list_head *pos;
+    Type *type;
+
+    size = table->hashSize ? table->hashSize * 2 : 64;
+    hashTable = CplAlloc(size * sizeof (*hashTable));
+    if (!hashTable) {
+        PrErr("no memory\n");
+        CplExit(-1);
+    }
+    for (i = 0; i < size; i++)
+        INIT_LIST_HEAD(&hashTable[i]);
+    for (i = 0; i < table->hashSize; i++) {
+        for (pos = table->hashTable[i].next; pos != &table->hashTable[i]; ) {
+            type = container_of(pos, Type, hashNode);
+            pos = pos->next;
+            list_add_tail(&type->hashNode, &hashTable[ATreeTypeHashOf(type) & (size - 1)]);
+        }
+    }
+    CplFree(table->hashTable);
+    table->hashTable = hashTable;
+    table->hashSize = size;
+}
+
+/*
+ * 功能：在类型驻留表中查找结构相同的数组或者指针类型。
+ * 返回值：找到时返回驻留的类型，否则返回NULL。
+ **/
+static Type *ATreeTypeTableFind(const TypeTable *table, TypeType typeType, const Type *subType,
+                                size_t count, AlignType alignType, unsigned int hash)
+{
+    struct list_head *bucket;
+    struct list_head *pos;
+    Type *type;
+
+    if (!table->hashTable)
+        return NULL;
+    bucket = &table->hashTable[hash & (table->hashSize - 1)];
+    list_for_each(pos, bucket) {
+        type = container_of(pos, Type, hashNode);
+        if (type->type != typeType)
+            continue;
+        if (typeType == TT_ARRAY) {
+            if (type->array.type == subType && type->array.count == count
+                    && type->alignType == alignType)
+                return type;
+        } else if (type->pointer.type == subType) {
+            return type;
+        }
+    }
+    return NULL;
+}
+
+static void ATreeTypeTableAdd(TypeTable *table, Type *type, unsigned int hash)
+{
+    if (table->typeNum >= table->hashSize)
+        ATreeTypeTableGrow(table);
+    list_add_tail(&type->hashNode, &table->hashTable[hash & (table->hashSize - 1)]);
+    table->typeNum++;
+}
+
+/*
+ * 功能：获取当前编译单元的类型驻留表，环境还没有建立时返回NULL，这时不驻留类型。
+ * 返回值：
+ **/
+static inline TypeTable *ATreeTypeTable(Bison *ctx)
+{
+    return ctx->env ? &ctx->env->typeTable : NULL;
+}
+
+/*
+ * 功能：新建数组类型，结构相同的数组类型返回同一个Type。
+ * 返回值：
+ **/
+Type *ATreeNewArrayType(Bison *ctx, Type *elementType, size_t count, AlignType alignType)
+{
+    TypeTable *table = ATreeTypeTable(ctx);
+    unsigned int hash;
     Type *newType;
 
-    newType = ATreeAllocType(TT_ARRAY);
+    hash = ATreeTypeHash(TT_ARRAY, elementType, count);
+    if (table) {
+        newType = ATreeTypeTableFind(table, TT_ARRAY, elementType, count, alignType, hash);
+        if (newType)
+            return newType;
+    }
+    newType = ATreeAllocType(ctx, TT_ARRAY);
     newType->array.type = elementType;
     newType->array.count = count;
     newType->size = ATreeTypeSize(elementType) * count;
     newType->alignType = alignType;
+    if (table)
+        ATreeTypeTableAdd(table, newType, hash);
     return newType;
 }
 
@@ -722,11 +1058,11 @@ Type *ATreeNewArrayType(Type *elementType, size_t count, AlignType alignType)
  * 功能：新建结构体类型
  * 返回值：
  **/
-Type *ATreeNewStructType(Domain *domain, AlignType alignType, size_t size)
+Type *ATreeNewStructType(Bison *ctx, Domain *domain, AlignType alignType, size_t size)
 {
     Type *newType;
 
-    newType = ATreeAllocType(TT_STRUCTURE);
+    newType = ATreeAllocType(ctx, TT_STRUCTURE);
     newType->alignType = alignType;
     newType->st.domain = domain;
     newType->size = size;
@@ -734,17 +1070,27 @@ Type *ATreeNewStructType(Domain *domain, AlignType alignType, size_t size)
 }
 
 /*
- * 功能：新建指针类型
+ * 功能：新建指针类型，指向同一个类型的指针类型返回同一个Type。
  * 返回值：
  **/
-Type *ATreeNewPointerType(Type *pointType)
+Type *ATreeNewPointerType(Bison *ctx, Type *pointType)
 {
+    TypeTable *table = ATreeTypeTable(ctx);
+    unsigned int hash;
     Type *newType;
 
-    newType = ATreeAllocType(TT_POINTER);
+    hash = ATreeTypeHash(TT_POINTER, pointType, 0);
+    if (table) {
+        newType = ATreeTypeTableFind(table, TT_POINTER, pointType, 0, AT_4BYTE, hash);
+        if (newType)
+            return newType;
+    }
+    newType = ATreeAllocType(ctx, TT_POINTER);
     newType->alignType = AT_4BYTE;
     newType->pointer.type = pointType;
     newType->size = 4;
+    if (table)
+        ATreeTypeTableAdd(table, newType, hash);
     return newType;
 }
 
@@ -752,11 +1098,11 @@ Type *ATreeNewPointerType(Type *pointType)
  * 功能：新建指针类型
  * 返回值：
  **/
-Type *ATreeNewFunctionType(FunRetType *retType, FunArgs *funArgs)
+Type *ATreeNewFunctionType(Bison *ctx, FunRetType *retType, FunArgs *funArgs)
 {
     Type *newType;
 
-    newType = ATreeAllocType(TT_FUNCTION);
+    newType = ATreeAllocType(ctx, TT_FUNCTION);
     newType->alignType = AT_4BYTE;
     newType->size = 4;
     newType->funType.funArgs = funArgs;
@@ -772,10 +1118,7 @@ Type *ATreeNewFunctionType(FunRetType *retType, FunArgs *funArgs)
  **/
 void ATreeFreeArray(Array *array)
 {
-    if (!array)
-        return;
-    ATreeFreeType(array->type);
-    CplFree(array);
+    (void)array;
 }
 
 /*
@@ -784,36 +1127,16 @@ void ATreeFreeArray(Array *array)
  **/
 void ATreeFreeType(Type *type)
 {
-    if (!type || type->type == TT_BASE)
-        return;
-    ATreeFreeArray(&type->array);
-    CplFree(type);
+    (void)type;
 }
 
-static int ATreeArrayIsEqual(const Array *lArray, const Array *rArray);
-
 /*
- * 功能：判断类型释放相同。
- * 返回值：
+ * 功能：判断类型是否相同。数组和指针类型都经过驻留，所以直接比较指针。
+ * 返回值：相同时返回1，否则返回0。
  **/
-static int ATreeTypeIsEqual(const Type *lType, const Type *rType)
+int ATreeTypeIsEqual(const Type *lType, const Type *rType)
 {
-    if (lType->type == TT_BASE
-            && rType->type == TT_BASE) {
-        return lType == rType;
-    } else {
-        return ATreeArrayIsEqual(&lType->array, &rType->array);
-    }
-}
-
-/*
- * 功能：判断数组类型是否相同。
- * 返回值：
- **/
-static int ATreeArrayIsEqual(const Array *lArray, const Array *rArray)
-{
-    return lArray->count == rArray->count
-            &&ATreeTypeIsEqual(lArray->type, rArray->type);
+    return lType == rType;
 }
 
 /*
@@ -850,39 +1173,39 @@ static Type *ATreeArrayDerefDimsType(const AEDims *dims)
  * 功能：拓宽表达式的类型。
  * 返回值：
  **/
-Type *ATreeExprWiddenType(ExprType exprType, Expr *lExpr, Expr *rExpr)
+Type *ATreeExprWiddenType(Bison *ctx, ExprType exprType, Expr *lExpr, Expr *rExpr)
 {
     Type *lType, *rType;
 
-    lType = ATreeExprType(lExpr);
-    rType = ATreeExprType(rExpr);
+    lType = ATreeExprType(ctx, lExpr);
+    rType = ATreeExprType(ctx, rExpr);
     if (lType->type == TT_BASE
             && rType->type == TT_BASE) {
         if (lType == rType) {
-            if (lType == bison->env->floatType) {
+            if (lType == ctx->env->floatType) {
                 return lType;
             } else {
-                return bison->env->intType;
+                return ctx->env->intType;
             }
         } else {
             if (lType->baseType.type == BTT_FLOAT
                     || rType->baseType.type == BTT_FLOAT) {
-                return bison->env->floatType;
+                return ctx->env->floatType;
             } else if (lType->baseType.type == BTT_INT
                        || rType->baseType.type == BTT_INT) {
-                return bison->env->intType;
+                return ctx->env->intType;
             } else if (lType->baseType.type == BTT_SHORT
                        || rType->baseType.type == BTT_SHORT) {
-                return bison->env->intType;
+                return ctx->env->intType;
             } else if (lType->baseType.type == BTT_CHAR
                        || rType->baseType.type == BTT_CHAR) {
-                return bison->env->intType;
+                return ctx->env->intType;
             } else if (lType->baseType.type == BTT_BOOL
                        || rType->baseType.type == BTT_BOOL) {
-                return bison->env->intType;
+                return ctx->env->intType;
             } else {
                 PrErr("syntax error, type error\n");
-                exit(-1);
+                CplExit(-1);
             }
         }
     } else if (lType->type == TT_POINTER
@@ -893,7 +1216,7 @@ Type *ATreeExprWiddenType(ExprType exprType, Expr *lExpr, Expr *rExpr)
             return lType;
         } else {
             PrErr("exprType error: %d", exprType);
-            exit(-1);
+            CplExit(-1);
         }
     } else {
         PrErr("lType->type error: %d", lType->type);
@@ -902,7 +1225,7 @@ Type *ATreeExprWiddenType(ExprType exprType, Expr *lExpr, Expr *rExpr)
             PrErr("rType->baseType.type error: %d", rType->baseType.type);
         }
         PrErr("syntax error, widden type error\n");
-        exit(-1);
+        CplExit(-1);
     }
     return NULL;
 }
@@ -911,11 +1234,11 @@ Type *ATreeExprWiddenType(ExprType exprType, Expr *lExpr, Expr *rExpr)
  * 功能：新建程序。
  * 返回值：
  **/
-Program *ATreeNewProgram(FunDefines *funDefines)
+Program *ATreeNewProgram(Bison *ctx, FunDefines *funDefines)
 {
     Program *program;
 
-    program = ATreeMAlloc(sizeof (*program));
+    program = ATreeMAlloc(ctx, sizeof (*program));
     program->funDefines = funDefines;
     return program;
 }
@@ -929,52 +1252,52 @@ void ATreeFreeProgram(Program *program)
     (void)program;
 }
 
-FunRetType *ATreeNewFunRetTypeVoid(void)
+FunRetType *ATreeNewFunRetTypeVoid(Bison *ctx)
 {
     FunRetType *funRetType;
 
-    funRetType = ATreeMAlloc(sizeof (*funRetType));
+    funRetType = ATreeMAlloc(ctx, sizeof (*funRetType));
     funRetType->typeType = ERTT_VOID;
     return funRetType;
 }
 
-FunRetType *ATreeNewFunRetType(Type *type)
+FunRetType *ATreeNewFunRetType(Bison *ctx, Type *type)
 {
     FunRetType *funRetType;
 
-    funRetType = ATreeMAlloc(sizeof (*funRetType));
+    funRetType = ATreeMAlloc(ctx, sizeof (*funRetType));
     funRetType->typeType = ERTT_BASE_TYPE;
     funRetType->type = type;
     return funRetType;
 }
 
-FunArg *ATreeNewFunArg(const Token *id, Type *type)
+FunArg *ATreeNewFunArg(Bison *ctx, const Token *id, Type *type)
 {
     FunArg *funArg;
 
-    funArg = ATreeMAlloc(sizeof (*funArg));
+    funArg = ATreeMAlloc(ctx, sizeof (*funArg));
     funArg->type = type;
     funArg->id = id;
     return funArg;
 }
 
-FunArgs *ATreeNewFunArgs(FunArg *funArg, FunArgs *next)
+FunArgs *ATreeNewFunArgs(Bison *ctx, FunArg *funArg, FunArgs *next)
 {
     FunArgs *funArgs;
 
-    funArgs = ATreeMAlloc(sizeof (*funArgs));
+    funArgs = ATreeMAlloc(ctx, sizeof (*funArgs));
     funArgs->funArg = funArg;
     funArgs->next = next;
     return funArgs;
 }
 
-static FunArgs *_ATreeFunArgsReverse(FunArgs *nextFunArgs, FunArgs *funArgs)
+static FunArgs *_ATreeFunArgsReverse(Bison *ctx, FunArgs *nextFunArgs, FunArgs *funArgs)
 {
     FunArgs *newFunArgs;
 
-    newFunArgs = ATreeNewFunArgs(nextFunArgs->funArg, funArgs);
+    newFunArgs = ATreeNewFunArgs(ctx, nextFunArgs->funArg, funArgs);
     if (nextFunArgs->next) {
-        newFunArgs = _ATreeFunArgsReverse(nextFunArgs->next, newFunArgs);
+        newFunArgs = _ATreeFunArgsReverse(ctx, nextFunArgs->next, newFunArgs);
     }
     return newFunArgs;
 }
@@ -983,7 +1306,7 @@ static FunArgs *_ATreeFunArgsReverse(FunArgs *nextFunArgs, FunArgs *funArgs)
  * 功能：返回函数参数的倒序
  * 返回值：
  **/
-FunArgs *ATreeFunArgsReverse(FunArgs *funArgs)
+FunArgs *ATreeFunArgsReverse(Bison *ctx, FunArgs *funArgs)
 {
     if (!funArgs) {
         return funArgs;
@@ -991,42 +1314,53 @@ FunArgs *ATreeFunArgsReverse(FunArgs *funArgs)
         if (funArgs->next) {
             FunArgs *newFunArgs;
 
-            newFunArgs = ATreeNewFunArgs(funArgs->funArg, NULL);
-            return _ATreeFunArgsReverse(funArgs->next, newFunArgs);
+            newFunArgs = ATreeNewFunArgs(ctx, funArgs->funArg, NULL);
+            return _ATreeFunArgsReverse(ctx, funArgs->next, newFunArgs);
         } else {
             return funArgs;
         }
     }
 }
 
-FunDefine *ATreeNewFunDefine(const Token *id, FunType *funType, Stmt *blockStmt)
+FunDefine *ATreeNewFunDefine(Bison *ctx, const Token *id, FunType *funType, Stmt *blockStmt)
 {
     FunDefine *funDefine;
 
-    funDefine = ATreeMAlloc(sizeof (*funDefine));
+    funDefine = ATreeMAlloc(ctx, sizeof (*funDefine));
     funDefine->id = id;
     funDefine->funType = funType;
-    funDefine->blockStmt = blockStmt;
+    funDefine->blockStmt = ATREE_ID(blockStmt);
     return funDefine;
 }
 
-FunDefines *ATreeNewFunDefines(FunDefines *prev, FunDefine *funDefine)
+/*
+ * 功能：在函数定义序列末尾追加函数定义，prev为空时新建序列。
+ * 返回值：函数定义序列
+ **/
+FunDefines *ATreeNewFunDefines(Bison *ctx, FunDefines *prev, FunDefine *funDefine)
 {
-    FunDefines *funDefines;
+    FunDefines *funDefines = prev;
 
     if (!funDefine) {
         return prev;
     }
-    funDefines = ATreeMAlloc(sizeof (*funDefines));
-    funDefines->prev = prev;
-    funDefines->funDefine = funDefine;
+    if (!funDefines) {
+        funDefines = ATreeMAlloc(ctx, sizeof (*funDefines));
+        memset(funDefines, 0, sizeof (*funDefines));
+    }
+    funDefines->funDefineArr = ATreeSeqReserve(ctx, funDefines->funDefineArr, sizeof (*funDefines->funDefineArr),
+                                               funDefines->funDefineNum, &funDefines->funDefineSize);
+    funDefines->funDefineArr[funDefines->funDefineNum++] = funDefine;
     return funDefines;
 }
 
-FunDefines *ATreeNewFunDefinesByFunDefines(FunDefines *prev, FunDefines *funDefines)
+/*
+ * 功能：把funDefines中的函数定义依次追加到prev末尾。
+ * 返回值：函数定义序列
+ **/
+FunDefines *ATreeNewFunDefinesByFunDefines(Bison *ctx, FunDefines *prev, FunDefines *funDefines)
 {
-    FunDefines *newFunDefines;
-    FunDefines *tempFunDefines = NULL;
+    uint32_t i;
 
     if (!prev) {
         return funDefines;
@@ -1034,29 +1368,26 @@ FunDefines *ATreeNewFunDefinesByFunDefines(FunDefines *prev, FunDefines *funDefi
     if (!funDefines) {
         return prev;
     }
-    while (funDefines->prev) {
-        tempFunDefines = funDefines;
-        funDefines = funDefines->prev;
-    }
-    newFunDefines = ATreeNewFunDefines(prev, funDefines->funDefine);
-    return ATreeNewFunDefinesByFunDefines(newFunDefines, tempFunDefines);
+    for (i = 0; i < funDefines->funDefineNum; i++)
+        prev = ATreeNewFunDefines(ctx, prev, funDefines->funDefineArr[i]);
+    return prev;
 }
 
-FunRefParas *ATreeNewFunRefParas(Expr *expr, FunRefParas *next)
+FunRefParas *ATreeNewFunRefParas(Bison *ctx, Expr *expr, FunRefParas *next)
 {
     FunRefParas *paras;
 
-    paras = ATreeMAlloc(sizeof (*paras));
-    paras->expr = expr;
+    paras = ATreeMAlloc(ctx, sizeof (*paras));
+    paras->expr = ATREE_ID(expr);
     paras->next = next;
     return paras;
 }
 
-FunRef *ATreeNewFunRef(const Token *token, FunType *funType, FunRefParas *paras)
+FunRef *ATreeNewFunRef(Bison *ctx, const Token *token, FunType *funType, FunRefParas *paras)
 {
     FunRef *funRef;
 
-    funRef = ATreeMAlloc(sizeof (*funRef));
+    funRef = ATreeMAlloc(ctx, sizeof (*funRef));
     funRef->token = token;
     funRef->paras = paras;
     funRef->funType = funType;
@@ -1074,7 +1405,7 @@ static void ATreeStringAppend(CplString *cplString, const char *str)
     error = CplStringAppendString(cplString, str);
     if (error != -ENOERR) {
         PrErr("append string error");
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -1082,7 +1413,7 @@ static void ATreeStringAppend(CplString *cplString, const char *str)
  * 功能：双目操作符表达式的字符串。
  * 返回值：
  */
-static CplString *ATreeBinOpExprString(Expr *expr)
+static CplString *ATreeBinOpExprString(Bison *ctx, Expr *expr)
 {
     CplString *cplString;
     CplString *lString, *rString;
@@ -1135,8 +1466,8 @@ static CplString *ATreeBinOpExprString(Expr *expr)
     }
 
     cplString = CplStringAlloc();
-    lString = ATreeExprString(expr->binOp.lExpr);
-    rString = ATreeExprString(expr->binOp.rExpr);
+    lString = ATreeExprString(ctx, ATreeExpr(ctx, expr->binOp.lExpr));
+    rString = ATreeExprString(ctx, ATreeExpr(ctx, expr->binOp.rExpr));
     ATreeStringAppend(cplString, lString->str);
     ATreeStringAppend(cplString, opStr);
     ATreeStringAppend(cplString, rString->str);
@@ -1149,7 +1480,7 @@ static CplString *ATreeBinOpExprString(Expr *expr)
  * 功能：单目操作符表达式的字符串
  * 返回值：
  */
-static CplString *ATreeUnaryOpExprString(Expr *expr)
+static CplString *ATreeUnaryOpExprString(Bison *ctx, Expr *expr)
 {
     CplString *cplString, *rString;
     const char *opStr = "?";
@@ -1159,7 +1490,7 @@ static CplString *ATreeUnaryOpExprString(Expr *expr)
     }
 
     cplString = CplStringAlloc();
-    rString = ATreeExprString(expr->unaryOp.expr);
+    rString = ATreeExprString(ctx, ATreeExpr(ctx, expr->unaryOp.expr));
     ATreeStringAppend(cplString, opStr);
     ATreeStringAppend(cplString, rString->str);
     CplStringFree(rString);
@@ -1238,14 +1569,14 @@ static CplString *ATreeIdExprString(Expr *expr)
     return cplString;
 }
 
-static CplString *ATreeAccessElmString(Expr *expr)
+static CplString *ATreeAccessElmString(Bison *ctx, Expr *expr)
 {
     CplString *cplString;
 
     cplString = CplStringAlloc();
-    CplStringAppendString(cplString, ATreeExprString(expr->accessElm.base)->str);
+    CplStringAppendString(cplString, ATreeExprString(ctx, ATreeExpr(ctx, expr->accessElm.base))->str);
     CplStringAppendString(cplString, "[");
-    CplStringAppendString(cplString, ATreeExprString(expr->accessElm.dims->idx)->str);
+    CplStringAppendString(cplString, ATreeExprString(ctx, ATreeExpr(ctx, expr->accessElm.dims->idx))->str);
     CplStringAppendString(cplString, "]");
     return cplString;
 }
@@ -1254,7 +1585,7 @@ static CplString *ATreeAccessElmString(Expr *expr)
  * 功能：表达式的字符串
  * 返回值：
  */
-CplString *ATreeExprString(Expr *expr)
+CplString *ATreeExprString(Bison *ctx, Expr *expr)
 {
     switch (expr->type) {
     case ET_ASSIGN:
@@ -1271,9 +1602,9 @@ CplString *ATreeExprString(Expr *expr)
     case ET_MUL:
     case ET_DIV:
     case ET_MOD:
-        return ATreeBinOpExprString(expr);
+        return ATreeBinOpExprString(ctx, expr);
     case ET_LNOT:
-        return ATreeUnaryOpExprString(expr);
+        return ATreeUnaryOpExprString(ctx, expr);
     case ET_CONST:
         return ATreeConstExprString(expr);
     case ET_TEMP:
@@ -1282,14 +1613,14 @@ CplString *ATreeExprString(Expr *expr)
         return ATreeConstSpcExprString(expr);
     case ET_FUN_REF:
         PrErr("function have no string");
-        exit(-1);
+        CplExit(-1);
     case ET_ID:
         return ATreeIdExprString(expr);
     case ET_ACCESS_ELM:
-        return ATreeAccessElmString(expr);
+        return ATreeAccessElmString(ctx, expr);
     }
     PrErr("expression type error: %d", expr->type);
-    exit(-1);
+    CplExit(-1);
 }
 
 Type *ATreeArrayBaseType(const Array *array)
@@ -1320,7 +1651,7 @@ size_t ATreeAddrAlignByType(size_t addr, const Type *type)
         break;
     default:
         PrErr("alignType error: %d", alignType);
-        exit(-1);
+        CplExit(-1);
     }
     return addr;
 }
@@ -1336,6 +1667,6 @@ AlignType ATreeTypeGetAlignType(const Type *type)
         return type->alignType;
     default:
         PrErr("type->type error: %d", type->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
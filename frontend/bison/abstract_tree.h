@@ -14,11 +14,19 @@ typedef struct _Expr Expr;
 typedef struct _Type Type;
 typedef struct _BPInsList BPInsList;
 typedef struct _Domain Domain;
+typedef struct _Bison Bison;
+
+typedef uint32_t ExprId;        /*表达式在编译单元表达式表中的下标*/
+typedef uint32_t StmtId;        /*语句在编译单元语句表中的下标*/
+typedef uint32_t CaseStmtId;    /*case语句在编译单元case语句表中的下标*/
+
+#define ATREE_NULL_ID       0   /*空节点的下标，节点表的下标从1开始*/
+#define ATREE_ID(node)      ((node) ? (node)->nodeId : ATREE_NULL_ID)
 
 /*访问成员的维度信息。*/
 typedef struct _AEDims {
     Type *type;                 /*元素的类型信息。*/
-    Expr *idx;                  /*当前维度的索引*/
+    ExprId idx;                 /*当前维度的索引*/
     struct _AEDims *nextDims; /*如果有下级维度则不为空。*/
 } AEDims;
 
@@ -65,7 +73,7 @@ typedef struct {
 } Id;
 
 typedef struct {
-    Expr *base;
+    ExprId base;
     Type *type;           /*最后一维度访问成员的类型*/
     AEDims *dims;         /*引用信息。*/
 } AccessElm;
@@ -73,14 +81,14 @@ typedef struct {
 /*二目运算符表达式*/
 typedef struct {
     Type *type;     /*表达式类型，int, float...*/
-    Expr *lExpr;    /*左边的表达式*/
-    Expr *rExpr;    /*右边的表达式*/
+    ExprId lExpr;   /*左边的表达式*/
+    ExprId rExpr;   /*右边的表达式*/
 } BinOp;
 
 /*单目运算符*/
 typedef struct {
     Type *type;     /*表达式类型，int, float...*/
-    Expr *expr;     /*子表达式*/
+    ExprId expr;    /*子表达式*/
 } UnaryOp;
 
 /*临时量*/
@@ -98,10 +106,10 @@ typedef enum {
 
 typedef struct {
     AccessMbrType type; /*访问方式*/
-    Expr *base;         /*基表达式*/
+    ExprId base;        /*基表达式*/
+    ExprId memOffset;   /*成员偏移量*/
     const Token *memId; /*成员id*/
     Type *memtype;      /*成员的类型*/
-    Expr *memOffset;   /*成员偏移量*/
 } AccessMbr;
 
 /*函数调用*/
@@ -139,6 +147,7 @@ typedef enum {
 /*表达式*/
 typedef struct _Expr {
     ExprType type;      /*表达式的类型*/
+    ExprId nodeId;      /*在表达式表中的下标*/
     Domain *domain;     /*表达式所在的作用域*/
     union {
         Id id;          /*id表达式*/
@@ -159,47 +168,50 @@ typedef struct _Stmt Stmt;
 
 /*表达式语句*/
 typedef struct {
-    Expr *expr;     /*表达式*/
+    ExprId expr;    /*表达式*/
 } ExprStmt;
 
 /*if语句*/
 typedef struct {
-    Cond *cond;     /*条件表达式*/
-    Stmt *stmt;     /*语句*/
+    ExprId cond;    /*条件表达式*/
+    StmtId stmt;    /*语句*/
 } IfStmt;
 
 /*if else语句*/
 typedef struct {
-    Cond *cond;     /*条件表达式*/
-    Stmt *ifStmt;   /*if语句*/
-    Stmt *elseStmt; /*else语句*/
+    ExprId cond;    /*条件表达式*/
+    StmtId ifStmt;  /*if语句*/
+    StmtId elseStmt;    /*else语句*/
 } ElseStmt;
 
 /*while语句*/
 typedef struct {
-    Cond *cond;     /*条件表达式*/
-    Stmt *stmt;     /*语句*/
+    ExprId cond;    /*条件表达式*/
+    StmtId stmt;    /*语句*/
     BPInsList *breakList;       /*待回填的break指令链表*/
     BPInsList *continueList;    /*待回填的continue指令链表*/
 } WhileStmt;
 
 /*do while语句*/
 typedef struct {
-    Cond *cond;     /*条件表达式*/
-    Stmt *stmt;     /*语句*/
+    ExprId cond;    /*条件表达式*/
+    StmtId stmt;    /*语句*/
     BPInsList *breakList;       /*待回填的break指令链表*/
     BPInsList *continueList;    /*待回填的continue指令链表*/
 } DoStmt;
 
-/*语句序列*/
+/*
+ * 语句序列，语句的下标按源代码顺序连续存放在ATree的序列数组中。
+ * 归约完成之前first是在openArr中的开始位置，归约完成后是在seqArr中的开始位置。
+ **/
 typedef struct _Stmts {
-    struct _Stmts *prevStmts;   /*前一个语句序列，如果为空则当前语句为第一个语句序列*/
-    Stmt *stmt;                 /*语句*/
+    uint32_t first;         /*第一条语句的位置*/
+    uint32_t num;           /*语句个数*/
 } Stmts;
 
 /*块语句*/
 typedef struct _BlockStmt {
-    Stmts *stmts;           /*语句序列*/
+    Stmts stmts;            /*语句序列*/
 } BlockStmt;
 
 /*break语句*/
@@ -214,8 +226,8 @@ typedef struct {
 
 /*case e: stmts */
 typedef struct {
-    Expr *expr;
-    Stmts *stmts;
+    ExprId expr;
+    Stmts stmts;
 } CaseExpr;
 
 /*case语句类型*/
@@ -227,26 +239,27 @@ typedef enum {
 /*switch内部的语句类型*/
 typedef struct {
     CaseStmtType type;
+    CaseStmtId nodeId;      /*在case语句表中的下标*/
     union {
         CaseExpr caseExpr;
-        Stmts *stmts;
+        Stmts stmts;
     };
 } CaseStmt;
 
-/* case stmts 语句*/
+/* case stmts 语句，case语句的下标按源代码顺序连续存放，和Stmts一样使用ATree的序列数组*/
 typedef struct _CaseStmts {
-    struct _CaseStmts *prev;    /*前一个case stmts语句序列*/
-    CaseStmt *caseStmt;
+    uint32_t first;
+    uint32_t num;
 } CaseStmts;
 
 typedef struct {
-    Expr *expr;
-    CaseStmts *caseStmts;
+    ExprId expr;
+    CaseStmts caseStmts;
     BPInsList *breakList;       /*待回填的break指令链表*/
 } SwitchStmt;
 
 typedef struct {
-    Expr *expr;
+    ExprId expr;
 } ReturnStmt;
 
 /*语句的类型*/
@@ -267,6 +280,7 @@ typedef enum {
 /*语句*/
 typedef struct _Stmt {
     StmtType type;      /*语句类型*/
+    StmtId nodeId;      /*在语句表中的下标*/
     Domain *domain;
     union {
         ExprStmt exprStmt;         /*表达式语句*/
@@ -371,6 +385,7 @@ typedef struct _Type {
     TypeType type;              /*类型的类型*/
     AlignType alignType;
     size_t size;            /*类型尺寸，单位：字节（byte）*/
+    struct list_head hashNode;  /*类型驻留表节点，只有数组和指针类型在驻留表中*/
     union {
         BaseType baseType;      /*基本类型*/
         Array array;            /*数组*/
@@ -380,21 +395,33 @@ typedef struct _Type {
     };
 } Type;
 
+/*
+ * 类型驻留表，结构相同的数组和指针类型共享同一个Type，尺寸和对齐方式只在这个Type上计算一次。
+ * 基本类型在环境中唯一，结构体和函数类型按声明区分，所以类型相同等价于Type指针相等。
+ **/
+typedef struct {
+    struct list_head *hashTable;    /*节点类型：Type*/
+    unsigned int hashSize;          /*散列表的桶数，总是2的幂*/
+    unsigned int typeNum;           /*驻留的类型数*/
+} TypeTable;
+
 /*函数定义*/
 typedef struct {
     const Token *id;
     FunType *funType;   /*函数类型*/
-    Stmt *blockStmt;    /*函数块语句*/
+    StmtId blockStmt;   /*函数块语句*/
 } FunDefine;
 
+/*函数定义序列，函数定义按源代码顺序连续存放*/
 typedef struct _FunDefines {
-    struct _FunDefines *prev;
-    FunDefine *funDefine;
+    FunDefine **funDefineArr;
+    uint32_t funDefineNum;
+    uint32_t funDefineSize;     /*数组容量*/
 } FunDefines;
 
 /*函数实际参数*/
 typedef struct _FunRefParas {
-    Expr *expr;     /*参数表达式*/
+    ExprId expr;    /*参数表达式*/
     struct _FunRefParas *next;  /*下一个实际参数，如果为空则表示为最后一级实际参数。*/
 } FunRefParas;
 
@@ -405,64 +432,130 @@ typedef struct _FunRef {
     FunRefParas *paras; /*函数实际参数。如果为空则表示不存在实际参数*/
 } FunRef;
 
-AEDims *ATreeNewAEDims(Type *type, Expr *idx,
+#define ATREE_PAGE_SHIFT    8   /*节点表每页的节点数是2的ATREE_PAGE_SHIFT次幂*/
+#define ATREE_PAGE_MASK     ((1u << ATREE_PAGE_SHIFT) - 1)
+
+/*
+ * 同一种语法树节点的表。节点按页连续存放，页从编译单元的区域分配器中申请，申请后不再移动，
+ * 节点指针在整个编译单元内有效。节点之间用32位下标引用，下标的高位是页号，低位是页内位置。
+ **/
+typedef struct {
+    void **pageArr;         /*页数组，每页是节点数组*/
+    uint32_t pageNum;
+    uint32_t pageSize;      /*页数组的容量*/
+    uint32_t nodeNum;       /*已分配的节点数，包括保留的下标0*/
+    uint32_t nodeSize;      /*节点大小，单位：字节*/
+} ATreeNodeTable;
+
+/*
+ * 编译单元的语法树。表达式、语句和case语句分别存放在各自的节点表中，语句序列和case语句序列
+ * 归约完成后按源代码顺序连续存放在seqArr中，生成中间代码时按下标区间顺序访问。
+ * LR分析时内层的序列先于外层的序列归约完成，正在归约的序列放在openArr中，内层在外层之上。
+ **/
+typedef struct _ATree {
+    ATreeNodeTable exprTable;       /*节点类型：Expr*/
+    ATreeNodeTable stmtTable;       /*节点类型：Stmt*/
+    ATreeNodeTable caseStmtTable;   /*节点类型：CaseStmt*/
+    uint32_t *seqArr;       /*归约完成的序列，元素是语句或者case语句的下标*/
+    uint32_t seqNum;
+    uint32_t seqSize;       /*seqArr的容量*/
+    uint32_t *openArr;      /*正在归约的序列*/
+    uint32_t openNum;
+    uint32_t openSize;      /*openArr的容量*/
+} ATree;
+
+static inline Expr *ATreeTreeExpr(const ATree *tree, ExprId id)
+{
+    if (id == ATREE_NULL_ID)
+        return NULL;
+    return (Expr *)tree->exprTable.pageArr[id >> ATREE_PAGE_SHIFT] + (id & ATREE_PAGE_MASK);
+}
+
+static inline Stmt *ATreeTreeStmt(const ATree *tree, StmtId id)
+{
+    if (id == ATREE_NULL_ID)
+        return NULL;
+    return (Stmt *)tree->stmtTable.pageArr[id >> ATREE_PAGE_SHIFT] + (id & ATREE_PAGE_MASK);
+}
+
+static inline CaseStmt *ATreeTreeCaseStmt(const ATree *tree, CaseStmtId id)
+{
+    if (id == ATREE_NULL_ID)
+        return NULL;
+    return (CaseStmt *)tree->caseStmtTable.pageArr[id >> ATREE_PAGE_SHIFT] + (id & ATREE_PAGE_MASK);
+}
+
+/*按下标取节点，ctx是编译上下文*/
+#define ATreeExpr(ctx, id)          ATreeTreeExpr((ctx)->tree, (id))
+#define ATreeStmt(ctx, id)          ATreeTreeStmt((ctx)->tree, (id))
+#define ATreeCaseStmt(ctx, id)      ATreeTreeCaseStmt((ctx)->tree, (id))
+/*归约完成的序列seq中第i个节点的下标，seq是Stmts或者CaseStmts的指针*/
+#define ATreeSeqId(ctx, seq, i)     ((ctx)->tree->seqArr[(seq)->first + (i)])
+
+ATree *ATreeAlloc(void);
+void ATreeFree(ATree *tree);
+
+AEDims *ATreeNewAEDims(Bison *ctx, Type *type, Expr *idx,
                               AEDims *nextDims);
-LValue *ATreeNewLValue(Type *type, const Token *id, AEDims *dims);
-
-Expr *ATreeNewIdExpr(Domain *domain, const Token *token, Type *type);
-Expr *ATreeNewAccessElmExpr(Domain *domain, Expr *baseExpr, AEDims *dims, Type *type);
-Expr *ATreeNewBinExpr(Domain *domain, ExprType exprtype, Type *type, Expr *lExpr, Expr *rExpr);
-Expr *ATreeNewUnaryExpr(Domain *domain, ExprType exprType, Type *type, Expr *expr);
-Expr *ATreeNewCValueExpr(Domain *domain, CValueType type, const Token *token);
-Expr *ATreeNewCValueSpcIntExpr(Domain *domain, int iValue);
-Expr *ATreeNewCValueSpcFloatExpr(Domain *domain, float fValue);
-Expr *ATreeNewCValueSpcBoolExpr(Domain *domain, CValueSpcType type);
-Expr *ATreeNewTemp(Domain *domain, Type *type);
-Expr *ATreeNewFunRefExpr(Domain *domain, FunRef *funRef);
-Expr *ATreeNewAccessMem(Domain *Domain, AccessMbrType type, Expr *base, const Token *memId, Type *memType, Expr *memOffset);
-Type *ATreeExprType(Expr *expr);
-
-Stmt *ATreeNewExprStmt(Domain *domain, Expr *expr);
-Stmt *ATreeNewIfStmt(Domain *domain, Cond *cond, Stmt *stmt);
-Stmt *ATreeNewElseStmt(Domain *domain, Cond *cond, Stmt *ifStmt, Stmt *elseStmt);
-Stmt *ATreeNewWhileStmt(Domain *domain, Cond *cond, Stmt *stmt);
-Stmt *ATreeNewDoStmt(Domain *domain, Cond *cond, Stmt *stmt);
-Stmt *ATreeNewBlockStmt(Domain *domain, Stmts *stmts);
-Stmt *ATreeNewBreakStmt(Domain *domain, size_t after);
-Stmt *ATreeNewContinueStmt(Domain *domain, size_t begin);
-Stmt *ATreeNewReturnVoidStmt(Domain *domain);
-Stmt *ATreeNewReturnValueStmt(Domain *domain, Expr *expr);
-
-CaseStmt *ATreeNewCaseExprStmt(Expr *expr, Stmts *stmts);
-CaseStmt *ATreeNewCaseDefaultStmt(Stmts *stmts);
-CaseStmts *ATreeNewCaseStmts(CaseStmts *prev, CaseStmt *caseStmt);
-Stmt *ATreeNewSwitchStmt(Expr *expr, CaseStmts *caseStmts);
-
-Stmts *ATreeNewStmts(Stmts *prevStmts, Stmt *stmt);
-Type *ATreeExprWiddenType(ExprType exprType, Expr *lExpr, Expr *rExpr);
-Program *ATreeNewProgram(FunDefines *funDefines);
-
-Type *ATreeNewBaseType(BaseTypeType type, size_t size, AlignType alignType);
+LValue *ATreeNewLValue(Bison *ctx, Type *type, const Token *id, AEDims *dims);
+
+Expr *ATreeNewIdExpr(Bison *ctx, Domain *domain, const Token *token, Type *type);
+Expr *ATreeNewAccessElmExpr(Bison *ctx, Domain *domain, Expr *baseExpr, AEDims *dims, Type *type);
+Expr *ATreeNewBinExpr(Bison *ctx, Domain *domain, ExprType exprtype, Type *type, Expr *lExpr, Expr *rExpr);
+Expr *ATreeNewUnaryExpr(Bison *ctx, Domain *domain, ExprType exprType, Type *type, Expr *expr);
+Expr *ATreeNewCValueExpr(Bison *ctx, Domain *domain, CValueType type, const Token *token);
+Expr *ATreeNewCValueSpcIntExpr(Bison *ctx, Domain *domain, int iValue);
+Expr *ATreeNewCValueSpcFloatExpr(Bison *ctx, Domain *domain, float fValue);
+Expr *ATreeNewCValueSpcBoolExpr(Bison *ctx, Domain *domain, CValueSpcType type);
+Expr *ATreeNewTemp(Bison *ctx, Domain *domain, Type *type);
+Expr *ATreeNewFunRefExpr(Bison *ctx, Domain *domain, FunRef *funRef);
+Expr *ATreeNewAccessMem(Bison *ctx, Domain *Domain, AccessMbrType type, Expr *base, const Token *memId, Type *memType, Expr *memOffset);
+Type *ATreeExprType(Bison *ctx, Expr *expr);
+
+Stmt *ATreeNewExprStmt(Bison *ctx, Domain *domain, Expr *expr);
+Stmt *ATreeNewIfStmt(Bison *ctx, Domain *domain, Cond *cond, Stmt *stmt);
+Stmt *ATreeNewElseStmt(Bison *ctx, Domain *domain, Cond *cond, Stmt *ifStmt, Stmt *elseStmt);
+Stmt *ATreeNewWhileStmt(Bison *ctx, Domain *domain, Cond *cond, Stmt *stmt);
+Stmt *ATreeNewDoStmt(Bison *ctx, Domain *domain, Cond *cond, Stmt *stmt);
+Stmt *ATreeNewBlockStmt(Bison *ctx, Domain *domain, Stmts *stmts);
+Stmt *ATreeNewBreakStmt(Bison *ctx, Domain *domain, size_t after);
+Stmt *ATreeNewContinueStmt(Bison *ctx, Domain *domain, size_t begin);
+Stmt *ATreeNewReturnVoidStmt(Bison *ctx, Domain *domain);
+Stmt *ATreeNewReturnValueStmt(Bison *ctx, Domain *domain, Expr *expr);
+
+CaseStmt *ATreeNewCaseExprStmt(Bison *ctx, Expr *expr, Stmts *stmts);
+CaseStmt *ATreeNewCaseDefaultStmt(Bison *ctx, Stmts *stmts);
+CaseStmts *ATreeNewCaseStmts(Bison *ctx, CaseStmts *prev, CaseStmt *caseStmt);
+Stmt *ATreeNewSwitchStmt(Bison *ctx, Expr *expr, CaseStmts *caseStmts);
+
+Stmts *ATreeNewStmts(Bison *ctx, Stmts *stmts, Stmt *stmt);
+Type *ATreeExprWiddenType(Bison *ctx, ExprType exprType, Expr *lExpr, Expr *rExpr);
+Program *ATreeNewProgram(Bison *ctx, FunDefines *funDefines);
+
+Type *ATreeNewBaseType(Bison *ctx, BaseTypeType type, size_t size, AlignType alignType);
 void ATreeFreeBaseType(Type *type);
 size_t ATreeTypeSize(const Type *type);
-Type *ATreeNewArrayType(Type *elementType, size_t count, AlignType alignType);
-Type *ATreeNewStructType(Domain *domain, AlignType alignType, size_t size);
-Type *ATreeNewPointerType(Type *pointType);
-Type *ATreeNewFunctionType(FunRetType *retType, FunArgs *funArgs);
-
-FunRetType *ATreeNewFunRetTypeVoid(void);
-FunRetType *ATreeNewFunRetType(Type *type);
-FunArg *ATreeNewFunArg(const Token *id, Type *type);
-FunArgs *ATreeNewFunArgs(FunArg *funArg, FunArgs *next);
-FunArgs *ATreeFunArgsReverse(FunArgs *funArgs);
-FunDefine *ATreeNewFunDefine(const Token *id, FunType *funType, Stmt *blockStmt);
-FunDefines *ATreeNewFunDefines(FunDefines *prev, FunDefine *funDefine);
-FunDefines *ATreeNewFunDefinesByFunDefines(FunDefines *prev, FunDefines *funDefines);
-
-FunRefParas *ATreeNewFunRefParas(Expr *expr, FunRefParas *next);
-FunRef *ATreeNewFunRef(const Token *token, FunType *funType, FunRefParas *paras);
-
-CplString *ATreeExprString(Expr *expr);
+Type *ATreeNewArrayType(Bison *ctx, Type *elementType, size_t count, AlignType alignType);
+Type *ATreeNewStructType(Bison *ctx, Domain *domain, AlignType alignType, size_t size);
+Type *ATreeNewPointerType(Bison *ctx, Type *pointType);
+Type *ATreeNewFunctionType(Bison *ctx, FunRetType *retType, FunArgs *funArgs);
+int ATreeTypeIsEqual(const Type *lType, const Type *rType);
+void ATreeTypeTableInit(TypeTable *table);
+void ATreeTypeTableFree(TypeTable *table);
+
+FunRetType *ATreeNewFunRetTypeVoid(Bison *ctx);
+FunRetType *ATreeNewFunRetType(Bison *ctx, Type *type);
+FunArg *ATreeNewFunArg(Bison *ctx, const Token *id, Type *type);
+FunArgs *ATreeNewFunArgs(Bison *ctx, FunArg *funArg, FunArgs *next);
+FunArgs *ATreeFunArgsReverse(Bison *ctx, FunArgs *funArgs);
+FunDefine *ATreeNewFunDefine(Bison *ctx, const Token *id, FunType *funType, Stmt *blockStmt);
+FunDefines *ATreeNewFunDefines(Bison *ctx, FunDefines *prev, FunDefine *funDefine);
+FunDefines *ATreeNewFunDefinesByFunDefines(Bison *ctx, FunDefines *prev, FunDefines *funDefines);
+
+FunRefParas *ATreeNewFunRefParas(Bison *ctx, Expr *expr, FunRefParas *next);
+FunRef *ATreeNewFunRef(Bison *ctx, const Token *token, FunType *funType, FunRefParas *paras);
+
+CplString *ATreeExprString(Bison *ctx, Expr *expr);
 
 Type *ATreeArrayBaseType(const Array *array);
 size_t ATreeAddrAlignByType(size_t addr, const Type *type);
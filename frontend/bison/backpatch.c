@@ -19,7 +19,7 @@ static void *BPMAlloc(size_t size)
     p = CplAlloc(size);
     if (!p) {
         PrErr("no memory");
-        exit(-1);
+        CplExit(-1);
     }
     return p;
 }
@@ -97,7 +97,7 @@ static inline void BPInstructSetLabel(QuadRuple *ruple, size_t label)
         break;
     default:
         PrErr("unknown ruple op");
-        exit(-1);
+        CplExit(-1);
         break;
     }
 }
@@ -1,8 +1,12 @@
 #include "bison.h"
 #include "grammar_symbol.h"
 #include "lalr_parse_table.h"
+#include "lalr_lookahead.h"
 #include "error_recover.h"
 #include "lr_parse_algorithm.h"
+#include "lr_static_table.h"
+#include "lr_inc_parse.h"
+#include "lalr_emit.h"
 #include "context_free_grammar.h"
 #include "list.h"
 #include "cpl_common.h"
@@ -10,6 +14,7 @@
 #include "cpl_errno.h"
 #include "stdlib.h"
 #include "string.h"
+#include <pthread.h>
 #include "lex.h"
 #include "cpl_mm.h"
 #include "quadruple.h"
@@ -20,6 +25,41 @@
 
 #define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
 
+/*
+ * 当前线程正在编译的上下文，只在BisonCompile期间有效。归约句柄的参数中没有上下文，
+ * 句柄通过它把上下文传给语法树和中间代码生成。
+ **/
+static __thread Bison *bison;
+
+/*构造LR(0)项集族的线程数，0表示使用CPU核数*/
+#define BISON_LALR_THREAD_NUM   0
+
+/*运行时构造语法分析表时也用两种向前看符号算法生成语法分析表并比较结果，生成静态语法分析表时总是比较*/
+//#define BISON_LA_CHECK
+#ifdef BISON_LA_CHECK
+#define BISON_LA_CHECK_FLAG     1
+#else
+#define BISON_LA_CHECK_FLAG     0
+#endif
+
+/*
+ * 使用bison_table_gen生成的静态语法分析表bison_table.inc，运行时不再构造文法和项集族。
+ * 编译bison_table_gen时定义BISON_TABLE_GEN，使用运行时构造的语法分析表。
+ **/
+#ifndef BISON_TABLE_GEN
+#define BISON_STATIC_TABLE
+#endif
+
+/*生成静态语法分析表时使用默认归约，并跳过句柄为CfgPassHandle的单产生式归约*/
+#define BISON_TABLE_EMIT_FLAGS  (LALR_EMIT_DEFAULT_REDUCE | LALR_EMIT_UNIT_BYPASS)
+
+/*错误恢复非终结符号，按优先顺序排列，生成静态语法分析表时用于计算每个状态上的错误恢复目标*/
+#define BISON_RECOVER_SYMIDS    SID_BLOCK, SID_STMTS
+
+/*统计语法分析的移入、归约、错误恢复次数和归约句柄耗时，退出时以JSON格式输出到BISON_PARSE_STAT_PATH*/
+//#define BISON_PARSE_STAT
+#define BISON_PARSE_STAT_PATH   "parse_stat.json"
+
 #define BISON_DEBUG
 #ifdef BISON_DEBUG
 #define PrDbg(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "debug", __VA_ARGS__)
@@ -28,17 +68,17 @@
 #endif
 
 /*
- * 功能：分配内存，如果失败则程序退出。
+ * 功能：从编译单元的区域分配器中分配内存，如果失败则程序退出。
  * 返回值：
  **/
-void *BisonMAlloc(size_t size)
+static void *BisonMAlloc(size_t size)
 {
     void *p;
 
-    p = CplAlloc(size);
+    p = CplArenaAlloc(bison->arena, size);
     if (!p) {
         PrErr("no memory\n");
-        exit(-1);
+        CplExit(-1);
     }
     return p;
 }
@@ -101,22 +141,7 @@ static int GrammarAddSymbol(ContextFreeGrammar *grammar)
     error = CfgAddSymbol(grammar, SID_LVALUE, "lvalue",  SYMBOL_TYPE_NONTERMINAL);
     if (error != -ENOERR)
         goto err;
-    error = CfgAddSymbol(grammar, SID_LOR_EXPR, "lor_expr",  SYMBOL_TYPE_NONTERMINAL);
-    if (error != -ENOERR)
-        goto err;
-    error = CfgAddSymbol(grammar, SID_LAND_EXPR, "land_expr",  SYMBOL_TYPE_NONTERMINAL);
-    if (error != -ENOERR)
-        goto err;
-    error = CfgAddSymbol(grammar, SID_REL_L0_EXPR, "rel_l0_expr",  SYMBOL_TYPE_NONTERMINAL);
-    if (error != -ENOERR)
-        goto err;
-    error = CfgAddSymbol(grammar, SID_ARITH_L0_EXPR, "arith_l0_expr",  SYMBOL_TYPE_NONTERMINAL);
-    if (error != -ENOERR)
-        goto err;
-    error = CfgAddSymbol(grammar, SID_REL_L1_EXPR, "rel_l1_expr",  SYMBOL_TYPE_NONTERMINAL);
-    if (error != -ENOERR)
-        goto err;
-    error = CfgAddSymbol(grammar, SID_ARITH_L1_EXPR, "arith_l1_expr",  SYMBOL_TYPE_NONTERMINAL);
+    error = CfgAddSymbol(grammar, SID_BIN_EXPR, "bin_expr",  SYMBOL_TYPE_NONTERMINAL);
     if (error != -ENOERR)
         goto err;
     error = CfgAddSymbol(grammar, SID_LEVEL2_EXPR, "level2_expr",  SYMBOL_TYPE_NONTERMINAL);
@@ -448,7 +473,7 @@ static int BisonProgDHandle(void **headArg, void *prevArg, void *bodyArg[])
 
     (void)prevArg;
     funDefines = bodyArg[0];
-    bison->program = ATreeNewProgram(funDefines);
+    bison->program = ATreeNewProgram(bison, funDefines);
     *headArg = bison->program;
     return 0;
 }
@@ -463,7 +488,7 @@ static int BisonStFunDefinesSfDssfdHandle(void **headArg, void *prevArg, void *b
     (void)prevArg;
     prevFunDefines = bodyArg[0];
     funDefine = bodyArg[1];
-    funDefines = ATreeNewFunDefines(prevFunDefines, funDefine);
+    funDefines = ATreeNewFunDefines(bison, prevFunDefines, funDefine);
     *headArg = funDefines;
     return 0;
 }
@@ -491,7 +516,7 @@ static int BisonConponentdefCdsfundefHandle(void **headArg, void *prevArg, void
     (void)prevArg;
     prevFunDefines = bodyArg[0];
     funDefine = bodyArg[1];
-    funDefines = ATreeNewFunDefines(prevFunDefines, funDefine);
+    funDefines = ATreeNewFunDefines(bison, prevFunDefines, funDefine);
     *headArg = funDefines;
     return 0;
 }
@@ -542,7 +567,7 @@ static int BisonBlockLdsrHandle(void **headArg, void *prevArg, void *bodyArg[])
 
     (void)prevArg;
     stmts = bodyArg[3];
-    blockStmt = ATreeNewBlockStmt(bison->env->domain, stmts);
+    blockStmt = ATreeNewBlockStmt(bison, bison->env->domain, stmts);
     *headArg = blockStmt;
     return 0;
 }
@@ -612,7 +637,7 @@ static int BisonDeclTiHandle(void **headArg, void *prevArg, void *bodyArg[])
             newAlignType = AT_4BYTE;
         } else {
             PrErr("type->type error: %d", type->type);
-            exit(-1);
+            CplExit(-1);
         }
         if (newAlignType > domain->alignType) {
             domain->alignType = newAlignType;
@@ -671,20 +696,7 @@ static int BisonTypeTsHandle(void **headArg, void *prevArg, void *bodyArg[])
 
     (void)prevArg;
     baseType = bodyArg[0];
-    type = ATreeNewPointerType(baseType);
-    *headArg = type;
-    return 0;
-}
-
-/*type -> struct_type*/
-static int BisonTypeStHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Type *type;
-    Type *structType;
-
-    (void)prevArg;
-    structType = bodyArg[0];
-    type = structType;
+    type = ATreeNewPointerType(bison, baseType);
     *headArg = type;
     return 0;
 }
@@ -702,7 +714,7 @@ static int BisonStructTypeSiHandle(void **headArg, void *prevArg, void *bodyArg[
     entry = EnvDomainGetEntry(bison->env->domain, id);
     if (!entry) {
         PrErr("entry error: %p", entry);
-        exit(-1);
+        CplExit(-1);
     }
     structType = entry->type;
     *headArg = structType;
@@ -789,7 +801,7 @@ static int BisonDimLdrdHandle(void **headArg, void *prevArg, void *bodyArg[])
     declDims1 = bodyArg[4];
     declDims = prevArg;
     alignType = ATreeTypeGetAlignType(declDims1->synType);
-    declDims->synType = ATreeNewArrayType(declDims1->synType, digitToken->digit, alignType);
+    declDims->synType = ATreeNewArrayType(bison, declDims1->synType, digitToken->digit, alignType);
     *headArg = declDims;
     return 0;
 }
@@ -816,7 +828,7 @@ static int BisonStmtsSSHandle(void **headArg, void *prevArg, void *bodyArg[])
     (void)prevArg;
     stmts1 = bodyArg[0];
     stmt = bodyArg[1];
-    stmts = ATreeNewStmts(stmts1, stmt);
+    stmts = ATreeNewStmts(bison, stmts1, stmt);
     *headArg = stmts;
     return 0;
 }
@@ -840,7 +852,7 @@ static int BisonStmtEsHandle(void **headArg, void *prevArg, void *bodyArg[])
 
     (void)prevArg;
     expr = bodyArg[0];
-    stmt = ATreeNewExprStmt(bison->env->domain, expr);
+    stmt = ATreeNewExprStmt(bison, bison->env->domain, expr);
     *headArg = stmt;
     return 0;
 }
@@ -855,7 +867,7 @@ static int BisonStmtIlcrsHandle(void **headArg, void *prevArg, void *bodyArg[])
     (void)prevArg;
     cond = bodyArg[2];
     stmt1 = bodyArg[4];
-    stmt = ATreeNewIfStmt(bison->env->domain, cond, stmt1);
+    stmt = ATreeNewIfStmt(bison, bison->env->domain, cond, stmt1);
     *headArg = stmt;
     return 0;
 }
@@ -871,7 +883,7 @@ static int BisonStmtIlcrsesHandle(void **headArg, void *prevArg, void *bodyArg[]
     cond = bodyArg[2];
     stmt1 = bodyArg[4];
     stmt2 = bodyArg[6];
-    stmt = ATreeNewElseStmt(bison->env->domain, cond, stmt1, stmt2);
+    stmt = ATreeNewElseStmt(bison, bison->env->domain, cond, stmt1, stmt2);
     *headArg = stmt;
     return 0;
 }
@@ -886,7 +898,7 @@ static int BisonStmtWlcrsHandle(void **headArg, void *prevArg, void *bodyArg[])
     (void)prevArg;
     cond = bodyArg[2];
     stmt1 = bodyArg[4];
-    stmt = ATreeNewWhileStmt(bison->env->domain, cond, stmt1);
+    stmt = ATreeNewWhileStmt(bison, bison->env->domain, cond, stmt1);
     *headArg = stmt;
     return 0;
 }
@@ -901,7 +913,7 @@ static int BisonStmtDswlcrHandle(void **headArg, void *prevArg, void *bodyArg[])
     (void)prevArg;
     cond = bodyArg[4];
     stmt1 = bodyArg[1];
-    stmt = ATreeNewDoStmt(bison->env->domain, cond, stmt1);
+    stmt = ATreeNewDoStmt(bison, bison->env->domain, cond, stmt1);
     *headArg = stmt;
     return 0;
 }
@@ -916,7 +928,7 @@ static int BisonCasestmtCecsHandle(void **headArg, void *prevArg, void *bodyArg[
     (void)prevArg;
     expr = bodyArg[1];
     stmts = bodyArg[3];
-    caseStmt = ATreeNewCaseExprStmt(expr, stmts);
+    caseStmt = ATreeNewCaseExprStmt(bison, expr, stmts);
     *headArg = caseStmt;
     return 0;
 }
@@ -929,7 +941,7 @@ static int BisonCasestmtDcsHandle(void **headArg, void *prevArg, void *bodyArg[]
 
     (void)prevArg;
     stmts = bodyArg[2];
-    caseStmt = ATreeNewCaseDefaultStmt(stmts);
+    caseStmt = ATreeNewCaseDefaultStmt(bison, stmts);
     *headArg = caseStmt;
     return 0;
 }
@@ -944,7 +956,7 @@ static int BisonCasestmtsCcHandle(void **headArg, void *prevArg, void *bodyArg[]
     (void)prevArg;
     prev = bodyArg[0];
     caseStmt = bodyArg[1];
-    caseStmts = ATreeNewCaseStmts(prev, caseStmt);
+    caseStmts = ATreeNewCaseStmts(bison, prev, caseStmt);
     *headArg = caseStmts;
     return 0;
 }
@@ -970,20 +982,7 @@ static int BisonStmtSlerlcrHandle(void **headArg, void *prevArg, void *bodyArg[]
     (void)prevArg;
     expr = bodyArg[2];
     caseStmts = bodyArg[5];
-    stmt = ATreeNewSwitchStmt(expr, caseStmts);
-    *headArg = stmt;
-    return 0;
-}
-
-/*stmt -> block*/
-static int BisonStmtBHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Stmt *stmt;
-    Stmt *blockStmt;
-
-    (void)prevArg;
-    blockStmt = bodyArg[0];
-    stmt = blockStmt;
+    stmt = ATreeNewSwitchStmt(bison, expr, caseStmts);
     *headArg = stmt;
     return 0;
 }
@@ -994,7 +993,7 @@ static int BisonStmtBsHandle(void **headArg, void *prevArg, void *bodyArg[])
     Stmt *stmt;
 
     (void)prevArg, (void)bodyArg;
-    stmt = ATreeNewBreakStmt(bison->env->domain, 0);
+    stmt = ATreeNewBreakStmt(bison, bison->env->domain, 0);
     *headArg = stmt;
     return 0;
 }
@@ -1005,24 +1004,11 @@ static int BisonStmtCsHandle(void **headArg, void *prevArg, void *bodyArg[])
     Stmt *stmt;
 
     (void)prevArg, (void)bodyArg;
-    stmt = ATreeNewContinueStmt(bison->env->domain, 0);
+    stmt = ATreeNewContinueStmt(bison, bison->env->domain, 0);
     *headArg = stmt;
     return 0;
 }
 
-/*cond -> lor_expr*/
-static int BisonCondLorHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Cond *cond;
-    Expr *lorExpr;
-
-    (void)prevArg;
-    lorExpr = bodyArg[0];
-    cond = lorExpr;
-    *headArg = cond;
-    return 0;
-}
-
 /*fun_defines -> fun_defines fun_define*/
 static int BisonFundefinesFfHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
@@ -1033,7 +1019,7 @@ static int BisonFundefinesFfHandle(void **headArg, void *prevArg, void *bodyArg[
     (void)prevArg;
     prev = bodyArg[0];
     funDefine = bodyArg[1];
-    funDefines = ATreeNewFunDefines(prev, funDefine);
+    funDefines = ATreeNewFunDefines(bison, prev, funDefine);
     *headArg = funDefines;
     return 0;
 }
@@ -1077,7 +1063,7 @@ static int BisonM8EmptyHandle(void **headArg, void *parentPrevArg, void *parentB
     funRetType = parentBodyArg[1];
     funArgs = parentBodyArg[4];
     lastDomain = parentBodyArg[0];
-    type = ATreeNewFunctionType(funRetType, funArgs);
+    type = ATreeNewFunctionType(bison, funRetType, funArgs);
     domainEntry = EnvNewDomainEntry(id, type, 0, lastDomain);
     EnvDomainPutEntry(lastDomain, domainEntry);
     bison->env->domain->funType = &type->funType;
@@ -1098,7 +1084,7 @@ static int BisonFundefineFilfrbHandle(void **headArg, void *prevArg, void *bodyA
     id = bodyArg[2];
     funType = bodyArg[6];
     blockStmt = bodyArg[7];
-    funDefine = ATreeNewFunDefine(id, funType, blockStmt);
+    funDefine = ATreeNewFunDefine(bison, id, funType, blockStmt);
     *headArg = funDefine;
     if (strcmp(id->cplString->str, "main") == 0) {
         bison->mainToken = id;
@@ -1113,7 +1099,7 @@ static int BisonFunrettypeVHandle(void **headArg, void *prevArg, void *bodyArg[]
     FunRetType *funRetType;
 
     (void)prevArg, (void)bodyArg;
-    funRetType = ATreeNewFunRetTypeVoid();
+    funRetType = ATreeNewFunRetTypeVoid(bison);
     *headArg = funRetType;
     return 0;
 }
@@ -1126,7 +1112,7 @@ static int BisonFunrettypeBtHandle(void **headArg, void *prevArg, void *bodyArg[
 
     (void)prevArg;
     baseType = bodyArg[0];
-    funRetType = ATreeNewFunRetType(baseType);
+    funRetType = ATreeNewFunRetType(bison, baseType);
     *headArg = funRetType;
     return 0;
 }
@@ -1139,22 +1125,11 @@ static int BisonFunrettypeSttHandle(void **headArg, void *prevArg, void *bodyArg
 
     (void)prevArg;
     structType = bodyArg[0];
-    funRetType = ATreeNewFunRetType(structType);
+    funRetType = ATreeNewFunRetType(bison, structType);
     *headArg = funRetType;
     return 0;
 }
 
-/*fun_argues -> fun_args*/
-static int BisonFunarguesFHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    FunArgs *funArgs;
-
-    (void)prevArg;
-    funArgs = bodyArg[0];
-    *headArg = funArgs;
-    return 0;
-}
-
 /*fun_argues -> void*/
 static int BisonFunarguesVHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
@@ -1188,7 +1163,7 @@ static int BisonFunargTiHandle(void **headArg, void *prevArg, void *bodyArg[])
     (void)prevArg;
     id = bodyArg[1];
     type = bodyArg[0];
-    funArg = ATreeNewFunArg(id, type);
+    funArg = ATreeNewFunArg(bison, id, type);
     *headArg = funArg;
 
     domainEntry = EnvNewDomainEntry(id, type, 0, bison->env->domain);
@@ -1207,7 +1182,7 @@ static int BisonFunargsFcfHandle(void **headArg, void *prevArg, void *bodyArg[])
     (void)prevArg;
     funArg = bodyArg[0];
     next = bodyArg[2];
-    funArgs = ATreeNewFunArgs(funArg, next);
+    funArgs = ATreeNewFunArgs(bison, funArg, next);
     *headArg = funArgs;
     return 0;
 }
@@ -1220,7 +1195,7 @@ static int BisonFunargsFHandle(void **headArg, void *prevArg, void *bodyArg[])
 
     (void)prevArg;
     funArg = bodyArg[0];
-    funArgs = ATreeNewFunArgs(funArg, NULL);
+    funArgs = ATreeNewFunArgs(bison, funArg, NULL);
     *headArg = funArgs;
     return 0;
 }
@@ -1233,7 +1208,7 @@ static int BisonFunblockLdsrHandle(void **headArg, void *prevArg, void *bodyArg[
 
     (void)prevArg;
     stmts = bodyArg[2];
-    blockStmt = ATreeNewBlockStmt(bison->env->domain, stmts);
+    blockStmt = ATreeNewBlockStmt(bison, bison->env->domain, stmts);
     *headArg = blockStmt;
     return 0;
 }
@@ -1280,9 +1255,9 @@ static int BisonStructDefineStimldsrmsHandle(void **headArg, void *prevArg, void
     domain = bison->env->domain;
     if (domain->type != DT_STRUCT) {
         PrErr("domain type error: %d", domain->type);
-        exit(-1);
+        CplExit(-1);
     }
-    structType = ATreeNewStructType(domain, domain->alignType, domain->offset_num);
+    structType = ATreeNewStructType(bison, domain, domain->alignType, domain->offset_num);
     *headArg = structType;
     bison->env->domain = EnvDomainPop(bison->env->domain);
 
@@ -1329,7 +1304,7 @@ static int BisonStmtResHandle(void **headArg, void *prevArg, void *bodyArg[])
 
     (void)prevArg;
     expr = bodyArg[1];
-    stmt = ATreeNewReturnValueStmt(bison->env->domain, expr);
+    stmt = ATreeNewReturnValueStmt(bison, bison->env->domain, expr);
     *headArg = stmt;
     return 0;
 }
@@ -1340,7 +1315,7 @@ static int BisonStmtRsHandle(void **headArg, void *prevArg, void *bodyArg[])
     Stmt *stmt;
 
     (void)prevArg, (void)bodyArg;
-    stmt = ATreeNewReturnVoidStmt(bison->env->domain);
+    stmt = ATreeNewReturnVoidStmt(bison, bison->env->domain);
     *headArg = stmt;
     return 0;
 }
@@ -1360,23 +1335,12 @@ static int BisonFuncallIlfrHandle(void **headArg, void *prevArg, void *bodyArg[]
     paras = bodyArg[2];
     domainEntry = EnvDomainGetEntry(bison->env->domain, id);
     funType = &domainEntry->type->funType;
-    funRef = ATreeNewFunRef(id, funType, paras);
-    level1Expr = ATreeNewFunRefExpr(bison->env->domain, funRef);
+    funRef = ATreeNewFunRef(bison, id, funType, paras);
+    level1Expr = ATreeNewFunRefExpr(bison, bison->env->domain, funRef);
     *headArg = level1Expr;
     return 0;
 }
 
-/*fun_parameters -> fun_paras*/
-static int BisonFunparametersFpHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    FunRefParas *paras;
-
-    (void)prevArg;
-    paras = bodyArg[0];
-    *headArg = paras;
-    return 0;
-}
-
 /*fun_parameters -> empty*/
 static int BisonFunparametersEmptyHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
@@ -1398,7 +1362,7 @@ static int BisonFunparasEcfHandle(void **headArg, void *prevArg, void *bodyArg[]
     (void)prevArg;
     expr = bodyArg[0];
     next = bodyArg[2];
-    paras = ATreeNewFunRefParas(expr, next);
+    paras = ATreeNewFunRefParas(bison, expr, next);
     *headArg = paras;
     return 0;
 }
@@ -1411,24 +1375,11 @@ static int BisonFunparasEHandle(void **headArg, void *prevArg, void *bodyArg[])
 
     (void)prevArg;
     expr = bodyArg[0];
-    paras = ATreeNewFunRefParas(expr, NULL);
+    paras = ATreeNewFunRefParas(bison, expr, NULL);
     *headArg = paras;
     return 0;
 }
 
-/*expr -> assign_expr*/
-static int BisonExprAssignHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *expr;
-    Expr *assignExpr;
-
-    (void)prevArg;
-    assignExpr = bodyArg[0];
-    expr = assignExpr;
-    *headArg = expr;
-    return 0;
-}
-
 /*assign_expr -> lvalue = assign_expr1*/
 static int BisonAssigLeAnHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
@@ -1438,7 +1389,7 @@ static int BisonAssigLeAnHandle(void **headArg, void *prevArg, void *bodyArg[])
     (void)prevArg;
     lValueExpr = bodyArg[0];
     AssignExpr1 = bodyArg[2];
-    assignExpr = ATreeNewBinExpr(bison->env->domain, ET_ASSIGN, ATreeExprType(lValueExpr), lValueExpr, AssignExpr1);
+    assignExpr = ATreeNewBinExpr(bison, bison->env->domain, ET_ASSIGN, ATreeExprType(bison, lValueExpr), lValueExpr, AssignExpr1);
     *headArg = assignExpr;
     return 0;
 }
@@ -1452,293 +1403,132 @@ static int BisonAssigRpAnHandle(void **headArg, void *prevArg, void *bodyArg[])
     (void)prevArg;
     refPointer = bodyArg[0];
     AssignExpr1 = bodyArg[2];
-    assignExpr = ATreeNewBinExpr(bison->env->domain, ET_ASSIGN, ATreeExprType(refPointer), refPointer, AssignExpr1);
+    assignExpr = ATreeNewBinExpr(bison, bison->env->domain, ET_ASSIGN, ATreeExprType(bison, refPointer), refPointer, AssignExpr1);
     *headArg = assignExpr;
     return 0;
 }
 
-/*assign_expr -> lor_expr*/
-static int BisonAssignLHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *assignExpr;
-    Expr *lorExpr;
-
-    (void)prevArg;
-    lorExpr = bodyArg[0];
-    assignExpr = lorExpr;
-    *headArg = assignExpr;
-    return 0;
-}
-
-/*lor_expr -> lor_expr1 || land_expr*/
-static int BisonLorLolandHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *lorExpr;
-    Expr *lorExpr1, *landExpr;
-
-    (void)prevArg;
-    lorExpr1 = bodyArg[0];
-    landExpr = bodyArg[2];
-    lorExpr = ATreeNewBinExpr(bison->env->domain, ET_LOR, bison->env->boolType, lorExpr1, landExpr);
-    *headArg = lorExpr;
-    return 0;
-}
-
-/*lor_expr -> land_expr*/
-static int BisonLorLandHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *lorExpr;
-    Expr *landExpr;
-
-    (void)prevArg;
-    landExpr = bodyArg[0];
-    lorExpr = landExpr;
-    *headArg = lorExpr;
-    return 0;
-}
-
-/*land_expr -> land_expr1 && rel_l0_expr*/
-static int BisonLandlaRelHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *landExpr;
-    Expr *landExpr1, *relL0Expr;
-
-    (void)prevArg;
-    landExpr1 = bodyArg[0];
-    relL0Expr = bodyArg[2];
-    landExpr = ATreeNewBinExpr(bison->env->domain, ET_LAND, bison->env->boolType, landExpr1, relL0Expr);
-    *headArg = landExpr;
-    return 0;
-}
-
-/*land_expr -> rel_l0_expr*/
-static int BisonLandRelHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *landExpr;
-    Expr *relL0Expr;
-
-    (void)prevArg;
-    relL0Expr = bodyArg[0];
-    landExpr = relL0Expr;
-    *headArg = landExpr;
-    return 0;
-}
-
-/*rel_l0_expr -> arith_l0_expr1 == arith_l0_expr2*/
-static int BisonRel0AritheaHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *relL0Expr;
-    Expr *arithL0Expr1, *arithL0Expr2;
-
-    (void)prevArg;
-    arithL0Expr1 = bodyArg[0];
-    arithL0Expr2 = bodyArg[2];
-    relL0Expr = ATreeNewBinExpr(bison->env->domain, ET_EQ, bison->env->boolType, arithL0Expr1, arithL0Expr2);
-    *headArg = relL0Expr;
-    return 0;
-}
-
-/*rel_l0_expr -> arith_l0_expr1 != arith_l0_expr2*/
-static int BisonRel0ArithneaHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*
+ * 功能：生成二元运算表达式，逻辑运算和关系运算的结果是bool类型，算术运算的结果取两个操作数中较宽的类型。
+ * 返回值：
+ **/
+static int BisonBinExpr(void **headArg, void *bodyArg[], ExprType exprType)
 {
-    Expr *relL0Expr;
-    Expr *arithL0Expr1, *arithL0Expr2;
+    Expr *binExpr;
+    Expr *lExpr, *rExpr;
+    Type *type;
 
-    (void)prevArg;
-    arithL0Expr1 = bodyArg[0];
-    arithL0Expr2 = bodyArg[2];
-    relL0Expr = ATreeNewBinExpr(bison->env->domain, ET_NE, bison->env->boolType, arithL0Expr1, arithL0Expr2);
-    *headArg = relL0Expr;
+    lExpr = bodyArg[0];
+    rExpr = bodyArg[2];
+    switch (exprType) {
+    case ET_LOR:
+    case ET_LAND:
+    case ET_EQ:
+    case ET_NE:
+    case ET_GT:
+    case ET_GE:
+    case ET_LT:
+    case ET_LE:
+        type = bison->env->boolType;
+        break;
+    default:
+        type = ATreeExprWiddenType(bison, exprType, lExpr, rExpr);
+        break;
+    }
+    binExpr = ATreeNewBinExpr(bison, bison->env->domain, exprType, type, lExpr, rExpr);
+    *headArg = binExpr;
     return 0;
 }
 
-/*rel_l0_expr -> rel_l1_expr*/
-static int BisonRel0Rel1Handle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 || bin_expr2*/
+static int BisonBinLorHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *relL0Expr;
-    Expr *relL1Expr;
-
     (void)prevArg;
-    relL1Expr = bodyArg[0];
-    relL0Expr = relL1Expr;
-    *headArg = relL0Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_LOR);
 }
 
-/*rel_l1_expr -> arith_l0_expr > arith_l0_expr*/
-static int BisonRel1ArithgtaHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 && bin_expr2*/
+static int BisonBinLandHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *relL1Expr;
-    Expr *arithL0Expr1, *arithL0Expr2;
-
     (void)prevArg;
-    arithL0Expr1 = bodyArg[0];
-    arithL0Expr2 = bodyArg[2];
-    relL1Expr = ATreeNewBinExpr(bison->env->domain, ET_GT, bison->env->boolType, arithL0Expr1, arithL0Expr2);
-    *headArg = relL1Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_LAND);
 }
 
-/*rel_l1_expr -> arith_l0_expr >= arith_l0_expr*/
-static int BisonRel1ArithgeaHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 == bin_expr2*/
+static int BisonBinEqHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *relL1Expr;
-    Expr *arithL0Expr1, *arithL0Expr2;
-
     (void)prevArg;
-    arithL0Expr1 = bodyArg[0];
-    arithL0Expr2 = bodyArg[2];
-    relL1Expr = ATreeNewBinExpr(bison->env->domain, ET_GE, bison->env->boolType, arithL0Expr1, arithL0Expr2);
-    *headArg = relL1Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_EQ);
 }
 
-/*rel_l1_expr -> arith_l0_expr < arith_l0_expr*/
-static int BisonRel1ArithltaHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 != bin_expr2*/
+static int BisonBinNeHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *relL1Expr;
-    Expr *arithL0Expr1, *arithL0Expr2;
-
     (void)prevArg;
-    arithL0Expr1 = bodyArg[0];
-    arithL0Expr2 = bodyArg[2];
-    relL1Expr = ATreeNewBinExpr(bison->env->domain, ET_LT, bison->env->boolType, arithL0Expr1, arithL0Expr2);
-    *headArg = relL1Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_NE);
 }
 
-/*rel_l1_expr -> arith_l0_expr <= arith_l0_expr*/
-static int BisonRel1ArithleaHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 > bin_expr2*/
+static int BisonBinGtHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *relL1Expr;
-    Expr *arithL0Expr1, *arithL0Expr2;
-
     (void)prevArg;
-    arithL0Expr1 = bodyArg[0];
-    arithL0Expr2 = bodyArg[2];
-    relL1Expr = ATreeNewBinExpr(bison->env->domain, ET_LE, bison->env->boolType, arithL0Expr1, arithL0Expr2);
-    *headArg = relL1Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_GT);
 }
 
-/*rel_l1_expr -> arith_l0_expr*/
-static int BisonRel1ArithHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 >= bin_expr2*/
+static int BisonBinGeHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *relL1Expr;
-    Expr *arithL0Expr;
-
     (void)prevArg;
-    arithL0Expr = bodyArg[0];
-    relL1Expr = arithL0Expr;
-    *headArg = relL1Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_GE);
 }
 
-/*arith_l0_expr -> arith_l0_expr1 + arith_l1_expr*/
-static int BisonArith0AaaHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 < bin_expr2*/
+static int BisonBinLtHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *arithL0Expr;
-    Expr *arithL0Expr1, *arithL1Expr;
-    Type *exprType;
-
     (void)prevArg;
-    arithL0Expr1 = bodyArg[0];
-    arithL1Expr = bodyArg[2];
-
-    exprType = ATreeExprWiddenType(ET_ADD, arithL0Expr1, arithL1Expr);
-    arithL0Expr = ATreeNewBinExpr(bison->env->domain, ET_ADD, exprType, arithL0Expr1, arithL1Expr);
-    *headArg = arithL0Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_LT);
 }
 
-/*arith_l0_expr -> arith_l0_expr - arith_l1_expr*/
-static int BisonArith0AsaHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 <= bin_expr2*/
+static int BisonBinLeHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *arithL0Expr;
-    Expr *arithL0Expr1, *arithL1Expr;
-    Type *exprType;
-
     (void)prevArg;
-    arithL0Expr1 = bodyArg[0];
-    arithL1Expr = bodyArg[2];
-    exprType = ATreeExprWiddenType(ET_SUB, arithL0Expr1, arithL1Expr);
-    arithL0Expr = ATreeNewBinExpr(bison->env->domain, ET_SUB, exprType, arithL0Expr1, arithL1Expr);
-    *headArg = arithL0Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_LE);
 }
 
-/*arith_l0_expr -> arith_l1_expr*/
-static int BisonArith0AHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 + bin_expr2*/
+static int BisonBinAddHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *arithL0Expr;
-    Expr *arithL1Expr;
-
     (void)prevArg;
-    arithL1Expr = bodyArg[0];
-    arithL0Expr = arithL1Expr;
-    *headArg = arithL0Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_ADD);
 }
 
-/*arith_l1_expr -> arith_l1_expr1 * level2_expr*/
-static int BisonArith1AmlHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 - bin_expr2*/
+static int BisonBinSubHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *arithL1Expr;
-    Expr *arithL1Expr1, *level2Expr;
-    Type *exprType;
-
     (void)prevArg;
-    arithL1Expr1 = bodyArg[0];
-    level2Expr = bodyArg[2];
-    exprType = ATreeExprWiddenType(ET_MUL, arithL1Expr1, level2Expr);
-    arithL1Expr = ATreeNewBinExpr(bison->env->domain, ET_MUL, exprType, arithL1Expr1, level2Expr);
-    *headArg = arithL1Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_SUB);
 }
 
-/*arith_l1_expr -> arith_l1_expr / level2_expr*/
-static int BisonArith1AdlHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 * bin_expr2*/
+static int BisonBinMulHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *arithL1Expr;
-    Expr *arithL1Expr1, *level2Expr;
-    Type *exprType;
-
     (void)prevArg;
-    arithL1Expr1 = bodyArg[0];
-    level2Expr = bodyArg[2];
-    exprType = ATreeExprWiddenType(ET_DIV, arithL1Expr1, level2Expr);
-    arithL1Expr = ATreeNewBinExpr(bison->env->domain, ET_DIV, exprType, arithL1Expr1, level2Expr);
-    *headArg = arithL1Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_MUL);
 }
 
-/*arith_l1_expr -> arith_l1_expr % level2_expr*/
-static int BisonArith1AmodlHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 / bin_expr2*/
+static int BisonBinDivHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *arithL1Expr;
-    Expr *arithL1Expr1, *level2Expr;
-    Type *exprType;
-
     (void)prevArg;
-    arithL1Expr1 = bodyArg[0];
-    level2Expr = bodyArg[2];
-    exprType = ATreeExprWiddenType(ET_MOD, arithL1Expr1, level2Expr);
-    arithL1Expr = ATreeNewBinExpr(bison->env->domain, ET_MOD, exprType, arithL1Expr1, level2Expr);
-    *headArg = arithL1Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_DIV);
 }
 
-/*arith_l1_expr -> level2_expr*/
-static int BisonArith1LHandle(void **headArg, void *prevArg, void *bodyArg[])
+/*bin_expr -> bin_expr1 % bin_expr2*/
+static int BisonBinModHandle(void **headArg, void *prevArg, void *bodyArg[])
 {
-    Expr *arithL1Expr;
-    Expr *level2Expr;
-
     (void)prevArg;
-    level2Expr = bodyArg[0];
-    arithL1Expr = level2Expr;
-    *headArg = arithL1Expr;
-    return 0;
+    return BisonBinExpr(headArg, bodyArg, ET_MOD);
 }
 
 /*level2_expr -> ! level2_expr2*/
@@ -1749,7 +1539,7 @@ static int BisonLevel2Nl2Handle(void **headArg, void *prevArg, void *bodyArg[])
 
     (void)prevArg;
     level2Expr2 = bodyArg[1];
-    level2Expr = ATreeNewUnaryExpr(bison->env->domain, ET_LNOT, bison->env->boolType, level2Expr2);
+    level2Expr = ATreeNewUnaryExpr(bison, bison->env->domain, ET_LNOT, bison->env->boolType, level2Expr2);
     *headArg = level2Expr;
     return 0;
 }
@@ -1764,25 +1554,14 @@ static int BisonRefpointerSl2Handle(void **headArg, void *prevArg, void *bodyArg
 
     (void)prevArg;
     level2Expr2 = bodyArg[1];
-    refExprType = ATreeExprType(level2Expr2);
+    refExprType = ATreeExprType(bison, level2Expr2);
     if (refExprType->type == TT_POINTER) {
         type = refExprType->pointer.type;
     } else {
         PrErr("refExprType->type error: %d", refExprType->type);
-        exit(-1);
+        CplExit(-1);
     }
-    level2Expr = ATreeNewUnaryExpr(bison->env->domain, ET_REF_POINTER, type, level2Expr2);
-    *headArg = level2Expr;
-    return 0;
-}
-
-/* level2_expr -> ref_pointer*/
-static int BisonLevel2RefpHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *level2Expr;
-
-    (void)prevArg;
-    level2Expr = bodyArg[0];
+    level2Expr = ATreeNewUnaryExpr(bison, bison->env->domain, ET_REF_POINTER, type, level2Expr2);
     *headArg = level2Expr;
     return 0;
 }
@@ -1797,9 +1576,9 @@ static int BisonLevel2Al2Handle(void **headArg, void *prevArg, void *bodyArg[])
 
     (void)prevArg;
     level2Expr2 = bodyArg[1];
-    pointType = ATreeExprType(level2Expr2);
-    type = ATreeNewPointerType(pointType);
-    level2Expr = ATreeNewUnaryExpr(bison->env->domain, ET_GET_ADDR, type, level2Expr2);
+    pointType = ATreeExprType(bison, level2Expr2);
+    type = ATreeNewPointerType(bison, pointType);
+    level2Expr = ATreeNewUnaryExpr(bison, bison->env->domain, ET_GET_ADDR, type, level2Expr2);
     *headArg = level2Expr;
     return 0;
 }
@@ -1814,20 +1593,7 @@ static int BisonLevel2Tcl2Handle(void **headArg, void *prevArg, void *bodyArg[])
     (void)prevArg;
     level2Expr2 = bodyArg[1];
     type = bodyArg[0];
-    level2Expr = ATreeNewUnaryExpr(bison->env->domain, ET_TYPE_CAST, type, level2Expr2);
-    *headArg = level2Expr;
-    return 0;
-}
-
-/*level2_expr -> factor*/
-static int BisonLevel2FactorHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *level2Expr;
-    Expr *factorExpr;
-
-    (void)prevArg;
-    factorExpr = bodyArg[0];
-    level2Expr = factorExpr;
+    level2Expr = ATreeNewUnaryExpr(bison, bison->env->domain, ET_TYPE_CAST, type, level2Expr2);
     *headArg = level2Expr;
     return 0;
 }
@@ -1853,7 +1619,7 @@ static int BisonFactorIHandle(void **headArg, void *prevArg, void *bodyArg[])
 
     (void)prevArg;
     idigitToken = bodyArg[0];
-    factorExpr = ATreeNewCValueExpr(bison->env->domain, CVT_IDIGIT, idigitToken);
+    factorExpr = ATreeNewCValueExpr(bison, bison->env->domain, CVT_IDIGIT, idigitToken);
     *headArg = factorExpr;
     return 0;
 }
@@ -1866,20 +1632,7 @@ static int BisonFactorFHandle(void **headArg, void *prevArg, void *bodyArg[])
 
     (void)prevArg;
     fdigitToken = bodyArg[0];
-    factorExpr = ATreeNewCValueExpr(bison->env->domain, CVT_FDIGIT, fdigitToken);
-    *headArg = factorExpr;
-    return 0;
-}
-
-/*factor -> lvalue*/
-static int BisonFactorLvalueHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *factorExpr;
-    Expr *lValueExpr;
-
-    (void)prevArg;
-    lValueExpr = bodyArg[0];
-    factorExpr = lValueExpr;
+    factorExpr = ATreeNewCValueExpr(bison, bison->env->domain, CVT_FDIGIT, fdigitToken);
     *headArg = factorExpr;
     return 0;
 }
@@ -1911,7 +1664,7 @@ static int BisonM5EHandle(void **headArg, void *parentPrevArg, void *parentBodyA
         Type *elementType;
 
         elementType = parentType->array.type;
-        arrDerefDims = ATreeNewAEDims(elementType, NULL, NULL);
+        arrDerefDims = ATreeNewAEDims(bison, elementType, NULL, NULL);
     } else {
         arrDerefDims = NULL;
     }
@@ -1919,39 +1672,6 @@ static int BisonM5EHandle(void **headArg, void *parentPrevArg, void *parentBodyA
     return 0;
 }
 
-/*lvalue -> id_expr*/
-static int BisonLvalueIdHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *lValueExpr;
-
-    (void)prevArg;
-    lValueExpr = bodyArg[0];
-    *headArg = lValueExpr;
-    return 0;
-}
-
-/*lvalue -> access_element*/
-static int BisonLvalueAccessElmHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *lValueExpr;
-
-    (void)prevArg;
-    lValueExpr = bodyArg[0];
-    *headArg = lValueExpr;
-    return 0;
-}
-
-/*lvalue -> access_member*/
-static int BisonLvalueAccessmemberHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *lValueExpr;
-
-    (void)prevArg;
-    lValueExpr = bodyArg[0];
-    *headArg = lValueExpr;
-    return 0;
-}
-
 static Type *BisonGetAccessMemExprType(Expr *baseExpr, const Token *memId, Expr **offset)
 {
     DomainEntry *entry;
@@ -1959,14 +1679,14 @@ static Type *BisonGetAccessMemExprType(Expr *baseExpr, const Token *memId, Expr
     Domain *stDomain;
     Expr *memOffset;
 
-    baseType = ATreeExprType(baseExpr);
+    baseType = ATreeExprType(bison, baseExpr);
     if (baseType->type != TT_STRUCTURE) {
         PrErr("baseType->type error: %d", baseType->type);
-        exit(-1);
+        CplExit(-1);
     }
     stDomain = baseType->st.domain;
     entry = EnvDomainGetEntry(stDomain, memId);
-    memOffset = ATreeNewCValueSpcIntExpr(bison->env->domain, entry->offset);
+    memOffset = ATreeNewCValueSpcIntExpr(bison, bison->env->domain, entry->offset);
     *offset = memOffset;
     return entry->type;
 }
@@ -1984,7 +1704,7 @@ static int BisonMemaccessLvdiHandle(void **headArg, void *prevArg, void *bodyArg
     baseExpr = bodyArg[0];
     memId = bodyArg[2];
     memType = BisonGetAccessMemExprType(baseExpr, memId, &memOffset);
-    memAccessExpr = ATreeNewAccessMem(bison->env->domain, AMTYPE_DIRECT, baseExpr, memId, memType, memOffset);
+    memAccessExpr = ATreeNewAccessMem(bison, bison->env->domain, AMTYPE_DIRECT, baseExpr, memId, memType, memOffset);
     *headArg = memAccessExpr;
     return 0;
 }
@@ -2002,7 +1722,7 @@ static int BisonMemaccessMadiHandle(void **headArg, void *prevArg, void *bodyArg
     baseExpr = bodyArg[0];
     memId = bodyArg[2];
     memType = BisonGetAccessMemExprType(baseExpr, memId, &memOffset);
-    memAccessExpr = ATreeNewAccessMem(bison->env->domain, AMTYPE_DIRECT, baseExpr, memId, memType, memOffset);
+    memAccessExpr = ATreeNewAccessMem(bison, bison->env->domain, AMTYPE_DIRECT, baseExpr, memId, memType, memOffset);
     *headArg = memAccessExpr;
     return 0;
 }
@@ -2014,20 +1734,20 @@ static Type *BisonGetAccessMemExprType2(Expr *baseExpr, const Token *memId, Expr
     Domain *stDomain;
     Expr *memOffset;
 
-    baseType = ATreeExprType(baseExpr);
+    baseType = ATreeExprType(bison, baseExpr);
 
     if (baseType->type != TT_POINTER) {
         PrErr("baseType->type error: %d", baseType->type);
-        exit(-1);
+        CplExit(-1);
     }
     baseType = baseType->pointer.type;
     if (baseType->type != TT_STRUCTURE) {
         PrErr("baseType->type error: %d", baseType->type);
-        exit(-1);
+        CplExit(-1);
     }
     stDomain = baseType->st.domain;
     entry = EnvDomainGetEntry(stDomain, memId);
-    memOffset = ATreeNewCValueSpcIntExpr(bison->env->domain, entry->offset);
+    memOffset = ATreeNewCValueSpcIntExpr(bison, bison->env->domain, entry->offset);
     *offset = memOffset;
     return entry->type;
 }
@@ -2045,7 +1765,7 @@ static int BisonMemaccessLvpiHandle(void **headArg, void *prevArg, void *bodyArg
     baseExpr = bodyArg[0];
     memId = bodyArg[2];
     memType = BisonGetAccessMemExprType2(baseExpr, memId, &memOffset);
-    memAccessExpr = ATreeNewAccessMem(bison->env->domain, AMTYPE_INDIRECT, baseExpr, memId, memType, memOffset);
+    memAccessExpr = ATreeNewAccessMem(bison, bison->env->domain, AMTYPE_INDIRECT, baseExpr, memId, memType, memOffset);
     *headArg = memAccessExpr;
     return 0;
 }
@@ -2063,55 +1783,11 @@ static int BisonMemaccessMapiHandle(void **headArg, void *prevArg, void *bodyArg
     baseExpr = bodyArg[0];
     memId = bodyArg[2];
     memType = BisonGetAccessMemExprType2(baseExpr, memId, &memOffset);
-    memAccessExpr = ATreeNewAccessMem(bison->env->domain, AMTYPE_INDIRECT, baseExpr, memId, memType, memOffset);
+    memAccessExpr = ATreeNewAccessMem(bison, bison->env->domain, AMTYPE_INDIRECT, baseExpr, memId, memType, memOffset);
     *headArg = memAccessExpr;
     return 0;
 }
 
-/*level1_expr -> access_mem*/
-static int BisonLevel1exprAccessmemHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *level1Expr;
-
-    (void)prevArg;
-    level1Expr = bodyArg[0];
-    *headArg = level1Expr;
-    return 0;
-}
-
-/*level1_expr -> fun_call*/
-static int BisonLevel1exprFuncallHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *level1Expr;
-
-    (void)prevArg;
-    level1Expr = bodyArg[0];
-    *headArg = level1Expr;
-    return 0;
-}
-
-/*level1_expr -> access_element*/
-static int BisonLevel1exprAccesselmHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *level1Expr;
-
-    (void)prevArg;
-    level1Expr = bodyArg[0];
-    *headArg = level1Expr;
-    return 0;
-}
-
-/*level1_expr -> factor*/
-static int BisonLevel1exprFactorHandle(void **headArg, void *prevArg, void *bodyArg[])
-{
-    Expr *level1Expr;
-
-    (void)prevArg;
-    level1Expr = bodyArg[0];
-    *headArg = level1Expr;
-    return 0;
-}
-
 /*M6 -> empty*/
 static int BisonM6EHandle(void **headArg, void *parentPrevArg, void *parentBodyArg[])
 {
@@ -2124,14 +1800,14 @@ static int BisonM6EHandle(void **headArg, void *parentPrevArg, void *parentBodyA
 
     if (!parentArrDerefDims) {
         PrErr("syntax error, decl is not array\n");
-        exit(-1);
+        CplExit(-1);
     }
     prevType = parentArrDerefDims->type;
     if (prevType->type == TT_ARRAY) {
         Type *elementType;
 
         elementType = prevType->array.type;
-        arrDerefDims = ATreeNewAEDims(elementType, NULL, NULL);
+        arrDerefDims = ATreeNewAEDims(bison, elementType, NULL, NULL);
     } else {
         arrDerefDims = NULL;
     }
@@ -2151,7 +1827,7 @@ static int BisonDedimLidHandle(void **headArg, void *prevArg, void *bodyArg[])
     idxExpr = bodyArg[1];
 
     arrDerefDims->nextDims = arrDerefDims1;
-    arrDerefDims->idx = idxExpr;
+    arrDerefDims->idx = ATREE_ID(idxExpr);
     *headArg = arrDerefDims;
     return 0;
 }
@@ -2175,7 +1851,7 @@ static int BisonArridxIdigitHandle(void **headArg, void *prevArg, void *bodyArg[
 
     (void)prevArg;
     idigitToken = bodyArg[0];
-    arrIdxExpr = ATreeNewCValueExpr(bison->env->domain, CVT_IDIGIT, idigitToken);
+    arrIdxExpr = ATreeNewCValueExpr(bison, bison->env->domain, CVT_IDIGIT, idigitToken);
     *headArg = arrIdxExpr;
     return 0;
 }
@@ -2193,9 +1869,9 @@ static int BisonIdexprIdHandle(void **headArg, void *prevArg, void *bodyArg[])
     entry = EnvDomainGetEntry(domain, id);
     if (!entry) {
         PrErr("entry error: %p\n", entry);
-        exit(-1);
+        CplExit(-1);
     }
-    idExpr = ATreeNewIdExpr(domain, id, entry->type);
+    idExpr = ATreeNewIdExpr(bison, domain, id, entry->type);
     *headArg = idExpr;
     return 0;
 }
@@ -2214,7 +1890,7 @@ static void BisonAccessEmlDimsInferType(Type *superiorType, AEDims *dims, Type *
         type = superiorType->pointer.type;
     } else {
         PrErr("superiorType->type error: %d", superiorType->type);
-        exit(-1);
+        CplExit(-1);
     }
     dims->type = type;
     *pType = type;
@@ -2236,10 +1912,10 @@ static int BisonAccesselmIddimdimsHandle(void **headArg, void *prevArg, void *bo
     (void)prevArg;
     idx = bodyArg[1];
     nextDims = bodyArg[2];
-    dims = ATreeNewAEDims(NULL, idx, nextDims);
+    dims = ATreeNewAEDims(bison, NULL, idx, nextDims);
     baseExpr = bodyArg[0];
-    accessElm = ATreeNewAccessElmExpr(bison->env->domain, baseExpr, dims, NULL);
-    BisonAccessEmlDimsInferType(ATreeExprType(baseExpr), accessElm->accessElm.dims, &accessElmType);
+    accessElm = ATreeNewAccessElmExpr(bison, bison->env->domain, baseExpr, dims, NULL);
+    BisonAccessEmlDimsInferType(ATreeExprType(bison, baseExpr), accessElm->accessElm.dims, &accessElmType);
     accessElm->accessElm.type = accessElmType;
     *headArg = accessElm;
     return 0;
@@ -2255,7 +1931,7 @@ static int BisonDimsDimdimsHandle(void **headArg, void *prevArg, void *bodyArg[]
     (void)prevArg;
     idx = bodyArg[0];
     nextDims = bodyArg[1];
-    dims = ATreeNewAEDims(NULL, idx, nextDims);
+    dims = ATreeNewAEDims(bison, NULL, idx, nextDims);
     *headArg = dims;
     return 0;
 }
@@ -2282,6 +1958,10 @@ static int  BisonDimLidxrHandle(void **headArg, void *prevArg, void *bodyArg[])
     return 0;
 }
 
+#ifdef BISON_STATIC_TABLE
+#include "bison_table.inc"
+#endif
+
 /*
  * 功能：添加文法的产生式和相关的归约处理函数。
  * 返回值：
@@ -2342,7 +2022,7 @@ static int GrammarAddProduct(ContextFreeGrammar *grammar)
     error = CfgAddProductH(grammar, RHT_SELF, BisonTypeTsHandle, SYMID_ARR(SID_TYPE, SID_TYPE, SID_TM_MUL));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonTypeStHandle, SYMID_ARR(SID_TYPE, SID_STRUCT_TYPE));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_TYPE, SID_STRUCT_TYPE));
     if (error != -ENOERR)
         goto err;
     error = CfgAddProductH(grammar, RHT_SELF, BisonStructTypeSiHandle, SYMID_ARR(SID_STRUCT_TYPE, SID_TM_STRUCT, SID_TM_ID));
@@ -2423,7 +2103,7 @@ static int GrammarAddProduct(ContextFreeGrammar *grammar)
     if (error != -ENOERR)
         goto err;
     /*块语句*/
-    error = CfgAddProductH(grammar, RHT_SELF, BisonStmtBHandle, SYMID_ARR(SID_STMT, SID_BLOCK));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_STMT, SID_BLOCK));
     if (error != -ENOERR)
         goto err;
     error = CfgAddProductH(grammar, RHT_SELF, BisonStmtBsHandle, SYMID_ARR(SID_STMT, SID_TM_BREAK, SID_TM_SEMI_COLON));
@@ -2432,7 +2112,7 @@ static int GrammarAddProduct(ContextFreeGrammar *grammar)
     error = CfgAddProductH(grammar, RHT_SELF, BisonStmtCsHandle, SYMID_ARR(SID_STMT, SID_TM_CONTINUE, SID_TM_SEMI_COLON));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonCondLorHandle, SYMID_ARR(SID_COND, SID_LOR_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_COND, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
 
@@ -2463,7 +2143,7 @@ static int GrammarAddProduct(ContextFreeGrammar *grammar)
     error = CfgAddProductH(grammar, RHT_SELF, BisonFunrettypeSttHandle, SYMID_ARR(SID_FUN_RET_TYPE, SID_STRUCT_TYPE));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonFunarguesFHandle, SYMID_ARR(SID_FUN_ARGUES, SID_FUN_ARGS));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_FUN_ARGUES, SID_FUN_ARGS));
     if (error != -ENOERR)
         goto err;
     error = CfgAddProductH(grammar, RHT_SELF, BisonFunarguesVHandle, SYMID_ARR(SID_FUN_ARGUES, SID_TM_VOID));
@@ -2513,7 +2193,7 @@ static int GrammarAddProduct(ContextFreeGrammar *grammar)
         goto err;
 
     /*表达式*/
-    error = CfgAddProductH(grammar, RHT_SELF, BisonExprAssignHandle, SYMID_ARR(SID_EXPR, SID_ASSIGN_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_EXPR, SID_ASSIGN_EXPR));
     if (error != -ENOERR)
         goto err;
     error = CfgAddProductH(grammar, RHT_SELF, BisonAssigLeAnHandle, SYMID_ARR(SID_ASSIGN_EXPR, SID_LVALUE, SID_TM_ASSIGN, SID_ASSIGN_EXPR));
@@ -2522,64 +2202,49 @@ static int GrammarAddProduct(ContextFreeGrammar *grammar)
     error = CfgAddProductH(grammar, RHT_SELF, BisonAssigRpAnHandle, SYMID_ARR(SID_ASSIGN_EXPR, SID_REF_POINTER, SID_TM_ASSIGN, SID_ASSIGN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonAssignLHandle, SYMID_ARR(SID_ASSIGN_EXPR, SID_LOR_EXPR));
-    if (error != -ENOERR)
-        goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLorLolandHandle, SYMID_ARR(SID_LOR_EXPR, SID_LOR_EXPR, SID_TM_LOR, SID_LAND_EXPR));
-    if (error != -ENOERR)
-        goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLorLandHandle, SYMID_ARR(SID_LOR_EXPR, SID_LAND_EXPR));
-    if (error != -ENOERR)
-        goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLandlaRelHandle, SYMID_ARR(SID_LAND_EXPR, SID_LAND_EXPR, SID_TM_LAND, SID_REL_L0_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_ASSIGN_EXPR, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLandRelHandle, SYMID_ARR(SID_LAND_EXPR, SID_REL_L0_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinLorHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_LOR, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonRel0AritheaHandle, SYMID_ARR(SID_REL_L0_EXPR, SID_ARITH_L0_EXPR, SID_TM_EQ, SID_ARITH_L0_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinLandHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_LAND, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonRel0ArithneaHandle, SYMID_ARR(SID_REL_L0_EXPR, SID_ARITH_L0_EXPR, SID_TM_NE, SID_ARITH_L0_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinEqHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_EQ, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonRel0Rel1Handle, SYMID_ARR(SID_REL_L0_EXPR, SID_REL_L1_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinNeHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_NE, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonRel1ArithltaHandle, SYMID_ARR(SID_REL_L1_EXPR, SID_ARITH_L0_EXPR, SID_TM_LT, SID_ARITH_L0_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinLtHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_LT, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonRel1ArithleaHandle, SYMID_ARR(SID_REL_L1_EXPR,  SID_ARITH_L0_EXPR, SID_TM_LE, SID_ARITH_L0_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinLeHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_LE, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonRel1ArithgtaHandle, SYMID_ARR(SID_REL_L1_EXPR, SID_ARITH_L0_EXPR, SID_TM_GT, SID_ARITH_L0_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinGtHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_GT, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonRel1ArithgeaHandle, SYMID_ARR(SID_REL_L1_EXPR, SID_ARITH_L0_EXPR, SID_TM_GE, SID_ARITH_L0_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinGeHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_GE, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonRel1ArithHandle, SYMID_ARR(SID_REL_L1_EXPR, SID_ARITH_L0_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinAddHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_ADD, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonArith0AaaHandle, SYMID_ARR(SID_ARITH_L0_EXPR, SID_ARITH_L0_EXPR, SID_TM_ADD, SID_ARITH_L1_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinSubHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_SUB, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonArith0AsaHandle, SYMID_ARR(SID_ARITH_L0_EXPR, SID_ARITH_L0_EXPR, SID_TM_SUB, SID_ARITH_L1_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinMulHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_MUL, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonArith0AHandle, SYMID_ARR(SID_ARITH_L0_EXPR, SID_ARITH_L1_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinDivHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_DIV, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonArith1AmlHandle, SYMID_ARR(SID_ARITH_L1_EXPR, SID_ARITH_L1_EXPR, SID_TM_MUL, SID_LEVEL2_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, BisonBinModHandle, SYMID_ARR(SID_BIN_EXPR, SID_BIN_EXPR, SID_TM_MOD, SID_BIN_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonArith1AdlHandle, SYMID_ARR(SID_ARITH_L1_EXPR, SID_ARITH_L1_EXPR, SID_TM_DIV, SID_LEVEL2_EXPR));
-    if (error != -ENOERR)
-        goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonArith1AmodlHandle, SYMID_ARR(SID_ARITH_L1_EXPR, SID_ARITH_L1_EXPR, SID_TM_MOD, SID_LEVEL2_EXPR));
-    if (error != -ENOERR)
-        goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonArith1LHandle, SYMID_ARR(SID_ARITH_L1_EXPR, SID_LEVEL2_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_BIN_EXPR, SID_LEVEL2_EXPR));
     if (error != -ENOERR)
         goto err;
     error = CfgAddProductH(grammar, RHT_SELF, BisonLevel2Nl2Handle, SYMID_ARR(SID_LEVEL2_EXPR, SID_TM_LNOT, SID_LEVEL2_EXPR));
@@ -2588,7 +2253,7 @@ static int GrammarAddProduct(ContextFreeGrammar *grammar)
     error = CfgAddProductH(grammar, RHT_SELF, BisonRefpointerSl2Handle, SYMID_ARR(SID_REF_POINTER, SID_TM_MUL, SID_LEVEL2_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLevel2RefpHandle, SYMID_ARR(SID_LEVEL2_EXPR, SID_REF_POINTER));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_LEVEL2_EXPR, SID_REF_POINTER));
     if (error != -ENOERR)
         goto err;
     error = CfgAddProductH(grammar, RHT_SELF, BisonLevel2Al2Handle, SYMID_ARR(SID_LEVEL2_EXPR, SID_TM_BNAD, SID_LEVEL2_EXPR));
@@ -2599,7 +2264,7 @@ static int GrammarAddProduct(ContextFreeGrammar *grammar)
     if (error != -ENOERR)
         goto err;
 
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLevel2FactorHandle, SYMID_ARR(SID_LEVEL2_EXPR, SID_LEVEL1_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_LEVEL2_EXPR, SID_LEVEL1_EXPR));
     if (error != -ENOERR)
         goto err;
 
@@ -2610,19 +2275,19 @@ static int GrammarAddProduct(ContextFreeGrammar *grammar)
     error = CfgAddProductH(grammar, RHT_SELF, BisonMemaccessLvpiHandle, SYMID_ARR(SID_ACCESS_MEMBER, SID_LEVEL1_EXPR, SID_TM_ARROW, SID_TM_ID));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLevel1exprAccessmemHandle, SYMID_ARR(SID_LEVEL1_EXPR, SID_ACCESS_MEMBER));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_LEVEL1_EXPR, SID_ACCESS_MEMBER));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLevel1exprFuncallHandle, SYMID_ARR(SID_LEVEL1_EXPR, SID_FUN_CALL));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_LEVEL1_EXPR, SID_FUN_CALL));
     if (error != -ENOERR)
         goto err;
     error = CfgAddProductH(grammar, RHT_SELF, BisonFuncallIlfrHandle, SYMID_ARR(SID_FUN_CALL, SID_TM_ID, SID_TM_LBRACKET, SID_FUN_PARAMETERS, SID_TM_RBRACKET));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLevel1exprAccesselmHandle, SYMID_ARR(SID_LEVEL1_EXPR, SID_ACCESS_ELM));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_LEVEL1_EXPR, SID_ACCESS_ELM));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLevel1exprFactorHandle, SYMID_ARR(SID_LEVEL1_EXPR, SID_FACTOR));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_LEVEL1_EXPR, SID_FACTOR));
     if (error != -ENOERR)
         goto err;
 
@@ -2636,10 +2301,10 @@ static int GrammarAddProduct(ContextFreeGrammar *grammar)
     error = CfgAddProductH(grammar, RHT_SELF, BisonFactorFHandle, SYMID_ARR(SID_FACTOR, SID_TM_FDIGIT));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonFactorLvalueHandle, SYMID_ARR(SID_FACTOR, SID_ID_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_FACTOR, SID_ID_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonFunparametersFpHandle, SYMID_ARR(SID_FUN_PARAMETERS, SID_FUN_PARAS));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_FUN_PARAMETERS, SID_FUN_PARAS));
     if (error != -ENOERR)
         goto err;
     error = CfgAddProductH(grammar, RHT_SELF, BisonFunparametersEmptyHandle, SYMID_ARR(SID_FUN_PARAMETERS, SID_EMPTY));
@@ -2654,13 +2319,13 @@ static int GrammarAddProduct(ContextFreeGrammar *grammar)
     error = CfgAddProductH(grammar, RHT_PARENT, BisonM5EHandle, SYMID_ARR(SID_M5, SID_EMPTY));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLvalueIdHandle, SYMID_ARR(SID_LVALUE, SID_ID_EXPR));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_LVALUE, SID_ID_EXPR));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLvalueAccessElmHandle, SYMID_ARR(SID_LVALUE, SID_ACCESS_ELM));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_LVALUE, SID_ACCESS_ELM));
     if (error != -ENOERR)
         goto err;
-    error = CfgAddProductH(grammar, RHT_SELF, BisonLvalueAccessmemberHandle, SYMID_ARR(SID_LVALUE, SID_ACCESS_MEMBER));
+    error = CfgAddProductH(grammar, RHT_SELF, CfgPassHandle, SYMID_ARR(SID_LVALUE, SID_ACCESS_MEMBER));
     if (error != -ENOERR)
         goto err;
     //error = CfgAddProductH(grammar, RHT_SELF, BisonLvalueIDedimHandle, SYMID_ARR(SID_LVALUE, SID_TM_ID, SID_M5, SID_ARR_DEREF_DIMx));
@@ -2711,6 +2376,50 @@ err:
     return error;
 }
 
+/*
+ * 功能：声明终结符号的优先级和结合性，后声明的优先级高，用于解决二元运算表达式和if else语句的冲突。
+ * 返回值：
+ **/
+static int GrammarAddPrecedence(ContextFreeGrammar *grammar)
+{
+    int error = 0;
+
+    /*else与最近的if相结合：if语句产生式的优先级低于else，遇到else时移入。*/
+    error = CfgAddPrecedence(grammar, SA_NONASSOC, SYMID_ARR(SID_TM_IF));
+    if (error != -ENOERR)
+        goto err;
+    error = CfgAddPrecedence(grammar, SA_NONASSOC, SYMID_ARR(SID_TM_ELSE));
+    if (error != -ENOERR)
+        goto err;
+    error = CfgSetProductPrec(grammar, SID_TM_IF, SYMID_ARR(SID_STMT, SID_TM_IF, SID_TM_LBRACKET, SID_COND, SID_TM_RBRACKET, SID_STMT));
+    if (error != -ENOERR)
+        goto err;
+
+    /*二元运算符*/
+    error = CfgAddPrecedence(grammar, SA_LEFT, SYMID_ARR(SID_TM_LOR));
+    if (error != -ENOERR)
+        goto err;
+    error = CfgAddPrecedence(grammar, SA_LEFT, SYMID_ARR(SID_TM_LAND));
+    if (error != -ENOERR)
+        goto err;
+    error = CfgAddPrecedence(grammar, SA_NONASSOC, SYMID_ARR(SID_TM_EQ, SID_TM_NE));
+    if (error != -ENOERR)
+        goto err;
+    error = CfgAddPrecedence(grammar, SA_NONASSOC, SYMID_ARR(SID_TM_LT, SID_TM_LE, SID_TM_GT, SID_TM_GE));
+    if (error != -ENOERR)
+        goto err;
+    error = CfgAddPrecedence(grammar, SA_LEFT, SYMID_ARR(SID_TM_ADD, SID_TM_SUB));
+    if (error != -ENOERR)
+        goto err;
+    error = CfgAddPrecedence(grammar, SA_LEFT, SYMID_ARR(SID_TM_MUL, SID_TM_DIV, SID_TM_MOD));
+    if (error != -ENOERR)
+        goto err;
+    return 0;
+
+err:
+    return error;
+}
+
 /*
  * 功能：设计文法
  * 返回值：
@@ -2729,6 +2438,9 @@ static int DesignGrammar(ContextFreeGrammar **pGrammar)
     if (error != -ENOERR)
         goto err;
     error = GrammarAddProduct(grammar);
+    if (error != -ENOERR)
+        goto err;
+    error = GrammarAddPrecedence(grammar);
     if (error != -ENOERR)
         goto err;
     return 0;
@@ -2905,8 +2617,53 @@ static int BisonGetCurrentSymId(struct _LrReader *reader)
         return SID_TM_STRUCT;
     }
     PrErr("token tag %u, no match sym id\n", token->tag);
-    exit(-1);
+    CplExit(-1);
+}
+
+#ifdef BISON_PARSE_STAT
+static LrParseStat *bisonParseStat;
+
+static const char *BisonParseStatSymStr(const void *arg, int symId)
+{
+#ifdef BISON_STATIC_TABLE
+    return LrStaticTableSymStr(arg, symId);
+#else
+    return CfgSymbolStr(CfgGetSymbol(arg, symId));
+#endif
+}
+
+static void BisonParseStatExit(void)
+{
+    FILE *fp;
+
+    fp = fopen(BISON_PARSE_STAT_PATH, "w");
+    if (fp) {
+        LrParseStatDump(bisonParseStat, fp);
+        fclose(fp);
+    } else {
+        PrErr("open %s failed\n", BISON_PARSE_STAT_PATH);
+    }
+    LrParseStatFree(bisonParseStat);
+    bisonParseStat = NULL;
+}
+
+/*
+ * 功能：给语法分析器设置统计，统计在多次分析之间累计，进程退出时输出。
+ *      统计没有加锁，只用于单线程编译。
+ * symStrArg：获取符号字符串的参数，静态语法分析表或者文法
+ * 返回值：无
+ **/
+static void BisonParseStatAttach(LrParser *lrParser, const void *symStrArg)
+{
+    if (!bisonParseStat) {
+        if (LrParseStatAlloc(&bisonParseStat) != -ENOERR)
+            return;
+        atexit(BisonParseStatExit);
+    }
+    LrParseStatSetSymStr(bisonParseStat, BisonParseStatSymStr, symStrArg);
+    lrParser->stat = bisonParseStat;
 }
+#endif
 
 /*
  * 功能：文法分析
@@ -2921,7 +2678,19 @@ static int GrammarParse(LrParser *lrParser, Lalr *lalr, Lex *lex)
     lrReader.arg = lex;
 
     LexScan(lex);
+#ifdef BISON_PARSE_STAT
+#ifdef BISON_STATIC_TABLE
+    BisonParseStatAttach(lrParser, &BisonStaticTable);
+#else
+    BisonParseStatAttach(lrParser, lalr->grammar);
+#endif
+#endif
+#ifdef BISON_STATIC_TABLE
+    (void)lalr;
+    return LrParseStatic(lrParser, &BisonStaticTable, &lrReader);
+#else
     return LrParse(lrParser, lalr, &lrReader);
+#endif
 }
 
 /*
@@ -2935,139 +2704,548 @@ static int LrShiftHandle(void **pNode, LrReader *reader)
 }
 
 /*
- * 功能：LR文法Action节点冲突处理函数。
- * 返回值：
+ * 功能：LR文法Action节点冲突处理函数，处理优先级声明无法解决的冲突。
+ * 返回值：冲突已解决时返回0，否则返回错误码。
  **/
 static int BisonActionNodeConflictHandle(Lalr *lalr, ItemSet *itemSet,
                                    ActionNode *actionNode, ActionType type, int la, int id)
 {
-    (void)lalr, (void)actionNode, (void)type, (void)id;
+    Item *item;
 
-    return 0;
-
-    if (itemSet->id == 8) {
-        if (actionNode->type == LAT_REDUCT
-                && type == LAT_REDUCT) {
-            if (actionNode->lookaheadId == SID_TM_STRUCT
-                    || actionNode->lookaheadId == SID_TM_FLOAT
-                    || actionNode->lookaheadId == SID_TM_INT
-                    || actionNode->lookaheadId == SID_TM_CHAR
-                    || actionNode->lookaheadId == SID_TM_SHORT
-                    || actionNode->lookaheadId == SID_TM_BOOL
-                    || actionNode->lookaheadId == SID_TM_VOID) {
-                actionNode->itemSetId = id;                  ///////////////////////////
-                printf("conflict has handled. [reduct %d].\n", actionNode->itemSetId);
-                return 0;
-            }
-        }
-    }
-    if (itemSet->id == 3) {
-        if (actionNode->type == LAT_SHIFT
-                && type == LAT_REDUCT) {
-            if (actionNode->lookaheadId == SID_TM_STRUCT) {
-                printf("conflict has handled. [shift %d].\n", actionNode->itemId);
-                return 0;
-            }
+    (void)lalr;
+    /*结构体定义和函数定义都可以以struct开头，移入struct，按结构体定义分析。*/
+    if (actionNode->type == LAT_SHIFT && type == LAT_REDUCT && la == SID_TM_STRUCT) {
+        item = LalrItemSetGetItem(itemSet, id);
+        if (item && item->productRef.headSymId == SID_M7) {
+            printf("conflict has handled. [shift %d].\n", actionNode->itemSetId);
+            return 0;
         }
     }
-    if (itemSet->id == 1) {
-        if (actionNode->type == LAT_REDUCT
-                && type == LAT_REDUCT) {
-            if (la == SID_END) {
-                printf("conflict has handled. [reduct %d].\n", actionNode->itemSetId);
-                return 0;
-            }
-        }
-    }
-    if (itemSet->id == 173) {     /*处理if语句和if else语句的冲突，else与最近的if相结合。*/
-        if (actionNode->type == LAT_SHIFT
-                && type == LAT_REDUCT)
-            if (la == SID_TM_ELSE) {
-                printf("conflict has handled\n");
-                return 0;
-            }
-    }
     return -ESYNTAX;
 }
 
 /*
- * 功能：构建抽象语法树。
- * 返回值：
+ * 功能：设计文法并生成LALR语法分析表。
+ * pGrammar：输出型参数，文法
+ * pLalr：输出型参数，LALR语法分析表
+ * laCheck：为1时先用两种向前看符号算法生成语法分析表并比较结果，不同时失败
+ * 返回值：成功时返回0，否则返回错误码。
  **/
-static int BuildTree(Lex *lex)
+static int BisonGenLalr(ContextFreeGrammar **pGrammar, Lalr **pLalr, int laCheck)
 {
     int error = 0;
     ContextFreeGrammar *grammar = NULL;
     Lalr *lalr;
-    LrErrorRecover *lrErrorRecover;
-    LrParser *lrParser;
 
     error = DesignGrammar(&grammar);
     if (error != -ENOERR)
-        goto err0;
+        return error;
     CfgPrintProduct(grammar);
 
+    if (laCheck) {
+        error = LalrCheckLookahead(grammar, NULL, BisonActionNodeConflictHandle);
+        if (error != -ENOERR)
+            goto err1;
+    }
     error = LalrAlloc(&lalr, grammar, NULL, BisonActionNodeConflictHandle);
     if (error != -ENOERR)
         goto err1;
+    LalrSetLookaheadType(lalr, LLT_DEREMER_PENNELLO);
+    LalrSetThreadNum(lalr, BISON_LALR_THREAD_NUM);
     error = GenLrParseTable(lalr);
     if (error != -ENOERR)
         goto err2;
 
     //LalrPrintItemSet(lalr);
     //LalrPrintParseTable(lalr);
+    *pGrammar = grammar;
+    *pLalr = lalr;
+    return 0;
+
+err2:
+    LalrFree(lalr);
+err1:
+    ContextFreeGrammarFree(grammar);
+    return error;
+}
+
+#ifndef BISON_STATIC_TABLE
+/*运行时构造的文法和语法分析表，只构造一次，所有编译上下文只读共享*/
+static pthread_once_t bisonLalrOnce = PTHREAD_ONCE_INIT;
+static ContextFreeGrammar *bisonGrammar;
+static Lalr *bisonLalr;
+static int bisonLalrError;
+
+static void BisonLalrFree(void)
+{
+    LalrFree(bisonLalr);
+    ContextFreeGrammarFree(bisonGrammar);
+    bisonLalr = NULL;
+    bisonGrammar = NULL;
+}
+
+static void BisonLalrInit(void)
+{
+    bisonLalrError = BisonGenLalr(&bisonGrammar, &bisonLalr, BISON_LA_CHECK_FLAG);
+    if (bisonLalrError == -ENOERR)
+        atexit(BisonLalrFree);
+}
+
+/*
+ * 功能：获取共享的LALR语法分析表，第一次调用时构造。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int BisonGetLalr(Lalr **pLalr)
+{
+    pthread_once(&bisonLalrOnce, BisonLalrInit);
+    *pLalr = bisonLalr;
+    return bisonLalrError;
+}
+#endif
+
+/*
+ * 功能：构建抽象语法树。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int BuildTree(Bison *ctx)
+{
+    int error = 0;
+    Lalr *lalr = NULL;
 
-    error = LrErrorRecoverAlloc(&lrErrorRecover, SYMID_ARR(SID_BLOCK, SID_STMTS));
+#ifndef BISON_STATIC_TABLE
+    error = BisonGetLalr(&lalr);
     if (error != -ENOERR)
-        goto err2;
-    error = LrParserAlloc(&lrParser, LrShiftHandle, lrErrorRecover);
+        goto err;
+#endif
+
+    error = LrErrorRecoverAlloc(&ctx->errorRecover, SYMID_ARR(BISON_RECOVER_SYMIDS));
     if (error != -ENOERR)
-        goto err3;
-    error = GrammarParse(lrParser, lalr, lex);
+        goto err;
+    error = LrParserAlloc(&ctx->parser, LrShiftHandle, ctx->errorRecover);
+    if (error != -ENOERR)
+        goto err;
+    ctx->parser->acceptPrintFlag = ctx->dumpFlag;
+    error = GrammarParse(ctx->parser, lalr, ctx->lex);
     if (error != -ENOERR)
-        goto err4;
-    if (lrParser->syntaxErrorFlag == 1) {
+        goto err;
+    if (ctx->parser->syntaxErrorFlag == 1) {
         error = -ESYNTAX;
-        goto err4;
+        goto err;
     }
+    return error;
+
+err:
+    PrErr("syntax error\n");
+    return error;
+}
 
-    LrParserFree(lrParser);
-    LrErrorReocverFree(lrErrorRecover);
+/*
+ * 功能：释放语法分析器。归约句柄中的语义错误经CplExit直接跳到退出点，BuildTree来不及释放，
+ *      所以语法分析器记录在上下文中，由退出点统一释放。
+ * 返回值：无
+ **/
+static void BisonFreeParser(Bison *ctx)
+{
+    if (ctx->parser) {
+        LrParserFree(ctx->parser);
+        ctx->parser = NULL;
+    }
+    LrErrorReocverFree(ctx->errorRecover);
+    ctx->errorRecover = NULL;
+}
+
+/*
+ * 功能：生成静态语法分析表的C源文件，供BISON_STATIC_TABLE使用。
+ *      生成之前检查两种向前看符号算法得到的语法分析表相同。
+ * path：输出文件路径
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int BisonGenStaticTable(const char *path)
+{
+    int error = 0;
+    ContextFreeGrammar *grammar = NULL;
+    Lalr *lalr = NULL;
+    FILE *fp;
+
+    if (!path)
+        return -EINVAL;
+
+    error = BisonGenLalr(&grammar, &lalr, 1);
+    if (error != -ENOERR)
+        return error;
+    fp = fopen(path, "w");
+    if (!fp) {
+        error = -EMISC;
+        goto err;
+    }
+    error = LalrEmitStaticTable(lalr, "Bison", BISON_TABLE_EMIT_FLAGS, SYMID_ARR(BISON_RECOVER_SYMIDS), fp);
+    if (fclose(fp) != 0 && error == -ENOERR)
+        error = -EMISC;
+
+err:
     LalrFree(lalr);
     ContextFreeGrammarFree(grammar);
     return error;
+}
 
-err4:
-    LrParserFree(lrParser);
-err3:
-    LrErrorReocverFree(lrErrorRecover);
-err2:
-    LalrFree(lalr);
-err1:
+/*
+ * 功能：把词法分析器中剩余的记号转换成文法符号id数组，不包含结束符号，供增量语法分析使用。
+ *      记号在词法分析器的单词表中，词法分析器释放之前一直有效。
+ * pSymIdArr：输出型参数，符号id数组，由调用者释放
+ * pTokenArr：输出型参数，记号数组，元素是const Token *，和符号id一一对应，由调用者释放，可以为NULL
+ * pLen：输出型参数，数组长度
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int BisonLexSymIdArr(Lex *lex, int **pSymIdArr, void ***pTokenArr, int *pLen)
+{
+    LrReader lrReader;
+    int *symIdArr = NULL, *tempArr;
+    void **tokenArr = NULL, **tempTokenArr;
+    int len = 0, size = 0;
+    int symId;
+
+    if (!lex || !pSymIdArr || !pLen)
+        return -EINVAL;
+
+    lrReader.getCurrentSymId = BisonGetCurrentSymId;
+    lrReader.inputPosInc = BisonInputPosInc;
+    lrReader.arg = lex;
+    LexScan(lex);
+    while ((symId = BisonGetCurrentSymId(&lrReader)) != SID_END) {
+        if (len >= size) {
+            size = size ? size * 2 : 256;
+            tempArr = realloc(symIdArr, size * sizeof (*symIdArr));
+            tempTokenArr = pTokenArr ? realloc(tokenArr, size * sizeof (*tokenArr)) : NULL;
+            if (tempArr)
+                symIdArr = tempArr;
+            if (tempTokenArr)
+                tokenArr = tempTokenArr;
+            if (!tempArr || (pTokenArr && !tempTokenArr)) {
+                free(symIdArr);
+                free(tokenArr);
+                return -ENOMEM;
+            }
+        }
+        symIdArr[len] = symId;
+        if (tokenArr)
+            tokenArr[len] = (void *)LexCurrent(lex);
+        len++;
+        BisonInputPosInc(&lrReader);
+    }
+    *pSymIdArr = symIdArr;
+    if (pTokenArr)
+        *pTokenArr = tokenArr;
+    *pLen = len;
+    return 0;
+}
+
+#ifdef BISON_STATIC_TABLE
+/*
+ * 增量分析中执行的归约句柄：只用产生式体的语义值构造结果，不查找和修改环境，
+ * 不使用产生式体前面的参数，也不修改产生式体的语义值，结果可以随子树复用。
+ **/
+static ProductBodyHandle *const bisonIncPureHandleArr[] = {
+    CfgPassHandle,
+    BisonDeclsEHandle,
+    BisonStmtsEHandle,
+    BisonCasestmtsEHandle,
+    BisonFundefinesEmptyHandle,
+    BisonFunrettypeVHandle,
+    BisonFunrettypeBtHandle,
+    BisonFunrettypeSttHandle,
+    BisonFunarguesVHandle,
+    BisonFunarguesEmptyHandle,
+    BisonFunargsFcfHandle,
+    BisonFunargsFHandle,
+    BisonStructdhStidHandle,
+    BisonStructM10EmptyHandle,
+    BisonTypecastLtrHandle,
+    BisonFunparametersEmptyHandle,
+    BisonFunparasEcfHandle,
+    BisonFunparasEHandle,
+    BisonFactorLerHandle,
+    BisonFactorMaHandle,
+    BisonDedimEHandle,
+    BisonDimsDimdimsHandle,
+    BisonDimsEmptyHandle,
+};
+
+/*按产生式编号标记归约句柄是否不依赖环境，只计算一次，所有增量语法分析器只读共享*/
+static pthread_once_t bisonIncPureOnce = PTHREAD_ONCE_INIT;
+static unsigned char *bisonIncPureArr;
+static int bisonIncProductNum;
+static int bisonIncPureError;
+
+static void BisonIncPureFree(void)
+{
+    free(bisonIncPureArr);
+    bisonIncPureArr = NULL;
+}
+
+/*
+ * 功能：按产生式编号计算bisonIncPureArr，编号顺序和静态语法分析表中的分派函数一致，
+ *      只给有归约句柄的产生式编号。
+ * 返回值：无
+ **/
+static void BisonIncPureInit(void)
+{
+    ContextFreeGrammar *grammar = NULL;
+    struct list_head *symPos, *bodyPos;
+    Symbol *symbol;
+    ProductBody *productBody;
+    unsigned char *pureArr = NULL, *tempArr;
+    int num = 0, size = 0;
+    unsigned int i;
+
+    bisonIncPureError = DesignGrammar(&grammar);
+    if (bisonIncPureError != -ENOERR)
+        return;
+    list_for_each(symPos, &grammar->symbolList) {
+        symbol = container_of(symPos, Symbol, node);
+        list_for_each(bodyPos, &symbol->bodyList) {
+            productBody = container_of(bodyPos, ProductBody, node);
+            if (!productBody->handle)
+                continue;
+            if (num >= size) {
+                size = size ? size * 2 : 64;
+                tempArr = realloc(pureArr, size);
+                if (!tempArr) {
+                    bisonIncPureError = -ENOMEM;
+                    goto out;
+                }
+                pureArr = tempArr;
+            }
+            pureArr[num] = 0;
+            for (i = 0; i < ARRAY_SIZE(bisonIncPureHandleArr); i++) {
+                if (productBody->handle == bisonIncPureHandleArr[i])
+                    pureArr[num] = 1;
+            }
+            num++;
+        }
+    }
+    bisonIncPureArr = pureArr;
+    bisonIncProductNum = num;
+    pureArr = NULL;
+    atexit(BisonIncPureFree);
+
+out:
+    free(pureArr);
     ContextFreeGrammarFree(grammar);
-err0:
-    printf("error: %d\n", error);
-    PrErr("syntax error\n");
-    exit(-1);
 }
 
-Bison bisonObj, *bison = &bisonObj;
+static int BisonIncPure(void *arg, int productId)
+{
+    (void)arg;
+    return productId >= 0 && productId < bisonIncProductNum && bisonIncPureArr[productId];
+}
 
 /*
- * 功能：构建抽象语法树，并生成中间代码。
- * 返回值：
+ * 功能：在增量语法分析器的上下文中执行归约句柄，语义值从上下文的区域分配器中申请。
+ * 返回值：成功时返回0，否则返回错误码。
  **/
-void BisonExec(void)
+static int BisonIncReduce(void *arg, int productId, void **headArg, void *prevArg, void *bodyArg[])
 {
-    Lex *lex;
+    Bison *prev;
+    int error = 0;
 
-    lex = LexAlloc();
-    LexSetInFile(lex, "test.txt");
-    bison->lex = lex;
-    bison->env = EnvAlloc();
-    bison->record = QRRecordAlloc();
-    BuildTree(lex);
-    GenProgram(bison->program);
+    prev = bison;
+    bison = arg;
+    error = BisonStaticTable.reduceHandle(productId, headArg, prevArg, bodyArg);
+    bison = prev;
+    return error;
 }
 
+/*
+ * 功能：分配使用静态语法分析表的增量语法分析器，用于编辑器集成。
+ *      不依赖环境的归约句柄在增量分析时执行，语义值保存在语法树中随子树复用，
+ *      从增量分析器自己的编译上下文中申请，用BisonIncParserFree释放。
+ *      记号的语义值是BisonLexSymIdArr得到的记号。依赖环境的语义分析和中间代码生成仍然使用BisonCompile。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int BisonIncParserAlloc(LrIncParser **pParser)
+{
+    LrIncHandle handle;
+    Bison *ctx;
+    int error = 0;
 
+    if (!pParser)
+        return -EINVAL;
+
+    pthread_once(&bisonIncPureOnce, BisonIncPureInit);
+    if (bisonIncPureError != -ENOERR)
+        return bisonIncPureError;
+    ctx = BisonAlloc();
+    if (!ctx)
+        return -ENOMEM;
+    ctx->arena = CplArenaCreate(0);
+    if (!ctx->arena) {
+        BisonFree(ctx);
+        return -ENOMEM;
+    }
+    handle.pure = BisonIncPure;
+    handle.reduce = BisonIncReduce;
+    handle.arg = ctx;
+    error = LrIncParserAlloc(pParser, &BisonStaticTable, &handle);
+    if (error != -ENOERR)
+        BisonFree(ctx);
+    return error;
+}
+
+void BisonIncParserFree(LrIncParser *parser)
+{
+    Bison *ctx;
+
+    if (!parser)
+        return;
+    ctx = parser->handle.arg;
+    LrIncParserFree(parser);
+    BisonFree(ctx);
+}
+#endif
+
+/*
+ * 功能：分配编译上下文。
+ * 返回值：编译上下文，内存不足时返回NULL。
+ **/
+Bison *BisonAlloc(void)
+{
+    Bison *ctx;
+
+    ctx = calloc(1, sizeof (*ctx));
+    if (!ctx)
+        return NULL;
+    ctx->tree = ATreeAlloc();
+    if (!ctx->tree) {
+        free(ctx);
+        return NULL;
+    }
+    ctx->tempNum = 1;
+    return ctx;
+}
+
+/*
+ * 功能：释放编译上下文，必须在四元式生成目标代码之后调用。语法树、类型和四元式操作数
+ *      都在编译单元的区域分配器中，整体释放。
+ * 返回值：无
+ **/
+void BisonFree(Bison *ctx)
+{
+    if (!ctx)
+        return;
+    QRRecordFree(ctx->record);
+    EnvFree(ctx->env);
+    LexFree(ctx->lex);
+    ATreeFree(ctx->tree);
+    CplArenaDestroy(ctx->arena);
+    free(ctx);
+}
+
+/*
+ * 功能：预先构造所有编译上下文共享的词法分析器自动机和语法分析表，
+ *      常驻进程在接受编译请求之前调用，避免第一次编译时构造。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int BisonPrepare(void)
+{
+#ifndef BISON_STATIC_TABLE
+    Lalr *lalr;
+    int error = 0;
+#endif
+
+    LexFree(LexAlloc());
+#ifndef BISON_STATIC_TABLE
+    error = BisonGetLalr(&lalr);
+    if (error != -ENOERR)
+        return error;
+#endif
+    return 0;
+}
+
+/*
+ * 功能：编译词法分析器中的源代码，构建抽象语法树并生成中间代码，结果保存在编译上下文中。
+ *      编译期间ctx是当前线程的上下文，编译错误只中止本次编译，不退出进程。
+ *      词法分析器的自动机在LexAlloc中构造，也在退出点之外。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int BisonCompileLex(Bison *ctx)
+{
+    volatile int error = 0;
+    Bison *prev;
+    jmp_buf exitPoint, *prevExitPoint;
+#ifndef BISON_STATIC_TABLE
+    Lalr *lalr;
+
+    /*共享的语法分析表在退出点之外构造*/
+    error = BisonGetLalr(&lalr);
+    if (error != -ENOERR)
+        return error;
+#endif
+
+    prev = bison;
+    prevExitPoint = cplExitPoint;
+    bison = ctx;
+    cplExitPoint = &exitPoint;
+    if (setjmp(exitPoint) == 0) {
+        ctx->env = EnvAlloc(ctx);
+        ctx->record = QRRecordAlloc();
+        error = BuildTree(ctx);
+        BisonFreeParser(ctx);
+        if (error == -ENOERR)
+            GenProgram(ctx, ctx->program);
+    } else {
+        BisonFreeParser(ctx);
+        error = -ECOMPILE;
+    }
+    cplExitPoint = prevExitPoint;
+    bison = prev;
+    return error;
+}
+
+/*
+ * 功能：编译一个源文件，一个上下文只能编译一次。
+ * path：源文件路径
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int BisonCompile(Bison *ctx, const char *path)
+{
+    int error = 0;
+
+    if (!ctx || !path || ctx->arena)
+        return -EINVAL;
+
+    ctx->arena = CplArenaCreate(0);
+    if (!ctx->arena)
+        return -ENOMEM;
+    ctx->lex = LexAlloc();
+    if (!ctx->lex)
+        return -ENOMEM;
+    error = LexSetInFile(ctx->lex, path);
+    if (error != -ENOERR)
+        return error;
+    return BisonCompileLex(ctx);
+}
+
+/*
+ * 功能：编译内存中的源代码，一个上下文只能编译一次。编译结束前缓冲区必须有效。
+ * buf：源代码
+ * len：源代码长度
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int BisonCompileBuffer(Bison *ctx, const char *buf, size_t len)
+{
+    int error = 0;
+
+    if (!ctx || !buf || ctx->arena)
+        return -EINVAL;
+
+    ctx->arena = CplArenaCreate(0);
+    if (!ctx->arena)
+        return -ENOMEM;
+    ctx->lex = LexAlloc();
+    if (!ctx->lex)
+        return -ENOMEM;
+    error = LexSetInBuffer(ctx->lex, buf, len);
+    if (error != -ENOERR)
+        return error;
+    return BisonCompileLex(ctx);
+}
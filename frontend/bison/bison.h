@@ -12,19 +12,42 @@ typedef struct _Program Program;
 typedef struct _Lex Lex;
 typedef struct _QRRecord QRRecord;
 typedef struct _FunType FunType;
-
+typedef struct _LrIncParser LrIncParser;
+typedef struct _CplArena CplArena;
+typedef struct _GenWork GenWork;
+typedef struct _LrParser LrParser;
+typedef struct _LrErrorRecover LrErrorRecover;
+typedef struct _ATree ATree;
+
+/*
+ * 编译上下文，一个编译单元对应一个上下文。语法分析表和词法分析器的自动机在所有上下文之间
+ * 只读共享，不同线程可以同时编译不同的编译单元。
+ **/
 typedef struct _Bison {
+    CplArena *arena;        /*编译单元的区域分配器，语法树、类型和四元式操作数都从这里申请*/
     Environ *env;
     Lex *lex;
+    LrParser *parser;       /*语法分析期间有效，语义错误退出时在退出点释放*/
+    LrErrorRecover *errorRecover;
     Program *program;
+    ATree *tree;            /*语法树的节点表，节点页在arena中*/
     QRRecord *record;
     const Token *mainToken;
     FunType *mainFunType;
+    size_t tempNum;         /*下一个临时变量的编号*/
+    GenWork *genWork;       /*中间代码生成的工作栈，第一次使用时从arena分配*/
+    unsigned int dumpFlag;  /*输出语法分析结果、中间代码和目标代码，默认不输出*/
 } Bison;
 
-extern Bison *bison;
-
-void BisonExec(void);
+int BisonPrepare(void);
+Bison *BisonAlloc(void);
+void BisonFree(Bison *ctx);
+int BisonCompile(Bison *ctx, const char *path);
+int BisonCompileBuffer(Bison *ctx, const char *buf, size_t len);
+int BisonGenStaticTable(const char *path);
+int BisonLexSymIdArr(Lex *lex, int **pSymIdArr, void ***pTokenArr, int *pLen);
+int BisonIncParserAlloc(LrIncParser **pParser);
+void BisonIncParserFree(LrIncParser *parser);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,32 @@
+#include "stdio.h"
+#include "string.h"
+#include "bison.h"
+#include "first_follow.h"
+
+/*
+ * 静态语法分析表生成工具，替代main.c和其他源文件一起编译，并定义BISON_TABLE_GEN：
+ *      gcc -DBISON_TABLE_GEN ... frontend/bison/bison_table_gen.c -o bison_table_gen
+ *      ./bison_table_gen frontend/bison/bison_table.inc
+ * 修改文法或者归约句柄后需要重新生成bison_table.inc。
+ *      ./bison_table_gen -b
+ * 运行FIRST/FOLLOW集合生成的性能测试，不生成语法分析表。
+ **/
+int main(int argc, char *argv[])
+{
+    const char *path = "bison_table.inc";
+    int error = 0;
+
+    if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+        CfgFirstFollowBench();
+        return 0;
+    }
+    if (argc > 1)
+        path = argv[1];
+    error = BisonGenStaticTable(path);
+    if (error != 0) {
+        printf("generate static table fail: %d\n", error);
+        return -1;
+    }
+    printf("generate static table: %s\n", path);
+    return 0;
+}
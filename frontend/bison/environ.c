@@ -9,6 +9,8 @@
 
 #define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
 
+#define ENV_DOMAIN_HASH_INIT_SIZE   8   /*作用域散列表的初始桶数*/
+
 #define ENV_DEBUG
 #ifdef ENV_DEBUG
 #define PrDbg(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "debug", __VA_ARGS__)
@@ -25,7 +27,7 @@ static inline void *EnvMAlloc(size_t size)
     p = CplAlloc(size);
     if (!p) {
         PrErr("no memory\n");
-        exit(-1);
+        CplExit(-1);
     }
     return p;
 }
@@ -85,6 +87,9 @@ static inline Domain *EnvNewDomain(Domain *prev, DomainType type)
     domain->allLocalVarSize = 0;
     domain->allTmpVarSize = 0;
     INIT_LIST_HEAD(&domain->entryList);
+    domain->hashTable = NULL;
+    domain->hashSize = 0;
+    domain->entryNum = 0;
     INIT_LIST_HEAD(&domain->nextList);
     domain->alignType = AT_1BYTE;
     if (prev) { /*把当前作用域添加到上一级作用域的下一级作用域链表*/
@@ -108,6 +113,30 @@ static void EnvFreeDomain(Domain *domain)
         list_del(&entry->node);
         EnvFreeDomainEntry(entry);
     }
+    CplFree(domain->hashTable);
+    domain->hashTable = NULL;
+    domain->hashSize = 0;
+    domain->entryNum = 0;
+}
+
+/*
+ * 功能：释放作用域和它的所有下一级作用域
+ * 返回值：
+ */
+static void EnvFreeDomainTree(Domain *domain)
+{
+    struct list_head *pos;
+    NextDomain *nextDomain;
+
+    for (pos = domain->nextList.next; pos != &domain->nextList; ) {
+        nextDomain = container_of(pos, NextDomain, node);
+        pos = pos->next;
+        list_del(&nextDomain->node);
+        EnvFreeDomainTree(nextDomain->domain);
+        CplFree(nextDomain);
+    }
+    EnvFreeDomain(domain);
+    CplFree(domain);
 }
 
 /*
@@ -125,6 +154,43 @@ void EnvFreeDomainList(Domain *domain)
     }
 }
 
+/*
+ * 功能：计算标识的散列值。词法分析器中相同的标识共享同一个Token，直接用Token的地址散列。
+ * 返回值：散列值
+ */
+static inline unsigned int EnvTokenHash(const Token *id)
+{
+    unsigned int hash;
+
+    hash = (unsigned int)((uintptr_t)id >> 3) * 2654435761u;
+    return hash ^ (hash >> 16);
+}
+
+/*
+ * 功能：散列表的桶数不够时扩大为原来的2倍，按条目链表的顺序重新散列，保持同名条目的先后顺序。
+ * 返回值：
+ */
+static void EnvDomainHashGrow(Domain *domain)
+{
+    struct list_head *table;
+    unsigned int size;
+    unsigned int i;
+    struct list_head *pos;
+    DomainEntry *entry;
+
+    size = domain->hashSize ? domain->hashSize * 2 : ENV_DOMAIN_HASH_INIT_SIZE;
+    table = EnvMAlloc(size * sizeof (*table));
+    for (i = 0; i < size; i++)
+        INIT_LIST_HEAD(&table[i]);
+    list_for_each(pos, &domain->entryList) {
+        entry = container_of(pos, DomainEntry, node);
+        list_add_tail(&entry->hashNode, &table[EnvTokenHash(entry->id) & (size - 1)]);
+    }
+    CplFree(domain->hashTable);
+    domain->hashTable = table;
+    domain->hashSize = size;
+}
+
 /*
  * 功能：向作用域中放置条目
  * 返回值：
@@ -133,21 +199,29 @@ int EnvDomainPutEntry(Domain *domain, DomainEntry *entry)
 {
     if (!domain || !entry)
         return -EINVAL;
+    if (domain->entryNum >= domain->hashSize)
+        EnvDomainHashGrow(domain);
     list_add_tail(&entry->node, &domain->entryList);
+    list_add_tail(&entry->hashNode, &domain->hashTable[EnvTokenHash(entry->id) & (domain->hashSize - 1)]);
+    domain->entryNum++;
     return 1;
 }
 
 /*
- * 功能：从作用域获取条目
+ * 功能：从作用域获取条目，同名条目返回最先放置的条目。
  * 返回值：
  */
 static DomainEntry *_EnvDomainGetEntry(Domain *domain, const Token *id)
 {
     DomainEntry *entry;
+    struct list_head *bucket;
     struct list_head *pos;
 
-    list_for_each(pos, &domain->entryList) {
-        entry = container_of(pos, DomainEntry, node);
+    if (!domain->hashTable)
+        return NULL;
+    bucket = &domain->hashTable[EnvTokenHash(id) & (domain->hashSize - 1)];
+    list_for_each(pos, bucket) {
+        entry = container_of(pos, DomainEntry, hashNode);
         if (id == entry->id)
             return entry;
     }
@@ -188,7 +262,7 @@ Type *EnvDomainGetTokenType(Domain *domain, const Token *token)
     entry = EnvDomainGetEntry(domain, token);
     if (!entry) {
         PrErr("no %s domain entry\n", token->cplString->str);
-        exit(-1);
+        CplExit(-1);
     }
     return entry->type;
 }
@@ -205,7 +279,7 @@ static Domain *EnvDomainTopFunDomain(Domain *domain)
         return domain;
     } else {
         PrErr("domain->type error: %d", domain->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -341,16 +415,17 @@ Stmt *EnvContinueLastLevelListTop(Environ *env)
  * 功能：初始化环境
  * 返回值：
  */
-static inline void EnvInit(Environ *env)
+static inline void EnvInit(Bison *ctx, Environ *env)
 {
     env->domain = EnvNewDomain(NULL, DT_GLOBAL);
-    env->boolType = ATreeNewBaseType(BTT_BOOL, 1, AT_1BYTE);
-    env->charType = ATreeNewBaseType(BTT_CHAR, 1, AT_1BYTE);
-    env->shortType = ATreeNewBaseType(BTT_SHORT, 2, AT_2BYTE);
-    env->intType = ATreeNewBaseType(BTT_INT, 4, AT_4BYTE);
-    env->floatType = ATreeNewBaseType(BTT_FLOAT, 4, AT_4BYTE);
-    env->trueExpr = ATreeNewCValueSpcBoolExpr(env->domain, CVTS_TRUE);
-    env->falseExpr = ATreeNewCValueSpcBoolExpr(env->domain, CVTS_FALSE);
+    env->boolType = ATreeNewBaseType(ctx, BTT_BOOL, 1, AT_1BYTE);
+    env->charType = ATreeNewBaseType(ctx, BTT_CHAR, 1, AT_1BYTE);
+    env->shortType = ATreeNewBaseType(ctx, BTT_SHORT, 2, AT_2BYTE);
+    env->intType = ATreeNewBaseType(ctx, BTT_INT, 4, AT_4BYTE);
+    env->floatType = ATreeNewBaseType(ctx, BTT_FLOAT, 4, AT_4BYTE);
+    ATreeTypeTableInit(&env->typeTable);
+    env->trueExpr = ATreeNewCValueSpcBoolExpr(ctx, env->domain, CVTS_TRUE);
+    env->falseExpr = ATreeNewCValueSpcBoolExpr(ctx, env->domain, CVTS_FALSE);
     INIT_LIST_HEAD(&env->lastLevelList);
 }
 
@@ -358,12 +433,12 @@ static inline void EnvInit(Environ *env)
  * 功能：分配环境
  * 返回值：
  */
-Environ *EnvAlloc(void)
+Environ *EnvAlloc(Bison *ctx)
 {
     Environ *env;
 
     env = EnvMAlloc(sizeof (*env));
-    EnvInit(env);
+    EnvInit(ctx, env);
     return env;
 }
 
@@ -373,10 +448,15 @@ Environ *EnvAlloc(void)
  */
 void EnvFree(Environ *env)
 {
+    Domain *domain;
+
     if (!env)
         return;
-    if (env->domain)
-        EnvFreeDomain(env->domain);
+    /*语法树和四元式引用所有的作用域，编译单元结束时从全局作用域开始整体释放。*/
+    for (domain = env->domain; domain && domain->prev; domain = domain->prev)
+        ;
+    if (domain)
+        EnvFreeDomainTree(domain);
     ATreeFreeBaseType(env->boolType);
     ATreeFreeBaseType(env->charType);
     ATreeFreeBaseType(env->shortType);
@@ -385,6 +465,7 @@ void EnvFree(Environ *env)
     ATreeFreeBaseType(env->boolType);
     ATreeFreeBaseType(env->boolType);
     EnvLastLevelListFree(&env->lastLevelList);
+    ATreeTypeTableFree(&env->typeTable);
     CplFree(env);
 }
 
@@ -12,6 +12,7 @@ extern "C" {
 /*作用域中的声明条目*/
 typedef struct {
     struct list_head node;
+    struct list_head hashNode;  /*作用域散列表节点*/
     const Token *id;            /*标识*/
     Type *type;                 /*标识类型*/
     size_t offset;              /*所在作用域的偏移量*/
@@ -37,6 +38,9 @@ typedef struct _Domain {
     DomainType type;
     struct _Domain *prev;       /*上一级作用域*/
     struct list_head entryList; /*条目链表，节点类型：DomainEntry*/
+    struct list_head *hashTable;    /*按标识散列的条目表，节点类型：DomainEntry，第一次放置条目时创建*/
+    unsigned int hashSize;          /*散列表的桶数，总是2的幂*/
+    unsigned int entryNum;          /*条目数*/
     size_t offset;              /*当前作用域所在作用域的偏移量*/
     size_t offset_num;          /*生成作用域中变量的偏移量*/
     size_t tmp_offset_num;      /*临时变量偏移量生成器*/
@@ -59,6 +63,7 @@ typedef struct {
 typedef struct _Environ {
     Domain *domain; /*当前作用域*/
     Type *boolType, *charType, *shortType, *intType, *floatType;    /*基本类型*/
+    TypeTable typeTable;                /*数组和指针类型的驻留表*/
     Expr *trueExpr, *falseExpr;
     struct list_head lastLevelList;     /*节点类型：LastLevel*/
 } Environ;
@@ -76,7 +81,7 @@ void EnvLastLevelListPop(Environ *env);
 Stmt *EnvBreakLastLevelListTop(Environ *env);
 Stmt *EnvContinueLastLevelListTop(Environ *env);
 
-Environ *EnvAlloc(void);
+Environ *EnvAlloc(Bison *ctx);
 void EnvFree(Environ *env);
 
 #ifdef __cplusplus
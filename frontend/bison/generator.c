@@ -9,10 +9,12 @@
 #include "cpl_errno.h"
 #include "cpl_debug.h"
 #include "stdlib.h"
+#include "string.h"
 #include "cpl_string.h"
 #include "bison.h"
 #include "quadruple.h"
 #include "backpatch.h"
+#include "optimizer.h"
 
 #include "stdarg.h"
 
@@ -23,39 +25,204 @@
 #define PrDbg(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "debug", __VA_ARGS__)
 #endif
 
-static int GenStmt(Stmt *stmt, BPInsList **nextList);
-static void GenExprJumping(Cond *cond, BPInsList **trueList, BPInsList **falseList);
-static void _GenExprJumping(Cond *cond, BPInsList **trueList, BPInsList **falseList);
-static Expr *GenExprForm(Expr *expr);
-static Expr *GenExprReduce(Expr *expr);
+static void GenExprJumping(Bison *ctx, Cond *cond, BPInsList **trueList, BPInsList **falseList);
+static void _GenExprJumping(Bison *ctx, Cond *cond, BPInsList **trueList, BPInsList **falseList);
+static Expr *GenExprForm(Bison *ctx, Expr *expr);
+static Expr *GenExprReduce(Bison *ctx, Expr *expr);
 
-#define GEN_CUR_INSTRUCT()      (bison->record->idx - 1)
+#define GEN_CUR_INSTRUCT()      (ctx->record->idx - 1)
 
-static inline void *GenMAlloc(size_t size)
+/*
+ * 功能：从编译单元的区域分配器中分配内存，如果失败则程序直接退出。
+ * 返回值：
+ **/
+static inline void *GenMAlloc(Bison *ctx, size_t size)
 {
     void *p;
 
-    p = CplAlloc(size);
+    p = CplArenaAlloc(ctx->arena, size);
     if (!p) {
         PrErr("no memory");
-        exit(-1);
+        CplExit(-1);
     }
     return p;
 }
 
+/*表达式的生成方式，对应递归生成时的三个入口函数*/
+typedef enum {
+    GEM_REDUCE,     /*简化表达式，GenExprReduce*/
+    GEM_FORM,       /*规化表达式，GenExprForm*/
+    GEM_JUMPING,    /*生成表达式跳转语句，GenExprJumping*/
+} GenExprMode;
+
+/*表达式工作栈的栈帧*/
+typedef struct _GenExprFrame {
+    struct _GenExprFrame *prev;
+    Expr *expr;
+    GenExprMode mode;
+    int step;                   /*子表达式生成完后从这一步继续*/
+    Expr *tempExpr;             /*结果临时变量*/
+    Expr *lExpr;                /*已经生成的左操作数*/
+    BPInsList *trueList;        /*已经生成的左操作数的跳转链表*/
+    BPInsList *falseList;
+} GenExprFrame;
+
+/*语句工作栈的栈帧类型*/
+typedef enum {
+    GSFT_STMT,
+    GSFT_STMTS,
+    GSFT_CASE_STMT,
+    GSFT_CASE_STMTS,
+} GenStmtFrameType;
+
+/*语句工作栈的栈帧*/
+typedef struct _GenStmtFrame {
+    struct _GenStmtFrame *prev;
+    GenStmtFrameType type;
+    int step;                       /*子语句生成完后从这一步继续*/
+    union {
+        Stmt *stmt;
+        Stmts *stmts;
+        CaseStmt *caseStmt;
+        CaseStmts *caseStmts;
+    };
+    uint32_t idx;                   /*序列中下一个要生成的元素在序列中的位置*/
+    BPInsList **nextList;           /*输出型参数，生成完后写入nextList*/
+    BPInsList *falseList;
+    BPInsList *subNextList;         /*子语句的nextList*/
+    BPInsList *sub2NextList;
+    BPInsList *newNextList;
+    BPInsList *insList;             /*待回填的跳转指令*/
+    size_t insIdx;                  /*循环开始的表号或者case标号*/
+    Expr *expr;                     /*switch的测试表达式或者case表达式*/
+    struct list_head *labelList;    /*case标号链表，节点类型：ExprLabelMap*/
+    struct list_head exprLabelMapList;
+} GenStmtFrame;
+
+/*
+ * 中间代码生成的工作栈。语句和表达式按嵌套深度压栈，不占用C栈，机器生成的超长函数和
+ * 深层嵌套的表达式也不会栈溢出。栈帧从编译单元的区域分配器中分配，出栈后放入空闲链表重复使用。
+ **/
+struct _GenWork {
+    GenExprFrame *exprTop;
+    GenExprFrame *exprFree;
+    GenStmtFrame *stmtTop;
+    GenStmtFrame *stmtFree;
+    Expr *retExpr;              /*最近出栈的表达式栈帧的结果*/
+    BPInsList *retTrueList;
+    BPInsList *retFalseList;
+};
+
+static GenWork *GenGetWork(Bison *ctx)
+{
+    if (!ctx->genWork) {
+        ctx->genWork = GenMAlloc(ctx, sizeof (*ctx->genWork));
+        memset(ctx->genWork, 0, sizeof (*ctx->genWork));
+    }
+    return ctx->genWork;
+}
+
+/*
+ * 功能：压入表达式栈帧，调用者压栈后必须立即返回，由GenExprRun执行新栈帧。
+ * 返回值：
+ **/
+static void GenExprPush(Bison *ctx, Expr *expr, GenExprMode mode)
+{
+    GenWork *work = GenGetWork(ctx);
+    GenExprFrame *frame;
+
+    frame = work->exprFree;
+    if (frame)
+        work->exprFree = frame->prev;
+    else
+        frame = GenMAlloc(ctx, sizeof (*frame));
+    memset(frame, 0, sizeof (*frame));
+    frame->expr = expr;
+    frame->mode = mode;
+    frame->prev = work->exprTop;
+    work->exprTop = frame;
+}
+
+/*
+ * 功能：栈顶的表达式生成完毕，记录结果并出栈。
+ * 返回值：
+ **/
+static void GenExprReturn(Bison *ctx, Expr *retExpr, BPInsList *trueList, BPInsList *falseList)
+{
+    GenWork *work = ctx->genWork;
+    GenExprFrame *frame = work->exprTop;
+
+    work->exprTop = frame->prev;
+    frame->prev = work->exprFree;
+    work->exprFree = frame;
+    work->retExpr = retExpr;
+    work->retTrueList = trueList;
+    work->retFalseList = falseList;
+}
+
+/*
+ * 功能：压入语句栈帧，调用者压栈后必须立即返回，由GenStmtRun执行新栈帧。
+ * 返回值：新栈帧
+ **/
+static GenStmtFrame *GenStmtPush(Bison *ctx, GenStmtFrameType type, void *node, BPInsList **nextList)
+{
+    GenWork *work = GenGetWork(ctx);
+    GenStmtFrame *frame;
+
+    frame = work->stmtFree;
+    if (frame)
+        work->stmtFree = frame->prev;
+    else
+        frame = GenMAlloc(ctx, sizeof (*frame));
+    memset(frame, 0, sizeof (*frame));
+    frame->type = type;
+    switch (type) {
+    case GSFT_STMT:
+        frame->stmt = node;
+        break;
+    case GSFT_STMTS:
+        frame->stmts = node;
+        break;
+    case GSFT_CASE_STMT:
+        frame->caseStmt = node;
+        break;
+    case GSFT_CASE_STMTS:
+        frame->caseStmts = node;
+        break;
+    }
+    frame->nextList = nextList;
+    frame->prev = work->stmtTop;
+    work->stmtTop = frame;
+    return frame;
+}
+
+static void GenStmtPop(Bison *ctx)
+{
+    GenWork *work = ctx->genWork;
+    GenStmtFrame *frame = work->stmtTop;
+
+    work->stmtTop = frame->prev;
+    frame->prev = work->stmtFree;
+    work->stmtFree = frame;
+}
+
 /*
  * 功能：简化赋值表达式
  * 返回值：
  */
-static Expr *GenAssignExprReduce(Expr *expr)
+static void GenAssignExprReduce(Bison *ctx, GenExprFrame *frame)
 {
     Expr *reduceExpr;
 
-    reduceExpr = GenExprForm(expr);
-    QRRecordAddUnary(bison->record, QROC_ASSIGN,
-                     QROperandFromExpr(reduceExpr->binOp.rExpr),
-                     QROperandFromExpr(reduceExpr->binOp.lExpr));
-    return reduceExpr->binOp.lExpr;
+    if (frame->step++ == 0) {
+        GenExprPush(ctx, frame->expr, GEM_FORM);
+        return;
+    }
+    reduceExpr = ctx->genWork->retExpr;
+    QRRecordAddUnary(ctx->record, QROC_ASSIGN,
+                     QROperandFromExpr(ctx, ATreeExpr(ctx, reduceExpr->binOp.rExpr)),
+                     QROperandFromExpr(ctx, ATreeExpr(ctx, reduceExpr->binOp.lExpr)));
+    GenExprReturn(ctx, ATreeExpr(ctx, reduceExpr->binOp.lExpr), NULL, NULL);
 }
 
 //static Expr *trueExpr = x;
@@ -65,90 +232,117 @@ static Expr *GenAssignExprReduce(Expr *expr)
  * 功能：简化逻辑或表达式
  * 返回值：
  */
-static Expr *GenLorExprReduce(Expr *expr)
+static void GenLorExprReduce(Bison *ctx, GenExprFrame *frame)
 {
+    GenWork *work = ctx->genWork;
+    Expr *expr = frame->expr;
     Expr *tempExpr;
-    BPInsList *true1List = NULL, *false1List = NULL;
-    BPInsList *true2List = NULL, *false2List = NULL;
     BPInsList *insList;
 
-    tempExpr = ATreeNewTemp(expr->domain, bison->env->boolType);
-    GenExprJumping(expr->binOp.lExpr, &true1List, &false1List);
-    BPInsListBackPatch(false1List, bison->record, bison->record->idx);
-    GenExprJumping(expr->binOp.rExpr, &true2List, &false2List);
-    BPInsListBackPatch(true1List, bison->record, bison->record->idx);
-    BPInsListBackPatch(true2List, bison->record, bison->record->idx);
-    QRRecordAddUnary(bison->record, QROC_ASSIGN, QROperandFromExpr(bison->env->trueExpr), QROperandFromExpr(tempExpr));
-    QRRecordAddUncondJump(bison->record, 0);
+    switch (frame->step++) {
+    case 0:
+        frame->tempExpr = ATreeNewTemp(ctx, expr->domain, ctx->env->boolType);
+        GenExprPush(ctx, ATreeExpr(ctx, expr->binOp.lExpr), GEM_JUMPING);
+        return;
+    case 1:
+        frame->trueList = work->retTrueList;
+        frame->falseList = work->retFalseList;
+        BPInsListBackPatch(frame->falseList, ctx->record, ctx->record->idx);
+        GenExprPush(ctx, ATreeExpr(ctx, expr->binOp.rExpr), GEM_JUMPING);
+        return;
+    }
+    tempExpr = frame->tempExpr;
+    BPInsListBackPatch(frame->trueList, ctx->record, ctx->record->idx);
+    BPInsListBackPatch(work->retTrueList, ctx->record, ctx->record->idx);
+    QRRecordAddUnary(ctx->record, QROC_ASSIGN, QROperandFromExpr(ctx, ctx->env->trueExpr), QROperandFromExpr(ctx, tempExpr));
+    QRRecordAddUncondJump(ctx->record, 0);
     insList = BPMakeInsList(GEN_CUR_INSTRUCT());
-    BPInsListBackPatch(false2List, bison->record, bison->record->idx);
-    QRRecordAddUnary(bison->record, QROC_ASSIGN, QROperandFromExpr(bison->env->falseExpr), QROperandFromExpr(tempExpr));
-    BPInsListBackPatch(insList, bison->record, bison->record->idx);
-    return tempExpr;
+    BPInsListBackPatch(work->retFalseList, ctx->record, ctx->record->idx);
+    QRRecordAddUnary(ctx->record, QROC_ASSIGN, QROperandFromExpr(ctx, ctx->env->falseExpr), QROperandFromExpr(ctx, tempExpr));
+    BPInsListBackPatch(insList, ctx->record, ctx->record->idx);
+    GenExprReturn(ctx, tempExpr, NULL, NULL);
 }
 
 /*
  * 功能：简化逻辑与表达式
  * 返回值：
  */
-static Expr *GenLandExprReduce(Expr *expr)
+static void GenLandExprReduce(Bison *ctx, GenExprFrame *frame)
 {
+    GenWork *work = ctx->genWork;
+    Expr *expr = frame->expr;
     Expr *tempExpr;
-    BPInsList *true1List = NULL, *false1List = NULL;
-    BPInsList *true2List = NULL, *false2List = NULL;
     BPInsList *insList;
 
-    tempExpr = ATreeNewTemp(expr->domain, bison->env->boolType);
-    GenExprJumping(expr->binOp.lExpr, &true1List, &false1List);
-    BPInsListBackPatch(true1List, bison->record, bison->record->idx);
-    GenExprJumping(expr->binOp.rExpr, &true2List, &false2List);
-    BPInsListBackPatch(true2List, bison->record, bison->record->idx);
-    QRRecordAddUnary(bison->record, QROC_ASSIGN, QROperandFromExpr(bison->env->trueExpr), QROperandFromExpr(tempExpr));
-    QRRecordAddUncondJump(bison->record, 0);
+    switch (frame->step++) {
+    case 0:
+        frame->tempExpr = ATreeNewTemp(ctx, expr->domain, ctx->env->boolType);
+        GenExprPush(ctx, ATreeExpr(ctx, expr->binOp.lExpr), GEM_JUMPING);
+        return;
+    case 1:
+        frame->trueList = work->retTrueList;
+        frame->falseList = work->retFalseList;
+        BPInsListBackPatch(frame->trueList, ctx->record, ctx->record->idx);
+        GenExprPush(ctx, ATreeExpr(ctx, expr->binOp.rExpr), GEM_JUMPING);
+        return;
+    }
+    tempExpr = frame->tempExpr;
+    BPInsListBackPatch(work->retTrueList, ctx->record, ctx->record->idx);
+    QRRecordAddUnary(ctx->record, QROC_ASSIGN, QROperandFromExpr(ctx, ctx->env->trueExpr), QROperandFromExpr(ctx, tempExpr));
+    QRRecordAddUncondJump(ctx->record, 0);
     insList = BPMakeInsList(GEN_CUR_INSTRUCT());
-    BPInsListBackPatch(false1List, bison->record, bison->record->idx);
-    BPInsListBackPatch(false2List, bison->record, bison->record->idx);
-    QRRecordAddUnary(bison->record, QROC_ASSIGN, QROperandFromExpr(bison->env->falseExpr), QROperandFromExpr(tempExpr));
-    BPInsListBackPatch(insList, bison->record, bison->record->idx);
-    return tempExpr;
+    BPInsListBackPatch(frame->falseList, ctx->record, ctx->record->idx);
+    BPInsListBackPatch(work->retFalseList, ctx->record, ctx->record->idx);
+    QRRecordAddUnary(ctx->record, QROC_ASSIGN, QROperandFromExpr(ctx, ctx->env->falseExpr), QROperandFromExpr(ctx, tempExpr));
+    BPInsListBackPatch(insList, ctx->record, ctx->record->idx);
+    GenExprReturn(ctx, tempExpr, NULL, NULL);
 }
 
 /*
  * 功能：简化关系表达式
  * 返回值：
  */
-static Expr *GenRelExprReduce(Expr *expr)
+static void GenRelExprReduce(Bison *ctx, GenExprFrame *frame)
 {
+    Expr *expr = frame->expr;
     Expr *tempExpr;
     BPInsList *trueList = NULL, *falseList = NULL;
     BPInsList *insList;
     Expr *reduceExpr;
 
-    reduceExpr = GenExprForm(expr);
-    tempExpr = ATreeNewTemp(expr->domain, bison->env->boolType);
-    _GenExprJumping(reduceExpr, &trueList, &falseList);
-    BPInsListBackPatch(trueList, bison->record, bison->record->idx);
-    QRRecordAddUnary(bison->record, QROC_ASSIGN,  QROperandFromExpr(bison->env->trueExpr), QROperandFromExpr(tempExpr));
-    QRRecordAddUncondJump(bison->record, 0);
+    if (frame->step++ == 0) {
+        GenExprPush(ctx, expr, GEM_FORM);
+        return;
+    }
+    reduceExpr = ctx->genWork->retExpr;
+    tempExpr = ATreeNewTemp(ctx, expr->domain, ctx->env->boolType);
+    _GenExprJumping(ctx, reduceExpr, &trueList, &falseList);
+    BPInsListBackPatch(trueList, ctx->record, ctx->record->idx);
+    QRRecordAddUnary(ctx->record, QROC_ASSIGN,  QROperandFromExpr(ctx, ctx->env->trueExpr), QROperandFromExpr(ctx, tempExpr));
+    QRRecordAddUncondJump(ctx->record, 0);
     insList = BPMakeInsList(GEN_CUR_INSTRUCT());
-    BPInsListBackPatch(falseList, bison->record, bison->record->idx);
-    QRRecordAddUnary(bison->record, QROC_ASSIGN, QROperandFromExpr(bison->env->falseExpr), QROperandFromExpr(tempExpr));
-    BPInsListBackPatch(insList, bison->record, bison->record->idx);
-    return tempExpr;
+    BPInsListBackPatch(falseList, ctx->record, ctx->record->idx);
+    QRRecordAddUnary(ctx->record, QROC_ASSIGN, QROperandFromExpr(ctx, ctx->env->falseExpr), QROperandFromExpr(ctx, tempExpr));
+    BPInsListBackPatch(insList, ctx->record, ctx->record->idx);
+    GenExprReturn(ctx, tempExpr, NULL, NULL);
 }
 
 /*
  * 功能：简化算术表达式
  * 返回值：
  */
-static Expr *GenArithExprReduce(Expr *expr)
+static void GenArithExprReduce(Bison *ctx, GenExprFrame *frame)
 {
-    Expr *tempExpr;
+    Expr *expr = frame->expr;
     Expr *reduceExpr;
     QROpCode opCode;
 
-    tempExpr = ATreeNewTemp(expr->domain, ATreeExprType(expr));
-    reduceExpr = GenExprForm(expr);
+    if (frame->step++ == 0) {
+        frame->tempExpr = ATreeNewTemp(ctx, expr->domain, ATreeExprType(ctx, expr));
+        GenExprPush(ctx, expr, GEM_FORM);
+        return;
+    }
+    reduceExpr = ctx->genWork->retExpr;
     switch (expr->type) {
     case ET_ADD:
         opCode = QROC_ADD;
@@ -167,35 +361,39 @@ static Expr *GenArithExprReduce(Expr *expr)
         break;
     default:
         PrErr("unknown expr type");
-        exit(-1);
+        CplExit(-1);
     }
-    QRRecordAddBin(bison->record, opCode,
-                   QROperandFromExpr(reduceExpr->binOp.lExpr), QROperandFromExpr(reduceExpr->binOp.rExpr),
-                   QROperandFromExpr(tempExpr));
-
-    return tempExpr;
+    QRRecordAddBin(ctx->record, opCode,
+                   QROperandFromExpr(ctx, ATreeExpr(ctx, reduceExpr->binOp.lExpr)), QROperandFromExpr(ctx, ATreeExpr(ctx, reduceExpr->binOp.rExpr)),
+                   QROperandFromExpr(ctx, frame->tempExpr));
+    GenExprReturn(ctx, frame->tempExpr, NULL, NULL);
 }
 
 /*
  * 功能：简化逻辑非表达式
  * 返回值：
  */
-static Expr *GenLnotExprReduce(Expr *expr)
+static void GenLnotExprReduce(Bison *ctx, GenExprFrame *frame)
 {
+    GenWork *work = ctx->genWork;
+    Expr *expr = frame->expr;
     Expr *tempExpr;
-    BPInsList *trueList = NULL, *falseList = NULL;
     BPInsList *insList;
 
-    tempExpr = ATreeNewTemp(expr->domain, bison->env->boolType);
-    GenExprJumping(expr->unaryOp.expr, &trueList, &falseList);
-    BPInsListBackPatch(trueList, bison->record, bison->record->idx);
-    QRRecordAddUnary(bison->record, QROC_ASSIGN, QROperandFromExpr(bison->env->falseExpr), QROperandFromExpr(tempExpr));
-    QRRecordAddUncondJump(bison->record, 0);
+    if (frame->step++ == 0) {
+        frame->tempExpr = ATreeNewTemp(ctx, expr->domain, ctx->env->boolType);
+        GenExprPush(ctx, ATreeExpr(ctx, expr->unaryOp.expr), GEM_JUMPING);
+        return;
+    }
+    tempExpr = frame->tempExpr;
+    BPInsListBackPatch(work->retTrueList, ctx->record, ctx->record->idx);
+    QRRecordAddUnary(ctx->record, QROC_ASSIGN, QROperandFromExpr(ctx, ctx->env->falseExpr), QROperandFromExpr(ctx, tempExpr));
+    QRRecordAddUncondJump(ctx->record, 0);
     insList = BPMakeInsList(GEN_CUR_INSTRUCT());
-    BPInsListBackPatch(falseList, bison->record, bison->record->idx);
-    QRRecordAddUnary(bison->record, QROC_ASSIGN, QROperandFromExpr(bison->env->trueExpr), QROperandFromExpr(tempExpr));
-    BPInsListBackPatch(insList, bison->record, bison->record->idx);
-    return tempExpr;
+    BPInsListBackPatch(work->retFalseList, ctx->record, ctx->record->idx);
+    QRRecordAddUnary(ctx->record, QROC_ASSIGN, QROperandFromExpr(ctx, ctx->env->trueExpr), QROperandFromExpr(ctx, tempExpr));
+    BPInsListBackPatch(insList, ctx->record, ctx->record->idx);
+    GenExprReturn(ctx, tempExpr, NULL, NULL);
 }
 
 /*
@@ -203,7 +401,7 @@ static Expr *GenLnotExprReduce(Expr *expr)
  * pLastType: 最后一级的元素类型。
  * 返回值：
  */
-static Expr *GenLValueDerefDimsIdx(Domain *domain, const AEDims *dims, Type **pLastType)
+static Expr *GenLValueDerefDimsIdx(Bison *ctx, Domain *domain, const AEDims *dims, Type **pLastType)
 {
     Expr *tempExpr, *nextExpr;
     Expr *typeSize;
@@ -211,37 +409,41 @@ static Expr *GenLValueDerefDimsIdx(Domain *domain, const AEDims *dims, Type **pL
 
     if (!dims)
         return NULL;
-    nextExpr = GenLValueDerefDimsIdx(domain, dims->nextDims, &nextType);
+    nextExpr = GenLValueDerefDimsIdx(ctx, domain, dims->nextDims, &nextType);
     if (dims->nextDims == NULL) {
         *pLastType = dims->type;
     } else {
         *pLastType = nextType;
     }
-    tempExpr = ATreeNewTemp(domain, bison->env->charType);
-    typeSize = ATreeNewCValueSpcIntExpr(domain, ATreeTypeSize(dims->type));
-    QRRecordAddBin(bison->record, QROC_MUL,
-                   QROperandFromExpr(dims->idx), QROperandFromExpr(typeSize),
-                   QROperandFromExpr(tempExpr));
+    tempExpr = ATreeNewTemp(ctx, domain, ctx->env->charType);
+    typeSize = ATreeNewCValueSpcIntExpr(ctx, domain, ATreeTypeSize(dims->type));
+    QRRecordAddBin(ctx->record, QROC_MUL,
+                   QROperandFromExpr(ctx, ATreeExpr(ctx, dims->idx)), QROperandFromExpr(ctx, typeSize),
+                   QROperandFromExpr(ctx, tempExpr));
     if (nextExpr != NULL) {
-        QRRecordAddBin(bison->record, QROC_ADD,
-                       QROperandFromExpr(tempExpr), QROperandFromExpr(nextExpr),
-                       QROperandFromExpr(tempExpr));
+        QRRecordAddBin(ctx->record, QROC_ADD,
+                       QROperandFromExpr(ctx, tempExpr), QROperandFromExpr(ctx, nextExpr),
+                       QROperandFromExpr(ctx, tempExpr));
     }
     return tempExpr;
 }
 
 static Expr *GenLValueExprForm(Expr *expr);
 
-static Expr *GenAccessElmExprReduce(Expr *expr)
+static void GenAccessElmExprReduce(Bison *ctx, GenExprFrame *frame)
 {
     Expr *tempExpr;
     Expr *reduceExpr;
 
-    reduceExpr = GenExprForm(expr);
-    tempExpr = ATreeNewTemp(expr->domain, ATreeExprType(reduceExpr));
-    QRRecordAddUnary(bison->record, QROC_ASSIGN,
-                     QROperandFromExpr(reduceExpr), QROperandFromExpr(tempExpr));
-    return tempExpr;
+    if (frame->step++ == 0) {
+        GenExprPush(ctx, frame->expr, GEM_FORM);
+        return;
+    }
+    reduceExpr = ctx->genWork->retExpr;
+    tempExpr = ATreeNewTemp(ctx, frame->expr->domain, ATreeExprType(ctx, reduceExpr));
+    QRRecordAddUnary(ctx->record, QROC_ASSIGN,
+                     QROperandFromExpr(ctx, reduceExpr), QROperandFromExpr(ctx, tempExpr));
+    GenExprReturn(ctx, tempExpr, NULL, NULL);
 }
 
 /*
@@ -249,138 +451,137 @@ static Expr *GenAccessElmExprReduce(Expr *expr)
  *      活动记录中，最后一个参数在栈底，方便处理变参函数。
  * 返回值：
  **/
-static int GenFunRefParas(Domain *domain, FunRefParas *paras, size_t *parasCnt, FunArgs *funArgs, FunType *funType)
+static int GenFunRefParas(Bison *ctx, Domain *domain, FunRefParas *paras, size_t *parasCnt, FunArgs *funArgs, FunType *funType)
 {
-    size_t nextParasCnt = 0;
+    size_t cnt = 0;
     Expr *reduceExpr;
     QROperand *operand;
     Type *paraType;
     Type *argType;
 
-    if (!paras) {
-        *parasCnt = 0;
-        return 0;
-    }
-    if (!funArgs && !funType->vargFlag) {
-        PrErr("param too many: %p", funArgs);
-        exit(-1);
-    }
-
-    if (funArgs) {
-        argType = funArgs->funArg->type;
-        if (argType->type == TT_ARRAY) {
-            argType = ATreeNewPointerType(argType->array.type);
-        } else if (argType->type == TT_FUNCTION) {
-            argType = ATreeNewPointerType(argType);
+    for (; paras; paras = paras->next) {
+        if (!funArgs && !funType->vargFlag) {
+            PrErr("param too many: %p", funArgs);
+            CplExit(-1);
         }
-    } else {
-        argType = NULL;
-    }
 
-    paraType = ATreeExprType(paras->expr);
-    if (paraType->type == TT_BASE) {
-        Expr *tempExpr;
-        Type *tempType;
-
-        if (argType) {
-            if (argType->type != TT_BASE) {
-                PrErr("argType->type error: %d", argType->type);
-                exit(-1);
+        if (funArgs) {
+            argType = funArgs->funArg->type;
+            if (argType->type == TT_ARRAY) {
+                argType = ATreeNewPointerType(ctx, argType->array.type);
+            } else if (argType->type == TT_FUNCTION) {
+                argType = ATreeNewPointerType(ctx, argType);
             }
-            tempType = argType;
         } else {
-            if (paraType->baseType.type == BTT_FLOAT) {
-                tempType = bison->env->floatType;
-            } else if (paraType->baseType.type == BTT_BOOL
-                       || paraType->baseType.type == BTT_CHAR
-                       || paraType->baseType.type == BTT_SHORT
-                       || paraType->baseType.type == BTT_INT) {
-                tempType = bison->env->intType;
+            argType = NULL;
+        }
+
+        paraType = ATreeExprType(ctx, ATreeExpr(ctx, paras->expr));
+        if (paraType->type == TT_BASE) {
+            Expr *tempExpr;
+            Type *tempType;
+
+            if (argType) {
+                if (argType->type != TT_BASE) {
+                    PrErr("argType->type error: %d", argType->type);
+                    CplExit(-1);
+                }
+                tempType = argType;
             } else {
-                PrErr("paraType->baseType.type error: %d", paraType->baseType.type);
-                exit(-1);
+                if (paraType->baseType.type == BTT_FLOAT) {
+                    tempType = ctx->env->floatType;
+                } else if (paraType->baseType.type == BTT_BOOL
+                           || paraType->baseType.type == BTT_CHAR
+                           || paraType->baseType.type == BTT_SHORT
+                           || paraType->baseType.type == BTT_INT) {
+                    tempType = ctx->env->intType;
+                } else {
+                    PrErr("paraType->baseType.type error: %d", paraType->baseType.type);
+                    CplExit(-1);
+                }
             }
-        }
-        tempExpr = ATreeNewTemp(domain, tempType);
-        reduceExpr = GenExprReduce(paras->expr);
-        QRRecordAddUnary(bison->record, QROC_ASSIGN,
-                         QROperandFromExpr(reduceExpr), QROperandFromExpr(tempExpr));
-        operand = QROperandFromExpr(tempExpr);
-    } else if (paraType->type == TT_ARRAY) {
-        Expr *tempExpr;
-        Expr *getAddrExpr;
-        Expr *accessElmExpr;
-        AEDims *dims;
-        Expr *dimsIdx;
-        Type *tempType;
-
-        if (argType) {
-            if (argType->type != TT_POINTER) {
-                PrErr("argType->type error: %d", argType->type);
-                exit(-1);
+            tempExpr = ATreeNewTemp(ctx, domain, tempType);
+            reduceExpr = GenExprReduce(ctx, ATreeExpr(ctx, paras->expr));
+            QRRecordAddUnary(ctx->record, QROC_ASSIGN,
+                             QROperandFromExpr(ctx, reduceExpr), QROperandFromExpr(ctx, tempExpr));
+            operand = QROperandFromExpr(ctx, tempExpr);
+        } else if (paraType->type == TT_ARRAY) {
+            Expr *tempExpr;
+            Expr *getAddrExpr;
+            Expr *accessElmExpr;
+            AEDims *dims;
+            Expr *dimsIdx;
+            Type *tempType;
+
+            if (argType) {
+                if (argType->type != TT_POINTER) {
+                    PrErr("argType->type error: %d", argType->type);
+                    CplExit(-1);
+                }
+                tempType = argType;
+            } else {
+                tempType = ATreeNewPointerType(ctx, paraType->array.type);
             }
-            tempType = argType;
-        } else {
-            tempType = ATreeNewPointerType(paraType->array.type);
-        }
-        tempExpr = ATreeNewTemp(domain, tempType);
-        dimsIdx = ATreeNewCValueSpcIntExpr(domain, 0);
-        dims = ATreeNewAEDims(paraType->array.type, dimsIdx, NULL);
-        accessElmExpr = ATreeNewAccessElmExpr(domain, paras->expr, dims, paraType);
-        getAddrExpr = ATreeNewUnaryExpr(domain, ET_GET_ADDR, tempType, accessElmExpr);
-        getAddrExpr = GenExprReduce(getAddrExpr);
-        QRRecordAddUnary(bison->record, QROC_ASSIGN,
-                         QROperandFromExpr(getAddrExpr), QROperandFromExpr(tempExpr));
-        operand = QROperandFromExpr(tempExpr);
-    } else if (paraType->type == TT_STRUCTURE) {
-        if (argType) {
-            if (argType->type != TT_STRUCTURE) {
+            tempExpr = ATreeNewTemp(ctx, domain, tempType);
+            dimsIdx = ATreeNewCValueSpcIntExpr(ctx, domain, 0);
+            dims = ATreeNewAEDims(ctx, paraType->array.type, dimsIdx, NULL);
+            accessElmExpr = ATreeNewAccessElmExpr(ctx, domain, ATreeExpr(ctx, paras->expr), dims, paraType);
+            getAddrExpr = ATreeNewUnaryExpr(ctx, domain, ET_GET_ADDR, tempType, accessElmExpr);
+            getAddrExpr = GenExprReduce(ctx, getAddrExpr);
+            QRRecordAddUnary(ctx->record, QROC_ASSIGN,
+                             QROperandFromExpr(ctx, getAddrExpr), QROperandFromExpr(ctx, tempExpr));
+            operand = QROperandFromExpr(ctx, tempExpr);
+        } else if (paraType->type == TT_STRUCTURE) {
+            if (argType) {
+                if (argType->type != TT_STRUCTURE) {
+                    PrErr("argType->type error: %d", argType->type);
+                    CplExit(-1);
+                }
+            } else {
                 PrErr("argType->type error: %d", argType->type);
-                exit(-1);
+                CplExit(-1);
             }
-        } else {
-            PrErr("argType->type error: %d", argType->type);
-            exit(-1);
-        }
-        reduceExpr = GenExprReduce(paras->expr);
-        operand = QROperandFromExpr(reduceExpr);
-    } else if (paraType->type == TT_POINTER) {
-        Expr *tempExpr;
+            reduceExpr = GenExprReduce(ctx, ATreeExpr(ctx, paras->expr));
+            operand = QROperandFromExpr(ctx, reduceExpr);
+        } else if (paraType->type == TT_POINTER) {
+            Expr *tempExpr;
 
-        if (argType) {
-            /*需要更加严格的判断，判断指针类型是否相同。*/
-            if (argType->type != TT_POINTER) {
-                PrErr("argType->type error: %d", argType->type);
-                exit(-1);
+            if (argType) {
+                /*需要更加严格的判断，判断指针类型是否相同。*/
+                if (argType->type != TT_POINTER) {
+                    PrErr("argType->type error: %d", argType->type);
+                    CplExit(-1);
+                }
             }
-        }
-        tempExpr = ATreeNewTemp(domain, paraType);
-        reduceExpr = GenExprReduce(paras->expr);
-        QRRecordAddUnary(bison->record, QROC_ASSIGN,
-                         QROperandFromExpr(reduceExpr), QROperandFromExpr(tempExpr));
-        operand = QROperandFromExpr(tempExpr);
-    } else if (paraType->type == TT_FUNCTION) {
-        if (argType) {
-            if (argType->type != TT_POINTER) {
-                PrErr("argType->type error: %d", argType->type);
-                exit(-1);
+            tempExpr = ATreeNewTemp(ctx, domain, paraType);
+            reduceExpr = GenExprReduce(ctx, ATreeExpr(ctx, paras->expr));
+            QRRecordAddUnary(ctx->record, QROC_ASSIGN,
+                             QROperandFromExpr(ctx, reduceExpr), QROperandFromExpr(ctx, tempExpr));
+            operand = QROperandFromExpr(ctx, tempExpr);
+        } else if (paraType->type == TT_FUNCTION) {
+            if (argType) {
+                if (argType->type != TT_POINTER) {
+                    PrErr("argType->type error: %d", argType->type);
+                    CplExit(-1);
+                }
+            } else {
+
             }
+            PrErr("type->type error: %d", paraType->type);
+            CplExit(-1);
         } else {
-
+            PrErr("type->type error: %d", paraType->type);
+            CplExit(-1);
         }
-        PrErr("type->type error: %d", paraType->type);
-        exit(-1);
-    } else {
-        PrErr("type->type error: %d", paraType->type);
-        exit(-1);
+        QRRecordAddFunParam(ctx->record, operand);
+        funArgs = funArgs ? funArgs->next : NULL;
+        cnt++;
     }
-    QRRecordAddFunParam(bison->record, operand);
-    GenFunRefParas(domain, paras->next, &nextParasCnt, funArgs->next, funType);
-    *parasCnt = nextParasCnt + 1;
+    *parasCnt = cnt;
     return 0;
 }
 
-static Expr *GenFunRefExprReduce(Expr *expr)
+static Expr *GenFunRefExprReduce(Bison *ctx, Expr *expr)
 {
     size_t parasCnt = 0;
     Expr *tempExpr;
@@ -389,105 +590,85 @@ static Expr *GenFunRefExprReduce(Expr *expr)
     funRetType = expr->funRef->funType->retType;
     if (funRetType->typeType == ERTT_VOID) {
         PrErr("functon %s have not return value", expr->funRef->token->cplString->str);
-        exit(-1);
+        CplExit(-1);
     }
-    tempExpr = ATreeNewTemp(expr->domain, funRetType->type);
-    GenFunRefParas(expr->domain, expr->funRef->paras, &parasCnt, expr->funRef->funType->funArgs, expr->funRef->funType);
-    QRRecordAddFunCall(bison->record, expr->funRef->token, parasCnt, QROperandFromExpr(tempExpr), expr->domain);
+    tempExpr = ATreeNewTemp(ctx, expr->domain, funRetType->type);
+    GenFunRefParas(ctx, expr->domain, expr->funRef->paras, &parasCnt, expr->funRef->funType->funArgs, expr->funRef->funType);
+    QRRecordAddFunCall(ctx->record, expr->funRef->token, parasCnt, QROperandFromExpr(ctx, tempExpr), expr->domain);
     return tempExpr;
 }
 
 /*
- * 功能：解引用指针
- * 返回值：
- **/
-static Expr *GenRefPointerExprReduce(Expr *expr)
-{
-    return GenExprForm(expr);
-}
-
-/*
- * 功能：取地址
- * 返回值：
- **/
-static Expr *GenGetAddrExprReduce(Expr *expr)
-{
-    return GenExprForm(expr);
-}
-
-/*
- * 功能：类型转换
- * 返回值：
- **/
-static Expr *GenTypeCaseExprReduce(Expr *expr)
-{
-    return GenExprForm(expr);
-}
-
-/*
- * 功能：简化表达式
+ * 功能：简化表达式，执行栈顶栈帧的下一步
  * 返回值：
  */
-static Expr *GenExprReduce(Expr *expr)
+static void GenExprReduceStep(Bison *ctx, GenExprFrame *frame)
 {
+    Expr *expr = frame->expr;
+
     switch (expr->type) {
     case ET_ASSIGN:
-        return GenAssignExprReduce(expr);
+        GenAssignExprReduce(ctx, frame);
+        return;
     case ET_LOR:
-        return GenLorExprReduce(expr);
+        GenLorExprReduce(ctx, frame);
+        return;
     case ET_LAND:
-        return GenLandExprReduce(expr);
+        GenLandExprReduce(ctx, frame);
+        return;
     case ET_EQ:
     case ET_NE:
     case ET_GT:
     case ET_GE:
     case ET_LT:
     case ET_LE:
-        return GenRelExprReduce(expr);
+        GenRelExprReduce(ctx, frame);
+        return;
     case ET_ADD:
     case ET_SUB:
     case ET_MUL:
     case ET_DIV:
     case ET_MOD:
-        return GenArithExprReduce(expr);
+        GenArithExprReduce(ctx, frame);
+        return;
     case ET_LNOT:
-        return GenLnotExprReduce(expr);
+        GenLnotExprReduce(ctx, frame);
+        return;
     case ET_CONST:
-        return expr;
     case ET_TEMP:
-        return expr;
-    case ET_FUN_REF:
-        return GenFunRefExprReduce(expr);
     case ET_CONST_SPC:
-        return expr;
+    case ET_ID:
+        GenExprReturn(ctx, expr, NULL, NULL);
+        return;
+    case ET_FUN_REF:
+        GenExprReturn(ctx, GenFunRefExprReduce(ctx, expr), NULL, NULL);
+        return;
     case ET_ACCESS_MBR:
-        return GenExprForm(expr);
     case ET_REF_POINTER:
-        return GenRefPointerExprReduce(expr);
     case ET_GET_ADDR:
-        return GenGetAddrExprReduce(expr);
     case ET_TYPE_CAST:
-        return GenTypeCaseExprReduce(expr);
-    case ET_ID:
-        return expr;
+        /*简化的结果就是规化的结果，栈帧直接改为规化*/
+        frame->mode = GEM_FORM;
+        return;
     case ET_ACCESS_ELM:
-        return GenAccessElmExprReduce(expr);
+        GenAccessElmExprReduce(ctx, frame);
+        return;
     }
     PrErr("expression type error");
-    exit(-1);
+    CplExit(-1);
 }
 
 /*
  * 功能：生成简单的表达式跳转语句
  * 返回值：
  */
-static void _GenExprJumping(Cond *cond, BPInsList **trueList, BPInsList **falseList)
+static void _GenExprJumping(Bison *ctx, Cond *cond, BPInsList **trueList, BPInsList **falseList)
 {
     BPInsList *newTrueList, *newFalseList;
 
-    QRRecordAddCondJump(bison->record, QROC_TRUE_JUMP, cond, 0);
+    QRRecordAddCondJump(ctx->record, QROC_TRUE_JUMP, cond, 0);
     newTrueList = BPMakeInsList(GEN_CUR_INSTRUCT());
-    QRRecordAddUncondJump(bison->record, 0);
+    QRRecordAddUncondJump(ctx->record, 0);
     newFalseList = BPMakeInsList(GEN_CUR_INSTRUCT());
     *trueList = newTrueList;
     *falseList = newFalseList;
@@ -497,50 +678,110 @@ static void _GenExprJumping(Cond *cond, BPInsList **trueList, BPInsList **falseL
  * 功能：生成逻辑或表达式跳转语句
  * 返回值：
  */
-static void GenLorExprJumping(Cond *cond, BPInsList **trueList, BPInsList **falseList)
+static void GenLorExprJumping(Bison *ctx, GenExprFrame *frame)
 {
-    BPInsList *true1List = NULL, *false1List = NULL;
-    BPInsList *true2List = NULL, *false2List = NULL;
-
-    GenExprJumping(cond->binOp.lExpr, &true1List, &false1List);
-    BPInsListBackPatch(false1List, bison->record, bison->record->idx);
-    GenExprJumping(cond->binOp.rExpr, &true2List, &false2List);
-    BPInsListMerge(true2List, true1List);
-    *trueList = true2List;
-    *falseList = false2List;
+    GenWork *work = ctx->genWork;
+    Cond *cond = frame->expr;
+
+    switch (frame->step++) {
+    case 0:
+        GenExprPush(ctx, ATreeExpr(ctx, cond->binOp.lExpr), GEM_JUMPING);
+        return;
+    case 1:
+        frame->trueList = work->retTrueList;
+        BPInsListBackPatch(work->retFalseList, ctx->record, ctx->record->idx);
+        GenExprPush(ctx, ATreeExpr(ctx, cond->binOp.rExpr), GEM_JUMPING);
+        return;
+    }
+    BPInsListMerge(work->retTrueList, frame->trueList);
+    GenExprReturn(ctx, NULL, work->retTrueList, work->retFalseList);
 }
 
 /*
  * 功能：生成逻辑与表达式跳转语句
  * 返回值：
  */
-static void GenLandExprJumping(Cond *cond, BPInsList **trueList, BPInsList **falseList)
+static void GenLandExprJumping(Bison *ctx, GenExprFrame *frame)
+{
+    GenWork *work = ctx->genWork;
+    Cond *cond = frame->expr;
+
+    switch (frame->step++) {
+    case 0:
+        GenExprPush(ctx, ATreeExpr(ctx, cond->binOp.lExpr), GEM_JUMPING);
+        return;
+    case 1:
+        frame->falseList = work->retFalseList;
+        BPInsListBackPatch(work->retTrueList, ctx->record, ctx->record->idx);
+        GenExprPush(ctx, ATreeExpr(ctx, cond->binOp.rExpr), GEM_JUMPING);
+        return;
+    }
+    BPInsListMerge(work->retFalseList, frame->falseList);
+    GenExprReturn(ctx, NULL, work->retTrueList, work->retFalseList);
+}
+
+/*
+ * 功能：生成逻辑非表达式跳转语句，交换内层表达式的真假跳转链表
+ * 返回值：
+ */
+static void GenLnotExprJumping(Bison *ctx, GenExprFrame *frame)
 {
-    BPInsList *true1List = NULL, *false1List = NULL;
-    BPInsList *true2List = NULL, *false2List = NULL;
+    GenWork *work = ctx->genWork;
 
-    GenExprJumping(cond->binOp.lExpr, &true1List, &false1List);
-    BPInsListBackPatch(true1List, bison->record, bison->record->idx);
-    GenExprJumping(cond->binOp.rExpr, &true2List, &false2List);
-    BPInsListMerge(false2List, false1List);
-    *trueList = true2List;
-    *falseList = false2List;
+    if (frame->step++ == 0) {
+        GenExprPush(ctx, ATreeExpr(ctx, frame->expr->unaryOp.expr), GEM_JUMPING);
+        return;
+    }
+    GenExprReturn(ctx, NULL, work->retFalseList, work->retTrueList);
 }
 
 /*
- * 功能：生成表达式跳转语句
+ * 功能：先简化表达式，再生成简单的表达式跳转语句
+ * 返回值：
+ */
+static void GenReduceExprJumping(Bison *ctx, GenExprFrame *frame)
+{
+    BPInsList *trueList = NULL, *falseList = NULL;
+    Cond *cond;
+
+    if (frame->step++ == 0) {
+        GenExprPush(ctx, frame->expr, GEM_REDUCE);
+        return;
+    }
+    cond = ctx->genWork->retExpr;
+    if (frame->expr->type == ET_ASSIGN)
+        _GenExprJumping(ctx, ATreeExpr(ctx, cond->binOp.lExpr), &trueList, &falseList);
+    else
+        _GenExprJumping(ctx, cond, &trueList, &falseList);
+    GenExprReturn(ctx, NULL, trueList, falseList);
+}
+
+/*
+ * 功能：生成表达式跳转语句，执行栈顶栈帧的下一步
  * 返回值：
  */
-static void GenExprJumping(Cond *cond, BPInsList **trueList, BPInsList **falseList)
+static void GenExprJumpingStep(Bison *ctx, GenExprFrame *frame)
 {
+    BPInsList *trueList = NULL, *falseList = NULL;
+    Cond *cond = frame->expr;
+
     switch (cond->type) {
-    case ET_ASSIGN:
-        cond = GenExprReduce(cond);
-        return _GenExprJumping(cond->binOp.lExpr, trueList, falseList);
     case ET_LOR:
-        return GenLorExprJumping(cond, trueList, falseList);
+        GenLorExprJumping(ctx, frame);
+        return;
     case ET_LAND:
-        return GenLandExprJumping(cond, trueList, falseList);
+        GenLandExprJumping(ctx, frame);
+        return;
+    case ET_LNOT:
+        GenLnotExprJumping(ctx, frame);
+        return;
+    case ET_CONST:
+    case ET_TEMP:
+    case ET_CONST_SPC:
+        _GenExprJumping(ctx, cond, &trueList, &falseList);
+        GenExprReturn(ctx, NULL, trueList, falseList);
+        return;
+    case ET_ASSIGN:
     case ET_EQ:
     case ET_NE:
     case ET_GT:
@@ -552,167 +793,112 @@ static void GenExprJumping(Cond *cond, BPInsList **trueList, BPInsList **falseLi
     case ET_MUL:
     case ET_DIV:
     case ET_MOD:
-        cond = GenExprReduce(cond);
-        return _GenExprJumping(cond, trueList, falseList);
-    case ET_LNOT:
-        return GenExprJumping(cond->unaryOp.expr, falseList, trueList);
-    case ET_CONST:
-        return _GenExprJumping(cond, trueList, falseList);
     case ET_ID:
     case ET_ACCESS_ELM:
-        cond = GenExprReduce(cond);
-        return _GenExprJumping(cond, trueList, falseList);
-    case ET_TEMP:
-        return _GenExprJumping(cond, trueList, falseList);
     case ET_FUN_REF:
-        cond = GenExprReduce(cond);
-        return _GenExprJumping(cond, trueList, falseList);
-    case ET_CONST_SPC:
-        return _GenExprJumping(cond, trueList, falseList);
     case ET_ACCESS_MBR:
     case ET_REF_POINTER:
     case ET_GET_ADDR:
     case ET_TYPE_CAST:
-        cond = GenExprReduce(cond);
-        return _GenExprJumping(cond, trueList, falseList);
+        GenReduceExprJumping(ctx, frame);
+        return;
     }
+    GenExprReturn(ctx, NULL, NULL, NULL);
 }
 
 /*
  * 功能：规化赋值表达式
  * 返回值：
  */
-static Expr *GenAssignExprForm(Expr *expr)
+static void GenAssignExprForm(Bison *ctx, GenExprFrame *frame)
 {
-    Expr *lExpr, *rExpr;
-
-    lExpr = GenExprForm(expr->binOp.lExpr);
-    if (lExpr->type == ET_ID) {
-        switch (expr->binOp.rExpr->type) {
+    Expr *expr = frame->expr;
+    GenExprMode mode;
+
+    switch (frame->step++) {
+    case 0:
+        GenExprPush(ctx, ATreeExpr(ctx, expr->binOp.lExpr), GEM_FORM);
+        return;
+    case 1:
+        frame->lExpr = ctx->genWork->retExpr;
+        switch (ATreeExpr(ctx, expr->binOp.rExpr)->type) {
         case ET_ADD:
         case ET_SUB:
         case ET_MUL:
         case ET_DIV:
         case ET_MOD:
-            rExpr = GenExprForm(expr->binOp.rExpr);
+            mode = GEM_FORM;
             break;
-        default:
-            rExpr = GenExprReduce(expr->binOp.rExpr);
-            break;
-        }
-    } else {
-        switch (expr->binOp.rExpr->type) {
-        case ET_ADD:
-        case ET_SUB:
-        case ET_MUL:
-        case ET_DIV:
-        case ET_MOD:
         case ET_ACCESS_ELM:
-            rExpr = GenExprForm(expr->binOp.rExpr);
+            mode = frame->lExpr->type == ET_ID ? GEM_REDUCE : GEM_FORM;
             break;
         default:
-            rExpr = GenExprReduce(expr->binOp.rExpr);
+            mode = GEM_REDUCE;
             break;
         }
+        GenExprPush(ctx, ATreeExpr(ctx, expr->binOp.rExpr), mode);
+        return;
     }
-    return ATreeNewBinExpr(expr->domain, expr->type,
-                           expr->binOp.type,
-                           lExpr,
-                           rExpr);
-}
-
-/*
- * 功能：规划逻辑或表达式
- * 返回值：
- */
-static Expr *GenLorExprForm(Expr *expr)
-{
-    return ATreeNewBinExpr(expr->domain, expr->type,
-                              expr->binOp.type,
-                              GenExprReduce(expr->binOp.lExpr),
-                              GenExprReduce(expr->binOp.rExpr));
+    GenExprReturn(ctx, ATreeNewBinExpr(ctx, expr->domain, expr->type,
+                                  expr->binOp.type,
+                                  frame->lExpr,
+                                  ctx->genWork->retExpr), NULL, NULL);
 }
 
 /*
- * 功能：规划逻辑与表达式
+ * 功能：规化逻辑或、逻辑与、关系和算术表达式，左右操作数都被简化
  * 返回值：
  */
-static Expr *GenLandExprForm(Expr *expr)
+static void GenBinExprForm(Bison *ctx, GenExprFrame *frame)
 {
-    return ATreeNewBinExpr(expr->domain, expr->type,
-                              expr->binOp.type,
-                              GenExprReduce(expr->binOp.lExpr),
-                              GenExprReduce(expr->binOp.rExpr));
-}
-
-/*
- * 功能：规划关系表达式
- * 返回值：
- */
-static Expr *GenRelExprForm(Expr *expr)
-{
-    return ATreeNewBinExpr(expr->domain, expr->type,
-                              expr->binOp.type,
-                              GenExprReduce(expr->binOp.lExpr),
-                              GenExprReduce(expr->binOp.rExpr));
-}
-
-/*
- * 功能：规化算术表达式
- * 返回值：
- */
-static Expr *GenArithExprForm(Expr *expr)
-{
-    return ATreeNewBinExpr(expr->domain, expr->type,
-                              expr->binOp.type,
-                              GenExprReduce(expr->binOp.lExpr),
-                              GenExprReduce(expr->binOp.rExpr));
-}
-
-/*
- * 功能：规化逻辑非表达式
- * 返回值：
- */
-static Expr *GenLnotExprForm(Expr *expr)
-{
-    return ATreeNewUnaryExpr(expr->domain, expr->type,
-                             expr->unaryOp.type,
-                             GenExprReduce(expr->unaryOp.expr));
+    Expr *expr = frame->expr;
+
+    switch (frame->step++) {
+    case 0:
+        GenExprPush(ctx, ATreeExpr(ctx, expr->binOp.lExpr), GEM_REDUCE);
+        return;
+    case 1:
+        frame->lExpr = ctx->genWork->retExpr;
+        GenExprPush(ctx, ATreeExpr(ctx, expr->binOp.rExpr), GEM_REDUCE);
+        return;
+    }
+    GenExprReturn(ctx, ATreeNewBinExpr(ctx, expr->domain, expr->type,
+                                  expr->binOp.type,
+                                  frame->lExpr,
+                                  ctx->genWork->retExpr), NULL, NULL);
 }
 
 /*
  * 功能：规化成员访问表达式
  * 返回值：
  */
-static Expr * GenMemAccessExprForm(Expr *expr)
+static Expr *GenMemAccessExprForm(Bison *ctx, Expr *expr, Expr *baseExpr)
 {
-    Expr *baseExpr = GenExprForm(expr->accessMbr.base);
-
     if (expr->accessMbr.type == AMTYPE_DIRECT) {
         Expr *newExpr;
         Expr *memOffset;
 
-        memOffset = expr->accessMbr.memOffset;
+        memOffset = ATreeExpr(ctx, expr->accessMbr.memOffset);
         if (baseExpr->type == ET_ACCESS_MBR) {
             Expr *tempExpr;
 
-            tempExpr = ATreeNewTemp(expr->domain, bison->env->intType);
-            QRRecordAddBin(bison->record, QROC_ADD, QROperandFromExpr(memOffset),
-                           QROperandFromExpr(baseExpr->accessMbr.memOffset), QROperandFromExpr(tempExpr));
-            if (baseExpr->accessMbr.base->type == ET_ID) {
-                newExpr = ATreeNewAccessMem(expr->domain, AMTYPE_DIRECT, baseExpr->accessMbr.base, NULL, expr->accessMbr.memtype, tempExpr);
+            tempExpr = ATreeNewTemp(ctx, expr->domain, ctx->env->intType);
+            QRRecordAddBin(ctx->record, QROC_ADD, QROperandFromExpr(ctx, memOffset),
+                           QROperandFromExpr(ctx, ATreeExpr(ctx, baseExpr->accessMbr.memOffset)), QROperandFromExpr(ctx, tempExpr));
+            if (ATreeExpr(ctx, baseExpr->accessMbr.base)->type == ET_ID) {
+                newExpr = ATreeNewAccessMem(ctx, expr->domain, AMTYPE_DIRECT, ATreeExpr(ctx, baseExpr->accessMbr.base), NULL, expr->accessMbr.memtype, tempExpr);
                 return newExpr;
             } else {
-                PrErr("baseExpr->memAccess.base->type error: %d", baseExpr->accessMbr.base->type);
-                exit(-1);
+                PrErr("baseExpr->memAccess.base->type error: %d", ATreeExpr(ctx, baseExpr->accessMbr.base)->type);
+                CplExit(-1);
             }
         } else {
             if (baseExpr->type == ET_ID) {
-                newExpr = ATreeNewAccessMem(expr->domain, AMTYPE_DIRECT, baseExpr, NULL, expr->accessMbr.memtype, memOffset);
+                newExpr = ATreeNewAccessMem(ctx, expr->domain, AMTYPE_DIRECT, baseExpr, NULL, expr->accessMbr.memtype, memOffset);
                 return newExpr;
             } else {
                 PrErr("baseExpr->type error: %d", baseExpr->type);
-                exit(-1);
+                CplExit(-1);
             }
         }
     } else if (expr->accessMbr.type == AMTYPE_INDIRECT) {
@@ -724,40 +910,40 @@ static Expr * GenMemAccessExprForm(Expr *expr)
                 Expr *newExpr;
                 Expr *memOffset;
 
-                tempExpr = ATreeNewTemp(expr->domain, baseMemType);
-                QRRecordAddUnary(bison->record, QROC_ASSIGN,
-                                 QROperandFromExpr(baseExpr), QROperandFromExpr(tempExpr));
-                memOffset = expr->accessMbr.memOffset;
-                newExpr = ATreeNewAccessMem(expr->domain, AMTYPE_INDIRECT, tempExpr, NULL, expr->accessMbr.memtype, memOffset);
+                tempExpr = ATreeNewTemp(ctx, expr->domain, baseMemType);
+                QRRecordAddUnary(ctx->record, QROC_ASSIGN,
+                                 QROperandFromExpr(ctx, baseExpr), QROperandFromExpr(ctx, tempExpr));
+                memOffset = ATreeExpr(ctx, expr->accessMbr.memOffset);
+                newExpr = ATreeNewAccessMem(ctx, expr->domain, AMTYPE_INDIRECT, tempExpr, NULL, expr->accessMbr.memtype, memOffset);
                 return newExpr;
             } else {
                 PrErr("baseMemType->type error: %d", baseMemType->type);
-                exit(-1);
+                CplExit(-1);
             }
         } else {
             if (baseExpr->type == ET_ID) {
                 Type *baseExprType;
 
-                baseExprType = ATreeExprType(baseExpr);
+                baseExprType = ATreeExprType(ctx, baseExpr);
                 if (baseExprType->type == TT_POINTER) {
                     if (baseExprType->pointer.type->type == TT_STRUCTURE) {
                         return expr;
                     } else {
                         PrErr("baseExprType->pointer.type->type error: %d", baseExprType->pointer.type->type);
-                        exit(-1);
+                        CplExit(-1);
                     }
                 } else {
                     PrErr("baseExprType->type error: %d", baseExprType->type);
-                    exit(-1);
+                    CplExit(-1);
                 }
             } else {
                 PrErr("baseExpr->type error: %d", baseExpr->type);
-                exit(-1);
+                CplExit(-1);
             }
         }
     } else {
         PrErr("expr->memAccess.type error: %d", expr->accessMbr.type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -765,24 +951,21 @@ static Expr * GenMemAccessExprForm(Expr *expr)
  * 功能：规化解引用指针表达式
  * 返回值：
  */
-static Expr *GenRefPointerExprForm(Expr *expr)
+static Expr *GenRefPointerExprForm(Bison *ctx, Expr *expr, Expr *baseExpr)
 {
-    Expr *baseExpr;
-
-    baseExpr = GenExprReduce(expr->unaryOp.expr);
     if ((baseExpr->type == ET_REF_POINTER)
             || baseExpr->type == ET_ACCESS_ELM
             || baseExpr->type == ET_ACCESS_MBR) {
         Expr *tempExpr;
 
-        tempExpr = ATreeNewTemp(expr->domain, ATreeExprType(baseExpr));
-        QRRecordAddUnary(bison->record, QROC_ASSIGN,
-                         QROperandFromExpr(baseExpr), QROperandFromExpr(tempExpr));
-        return ATreeNewUnaryExpr(expr->domain, expr->type, expr->unaryOp.type, tempExpr);
+        tempExpr = ATreeNewTemp(ctx, expr->domain, ATreeExprType(ctx, baseExpr));
+        QRRecordAddUnary(ctx->record, QROC_ASSIGN,
+                         QROperandFromExpr(ctx, baseExpr), QROperandFromExpr(ctx, tempExpr));
+        return ATreeNewUnaryExpr(ctx, expr->domain, expr->type, expr->unaryOp.type, tempExpr);
     } else if (baseExpr->type == ET_GET_ADDR) {
-        return baseExpr->unaryOp.expr;
+        return ATreeExpr(ctx, baseExpr->unaryOp.expr);
     } else {
-        return ATreeNewUnaryExpr(expr->domain, expr->type, expr->unaryOp.type, baseExpr);
+        return ATreeNewUnaryExpr(ctx, expr->domain, expr->type, expr->unaryOp.type, baseExpr);
     }
 }
 
@@ -790,19 +973,16 @@ static Expr *GenRefPointerExprForm(Expr *expr)
  * 功能：规化取地址表达式
  * 返回值：
  */
-static Expr *GenGetAddrExprForm(Expr *expr)
+static Expr *GenGetAddrExprForm(Bison *ctx, Expr *expr, Expr *innerExpr)
 {
-    Expr *innerExpr;
-
-    innerExpr = GenExprForm(expr->unaryOp.expr);
     if (innerExpr->type == ET_REF_POINTER) {
-        return innerExpr->unaryOp.expr;
+        return ATreeExpr(ctx, innerExpr->unaryOp.expr);
     } else if (innerExpr->type == ET_ID
                || innerExpr->type == ET_ACCESS_MBR) {
-        return ATreeNewUnaryExpr(expr->domain, expr->type, expr->unaryOp.type, innerExpr);
+        return ATreeNewUnaryExpr(ctx, expr->domain, expr->type, expr->unaryOp.type, innerExpr);
     } else {
         PrErr("baseExpr->type error: %d", innerExpr->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -810,71 +990,73 @@ static Expr *GenGetAddrExprForm(Expr *expr)
  * 功能：规化类型转换表达式
  * 返回值：
  */
-static Expr *GenTypeCastExprForm(Expr *expr)
+static Expr *GenTypeCastExprForm(Bison *ctx, Expr *expr, Expr *innerExpr)
 {
-    Expr *innerExpr;
     Type *type;
 
-    type = ATreeExprType(expr);
-    innerExpr = GenExprForm(expr->unaryOp.expr);
+    type = ATreeExprType(ctx, expr);
     if (innerExpr->type == ET_ID) {
-        return ATreeNewIdExpr(innerExpr->domain, innerExpr->id.token, type);
+        return ATreeNewIdExpr(ctx, innerExpr->domain, innerExpr->id.token, type);
     } else if (innerExpr->type == ET_GET_ADDR) {
-        return ATreeNewUnaryExpr(innerExpr->domain, ET_GET_ADDR, type, innerExpr->unaryOp.expr);
+        return ATreeNewUnaryExpr(ctx, innerExpr->domain, ET_GET_ADDR, type, ATreeExpr(ctx, innerExpr->unaryOp.expr));
     } else if (innerExpr->type == ET_ACCESS_MBR) {
-        return ATreeNewAccessMem(innerExpr->domain, innerExpr->accessMbr.type, innerExpr->accessMbr.base, innerExpr->accessMbr.memId,
-                                 type, innerExpr->accessMbr.memOffset);
+        return ATreeNewAccessMem(ctx, innerExpr->domain, innerExpr->accessMbr.type, ATreeExpr(ctx, innerExpr->accessMbr.base), innerExpr->accessMbr.memId,
+                                 type, ATreeExpr(ctx, innerExpr->accessMbr.memOffset));
     } else if (innerExpr->type == ET_REF_POINTER) {
-        return ATreeNewUnaryExpr(innerExpr->domain, ET_REF_POINTER, type, innerExpr->unaryOp.expr);
+        return ATreeNewUnaryExpr(ctx, innerExpr->domain, ET_REF_POINTER, type, ATreeExpr(ctx, innerExpr->unaryOp.expr));
     } else if (innerExpr->type == ET_CONST
                || innerExpr->type == ET_CONST_SPC) {
         Expr *tempExpr;
 
-        tempExpr = ATreeNewTemp(expr->domain, type);
-        QRRecordAddUnary(bison->record, QROC_ASSIGN,
-                         QROperandFromExpr(innerExpr), QROperandFromExpr(tempExpr));
+        tempExpr = ATreeNewTemp(ctx, expr->domain, type);
+        QRRecordAddUnary(ctx->record, QROC_ASSIGN,
+                         QROperandFromExpr(ctx, innerExpr), QROperandFromExpr(ctx, tempExpr));
         return tempExpr;
     } else {
         PrErr("innerExpr->type error: %d", innerExpr->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
-static Expr *GenAccessElmOffsetExpr(Domain *domain, AEDims *dims, Type **type)
+static Expr *GenAccessElmOffsetExpr(Bison *ctx, Domain *domain, AEDims *dims, Type **type)
 {
     Expr *tempExpr;
     Expr *idxReduce;
     Expr *typeSizeExpr;
 
-    tempExpr = ATreeNewTemp(domain, bison->env->intType);
-    idxReduce = GenExprReduce(dims->idx);
-    typeSizeExpr = ATreeNewCValueSpcIntExpr(domain, ATreeTypeSize(dims->type));
-    QRRecordAddBin(bison->record, QROC_MUL, QROperandFromExpr(idxReduce),
-                   QROperandFromExpr(typeSizeExpr), QROperandFromExpr(tempExpr));
+    tempExpr = ATreeNewTemp(ctx, domain, ctx->env->intType);
+    idxReduce = GenExprReduce(ctx, ATreeExpr(ctx, dims->idx));
+    typeSizeExpr = ATreeNewCValueSpcIntExpr(ctx, domain, ATreeTypeSize(dims->type));
+    QRRecordAddBin(ctx->record, QROC_MUL, QROperandFromExpr(ctx, idxReduce),
+                   QROperandFromExpr(ctx, typeSizeExpr), QROperandFromExpr(ctx, tempExpr));
     if (dims->nextDims) {
         Expr *nextOffset;
-
-        nextOffset = GenAccessElmOffsetExpr(domain, dims->nextDims, type);
-        QRRecordAddBin(bison->record, QROC_ADD, QROperandFromExpr(nextOffset),
-                       QROperandFromExpr(tempExpr), QROperandFromExpr(tempExpr));
+        Expr *sumExpr;
+
+        /*和放到新的临时变量中，每个临时变量只定义一次，外层下标的乘积可以作为循环不变量外提*/
+        nextOffset = GenAccessElmOffsetExpr(ctx, domain, dims->nextDims, type);
+        sumExpr = ATreeNewTemp(ctx, domain, ctx->env->intType);
+        QRRecordAddBin(ctx->record, QROC_ADD, QROperandFromExpr(ctx, nextOffset),
+                       QROperandFromExpr(ctx, tempExpr), QROperandFromExpr(ctx, sumExpr));
+        return sumExpr;
     } else {
         *type = dims->type;
     }
     return tempExpr;
 }
 
-Type *GenAccessElmBaseExprType(Expr *expr)
+Type *GenAccessElmBaseExprType(Bison *ctx, Expr *expr)
 {
     Type *type;
 
-    type = ATreeExprType(expr);
+    type = ATreeExprType(ctx, expr);
     if (expr->type == ET_ID) {
         DomainEntry *entry;
 
         entry = EnvDomainGetEntry(expr->domain, expr->id.token);
         if (entry->funArgFlag == 1) {
             if (type->type == TT_ARRAY) {
-                return ATreeNewPointerType(type->array.type);
+                return ATreeNewPointerType(ctx, type->array.type);
             } else {
                 return type;
             }
@@ -890,129 +1072,222 @@ Type *GenAccessElmBaseExprType(Expr *expr)
  * 功能：规范化访问元素表达式
  * 返回值：
  */
-static Expr *GenAccessElmExprForm(Expr *expr)
+static Expr *GenAccessElmExprForm(Bison *ctx, Expr *expr)
 {
     Expr *newExpr;
     Expr *offsetExpr;
     Type *baseType;
     Type *memType;
 
-    baseType = GenAccessElmBaseExprType(expr->accessElm.base);
+    baseType = GenAccessElmBaseExprType(ctx, ATreeExpr(ctx, expr->accessElm.base));
     if (!expr->accessElm.dims) {
         PrErr("expr->accessElm.dims: %p", expr->accessElm.dims);
-        exit(-1);
+        CplExit(-1);
     }
-    offsetExpr = GenAccessElmOffsetExpr(expr->domain, expr->accessElm.dims, &memType);
+    offsetExpr = GenAccessElmOffsetExpr(ctx, expr->domain, expr->accessElm.dims, &memType);
     if (baseType->type == TT_ARRAY) {
-        newExpr = ATreeNewAccessMem(expr->domain, AMTYPE_DIRECT, expr->accessElm.base, NULL, memType, offsetExpr);
+        newExpr = ATreeNewAccessMem(ctx, expr->domain, AMTYPE_DIRECT, ATreeExpr(ctx, expr->accessElm.base), NULL, memType, offsetExpr);
     } else if (baseType->type == TT_POINTER) {
-        newExpr = ATreeNewAccessMem(expr->domain, AMTYPE_INDIRECT, expr->accessElm.base, NULL, memType, offsetExpr);
+        newExpr = ATreeNewAccessMem(ctx, expr->domain, AMTYPE_INDIRECT, ATreeExpr(ctx, expr->accessElm.base), NULL, memType, offsetExpr);
     } else {
         PrErr("type->type error: %d", baseType->type);
-        exit(-1);
+        CplExit(-1);
     }
 
     return newExpr;
 }
 
-static Expr *GenFunRefExprForm(Expr *expr)
+static Expr *GenFunRefExprForm(Bison *ctx, Expr *expr)
 {
     size_t parasCnt = 0;
 
-    GenFunRefParas(expr->domain, expr->funRef->paras, &parasCnt, expr->funRef->funType->funArgs, expr->funRef->funType);
-    QRRecordAddFunCallNrv(bison->record, expr->funRef->token, parasCnt, expr->domain);
+    GenFunRefParas(ctx, expr->domain, expr->funRef->paras, &parasCnt, expr->funRef->funType->funArgs, expr->funRef->funType);
+    QRRecordAddFunCallNrv(ctx->record, expr->funRef->token, parasCnt, expr->domain);
     return expr;
 }
 
 /*
- * 功能：规化表达式
+ * 功能：规化单目运算符和成员访问表达式，内层表达式生成完后再规化本层
+ * 返回值：
+ */
+static void GenUnaryExprForm(Bison *ctx, GenExprFrame *frame)
+{
+    Expr *expr = frame->expr;
+    Expr *innerExpr;
+
+    if (frame->step++ == 0) {
+        if (expr->type == ET_ACCESS_MBR)
+            GenExprPush(ctx, ATreeExpr(ctx, expr->accessMbr.base), GEM_FORM);
+        else if (expr->type == ET_LNOT || expr->type == ET_REF_POINTER)
+            GenExprPush(ctx, ATreeExpr(ctx, expr->unaryOp.expr), GEM_REDUCE);
+        else
+            GenExprPush(ctx, ATreeExpr(ctx, expr->unaryOp.expr), GEM_FORM);
+        return;
+    }
+    innerExpr = ctx->genWork->retExpr;
+    switch (expr->type) {
+    case ET_LNOT:
+        innerExpr = ATreeNewUnaryExpr(ctx, expr->domain, expr->type, expr->unaryOp.type, innerExpr);
+        break;
+    case ET_ACCESS_MBR:
+        innerExpr = GenMemAccessExprForm(ctx, expr, innerExpr);
+        break;
+    case ET_REF_POINTER:
+        innerExpr = GenRefPointerExprForm(ctx, expr, innerExpr);
+        break;
+    case ET_GET_ADDR:
+        innerExpr = GenGetAddrExprForm(ctx, expr, innerExpr);
+        break;
+    default:
+        innerExpr = GenTypeCastExprForm(ctx, expr, innerExpr);
+        break;
+    }
+    GenExprReturn(ctx, innerExpr, NULL, NULL);
+}
+
+/*
+ * 功能：规化表达式，执行栈顶栈帧的下一步
  * 返回值：
  */
-static Expr *GenExprForm(Expr *expr)
+static void GenExprFormStep(Bison *ctx, GenExprFrame *frame)
 {
+    Expr *expr = frame->expr;
+
     switch (expr->type) {
     case ET_ASSIGN:
-        return GenAssignExprForm(expr);
+        GenAssignExprForm(ctx, frame);
+        return;
     case ET_LOR:
-        return GenLorExprForm(expr);
     case ET_LAND:
-        return GenLandExprForm(expr);
     case ET_EQ:
     case ET_NE:
     case ET_GT:
     case ET_GE:
     case ET_LT:
     case ET_LE:
-        return GenRelExprForm(expr);
     case ET_ADD:
     case ET_SUB:
     case ET_MUL:
     case ET_DIV:
     case ET_MOD:
-        return GenArithExprForm(expr);
+        GenBinExprForm(ctx, frame);
+        return;
     case ET_LNOT:
-        return GenLnotExprForm(expr);
-    case ET_CONST:
-        return expr;
-    case ET_TEMP:
-        return expr;
-    case ET_CONST_SPC:
-        return expr;
     case ET_ACCESS_MBR:
-        return GenMemAccessExprForm(expr);
     case ET_REF_POINTER:
-        return GenRefPointerExprForm(expr);
     case ET_GET_ADDR:
-        return GenGetAddrExprForm(expr);
     case ET_TYPE_CAST:
-        return GenTypeCastExprForm(expr);
+        GenUnaryExprForm(ctx, frame);
+        return;
+    case ET_CONST:
+    case ET_TEMP:
+    case ET_CONST_SPC:
     case ET_ID:
-        return expr;
+        GenExprReturn(ctx, expr, NULL, NULL);
+        return;
     case ET_ACCESS_ELM:
-        return GenAccessElmExprForm(expr);
+        GenExprReturn(ctx, GenAccessElmExprForm(ctx, expr), NULL, NULL);
+        return;
     case ET_FUN_REF:
         PrErr("expression type error\n");
-        exit(-1);
+        CplExit(-1);
     }
     PrErr("expression type error\n");
-    exit(-1);
+    CplExit(-1);
+}
+
+/*
+ * 功能：用工作栈生成表达式。生成函数调用参数和数组下标时会再次进入，
+ *      再次进入时只执行新压入的栈帧，表达式运算符的嵌套深度不占用C栈。
+ * trueList, falseList：输出型参数，GEM_JUMPING方式生成的跳转链表，其它方式可以为空
+ * 返回值：GEM_REDUCE和GEM_FORM方式生成的表达式
+ */
+static Expr *GenExprRun(Bison *ctx, Expr *expr, GenExprMode mode, BPInsList **trueList, BPInsList **falseList)
+{
+    GenWork *work = GenGetWork(ctx);
+    GenExprFrame *base = work->exprTop;
+    GenExprFrame *frame;
+
+    GenExprPush(ctx, expr, mode);
+    while (work->exprTop != base) {
+        frame = work->exprTop;
+        if (frame->mode == GEM_REDUCE)
+            GenExprReduceStep(ctx, frame);
+        else if (frame->mode == GEM_FORM)
+            GenExprFormStep(ctx, frame);
+        else
+            GenExprJumpingStep(ctx, frame);
+    }
+    if (trueList)
+        *trueList = work->retTrueList;
+    if (falseList)
+        *falseList = work->retFalseList;
+    return work->retExpr;
+}
+
+/*
+ * 功能：简化表达式
+ * 返回值：
+ */
+static Expr *GenExprReduce(Bison *ctx, Expr *expr)
+{
+    return GenExprRun(ctx, expr, GEM_REDUCE, NULL, NULL);
+}
+
+/*
+ * 功能：规化表达式
+ * 返回值：
+ */
+static Expr *GenExprForm(Bison *ctx, Expr *expr)
+{
+    return GenExprRun(ctx, expr, GEM_FORM, NULL, NULL);
+}
+
+/*
+ * 功能：生成表达式跳转语句
+ * 返回值：
+ */
+static void GenExprJumping(Bison *ctx, Cond *cond, BPInsList **trueList, BPInsList **falseList)
+{
+    GenExprRun(ctx, cond, GEM_JUMPING, trueList, falseList);
 }
 
 /*
  * 功能：生成表达式语句
  * 返回值：
  */
-static int GenExprStmt(Stmt *stmt, BPInsList **nextList)
+static int GenExprStmt(Bison *ctx, Stmt *stmt, BPInsList **nextList)
 {
     Expr *expr;
     BPInsList *newNextList = NULL;
 
-    expr = stmt->exprStmt.expr;
+    expr = ATreeExpr(ctx, stmt->exprStmt.expr);
     if (expr->type == ET_ASSIGN) {
-        Expr *rExpr;
+        Expr *rExpr, *dstExpr;
 
-        expr = GenExprForm(stmt->exprStmt.expr);
-        rExpr = expr->binOp.rExpr;
+        expr = GenExprForm(ctx, expr);
+        dstExpr = ATreeExpr(ctx, expr->binOp.lExpr);
+        rExpr = ATreeExpr(ctx, expr->binOp.rExpr);
         switch (rExpr->type) {
         case ET_ADD:
-            QRRecordAddBin(bison->record, QROC_ADD, QROperandFromExpr(rExpr->binOp.lExpr),
-                           QROperandFromExpr(rExpr->binOp.rExpr), QROperandFromExpr(expr->binOp.lExpr));
+            QRRecordAddBin(ctx->record, QROC_ADD, QROperandFromExpr(ctx, ATreeExpr(ctx, rExpr->binOp.lExpr)),
+                           QROperandFromExpr(ctx, ATreeExpr(ctx, rExpr->binOp.rExpr)), QROperandFromExpr(ctx, dstExpr));
             break;
         case ET_SUB:
-            QRRecordAddBin(bison->record, QROC_SUB, QROperandFromExpr(rExpr->binOp.lExpr),
-                           QROperandFromExpr(rExpr->binOp.rExpr), QROperandFromExpr(expr->binOp.lExpr));
+            QRRecordAddBin(ctx->record, QROC_SUB, QROperandFromExpr(ctx, ATreeExpr(ctx, rExpr->binOp.lExpr)),
+                           QROperandFromExpr(ctx, ATreeExpr(ctx, rExpr->binOp.rExpr)), QROperandFromExpr(ctx, dstExpr));
             break;
         case ET_MUL:
-            QRRecordAddBin(bison->record, QROC_MUL, QROperandFromExpr(rExpr->binOp.lExpr),
-                           QROperandFromExpr(rExpr->binOp.rExpr), QROperandFromExpr(expr->binOp.lExpr));
+            QRRecordAddBin(ctx->record, QROC_MUL, QROperandFromExpr(ctx, ATreeExpr(ctx, rExpr->binOp.lExpr)),
+                           QROperandFromExpr(ctx, ATreeExpr(ctx, rExpr->binOp.rExpr)), QROperandFromExpr(ctx, dstExpr));
             break;
         case ET_DIV:
-            QRRecordAddBin(bison->record, QROC_DIV, QROperandFromExpr(rExpr->binOp.lExpr),
-                           QROperandFromExpr(rExpr->binOp.rExpr), QROperandFromExpr(expr->binOp.lExpr));
+            QRRecordAddBin(ctx->record, QROC_DIV, QROperandFromExpr(ctx, ATreeExpr(ctx, rExpr->binOp.lExpr)),
+                           QROperandFromExpr(ctx, ATreeExpr(ctx, rExpr->binOp.rExpr)), QROperandFromExpr(ctx, dstExpr));
             break;
         case ET_MOD:
-            QRRecordAddBin(bison->record, QROC_MOD, QROperandFromExpr(rExpr->binOp.lExpr),
-                           QROperandFromExpr(rExpr->binOp.rExpr), QROperandFromExpr(expr->binOp.lExpr));
+            QRRecordAddBin(ctx->record, QROC_MOD, QROperandFromExpr(ctx, ATreeExpr(ctx, rExpr->binOp.lExpr)),
+                           QROperandFromExpr(ctx, ATreeExpr(ctx, rExpr->binOp.rExpr)), QROperandFromExpr(ctx, dstExpr));
             break;
         case ET_CONST:
         case ET_TEMP:
@@ -1023,15 +1298,15 @@ static int GenExprStmt(Stmt *stmt, BPInsList **nextList)
         case ET_TYPE_CAST:
         case ET_ID:
         case ET_ACCESS_ELM:
-            QRRecordAddUnary(bison->record, QROC_ASSIGN, QROperandFromExpr(expr->binOp.rExpr),
-                             QROperandFromExpr(expr->binOp.lExpr));
+            QRRecordAddUnary(ctx->record, QROC_ASSIGN, QROperandFromExpr(ctx, rExpr),
+                             QROperandFromExpr(ctx, dstExpr));
             break;
         default:
             PrErr("rExpr->type: %u", rExpr->type);
-            exit(-1);
+            CplExit(-1);
         }
     } else if (expr->type == ET_FUN_REF) {
-        GenFunRefExprForm(expr);
+        GenFunRefExprForm(ctx, expr);
     } else {
         /*其它表达式不处理。*/
     }
@@ -1044,134 +1319,155 @@ static int GenExprStmt(Stmt *stmt, BPInsList **nextList)
  * 功能：生成if语句
  * 返回值：
  */
-static int GenIfStmt(Stmt *stmt, BPInsList **nextList)
+static void GenIfStmt(Bison *ctx, GenStmtFrame *frame)
 {
-    BPInsList *trueList = NULL, *falseList = NULL;
-    BPInsList *subNext = NULL;
-
-    GenExprJumping(stmt->ifStmt.cond, &trueList, &falseList);
-    BPInsListBackPatch(trueList, bison->record, bison->record->idx);
-    GenStmt(stmt->ifStmt.stmt, &subNext);
-    BPInsListMerge(falseList, subNext);
-    *nextList = falseList;
-    return 0;
+    Stmt *stmt = frame->stmt;
+    BPInsList *trueList = NULL;
+
+    if (frame->step++ == 0) {
+        GenExprJumping(ctx, ATreeExpr(ctx, stmt->ifStmt.cond), &trueList, &frame->falseList);
+        BPInsListBackPatch(trueList, ctx->record, ctx->record->idx);
+        GenStmtPush(ctx, GSFT_STMT, ATreeStmt(ctx, stmt->ifStmt.stmt), &frame->subNextList);
+        return;
+    }
+    BPInsListMerge(frame->falseList, frame->subNextList);
+    *frame->nextList = frame->falseList;
+    GenStmtPop(ctx);
 }
 
 /*
  * 功能：生成if else语句
  * 返回值：
  */
-static int GenElseStmt(Stmt *stmt, BPInsList **nextList)
+static void GenElseStmt(Bison *ctx, GenStmtFrame *frame)
 {
-    BPInsList *trueList = NULL, *falseList = NULL;
-    BPInsList *sub1Next = NULL, *sub2Next = NULL;
-    BPInsList *newNextList;
-
-    GenExprJumping(stmt->elseStmt.cond, &trueList, &falseList);
-    BPInsListBackPatch(trueList, bison->record, bison->record->idx);
-    GenStmt(stmt->elseStmt.ifStmt, &sub1Next);
-    QRRecordAddUncondJump(bison->record, 0);
-    newNextList = BPMakeInsList(GEN_CUR_INSTRUCT());
-    BPInsListBackPatch(falseList, bison->record, bison->record->idx);
-    GenStmt(stmt->elseStmt.elseStmt, &sub2Next);
-    BPInsListMerge(newNextList, sub1Next);
-    BPInsListMerge(newNextList, sub2Next);
-    *nextList = newNextList;
-    return 0;
+    Stmt *stmt = frame->stmt;
+    BPInsList *trueList = NULL;
+
+    switch (frame->step++) {
+    case 0:
+        GenExprJumping(ctx, ATreeExpr(ctx, stmt->elseStmt.cond), &trueList, &frame->falseList);
+        BPInsListBackPatch(trueList, ctx->record, ctx->record->idx);
+        GenStmtPush(ctx, GSFT_STMT, ATreeStmt(ctx, stmt->elseStmt.ifStmt), &frame->subNextList);
+        return;
+    case 1:
+        QRRecordAddUncondJump(ctx->record, 0);
+        frame->newNextList = BPMakeInsList(GEN_CUR_INSTRUCT());
+        BPInsListBackPatch(frame->falseList, ctx->record, ctx->record->idx);
+        GenStmtPush(ctx, GSFT_STMT, ATreeStmt(ctx, stmt->elseStmt.elseStmt), &frame->sub2NextList);
+        return;
+    }
+    BPInsListMerge(frame->newNextList, frame->subNextList);
+    BPInsListMerge(frame->newNextList, frame->sub2NextList);
+    *frame->nextList = frame->newNextList;
+    GenStmtPop(ctx);
 }
 
 /*
  * 功能：生成while语句
  * 返回值：
  */
-static int GenWhileStmt(Stmt *stmt, BPInsList **nextList)
+static void GenWhileStmt(Bison *ctx, GenStmtFrame *frame)
 {
-    BPInsList *subNextList = NULL;
-    BPInsList *trueList = NULL, *falseList = NULL;
-    size_t beginInsIdx;
-
-    EnvLastLevelListPush(bison->env, stmt);
-    beginInsIdx = bison->record->idx;
-    GenExprJumping(stmt->whileStmt.cond, &trueList, &falseList);
-    BPInsListBackPatch(trueList, bison->record, bison->record->idx);
-    GenStmt(stmt->whileStmt.stmt, &subNextList);
-    QRRecordAddUncondJump(bison->record, beginInsIdx);
-    BPInsListMerge(subNextList, stmt->whileStmt.continueList);
-    BPInsListBackPatch(subNextList, bison->record, beginInsIdx);
-    BPInsListMerge(falseList, stmt->whileStmt.breakList);
-    *nextList = falseList;
-    EnvLastLevelListPop(bison->env);
-    return 0;
+    Stmt *stmt = frame->stmt;
+    BPInsList *trueList = NULL;
+
+    if (frame->step++ == 0) {
+        EnvLastLevelListPush(ctx->env, stmt);
+        frame->insIdx = ctx->record->idx;
+        GenExprJumping(ctx, ATreeExpr(ctx, stmt->whileStmt.cond), &trueList, &frame->falseList);
+        BPInsListBackPatch(trueList, ctx->record, ctx->record->idx);
+        GenStmtPush(ctx, GSFT_STMT, ATreeStmt(ctx, stmt->whileStmt.stmt), &frame->subNextList);
+        return;
+    }
+    QRRecordAddUncondJump(ctx->record, frame->insIdx);
+    BPInsListMerge(frame->subNextList, stmt->whileStmt.continueList);
+    BPInsListBackPatch(frame->subNextList, ctx->record, frame->insIdx);
+    BPInsListMerge(frame->falseList, stmt->whileStmt.breakList);
+    *frame->nextList = frame->falseList;
+    EnvLastLevelListPop(ctx->env);
+    GenStmtPop(ctx);
 }
 
 /*
  * 功能：生成do while语句
  * 返回值：
  */
-static int GenDoStmt(Stmt *stmt, BPInsList **nextList)
+static void GenDoStmt(Bison *ctx, GenStmtFrame *frame)
 {
-    BPInsList *subNextList = NULL;
+    Stmt *stmt = frame->stmt;
     BPInsList *trueList = NULL, *falseList = NULL;
-    size_t beginInsIdx;
-
-    EnvLastLevelListPush(bison->env, stmt);
-    beginInsIdx = bison->record->idx;
-    GenStmt(stmt->doStmt.stmt, &subNextList);
-    BPInsListBackPatch(subNextList, bison->record, beginInsIdx);
-    GenExprJumping(stmt->doStmt.cond, &trueList, &falseList);
-    BPInsListBackPatch(trueList, bison->record, beginInsIdx);
-    BPInsListBackPatch(stmt->doStmt.continueList, bison->record, beginInsIdx);
+
+    if (frame->step++ == 0) {
+        EnvLastLevelListPush(ctx->env, stmt);
+        frame->insIdx = ctx->record->idx;
+        GenStmtPush(ctx, GSFT_STMT, ATreeStmt(ctx, stmt->doStmt.stmt), &frame->subNextList);
+        return;
+    }
+    BPInsListBackPatch(frame->subNextList, ctx->record, frame->insIdx);
+    GenExprJumping(ctx, ATreeExpr(ctx, stmt->doStmt.cond), &trueList, &falseList);
+    BPInsListBackPatch(trueList, ctx->record, frame->insIdx);
+    BPInsListBackPatch(stmt->doStmt.continueList, ctx->record, frame->insIdx);
     BPInsListMerge(falseList, stmt->doStmt.breakList);
-    *nextList = falseList;
-    EnvLastLevelListPop(bison->env);
-    return 0;
+    *frame->nextList = falseList;
+    EnvLastLevelListPop(ctx->env);
+    GenStmtPop(ctx);
 }
 
 /*
- * 功能：生成语句序列
+ * 功能：生成语句序列，每次压入一条语句。前一条语句的下一条指令就是当前语句的第一条指令，
+ *      最后一条语句的nextList交给调用者。
  * 返回值：
  */
-static int GenStmts(Stmts *stmts, BPInsList **nextList)
+static void GenStmts(Bison *ctx, GenStmtFrame *frame)
 {
-    BPInsList *newNextList = NULL;
+    Stmts *stmts = frame->stmts;
+    BPInsList **nextList;
 
-    if (!stmts)
-        return 0;
-    if (stmts->prevStmts) {
-        GenStmts(stmts->prevStmts, &newNextList);
-        BPInsListBackPatch(newNextList, bison->record, bison->record->idx);
+    if (frame->idx == stmts->num) {
+        GenStmtPop(ctx);
+        return;
     }
-    GenStmt(stmts->stmt, nextList);
-    return 0;
+    if (frame->idx > 0)
+        BPInsListBackPatch(frame->subNextList, ctx->record, ctx->record->idx);
+    frame->subNextList = NULL;
+    nextList = frame->idx + 1 == stmts->num ? frame->nextList : &frame->subNextList;
+    GenStmtPush(ctx, GSFT_STMT, ATreeStmt(ctx, ATreeSeqId(ctx, stmts, frame->idx)), nextList);
+    frame->idx++;
 }
 
 /*
  * 功能：生成块语句
  * 返回值：
  */
-static int GenBlockStmt(Stmt *stmt, BPInsList **nextList)
+static void GenBlockStmt(Bison *ctx, GenStmtFrame *frame)
 {
-    QRRecordAddBlkStart(bison->record, stmt->domain);
-    GenStmts(stmt->blockStmt.stmts, nextList);
-    QRRecordAddBlkEnd(bison->record, stmt->domain);
-    return 0;
+    Stmt *stmt = frame->stmt;
+
+    if (frame->step++ == 0) {
+        QRRecordAddBlkStart(ctx->record, stmt->domain);
+        GenStmtPush(ctx, GSFT_STMTS, &stmt->blockStmt.stmts, frame->nextList);
+        return;
+    }
+    QRRecordAddBlkEnd(ctx->record, stmt->domain);
+    GenStmtPop(ctx);
 }
 
 /*
  * 功能：生成break语句
  * 返回值：
  */
-static int GenBreakStmt(Stmt *stmt, BPInsList **nextList)
+static int GenBreakStmt(Bison *ctx, Stmt *stmt, BPInsList **nextList)
 {
     Stmt *topStmt;
     BPInsList *bpInsList = NULL;
 
     (void)stmt;
     *nextList = NULL;
-    topStmt = EnvBreakLastLevelListTop(bison->env);
+    topStmt = EnvBreakLastLevelListTop(ctx->env);
     if (!topStmt) {
         PrErr("break no last level\n");
-        exit(-1);
+        CplExit(-1);
     }
     if (topStmt->type == ST_WHILE) {
         bpInsList = topStmt->whileStmt.breakList;
@@ -1181,9 +1477,9 @@ static int GenBreakStmt(Stmt *stmt, BPInsList **nextList)
         bpInsList = topStmt->switchStmt.breakList;
     }  else {
         PrErr("statement type error\n");
-        exit(-1);
+        CplExit(-1);
     }
-    QRRecordAddUncondJump(bison->record, 0);
+    QRRecordAddUncondJump(ctx->record, 0);
     BPInsListAddInstruct(bpInsList, GEN_CUR_INSTRUCT());
     return 0;
 }
@@ -1192,17 +1488,17 @@ static int GenBreakStmt(Stmt *stmt, BPInsList **nextList)
  * 功能：生成continue语句。
  * 返回值：
  */
-static int GenContinueStmt(Stmt *stmt, BPInsList **nextList)
+static int GenContinueStmt(Bison *ctx, Stmt *stmt, BPInsList **nextList)
 {
     Stmt *topStmt;
     BPInsList *bpInsList = NULL;
 
     (void)stmt;
     *nextList = NULL;
-    topStmt = EnvContinueLastLevelListTop(bison->env);
+    topStmt = EnvContinueLastLevelListTop(ctx->env);
     if (!topStmt) {
         PrErr("continue no last level\n");
-        exit(-1);
+        CplExit(-1);
     }
     if (topStmt->type == ST_WHILE) {
         bpInsList = topStmt->whileStmt.continueList;
@@ -1210,9 +1506,9 @@ static int GenContinueStmt(Stmt *stmt, BPInsList **nextList)
         bpInsList = topStmt->doStmt.continueList;
     } else {
         PrErr("statement type error\n");
-        exit(-1);
+        CplExit(-1);
     }
-    QRRecordAddUncondJump(bison->record, 0);
+    QRRecordAddUncondJump(ctx->record, 0);
     BPInsListAddInstruct(bpInsList, GEN_CUR_INSTRUCT());
 
     return 0;
@@ -1230,197 +1526,456 @@ typedef struct {
     Expr *expr;
 } ExprLabelMap;
 
-static ExprLabelMap *GenNewExprLabelMap(size_t label, Expr *expr)
+static ExprLabelMap *GenNewExprLabelMap(Bison *ctx, size_t label, Expr *expr)
 {
     ExprLabelMap *elMap;
 
-    elMap = GenMAlloc(sizeof (*elMap));
+    elMap = GenMAlloc(ctx, sizeof (*elMap));
     elMap->type = ELMT_EXPR_LABEL;
     elMap->expr = expr;
     elMap->label = label;
     return elMap;
 }
 
-static ExprLabelMap *GenNewDefaultLabelMap(size_t label)
+static ExprLabelMap *GenNewDefaultLabelMap(Bison *ctx, size_t label)
 {
     ExprLabelMap *elMap;
 
-    elMap = GenMAlloc(sizeof (*elMap));
+    elMap = GenMAlloc(ctx, sizeof (*elMap));
     elMap->type = ELMT_DEFAULT_LABEL;
     elMap->label = label;
     return elMap;
 }
 
-static int GenCaseStmts(CaseStmts *caseStmts, BPInsList **nextList, struct list_head *list)
+/*
+ * 功能：生成case语句，case标号加入标号链表
+ * 返回值：
+ **/
+static void GenCaseStmt(Bison *ctx, GenStmtFrame *frame)
 {
-    CaseStmt *caseStmt;
+    CaseStmt *caseStmt = frame->caseStmt;
     ExprLabelMap *exprLabelMap;
-    BPInsList *prevStmtsNextList = NULL;
-    BPInsList *newNextList = NULL;
-    size_t label;
 
-    if (!caseStmts) {
-        *nextList = BPAllocInsList();
-        return 0;
+    if (frame->step++ == 0) {
+        if (caseStmt->type == CST_CASE_EXPR) {
+            frame->expr = GenExprReduce(ctx, ATreeExpr(ctx, caseStmt->caseExpr.expr));
+            frame->insIdx = ctx->record->idx;
+            GenStmtPush(ctx, GSFT_STMTS, &caseStmt->caseExpr.stmts, &frame->subNextList);
+        } else if (caseStmt->type == CST_CASE_DEFAULT) {
+            frame->insIdx = ctx->record->idx;
+            GenStmtPush(ctx, GSFT_STMTS, &caseStmt->stmts, &frame->subNextList);
+        } else {
+            PrErr("error, unknown case stmt type");
+            CplExit(-1);
+        }
+        return;
+    }
+    if (caseStmt->type == CST_CASE_EXPR)
+        exprLabelMap = GenNewExprLabelMap(ctx, frame->insIdx, frame->expr);
+    else
+        exprLabelMap = GenNewDefaultLabelMap(ctx, frame->insIdx);
+    *frame->nextList = frame->subNextList;
+    list_add_tail(&exprLabelMap->node, frame->labelList);
+    GenStmtPop(ctx);
+}
+
+/*
+ * 功能：按源代码顺序生成switch中的case语句，前一个case语句执行完后落入下一个case语句。
+ * 返回值：
+ **/
+static void GenCaseStmts(Bison *ctx, GenStmtFrame *frame)
+{
+    CaseStmts *caseStmts = frame->caseStmts;
+    GenStmtFrame *caseFrame;
+    BPInsList **nextList;
+
+    if (caseStmts->num == 0) {
+        *frame->nextList = BPAllocInsList();
+        GenStmtPop(ctx);
+        return;
     }
-    if (caseStmts->prev) {
-        GenCaseStmts(caseStmts->prev, &prevStmtsNextList, list);
-        BPInsListBackPatch(prevStmtsNextList, bison->record, bison->record->idx);
+    if (frame->idx == caseStmts->num) {
+        GenStmtPop(ctx);
+        return;
     }
+    if (frame->idx > 0)
+        BPInsListBackPatch(frame->subNextList, ctx->record, ctx->record->idx);
+    frame->subNextList = NULL;
+    nextList = frame->idx + 1 == caseStmts->num ? frame->nextList : &frame->subNextList;
+    caseFrame = GenStmtPush(ctx, GSFT_CASE_STMT, ATreeCaseStmt(ctx, ATreeSeqId(ctx, caseStmts, frame->idx)), nextList);
+    frame->idx++;
+    caseFrame->labelList = frame->labelList;
+}
 
-    caseStmt = caseStmts->caseStmt;
-    if (caseStmt->type == CST_CASE_EXPR) {
-        Expr *temp;
+#define GEN_SWITCH_MIN_CASES    4       /*case标号少于这个数量时逐个比较*/
+#define GEN_SWITCH_MAX_TABLE    4096    /*跳转表的最大长度*/
+#define GEN_SWITCH_MAX_SPARSITY 3       /*跳转表长度不超过case标号数量的这个倍数时使用跳转表*/
 
-        temp = GenExprReduce(caseStmt->caseExpr.expr);
-        label = bison->record->idx;
-        GenStmts(caseStmt->caseExpr.stmts, &newNextList);
-        exprLabelMap = GenNewExprLabelMap(label, temp);
-    } else if (caseStmt->type == CST_CASE_DEFAULT) {
-        label = bison->record->idx;
-        GenStmts(caseStmt->stmts, &newNextList);
-        exprLabelMap = GenNewDefaultLabelMap(label);
-    } else {
-        PrErr("error, unknown case stmt type");
-        exit(-1);
+/*整型常量case标号*/
+typedef struct {
+    int value;
+    size_t label;
+    uint32_t order;     /*在switch语句中的次序，值相同的标号只保留第一个*/
+} GenCaseLabel;
+
+/*
+ * 功能：获取整型常量表达式的值。
+ * 返回值：是整型常量时返回1，否则返回0。
+ **/
+static int GenExprIntConst(const Expr *expr, int *pValue)
+{
+    if (expr->type == ET_CONST && expr->cValue.type == CVT_IDIGIT) {
+        *pValue = expr->cValue.token->digit;
+        return 1;
+    }
+    if (expr->type == ET_CONST_SPC && expr->cValueSpc.type == CVTS_IDIGIT) {
+        *pValue = expr->cValueSpc.iValue;
+        return 1;
     }
-    *nextList = newNextList;
-    list_add_tail(&exprLabelMap->node, list);
     return 0;
 }
 
-static int GenSwichTestStmt(struct list_head *exprLabelMapList, Expr *testExpr)
+static int GenCaseLabelCmp(const void *a, const void *b)
+{
+    const GenCaseLabel *l = a, *r = b;
+
+    if (l->value != r->value)
+        return l->value < r->value ? -1 : 1;
+    return l->order < r->order ? -1 : l->order > r->order;
+}
+
+/*
+ * 功能：生成比较testExpr和常量value的条件跳转，目标标号为0时由调用者回填。
+ * 返回值：
+ **/
+static void GenSwitchCmpJump(Bison *ctx, Expr *testExpr, ExprType type, int value, size_t label)
+{
+    Expr *cond;
+
+    cond = ATreeNewBinExpr(ctx, testExpr->domain, type, ctx->env->boolType, testExpr,
+                           ATreeNewCValueSpcIntExpr(ctx, testExpr->domain, value));
+    QRRecordAddCondJump(ctx->record, QROC_TRUE_JUMP, cond, label);
+}
+
+static void GenSwitchMissJump(Bison *ctx, BPInsList *missList)
+{
+    QRRecordAddUncondJump(ctx->record, 0);
+    BPInsListAddInstruct(missList, GEN_CUR_INSTRUCT());
+}
+
+/*
+ * 功能：按源代码顺序逐个比较case标号，标号不全是整型常量时使用。
+ * 返回值：
+ **/
+static void GenSwitchLinearTest(Bison *ctx, struct list_head *exprLabelMapList, Expr *testExpr)
 {
     struct list_head *pos;
     ExprLabelMap *exprLabelMap;
-    size_t defaultLabel = 0;
 
     list_for_each(pos, exprLabelMapList) {
         exprLabelMap = container_of(pos, ExprLabelMap, node);
         if (exprLabelMap->type == ELMT_EXPR_LABEL) {
             Expr *eqExpr, *reduceExpr;
 
-            eqExpr = ATreeNewBinExpr(testExpr->domain, ET_EQ, bison->env->boolType,
+            eqExpr = ATreeNewBinExpr(ctx, testExpr->domain, ET_EQ, ctx->env->boolType,
                                      testExpr, exprLabelMap->expr);
-            reduceExpr = GenExprReduce(eqExpr);
-            QRRecordAddCondJump(bison->record, QROC_TRUE_JUMP,
+            reduceExpr = GenExprReduce(ctx, eqExpr);
+            QRRecordAddCondJump(ctx->record, QROC_TRUE_JUMP,
                                      reduceExpr, exprLabelMap->label);
+        }
+    }
+}
+
+/*
+ * 功能：用平衡的二分查找比较树匹配caseArr[lo, hi)中的标号，少量标号直接逐个比较，
+ *      没有匹配的标号时跳转指令加入missList。
+ * 返回值：
+ **/
+static void GenSwitchSearchTest(Bison *ctx, Expr *testExpr, const GenCaseLabel *caseArr,
+                                uint32_t lo, uint32_t hi, BPInsList *missList)
+{
+    BPInsList *leftList;
+    uint32_t mid, i;
+
+    if (hi - lo < GEN_SWITCH_MIN_CASES) {
+        for (i = lo; i < hi; i++)
+            GenSwitchCmpJump(ctx, testExpr, ET_EQ, caseArr[i].value, caseArr[i].label);
+        GenSwitchMissJump(ctx, missList);
+        return;
+    }
+    mid = lo + (hi - lo) / 2;
+    GenSwitchCmpJump(ctx, testExpr, ET_LT, caseArr[mid].value, 0);
+    leftList = BPMakeInsList(GEN_CUR_INSTRUCT());
+    GenSwitchCmpJump(ctx, testExpr, ET_EQ, caseArr[mid].value, caseArr[mid].label);
+    GenSwitchSearchTest(ctx, testExpr, caseArr, mid + 1, hi, missList);
+    BPInsListBackPatch(leftList, ctx->record, ctx->record->idx);
+    GenSwitchSearchTest(ctx, testExpr, caseArr, lo, mid, missList);
+}
+
+/*
+ * 功能：生成带边界检查的跳转表，越界时的跳转指令加入missList。跳转表中没有case标号的
+ *      位置跳转到default语句，没有default语句时跳转到测试代码之后的指令。
+ * 返回值：
+ **/
+static void GenSwitchTableTest(Bison *ctx, Expr *testExpr, const GenCaseLabel *caseArr, uint32_t caseNum,
+                               size_t defaultLabel, BPInsList *missList)
+{
+    Domain *domain = testExpr->domain;
+    Expr *idxExpr = testExpr;
+    size_t *labelArr;
+    size_t missLabel;
+    uint32_t tableNum, i;
+    int minValue;
+
+    minValue = caseArr[0].value;
+    tableNum = (uint32_t)((int64_t)caseArr[caseNum - 1].value - minValue + 1);
+    if (minValue != 0) {
+        idxExpr = ATreeNewTemp(ctx, domain, ctx->env->intType);
+        QRRecordAddBin(ctx->record, QROC_SUB, QROperandFromExpr(ctx, testExpr),
+                       QROperandFromExpr(ctx, ATreeNewCValueSpcIntExpr(ctx, domain, minValue)),
+                       QROperandFromExpr(ctx, idxExpr));
+    }
+    GenSwitchCmpJump(ctx, idxExpr, ET_LT, 0, 0);
+    BPInsListAddInstruct(missList, GEN_CUR_INSTRUCT());
+    GenSwitchCmpJump(ctx, idxExpr, ET_GT, tableNum - 1, 0);
+    BPInsListAddInstruct(missList, GEN_CUR_INSTRUCT());
+
+    /*跳转表跳转是测试代码的最后一条指令，标号数组直接交给四元式*/
+    missLabel = defaultLabel != 0 ? defaultLabel : ctx->record->idx + 1;
+    labelArr = GenMAlloc(ctx, tableNum * sizeof (*labelArr));
+    for (i = 0; i < tableNum; i++)
+        labelArr[i] = missLabel;
+    for (i = 0; i < caseNum; i++)
+        labelArr[caseArr[i].value - minValue] = caseArr[i].label;
+    QRRecordAddTableJump(ctx->record, QROperandFromExpr(ctx, idxExpr), labelArr, tableNum);
+}
+
+/*
+ * 功能：生成switch语句的测试代码。case标号都是整型常量时，稠密的标号用跳转表分派，
+ *      稀疏的标号用二分查找比较树分派，否则按源代码顺序逐个比较。
+ *      没有匹配的标号时跳转到default语句，没有default语句时落入测试代码之后的指令。
+ * 返回值：
+ **/
+static int GenSwichTestStmt(Bison *ctx, struct list_head *exprLabelMapList, Expr *testExpr)
+{
+    struct list_head *pos;
+    ExprLabelMap *exprLabelMap;
+    GenCaseLabel *caseArr = NULL;
+    BPInsList *missList;
+    Type *testType;
+    size_t defaultLabel = 0;
+    uint32_t caseNum = 0, num = 0, i;
+    int constFlag = 1;
+    int value;
+
+    list_for_each(pos, exprLabelMapList) {
+        exprLabelMap = container_of(pos, ExprLabelMap, node);
+        if (exprLabelMap->type == ELMT_EXPR_LABEL) {
+            caseNum++;
+            if (!GenExprIntConst(exprLabelMap->expr, &value))
+                constFlag = 0;
         } else if (exprLabelMap->type == ELMT_DEFAULT_LABEL) {
             if (defaultLabel == 0) {
                 defaultLabel = exprLabelMap->label;
             } else {
                 PrErr("syntax error, too many default stmt");
-                exit(-1);
+                CplExit(-1);
             }
         }
     }
-    if (defaultLabel != 0) {
-        QRRecordAddUncondJump(bison->record, defaultLabel);
+    testType = ATreeExprType(ctx, testExpr);
+    if (testType->type != TT_BASE || testType->baseType.type == BTT_FLOAT)
+        constFlag = 0;
+
+    if (!constFlag || caseNum == 0) {
+        GenSwitchLinearTest(ctx, exprLabelMapList, testExpr);
+        if (defaultLabel != 0)
+            QRRecordAddUncondJump(ctx->record, defaultLabel);
+        EnvLastLevelListPop(ctx->env);
+        return 0;
+    }
+
+    caseArr = GenMAlloc(ctx, caseNum * sizeof (*caseArr));
+    list_for_each(pos, exprLabelMapList) {
+        exprLabelMap = container_of(pos, ExprLabelMap, node);
+        if (exprLabelMap->type != ELMT_EXPR_LABEL)
+            continue;
+        GenExprIntConst(exprLabelMap->expr, &caseArr[num].value);
+        caseArr[num].label = exprLabelMap->label;
+        caseArr[num].order = num;
+        num++;
+    }
+    qsort(caseArr, caseNum, sizeof (*caseArr), GenCaseLabelCmp);
+    for (num = 0, i = 0; i < caseNum; i++) {
+        if (num == 0 || caseArr[i].value != caseArr[num - 1].value)
+            caseArr[num++] = caseArr[i];
+    }
+    caseNum = num;
+
+    missList = BPAllocInsList();
+    if (caseNum >= GEN_SWITCH_MIN_CASES
+            && (int64_t)caseArr[caseNum - 1].value - caseArr[0].value < GEN_SWITCH_MAX_TABLE
+            && (int64_t)caseArr[caseNum - 1].value - caseArr[0].value
+               < (int64_t)caseNum * GEN_SWITCH_MAX_SPARSITY) {
+        GenSwitchTableTest(ctx, testExpr, caseArr, caseNum, defaultLabel, missList);
+    } else {
+        GenSwitchSearchTest(ctx, testExpr, caseArr, 0, caseNum, missList);
     }
-    EnvLastLevelListPop(bison->env);
+    BPInsListBackPatch(missList, ctx->record,
+                       defaultLabel != 0 ? defaultLabel : ctx->record->idx);
+    EnvLastLevelListPop(ctx->env);
 
     return 0;
 }
 
-static int GenSwitchStmt(Stmt *stmt, BPInsList **nextList)
+static void GenSwitchStmt(Bison *ctx, GenStmtFrame *frame)
 {
-    Expr *testExpr;
-    struct list_head exprLabelMapList;
-    BPInsList *testInsList = NULL;
-    BPInsList *newNextList = NULL;
-    BPInsList *caseNextList = NULL;
-
-    newNextList = BPAllocInsList();
-    EnvLastLevelListPush(bison->env, stmt);
-    testExpr = GenExprReduce(stmt->switchStmt.expr);
-    QRRecordAddUncondJump(bison->record, 0);
-    testInsList = BPMakeInsList(GEN_CUR_INSTRUCT());
-    INIT_LIST_HEAD(&exprLabelMapList);
-    GenCaseStmts(stmt->switchStmt.caseStmts, &caseNextList, &exprLabelMapList);
-    QRRecordAddUncondJump(bison->record, 0);
-    BPInsListAddInstruct(newNextList, GEN_CUR_INSTRUCT());
-    BPInsListMerge(newNextList, stmt->switchStmt.breakList);
-    BPInsListMerge(newNextList, caseNextList);
-    *nextList = newNextList;
-    BPInsListBackPatch(testInsList, bison->record, bison->record->idx);
-    GenSwichTestStmt(&exprLabelMapList, testExpr);
-    EnvLastLevelListPop(bison->env);
-    return 0;
+    Stmt *stmt = frame->stmt;
+    GenStmtFrame *casesFrame;
+
+    if (frame->step++ == 0) {
+        frame->newNextList = BPAllocInsList();
+        EnvLastLevelListPush(ctx->env, stmt);
+        frame->expr = GenExprReduce(ctx, ATreeExpr(ctx, stmt->switchStmt.expr));
+        QRRecordAddUncondJump(ctx->record, 0);
+        frame->insList = BPMakeInsList(GEN_CUR_INSTRUCT());
+        INIT_LIST_HEAD(&frame->exprLabelMapList);
+        casesFrame = GenStmtPush(ctx, GSFT_CASE_STMTS, &stmt->switchStmt.caseStmts, &frame->subNextList);
+        casesFrame->labelList = &frame->exprLabelMapList;
+        return;
+    }
+    QRRecordAddUncondJump(ctx->record, 0);
+    BPInsListAddInstruct(frame->newNextList, GEN_CUR_INSTRUCT());
+    BPInsListMerge(frame->newNextList, stmt->switchStmt.breakList);
+    BPInsListMerge(frame->newNextList, frame->subNextList);
+    *frame->nextList = frame->newNextList;
+    BPInsListBackPatch(frame->insList, ctx->record, ctx->record->idx);
+    GenSwichTestStmt(ctx, &frame->exprLabelMapList, frame->expr);
+    EnvLastLevelListPop(ctx->env);
+    GenStmtPop(ctx);
 }
 
-static int GenReturnVoidStmt(Stmt *stmt, BPInsList **nextList)
+static int GenReturnVoidStmt(Bison *ctx, Stmt *stmt, BPInsList **nextList)
 {
     (void)stmt;
     *nextList = NULL;
-    QRRecordAddReturnVoid(bison->record, stmt->domain);
+    QRRecordAddReturnVoid(ctx->record, stmt->domain);
     return 0;
 }
 
-static int GenReturnValueStmt(Stmt *stmt, BPInsList **nextList)
+static int GenReturnValueStmt(Bison *ctx, Stmt *stmt, BPInsList **nextList)
 {
     Expr *tempExpr;
 
     *nextList = NULL;
-    tempExpr = GenExprReduce(stmt->returnStmt.expr);
-    QRRecordAddReturnValue(bison->record, QROperandFromExpr(tempExpr), stmt->domain);
+    tempExpr = GenExprReduce(ctx, ATreeExpr(ctx, stmt->returnStmt.expr));
+    QRRecordAddReturnValue(ctx->record, QROperandFromExpr(ctx, tempExpr), stmt->domain);
     return 0;
 }
 
 /*
- * 功能：生成语句
+ * 功能：生成语句，执行栈顶栈帧的下一步。含有子语句的语句分步执行，其它语句一步生成完毕。
  * 返回值：
  */
-static int GenStmt(Stmt *stmt, BPInsList **nextList)
+static void GenStmt(Bison *ctx, GenStmtFrame *frame)
 {
+    Stmt *stmt = frame->stmt;
+
     switch (stmt->type) {
-    case ST_EXPR:
-        return GenExprStmt(stmt, nextList);
     case ST_IF:
-        return GenIfStmt(stmt, nextList);
+        GenIfStmt(ctx, frame);
+        return;
     case ST_ELSE:
-        return GenElseStmt(stmt, nextList);
+        GenElseStmt(ctx, frame);
+        return;
     case ST_WHILE:
-        return GenWhileStmt(stmt, nextList);
+        GenWhileStmt(ctx, frame);
+        return;
     case ST_DO:
-        return GenDoStmt(stmt, nextList);
+        GenDoStmt(ctx, frame);
+        return;
     case ST_BLOCK:
-        return GenBlockStmt(stmt, nextList);
+        GenBlockStmt(ctx, frame);
+        return;
+    case ST_SWITCH:
+        GenSwitchStmt(ctx, frame);
+        return;
+    case ST_EXPR:
+        GenExprStmt(ctx, stmt, frame->nextList);
+        break;
     case ST_BREAK:
-        return GenBreakStmt(stmt, nextList);
+        GenBreakStmt(ctx, stmt, frame->nextList);
+        break;
     case ST_CONTINUE:
-        return GenContinueStmt(stmt, nextList);
-    case ST_SWITCH:
-        return GenSwitchStmt(stmt, nextList);
+        GenContinueStmt(ctx, stmt, frame->nextList);
+        break;
     case ST_RETURN_VOID:
-        return GenReturnVoidStmt(stmt, nextList);
+        GenReturnVoidStmt(ctx, stmt, frame->nextList);
+        break;
     case ST_RETURN_VALUE:
-        return GenReturnValueStmt(stmt, nextList);
+        GenReturnValueStmt(ctx, stmt, frame->nextList);
+        break;
+    default:
+        PrErr("statement type error, %d\n", stmt->type);
+        CplExit(-1);
+    }
+    GenStmtPop(ctx);
+}
+
+/*
+ * 功能：用工作栈生成语句，语句的嵌套深度不占用C栈。
+ * 返回值：
+ */
+static int GenStmtRun(Bison *ctx, Stmt *stmt, BPInsList **nextList)
+{
+    GenWork *work = GenGetWork(ctx);
+    GenStmtFrame *base = work->stmtTop;
+    GenStmtFrame *frame;
+
+    GenStmtPush(ctx, GSFT_STMT, stmt, nextList);
+    while (work->stmtTop != base) {
+        frame = work->stmtTop;
+        switch (frame->type) {
+        case GSFT_STMT:
+            GenStmt(ctx, frame);
+            break;
+        case GSFT_STMTS:
+            GenStmts(ctx, frame);
+            break;
+        case GSFT_CASE_STMT:
+            GenCaseStmt(ctx, frame);
+            break;
+        case GSFT_CASE_STMTS:
+            GenCaseStmts(ctx, frame);
+            break;
+        }
     }
-    PrErr("statement type error, %d\n", stmt->type);
-    exit(-1);
+    return 0;
 }
 
-static int GenFunDefine(FunDefine *funDefine, BPInsList **nextList)
+static int GenFunDefine(Bison *ctx, FunDefine *funDefine, BPInsList **nextList)
 {
-    QRRecordAddFunStart(bison->record, funDefine->id, funDefine->funType);
-    GenStmt(funDefine->blockStmt, nextList);
-    QRRecordAddFunEnd(bison->record, funDefine->id, funDefine->blockStmt->domain);
+    QRRecordAddFunStart(ctx->record, funDefine->id, funDefine->funType);
+    GenStmtRun(ctx, ATreeStmt(ctx, funDefine->blockStmt), nextList);
+    QRRecordAddFunEnd(ctx->record, funDefine->id, ATreeStmt(ctx, funDefine->blockStmt)->domain);
     return 0;
 }
 
-static int GenFunDefines(FunDefines *funDefines, BPInsList **nextList)
+static int GenFunDefines(Bison *ctx, FunDefines *funDefines, BPInsList **nextList)
 {
-    BPInsList *newNextList = NULL;
+    BPInsList *newNextList;
+    uint32_t i;
 
-    if (!funDefines) {
+    if (!funDefines || funDefines->funDefineNum == 0) {
         *nextList = NULL;
         return 0;
     }
-    if (funDefines->prev) {
-        GenFunDefines(funDefines->prev, &newNextList);
-        BPInsListBackPatch(newNextList, bison->record, bison->record->idx);
+    for (i = 0; i + 1 < funDefines->funDefineNum; i++) {
+        newNextList = NULL;
+        GenFunDefine(ctx, funDefines->funDefineArr[i], &newNextList);
+        BPInsListBackPatch(newNextList, ctx->record, ctx->record->idx);
     }
-    GenFunDefine(funDefines->funDefine, nextList);
+    GenFunDefine(ctx, funDefines->funDefineArr[i], nextList);
     return 0;
 }
 
@@ -1428,15 +1983,20 @@ static int GenFunDefines(FunDefines *funDefines, BPInsList **nextList)
  * 功能：生成程序中间代码。
  * 返回值：
  */
-int GenProgram(Program *program)
+int GenProgram(Bison *ctx, Program *program)
 {
     BPInsList *nextList = NULL;
+    int error = 0;
 
     if (!program)
         return -EINVAL;
-    GenFunDefines(program->funDefines, &nextList);
-    BPInsListBackPatch(nextList, bison->record, bison->record->idx);
-    QRPrintRecord(bison->record);
+    GenFunDefines(ctx, program->funDefines, &nextList);
+    BPInsListBackPatch(nextList, ctx->record, ctx->record->idx);
+    error = OptRecord(ctx);
+    if (error != -ENOERR)
+        return error;
+    if (ctx->dumpFlag)
+        QRPrintRecord(ctx, ctx->record);
     return 0;
 }
 
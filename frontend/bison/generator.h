@@ -6,8 +6,9 @@ extern "C" {
 #endif
 
 typedef struct _Program Program;
+typedef struct _Bison Bison;
 
-int GenProgram(Program *program);
+int GenProgram(Bison *ctx, Program *program);
 
 #ifdef __cplusplus
 }
@@ -26,12 +26,7 @@ typedef enum _SymbolId {
     SID_COND            ,       //cond
     SID_ASSIGN_EXPR     ,       //assign_expr
     SID_LVALUE          ,       //lvalue
-    SID_LOR_EXPR        ,       //lor_expr
-    SID_LAND_EXPR       ,       //land_expr
-    SID_REL_L0_EXPR     ,       //rel_l0_expr
-    SID_ARITH_L0_EXPR   ,       //arith_l0_expr
-    SID_REL_L1_EXPR     ,       //rel_l1_expr
-    SID_ARITH_L1_EXPR   ,       //arith_l1_expr
+    SID_BIN_EXPR        ,       //bin_expr，二元运算表达式，运算符优先级由优先级声明决定
     SID_LEVEL2_EXPR,            //第二优先级表达式
     SID_LEVEL1_EXPR,            //第一优先级表达式
     SID_FACTOR          ,       //factor
@@ -27,7 +27,9 @@ static ProductBody *CfgAllocProductBody(void)
         INIT_LIST_HEAD(&productBody->firstSymIdList);
         INIT_LIST_HEAD(&productBody->symIdList);
         productBody->handle = NULL;
+        productBody->handleName = NULL;
         productBody->handleType = RHT_SELF;
+        productBody->precSymId = -1;
     }
     return productBody;
 }
@@ -91,6 +93,8 @@ static Symbol *CfgAllocSymbol(int id, const char *str, char type)
         INIT_LIST_HEAD(&symbol->firstSymIdList);
         INIT_LIST_HEAD(&symbol->followSymIdList);
         INIT_LIST_HEAD(&symbol->tailSymIdList);
+        symbol->prec = 0;
+        symbol->assoc = SA_NONE;
     }
     return symbol;
 }
@@ -149,7 +153,8 @@ int CfgAddProduct(ContextFreeGrammar *grammar, int product[], unsigned int len)
     return error;
 }
 
-int CfgAddProductH(ContextFreeGrammar *grammar, ReduceHandleType handleType, ProductBodyHandle *handle, int product[], unsigned int len)
+int CfgAddProductHandle(ContextFreeGrammar *grammar, ReduceHandleType handleType, ProductBodyHandle *handle,
+                        const char *handleName, int product[], unsigned int len)
 {
     ProductBody *productBody;
     Symbol *headSymbol;
@@ -178,11 +183,120 @@ int CfgAddProductH(ContextFreeGrammar *grammar, ReduceHandleType handleType, Pro
     }
     productBody->id = headSymbol->bodyNum++;
     productBody->handle = handle;
+    productBody->handleName = handle ? handleName : NULL;
     productBody->handleType = handleType;
     return error;
 }
 
 
+/*
+ * 功能：声明一组终结符号的优先级和结合性，同一次声明的符号优先级相同，
+ *      后声明的优先级比先声明的高，类似yacc的%left、%right、%nonassoc。
+ * assoc：结合性
+ * symIdArr：终结符号id数组
+ * len：数组长度
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int CfgAddPrecedence(ContextFreeGrammar *grammar, SymbolAssoc assoc, int symIdArr[], unsigned int len)
+{
+    Symbol *symbol;
+    unsigned int w;
+
+    if (!grammar || !symIdArr || len == 0 || assoc == SA_NONE)
+        return -EINVAL;
+
+    grammar->precNum++;
+    for (w = 0; w < len; w++) {
+        symbol = CfgGetSymbol(grammar, symIdArr[w]);
+        if (!symbol) {
+            PrErr("ENOSYM, sym id: %d", symIdArr[w]);
+            return -ENOSYM;
+        }
+        if (symbol->type != SYMBOL_TYPE_TERMINAL)
+            return -ESYMTYPE;
+        symbol->prec = grammar->precNum;
+        symbol->assoc = assoc;
+    }
+    return 0;
+}
+
+/*
+ * 功能：用终结符号precSymId的优先级作为产生式的优先级，类似yacc的%prec。
+ * precSymId：已经声明了优先级的终结符号id
+ * product：产生式，第一个符号是产生式头，其它符号是产生式体。
+ * len：产生式长度。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int CfgSetProductPrec(ContextFreeGrammar *grammar, int precSymId, int product[], unsigned int len)
+{
+    struct list_head *pos, *iter;
+    Symbol *headSymbol;
+    ProductBody *productBody;
+    SymId *symId;
+    unsigned int w;
+
+    if (!grammar || !product || len < 2)
+        return -EINVAL;
+
+    headSymbol = CfgGetSymbol(grammar, product[0]);
+    if (!headSymbol) {
+        PrErr("ENOSYM, sym id: %d", product[0]);
+        return -ENOSYM;
+    }
+    list_for_each(pos, &headSymbol->bodyList) {
+        productBody = container_of(pos, ProductBody, node);
+        w = 1;
+        list_for_each(iter, &productBody->symIdList) {
+            symId = container_of(iter, SymId, node);
+            if (w >= len || symId->id != product[w])
+                break;
+            w++;
+        }
+        if (iter == &productBody->symIdList && w == len) {
+            productBody->precSymId = precSymId;
+            return 0;
+        }
+    }
+    return -ENMATCHPB;
+}
+
+/*
+ * 功能：获取决定产生式优先级的终结符号，默认是产生式体最右边的终结符号。
+ * 返回值：声明了优先级的终结符号，产生式没有优先级时返回NULL。
+ **/
+const Symbol *CfgProductBodyPrecSymbol(const ContextFreeGrammar *grammar, const ProductBody *productBody)
+{
+    struct list_head *pos;
+    const Symbol *symbol, *precSymbol = NULL;
+    SymId *symId;
+
+    if (productBody->precSymId >= 0) {
+        precSymbol = CfgGetSymbol(grammar, productBody->precSymId);
+    } else {
+        list_for_each(pos, &productBody->symIdList) {
+            symId = container_of(pos, SymId, node);
+            symbol = CfgGetSymbol(grammar, symId->id);
+            if (symbol && symbol->type == SYMBOL_TYPE_TERMINAL)
+                precSymbol = symbol;
+        }
+    }
+    if (precSymbol && precSymbol->prec > 0)
+        return precSymbol;
+    return NULL;
+}
+
+/*
+ * 功能：单产生式A -> B的归约句柄，把产生式体的参数原样传给产生式头。
+ *      生成静态语法分析表时可以跳过使用这个句柄的单产生式归约。
+ * 返回值：成功时返回0。
+ **/
+int CfgPassHandle(void **headArg, void *prevArg, void *bodyArg[])
+{
+    (void)prevArg;
+    *headArg = bodyArg[0];
+    return 0;
+}
+
 /*
  * 功能：向文法添加符号
  * grammar: 文法
@@ -238,11 +352,11 @@ int ContextFreeGrammarAlloc(ContextFreeGrammar **pGrammar, int emptyId, int endI
         return -ENOMEM;
     }
     INIT_LIST_HEAD(&grammar->symbolList);
-    INIT_LIST_HEAD(&grammar->genFirstSymIdList);
     grammar->emptySymId = emptyId;
     grammar->endSymId = endId;
     grammar->startSymId = startId;
     grammar->maxSymId = 0;
+    grammar->precNum = 0;
     *pGrammar = grammar;
     return 0;
 }
@@ -266,7 +380,6 @@ void ContextFreeGrammarFree(ContextFreeGrammar *grammar)
         list_del(&symbol->node);
         CfgFreeSymbol(symbol);
     }
-    CfgSymIdListFree(&grammar->genFirstSymIdList);
     free(grammar);
 }
 
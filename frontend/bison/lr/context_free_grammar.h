@@ -28,6 +28,14 @@ typedef enum {
     RHT_PARENT, /*传递规约产生式头所在产生式体的参数，用于标记非终结符的数据传递。*/
 } ReduceHandleType;
 
+/*终结符号的结合性，与优先级一起用于解决移入/归约冲突*/
+typedef enum {
+    SA_NONE,        /*没有声明优先级*/
+    SA_LEFT,        /*左结合，优先级相同时归约*/
+    SA_RIGHT,       /*右结合，优先级相同时移入*/
+    SA_NONASSOC,    /*不结合，优先级相同时报错*/
+} SymbolAssoc;
+
 /*产生式体*/
 typedef struct {
     struct list_head node;
@@ -36,6 +44,8 @@ typedef struct {
     struct list_head firstSymIdList;    /*FIRST集合链表，节点类型：SymId*/
     ReduceHandleType handleType;        /*规约句柄类型*/
     ProductBodyHandle *handle;          /*归约处理句柄*/
+    const char *handleName;             /*归约处理句柄的函数名，用于生成静态语法分析表。*/
+    int precSymId;                      /*决定产生式优先级的终结符号id，-1表示取产生式体最右边的终结符号*/
 } ProductBody;
 
 /*上下文无关文法符号*/
@@ -49,6 +59,8 @@ typedef struct _Symbol {
     struct list_head firstSymIdList;    /*FIRST集合，节点类型：SymId*/
     struct list_head followSymIdList;   /*FOLLOW集合，节点类型：SymId*/
     struct list_head tailSymIdList;     /*产生式体尾部符号id链表，节点类型：SymId*/
+    int prec;           /*终结符号的优先级，数值越大优先级越高，0表示没有声明优先级*/
+    SymbolAssoc assoc;  /*终结符号的结合性*/
 } Symbol;
 
 typedef struct _Lalr Lalr;
@@ -58,15 +70,24 @@ typedef struct _ContextFreeGrammar {
     struct list_head symbolList;            /*符号链表，节点类型：Symbol*/
     int emptySymId, endSymId, startSymId;   /*空字符串符号id、结束符号id、起始符号id*/
     int maxSymId;                   /*始终保证它是文法中编号最大的符号id，用于判断向前看符号传播关系。*/
-
-    struct list_head genFirstSymIdList;     /*正在生成FIRST集合的符号id，节点类型：SymId*/
+    int precNum;                    /*优先级生成器，后声明的优先级高*/
 } ContextFreeGrammar;
 
 int ContextFreeGrammarAlloc(ContextFreeGrammar **pGrammar, int emptyId, int endId, int startId);
 void ContextFreeGrammarFree(ContextFreeGrammar *grammar);
 int CfgAddSymbol(ContextFreeGrammar *grammar, int id, const char *str, char type);
 int CfgAddProduct(ContextFreeGrammar *grammar, int product[], unsigned int len);
-int CfgAddProductH(ContextFreeGrammar *grammar, ReduceHandleType handleType, ProductBodyHandle *handle, int product[], unsigned int len);
+int CfgAddProductHandle(ContextFreeGrammar *grammar, ReduceHandleType handleType, ProductBodyHandle *handle,
+                        const char *handleName, int product[], unsigned int len);
+/*添加带归约句柄的产生式，同时记录句柄的函数名。*/
+#define CfgAddProductH(grammar, handleType, handle, ...) \
+    CfgAddProductHandle(grammar, handleType, handle, #handle, __VA_ARGS__)
+
+int CfgAddPrecedence(ContextFreeGrammar *grammar, SymbolAssoc assoc, int symIdArr[], unsigned int len);
+int CfgSetProductPrec(ContextFreeGrammar *grammar, int precSymId, int product[], unsigned int len);
+const Symbol *CfgProductBodyPrecSymbol(const ContextFreeGrammar *grammar, const ProductBody *productBody);
+
+int CfgPassHandle(void **headArg, void *prevArg, void *bodyArg[]);
 
 Symbol *CfgGetSymbol(const ContextFreeGrammar *grammar, int symId);
 const char *CfgSymbolStr(const Symbol *symbol);
@@ -1,14 +1,22 @@
 #include "error_recover.h"
 #include "lalr_parse_table.h"
 #include "lr_parse_algorithm.h"
+#include "lr_static_table.h"
 #include "first_follow.h"
 #include "list.h"
 #include "cpl_common.h"
 #include "cpl_debug.h"
 #include "cpl_errno.h"
+#include "cpl_bitset.h"
 #include "stdlib.h"
 #include "string.h"
 
+/*错误恢复的过程是诊断信息，输出到当前线程的诊断信息输出流*/
+static FILE *ErStream(void)
+{
+    return cplPrStream ? cplPrStream : stdout;
+}
+
 static int CfgSymIdSetAddArr(struct list_head *list, int arr[], unsigned int len)
 {
     int error = 0;
@@ -17,8 +25,11 @@ static int CfgSymIdSetAddArr(struct list_head *list, int arr[], unsigned int len
     if (!list || !arr)
         return -EINVAL;
 
+    /*保持数组顺序，错误恢复时按这个顺序选择非终结符号*/
     for (k = 0; k < len; k++) {
-        error = CfgSymIdSetAddId(list, arr[k]);
+        if (CfgSymIdSetIsContain(list, arr[k]) == 1)
+            continue;
+        error = CfgSymIdListTailAddId(list, arr[k]);
         if (error != -ENOERR)
             return error;
     }
@@ -48,40 +59,244 @@ static GotoNode *LrErrorRecoverGetGoto(ItemSet *itemSet, struct list_head *list)
 }
 
 /*
- * 功能：弹出格局栈中的状态，直到找到一个可用于错误恢复非终结符号。
- * grammar: 文法
- * stack: 格局栈
- * list: 错误恢复非终结符号链表
- * 返回值：成功时返回错误恢复非终结符号，否则返回错误码。
+ * 功能：把非终结符号的FOLLOW集合转换成位集合。
+ * 返回值：成功时返回0，否则返回错误码。
  **/
-static int LrErrorRecoverGetSymId(Lalr *lalr, struct list_head *stack, struct list_head *list)
+static int LrErrorRecoverGenFollow(Lalr *lalr, int symId, uint32_t *follow)
 {
+    struct list_head followList;
+    struct list_head *pos;
+    SymId *followSymId;
+    int error = 0;
+
+    INIT_LIST_HEAD(&followList);
+    error = CfgGetSymIdFollow(lalr->grammar, symId, &followList);
+    if (error != -ENOERR)
+        goto out;
+    list_for_each(pos, &followList) {
+        followSymId = container_of(pos, SymId, node);
+        if (followSymId->id >= 0 && followSymId->id <= lalr->grammar->maxSymId)
+            CplBitsetSet(follow, followSymId->id);
+    }
+out:
+    CfgSymIdListFree(&followList);
+    return error;
+}
+
+static void LrErrorRecoverFreeTable(LrErrorRecover *lrErrorRecover)
+{
+    free(lrErrorRecover->targetArr);
+    free(lrErrorRecover->followArr);
+    lrErrorRecover->targetArr = NULL;
+    lrErrorRecover->followArr = NULL;
+    lrErrorRecover->stateNum = 0;
+    lrErrorRecover->lalr = NULL;
+}
+
+/*
+ * 功能：生成错误恢复表，每个状态上的错误恢复目标和错误恢复非终结符号的FOLLOW集合位集合，
+ *      错误恢复时只需要查表，不再扫描GOTO链表和生成FOLLOW链表。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrErrorRecoverGenTable(LrErrorRecover *lrErrorRecover, Lalr *lalr)
+{
+    struct list_head *pos, *iter;
     ItemSet *itemSet;
-    int topStateId;
     GotoNode *gotoNode;
+    SymId *symId;
+    LrRecoverTarget *target;
+    unsigned int recoverNum = 0;
+    unsigned int k;
     int error = 0;
 
+    LrErrorRecoverFreeTable(lrErrorRecover);
+    list_for_each(pos, &lrErrorRecover->recoverSymIdList)
+        recoverNum++;
+    lrErrorRecover->stateNum = lalr->itemSetNum;
+    lrErrorRecover->followWords = CPL_BITSET_WORDS(lalr->grammar->maxSymId + 1);
+    lrErrorRecover->targetArr = malloc(lrErrorRecover->stateNum * sizeof (*lrErrorRecover->targetArr));
+    lrErrorRecover->followArr = calloc((size_t)(recoverNum ? recoverNum : 1) * lrErrorRecover->followWords,
+                                       sizeof (*lrErrorRecover->followArr));
+    if (!lrErrorRecover->targetArr || !lrErrorRecover->followArr) {
+        error = -ENOMEM;
+        goto err;
+    }
+
+    k = 0;
+    list_for_each(pos, &lrErrorRecover->recoverSymIdList) {
+        symId = container_of(pos, SymId, node);
+        error = LrErrorRecoverGenFollow(lalr, symId->id, &lrErrorRecover->followArr[k * lrErrorRecover->followWords]);
+        if (error != -ENOERR)
+            goto err;
+        k++;
+    }
+    for (k = 0; k < (unsigned int)lrErrorRecover->stateNum; k++) {
+        lrErrorRecover->targetArr[k].symId = -1;
+        lrErrorRecover->targetArr[k].nextState = -1;
+        lrErrorRecover->targetArr[k].follow = NULL;
+    }
+    list_for_each(pos, &lalr->itemSetList) {
+        itemSet = container_of(pos, ItemSet, node);
+        if (itemSet->id < 0 || itemSet->id >= lrErrorRecover->stateNum)
+            continue;
+        gotoNode = LrErrorRecoverGetGoto(itemSet, &lrErrorRecover->recoverSymIdList);
+        if (!gotoNode)
+            continue;
+        target = &lrErrorRecover->targetArr[itemSet->id];
+        target->symId = gotoNode->symId;
+        target->nextState = gotoNode->nextItemSetId;
+        k = 0;
+        list_for_each(iter, &lrErrorRecover->recoverSymIdList) {
+            if (container_of(iter, SymId, node)->id == gotoNode->symId)
+                break;
+            k++;
+        }
+        target->follow = &lrErrorRecover->followArr[k * lrErrorRecover->followWords];
+    }
+    lrErrorRecover->lalr = lalr;
+    return 0;
+
+err:
+    LrErrorRecoverFreeTable(lrErrorRecover);
+    return error;
+}
+
+/*
+ * 功能：弹出格局栈中的状态，直到找到一个可用于错误恢复非终结符号。
+ * stack: 格局栈
+ * 返回值：成功时返回状态上的错误恢复目标，否则返回NULL，错误码由pError返回。
+ **/
+static const LrRecoverTarget *LrErrorRecoverGetTarget(LrErrorRecover *lrErrorRecover, Lalr *lalr,
+                                                      struct list_head *stack, int *pError)
+{
+    const LrRecoverTarget *target;
+    int topStateId;
+
     while (1) {
         topStateId = ConfigurationStackTopState(stack, 0)->id;
         if (topStateId < 0) {
+            *pError = -ESYNTAX;
+            return NULL;
+        }
+        if (topStateId >= lrErrorRecover->stateNum) {
+            *pError = -ENOSTATE;
+            return NULL;
+        }
+
+        /*获取当前状态上的错误恢复目标*/
+        target = &lrErrorRecover->targetArr[topStateId];
+        if (target->symId >= 0) {
+            fprintf(ErStream(), "GOTO(%d, %s) -> %d\n", topStateId,
+                    CfgSymbolStr(CfgGetSymbol(lalr->grammar, target->symId)), target->nextState);
+            /*把错误恢复非终结符号对应的状态压入格局栈*/
+            ConfigurationStackPushState(stack, target->nextState, NULL);
+            return target;
+        }
+        fprintf(ErStream(), "Pop up state: %d\n", topStateId);
+        if (topStateId == 0) {
+            *pError = -ESYNTAX;
+            return NULL;
+        }
+        *pError = ConfigurationStackPopState(stack, 1);
+        if (*pError != -ENOERR)
+            return NULL;
+    }
+}
+
+/*
+ * 功能：恐慌模式错误恢复处理。
+ * lalr：语法分析表
+ * lrParser：语法分析器，使用其中的格局栈
+ * reader：输入
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrErrorRecoverHandle(LrErrorRecover *lrErrorRecover, Lalr *lalr,
+                      LrParser *lrParser, LrReader *reader)
+{
+    const LrRecoverTarget *target;
+    int curSymId;
+    int error = 0;
+
+    if (lrErrorRecover->lalr != lalr) {
+        error = LrErrorRecoverGenTable(lrErrorRecover, lalr);
+        if (error != -ENOERR)
+            return error;
+    }
+    /*弹出格局栈中的状态，直到找到一个可用于错误恢复非终结符号。*/
+    target = LrErrorRecoverGetTarget(lrErrorRecover, lalr, &lrParser->configurationStack, &error);
+    if (!target)
+        return error;
+
+    /*消耗输入中的符号，直到遇到FOLLOW集合中的符号。为避免死循环，至少消耗一个输入符号。*/
+    while (1) {
+        curSymId = reader->getCurrentSymId(reader);
+        if (curSymId == lalr->grammar->endSymId)
             return -ESYNTAX;
+        fprintf(ErStream(), "Drop the letter '%s'\n", CfgSymbolStr(CfgGetSymbol(lalr->grammar, curSymId)));
+        reader->inputPosInc(reader);
+        curSymId = reader->getCurrentSymId(reader);
+        if (curSymId >= 0 && curSymId <= lalr->grammar->maxSymId && CplBitsetTest(target->follow, curSymId))
+            return 0;
+    }
+}
+
+/*
+ * 功能：获取静态语法分析表中状态上的错误恢复目标。表中有生成时计算的错误恢复表时直接查表，
+ *      否则按错误恢复非终结符号链表查找GOTO。
+ * 返回值：找到时返回错误恢复非终结符号，并由pNextState返回GOTO状态，否则返回-1。
+ **/
+static int LrErrorRecoverStaticGetRecover(const LrStaticTable *table, int state, struct list_head *list,
+                                          int *pNextState)
+{
+    struct list_head *pos;
+    SymId *symId;
+    int entry;
+
+    if (table->recoverArr) {
+        *pNextState = table->recoverArr[state].nextState;
+        return table->recoverArr[state].symId;
+    }
+    list_for_each(pos, list) {
+        symId = container_of(pos, SymId, node);
+        entry = LrStaticTableEntry(table, state, symId->id);
+        if (LR_STATIC_IS_NEXT(entry)) {
+            *pNextState = LR_STATIC_NEXT_STATE(entry);
+            return symId->id;
         }
-        itemSet = LalrGetItemSet(lalr, topStateId);
-        if (!itemSet)
+    }
+    return -1;
+}
+
+/*
+ * 功能：弹出格局栈中的状态，直到找到一个在静态语法分析表中可用于错误恢复的非终结符号。
+ * table: 静态语法分析表
+ * stack: 格局栈
+ * list: 错误恢复非终结符号链表
+ * 返回值：成功时返回错误恢复非终结符号，否则返回错误码。
+ **/
+static int LrErrorRecoverStaticGetSymId(const LrStaticTable *table, struct list_head *stack, struct list_head *list)
+{
+    int topStateId;
+    int recoverSymId;
+    int nextState;
+    int error = 0;
+
+    while (1) {
+        topStateId = ConfigurationStackTopState(stack, 0)->id;
+        if (topStateId < 0 || topStateId >= table->stateNum)
             return -ENOSTATE;
 
-        /*获取当前项集中可用于错误恢复的GOTO节点*/
-        gotoNode = LrErrorRecoverGetGoto(itemSet, list);
-        if (gotoNode) {
-            printf("GOTO(%d, %s) -> %d\n", ConfigurationStackTopState(stack, 0)->id,
-                   CfgSymbolStr(CfgGetSymbol(lalr->grammar, gotoNode->symId)),
-                   gotoNode->nextItemSetId);
+        /*获取当前状态上可用于错误恢复的GOTO*/
+        recoverSymId = LrErrorRecoverStaticGetRecover(table, topStateId, list, &nextState);
+        if (recoverSymId >= 0) {
+            fprintf(ErStream(), "GOTO(%d, %s) -> %d\n", topStateId,
+                    LrStaticTableSymStr(table, recoverSymId), nextState);
             /*把错误恢复非终结符号对应的状态压入格局栈*/
-            ConfigurationStackPushState(stack, gotoNode->nextItemSetId, NULL);
-            return gotoNode->symId;
+            ConfigurationStackPushState(stack, nextState, NULL);
+            return recoverSymId;
         }
-        printf("Pop up state: %d\n", itemSet->id);
-        if (ConfigurationStackTopState(stack, 0)->id == 0)
+        fprintf(ErStream(), "Pop up state: %d\n", topStateId);
+        if (topStateId == 0)
             return -ESYNTAX;
         error = ConfigurationStackPopState(stack, 1);
         if (error != -ENOERR)
@@ -92,47 +307,40 @@ static int LrErrorRecoverGetSymId(Lalr *lalr, struct list_head *stack, struct li
 }
 
 /*
- * 功能：恐慌模式错误恢复处理。
- * grammar：文法
- * itemSet：项集
- * stack：格局栈
- * input：输入
- * pIdx：输入索引
+ * 功能：使用静态语法分析表的恐慌模式错误恢复处理，FOLLOW集合取自表中的位集合。
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int LrErrorRecoverHandle(LrErrorRecover *lrErrorRecover, Lalr *lalr,
-                      LrParser *lrParser, LrReader *reader)
+int LrErrorRecoverStaticHandle(LrErrorRecover *lrErrorRecover, const LrStaticTable *table,
+                               LrParser *lrParser, LrReader *reader)
 {
-    int recoverSymId;
+    const uint32_t *follow;
+    int recoverSymId, recoverIdx;
+    int curSymId, curIdx;
     int error = 0;
-    struct list_head followList;
-    struct list_head *stack;
 
-    stack = &lrParser->configurationStack;
-    INIT_LIST_HEAD(&followList);
+    if (!lrErrorRecover || !table || !lrParser || !reader)
+        return -EINVAL;
+
     /*弹出格局栈中的状态，直到找到一个可用于错误恢复非终结符号。*/
-    error = recoverSymId = LrErrorRecoverGetSymId(lalr, stack, &lrErrorRecover->recoverSymIdList);
+    error = recoverSymId = LrErrorRecoverStaticGetSymId(table, &lrParser->configurationStack,
+                                                        &lrErrorRecover->recoverSymIdList);
     if (error < 0)
         return error;
-    /*获取错误恢复非终结符号的FOLLOW集合*/
-    error = CfgGetSymIdFollow(lalr->grammar, recoverSymId, &followList);
-    if (error != -ENOERR) {
-        CfgSymIdListFree(&followList);
-        return error;
-    }
+    recoverIdx = LrStaticTableSymIdx(table, recoverSymId);
+    if (recoverIdx < 0)
+        return -ENOSYM;
+    follow = &table->followArr[recoverIdx * table->followWords];
 
     /*消耗输入中的符号，直到遇到FOLLOW集合中的符号。为避免死循环，至少消耗一个输入符号。*/
     while (1) {
-        if (reader->getCurrentSymId(reader) == lalr->grammar->endSymId) {
-            CfgSymIdListFree(&followList);
+        curSymId = reader->getCurrentSymId(reader);
+        if (curSymId == table->endSymId)
             return -ESYNTAX;
-        }
-        printf("Drop the letter '%s'\n", CfgSymbolStr(CfgGetSymbol(lalr->grammar, reader->getCurrentSymId(reader))));
+        fprintf(ErStream(), "Drop the letter '%s'\n", LrStaticTableSymStr(table, curSymId));
         reader->inputPosInc(reader);
-        if (CfgSymIdSetIsContain(&followList, reader->getCurrentSymId(reader)) == 1) {
-            CfgSymIdListFree(&followList);
+        curIdx = LrStaticTableSymIdx(table, reader->getCurrentSymId(reader));
+        if (curIdx >= 0 && CplBitsetTest(follow, curIdx))
             return 0;
-        }
     }
 }
 
@@ -140,13 +348,15 @@ void LrErrorReocverFree(LrErrorRecover *lrErrorRecover)
 {
     if (lrErrorRecover) {
         CfgSymIdListFree(&lrErrorRecover->recoverSymIdList);
+        LrErrorRecoverFreeTable(lrErrorRecover);
+        free(lrErrorRecover);
     }
 }
 
 /*
  * 功能：
  * pLrErroeRecover:
- * recoverSymIdArr: 用于错误恢复的非终结符号id数组，元素通常是比较常用的非终结符号。
+ * recoverSymIdArr: 用于错误恢复的非终结符号id数组，元素通常是比较常用的非终结符号，按优先顺序排列。
  * len: 数组长度。
  * 返回值：
  */
@@ -165,6 +375,11 @@ int LrErrorRecoverAlloc(LrErrorRecover **pLrErroeRecover, int recoverSymIdArr[],
     *pLrErroeRecover = lrErrorRecover;
 
     INIT_LIST_HEAD(&lrErrorRecover->recoverSymIdList);
+    lrErrorRecover->lalr = NULL;
+    lrErrorRecover->targetArr = NULL;
+    lrErrorRecover->stateNum = 0;
+    lrErrorRecover->followArr = NULL;
+    lrErrorRecover->followWords = 0;
     error = CfgSymIdSetAddArr(&lrErrorRecover->recoverSymIdList, recoverSymIdArr, len);
     if (error != -ENOERR) {
         CfgSymIdListFree(&lrErrorRecover->recoverSymIdList);
@@ -5,6 +5,7 @@
 extern "C" {
 #endif
 
+#include "stdint.h"
 #include "list.h"
 
 typedef struct _LrErrorRecover LrErrorRecover;
@@ -12,18 +13,34 @@ typedef struct _Lalr Lalr;
 typedef struct _LrReader LrReader;
 typedef struct _LrParser LrParser;
 typedef struct _LrErrorRecover LrErrorRecover;
+typedef struct _LrStaticTable LrStaticTable;
 
 typedef int (RecoverHandle)(LrErrorRecover *, Lalr *,
                                 LrParser *, LrReader *);
 
+/*状态上的错误恢复目标*/
+typedef struct {
+    int symId;                  /*状态上可用于错误恢复的非终结符号，没有时为-1*/
+    int nextState;              /*GOTO(state, symId)*/
+    const uint32_t *follow;     /*symId的FOLLOW集合位集合*/
+} LrRecoverTarget;
+
 typedef struct _LrErrorRecover {
     struct list_head recoverSymIdList;
     RecoverHandle *recoverHandle;
     void (*resourceFree)(struct _LrErrorRecover *);
+    /*第一次错误恢复时按语法分析表生成的错误恢复表，语法分析表变化时重新生成*/
+    const Lalr *lalr;
+    LrRecoverTarget *targetArr;     /*[stateNum]*/
+    int stateNum;
+    uint32_t *followArr;            /*[错误恢复非终结符号数][followWords]*/
+    unsigned int followWords;
 } LrErrorRecover;
 
 int LrErrorRecoverAlloc(LrErrorRecover **pLrErroeRecover, int recoverSymIdArr[], unsigned int len);
 void LrErrorReocverFree(LrErrorRecover *lrErrorRecover);
+int LrErrorRecoverStaticHandle(LrErrorRecover *lrErrorRecover, const LrStaticTable *table,
+                               LrParser *lrParser, LrReader *reader);
 
 #ifdef __cplusplus
 }
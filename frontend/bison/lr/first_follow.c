@@ -2,6 +2,7 @@
 
 #include "cpl_errno.h"
 #include "cpl_debug.h"
+#include "cpl_bitset.h"
 #include "list.h"
 #include "stdlib.h"
 #include "stdio.h"
@@ -15,441 +16,508 @@
 #endif
 
 
-static int CfgSymbolGenFirst(ContextFreeGrammar *grammar, Symbol *symbol);
-
 /*
- * 功能：获取文法符号的FIRST集合，如果非终结符号FIRST集合为空会尝试生成FIRST集合。
- * grammar: 文法
- * symbol: 文法符号
- * firstSymbolList：输出型参数，FIRST集合
- * 返回值：成功时返回0，否则返回错误码。
+ * FIRST和FOLLOW集合都可以表示成有向图上的集合传播问题：
+ *      FIRST(A) = F'(A) ∪ {FIRST(B) | A -> αBβ，α可以推导出空符号}
+ *      FOLLOW(B) = F'(B) ∪ {FOLLOW(A) | A -> αBβ，β可以推导出空符号}
+ * 其中F'是直接得到的终结符号集合。在图上做一次强连通分量遍历（digraph算法），同一个分量中的
+ * 符号集合相同，每条边只处理一次。终结符号集合用位集合表示，位下标是终结符号的紧凑编号。
  **/
-static int CfgGetSymbolFirstSet(ContextFreeGrammar *grammar, Symbol *symbol, struct list_head *firstSymbolList)
-{
-    int error = 0;
-
-    if (symbol->id == grammar->emptySymId) {
-        return CfgSymIdSetAddId(firstSymbolList, grammar->emptySymId);
-    }
 
-    /*终结符号和空符号的FIRST集合是符合本身。*/
-    if (symbol->type == SYMBOL_TYPE_TERMINAL
-            || symbol->type == SYMBOL_TYPE_EMPTY) {
-        return CfgSymIdSetAddId(firstSymbolList, symbol->id);
-    } else if (symbol->type == SYMBOL_TYPE_NONTERMINAL) {
-        /*如果非终结符的FIRST集合为空则生成非终结符的FIRST集合。*/
-        if (list_empty(firstSymbolList)) {
-            error = CfgSymbolGenFirst(grammar, symbol);
-            if (error != -ENOERR)
-                return error;
-        }
-        return CfgSymIdSetAddList(firstSymbolList, &symbol->firstSymIdList);
-    } else {
-        PrErr("ESYMTYPE");
-        return -ESYMTYPE;
-    }
+#define CFG_DEPTH_INFINITY      0x7fffffff
+
+/*有向图，邻接表采用压缩行存储*/
+typedef struct {
+    int *fromArr;   /*添加边时的起点数组*/
+    int *toArr;     /*添加边时的终点数组*/
+    int edgeNum;
+    int edgeCap;
+    int *base;      /*节点v的邻接节点是adj[base[v]]到adj[base[v + 1] - 1]*/
+    int *adj;
+} CfgGraph;
+
+/*FIRST、FOLLOW集合生成上下文*/
+typedef struct {
+    ContextFreeGrammar *grammar;
+    int symNum;             /*符号id的范围[0, symNum)*/
+    Symbol **symbolArr;     /*按符号id索引的文法符号*/
+    int *termIndex;         /*终结符号id到紧凑编号的映射，不是终结符号时为-1*/
+    int *termArr;           /*紧凑编号到终结符号id的映射，按符号id升序*/
+    int termNum;
+    unsigned int words;     /*终结符号位集合的字数*/
+    char *nullable;         /*符号能否推导出空符号*/
+    uint32_t *firstSet;     /*按符号id索引，每个符号words个字，不含空符号*/
+    uint32_t *followSet;    /*按符号id索引，每个符号words个字*/
+    int *depthArr;          /*digraph遍历的深度标记*/
+    int *stack;             /*digraph遍历栈*/
+    int top;
+} CfgFfContext;
+
+static void CfgGraphFree(CfgGraph *graph)
+{
+    free(graph->fromArr);
+    free(graph->toArr);
+    free(graph->base);
+    free(graph->adj);
+    memset(graph, 0, sizeof (*graph));
 }
 
 /*
- * 功能：生成产生式体的FIRST集合
- * grammar: 文法
- * productBody：产生式体指针。
+ * 功能：添加一条边from -> to。
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int CfgProductBodyGenFirst(ContextFreeGrammar *grammar, ProductBody *productBody)
+static int CfgGraphAddEdge(CfgGraph *graph, int from, int to)
 {
-    struct list_head *pos;
-    SymId *symId;
-    Symbol *symbol;
-    char emptyIdFlag = 1;
-    int error = 0;
-
-    if (list_empty(&productBody->symIdList)) {
-        PrErr("ENONBODY");
-        return -ENONBODY;
+    if (graph->edgeNum == graph->edgeCap) {
+        int cap = graph->edgeCap ? graph->edgeCap * 2 : 64;
+        int *fromArr, *toArr;
+
+        fromArr = realloc(graph->fromArr, cap * sizeof (*fromArr));
+        if (!fromArr)
+            return -ENOMEM;
+        graph->fromArr = fromArr;
+        toArr = realloc(graph->toArr, cap * sizeof (*toArr));
+        if (!toArr)
+            return -ENOMEM;
+        graph->toArr = toArr;
+        graph->edgeCap = cap;
     }
-
-    /*从产生式体第一个符号开始遍历，计算产生式体的FIRST集合*/
-    list_for_each(pos, &productBody->symIdList) {
-        struct list_head firstSymIdList;
-
-        /*获取产生式体中被遍历的符号的FIRST集合。*/
-        INIT_LIST_HEAD(&firstSymIdList);
-        symId = container_of(pos, SymId, node);
-        symbol = CfgGetSymbol(grammar, symId->id);
-        if (!symbol) {
-            PrErr("ENOSYM");
-            return -ENOSYM;
-        }
-
-        error = CfgGetSymbolFirstSet(grammar, symbol, &firstSymIdList);
-        if (error != -ENOERR)
-            return error;
-        /*把被遍历产生式体符号的FIRST集合中的非空符号拷贝到产生式体的FIRST集合中。*/
-        error = CfgSymIdSetAddListExcludeId(&productBody->firstSymIdList, &firstSymIdList, grammar->emptySymId);
-        if (error != -ENOERR)
-            return error;
-        /*如果被遍历产生式体符号的FIRST集合中不包含空符号则跳出循环。*/
-        if (!list_empty(&firstSymIdList)
-                && (0 == CfgSymIdSetIsContain(&firstSymIdList, grammar->emptySymId))) {
-            emptyIdFlag = 0;
-            CfgSymIdListFree(&firstSymIdList);
-            break;
-        }
-        CfgSymIdListFree(&firstSymIdList);
-    }
-
-    /*如果产生式体的各个非终结符号的FIRST集合中都包含空符号，则把空符号添加到产生式体的FIRST集合中。*/
-    if (emptyIdFlag == 1) {
-        error = CfgSymIdSetAddId(&productBody->firstSymIdList, grammar->emptySymId);
-        if (error != -ENOERR)
-            return error;
-    }
-
-    return error;
+    graph->fromArr[graph->edgeNum] = from;
+    graph->toArr[graph->edgeNum] = to;
+    graph->edgeNum++;
+    return 0;
 }
 
 /*
- * 功能：生成文法符号的FIRST集合
- * grammar: 文法
- * symbol: 文法符号
+ * 功能：把添加的边整理成压缩行存储的邻接表，同一起点的边保持添加顺序。
+ * nodeNum：节点个数
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int CfgSymbolGenFirst(ContextFreeGrammar *grammar, Symbol *symbol)
+static int CfgGraphBuild(CfgGraph *graph, int nodeNum)
 {
-    struct list_head *pos;
-    ProductBody *productBody;
-    int error = 0;
-
-    /*为了避免同一个符号多次调用生成函数，先进行判断*/
-    if (1 == CfgSymIdSetIsContain(&grammar->genFirstSymIdList, symbol->id)) {
-        return 0;
+    int *fill;
+    int e, v;
+
+    graph->base = calloc(nodeNum + 1, sizeof (*graph->base));
+    graph->adj = malloc((graph->edgeNum ? graph->edgeNum : 1) * sizeof (*graph->adj));
+    fill = malloc((nodeNum + 1) * sizeof (*fill));
+    if (!graph->base || !graph->adj || !fill) {
+        free(fill);
+        return -ENOMEM;
     }
-    error = CfgSymIdListAddId(&grammar->genFirstSymIdList, symbol->id);
-    if (error != -ENOERR)
-        return error;
-
-    /*遍历各个产生式体，生成各产生式体的FIRST集合，并添加到当前符号的FIRST集合中。*/
-    list_for_each(pos, &symbol->bodyList) {
-        productBody = container_of(pos, ProductBody, node);
-        error = CfgProductBodyGenFirst(grammar, productBody);
-        if (error != -ENOERR)
-            return error;
-        error = CfgSymIdSetAddList(&symbol->firstSymIdList, &productBody->firstSymIdList);
-        if (error != -ENOERR)
-            return error;
-    }
-
-    if (0 == CfgSymIdListDelId(&grammar->genFirstSymIdList, symbol->id)) {
-        PrErr("delete id error");
-        return -EMISC;
-    }
-
-    return error;
+    for (e = 0; e < graph->edgeNum; e++)
+        graph->base[graph->fromArr[e] + 1]++;
+    for (v = 0; v < nodeNum; v++)
+        graph->base[v + 1] += graph->base[v];
+    memcpy(fill, graph->base, (nodeNum + 1) * sizeof (*fill));
+    for (e = 0; e < graph->edgeNum; e++)
+        graph->adj[fill[graph->fromArr[e]]++] = graph->toArr[e];
+    free(fill);
+    return 0;
 }
 
 /*
- * 功能：生成文法的FIRST集合
- * grammar: 文法
- * 返回值：成功时返回0，否则返回错误码。
+ * 功能：digraph遍历，F(x) = F'(x) ∪ {F(y) | x -> y}，同一强连通分量中的符号得到相同的集合。
+ * setArr：输入时为F'，输出时为F。
+ * 返回值：无
  **/
-static int CfgGenerateFirst(ContextFreeGrammar *grammar)
+static void CfgTraverse(CfgFfContext *ctx, const CfgGraph *graph, int x, uint32_t *setArr)
 {
-    struct list_head *pos;
-    Symbol *symbol;
-    int error = 0;
-
-    if (!grammar)
-        return -EINVAL;
-
-    /*遍历文法中的各个非终结符号，并生成FIRST集合*/
-    list_for_each(pos, &grammar->symbolList) {
-        symbol = container_of(pos, Symbol, node);
-        if (symbol->type == SYMBOL_TYPE_NONTERMINAL
-                && list_empty(&symbol->firstSymIdList)) {
-            error = CfgSymbolGenFirst(grammar, symbol);
-            if (error != -ENOERR)
-                return error;
-        }
+    int depth;
+    int e, y;
+
+    ctx->stack[ctx->top++] = x;
+    depth = ctx->top;
+    ctx->depthArr[x] = depth;
+
+    for (e = graph->base[x]; e < graph->base[x + 1]; e++) {
+        y = graph->adj[e];
+        if (ctx->depthArr[y] == 0)
+            CfgTraverse(ctx, graph, y, setArr);
+        if (ctx->depthArr[y] < ctx->depthArr[x])
+            ctx->depthArr[x] = ctx->depthArr[y];
+        CplBitsetOr(&setArr[x * ctx->words], &setArr[y * ctx->words], ctx->words);
     }
 
-    return 0;
-}
-
-static int CfgSymIdGenFollowByBetaList(ContextFreeGrammar *grammar, int symId, struct list_head *betaList)
-{
-    Symbol *symbol;
-    struct list_head nextSymFirstSet;
-    int error;
-
-    /*获取相邻下一个符号的FIRST集合。*/
-    INIT_LIST_HEAD(&nextSymFirstSet);
-    symbol = CfgGetSymbol(grammar, symId);
-    if (!symbol) {
-        PrErr("ENOSYM");
-        return -ENOSYM;
+    /*x是强连通分量的根，分量中的符号共享x的集合。*/
+    if (ctx->depthArr[x] == depth) {
+        do {
+            y = ctx->stack[--ctx->top];
+            ctx->depthArr[y] = CFG_DEPTH_INFINITY;
+            if (y != x)
+                CplBitsetCopy(&setArr[y * ctx->words], &setArr[x * ctx->words], ctx->words);
+        } while (y != x);
     }
-    error = CfgGetSymIdListFirst(grammar, betaList, &nextSymFirstSet);
-    if (error != -ENOERR)
-        return error;
-
-    /*把相邻下一个符号的FIRST集合添加到当前符号的FOLLOW集合中。*/
-    error = CfgSymIdSetAddListExcludeId(&symbol->followSymIdList, &nextSymFirstSet, grammar->emptySymId);
-    CfgSymIdListFree(&nextSymFirstSet);
-    return error;
 }
 
-/*
- * 功能：生成产生式体中各个符号的FOLLOW集合。
- * grammar: 文法
- * productBody：产生式体。
- * 返回值：成功时返回0，否则返回错误码。
- **/
-static int CfgProductBodyGenFollowByProduct(ContextFreeGrammar *grammar, ProductBody *productBody)
+static void CfgDigraph(CfgFfContext *ctx, const CfgGraph *graph, uint32_t *setArr)
 {
-    struct list_head *pos;
-    struct list_head betaList;  /*待处理符号后面的文法符号串。*/
-    SymId *symId;
-    int error = 0;
+    int v;
 
-    INIT_LIST_HEAD(&betaList);
-    /*遍历产生式体中除尾符号外的各个符号，并生成各自的FOLLOW集合。*/
-    list_for_each(pos, &productBody->symIdList) {
-        if (list_get_tail(&productBody->symIdList) == pos) {
-            break;
-        }
-        symId = container_of(pos, SymId, node);
-        error = CfgSymIdListCopyFromPos(&betaList, &productBody->symIdList, pos->next);
-        if (error != -ENOERR)
-            return error;
-        error = CfgSymIdGenFollowByBetaList(grammar, symId->id, &betaList);
-        CfgSymIdListFree(&betaList);
-        if (error != -ENOERR)
-            return error;
+    memset(ctx->depthArr, 0, ctx->symNum * sizeof (*ctx->depthArr));
+    ctx->top = 0;
+    for (v = 0; v < ctx->symNum; v++) {
+        if (ctx->depthArr[v] == 0)
+            CfgTraverse(ctx, graph, v, setArr);
     }
-
-    return 0;
 }
 
-/*
- * 功能：根据符号的产生式体生成符号的FOLLOW集合
- * grammar: 文法
- * symbol: 文法符号
- * 返回值：成功时返回0，否则返回错误码。
- **/
-static int CfgSymbolGenFollowByProduct(ContextFreeGrammar *grammar, Symbol *symbol)
+static void CfgFfContextFree(CfgFfContext *ctx)
 {
-    struct list_head *pos;
-    ProductBody *productBody;
-    int error = 0;
-
-    /*遍历文法符号的各个产生式体，生成相关符号的FOLLOW集合。*/
-    list_for_each(pos, &symbol->bodyList) {
-        productBody = container_of(pos, ProductBody, node);
-        error = CfgProductBodyGenFollowByProduct(grammar, productBody);
-        if (error != -ENOERR)
-            return error;
-    }
-
-    return 0;
+    free(ctx->symbolArr);
+    free(ctx->termIndex);
+    free(ctx->termArr);
+    free(ctx->nullable);
+    free(ctx->firstSet);
+    free(ctx->followSet);
+    free(ctx->depthArr);
+    free(ctx->stack);
 }
 
 /*
- * 功能：根据产生式体生成文法的FOLLOW集合。
- * grammar: 文法。
+ * 功能：建立文法符号的索引数组和终结符号的紧凑编号。
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int CfgGenFollowByProduct(ContextFreeGrammar *grammar)
+static int CfgFfContextInit(CfgFfContext *ctx, ContextFreeGrammar *grammar)
 {
     struct list_head *pos;
     Symbol *symbol;
-    int error = 0;
+    int id;
+
+    memset(ctx, 0, sizeof (*ctx));
+    ctx->grammar = grammar;
+    ctx->symNum = grammar->maxSymId + 1;
+    ctx->symbolArr = calloc(ctx->symNum, sizeof (*ctx->symbolArr));
+    ctx->termIndex = malloc(ctx->symNum * sizeof (*ctx->termIndex));
+    ctx->termArr = malloc(ctx->symNum * sizeof (*ctx->termArr));
+    ctx->nullable = calloc(ctx->symNum, sizeof (*ctx->nullable));
+    ctx->depthArr = calloc(ctx->symNum, sizeof (*ctx->depthArr));
+    ctx->stack = calloc(ctx->symNum, sizeof (*ctx->stack));
+    if (!ctx->symbolArr || !ctx->termIndex || !ctx->termArr
+            || !ctx->nullable || !ctx->depthArr || !ctx->stack)
+        return -ENOMEM;
 
     list_for_each(pos, &grammar->symbolList) {
         symbol = container_of(pos, Symbol, node);
-        error = CfgSymbolGenFollowByProduct(grammar, symbol);
-        if (error != -ENOERR)
-            return error;
-    }
-
-    return 0;
-}
-
-/*
- * 功能：根据产生式体生成非终结符号的尾非终结符号id链表。
- * grammar: 文法
- * symbol: 文法符号
- * productBody: 产生式体。
- * 返回值：成功时返回0，否则返回错误码。
- **/
-static int CfgProductBodyGenTailSymIdList(ContextFreeGrammar *grammar, Symbol *symbol,
-                                   ProductBody *productBody)
-{
-    struct list_head *pos;
-    SymId *symId;
-    Symbol *iterSymbol;
-    int error = 0;
-
-    /*从产生式体的尾符号开始遍历。*/
-    list_for_each_prev(pos, &productBody->symIdList) {
-        symId = container_of(pos, SymId, node);
-        iterSymbol = CfgGetSymbol(grammar, symId->id);
-        if (!iterSymbol) {
-            PrErr("ENOSYM");
+        if (symbol->id < 0 || symbol->id >= ctx->symNum) {
+            PrErr("ENOSYM: %d", symbol->id);
             return -ENOSYM;
         }
-        if (iterSymbol->type == SYMBOL_TYPE_NONTERMINAL) {
-            error = CfgSymIdSetAddId(&symbol->tailSymIdList, symId->id);
-            if (error != -ENOERR)
-                return error;
-            /*如果当前非终结符号不能推导出空符号，则跳出循环。*/
-            if (0 == CfgSymIdSetIsContain(&iterSymbol->firstSymIdList, grammar->emptySymId)) {
-                break;
-            }
-        } else {
-            if (iterSymbol->id != grammar->emptySymId)
-                break;
+        ctx->symbolArr[symbol->id] = symbol;
+    }
+    for (id = 0; id < ctx->symNum; id++) {
+        ctx->termIndex[id] = -1;
+        if (ctx->symbolArr[id] && ctx->symbolArr[id]->type == SYMBOL_TYPE_TERMINAL) {
+            ctx->termIndex[id] = ctx->termNum;
+            ctx->termArr[ctx->termNum++] = id;
         }
     }
-
+    ctx->nullable[grammar->emptySymId] = 1;
+
+    ctx->words = CPL_BITSET_WORDS(ctx->termNum ? ctx->termNum : 1);
+    ctx->firstSet = calloc(ctx->symNum, ctx->words * sizeof (uint32_t));
+    ctx->followSet = calloc(ctx->symNum, ctx->words * sizeof (uint32_t));
+    if (!ctx->firstSet || !ctx->followSet)
+        return -ENOMEM;
+    for (id = 0; id < ctx->termNum; id++)
+        CplBitsetSet(&ctx->firstSet[ctx->termArr[id] * ctx->words], id);
     return 0;
 }
 
 /*
- * 功能：生成符号的产生式尾符号链表
- * grammar: 文法
- * symbol: 文法符号
- * 返回值：成功时返回0，否则返回错误码。
+ * 功能：获取产生式体中的符号，检查符号是否存在。
+ * 返回值：成功时返回文法符号，否则返回NULL。
  **/
-static int CfgSymbolGenTailSymIdList(ContextFreeGrammar *grammar, Symbol *symbol)
+static inline Symbol *CfgFfGetSymbol(const CfgFfContext *ctx, int symId)
 {
-    struct list_head *pos;
-    ProductBody *productBody;
-    int error = 0;
-
-    list_for_each(pos, &symbol->bodyList) {
-        productBody = container_of(pos, ProductBody, node);
-        error = CfgProductBodyGenTailSymIdList(grammar, symbol, productBody);
-        if (error != -ENOERR)
-            return error;
-    }
-
-    return 0;
+    if (symId < 0 || symId >= ctx->symNum)
+        return NULL;
+    return ctx->symbolArr[symId];
 }
 
 /*
- * 功能：生成文法中各个非终结符号的尾符号链表。
- * grammar: 文法。
+ * 功能：计算能推导出空符号的非终结符号。每个产生式体记录还不能推导出空符号的符号个数，
+ *      符号变为可空时减少包含它的产生式体的计数，计数为0时产生式头可空，每次出现只处理一次。
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int CfgGenTailSymIdList(ContextFreeGrammar *grammar)
+static int CfgFfGenNullable(CfgFfContext *ctx)
 {
-    struct list_head *pos;
+    struct list_head *pos, *bodyPos, *symPos;
     Symbol *symbol;
+    ProductBody *productBody;
+    SymId *symId;
+    CfgGraph occur;         /*符号 -> 包含它的产生式体编号*/
+    int *headArr = NULL;    /*产生式体编号 -> 产生式头符号id*/
+    int *remainArr = NULL;  /*产生式体中还不能推导出空符号的符号个数*/
+    int *worklist = NULL;
+    int bodyCnt = 0, bodyCap = 0;
+    int head = 0, tail = 0;
+    int e, b;
     int error = 0;
 
-    list_for_each(pos, &grammar->symbolList) {
+    memset(&occur, 0, sizeof (occur));
+    worklist = malloc(ctx->symNum * sizeof (*worklist));
+    if (!worklist) {
+        error = -ENOMEM;
+        goto out;
+    }
+
+    list_for_each(pos, &ctx->grammar->symbolList) {
         symbol = container_of(pos, Symbol, node);
-        error = CfgSymbolGenTailSymIdList(grammar, symbol);
-        if (error != -ENOERR)
-            return error;
+        list_for_each(bodyPos, &symbol->bodyList) {
+            int remain = 0;
+
+            productBody = container_of(bodyPos, ProductBody, node);
+            if (list_empty(&productBody->symIdList)) {
+                PrErr("ENONBODY");
+                error = -ENONBODY;
+                goto out;
+            }
+            if (bodyCnt == bodyCap) {
+                int cap = bodyCap ? bodyCap * 2 : 64;
+                int *arr;
+
+                arr = realloc(headArr, cap * sizeof (*headArr));
+                if (!arr) {
+                    error = -ENOMEM;
+                    goto out;
+                }
+                headArr = arr;
+                arr = realloc(remainArr, cap * sizeof (*remainArr));
+                if (!arr) {
+                    error = -ENOMEM;
+                    goto out;
+                }
+                remainArr = arr;
+                bodyCap = cap;
+            }
+            list_for_each(symPos, &productBody->symIdList) {
+                symId = container_of(symPos, SymId, node);
+                if (!CfgFfGetSymbol(ctx, symId->id)) {
+                    PrErr("ENOSYM: %d", symId->id);
+                    error = -ENOSYM;
+                    goto out;
+                }
+                if (symId->id == ctx->grammar->emptySymId)
+                    continue;
+                remain++;
+                error = CfgGraphAddEdge(&occur, symId->id, bodyCnt);
+                if (error != -ENOERR)
+                    goto out;
+            }
+            headArr[bodyCnt] = symbol->id;
+            remainArr[bodyCnt] = remain;
+            if (remain == 0 && !ctx->nullable[symbol->id]) {
+                ctx->nullable[symbol->id] = 1;
+                worklist[tail++] = symbol->id;
+            }
+            bodyCnt++;
+        }
     }
+    error = CfgGraphBuild(&occur, ctx->symNum);
+    if (error != -ENOERR)
+        goto out;
 
-    return 0;
+    while (head < tail) {
+        int id = worklist[head++];
+
+        for (e = occur.base[id]; e < occur.base[id + 1]; e++) {
+            b = occur.adj[e];
+            if (--remainArr[b] == 0 && !ctx->nullable[headArr[b]]) {
+                ctx->nullable[headArr[b]] = 1;
+                worklist[tail++] = headArr[b];
+            }
+        }
+    }
+out:
+    CfgGraphFree(&occur);
+    free(headArr);
+    free(remainArr);
+    free(worklist);
+    return error;
 }
 
 /*
- * 功能：把符号FOLLOW集合中的符号添加到尾符号链表中各符号的FOLLOW集合中去。
- * grammar: 文法
- * symbol: 文法符号。
+ * 功能：把位集合转换成符号id链表，按符号id升序排列。
+ * list：输出型参数，原有内容会被释放。
+ * emptyFlag：为1时在链表末尾添加空符号。
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int CfgSymbolGenTailSymFollow(ContextFreeGrammar *grammar, Symbol *symbol)
+static int CfgFfSetToList(const CfgFfContext *ctx, const uint32_t *set, char emptyFlag, struct list_head *list)
 {
-    char updateFlag = 0;
-    struct list_head *pos;
-    SymId *symId;
-    Symbol *iterSymbol;
+    int t;
     int error = 0;
 
-    list_for_each(pos, &symbol->tailSymIdList) {
-        symId = container_of(pos, SymId, node);
-        iterSymbol = CfgGetSymbol(grammar, symId->id);
-        if (!iterSymbol) {
-            PrErr("ENOSYM");
-            return -ENOSYM;
-        }
-        error = CfgSymIdSetAddListUpdateFlag(&iterSymbol->followSymIdList, &symbol->followSymIdList, grammar->emptySymId,
-                                     &updateFlag);
-        if (error != -ENOERR)
-            return error;
-        if (updateFlag == 1) {
-            error = CfgSymbolGenTailSymFollow(grammar, iterSymbol);
+    CfgSymIdListFree(list);
+    for (t = 0; t < ctx->termNum; t++) {
+        if (CplBitsetTest(set, t)) {
+            error = CfgSymIdListTailAddId(list, ctx->termArr[t]);
             if (error != -ENOERR)
                 return error;
         }
     }
-
-    return 0;
+    if (emptyFlag == 1)
+        error = CfgSymIdListTailAddId(list, ctx->grammar->emptySymId);
+    return error;
 }
 
 /*
- * 功能：根据非终结符的FOLLOW集合生成它的产生式体末尾非终结符的FOLLOW集合
- * grammar: 文法
+ * 功能：生成文法的FIRST集合，包括各产生式体的FIRST集合。
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int CfgGenTailSymFollow(ContextFreeGrammar *grammar)
+static int CfgGenerateFirst(CfgFfContext *ctx)
 {
-    struct list_head *pos;
+    struct list_head *pos, *bodyPos, *symPos;
     Symbol *symbol;
+    ProductBody *productBody;
+    SymId *symId;
+    CfgGraph graph;
+    uint32_t *bodySet;
     int error = 0;
 
-    /*生成文法中各非终结符的产生式体的末尾非终结符链表。*/
-    error = CfgGenTailSymIdList(grammar);
+    memset(&graph, 0, sizeof (graph));
+    bodySet = malloc(ctx->words * sizeof (*bodySet));
+    if (!bodySet)
+        return -ENOMEM;
+
+    /*A -> αXβ，α可以推导出空符号：X是终结符号时加入F'(A)，X是非终结符号时添加边A -> X。*/
+    list_for_each(pos, &ctx->grammar->symbolList) {
+        symbol = container_of(pos, Symbol, node);
+        list_for_each(bodyPos, &symbol->bodyList) {
+            productBody = container_of(bodyPos, ProductBody, node);
+            list_for_each(symPos, &productBody->symIdList) {
+                symId = container_of(symPos, SymId, node);
+                if (symId->id == ctx->grammar->emptySymId)
+                    continue;
+                if (ctx->termIndex[symId->id] >= 0) {
+                    CplBitsetSet(&ctx->firstSet[symbol->id * ctx->words], ctx->termIndex[symId->id]);
+                    break;
+                }
+                error = CfgGraphAddEdge(&graph, symbol->id, symId->id);
+                if (error != -ENOERR)
+                    goto out;
+                if (!ctx->nullable[symId->id])
+                    break;
+            }
+        }
+    }
+    error = CfgGraphBuild(&graph, ctx->symNum);
     if (error != -ENOERR)
-        return error;
+        goto out;
+    CfgDigraph(ctx, &graph, ctx->firstSet);
 
-    /*根据非终结符的FOLLOW集合生成它的产生式体末尾非终结符的FOLLOW集合*/
-    list_for_each(pos, &grammar->symbolList) {
+    /*写回非终结符号和产生式体的FIRST集合。*/
+    list_for_each(pos, &ctx->grammar->symbolList) {
         symbol = container_of(pos, Symbol, node);
-        if (symbol->type == SYMBOL_TYPE_NONTERMINAL) {
-            error = CfgSymbolGenTailSymFollow(grammar, symbol);
+        if (symbol->type != SYMBOL_TYPE_NONTERMINAL)
+            continue;
+        error = CfgFfSetToList(ctx, &ctx->firstSet[symbol->id * ctx->words],
+                               ctx->nullable[symbol->id], &symbol->firstSymIdList);
+        if (error != -ENOERR)
+            goto out;
+        list_for_each(bodyPos, &symbol->bodyList) {
+            char emptyFlag = 1;
+
+            productBody = container_of(bodyPos, ProductBody, node);
+            CplBitsetZero(bodySet, ctx->words);
+            list_for_each(symPos, &productBody->symIdList) {
+                symId = container_of(symPos, SymId, node);
+                if (symId->id == ctx->grammar->emptySymId)
+                    continue;
+                CplBitsetOr(bodySet, &ctx->firstSet[symId->id * ctx->words], ctx->words);
+                if (!ctx->nullable[symId->id]) {
+                    emptyFlag = 0;
+                    break;
+                }
+            }
+            error = CfgFfSetToList(ctx, bodySet, emptyFlag, &productBody->firstSymIdList);
             if (error != -ENOERR)
-                return error;
+                goto out;
         }
     }
-
-    return 0;
+out:
+    CfgGraphFree(&graph);
+    free(bodySet);
+    return error;
 }
 
 /*
- * 功能：生成文法的FOLLOW集合
- * grammar: 文法
+ * 功能：生成文法的FOLLOW集合，同时生成各非终结符号的尾符号链表。
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int CfgGenerateFollow(ContextFreeGrammar *grammar)
+static int CfgGenerateFollow(CfgFfContext *ctx)
 {
-    Symbol *startSymbol;
+    struct list_head *pos, *bodyPos, *symPos;
+    Symbol *symbol;
+    ProductBody *productBody;
+    SymId *symId;
+    CfgGraph graph;
+    uint32_t *trailer;  /*产生式体中当前符号后面部分的FIRST集合*/
+    char nullableFlag;  /*产生式体中当前符号后面部分能否推导出空符号*/
     int error = 0;
 
+    memset(&graph, 0, sizeof (graph));
+    trailer = malloc(ctx->words * sizeof (*trailer));
+    if (!trailer)
+        return -ENOMEM;
+
     /*把结束符$添加到开始符号的FOLLOW集合*/
-    startSymbol = CfgGetSymbol(grammar, grammar->startSymId);
-    if (!startSymbol) {
+    if (!CfgFfGetSymbol(ctx, ctx->grammar->startSymId) || ctx->termIndex[ctx->grammar->endSymId] < 0) {
         PrErr("ENOSYM");
-        return -ENOSYM;
+        error = -ENOSYM;
+        goto out;
     }
-    error = CfgSymIdSetAddId(&startSymbol->followSymIdList, grammar->endSymId);
-    if (error != -ENOERR)
-        return error;
-    /*根据产生式体生成FOLLOW集合*/
-    error = CfgGenFollowByProduct(grammar);
-    if (error != -ENOERR)
-        return error;
-    /*产生式体的末尾非终结符继承产生式头的FOLLOW集合*/
-    error = CfgGenTailSymFollow(grammar);
+    CplBitsetSet(&ctx->followSet[ctx->grammar->startSymId * ctx->words],
+                 ctx->termIndex[ctx->grammar->endSymId]);
+
+    /*A -> αBβ：FIRST(β)加入F'(B)，β可以推导出空符号时添加边B -> A。*/
+    list_for_each(pos, &ctx->grammar->symbolList) {
+        symbol = container_of(pos, Symbol, node);
+        CfgSymIdListFree(&symbol->tailSymIdList);
+        list_for_each(bodyPos, &symbol->bodyList) {
+            productBody = container_of(bodyPos, ProductBody, node);
+            CplBitsetZero(trailer, ctx->words);
+            nullableFlag = 1;
+            list_for_each_prev(symPos, &productBody->symIdList) {
+                symId = container_of(symPos, SymId, node);
+                if (symId->id == ctx->grammar->emptySymId)
+                    continue;
+                if (ctx->symbolArr[symId->id]->type == SYMBOL_TYPE_NONTERMINAL) {
+                    CplBitsetOr(&ctx->followSet[symId->id * ctx->words], trailer, ctx->words);
+                    if (nullableFlag == 1) {
+                        error = CfgSymIdSetAddId(&symbol->tailSymIdList, symId->id);
+                        if (error != -ENOERR)
+                            goto out;
+                        error = CfgGraphAddEdge(&graph, symId->id, symbol->id);
+                        if (error != -ENOERR)
+                            goto out;
+                    }
+                }
+                if (ctx->nullable[symId->id]) {
+                    CplBitsetOr(trailer, &ctx->firstSet[symId->id * ctx->words], ctx->words);
+                } else {
+                    CplBitsetCopy(trailer, &ctx->firstSet[symId->id * ctx->words], ctx->words);
+                    nullableFlag = 0;
+                }
+            }
+        }
+    }
+    error = CfgGraphBuild(&graph, ctx->symNum);
     if (error != -ENOERR)
-        return error;
+        goto out;
+    CfgDigraph(ctx, &graph, ctx->followSet);
 
+    list_for_each(pos, &ctx->grammar->symbolList) {
+        symbol = container_of(pos, Symbol, node);
+        if (symbol->type != SYMBOL_TYPE_NONTERMINAL)
+            continue;
+        error = CfgFfSetToList(ctx, &ctx->followSet[symbol->id * ctx->words], 0, &symbol->followSymIdList);
+        if (error != -ENOERR)
+            goto out;
+    }
+out:
+    CfgGraphFree(&graph);
+    free(trailer);
     return error;
 }
 
@@ -564,20 +632,30 @@ int CfgGetSymIdFollow(ContextFreeGrammar *grammar, int symId, struct list_head *
 }
 
 /*
- * 功能：生成文法的FIRST和FOLLOW集合
+ * 功能：生成文法的FIRST和FOLLOW集合，可以重复调用，每次都重新生成。
  * 返回值：成功时返回0，否则返回错误码。
  **/
 int CfgGenFirstFollow(ContextFreeGrammar *grammar)
 {
+    CfgFfContext ctx;
     int error;
 
     if (!grammar)
         return -EINVAL;
 
-    error = CfgGenerateFirst(grammar);
+    error = CfgFfContextInit(&ctx, grammar);
     if (error != -ENOERR)
-        return error;
-    return CfgGenerateFollow(grammar);
+        goto out;
+    error = CfgFfGenNullable(&ctx);
+    if (error != -ENOERR)
+        goto out;
+    error = CfgGenerateFirst(&ctx);
+    if (error != -ENOERR)
+        goto out;
+    error = CfgGenerateFollow(&ctx);
+out:
+    CfgFfContextFree(&ctx);
+    return error;
 }
 
 /*
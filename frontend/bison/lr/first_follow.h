@@ -17,6 +17,7 @@ int CfgGetSymIdFollow(ContextFreeGrammar *grammar, int symId, struct list_head *
 int CfgGetSymIdListFirst(ContextFreeGrammar *grammar, const struct list_head *symIdList, struct list_head *firstSet);
 
 void CfgPrintFirstFollow(ContextFreeGrammar *grammar);
+void CfgFirstFollowBench(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,129 @@
+#include "context_free_grammar.h"
+#include "first_follow.h"
+#include "cpl_errno.h"
+#include "cpl_debug.h"
+#include "stdlib.h"
+#include "stdio.h"
+#include "time.h"
+
+/*
+ * 生成FIRST/FOLLOW集合的性能测试，用合成文法验证生成时间随产生式个数线性增长。
+ * 合成文法有BENCH_TERM_NUM个终结符号和n个非终结符号A0 ... An-1：
+ *      A(i) -> A(i+1) t(i)         首尾相连，FIRST关系是一个包含全部非终结符号的环；
+ *      A(i) -> t(7i) A(i+3)        FOLLOW关系也形成环；
+ *      A(i) -> empty               i是5的倍数时。
+ **/
+
+#define BENCH_ID_EMPTY          0
+#define BENCH_ID_END            1
+#define BENCH_ID_START          2
+#define BENCH_TERM_NUM          32
+#define BENCH_ID_TERM(i)        (3 + ((i) % BENCH_TERM_NUM))
+#define BENCH_ID_NONTERM(n, i)  (3 + BENCH_TERM_NUM + ((i) % (n)))
+
+/*
+ * 功能：生成有n个非终结符号的合成文法
+ * pProductNum：输出型参数，产生式个数
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int BenchDesignGrammar(ContextFreeGrammar **pGrammar, int n, int *pProductNum)
+{
+    ContextFreeGrammar *grammar;
+    int product[3];
+    int productNum = 0;
+    int i;
+    int error = 0;
+
+    error = ContextFreeGrammarAlloc(&grammar, BENCH_ID_EMPTY, BENCH_ID_END, BENCH_ID_START);
+    if (error != -ENOERR)
+        return error;
+    *pGrammar = grammar;
+
+    error = CfgAddSymbol(grammar, BENCH_ID_EMPTY, "empty", SYMBOL_TYPE_EMPTY);
+    if (error != -ENOERR)
+        goto err;
+    error = CfgAddSymbol(grammar, BENCH_ID_END, "$", SYMBOL_TYPE_TERMINAL);
+    if (error != -ENOERR)
+        goto err;
+    error = CfgAddSymbol(grammar, BENCH_ID_START, "S'", SYMBOL_TYPE_NONTERMINAL);
+    if (error != -ENOERR)
+        goto err;
+    for (i = 0; i < BENCH_TERM_NUM; i++) {
+        error = CfgAddSymbol(grammar, BENCH_ID_TERM(i), "t", SYMBOL_TYPE_TERMINAL);
+        if (error != -ENOERR)
+            goto err;
+    }
+    for (i = 0; i < n; i++) {
+        error = CfgAddSymbol(grammar, BENCH_ID_NONTERM(n, i), "A", SYMBOL_TYPE_NONTERMINAL);
+        if (error != -ENOERR)
+            goto err;
+    }
+
+    product[0] = BENCH_ID_START;
+    product[1] = BENCH_ID_NONTERM(n, 0);
+    error = CfgAddProduct(grammar, product, 2);
+    if (error != -ENOERR)
+        goto err;
+    productNum++;
+    for (i = 0; i < n; i++) {
+        product[0] = BENCH_ID_NONTERM(n, i);
+        product[1] = BENCH_ID_NONTERM(n, i + 1);
+        product[2] = BENCH_ID_TERM(i);
+        error = CfgAddProduct(grammar, product, 3);
+        if (error != -ENOERR)
+            goto err;
+        product[1] = BENCH_ID_TERM(i * 7);
+        product[2] = BENCH_ID_NONTERM(n, i + 3);
+        error = CfgAddProduct(grammar, product, 3);
+        if (error != -ENOERR)
+            goto err;
+        productNum += 2;
+        if (i % 5 == 0) {
+            product[1] = BENCH_ID_EMPTY;
+            error = CfgAddProduct(grammar, product, 2);
+            if (error != -ENOERR)
+                goto err;
+            productNum++;
+        }
+    }
+    *pProductNum = productNum;
+    return 0;
+
+err:
+    ContextFreeGrammarFree(grammar);
+    *pGrammar = NULL;
+    return error;
+}
+
+/*
+ * 功能：测试不同规模的合成文法生成FIRST/FOLLOW集合的时间。
+ * 返回值：无
+ **/
+void CfgFirstFollowBench(void)
+{
+    static const int sizeArr[] = {1000, 2000, 4000, 8000, 16000};
+    ContextFreeGrammar *grammar;
+    int productNum = 0;
+    unsigned int i;
+    clock_t start;
+    double ms;
+    int error = 0;
+
+    printf("%10s %10s %12s %14s\n", "nonterm", "product", "time(ms)", "ns/product");
+    for (i = 0; i < sizeof (sizeArr) / sizeof (sizeArr[0]); i++) {
+        error = BenchDesignGrammar(&grammar, sizeArr[i], &productNum);
+        if (error != -ENOERR) {
+            printf("design grammar fail: %d\n", error);
+            return;
+        }
+        start = clock();
+        error = CfgGenFirstFollow(grammar);
+        ms = (double)(clock() - start) * 1000 / CLOCKS_PER_SEC;
+        ContextFreeGrammarFree(grammar);
+        if (error != -ENOERR) {
+            printf("generate first follow fail: %d\n", error);
+            return;
+        }
+        printf("%10d %10d %12.2f %14.1f\n", sizeArr[i], productNum, ms, ms * 1e6 / productNum);
+    }
+}
@@ -0,0 +1,706 @@
+#include "lalr_emit.h"
+#include "lr_static_table.h"
+#include "context_free_grammar.h"
+#include "first_follow.h"
+#include "list.h"
+#include "cpl_bitset.h"
+#include "cpl_common.h"
+#include "cpl_debug.h"
+#include "cpl_errno.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
+
+/*每行输出的数组元素个数*/
+#define LALR_EMIT_LINE_NUM      16
+
+/*生成静态语法分析表的上下文*/
+typedef struct {
+    Lalr *lalr;
+    int symNum;                 /*符号id的范围[0, symNum)*/
+    int stateNum;               /*状态数*/
+    int16_t *tableArr;          /*[stateNum][symNum]*/
+    LrStaticReduce *reduceArr;  /*去重后的归约动作*/
+    char *reduceUnitArr;        /*[reduceNum]，归约动作是否是可以跳过的单产生式归约*/
+    int reduceNum;
+    int reduceSize;
+    unsigned int followWords;
+    uint32_t *followArr;        /*[symNum][followWords]*/
+    int colNum;                 /*输出的表的列数*/
+    int16_t *symIdxArr;         /*[symNum]，符号id对应的列下标，不在表中的符号为-1*/
+    int *colSymArr;             /*[colNum]，列下标对应的符号id*/
+    unsigned int colFollowWords;
+    uint32_t *colFollowArr;     /*[colNum][colFollowWords]，按列下标编号的FOLLOW集合*/
+    unsigned int flags;         /*LALR_EMIT_*选项*/
+    int16_t *defaultArr;        /*[stateNum]，只有一个归约动作的状态的表项，否则为0*/
+    int defaultNum;             /*有默认归约的状态数*/
+    int bypassNum;              /*被跳过的单产生式归约的GOTO数*/
+    LrStaticRecover *recoverArr;    /*[stateNum]，错误恢复目标*/
+    int recoverStateNum;            /*有错误恢复目标的状态数*/
+} LalrEmitContext;
+
+/*
+ * 功能：获取产生式的编号，只给有归约句柄的产生式编号，编号顺序与生成的分派函数一致。
+ * 返回值：产生式编号，没有归约句柄时返回-1。
+ **/
+static int LalrEmitProductId(const ContextFreeGrammar *grammar, int headSymId, int bodyId)
+{
+    struct list_head *symPos, *bodyPos;
+    Symbol *symbol;
+    ProductBody *productBody;
+    int productId = 0;
+
+    list_for_each(symPos, &grammar->symbolList) {
+        symbol = container_of(symPos, Symbol, node);
+        list_for_each(bodyPos, &symbol->bodyList) {
+            productBody = container_of(bodyPos, ProductBody, node);
+            if (!productBody->handle)
+                continue;
+            if (symbol->id == headSymId && productBody->id == bodyId)
+                return productId;
+            productId++;
+        }
+    }
+    return -1;
+}
+
+/*
+ * 功能：判断产生式是否是句柄为CfgPassHandle的单产生式A -> B，B是非终结符号。
+ * 返回值：是返回1，否则返回0。
+ **/
+static int LalrEmitProductIsUnitPass(const ContextFreeGrammar *grammar, const ProductBody *productBody)
+{
+    const Symbol *symbol;
+    const struct list_head *list = &productBody->symIdList;
+
+    if (productBody->handle != CfgPassHandle || productBody->handleType != RHT_SELF)
+        return 0;
+    if (list_empty(list) || list->next->next != list)
+        return 0;
+    symbol = CfgGetSymbol(grammar, container_of(list->next, SymId, node)->id);
+    return symbol && symbol->type == SYMBOL_TYPE_NONTERMINAL;
+}
+
+/*
+ * 功能：按照LrParse的归约规则，把项集itemSet上的归约或接受动作转换成静态归约动作。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LalrEmitGenReduce(LalrEmitContext *ctx, const ItemSet *itemSet, const ActionNode *action,
+                             LrStaticReduce *reduce, char *pUnit)
+{
+    ContextFreeGrammar *grammar = ctx->lalr->grammar;
+    ProductBody *productBody;
+    Item *item, *tempItem = NULL;
+
+    item = LalrItemSetGetItem(itemSet, action->itemId);
+    if (!item)
+        return -ENOITEM;
+    productBody = CfgGetProductBody(grammar, item->productRef.headSymId, item->productRef.bodyId);
+    if (!productBody)
+        return -ENOPDTB;
+    if (productBody->handle && !productBody->handleName) {
+        PrErr("product body of '%s' has no handle name\n",
+              CfgSymbolStr(CfgGetSymbol(grammar, item->productRef.headSymId)));
+        return -EINVAL;
+    }
+
+    memset(reduce, 0, sizeof (*reduce));
+    *pUnit = action->type == LAT_REDUCT && LalrEmitProductIsUnitPass(grammar, productBody);
+    reduce->type = action->type;
+    reduce->headSymId = item->productRef.headSymId;
+    reduce->bodyId = item->productRef.bodyId;
+    reduce->popNum = item->pos;
+    reduce->productId = -1;
+    if (!productBody->handle)
+        return 0;
+
+    reduce->productId = LalrEmitProductId(grammar, item->productRef.headSymId, item->productRef.bodyId);
+    if (action->type == LAT_ACCEPT || CfgProductBodyIsEmpty(grammar, productBody) == 0) {
+        reduce->argNum = item->pos + 1;
+        reduce->bodyArgFlag = 1;
+    } else if (productBody->handleType == RHT_SELF) {
+        reduce->argNum = 1;
+        reduce->bodyArgFlag = 0;
+    } else {
+        /*
+         * 空产生式体的项点位置是0，归约时格局栈栈顶就是当前项集，
+         * 参数个数由当前项集中点右边是产生式头的项决定，可以在生成时确定。
+         * 找不到唯一的项时，动态分析在归约时报错，这里用-1把错误推迟到归约时。
+         **/
+        if (LrItemSetGetItemByNextSymId(ctx->lalr, itemSet, item->productRef.headSymId, &tempItem) == -ENOERR) {
+            reduce->argNum = tempItem->pos + 1;
+            reduce->bodyArgFlag = 1;
+        } else {
+            reduce->argNum = -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * 功能：把归约动作加入去重后的归约动作数组。
+ * 返回值：成功时返回归约动作的下标，否则返回错误码。
+ **/
+static int LalrEmitAddReduce(LalrEmitContext *ctx, const LrStaticReduce *reduce, char unit)
+{
+    LrStaticReduce *reduceArr;
+    char *reduceUnitArr;
+    int i;
+
+    for (i = 0; i < ctx->reduceNum; i++) {
+        if (memcmp(&ctx->reduceArr[i], reduce, sizeof (*reduce)) == 0)
+            return i;
+    }
+    if (ctx->reduceNum >= ctx->reduceSize) {
+        ctx->reduceSize = ctx->reduceSize ? ctx->reduceSize * 2 : 64;
+        reduceArr = realloc(ctx->reduceArr, ctx->reduceSize * sizeof (*reduceArr));
+        if (!reduceArr)
+            return -ENOMEM;
+        ctx->reduceArr = reduceArr;
+        reduceUnitArr = realloc(ctx->reduceUnitArr, ctx->reduceSize * sizeof (*reduceUnitArr));
+        if (!reduceUnitArr)
+            return -ENOMEM;
+        ctx->reduceUnitArr = reduceUnitArr;
+    }
+    ctx->reduceArr[ctx->reduceNum] = *reduce;
+    ctx->reduceUnitArr[ctx->reduceNum] = unit;
+    return ctx->reduceNum++;
+}
+
+/*
+ * 功能：把项集族的ACTION和GOTO表压缩成一个[state][sym]的二维数组。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LalrEmitGenTable(LalrEmitContext *ctx)
+{
+    struct list_head *pos, *iter;
+    ItemSet *itemSet;
+    ActionNode *action;
+    GotoNode *gotoNode;
+    LrStaticReduce reduce;
+    char unit;
+    int idx;
+    int error = 0;
+
+    list_for_each(pos, &ctx->lalr->itemSetList) {
+        itemSet = container_of(pos, ItemSet, node);
+        if (itemSet->id < 0 || itemSet->id >= ctx->stateNum)
+            return -ENOSTATE;
+        list_for_each(iter, &itemSet->actionList) {
+            action = container_of(iter, ActionNode, node);
+            if (action->lookaheadId < 0 || action->lookaheadId >= ctx->symNum)
+                return -ENOSYM;
+            idx = itemSet->id * ctx->symNum + action->lookaheadId;
+            if (action->type == LAT_SHIFT) {
+                if (action->itemSetId + 1 > INT16_MAX)
+                    return -EMISC;
+                ctx->tableArr[idx] = action->itemSetId + 1;
+            } else if (action->type == LAT_REDUCT || action->type == LAT_ACCEPT) {
+                error = LalrEmitGenReduce(ctx, itemSet, action, &reduce, &unit);
+                if (error != -ENOERR)
+                    return error;
+                error = LalrEmitAddReduce(ctx, &reduce, unit);
+                if (error < 0)
+                    return error;
+                if (error + 1 > -(int)INT16_MIN)
+                    return -EMISC;
+                ctx->tableArr[idx] = -(error + 1);
+            }
+        }
+        list_for_each(iter, &itemSet->gotoList) {
+            gotoNode = container_of(iter, GotoNode, node);
+            if (gotoNode->symId < 0 || gotoNode->symId >= ctx->symNum)
+                return -ENOSYM;
+            if (gotoNode->nextItemSetId + 1 > INT16_MAX)
+                return -EMISC;
+            ctx->tableArr[itemSet->id * ctx->symNum + gotoNode->symId] = gotoNode->nextItemSetId + 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * 功能：找出只有一个归约动作、没有移入动作的状态，这样的状态不论向前看符号是什么都执行这个归约，
+ *      由于错误会在归约后的状态上被发现，省略向前看符号不会接受错误的输入。接受动作需要检查输入结束，不作为默认归约。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LalrEmitGenDefault(LalrEmitContext *ctx)
+{
+    const Symbol *symbol;
+    char *termArr;
+    int state, sym;
+    int entry, defaultEntry;
+
+    termArr = calloc(ctx->symNum, sizeof (*termArr));
+    if (!termArr)
+        return -ENOMEM;
+    for (sym = 0; sym < ctx->symNum; sym++) {
+        symbol = CfgGetSymbol(ctx->lalr->grammar, sym);
+        termArr[sym] = symbol && symbol->type == SYMBOL_TYPE_TERMINAL;
+    }
+    for (state = 0; state < ctx->stateNum; state++) {
+        defaultEntry = LR_STATIC_ERROR;
+        for (sym = 0; sym < ctx->symNum; sym++) {
+            if (!termArr[sym])
+                continue;
+            entry = ctx->tableArr[state * ctx->symNum + sym];
+            if (entry == LR_STATIC_ERROR)
+                continue;
+            if (LR_STATIC_IS_NEXT(entry)
+                    || ctx->reduceArr[LR_STATIC_REDUCE_IDX(entry)].type != LAT_REDUCT
+                    || (defaultEntry != LR_STATIC_ERROR && defaultEntry != entry)) {
+                defaultEntry = LR_STATIC_ERROR;
+                break;
+            }
+            defaultEntry = entry;
+        }
+        ctx->defaultArr[state] = defaultEntry;
+        if (defaultEntry != LR_STATIC_ERROR)
+            ctx->defaultNum++;
+    }
+    free(termArr);
+    return 0;
+}
+
+/*
+ * 功能：跳过单产生式归约。如果GOTO(s, B) = t，而t只有默认归约A -> B，并且归约句柄是CfgPassHandle，
+ *      则把GOTO(s, B)改成GOTO(s, A)，省去进入状态t再归约的过程。链式的单产生式会被逐个跳过。
+ * 返回值：无
+ **/
+static void LalrEmitUnitBypass(LalrEmitContext *ctx)
+{
+    const LrStaticReduce *reduce;
+    int state, sym, next;
+    int entry, headEntry;
+    int idx;
+    int changed = 1;
+    int round;
+
+    /*单产生式链的长度不会超过符号数*/
+    for (round = 0; changed && round < ctx->symNum; round++) {
+        changed = 0;
+        for (state = 0; state < ctx->stateNum; state++) {
+            for (sym = 0; sym < ctx->symNum; sym++) {
+                entry = ctx->tableArr[state * ctx->symNum + sym];
+                if (!LR_STATIC_IS_NEXT(entry))
+                    continue;
+                next = LR_STATIC_NEXT_STATE(entry);
+                if (ctx->defaultArr[next] == LR_STATIC_ERROR)
+                    continue;
+                idx = LR_STATIC_REDUCE_IDX(ctx->defaultArr[next]);
+                reduce = &ctx->reduceArr[idx];
+                if (!ctx->reduceUnitArr[idx] || reduce->headSymId == sym)
+                    continue;
+                headEntry = ctx->tableArr[state * ctx->symNum + reduce->headSymId];
+                if (!LR_STATIC_IS_NEXT(headEntry) || headEntry == entry)
+                    continue;
+                ctx->tableArr[state * ctx->symNum + sym] = headEntry;
+                ctx->bypassNum++;
+                changed = 1;
+            }
+        }
+    }
+}
+
+/*
+ * 功能：生成每个状态上的错误恢复目标，取错误恢复非终结符号中第一个有GOTO的符号，
+ *      与LrErrorRecover按链表顺序查找的结果一致。在跳过单产生式归约之后生成，使用最终的GOTO。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LalrEmitGenRecover(LalrEmitContext *ctx, const int recoverSymIdArr[], unsigned int recoverNum)
+{
+    int state;
+    int entry;
+    unsigned int k;
+
+    for (k = 0; k < recoverNum; k++) {
+        if (recoverSymIdArr[k] < 0 || recoverSymIdArr[k] >= ctx->symNum || recoverSymIdArr[k] > INT16_MAX)
+            return -ENOSYM;
+    }
+    ctx->recoverArr = malloc(ctx->stateNum * sizeof (*ctx->recoverArr));
+    if (!ctx->recoverArr)
+        return -ENOMEM;
+    for (state = 0; state < ctx->stateNum; state++) {
+        ctx->recoverArr[state].symId = -1;
+        ctx->recoverArr[state].nextState = -1;
+        for (k = 0; k < recoverNum; k++) {
+            entry = ctx->tableArr[state * ctx->symNum + recoverSymIdArr[k]];
+            if (LR_STATIC_IS_NEXT(entry)) {
+                ctx->recoverArr[state].symId = recoverSymIdArr[k];
+                ctx->recoverArr[state].nextState = LR_STATIC_NEXT_STATE(entry);
+                ctx->recoverStateNum++;
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * 功能：生成非终结符号的FOLLOW集合位集合，用于恐慌模式错误恢复。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LalrEmitGenFollow(LalrEmitContext *ctx)
+{
+    ContextFreeGrammar *grammar = ctx->lalr->grammar;
+    struct list_head *pos, *iter;
+    struct list_head followList;
+    Symbol *symbol;
+    SymId *symId;
+    int error = 0;
+
+    error = CfgGenFirstFollow(grammar);
+    if (error != -ENOERR)
+        return error;
+    list_for_each(pos, &grammar->symbolList) {
+        symbol = container_of(pos, Symbol, node);
+        if (symbol->type != SYMBOL_TYPE_NONTERMINAL)
+            continue;
+        INIT_LIST_HEAD(&followList);
+        error = CfgGetSymIdFollow(grammar, symbol->id, &followList);
+        if (error != -ENOERR) {
+            CfgSymIdListFree(&followList);
+            return error;
+        }
+        list_for_each(iter, &followList) {
+            symId = container_of(iter, SymId, node);
+            CplBitsetSet(&ctx->followArr[symbol->id * ctx->followWords], symId->id);
+        }
+        CfgSymIdListFree(&followList);
+    }
+    return 0;
+}
+
+/*
+ * 功能：符号id是稀疏的，只给在ACTION、GOTO或者FOLLOW集合中出现的符号分配稠密的列下标，
+ *      其余符号不占用表的列。FOLLOW集合同时换成按列下标编号的位集合。
+ *      在跳过单产生式归约和生成错误恢复目标之后调用，使用最终的表项。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LalrEmitGenColumn(LalrEmitContext *ctx)
+{
+    const uint32_t *follow;
+    char *usedArr;
+    int state, sym, col, followCol;
+
+    usedArr = calloc(ctx->symNum, sizeof (*usedArr));
+    ctx->symIdxArr = malloc(ctx->symNum * sizeof (*ctx->symIdxArr));
+    ctx->colSymArr = malloc(ctx->symNum * sizeof (*ctx->colSymArr));
+    if (!usedArr || !ctx->symIdxArr || !ctx->colSymArr) {
+        free(usedArr);
+        return -ENOMEM;
+    }
+    for (state = 0; state < ctx->stateNum; state++) {
+        for (sym = 0; sym < ctx->symNum; sym++) {
+            if (ctx->tableArr[state * ctx->symNum + sym] != LR_STATIC_ERROR)
+                usedArr[sym] = 1;
+        }
+    }
+    /*FOLLOW集合中只有终结符号，错误恢复时在输入中查找它们，即使没有表项也要保留列*/
+    for (sym = 0; sym < ctx->symNum; sym++) {
+        if (!usedArr[sym])
+            continue;
+        follow = &ctx->followArr[sym * ctx->followWords];
+        for (col = 0; col < ctx->symNum; col++) {
+            if (CplBitsetTest(follow, col))
+                usedArr[col] = 1;
+        }
+    }
+    for (sym = 0; sym < ctx->symNum; sym++) {
+        ctx->symIdxArr[sym] = -1;
+        if (!usedArr[sym])
+            continue;
+        ctx->symIdxArr[sym] = ctx->colNum;
+        ctx->colSymArr[ctx->colNum++] = sym;
+    }
+    free(usedArr);
+    if (ctx->colNum > INT16_MAX)
+        return -EMISC;
+
+    ctx->colFollowWords = CPL_BITSET_WORDS(ctx->colNum);
+    ctx->colFollowArr = calloc((size_t)ctx->colNum * ctx->colFollowWords, sizeof (*ctx->colFollowArr));
+    if (!ctx->colFollowArr)
+        return -ENOMEM;
+    for (col = 0; col < ctx->colNum; col++) {
+        follow = &ctx->followArr[ctx->colSymArr[col] * ctx->followWords];
+        for (followCol = 0; followCol < ctx->colNum; followCol++) {
+            if (CplBitsetTest(follow, ctx->colSymArr[followCol]))
+                CplBitsetSet(&ctx->colFollowArr[col * ctx->colFollowWords], followCol);
+        }
+    }
+    return 0;
+}
+
+static void LalrEmitStr(FILE *fp, const char *str)
+{
+    fputc('"', fp);
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\')
+            fputc('\\', fp);
+        fputc(*str, fp);
+    }
+    fputc('"', fp);
+}
+
+static void LalrEmitSymStrArr(LalrEmitContext *ctx, const char *prefix, FILE *fp)
+{
+    Symbol *symbol;
+    int i;
+
+    fprintf(fp, "static const char *const %sSymStrArr[%d] = {\n", prefix, ctx->colNum);
+    for (i = 0; i < ctx->colNum; i++) {
+        symbol = CfgGetSymbol(ctx->lalr->grammar, ctx->colSymArr[i]);
+        fprintf(fp, "    /*%d*/ ", ctx->colSymArr[i]);
+        if (symbol && symbol->str)
+            LalrEmitStr(fp, symbol->str);
+        else
+            fprintf(fp, "NULL");
+        fprintf(fp, ",\n");
+    }
+    fprintf(fp, "};\n\n");
+}
+
+static void LalrEmitSymIdxArr(LalrEmitContext *ctx, const char *prefix, FILE *fp)
+{
+    int sym;
+
+    fprintf(fp, "static const int16_t %sSymIdxArr[%d] = {\n", prefix, ctx->symNum);
+    for (sym = 0; sym < ctx->symNum; sym++) {
+        if (sym % LALR_EMIT_LINE_NUM == 0)
+            fprintf(fp, "    /*%d*/", sym);
+        fprintf(fp, " %d,", ctx->symIdxArr[sym]);
+        if (sym % LALR_EMIT_LINE_NUM == LALR_EMIT_LINE_NUM - 1 || sym == ctx->symNum - 1)
+            fprintf(fp, "\n");
+    }
+    fprintf(fp, "};\n\n");
+}
+
+static void LalrEmitTableArr(LalrEmitContext *ctx, const char *prefix, FILE *fp)
+{
+    int state, col;
+
+    fprintf(fp, "static const int16_t %sTableArr[%d * %d] = {\n", prefix, ctx->stateNum, ctx->colNum);
+    for (state = 0; state < ctx->stateNum; state++) {
+        fprintf(fp, "    /*%d*/\n", state);
+        for (col = 0; col < ctx->colNum; col++) {
+            if (col % LALR_EMIT_LINE_NUM == 0)
+                fprintf(fp, "   ");
+            fprintf(fp, " %d,", ctx->tableArr[state * ctx->symNum + ctx->colSymArr[col]]);
+            if (col % LALR_EMIT_LINE_NUM == LALR_EMIT_LINE_NUM - 1 || col == ctx->colNum - 1)
+                fprintf(fp, "\n");
+        }
+    }
+    fprintf(fp, "};\n\n");
+}
+
+static void LalrEmitReduceArr(LalrEmitContext *ctx, const char *prefix, FILE *fp)
+{
+    const LrStaticReduce *reduce;
+    int i;
+
+    fprintf(fp, "/*{type, headSymId, bodyId, productId, popNum, argNum, bodyArgFlag}*/\n");
+    fprintf(fp, "static const LrStaticReduce %sReduceArr[%d] = {\n", prefix, ctx->reduceNum);
+    for (i = 0; i < ctx->reduceNum; i++) {
+        reduce = &ctx->reduceArr[i];
+        fprintf(fp, "    {%s, %d, %d, %d, %d, %d, %d},\n",
+                reduce->type == LAT_ACCEPT ? "LAT_ACCEPT" : "LAT_REDUCT",
+                reduce->headSymId, reduce->bodyId, reduce->productId, reduce->popNum,
+                reduce->argNum, reduce->bodyArgFlag);
+    }
+    fprintf(fp, "};\n\n");
+}
+
+static void LalrEmitDefaultArr(LalrEmitContext *ctx, const char *prefix, FILE *fp)
+{
+    int state;
+
+    fprintf(fp, "static const int16_t %sDefaultArr[%d] = {\n", prefix, ctx->stateNum);
+    for (state = 0; state < ctx->stateNum; state++) {
+        if (state % LALR_EMIT_LINE_NUM == 0)
+            fprintf(fp, "   ");
+        fprintf(fp, " %d,", ctx->defaultArr[state]);
+        if (state % LALR_EMIT_LINE_NUM == LALR_EMIT_LINE_NUM - 1 || state == ctx->stateNum - 1)
+            fprintf(fp, "\n");
+    }
+    fprintf(fp, "};\n\n");
+}
+
+static void LalrEmitRecoverArr(LalrEmitContext *ctx, const char *prefix, FILE *fp)
+{
+    int state;
+
+    fprintf(fp, "/*{symId, nextState}*/\n");
+    fprintf(fp, "static const LrStaticRecover %sRecoverArr[%d] = {\n", prefix, ctx->stateNum);
+    for (state = 0; state < ctx->stateNum; state++) {
+        if (state % (LALR_EMIT_LINE_NUM / 2) == 0)
+            fprintf(fp, "   ");
+        fprintf(fp, " {%d, %d},", ctx->recoverArr[state].symId, ctx->recoverArr[state].nextState);
+        if (state % (LALR_EMIT_LINE_NUM / 2) == LALR_EMIT_LINE_NUM / 2 - 1 || state == ctx->stateNum - 1)
+            fprintf(fp, "\n");
+    }
+    fprintf(fp, "};\n\n");
+}
+
+static void LalrEmitFollowArr(LalrEmitContext *ctx, const char *prefix, FILE *fp)
+{
+    unsigned int col, w;
+
+    fprintf(fp, "static const uint32_t %sFollowArr[%d * %u] = {\n", prefix, ctx->colNum, ctx->colFollowWords);
+    for (col = 0; col < (unsigned int)ctx->colNum; col++) {
+        fprintf(fp, "    /*%d*/", ctx->colSymArr[col]);
+        for (w = 0; w < ctx->colFollowWords; w++)
+            fprintf(fp, " 0x%08xu,", ctx->colFollowArr[col * ctx->colFollowWords + w]);
+        fprintf(fp, "\n");
+    }
+    fprintf(fp, "};\n\n");
+}
+
+/*
+ * 功能：生成按产生式编号分派的归约函数，直接调用归约句柄，便于编译器内联。
+ **/
+static void LalrEmitReduceHandle(LalrEmitContext *ctx, const char *prefix, FILE *fp)
+{
+    struct list_head *symPos, *bodyPos;
+    Symbol *symbol;
+    ProductBody *productBody;
+    int productId = 0;
+
+    fprintf(fp, "static int %sReduceHandle(int productId, void **headArg, void *prevArg, void *bodyArg[])\n", prefix);
+    fprintf(fp, "{\n");
+    fprintf(fp, "    switch (productId) {\n");
+    list_for_each(symPos, &ctx->lalr->grammar->symbolList) {
+        symbol = container_of(symPos, Symbol, node);
+        list_for_each(bodyPos, &symbol->bodyList) {
+            productBody = container_of(bodyPos, ProductBody, node);
+            if (!productBody->handle)
+                continue;
+            fprintf(fp, "    case %d:\n", productId);
+            fprintf(fp, "        return %s(headArg, prevArg, bodyArg);\n", productBody->handleName);
+            productId++;
+        }
+    }
+    fprintf(fp, "    default:\n");
+    fprintf(fp, "        return -EINVAL;\n");
+    fprintf(fp, "    }\n");
+    fprintf(fp, "}\n\n");
+}
+
+static void LalrEmitContextFree(LalrEmitContext *ctx)
+{
+    free(ctx->tableArr);
+    free(ctx->reduceArr);
+    free(ctx->reduceUnitArr);
+    free(ctx->followArr);
+    free(ctx->symIdxArr);
+    free(ctx->colSymArr);
+    free(ctx->colFollowArr);
+    free(ctx->defaultArr);
+    free(ctx->recoverArr);
+}
+
+/*
+ * 功能：把生成好的LALR语法分析表输出成C源文件，其中的数组都是static const的，
+ *      归约句柄通过switch分派，文件需要在归约句柄定义之后被#include。
+ * lalr：已经生成了语法分析表的LALR
+ * prefix：生成的标识符的前缀，生成的表名为<prefix>StaticTable
+ * flags：LALR_EMIT_*选项的组合
+ * recoverSymIdArr：错误恢复非终结符号，按优先顺序排列，为空时不生成错误恢复表
+ * recoverNum：错误恢复非终结符号数
+ * fp：输出文件
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int LalrEmitStaticTable(Lalr *lalr, const char *prefix, unsigned int flags,
+                        const int recoverSymIdArr[], unsigned int recoverNum, FILE *fp)
+{
+    LalrEmitContext ctx;
+    int error = 0;
+
+    if (!lalr || !lalr->grammar || !prefix || !fp)
+        return -EINVAL;
+
+    memset(&ctx, 0, sizeof (ctx));
+    ctx.lalr = lalr;
+    ctx.symNum = lalr->grammar->maxSymId + 1;
+    ctx.stateNum = lalr->itemSetNum;
+    ctx.followWords = CPL_BITSET_WORDS(ctx.symNum);
+    ctx.tableArr = calloc((size_t)ctx.stateNum * ctx.symNum, sizeof (*ctx.tableArr));
+    ctx.followArr = calloc((size_t)ctx.symNum * ctx.followWords, sizeof (*ctx.followArr));
+    ctx.defaultArr = calloc(ctx.stateNum, sizeof (*ctx.defaultArr));
+    ctx.flags = flags;
+    if (!ctx.tableArr || !ctx.followArr || !ctx.defaultArr) {
+        error = -ENOMEM;
+        goto err;
+    }
+    error = LalrEmitGenTable(&ctx);
+    if (error != -ENOERR)
+        goto err;
+    error = LalrEmitGenFollow(&ctx);
+    if (error != -ENOERR)
+        goto err;
+    /*跳过单产生式归约依赖默认归约的计算结果*/
+    if (flags & (LALR_EMIT_DEFAULT_REDUCE | LALR_EMIT_UNIT_BYPASS)) {
+        error = LalrEmitGenDefault(&ctx);
+        if (error != -ENOERR)
+            goto err;
+    }
+    if (flags & LALR_EMIT_UNIT_BYPASS)
+        LalrEmitUnitBypass(&ctx);
+    if (recoverSymIdArr && recoverNum > 0) {
+        error = LalrEmitGenRecover(&ctx, recoverSymIdArr, recoverNum);
+        if (error != -ENOERR)
+            goto err;
+    }
+    error = LalrEmitGenColumn(&ctx);
+    if (error != -ENOERR)
+        goto err;
+
+    fprintf(fp, "/*\n");
+    fprintf(fp, " * 静态LALR语法分析表，由LalrEmitStaticTable生成，不要手工修改。\n");
+    fprintf(fp, " * 状态数：%d，符号数：%d，表的列数：%d，归约动作数：%d。\n",
+            ctx.stateNum, ctx.symNum, ctx.colNum, ctx.reduceNum);
+    if (flags & LALR_EMIT_DEFAULT_REDUCE)
+        fprintf(fp, " * 默认归约的状态数：%d。\n", ctx.defaultNum);
+    if (flags & LALR_EMIT_UNIT_BYPASS)
+        fprintf(fp, " * 跳过单产生式归约的GOTO数：%d。\n", ctx.bypassNum);
+    if (ctx.recoverArr)
+        fprintf(fp, " * 有错误恢复目标的状态数：%d。\n", ctx.recoverStateNum);
+    fprintf(fp, " **/\n\n");
+    LalrEmitSymStrArr(&ctx, prefix, fp);
+    LalrEmitSymIdxArr(&ctx, prefix, fp);
+    LalrEmitTableArr(&ctx, prefix, fp);
+    LalrEmitReduceArr(&ctx, prefix, fp);
+    if (flags & LALR_EMIT_DEFAULT_REDUCE)
+        LalrEmitDefaultArr(&ctx, prefix, fp);
+    if (ctx.recoverArr)
+        LalrEmitRecoverArr(&ctx, prefix, fp);
+    LalrEmitFollowArr(&ctx, prefix, fp);
+    LalrEmitReduceHandle(&ctx, prefix, fp);
+    fprintf(fp, "static const LrStaticTable %sStaticTable = {\n", prefix);
+    fprintf(fp, "    .stateNum = %d,\n", ctx.stateNum);
+    fprintf(fp, "    .symNum = %d,\n", ctx.symNum);
+    fprintf(fp, "    .colNum = %d,\n", ctx.colNum);
+    fprintf(fp, "    .endSymId = %d,\n", lalr->grammar->endSymId);
+    fprintf(fp, "    .symIdxArr = %sSymIdxArr,\n", prefix);
+    fprintf(fp, "    .tableArr = %sTableArr,\n", prefix);
+    fprintf(fp, "    .reduceArr = %sReduceArr,\n", prefix);
+    if (flags & LALR_EMIT_DEFAULT_REDUCE)
+        fprintf(fp, "    .defaultArr = %sDefaultArr,\n", prefix);
+    else
+        fprintf(fp, "    .defaultArr = NULL,\n");
+    fprintf(fp, "    .followWords = %u,\n", ctx.colFollowWords);
+    fprintf(fp, "    .followArr = %sFollowArr,\n", prefix);
+    if (ctx.recoverArr)
+        fprintf(fp, "    .recoverArr = %sRecoverArr,\n", prefix);
+    else
+        fprintf(fp, "    .recoverArr = NULL,\n");
+    fprintf(fp, "    .symStrArr = %sSymStrArr,\n", prefix);
+    fprintf(fp, "    .reduceHandle = %sReduceHandle,\n", prefix);
+    fprintf(fp, "};\n");
+    if (ferror(fp))
+        error = -EMISC;
+
+err:
+    LalrEmitContextFree(&ctx);
+    return error;
+}
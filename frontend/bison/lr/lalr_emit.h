@@ -0,0 +1,22 @@
+#ifndef __LALR_EMIT_H__
+#define __LALR_EMIT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdio.h"
+#include "lalr_parse_table.h"
+
+/*生成静态语法分析表的选项*/
+#define LALR_EMIT_DEFAULT_REDUCE    0x01    /*只有一个归约动作的状态不读取向前看符号直接归约*/
+#define LALR_EMIT_UNIT_BYPASS       0x02    /*跳过句柄为CfgPassHandle的单产生式归约*/
+
+int LalrEmitStaticTable(Lalr *lalr, const char *prefix, unsigned int flags,
+                        const int recoverSymIdArr[], unsigned int recoverNum, FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__LALR_EMIT_H__*/
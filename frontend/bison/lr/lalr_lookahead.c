@@ -0,0 +1,608 @@
+#include "lalr_lookahead.h"
+#include "lalr_parse_table.h"
+#include "context_free_grammar.h"
+#include "sym_id.h"
+#include "list.h"
+#include "cpl_bitset.h"
+#include "cpl_debug.h"
+#include "cpl_errno.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
+
+//#define LLA_DEBUG
+#ifdef LLA_DEBUG
+#define PrDbg(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "debug", __VA_ARGS__)
+#else
+#define PrDbg(...)
+#endif
+
+/*
+ * DeRemer-Pennello LALR(1)向前看符号算法。
+ * 在LR(0)项集族上定义非终结符号转移(p, A)之间的关系：
+ *      DR(p, A)：GOTO(p, A)上可以直接移入的终结符号；
+ *      (p, A) reads (r, C)：r = GOTO(p, A)，且C可以推导出空符号；
+ *      (p, A) includes (p', B)：B -> βAγ，γ可以推导出空符号，且p'经过β到达p；
+ *      (q, A -> ω) lookback (p, A)：p经过ω到达q。
+ * 于是：Read = DR ∪ Read(reads)，Follow = Read ∪ Follow(includes)，
+ *      LA(q, A -> ω) = ∪{Follow(p, A) | (q, A -> ω) lookback (p, A)}。
+ * Read和Follow都用强连通分量上的digraph遍历一次求出。
+ **/
+
+#define LA_DEPTH_INFINITY   0x7fffffff
+
+/*转移之间的关系类型*/
+typedef enum {
+    LRT_READS,      /*reads关系*/
+    LRT_INCLUDES,   /*includes关系*/
+    LRT_NUM,
+} LaRelationType;
+
+/*非终结符号转移(p, A)*/
+typedef struct {
+    int itemSetId;                          /*转移的起始项集p*/
+    int symId;                              /*非终结符号A*/
+    int nextItemSetId;                      /*GOTO(p, A)*/
+    struct list_head relList[LRT_NUM];      /*关系链表，节点类型：SymId，id为转移编号*/
+    struct list_head lookbackList;          /*lookback关系，节点类型：FollowTransmitterItem*/
+} LaTrans;
+
+typedef struct {
+    Lalr *lalr;
+    ContextFreeGrammar *grammar;
+    ItemSet **itemSetArr;   /*按项集id索引的项集*/
+    int itemSetCnt;
+    Symbol **symbolArr;     /*按符号id索引的文法符号*/
+    LaTrans *transArr;      /*非终结符号转移*/
+    int transCnt;
+    int *transBase;         /*项集p的转移在transArr中的下标范围[transBase[p], transBase[p + 1])*/
+    unsigned int words;     /*符号位集合的字数*/
+    uint32_t *readSet;      /*Read(p, A)，每个转移words个字*/
+    uint32_t *followSet;    /*Follow(p, A)，每个转移words个字*/
+    uint32_t **itemLaSet;   /*各项集中各项的向前看符号集合*/
+    int *depthArr;          /*digraph遍历的深度标记*/
+    int *stack;             /*digraph遍历栈*/
+    int top;
+    CplArena *arena;        /*lookback关系节点的区域分配器*/
+} LaContext;
+
+/*
+ * 功能：获取项集在文法符号上的下一个项集id。
+ * 返回值：成功时返回项集id，否则返回-ENOSTATE。
+ **/
+static int LaGoto(const LaContext *ctx, int itemSetId, int symId)
+{
+    struct list_head *pos;
+    MapNode *mapNode;
+
+    list_for_each(pos, &ctx->itemSetArr[itemSetId]->mapList) {
+        mapNode = container_of(pos, MapNode, node);
+        if (mapNode->symId == symId)
+            return mapNode->itemSetId;
+    }
+    return -ENOSTATE;
+}
+
+/*
+ * 功能：获取非终结符号转移(itemSetId, symId)的编号。
+ * 返回值：成功时返回转移编号，否则返回-ENOSTATE。
+ **/
+static int LaTransIndex(const LaContext *ctx, int itemSetId, int symId)
+{
+    int t;
+
+    for (t = ctx->transBase[itemSetId]; t < ctx->transBase[itemSetId + 1]; t++) {
+        if (ctx->transArr[t].symId == symId)
+            return t;
+    }
+    return -ENOSTATE;
+}
+
+/*
+ * 功能：判断文法符号是否可以推导出空符号。
+ * 返回值：可以推导出空符号返回1，否则返回0。
+ **/
+static int LaSymIsNullable(const LaContext *ctx, int symId)
+{
+    const Symbol *symbol;
+
+    if (symId == ctx->grammar->emptySymId)
+        return 1;
+    symbol = ctx->symbolArr[symId];
+    if (!symbol || symbol->type != SYMBOL_TYPE_NONTERMINAL)
+        return 0;
+    return CfgSymIdSetIsContain(&symbol->firstSymIdList, ctx->grammar->emptySymId) == 1;
+}
+
+/*
+ * 功能：把产生式体转换为符号id数组，空产生式体的长度为0。
+ * arr：输出型参数，为NULL时只计算长度。
+ * 返回值：产生式体长度。
+ **/
+static int LaProductBodyToArr(const LaContext *ctx, const ProductBody *productBody, int *arr)
+{
+    struct list_head *pos;
+    SymId *symId;
+    int len = 0;
+
+    list_for_each(pos, &productBody->symIdList) {
+        symId = container_of(pos, SymId, node);
+        if (symId->id == ctx->grammar->emptySymId)
+            continue;
+        if (arr)
+            arr[len] = symId->id;
+        len++;
+    }
+    return len;
+}
+
+/*
+ * 功能：获取项集中以(headSymId, bodyId, position)为核心的项。
+ * 返回值：成功时返回项，否则返回NULL。
+ **/
+static Item *LaItemSetGetItemByCore(const ItemSet *itemSet, int headSymId, int bodyId, int position)
+{
+    struct list_head *pos;
+    Item *item;
+
+    list_for_each(pos, &itemSet->itemList) {
+        item = container_of(pos, Item, node);
+        if (item->productRef.headSymId == headSymId
+                && item->productRef.bodyId == bodyId
+                && item->pos == position)
+            return item;
+    }
+    return NULL;
+}
+
+/*
+ * 功能：释放上下文资源
+ * 返回值：无
+ **/
+static void LaContextFree(LaContext *ctx)
+{
+    int t;
+
+    if (ctx->transArr) {
+        for (t = 0; t < ctx->transCnt; t++) {
+            CfgSymIdListFree(&ctx->transArr[t].relList[LRT_READS]);
+            CfgSymIdListFree(&ctx->transArr[t].relList[LRT_INCLUDES]);
+        }
+    }
+    CplArenaDestroy(ctx->arena);
+    if (ctx->itemLaSet) {
+        for (t = 0; t < ctx->itemSetCnt; t++)
+            free(ctx->itemLaSet[t]);
+    }
+    free(ctx->itemSetArr);
+    free(ctx->symbolArr);
+    free(ctx->transArr);
+    free(ctx->transBase);
+    free(ctx->readSet);
+    free(ctx->followSet);
+    free(ctx->itemLaSet);
+    free(ctx->depthArr);
+    free(ctx->stack);
+}
+
+/*
+ * 功能：建立项集、文法符号的索引数组和非终结符号转移数组。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LaContextInit(LaContext *ctx, Lalr *lalr)
+{
+    struct list_head *pos, *mapPos;
+    ItemSet *itemSet;
+    MapNode *mapNode;
+    Symbol *symbol;
+    int t, s;
+
+    memset(ctx, 0, sizeof (*ctx));
+    ctx->lalr = lalr;
+    ctx->grammar = lalr->grammar;
+    ctx->itemSetCnt = lalr->itemSetNum;
+    ctx->words = CPL_BITSET_WORDS(ctx->grammar->maxSymId + 1);
+    ctx->arena = CplArenaCreate(0);
+
+    ctx->itemSetArr = calloc(ctx->itemSetCnt, sizeof (*ctx->itemSetArr));
+    ctx->symbolArr = calloc(ctx->grammar->maxSymId + 1, sizeof (*ctx->symbolArr));
+    ctx->transBase = calloc(ctx->itemSetCnt + 1, sizeof (*ctx->transBase));
+    ctx->itemLaSet = calloc(ctx->itemSetCnt, sizeof (*ctx->itemLaSet));
+    if (!ctx->arena || !ctx->itemSetArr || !ctx->symbolArr || !ctx->transBase || !ctx->itemLaSet)
+        return -ENOMEM;
+
+    list_for_each(pos, &ctx->grammar->symbolList) {
+        symbol = container_of(pos, Symbol, node);
+        ctx->symbolArr[symbol->id] = symbol;
+    }
+
+    /*统计非终结符号转移的数量，同时建立项集索引。*/
+    list_for_each(pos, &lalr->itemSetList) {
+        itemSet = container_of(pos, ItemSet, node);
+        if (itemSet->id < 0 || itemSet->id >= ctx->itemSetCnt)
+            return -ENOSTATE;
+        ctx->itemSetArr[itemSet->id] = itemSet;
+        ctx->itemLaSet[itemSet->id] = calloc(itemSet->itemNum ? itemSet->itemNum : 1,
+                                             ctx->words * sizeof (uint32_t));
+        if (!ctx->itemLaSet[itemSet->id])
+            return -ENOMEM;
+        list_for_each(mapPos, &itemSet->mapList) {
+            mapNode = container_of(mapPos, MapNode, node);
+            symbol = ctx->symbolArr[mapNode->symId];
+            if (symbol && symbol->type == SYMBOL_TYPE_NONTERMINAL)
+                ctx->transCnt++;
+        }
+    }
+
+    ctx->transArr = calloc(ctx->transCnt ? ctx->transCnt : 1, sizeof (*ctx->transArr));
+    ctx->readSet = calloc(ctx->transCnt ? ctx->transCnt : 1, ctx->words * sizeof (uint32_t));
+    ctx->followSet = calloc(ctx->transCnt ? ctx->transCnt : 1, ctx->words * sizeof (uint32_t));
+    ctx->depthArr = calloc(ctx->transCnt ? ctx->transCnt : 1, sizeof (*ctx->depthArr));
+    ctx->stack = calloc(ctx->transCnt ? ctx->transCnt : 1, sizeof (*ctx->stack));
+    if (!ctx->transArr || !ctx->readSet || !ctx->followSet || !ctx->depthArr || !ctx->stack)
+        return -ENOMEM;
+    /*先初始化所有链表头，中途出错返回时LaContextFree可以释放每个转移*/
+    for (t = 0; t < ctx->transCnt; t++) {
+        INIT_LIST_HEAD(&ctx->transArr[t].relList[LRT_READS]);
+        INIT_LIST_HEAD(&ctx->transArr[t].relList[LRT_INCLUDES]);
+        INIT_LIST_HEAD(&ctx->transArr[t].lookbackList);
+    }
+
+    /*按项集id顺序填写转移数组。*/
+    t = 0;
+    for (s = 0; s < ctx->itemSetCnt; s++) {
+        ctx->transBase[s] = t;
+        if (!ctx->itemSetArr[s])
+            return -ENOSTATE;
+        list_for_each(mapPos, &ctx->itemSetArr[s]->mapList) {
+            mapNode = container_of(mapPos, MapNode, node);
+            symbol = ctx->symbolArr[mapNode->symId];
+            if (!symbol || symbol->type != SYMBOL_TYPE_NONTERMINAL)
+                continue;
+            ctx->transArr[t].itemSetId = s;
+            ctx->transArr[t].symId = mapNode->symId;
+            ctx->transArr[t].nextItemSetId = mapNode->itemSetId;
+            t++;
+        }
+    }
+    ctx->transBase[ctx->itemSetCnt] = t;
+    return 0;
+}
+
+/*
+ * 功能：计算各转移的DR集合和reads关系。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LaGenDirectRead(LaContext *ctx)
+{
+    struct list_head *pos;
+    MapNode *mapNode;
+    Symbol *symbol;
+    LaTrans *trans;
+    int t, r;
+    int error = 0;
+
+    for (t = 0; t < ctx->transCnt; t++) {
+        trans = &ctx->transArr[t];
+        list_for_each(pos, &ctx->itemSetArr[trans->nextItemSetId]->mapList) {
+            mapNode = container_of(pos, MapNode, node);
+            symbol = ctx->symbolArr[mapNode->symId];
+            if (!symbol)
+                return -ENOSYM;
+            if (symbol->type == SYMBOL_TYPE_TERMINAL) {
+                CplBitsetSet(&ctx->readSet[t * ctx->words], mapNode->symId);
+            } else if (symbol->type == SYMBOL_TYPE_NONTERMINAL
+                       && LaSymIsNullable(ctx, mapNode->symId)) {
+                r = LaTransIndex(ctx, trans->nextItemSetId, mapNode->symId);
+                if (r < 0)
+                    return r;
+                error = CfgSymIdListTailAddId(&trans->relList[LRT_READS], r);
+                if (error != -ENOERR)
+                    return error;
+            }
+        }
+    }
+    return error;
+}
+
+/*
+ * 功能：添加lookback关系节点
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LaTransAddLookback(LaContext *ctx, LaTrans *trans, int itemSetId, int itemId)
+{
+    FollowTransmitterItem *lookback;
+
+    lookback = CplArenaAlloc(ctx->arena, sizeof (*lookback));
+    if (!lookback)
+        return -ENOMEM;
+    lookback->itemSetId = itemSetId;
+    lookback->itemId = itemId;
+    list_add_tail(&lookback->node, &trans->lookbackList);
+    return 0;
+}
+
+/*
+ * 功能：从项集itemSetId出发沿产生式体symbol -> productBody行走，生成includes和lookback关系。
+ *      symbol是开始符号时不存在转移(p', S')，它的FOLLOW集合是结束符号，直接加到相关集合中。
+ * headTrans：转移(p', B)的编号，开始符号时为-1。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LaWalkProductBody(LaContext *ctx, int itemSetId, int headTrans,
+                             const Symbol *symbol, const ProductBody *productBody)
+{
+    int len = LaProductBodyToArr(ctx, productBody, NULL);
+    int bodyArr[len + 1];
+    int stateArr[len + 1];
+    int nullableFrom;   /*从这个位置开始的剩余产生式体都可以推导出空符号。*/
+    int i, t;
+    Item *item;
+    int error = 0;
+
+    LaProductBodyToArr(ctx, productBody, bodyArr);
+    stateArr[0] = itemSetId;
+    for (i = 0; i < len; i++) {
+        stateArr[i + 1] = LaGoto(ctx, stateArr[i], bodyArr[i]);
+        if (stateArr[i + 1] < 0)
+            return stateArr[i + 1];
+    }
+
+    nullableFrom = len;
+    while (nullableFrom > 0 && LaSymIsNullable(ctx, bodyArr[nullableFrom - 1]))
+        nullableFrom--;
+
+    /*includes：B -> βAγ，γ可以推导出空符号。*/
+    for (i = 0; i < len; i++) {
+        const Symbol *iterSymbol = ctx->symbolArr[bodyArr[i]];
+
+        if (!iterSymbol || iterSymbol->type != SYMBOL_TYPE_NONTERMINAL || i + 1 < nullableFrom)
+            continue;
+        t = LaTransIndex(ctx, stateArr[i], bodyArr[i]);
+        if (t < 0)
+            return t;
+        if (headTrans >= 0) {
+            error = CfgSymIdListTailAddId(&ctx->transArr[t].relList[LRT_INCLUDES], headTrans);
+            if (error != -ENOERR)
+                return error;
+        } else {
+            CplBitsetSet(&ctx->followSet[t * ctx->words], ctx->grammar->endSymId);
+        }
+    }
+
+    /*lookback：从p'经过ω到达归约项所在项集q。*/
+    item = LaItemSetGetItemByCore(ctx->itemSetArr[stateArr[len]], symbol->id, productBody->id, len);
+    if (!item)
+        return -ENOITEM;
+    if (headTrans >= 0)
+        return LaTransAddLookback(ctx, &ctx->transArr[headTrans], stateArr[len], item->id);
+    CplBitsetSet(&ctx->itemLaSet[stateArr[len]][item->id * ctx->words], ctx->grammar->endSymId);
+    return 0;
+}
+
+/*
+ * 功能：生成includes和lookback关系。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LaGenIncludesLookback(LaContext *ctx)
+{
+    struct list_head *pos;
+    ProductBody *productBody;
+    const Symbol *symbol;
+    int t;
+    int error = 0;
+
+    for (t = 0; t < ctx->transCnt; t++) {
+        symbol = ctx->symbolArr[ctx->transArr[t].symId];
+        list_for_each(pos, &symbol->bodyList) {
+            productBody = container_of(pos, ProductBody, node);
+            error = LaWalkProductBody(ctx, ctx->transArr[t].itemSetId, t, symbol, productBody);
+            if (error != -ENOERR)
+                return error;
+        }
+    }
+
+    /*增广文法的开始产生式只出现在起始项集中。*/
+    symbol = ctx->symbolArr[ctx->grammar->startSymId];
+    if (!symbol)
+        return -ENOSYM;
+    list_for_each(pos, &symbol->bodyList) {
+        productBody = container_of(pos, ProductBody, node);
+        error = LaWalkProductBody(ctx, 0, -1, symbol, productBody);
+        if (error != -ENOERR)
+            return error;
+    }
+    return error;
+}
+
+/*
+ * 功能：digraph遍历，F(x) = F'(x) ∪ {F(y) | x R y}，同一强连通分量中的转移得到相同的集合。
+ * setArr：输入时为F'，输出时为F。
+ * 返回值：无
+ **/
+static void LaTraverse(LaContext *ctx, int x, LaRelationType relType, uint32_t *setArr)
+{
+    struct list_head *pos;
+    SymId *symId;
+    int depth;
+    int y;
+
+    ctx->stack[ctx->top++] = x;
+    depth = ctx->top;
+    ctx->depthArr[x] = depth;
+
+    list_for_each(pos, &ctx->transArr[x].relList[relType]) {
+        symId = container_of(pos, SymId, node);
+        y = symId->id;
+        if (ctx->depthArr[y] == 0)
+            LaTraverse(ctx, y, relType, setArr);
+        if (ctx->depthArr[y] < ctx->depthArr[x])
+            ctx->depthArr[x] = ctx->depthArr[y];
+        CplBitsetOr(&setArr[x * ctx->words], &setArr[y * ctx->words], ctx->words);
+    }
+
+    /*x是强连通分量的根，分量中的转移共享x的集合。*/
+    if (ctx->depthArr[x] == depth) {
+        do {
+            y = ctx->stack[--ctx->top];
+            ctx->depthArr[y] = LA_DEPTH_INFINITY;
+            if (y != x)
+                CplBitsetCopy(&setArr[y * ctx->words], &setArr[x * ctx->words], ctx->words);
+        } while (y != x);
+    }
+}
+
+static void LaDigraph(LaContext *ctx, LaRelationType relType, uint32_t *setArr)
+{
+    int t;
+
+    memset(ctx->depthArr, 0, ctx->transCnt * sizeof (*ctx->depthArr));
+    ctx->top = 0;
+    for (t = 0; t < ctx->transCnt; t++) {
+        if (ctx->depthArr[t] == 0)
+            LaTraverse(ctx, t, relType, setArr);
+    }
+}
+
+/*
+ * 功能：根据lookback关系生成各归约项的向前看符号集合，并写回项的向前看符号链表。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LaGenItemLookahead(LaContext *ctx)
+{
+    struct list_head *pos;
+    FollowTransmitterItem *lookback;
+    ItemSet *itemSet;
+    Item *item;
+    int t, s;
+    unsigned int bit;
+    int error = 0;
+
+    for (t = 0; t < ctx->transCnt; t++) {
+        list_for_each(pos, &ctx->transArr[t].lookbackList) {
+            lookback = container_of(pos, FollowTransmitterItem, node);
+            CplBitsetOr(&ctx->itemLaSet[lookback->itemSetId][lookback->itemId * ctx->words],
+                        &ctx->followSet[t * ctx->words], ctx->words);
+        }
+    }
+
+    for (s = 0; s < ctx->itemSetCnt; s++) {
+        itemSet = ctx->itemSetArr[s];
+        list_for_each(pos, &itemSet->itemList) {
+            const ProductBody *productBody;
+            const uint32_t *laSet;
+
+            item = container_of(pos, Item, node);
+            productBody = CfgSymbolGetProductBody(ctx->symbolArr[item->productRef.headSymId],
+                                                  item->productRef.bodyId);
+            if (!productBody)
+                return -ENOPDTB;
+            if (item->pos != LaProductBodyToArr(ctx, productBody, NULL))
+                continue;
+            laSet = &ctx->itemLaSet[s][item->id * ctx->words];
+            CfgSymIdListFree(&item->followList);
+            for (bit = 0; bit <= (unsigned int)ctx->grammar->maxSymId; bit++) {
+                if (CplBitsetTest(laSet, bit)) {
+                    error = CfgSymIdListTailAddId(&item->followList, bit);
+                    if (error != -ENOERR)
+                        return error;
+                }
+            }
+        }
+    }
+    return error;
+}
+
+/*
+ * 功能：用DeRemer-Pennello算法生成LR(0)项集族中各归约项的LALR(1)向前看符号。
+ *      调用前项集族和GOTO(I, X)映射节点必须已经生成，FIRST集合必须已经生成。
+ * lalr: lalr
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int LalrGenLookaheadDeRemer(Lalr *lalr)
+{
+    LaContext ctx;
+    int error = 0;
+
+    if (!lalr || !lalr->grammar)
+        return -EINVAL;
+
+    error = LaContextInit(&ctx, lalr);
+    if (error != -ENOERR)
+        goto out;
+    error = LaGenDirectRead(&ctx);
+    if (error != -ENOERR)
+        goto out;
+    /*Read = DR ∪ Read(reads)*/
+    LaDigraph(&ctx, LRT_READS, ctx.readSet);
+
+    /*Follow的初值是Read，开始产生式贡献的结束符号在生成includes关系时加入。*/
+    CplBitsetCopy(ctx.followSet, ctx.readSet, ctx.transCnt * ctx.words);
+    error = LaGenIncludesLookback(&ctx);
+    if (error != -ENOERR)
+        goto out;
+    /*Follow = Read ∪ Follow(includes)*/
+    LaDigraph(&ctx, LRT_INCLUDES, ctx.followSet);
+
+    error = LaGenItemLookahead(&ctx);
+out:
+    if (error != -ENOERR)
+        PrErr("generate lookahead fail: %d", error);
+    LaContextFree(&ctx);
+    return error;
+}
+
+/*
+ * 功能：生成LALR语法分析表。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LaGenParseTable(Lalr **pLalr, ContextFreeGrammar *grammar, LookaheadType type,
+                           GotoNodeConflictHandle *gotoHandle, ActionNodeConflictHandle *actionHandle)
+{
+    int error = 0;
+
+    error = LalrAlloc(pLalr, grammar, gotoHandle, actionHandle);
+    if (error != -ENOERR)
+        return error;
+    LalrSetLookaheadType(*pLalr, type);
+    error = LalrGenItemSet(*pLalr);
+    if (error != -ENOERR)
+        return error;
+    return LalrGenParseTable(*pLalr);
+}
+
+/*
+ * 功能：分别用传播关系算法和DeRemer-Pennello算法生成文法的LALR语法分析表，检查两者是否相同。
+ * grammar: 文法
+ * gotoHandle、actionHandle：冲突处理函数，与正式生成语法分析表时相同。
+ * 返回值：两张语法分析表相同时返回0，否则返回错误码。
+ **/
+int LalrCheckLookahead(ContextFreeGrammar *grammar, GotoNodeConflictHandle *gotoHandle,
+                       ActionNodeConflictHandle *actionHandle)
+{
+    Lalr *propagateLalr = NULL;
+    Lalr *deRemerLalr = NULL;
+    int error = 0;
+
+    if (!grammar)
+        return -EINVAL;
+
+    error = LaGenParseTable(&propagateLalr, grammar, LLT_PROPAGATE, gotoHandle, actionHandle);
+    if (error != -ENOERR)
+        goto out;
+    error = LaGenParseTable(&deRemerLalr, grammar, LLT_DEREMER_PENNELLO, gotoHandle, actionHandle);
+    if (error != -ENOERR)
+        goto out;
+    if (LalrParseTableIsEqual(propagateLalr, deRemerLalr) != 1) {
+        PrErr("lookahead check fail: parse tables are different");
+        error = -EMISC;
+    } else {
+        PrDbg("lookahead check pass: %d item sets", deRemerLalr->itemSetNum);
+    }
+out:
+    if (propagateLalr)
+        LalrFree(propagateLalr);
+    if (deRemerLalr)
+        LalrFree(deRemerLalr);
+    return error;
+}
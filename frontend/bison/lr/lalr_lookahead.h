@@ -0,0 +1,18 @@
+#ifndef __LALR_LOOKAHEAD_H__
+#define __LALR_LOOKAHEAD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lalr_parse_table.h"
+
+int LalrGenLookaheadDeRemer(Lalr *lalr);
+int LalrCheckLookahead(ContextFreeGrammar *grammar, GotoNodeConflictHandle *gotoHandle,
+                       ActionNodeConflictHandle *actionHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__LALR_LOOKAHEAD_H__*/
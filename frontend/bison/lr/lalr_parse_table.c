@@ -1,14 +1,30 @@
 #include "lalr_parse_table.h"
 #include "context_free_grammar.h"
 #include "first_follow.h"
+#include "lalr_lookahead.h"
 #include "list.h"
 #include "cpl_debug.h"
 #include "cpl_errno.h"
 #include "stdlib.h"
 #include "string.h"
 
+/*
+ * 多线程构造LR(0)项集族，需要链接pthread库。
+ * 编译时定义LALR_NO_PARALLEL则总是单线程构造，LalrSetThreadNum设置的线程数不起作用。
+ **/
+#ifndef LALR_NO_PARALLEL
+#define LALR_PARALLEL
+#endif
+
+#ifdef LALR_PARALLEL
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 #define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
 
+#define LALR_CORE_HASH_INIT_SIZE    256     /*项集核心散列表的初始桶数*/
+
 #define LPT_DEBUG
 #ifdef LPT_DEBUG
 #define PrDbg(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "debug", __VA_ARGS__)
@@ -36,13 +52,16 @@ static int LrItemIsContainTransmitterItem(const Item *item, int itemSetId, int i
 }
 
 /*
- * 功能：给项item添加一个向前看符号传播关系节点
+ * 功能：给项item添加一个向前看符号传播关系节点，节点从传播关系的区域分配器中申请，
+ *      生成语法分析表后整体释放。
+ * arena：为NULL时使用传播关系的区域分配器，候选项集的传播关系节点从候选项集的分配器中申请，
+ *      随候选项集一起丢弃。
  * item：项
  * itemSet: 项集id
  * itemId: 项id
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int LrItemAddFollowTransmitterItem(Item *item, int itemSetId, int itemId)
+static int LrItemAddFollowTransmitterItem(Lalr *lalr, CplArena *arena, Item *item, int itemSetId, int itemId)
 {
     FollowTransmitterItem *transmitter;
 
@@ -51,7 +70,15 @@ static int LrItemAddFollowTransmitterItem(Item *item, int itemSetId, int itemId)
     if (LrItemIsContainTransmitterItem(item, itemSetId, itemId) == 1)
         return 0;
 
-    transmitter = malloc(sizeof (*transmitter));
+    if (!arena) {
+        if (!lalr->transmitterArena) {
+            lalr->transmitterArena = CplArenaCreate(0);
+            if (!lalr->transmitterArena)
+                return -ENOMEM;
+        }
+        arena = lalr->transmitterArena;
+    }
+    transmitter = CplArenaAlloc(arena, sizeof (*transmitter));
     if (!transmitter)
         return -ENOMEM;
     transmitter->itemSetId = itemSetId;
@@ -61,36 +88,19 @@ static int LrItemAddFollowTransmitterItem(Item *item, int itemSetId, int itemId)
 }
 
 /*
- * 功能：释放项的传播关系链表
- * list：传播关系链表
- * 返回值：无
- **/
-static void LrItemFreeTransmitterItemList(struct list_head *list)
-{
-    struct list_head *pos;
-    FollowTransmitterItem *transmitter;
-
-    for (pos = list->next; pos != list; ) {
-        transmitter = container_of(pos, FollowTransmitterItem, node);
-        pos = pos->next;
-        list_del(&transmitter->node);
-        free(transmitter);
-    }
-}
-
-/*
- * 功能：申请项资源
+ * 功能：从区域分配器中申请项资源
+ * arena：项所在项集的区域分配器
  * itemId：项id
  * headSymId：产生式头符号id
  * bodyId: 产生式体id
  * pos: 点的位置
  * 返回值：成功时返回项指针，否则返回NULL。
  **/
-static Item *LrAllocItem(int itemId, int headSymId, int bodyId, unsigned int pos)
+static Item *LrAllocItem(CplArena *arena, int itemId, int headSymId, int bodyId, unsigned int pos)
 {
     Item *item;
 
-    item = malloc(sizeof (*item));
+    item = CplArenaAlloc(arena, sizeof (*item));
     if (item) {
         item->id = itemId;
         item->pos = pos;
@@ -103,21 +113,7 @@ static Item *LrAllocItem(int itemId, int headSymId, int bodyId, unsigned int pos
 }
 
 /*
- * 功能：释放项资源
- * item：项
- * 返回值：无
- **/
-static void LrFreeItem(Item *item)
-{
-    if (!item)
-        return;
-    CfgSymIdListFree(&item->followList);
-    LrItemFreeTransmitterItemList(&item->transmitterList);
-    free(item);
-}
-
-/*
- * 功能：释放项集中的项链表
+ * 功能：释放项集中各项的向前看符号链表，项本身在区域分配器中，随分配器一起释放。
  * list: 项链表
  * 返回值：无
  **/
@@ -126,26 +122,25 @@ static void LrItemSetFreeItemList(struct list_head *list)
     struct list_head *pos;
     Item *item;
 
-    for (pos = list->next; pos != list; ) {
+    list_for_each(pos, list) {
         item = container_of(pos, Item, node);
-        pos = pos->next;
-        list_del(&item->node);
-        LrFreeItem(item);
-        item = NULL;
+        CfgSymIdListFree(&item->followList);
     }
+    INIT_LIST_HEAD(list);
 }
 
 /*
  * 功能：申请项集GOTO(I, X)节点
+ * arena: 区域分配器
  * symId: 文法符号id
  * itemSetId: 项集id
  * 返回值：成功时返回项集GOTO(I, X)节点指针，否则返回NULL
  **/
-static MapNode *LrAllocMapNode(int symId, int itemSetId)
+static MapNode *LrAllocMapNode(CplArena *arena, int symId, int itemSetId)
 {
     MapNode *mapNode;
 
-    mapNode = malloc(sizeof (*mapNode));
+    mapNode = CplArenaAlloc(arena, sizeof (*mapNode));
     if (mapNode) {
         mapNode->symId = symId;
         mapNode->itemSetId = itemSetId;
@@ -153,36 +148,19 @@ static MapNode *LrAllocMapNode(int symId, int itemSetId)
     return mapNode;
 }
 
-/*
- * 功能：释放项集中的GOTO(I, X)节点链表
- * list: GOTO(I, X)节点链表
- * 返回值：无
- **/
-static void LrItemSetFreeMapList(struct list_head *list)
-{
-    struct list_head *pos;
-    MapNode *mapNode;
-
-    for (pos = list->next; pos != list; ) {
-        mapNode = container_of(pos, MapNode, node);
-        pos = pos ->next;
-        free(mapNode);
-        mapNode = NULL;
-    }
-}
-
 /*
  * 功能：申请ACTION节点
+ * arena: 区域分配器
  * type: 动作类型
  * lookaheadId：向前看符号
  * id: 项集id或者项id
  * 返回值：成功时返回ACTION指针，否则返回NULL。
  **/
-static ActionNode *LrAllocActionNode(ActionType type, int lookaheadId, int id)
+static ActionNode *LrAllocActionNode(CplArena *arena, ActionType type, int lookaheadId, int id)
 {
     ActionNode *actionNode;
 
-    actionNode = malloc(sizeof (*actionNode));
+    actionNode = CplArenaAlloc(arena, sizeof (*actionNode));
     if (actionNode) {
         actionNode->type = type;
         actionNode->lookaheadId = lookaheadId;
@@ -196,35 +174,18 @@ static ActionNode *LrAllocActionNode(ActionType type, int lookaheadId, int id)
     return actionNode;
 }
 
-/*
- * 功能：释放项集中的ACTION链表
- * list: ACTION链表
- * 返回值：无
- **/
-static void LrItemSetFreeActionList(struct list_head *list)
-{
-    struct list_head *pos;
-    ActionNode *actionNode;
-
-    for (pos = list->next; pos != list; ) {
-        actionNode = container_of(pos, ActionNode, node);
-        pos = pos->next;
-        list_del(&actionNode->node);
-        free(actionNode);
-    }
-}
-
 /*
  * 功能：申请GOTO节点
+ * arena: 区域分配器
  * symId: 文法符号
  * nextItemSetId：下一个项集id
  * 返回值：成功时返回GOTO节点指针，否则返回NULL。
  **/
-static GotoNode *LrAllocGotoNode(int symId, int nextItemSetId)
+static GotoNode *LrAllocGotoNode(CplArena *arena, int symId, int nextItemSetId)
 {
     GotoNode *gotoNode;
 
-    gotoNode = malloc(sizeof (*gotoNode));
+    gotoNode = CplArenaAlloc(arena, sizeof (*gotoNode));
     if (gotoNode) {
         gotoNode->symId = symId;
         gotoNode->nextItemSetId = nextItemSetId;
@@ -233,46 +194,34 @@ static GotoNode *LrAllocGotoNode(int symId, int nextItemSetId)
 }
 
 /*
- * 功能：释放项集的GOTO链表
- * list: GOTO链表
- * 返回值：无
- **/
-static void LrItemSetFreeGotoList(struct list_head *list)
-{
-    struct list_head *pos;
-    GotoNode *gotoNode;
-
-    for (pos = list->next; pos != list; ) {
-        gotoNode = container_of(pos, GotoNode, node);
-        pos = pos->next;
-        list_del(&gotoNode->node);
-        free(gotoNode);
-    }
-}
-
-/*
- * 功能：申请项集资源
+ * 功能：从区域分配器中申请项集资源，项集的项、映射节点、ACTION和GOTO节点都从同一个分配器中申请。
+ * arena: 区域分配器
  * id: 项集id
  * 返回值：成功时返回项集指针，否则返回NULL。
  **/
-static ItemSet *LrAllocItemSet(int id)
+static ItemSet *LrAllocItemSet(CplArena *arena, int id)
 {
     ItemSet *itemSet;
 
-    itemSet = malloc(sizeof (*itemSet));
+    itemSet = CplArenaAlloc(arena, sizeof (*itemSet));
     if (itemSet) {
+        itemSet->arena = arena;
         itemSet->id = id;
         itemSet->itemNum = 0;
         INIT_LIST_HEAD(&itemSet->itemList);
         INIT_LIST_HEAD(&itemSet->mapList);
         INIT_LIST_HEAD(&itemSet->actionList);
         INIT_LIST_HEAD(&itemSet->gotoList);
+        INIT_LIST_HEAD(&itemSet->hashNode);
+        itemSet->coreHash = 0;
+        itemSet->coreNum = 0;
+        itemSet->coreArr = NULL;
     }
     return itemSet;
 }
 
 /*
- * 功能：释放项集资源
+ * 功能：释放项集资源。只释放不在区域分配器中的向前看符号链表，项集占用的区域内存随分配器回收。
  * itemSet：项集
  * 返回值：无
  **/
@@ -281,11 +230,18 @@ static void LrFreeItemSet(ItemSet *itemSet)
     if (!itemSet)
         return;
     LrItemSetFreeItemList(&itemSet->itemList);
-    LrItemSetFreeMapList(&itemSet->itemList);
-    LrItemSetFreeActionList(&itemSet->actionList);
-    LrItemSetFreeGotoList(&itemSet->gotoList);
-    free(itemSet);
-    itemSet = NULL;
+}
+
+/*
+ * 功能：丢弃在临时分配器中生成的候选项集，重置临时分配器。临时分配器中同时只有一个候选项集。
+ * 返回值：无
+ **/
+static void LrDiscardItemSet(ItemSet *itemSet)
+{
+    CplArena *arena = itemSet->arena;
+
+    LrFreeItemSet(itemSet);
+    CplArenaReset(arena);
 }
 
 /*
@@ -307,9 +263,63 @@ static void LrFreeItemSetList(struct list_head *list)
     }
 }
 
+/*
+ * 功能：给每个构造线程准备一个区域分配器和一个临时分配器，当前线程使用下标0。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LalrPrepareArena(Lalr *lalr, int num)
+{
+    CplArena **arenaArr;
+    int n;
+
+    if (num <= lalr->arenaNum)
+        return 0;
+    arenaArr = realloc(lalr->arenaArr, num * sizeof (*arenaArr));
+    if (!arenaArr)
+        return -ENOMEM;
+    lalr->arenaArr = arenaArr;
+    arenaArr = realloc(lalr->scratchArenaArr, num * sizeof (*arenaArr));
+    if (!arenaArr)
+        return -ENOMEM;
+    lalr->scratchArenaArr = arenaArr;
+    for (; lalr->arenaNum < num; lalr->arenaNum++) {
+        n = lalr->arenaNum;
+        lalr->arenaArr[n] = CplArenaCreate(0);
+        lalr->scratchArenaArr[n] = CplArenaCreate(0);
+        if (!lalr->arenaArr[n] || !lalr->scratchArenaArr[n]) {
+            CplArenaDestroy(lalr->arenaArr[n]);
+            CplArenaDestroy(lalr->scratchArenaArr[n]);
+            return -ENOMEM;
+        }
+    }
+    return 0;
+}
+
+/*
+ * 功能：释放构造过程中的所有区域分配器。
+ * 返回值：无
+ **/
+static void LalrFreeArena(Lalr *lalr)
+{
+    int i;
+
+    for (i = 0; i < lalr->arenaNum; i++) {
+        CplArenaDestroy(lalr->arenaArr[i]);
+        CplArenaDestroy(lalr->scratchArenaArr[i]);
+    }
+    CplArenaDestroy(lalr->transmitterArena);
+    free(lalr->arenaArr);
+    free(lalr->scratchArenaArr);
+    lalr->arenaArr = NULL;
+    lalr->scratchArenaArr = NULL;
+    lalr->arenaNum = 0;
+    lalr->transmitterArena = NULL;
+}
+
 int LalrAlloc(Lalr **pLalr, ContextFreeGrammar *grammar, GotoNodeConflictHandle *gotoHandle, ActionNodeConflictHandle *actionHandle)
 {
     Lalr *lalr;
+    unsigned int i;
 
     if (!pLalr || !grammar)
         return -EINVAL;
@@ -325,15 +335,67 @@ int LalrAlloc(Lalr **pLalr, ContextFreeGrammar *grammar, GotoNodeConflictHandle
     lalr->actionNodeConflictHandle = actionHandle;
     lalr->itemSetNum = 0;
     lalr->grammar = grammar;
+    lalr->lookaheadType = LLT_PROPAGATE;
+    lalr->threadNum = 1;
+    lalr->coreHashSize = LALR_CORE_HASH_INIT_SIZE;
+    lalr->transmitterArena = NULL;
+    lalr->tableArena = NULL;
+    lalr->arenaArr = NULL;
+    lalr->scratchArenaArr = NULL;
+    lalr->arenaNum = 0;
+    lalr->coreHashTable = malloc(lalr->coreHashSize * sizeof (*lalr->coreHashTable));
+    if (!lalr->coreHashTable || LalrPrepareArena(lalr, 1) != -ENOERR) {
+        LalrFreeArena(lalr);
+        free(lalr->coreHashTable);
+        free(lalr);
+        *pLalr = NULL;
+        return -ENOMEM;
+    }
+    for (i = 0; i < lalr->coreHashSize; i++)
+        INIT_LIST_HEAD(&lalr->coreHashTable[i]);
     return 0;
 }
 
 void LalrFree(Lalr *lalr)
 {
     LrFreeItemSetList(&lalr->itemSetList);
+    LalrFreeArena(lalr);
+    CplArenaDestroy(lalr->tableArena);
+    free(lalr->coreHashTable);
     free(lalr);
 }
 
+/*
+ * 功能：设置向前看符号的生成算法，必须在LalrGenItemSet之前调用。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int LalrSetLookaheadType(Lalr *lalr, LookaheadType type)
+{
+    if (!lalr || (type != LLT_PROPAGATE && type != LLT_DEREMER_PENNELLO))
+        return -EINVAL;
+    if (!list_empty(&lalr->itemSetList))
+        return -EMISC;
+    lalr->lookaheadType = type;
+    return 0;
+}
+
+/*
+ * 功能：设置构造LR(0)项集族的线程数，threadNum小于等于0时使用CPU核数。
+ *      只有DeRemer-Pennello算法才并行构造，传播关系算法需要反复合并向前看符号，仍然单线程构造。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int LalrSetThreadNum(Lalr *lalr, int threadNum)
+{
+    if (!lalr)
+        return -EINVAL;
+#ifdef LALR_PARALLEL
+    if (threadNum <= 0)
+        threadNum = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    lalr->threadNum = threadNum > 0 ? threadNum : 1;
+    return 0;
+}
+
 /*
  * 功能：获取项中点(.)右边的文法符号id
  * grammar: 文法
@@ -453,7 +515,7 @@ static int LrItemSetAddItem(ItemSet *itemSet, int headSymId, int bodyId, int pos
             return CfgSymIdSetAddList(&item->followList, followList);
         }
     } else {
-        item = LrAllocItem(itemSet->itemNum++, headSymId, bodyId, pos);
+        item = LrAllocItem(itemSet->arena, itemSet->itemNum++, headSymId, bodyId, pos);
         if (!item) {
             return -ENOMEM;
         }
@@ -491,7 +553,7 @@ static int LrItemSetAddItemUpdateFlag(Lalr *lalr, ItemSet *itemSet, Item *transm
         }
     } else {
         *flag = 1;
-        item = LrAllocItem(itemSet->itemNum++, headSymId, bodyId, pos);
+        item = LrAllocItem(itemSet->arena, itemSet->itemNum++, headSymId, bodyId, pos);
         if (!item) {
             return -ENOMEM;
         }
@@ -502,7 +564,8 @@ static int LrItemSetAddItemUpdateFlag(Lalr *lalr, ItemSet *itemSet, Item *transm
     }
     /*如果待添加项的向前看符号链表中包含了传播符号，则给父项添加一个传播关系节点*/
     if (CfgSymIdSetIsContain(followList, lalr->grammar->maxSymId) == 1) {
-        error = LrItemAddFollowTransmitterItem(transmitterItem, itemSet->id, item->id);
+        error = LrItemAddFollowTransmitterItem(lalr, itemSet->arena == lalr->scratchArenaArr[0] ? itemSet->arena : NULL,
+                                               transmitterItem, itemSet->id, item->id);
         if (error != -ENOERR)
             return error;
     }
@@ -651,10 +714,12 @@ static int LrItemSetExtendByNonterminal(Lalr *lalr, ItemSet *itemSet, const Symb
     }
 
     INIT_LIST_HEAD(&newFollowList);
-    /*创建新项的向前看符号链表*/
-    error = LrItemGenFollow(lalr, betaSymIdList, &maxSymIdFollow, &newFollowList);
-    if (error != -ENOERR) {
-        goto err0;
+    /*创建新项的向前看符号链表，DeRemer-Pennello算法只需要LR(0)项集族，之后再统一计算向前看符号。*/
+    if (lalr->lookaheadType == LLT_PROPAGATE) {
+        error = LrItemGenFollow(lalr, betaSymIdList, &maxSymIdFollow, &newFollowList);
+        if (error != -ENOERR) {
+            goto err0;
+        }
     }
 
     *updateFlag = 0;
@@ -740,6 +805,10 @@ int LrClosure(Lalr *lalr, ItemSet *itemSet)
     return 0;
 }
 
+static int LrItemSetGenCore(Lalr *lalr, ItemSet *itemSet);
+static int LrAddItemSet(Lalr *lalr, ItemSet *itemSet);
+static ItemSet *LrGetItemSetByItemSetCore(Lalr *lalr, ItemSet *itemSet);
+
 /*
  * 功能：生成起始项集。
  * grammar: 文法
@@ -751,19 +820,25 @@ static int LrGenStartItemSet(Lalr *lalr)
     Item *item;
     int error = 0;
 
-    itemSet = LrAllocItemSet(lalr->itemSetNum++);
+    itemSet = LrAllocItemSet(lalr->arenaArr[0], lalr->itemSetNum);
     if (!itemSet) {
         return -ENOMEM;
     }
-    list_add_tail(&itemSet->node, &lalr->itemSetList);
-    item = LrAllocItem(itemSet->itemNum++, lalr->grammar->startSymId, 0, 0);
+    item = LrAllocItem(itemSet->arena, itemSet->itemNum++, lalr->grammar->startSymId, 0, 0);
     if (!item) {
+        LrFreeItemSet(itemSet);
         return -ENOMEM;
     }
     list_add_tail(&item->node, &itemSet->itemList);
     error = CfgSymIdSetAddId(&item->followList, lalr->grammar->endSymId);
-    if (error != -ENOERR)
+    if (error == -ENOERR)
+        error = LrItemSetGenCore(lalr, itemSet);
+    if (error == -ENOERR)
+        error = LrAddItemSet(lalr, itemSet);
+    if (error != -ENOERR) {
+        LrFreeItemSet(itemSet);
         return error;
+    }
 
     return LrClosure(lalr, itemSet);
 }
@@ -803,7 +878,7 @@ static int LrItemSetAddMap(ItemSet *itemSet, int symId, int itemSetId)
 
     if (LrItemSetIsContainMapNode(itemSet, symId, itemSetId) == 1)
         return 0;
-    mapNode = LrAllocMapNode(symId, itemSetId);
+    mapNode = LrAllocMapNode(itemSet->arena, symId, itemSetId);
     if (!mapNode) {
         return -ENOMEM;
     }
@@ -875,17 +950,14 @@ static int LrItemSetAddFollowByItemSet(ItemSet *lItemSet, const ItemSet *rItemSe
     return error;
 }
 
-static ItemSet *LrGetItemSetByItemSetCore(Lalr *lalr, ItemSet *itemSet);
-
 /*
- * 功能：创建LR文法的GOTO(I, X)函数映射表
- * grammar: 文法
- * itemSet: 项集
- * symId: 符号id
- * updateFlag: 如果添加了新节点则updateFlag置1，否则置0
+ * 功能：生成项集itemSet在符号symId上的后继项集的核心，不计算闭包。
+ * arena：后继项集使用的区域分配器，并行构造时每个线程一个。
+ * pAlphaItemSet：输出型参数，后继项集，不存在后继项集时为NULL。
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int LrItemSetGotoBySymId(Lalr *lalr, ItemSet *itemSet, int symId, char *updateFlag)
+static int LrItemSetGenGotoCore(Lalr *lalr, CplArena *arena, const ItemSet *itemSet, int symId,
+                                ItemSet **pAlphaItemSet)
 {
     ItemSet *alphaItemSet;
     int error = 0;
@@ -893,9 +965,9 @@ static int LrItemSetGotoBySymId(Lalr *lalr, ItemSet *itemSet, int symId, char *u
     const Item *item;
     char has = 0;
 
-    *updateFlag = 0;
+    *pAlphaItemSet = NULL;
     /*申请新项集alpha*/
-    alphaItemSet = LrAllocItemSet(lalr->itemSetNum);
+    alphaItemSet = LrAllocItemSet(arena, lalr->itemSetNum);
     if (!alphaItemSet) {
         return -ENOMEM;
     }
@@ -916,39 +988,79 @@ static int LrItemSetGotoBySymId(Lalr *lalr, ItemSet *itemSet, int symId, char *u
             has = 1;
         }
     }
-    /*如果找到一个符号的项则计算新项集alpha的闭包，如果项集族中不存在这个项集alpha则添加到项集族。
-      创建项集itemSet在符号symId上的下一个项集nextItemSet的GOTO(I, X)节点。*/
-    if (has == 1) {
-        ItemSet *nextItemSet;
+    if (has == 0) {
+        LrFreeItemSet(alphaItemSet);
+        return 0;
+    }
+    error = LrItemSetGenCore(lalr, alphaItemSet);
+    if (error != -ENOERR) {
+        LrFreeItemSet(alphaItemSet);
+        return error;
+    }
+    *pAlphaItemSet = alphaItemSet;
+    return 0;
+}
 
-        error = LrClosure(lalr, alphaItemSet);
-        if (error != -ENOERR) {
-            LrFreeItemSet(alphaItemSet);
+/*
+ * 功能：创建LR文法的GOTO(I, X)函数映射表
+ * grammar: 文法
+ * itemSet: 项集
+ * symId: 符号id
+ * updateFlag: 如果添加了新节点则updateFlag置1，否则置0
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrItemSetGotoBySymId(Lalr *lalr, ItemSet *itemSet, int symId, char *updateFlag)
+{
+    ItemSet *alphaItemSet;
+    ItemSet *nextItemSet;
+    int error = 0;
+
+    *updateFlag = 0;
+    /*候选项集先在临时分配器中生成，大多数候选和已有项集重复，丢弃时重置临时分配器。*/
+    error = LrItemSetGenGotoCore(lalr, lalr->scratchArenaArr[0], itemSet, symId, &alphaItemSet);
+    if (error != -ENOERR || !alphaItemSet)
+        return error;
+
+    /*闭包不改变项集的核心，先用核心寻找项集族中跟项集alpha核心相同的项集。*/
+    nextItemSet = LrGetItemSetByItemSetCore(lalr, alphaItemSet);
+    /*DeRemer-Pennello算法不需要合并向前看符号，已有的项集不必再计算闭包。*/
+    if (nextItemSet && lalr->lookaheadType == LLT_DEREMER_PENNELLO) {
+        LrDiscardItemSet(alphaItemSet);
+        return LrItemSetAddMap(itemSet, symId, nextItemSet->id);
+    }
+    /*新项集要留在项集族中，在正式的分配器中重新生成。*/
+    if (!nextItemSet) {
+        LrDiscardItemSet(alphaItemSet);
+        error = LrItemSetGenGotoCore(lalr, lalr->arenaArr[0], itemSet, symId, &alphaItemSet);
+        if (error != -ENOERR)
             return error;
-        }
+    }
 
-        /*寻找项集族中跟项集alpha核心相同的项集*/
-        nextItemSet = LrGetItemSetByItemSetCore(lalr, alphaItemSet);
-        if (!nextItemSet) {
-            *updateFlag = 1;
-            list_add_tail(&alphaItemSet->node, &lalr->itemSetList);
-            lalr->itemSetNum++;
-            nextItemSet = alphaItemSet;
-        } else {
-            error = LrItemSetAddFollowByItemSet(nextItemSet, alphaItemSet, updateFlag);
+    /*计算新项集alpha的闭包，如果项集族中不存在这个项集alpha则添加到项集族。*/
+    error = LrClosure(lalr, alphaItemSet);
+    if (error != -ENOERR) {
+        LrFreeItemSet(alphaItemSet);
+        return error;
+    }
+
+    if (!nextItemSet) {
+        error = LrAddItemSet(lalr, alphaItemSet);
+        if (error != -ENOERR) {
             LrFreeItemSet(alphaItemSet);
-            if (error != -ENOERR) {
-                return error;
-            }
+            return error;
         }
-        /*创建项集itemSet在符号symId上的下一个项集nextItemSet的GOTO(I, X)节点。*/
-        error = LrItemSetAddMap(itemSet, symId, nextItemSet->id);
+        *updateFlag = 1;
+        nextItemSet = alphaItemSet;
+    } else {
+        /*传播关系算法每一轮都要重新计算已有项集的闭包，合并向前看符号后丢弃候选。*/
+        error = LrItemSetAddFollowByItemSet(nextItemSet, alphaItemSet, updateFlag);
+        LrDiscardItemSet(alphaItemSet);
         if (error != -ENOERR) {
             return error;
         }
     }
-
-    return error;
+    /*创建项集itemSet在符号symId上的下一个项集nextItemSet的GOTO(I, X)节点。*/
+    return LrItemSetAddMap(itemSet, symId, nextItemSet->id);
 }
 
 /*
@@ -1009,23 +1121,65 @@ static int LrItemSetGetNextSymIdList(Lalr *lalr, ItemSet *itemSet, struct list_h
 }
 
 /*
- * 功能：判断项集lItemSet的核心是否包含了项集rItemSet的核心
- * lItemSet：左项集
- * rItemSet：右项集
- * 返回值：如果项集lItemSet的核心包含了项集rItemSet的核心返回1，否则返回0。
+ * 功能：比较两个项的核心，用于排序。
+ * 返回值：小于、等于、大于时分别返回负数、0、正数。
  **/
-static int LrItemSetCoreIsContain(const ItemSet *lItemSet, const ItemSet *rItemSet)
+static int LrCoreItemCmp(const void *lCore, const void *rCore)
 {
-    const struct list_head *pos;
+    const int *l = lCore;
+    const int *r = rCore;
+
+    if (l[0] != r[0])
+        return l[0] < r[0] ? -1 : 1;
+    if (l[1] != r[1])
+        return l[1] < r[1] ? -1 : 1;
+    if (l[2] != r[2])
+        return l[2] < r[2] ? -1 : 1;
+    return 0;
+}
+
+/*
+ * 功能：生成项集的核心，即点不在最左边的项和增广文法的开始项，排序后计算散列值。
+ *      核心在加入闭包项之前或者之后生成都一样，因为闭包项的点都在最左边。
+ * itemSet：项集
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrItemSetGenCore(Lalr *lalr, ItemSet *itemSet)
+{
+    struct list_head *pos;
     const Item *item;
+    unsigned int hash = 2166136261u;
+    int i, n = 0;
 
-    list_for_each(pos, &rItemSet->itemList) {
+    list_for_each(pos, &itemSet->itemList) {
         item = container_of(pos, Item, node);
-        if (LrItemSetIsContainCore(lItemSet, item->productRef.headSymId,
-                                    item->productRef.bodyId, item->pos) == 0)
-            return 0;
+        if (item->pos != 0 || item->productRef.headSymId == lalr->grammar->startSymId)
+            n++;
     }
-    return 1;
+    itemSet->coreArr = CplArenaAlloc(itemSet->arena, (n ? n : 1) * 3 * sizeof (*itemSet->coreArr));
+    if (!itemSet->coreArr)
+        return -ENOMEM;
+    itemSet->coreNum = n;
+
+    n = 0;
+    list_for_each(pos, &itemSet->itemList) {
+        item = container_of(pos, Item, node);
+        if (item->pos != 0 || item->productRef.headSymId == lalr->grammar->startSymId) {
+            itemSet->coreArr[n * 3] = item->productRef.headSymId;
+            itemSet->coreArr[n * 3 + 1] = item->productRef.bodyId;
+            itemSet->coreArr[n * 3 + 2] = item->pos;
+            n++;
+        }
+    }
+    qsort(itemSet->coreArr, n, 3 * sizeof (*itemSet->coreArr), LrCoreItemCmp);
+
+    /*FNV-1a*/
+    for (i = 0; i < n * 3; i++) {
+        hash ^= (unsigned int)itemSet->coreArr[i];
+        hash *= 16777619u;
+    }
+    itemSet->coreHash = hash;
+    return 0;
 }
 
 /*
@@ -1036,15 +1190,62 @@ static int LrItemSetCoreIsContain(const ItemSet *lItemSet, const ItemSet *rItemS
  **/
 static int LrItemSetIsCoreEqual(const ItemSet *lItemSet, const ItemSet *rItemSet)
 {
-    if (LrItemSetCoreIsContain(lItemSet, rItemSet) == 1
-            && LrItemSetCoreIsContain(rItemSet, lItemSet) == 1)
-        return 1;
-    else
-        return 0;
+    return lItemSet->coreHash == rItemSet->coreHash
+            && lItemSet->coreNum == rItemSet->coreNum
+            && memcmp(lItemSet->coreArr, rItemSet->coreArr,
+                      lItemSet->coreNum * 3 * sizeof (*lItemSet->coreArr)) == 0;
+}
+
+/*
+ * 功能：散列表的桶数不够时扩大为原来的2倍，重新散列所有项集。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrCoreHashTableGrow(Lalr *lalr)
+{
+    struct list_head *table;
+    unsigned int size;
+    unsigned int i;
+    struct list_head *pos;
+    ItemSet *itemSet;
+
+    size = lalr->coreHashSize * 2;
+    table = malloc(size * sizeof (*table));
+    if (!table)
+        return -ENOMEM;
+    for (i = 0; i < size; i++)
+        INIT_LIST_HEAD(&table[i]);
+    list_for_each(pos, &lalr->itemSetList) {
+        itemSet = container_of(pos, ItemSet, node);
+        list_del(&itemSet->hashNode);
+        list_add_tail(&itemSet->hashNode, &table[itemSet->coreHash & (size - 1)]);
+    }
+    free(lalr->coreHashTable);
+    lalr->coreHashTable = table;
+    lalr->coreHashSize = size;
+    return 0;
+}
+
+/*
+ * 功能：把项集加入项集族，同时加入核心散列表。项集的核心必须已经生成。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrAddItemSet(Lalr *lalr, ItemSet *itemSet)
+{
+    int error = 0;
+
+    if ((unsigned int)lalr->itemSetNum >= lalr->coreHashSize) {
+        error = LrCoreHashTableGrow(lalr);
+        if (error != -ENOERR)
+            return error;
+    }
+    list_add_tail(&itemSet->node, &lalr->itemSetList);
+    list_add_tail(&itemSet->hashNode, &lalr->coreHashTable[itemSet->coreHash & (lalr->coreHashSize - 1)]);
+    lalr->itemSetNum++;
+    return 0;
 }
 
 /*
- * 功能：找到一个项集族中和项集itemSet核心相同的项集
+ * 功能：找到一个项集族中和项集itemSet核心相同的项集，项集itemSet的核心必须已经生成。
  * grammar: 文法
  * itemSet项集
  * 返回值：如果存在返回项集族中和项集itemSet核心相同的项集，否则返回NULL。
@@ -1052,10 +1253,12 @@ static int LrItemSetIsCoreEqual(const ItemSet *lItemSet, const ItemSet *rItemSet
 static ItemSet *LrGetItemSetByItemSetCore(Lalr *lalr, ItemSet *itemSet)
 {
     struct list_head *pos;
+    struct list_head *bucket;
     ItemSet *iter;
 
-    list_for_each(pos, &lalr->itemSetList) {
-        iter = container_of(pos, ItemSet, node);
+    bucket = &lalr->coreHashTable[itemSet->coreHash & (lalr->coreHashSize - 1)];
+    list_for_each(pos, bucket) {
+        iter = container_of(pos, ItemSet, hashNode);
         if (LrItemSetIsCoreEqual(iter, itemSet) == 1) {
             return iter;
         }
@@ -1070,7 +1273,7 @@ static ItemSet *LrGetItemSetByItemSetCore(Lalr *lalr, ItemSet *itemSet)
  * gotoItem：GOTO(I, X)项集中的项
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int LrItemSetGenTransmitterByGotoItem(ItemSet *itemSet, ItemSet *gotoItemSet, Item *gotoItem)
+static int LrItemSetGenTransmitterByGotoItem(Lalr *lalr, ItemSet *itemSet, ItemSet *gotoItemSet, Item *gotoItem)
 {
     struct list_head *pos;
     Item *item;
@@ -1081,7 +1284,7 @@ static int LrItemSetGenTransmitterByGotoItem(ItemSet *itemSet, ItemSet *gotoItem
         if (item->productRef.headSymId == gotoItem->productRef.headSymId
                 && item->productRef.bodyId == gotoItem->productRef.bodyId
                 && item->pos + 1 == gotoItem->pos) {
-            error = LrItemAddFollowTransmitterItem(item, gotoItemSet->id, gotoItem->id);
+            error = LrItemAddFollowTransmitterItem(lalr, NULL, item, gotoItemSet->id, gotoItem->id);
             if (error != -ENOERR)
                 return error;
         }
@@ -1096,7 +1299,7 @@ static int LrItemSetGenTransmitterByGotoItem(ItemSet *itemSet, ItemSet *gotoItem
  * gotoItemSet：GOTO(I, X)项集
  * 返回值：成功时返回0，否则返回错误码。
  **/
-static int LrItemSetGenTransmitterByGotoItemSet(ItemSet *itemSet, ItemSet *gotoItemSet)
+static int LrItemSetGenTransmitterByGotoItemSet(Lalr *lalr, ItemSet *itemSet, ItemSet *gotoItemSet)
 {
     struct list_head *pos;
     Item *item;
@@ -1105,7 +1308,7 @@ static int LrItemSetGenTransmitterByGotoItemSet(ItemSet *itemSet, ItemSet *gotoI
     list_for_each(pos, &gotoItemSet->itemList) {
         item = container_of(pos, Item, node);
         if (item->pos != 0) {
-            error = LrItemSetGenTransmitterByGotoItem(itemSet, gotoItemSet, item);
+            error = LrItemSetGenTransmitterByGotoItem(lalr, itemSet, gotoItemSet, item);
             if (error != -ENOERR)
                 return error;
         }
@@ -1123,60 +1326,18 @@ static int LrItemSetGenTransmitterByGotoItemSet(ItemSet *itemSet, ItemSet *gotoI
 static int LrItemGenTransmitterList(Lalr *lalr, ItemSet *itemSet, int symId)
 {
     ItemSet *alphaItemSet;
+    ItemSet *nextItemSet;
     int error = 0;
-    struct list_head *pos;
-    const Item *item;
-    char has = 0;
-
-    /*申请新项集alpha*/
-    alphaItemSet = LrAllocItemSet(lalr->itemSetNum);
-    if (!alphaItemSet) {
-        return -ENOMEM;
-    }
-
-    /*遍历项集中的所有项，找到下一个符号是symId的项并添加到新项集alpha*/
-    list_for_each(pos, &itemSet->itemList) {
-        item = container_of(pos, Item, node);
-        if (LrItemNextSymId(lalr, item) == symId) {
-            struct list_head nullFollowList;
-
-            INIT_LIST_HEAD(&nullFollowList);
-            error = LrItemSetAddItem(alphaItemSet, item->productRef.headSymId, item->productRef.bodyId,
-                          item->pos + 1, &nullFollowList);
-            if (error != -ENOERR) {
-                LrFreeItemSet(alphaItemSet);
-                return error;
-            }
-            has = 1;
-        }
-    }
-
-    /*如果找到一个符号的项则计算新项集alpha的闭包。*/
-    if (has == 1) {
-        ItemSet *nextItemSet;
 
-        error = LrClosure(lalr, alphaItemSet);
-        if (error != -ENOERR) {
-            LrFreeItemSet(alphaItemSet);
-            return error;
-        }
-
-        /*寻找项集族中跟项集alpha相同的项集*/
-        nextItemSet = LrGetItemSetByItemSetCore(lalr, alphaItemSet);
-        if (!nextItemSet) {
-            LrFreeItemSet(alphaItemSet);
-            return -ENOSTATE;
-        } else {
-            LrItemSetGenTransmitterByGotoItemSet(itemSet, nextItemSet);
-            if (error != -ENOERR) {
-                LrFreeItemSet(alphaItemSet);
-                return error;
-            }
-        }
-    }
-    LrFreeItemSet(alphaItemSet);
-
-    return error;
+    /*生成项集alpha的核心，寻找项集族中跟项集alpha核心相同的项集，不必计算闭包。*/
+    error = LrItemSetGenGotoCore(lalr, lalr->scratchArenaArr[0], itemSet, symId, &alphaItemSet);
+    if (error != -ENOERR || !alphaItemSet)
+        return error;
+    nextItemSet = LrGetItemSetByItemSetCore(lalr, alphaItemSet);
+    LrDiscardItemSet(alphaItemSet);
+    if (!nextItemSet)
+        return -ENOSTATE;
+    return LrItemSetGenTransmitterByGotoItemSet(lalr, itemSet, nextItemSet);
 }
 
 /*
@@ -1342,6 +1503,261 @@ static int LrGenItemSetsFollow(Lalr *lalr)
     return error;
 }
 
+#ifdef LALR_PARALLEL
+/*并行构造时项集在一个文法符号上的后继*/
+typedef struct {
+    struct list_head node;
+    int symId;              /*文法符号*/
+    ItemSet *nextItemSet;   /*项集族中已有的后继项集*/
+    ItemSet *alphaItemSet;  /*项集族中还没有的后继项集，已经计算了闭包*/
+} LrSuccessor;
+
+/*一轮并行处理的项集*/
+typedef struct {
+    Lalr *lalr;
+    ItemSet **itemSetArr;           /*本轮待处理的项集，按项集id排列*/
+    struct list_head *succListArr;  /*各项集的后继链表，节点类型：LrSuccessor*/
+    int itemSetCnt;
+    int next;                       /*下一个待处理项集的下标*/
+    int error;
+    pthread_mutex_t mutex;
+} LrParallelBatch;
+
+/*并行构造线程的参数*/
+typedef struct {
+    LrParallelBatch *batch;
+    CplArena *arena;        /*线程私有的区域分配器，新项集从这里申请*/
+    CplArena *scratch;      /*线程私有的临时分配器，候选项集从这里申请*/
+} LrParallelWorkerArg;
+
+/*
+ * 功能：释放后继链表
+ * 返回值：无
+ **/
+static void LrFreeSuccessorList(struct list_head *list)
+{
+    struct list_head *pos;
+    LrSuccessor *succ;
+
+    for (pos = list->next; pos != list; ) {
+        succ = container_of(pos, LrSuccessor, node);
+        pos = pos->next;
+        list_del(&succ->node);
+        if (succ->alphaItemSet)
+            LrFreeItemSet(succ->alphaItemSet);
+        free(succ);
+    }
+}
+
+/*
+ * 功能：计算项集在各个文法符号上的后继。项集族和散列表在并行阶段只读，
+ *      项集族中还没有的后继计算闭包后留给合并阶段编号。
+ * arena: 当前线程的区域分配器
+ * scratch: 当前线程的临时分配器
+ * succList: 输出型参数，后继链表，按文法符号的处理顺序排列。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrItemSetGenSuccessorList(Lalr *lalr, CplArena *arena, CplArena *scratch, ItemSet *itemSet,
+                                     struct list_head *succList)
+{
+    struct list_head nextSymIdList;
+    struct list_head *pos;
+    SymId *symId;
+    ItemSet *alphaItemSet;
+    LrSuccessor *succ;
+    int error = 0;
+
+    INIT_LIST_HEAD(&nextSymIdList);
+    error = LrItemSetGetNextSymIdList(lalr, itemSet, &nextSymIdList);
+    if (error != -ENOERR)
+        goto err;
+
+    list_for_each(pos, &nextSymIdList) {
+        symId = container_of(pos, SymId, node);
+        error = LrItemSetGenGotoCore(lalr, scratch, itemSet, symId->id, &alphaItemSet);
+        if (error != -ENOERR)
+            goto err;
+        if (!alphaItemSet)
+            continue;
+        succ = malloc(sizeof (*succ));
+        if (!succ) {
+            LrDiscardItemSet(alphaItemSet);
+            error = -ENOMEM;
+            goto err;
+        }
+        succ->symId = symId->id;
+        succ->nextItemSet = LrGetItemSetByItemSetCore(lalr, alphaItemSet);
+        succ->alphaItemSet = NULL;
+        list_add_tail(&succ->node, succList);
+        LrDiscardItemSet(alphaItemSet);
+        if (succ->nextItemSet)
+            continue;
+        error = LrItemSetGenGotoCore(lalr, arena, itemSet, symId->id, &alphaItemSet);
+        if (error != -ENOERR)
+            goto err;
+        succ->alphaItemSet = alphaItemSet;
+        error = LrClosure(lalr, alphaItemSet);
+        if (error != -ENOERR)
+            goto err;
+    }
+err:
+    CfgSymIdListFree(&nextSymIdList);
+    return error;
+}
+
+static void *LrParallelWorker(void *arg)
+{
+    LrParallelWorkerArg *workerArg = arg;
+    LrParallelBatch *batch = workerArg->batch;
+    int i;
+    int error;
+
+    for (;;) {
+        pthread_mutex_lock(&batch->mutex);
+        i = batch->error ? batch->itemSetCnt : batch->next++;
+        pthread_mutex_unlock(&batch->mutex);
+        if (i >= batch->itemSetCnt)
+            break;
+        error = LrItemSetGenSuccessorList(batch->lalr, workerArg->arena, workerArg->scratch,
+                                          batch->itemSetArr[i], &batch->succListArr[i]);
+        if (error != -ENOERR) {
+            pthread_mutex_lock(&batch->mutex);
+            if (!batch->error)
+                batch->error = error;
+            pthread_mutex_unlock(&batch->mutex);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 功能：按项集id和文法符号的顺序合并一轮的后继，给新项集编号。
+ *      编号顺序和单线程构造时相同，所以生成的语法分析表是确定的。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrParallelBatchMerge(LrParallelBatch *batch)
+{
+    Lalr *lalr = batch->lalr;
+    struct list_head *pos;
+    LrSuccessor *succ;
+    ItemSet *nextItemSet;
+    int i;
+    int error = 0;
+
+    for (i = 0; i < batch->itemSetCnt; i++) {
+        list_for_each(pos, &batch->succListArr[i]) {
+            succ = container_of(pos, LrSuccessor, node);
+            nextItemSet = succ->nextItemSet;
+            if (!nextItemSet) {
+                /*同一轮中其他项集可能已经生成了核心相同的项集。*/
+                nextItemSet = LrGetItemSetByItemSetCore(lalr, succ->alphaItemSet);
+                if (!nextItemSet) {
+                    succ->alphaItemSet->id = lalr->itemSetNum;
+                    error = LrAddItemSet(lalr, succ->alphaItemSet);
+                    if (error != -ENOERR)
+                        return error;
+                    nextItemSet = succ->alphaItemSet;
+                    succ->alphaItemSet = NULL;
+                }
+            }
+            error = LrItemSetAddMap(batch->itemSetArr[i], succ->symId, nextItemSet->id);
+            if (error != -ENOERR)
+                return error;
+        }
+    }
+    return error;
+}
+
+/*
+ * 功能：多线程生成LR(0)项集族和GOTO(I, X)映射节点。按层处理，每一轮并行计算上一轮新项集的
+ *      闭包和后继核心，然后单线程合并去重。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrGenItemSetsParallel(Lalr *lalr)
+{
+    LrParallelBatch batch;
+    LrParallelWorkerArg *argArr;
+    pthread_t *threadArr;
+    struct list_head *first;    /*本轮第一个项集*/
+    struct list_head *pos;
+    int threadCnt;
+    int i, t;
+    int error = 0;
+
+    error = LalrPrepareArena(lalr, lalr->threadNum);
+    if (error != -ENOERR)
+        return error;
+    threadArr = malloc(lalr->threadNum * sizeof (*threadArr));
+    argArr = malloc(lalr->threadNum * sizeof (*argArr));
+    if (!threadArr || !argArr) {
+        free(threadArr);
+        free(argArr);
+        return -ENOMEM;
+    }
+    memset(&batch, 0, sizeof (batch));
+    batch.lalr = lalr;
+    pthread_mutex_init(&batch.mutex, NULL);
+    for (t = 0; t < lalr->threadNum; t++) {
+        argArr[t].batch = &batch;
+        argArr[t].arena = lalr->arenaArr[t];
+        argArr[t].scratch = lalr->scratchArenaArr[t];
+    }
+
+    first = lalr->itemSetList.next;
+    while (first != &lalr->itemSetList) {
+        batch.itemSetCnt = lalr->itemSetNum - container_of(first, ItemSet, node)->id;
+        batch.itemSetArr = malloc(batch.itemSetCnt * sizeof (*batch.itemSetArr));
+        batch.succListArr = malloc(batch.itemSetCnt * sizeof (*batch.succListArr));
+        if (!batch.itemSetArr || !batch.succListArr) {
+            error = -ENOMEM;
+            goto err;
+        }
+        for (i = 0, pos = first; pos != &lalr->itemSetList; i++, pos = pos->next) {
+            batch.itemSetArr[i] = container_of(pos, ItemSet, node);
+            INIT_LIST_HEAD(&batch.succListArr[i]);
+        }
+        batch.next = 0;
+        batch.error = 0;
+
+        /*当前线程也参与计算。*/
+        threadCnt = lalr->threadNum - 1;
+        if (threadCnt > batch.itemSetCnt - 1)
+            threadCnt = batch.itemSetCnt - 1;
+        for (t = 0; t < threadCnt; t++) {
+            if (pthread_create(&threadArr[t], NULL, LrParallelWorker, &argArr[t + 1]) != 0)
+                break;
+        }
+        threadCnt = t;
+        LrParallelWorker(&argArr[0]);
+        for (t = 0; t < threadCnt; t++)
+            pthread_join(threadArr[t], NULL);
+
+        error = batch.error;
+        /*记住本轮最后一个项集，合并后它后面的就是下一轮的项集。*/
+        pos = lalr->itemSetList.prev;
+        if (error == -ENOERR)
+            error = LrParallelBatchMerge(&batch);
+        for (i = 0; i < batch.itemSetCnt; i++)
+            LrFreeSuccessorList(&batch.succListArr[i]);
+        free(batch.itemSetArr);
+        free(batch.succListArr);
+        batch.itemSetArr = NULL;
+        batch.succListArr = NULL;
+        if (error != -ENOERR)
+            goto err;
+        first = pos->next;
+    }
+
+err:
+    free(batch.itemSetArr);
+    free(batch.succListArr);
+    pthread_mutex_destroy(&batch.mutex);
+    free(argArr);
+    free(threadArr);
+    return error;
+}
+#endif
+
 /*
  * 功能：生成文法LALR项集族和GOTO(I, X)映射节点。
  * grammar: 文法
@@ -1366,6 +1782,14 @@ int LalrGenItemSet(Lalr *lalr)
     error = LrGenStartItemSet(lalr);
     if (error != -ENOERR)
         return error;
+#ifdef LALR_PARALLEL
+    if (lalr->threadNum > 1 && lalr->lookaheadType == LLT_DEREMER_PENNELLO) {
+        error = LrGenItemSetsParallel(lalr);
+        if (error != -ENOERR)
+            return error;
+        return LalrGenLookaheadDeRemer(lalr);
+    }
+#endif
     /*循环遍历项集族中所有的项集，生成项集在各个文法符号上的下一个项集和GOTO(I, X)映射节点，
         并生成计算闭包时自发形成的向前看符号。*/
     do {
@@ -1393,6 +1817,14 @@ int LalrGenItemSet(Lalr *lalr)
         }
     } while (updateFlag == 1);
 
+    if (lalr->lookaheadType == LLT_DEREMER_PENNELLO) {
+        error = LalrGenLookaheadDeRemer(lalr);
+        if (error != -ENOERR) {
+            goto err;
+        }
+        return error;
+    }
+
     error = LrGenItemSetsTransmitterItem(lalr);
     if (error != -ENOERR) {
         goto err;
@@ -1572,7 +2004,7 @@ static int LrItemSetGenParseTableByMapNode(Lalr *lalr, ItemSet *itemSet, MapNode
             return -ESYNTAX;
         }
 
-        gotoNode = LrAllocGotoNode(mapNode->symId, mapNode->itemSetId);
+        gotoNode = LrAllocGotoNode(itemSet->arena, mapNode->symId, mapNode->itemSetId);
         if (!gotoNode) {
             return -ENOMEM;
         }
@@ -1603,7 +2035,7 @@ static int LrItemSetGenParseTableByMapNode(Lalr *lalr, ItemSet *itemSet, MapNode
                 printf("error: grammar symtax error\n");
                 return -ESYNTAX;
             }
-            actionNode = LrAllocActionNode(LAT_SHIFT, mapNode->symId, mapNode->itemSetId);
+            actionNode = LrAllocActionNode(itemSet->arena, LAT_SHIFT, mapNode->symId, mapNode->itemSetId);
         } else {    /*如果是输入结束符，则出现错误*/
             return -ESYNTAX;
         }
@@ -1639,6 +2071,40 @@ static int LrItemSetGenParseTableByMap(Lalr *lalr, ItemSet *itemSet)
     return error;
 }
 
+/*
+ * 功能：用终结符号和产生式的优先级、结合性解决移入/归约冲突。
+ * actionNode：已有的移入ACTION节点，解决冲突后会被修改
+ * item：归约项
+ * 返回值：冲突已解决返回1，没有声明优先级无法解决时返回0，失败返回错误码。
+ **/
+static int LrResolveConflictByPrec(Lalr *lalr, ActionNode *actionNode, const Item *item)
+{
+    const Symbol *laSymbol, *precSymbol;
+    const ProductBody *productBody;
+
+    if (actionNode->type != LAT_SHIFT)
+        return 0;
+    laSymbol = CfgGetSymbol(lalr->grammar, actionNode->lookaheadId);
+    if (!laSymbol)
+        return -ENOSYM;
+    productBody = CfgGetProductBody(lalr->grammar, item->productRef.headSymId, item->productRef.bodyId);
+    if (!productBody)
+        return -ENOPDTB;
+    precSymbol = CfgProductBodyPrecSymbol(lalr->grammar, productBody);
+    if (laSymbol->prec == 0 || !precSymbol)
+        return 0;
+
+    if (precSymbol->prec > laSymbol->prec
+            || (precSymbol->prec == laSymbol->prec && laSymbol->assoc == SA_LEFT)) {
+        actionNode->type = LAT_REDUCT;
+        actionNode->itemId = item->id;
+    } else if (precSymbol->prec == laSymbol->prec && laSymbol->assoc == SA_NONASSOC) {
+        actionNode->type = LAT_ERROR;
+    }
+    /*产生式优先级低或者右结合时保留移入*/
+    return 1;
+}
+
 /*
  * 功能：添加项集itemSet的归约ACTION节点，向前看符号是follow链表中的符号id。
  * itemSet：项集
@@ -1660,6 +2126,14 @@ static int LrItemSetAddReductActionByList(Lalr *lalr, ItemSet *itemSet, Item *it
         if (LrItemSetActionNodeIsConflict(itemSet, symId->id, &conflictActionNode) == 1) {
             const char *conflictType;
 
+            /*不结合的运算符已经在这个向前看符号上标记为错误*/
+            if (conflictActionNode->type == LAT_ERROR)
+                continue;
+            error = LrResolveConflictByPrec(lalr, conflictActionNode, item);
+            if (error < 0)
+                return error;
+            if (error == 1)
+                continue;
             conflictType = conflictActionNode->type == LAT_SHIFT ? "shift" :
                            conflictActionNode->type == LAT_ACCEPT ? "accept" :
                            conflictActionNode->type == LAT_REDUCT ? "reduct" : "?";
@@ -1679,7 +2153,7 @@ static int LrItemSetAddReductActionByList(Lalr *lalr, ItemSet *itemSet, Item *it
             printf("error: grammar symtax error\n");
             return -ESYNTAX;
         }
-        actionNode = LrAllocActionNode(LAT_REDUCT, symId->id, item->id);
+        actionNode = LrAllocActionNode(itemSet->arena, LAT_REDUCT, symId->id, item->id);
         if (!actionNode) {
             return -ENOMEM;
         }
@@ -1760,7 +2234,7 @@ static int LrItemSetGenParseTableByReductItem(Lalr *lalr, ItemSet *itemSet, Item
                 printf("error: grammar symtax error\n");
                 return -ESYNTAX;
             }
-            actionNode = LrAllocActionNode(LAT_ACCEPT, lalr->grammar->endSymId, 0);
+            actionNode = LrAllocActionNode(itemSet->arena, LAT_ACCEPT, lalr->grammar->endSymId, 0);
             if (!actionNode) {
                 return -ENOMEM;
             }
@@ -1809,39 +2283,150 @@ static int LrItemSetGenParseTable(Lalr *lalr, ItemSet *itemSet)
 }
 
 /*
- * 功能：释放生成语法分析表过程中的垃圾。
- * itmeSet: 项集
+ * 功能：释放生成语法分析表过程中的垃圾。传播关系节点都在传播关系的区域分配器中，
+ *      清空各项的传播关系链表后一次释放。
+ * lalr: lalr
  * 返回值：无
  **/
-static void ItemSetFreeGPTGarbage(ItemSet *itemSet)
+static void LalrFreeGPTGarbage(Lalr *lalr)
 {
-    struct list_head *pos;
+    struct list_head *pos, *itemPos;
+    ItemSet *itemSet;
     Item *item;
 
+    list_for_each(pos, &lalr->itemSetList) {
+        itemSet = container_of(pos, ItemSet, node);
+        list_for_each(itemPos, &itemSet->itemList) {
+            item = container_of(itemPos, Item, node);
+            INIT_LIST_HEAD(&item->transmitterList);
+        }
+    }
+    CplArenaDestroy(lalr->transmitterArena);
+    lalr->transmitterArena = NULL;
+}
+
+/*
+ * 功能：把项集itemSet复制到区域分配器arena中，只保留语法分析时用到的项、映射、ACTION和GOTO节点，
+ *      项的向前看符号链表移到新项中。
+ * pItemSet: 输出型参数，新项集
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrItemSetCompact(CplArena *arena, ItemSet *itemSet, ItemSet **pItemSet)
+{
+    struct list_head *pos;
+    ItemSet *newItemSet;
+    Item *item, *newItem;
+    MapNode *mapNode, *newMapNode;
+    ActionNode *actionNode, *newActionNode;
+    GotoNode *gotoNode, *newGotoNode;
+
+    newItemSet = LrAllocItemSet(arena, itemSet->id);
+    if (!newItemSet)
+        return -ENOMEM;
+    newItemSet->itemNum = itemSet->itemNum;
     list_for_each(pos, &itemSet->itemList) {
         item = container_of(pos, Item, node);
-        LrItemFreeTransmitterItemList(&item->transmitterList);
+        newItem = LrAllocItem(arena, item->id, item->productRef.headSymId, item->productRef.bodyId, item->pos);
+        if (!newItem)
+            return -ENOMEM;
+        list_add_tail(&newItem->node, &newItemSet->itemList);
     }
+    list_for_each(pos, &itemSet->mapList) {
+        mapNode = container_of(pos, MapNode, node);
+        newMapNode = LrAllocMapNode(arena, mapNode->symId, mapNode->itemSetId);
+        if (!newMapNode)
+            return -ENOMEM;
+        list_add_tail(&newMapNode->node, &newItemSet->mapList);
+    }
+    list_for_each(pos, &itemSet->actionList) {
+        actionNode = container_of(pos, ActionNode, node);
+        newActionNode = LrAllocActionNode(arena, actionNode->type, actionNode->lookaheadId, actionNode->itemSetId);
+        if (!newActionNode)
+            return -ENOMEM;
+        list_add_tail(&newActionNode->node, &newItemSet->actionList);
+    }
+    list_for_each(pos, &itemSet->gotoList) {
+        gotoNode = container_of(pos, GotoNode, node);
+        newGotoNode = LrAllocGotoNode(arena, gotoNode->symId, gotoNode->nextItemSetId);
+        if (!newGotoNode)
+            return -ENOMEM;
+        list_add_tail(&newGotoNode->node, &newItemSet->gotoList);
+    }
+    *pItemSet = newItemSet;
+    return 0;
 }
 
 /*
- * 功能：释放生成语法分析表过程中的垃圾。
- * lalr: lalr
+ * 功能：把链表from的节点整体移到空链表to中，from变为空链表。
  * 返回值：无
  **/
-static void LalrFreeGPTGarbage(Lalr *lalr)
+static void LrMoveList(struct list_head *from, struct list_head *to)
 {
-    struct list_head *pos;
-    ItemSet *itemSet;
+    if (list_empty(from)) {
+        INIT_LIST_HEAD(to);
+        return;
+    }
+    to->next = from->next;
+    to->prev = from->prev;
+    to->next->prev = to;
+    to->prev->next = to;
+    INIT_LIST_HEAD(from);
+}
 
+/*
+ * 功能：生成语法分析表后把项集族复制到一个新的区域分配器中，释放构造过程中的区域分配器和
+ *      项集核心散列表。被丢弃的候选项集、项集核心和传播关系都不再占用内存。
+ *      申请内存失败时保留原来的项集族。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LalrCompact(Lalr *lalr)
+{
+    struct list_head itemSetList, *pos, *newPos, *itemPos, *newItemPos;
+    CplArena *arena;
+    ItemSet *itemSet, *newItemSet;
+    Item *item, *newItem;
+    int error = 0;
+
+    arena = CplArenaCreate(0);
+    if (!arena)
+        return -ENOMEM;
+    INIT_LIST_HEAD(&itemSetList);
     list_for_each(pos, &lalr->itemSetList) {
         itemSet = container_of(pos, ItemSet, node);
-        ItemSetFreeGPTGarbage(itemSet);
+        error = LrItemSetCompact(arena, itemSet, &newItemSet);
+        if (error != -ENOERR) {
+            CplArenaDestroy(arena);
+            return error;
+        }
+        list_add_tail(&newItemSet->node, &itemSetList);
     }
+
+    /*向前看符号链表不在区域分配器中，直接移到新项中。*/
+    newPos = itemSetList.next;
+    list_for_each(pos, &lalr->itemSetList) {
+        itemSet = container_of(pos, ItemSet, node);
+        newItemSet = container_of(newPos, ItemSet, node);
+        newItemPos = newItemSet->itemList.next;
+        list_for_each(itemPos, &itemSet->itemList) {
+            item = container_of(itemPos, Item, node);
+            newItem = container_of(newItemPos, Item, node);
+            LrMoveList(&item->followList, &newItem->followList);
+            newItemPos = newItemPos->next;
+        }
+        newPos = newPos->next;
+    }
+    LrMoveList(&itemSetList, &lalr->itemSetList);
+    LalrFreeArena(lalr);
+    CplArenaDestroy(lalr->tableArena);
+    lalr->tableArena = arena;
+    free(lalr->coreHashTable);
+    lalr->coreHashTable = NULL;
+    lalr->coreHashSize = 0;
+    return 0;
 }
 
 /*
- * 功能：生成LR语法分析表
+ * 功能：生成LR语法分析表，成功后释放构造过程中的区域分配器。
  * grammar: 文法
  * 返回值：成功时返回0，否则返回错误码。
  **/
@@ -1863,7 +2448,58 @@ int LalrGenParseTable(Lalr *lalr)
         }
     }
     LalrFreeGPTGarbage(lalr);
-    return error;
+    return LalrCompact(lalr);
+}
+
+/*
+ * 功能：判断项集lItemSet的ACTION和GOTO节点是否都在项集rItemSet中。
+ * 返回值：都在rItemSet中返回1，否则返回0。
+ **/
+static int LrItemSetParseTableIsContain(const ItemSet *lItemSet, const ItemSet *rItemSet)
+{
+    struct list_head *pos;
+    ActionNode *actionNode, *rActionNode;
+    GotoNode *gotoNode, *rGotoNode;
+
+    list_for_each(pos, &lItemSet->actionList) {
+        actionNode = container_of(pos, ActionNode, node);
+        rActionNode = LalrItemSetGetAction(rItemSet, actionNode->lookaheadId);
+        if (!rActionNode || rActionNode->type != actionNode->type
+                || rActionNode->itemSetId != actionNode->itemSetId)
+            return 0;
+    }
+    list_for_each(pos, &lItemSet->gotoList) {
+        gotoNode = container_of(pos, GotoNode, node);
+        rGotoNode = LalrItemSetGetGoto(rItemSet, gotoNode->symId);
+        if (!rGotoNode || rGotoNode->nextItemSetId != gotoNode->nextItemSetId)
+            return 0;
+    }
+    return 1;
+}
+
+/*
+ * 功能：判断两张语法分析表是否相同，项集编号、ACTION和GOTO节点都要相同。
+ * 返回值：相同返回1，否则返回0。
+ **/
+int LalrParseTableIsEqual(const Lalr *lLalr, const Lalr *rLalr)
+{
+    const struct list_head *lPos, *rPos;
+    const ItemSet *lItemSet, *rItemSet;
+
+    if (!lLalr || !rLalr || lLalr->itemSetNum != rLalr->itemSetNum)
+        return 0;
+
+    for (lPos = lLalr->itemSetList.next, rPos = rLalr->itemSetList.next;
+         lPos != &lLalr->itemSetList && rPos != &rLalr->itemSetList;
+         lPos = lPos->next, rPos = rPos->next) {
+        lItemSet = container_of(lPos, ItemSet, node);
+        rItemSet = container_of(rPos, ItemSet, node);
+        if (lItemSet->id != rItemSet->id
+                || LrItemSetParseTableIsContain(lItemSet, rItemSet) != 1
+                || LrItemSetParseTableIsContain(rItemSet, lItemSet) != 1)
+            return 0;
+    }
+    return lPos == &lLalr->itemSetList && rPos == &rLalr->itemSetList;
 }
 
 /*
@@ -6,6 +6,7 @@ extern "C" {
 #endif
 
 #include "list.h"
+#include "cpl_mm.h"
 
 typedef struct _ContextFreeGrammar ContextFreeGrammar;
 
@@ -74,8 +75,19 @@ typedef struct _ItemSet {
     struct list_head mapList;       /*在各个文法符号上到相关项集的映射表，节点类型：MapNode*/
     struct list_head actionList;    /*ACTION链表，节点类型：ActionNode*/
     struct list_head gotoList;      /*GOTO链表节点类型：GotoNode*/
+    struct list_head hashNode;      /*项集核心散列表节点*/
+    unsigned int coreHash;          /*项集核心的散列值*/
+    int coreNum;                    /*项集核心中项的个数*/
+    int *coreArr;                   /*排好序的项集核心，每项3个整数：产生式头符号id、产生式体id、点的位置*/
+    CplArena *arena;                /*项集和项集中各个节点所在的区域分配器*/
 } ItemSet;
 
+/*向前看符号的生成算法*/
+typedef enum {
+    LLT_PROPAGATE,          /*在项集族上自发生成和传播向前看符号*/
+    LLT_DEREMER_PENNELLO,   /*DeRemer-Pennello算法，在LR(0)项集族上用reads/includes关系计算*/
+} LookaheadType;
+
 typedef struct _Lalr Lalr;
 typedef struct _ContextFreeGrammar ContextFreeGrammar;
 
@@ -89,15 +101,31 @@ typedef struct _Lalr {
     ContextFreeGrammar *grammar;
     struct list_head itemSetList;   /*项集链表：节点类型：ItemSet*/
     int itemSetNum;                 /*项集编号生成器。*/
+    struct list_head *coreHashTable;    /*按项集核心散列的项集表，节点类型：ItemSet*/
+    unsigned int coreHashSize;          /*散列表的桶数，总是2的幂*/
     GotoNodeConflictHandle *gotoNodeConflictHandle;
     ActionNodeConflictHandle *actionNodeConflictHandle;
+    LookaheadType lookaheadType;    /*向前看符号的生成算法*/
+    int threadNum;                  /*构造LR(0)项集族的线程数*/
+    /*构造过程中的项集、项、映射节点、ACTION和GOTO节点都从区域分配器中申请，生成语法分析表后
+      把项集复制到tableArena中，整体释放这些分配器。
+      并行构造时每个线程使用一个分配器，单线程时只使用arenaArr[0]。*/
+    CplArena **arenaArr;
+    /*和arenaArr一一对应，后继项集的候选先在这里生成，和已有项集重复时随分配器一起重置*/
+    CplArena **scratchArenaArr;
+    int arenaNum;
+    CplArena *transmitterArena;     /*向前看符号传播关系节点，生成语法分析表后释放*/
+    CplArena *tableArena;           /*生成语法分析表后的项集，不再有向前看符号和项集核心*/
 } Lalr;
 
 int LalrAlloc(Lalr **lalr, ContextFreeGrammar *grammar, GotoNodeConflictHandle *gotoHandle, ActionNodeConflictHandle *actionHandle);
 void LalrFree(Lalr *lalr);
+int LalrSetLookaheadType(Lalr *lalr, LookaheadType type);
+int LalrSetThreadNum(Lalr *lalr, int threadNum);
 int LalrGenItemSet(Lalr *lalr);
 int LalrGoto(Lalr *lalr, int itemSetId, int symId);
 int LalrGenParseTable(Lalr *lalr);
+int LalrParseTableIsEqual(const Lalr *lLalr, const Lalr *rLalr);
 
 ItemSet *LalrGetItemSet(Lalr *lalr, int itemSetId);
 Item *LalrItemSetGetItem(const ItemSet *itemSet, int id);
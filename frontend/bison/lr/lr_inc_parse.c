@@ -0,0 +1,531 @@
+#include "lr_inc_parse.h"
+#include "cpl_errno.h"
+#include "cpl_debug.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
+
+/*
+ * 增量语法分析，参考Wagner–Graham的增量LR分析算法。
+ * 输入是旧语法树和新记号组成的序列：编辑区域之外的旧子树在栈顶状态与子树记录的状态相同时整体移入，
+ * 否则按子树的第一个记号归约，或者把子树拆成子节点继续读入。只有编辑区域附近的记号被逐个重新分析。
+ * 子树的最后几次归约依赖它后面的一个记号，所以紧挨在编辑区域前面的子树也要拆开。
+ * 归约句柄大多会查找和修改全局的环境和符号表，增量分析只执行调用者标记为不依赖环境的归约句柄，
+ * 语义值保存在节点中，整体移入的旧子树不再执行归约句柄。
+ **/
+
+/*读入的输入序列的状态，位置是旧记号序列中的下标*/
+typedef struct {
+    int oldPos;                 /*下一个旧节点的第一个记号的位置*/
+    int start;                  /*编辑开始位置*/
+    int delEnd;                 /*被删除的旧记号的结束位置*/
+    const int *insSymIdArr;     /*插入的新记号*/
+    void *const *insValueArr;   /*插入的新记号的语义值，可以为NULL*/
+    int insNum;
+    int insIdx;
+    int insDone;                /*新记号已经全部读入*/
+} LrIncStream;
+
+/*向前看的输入，旧语法树节点或者新记号*/
+typedef struct {
+    LrIncNode *node;            /*旧语法树中的节点，为NULL时是新记号或者结束符号*/
+    int symId;
+    void *value;                /*记号的语义值*/
+} LrIncLookahead;
+
+static inline int LrIncNodeIsLeaf(const LrIncNode *node)
+{
+    return node->childNum == 0 && node->tokenNum == 1;
+}
+
+static void LrIncNodeRelease(LrIncNode *node)
+{
+    int i;
+
+    if (!node || --node->refCount > 0)
+        return;
+    for (i = 0; i < node->childNum; i++)
+        LrIncNodeRelease(node->childArr[i]);
+    free(node);
+}
+
+static LrIncNode *LrIncNodeAlloc(int symId, int state, int childNum)
+{
+    LrIncNode *node;
+
+    node = malloc(sizeof (*node) + childNum * sizeof (node->childArr[0]));
+    if (!node)
+        return NULL;
+    node->symId = symId;
+    node->state = state;
+    node->tokenNum = 0;
+    node->firstSymId = -1;
+    node->refCount = 1;
+    node->valueFlag = 0;
+    node->value = NULL;
+    node->childNum = childNum;
+    return node;
+}
+
+static int LrIncStackPush(LrIncParser *parser, int state, LrIncNode *node)
+{
+    LrIncStackElm *stackArr;
+
+    if (parser->stackTop >= parser->stackSize) {
+        parser->stackSize = parser->stackSize ? parser->stackSize * 2 : 64;
+        stackArr = realloc(parser->stackArr, parser->stackSize * sizeof (*stackArr));
+        if (!stackArr)
+            return -ENOMEM;
+        parser->stackArr = stackArr;
+    }
+    parser->stackArr[parser->stackTop].state = state;
+    parser->stackArr[parser->stackTop].node = node;
+    parser->stackTop++;
+    return 0;
+}
+
+static void LrIncStackClear(LrIncParser *parser)
+{
+    while (parser->stackTop > 0) {
+        parser->stackTop--;
+        LrIncNodeRelease(parser->stackArr[parser->stackTop].node);
+    }
+}
+
+static int LrIncPendingPush(LrIncParser *parser, LrIncNode *node)
+{
+    LrIncNode **pendingArr;
+
+    if (parser->pendingTop >= parser->pendingSize) {
+        parser->pendingSize = parser->pendingSize ? parser->pendingSize * 2 : 64;
+        pendingArr = realloc(parser->pendingArr, parser->pendingSize * sizeof (*pendingArr));
+        if (!pendingArr)
+            return -ENOMEM;
+        parser->pendingArr = pendingArr;
+    }
+    parser->pendingArr[parser->pendingTop++] = node;
+    return 0;
+}
+
+/*
+ * 功能：把待读入的栈顶节点拆成子节点，第一个子节点成为下一个待读入的节点。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrIncBreakdown(LrIncParser *parser)
+{
+    LrIncNode *node;
+    int i;
+    int error = 0;
+
+    node = parser->pendingArr[--parser->pendingTop];
+    for (i = node->childNum - 1; i >= 0; i--) {
+        error = LrIncPendingPush(parser, node->childArr[i]);
+        if (error != -ENOERR)
+            return error;
+    }
+    return 0;
+}
+
+/*
+ * 功能：获取下一个输入，不消耗它。旧节点在这里按编辑区域拆开或者丢弃。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrIncPeek(LrIncParser *parser, LrIncStream *stream, LrIncLookahead *la)
+{
+    LrIncNode *node;
+    int end;
+    int error = 0;
+
+    while (1) {
+        if (!stream->insDone && stream->oldPos >= stream->start) {
+            if (stream->insIdx < stream->insNum) {
+                la->node = NULL;
+                la->symId = stream->insSymIdArr[stream->insIdx];
+                la->value = stream->insValueArr ? stream->insValueArr[stream->insIdx] : NULL;
+                return 0;
+            }
+            stream->insDone = 1;
+        }
+        if (parser->pendingTop == 0) {
+            la->node = NULL;
+            la->symId = parser->table->endSymId;
+            la->value = NULL;
+            return 0;
+        }
+        node = parser->pendingArr[parser->pendingTop - 1];
+        end = stream->oldPos + node->tokenNum;
+        if (stream->insDone && stream->oldPos < stream->delEnd) {
+            /*被删除的旧记号*/
+            if (end <= stream->delEnd) {
+                parser->pendingTop--;
+                stream->oldPos = end;
+                continue;
+            }
+        } else if (node->tokenNum == 0) {
+            /*空子树的归约依赖后面的记号，重新归约*/
+            parser->pendingTop--;
+            continue;
+        } else if (LrIncNodeIsLeaf(node) || stream->insDone || end < stream->start) {
+            la->node = node;
+            la->symId = node->symId;
+            la->value = node->value;
+            return 0;
+        }
+        error = LrIncBreakdown(parser);
+        if (error != -ENOERR)
+            return error;
+    }
+}
+
+static void LrIncConsume(LrIncParser *parser, LrIncStream *stream, const LrIncLookahead *la)
+{
+    if (la->node) {
+        parser->pendingTop--;
+        stream->oldPos += la->node->tokenNum;
+    } else if (!stream->insDone) {
+        stream->insIdx++;
+    }
+}
+
+/*
+ * 功能：计算归约出的节点的语义值。没有归约句柄的产生式的语义值是NULL，和LrParseStatic相同；
+ *      不依赖环境的归约句柄在子节点都有语义值时执行，参数只取自子节点。
+ *      产生式体为空、参数来自产生式头所在的产生式体时，语义值依赖子树之外的分析栈，不执行。
+ * 返回值：无
+ **/
+static void LrIncReduceValue(LrIncParser *parser, const LrStaticReduce *reduce, LrIncNode *node)
+{
+    const LrIncHandle *handle = &parser->handle;
+    void *bodyArg[node->childNum + 1];
+    int i;
+
+    if (!handle->reduce)
+        return;
+    if (reduce->productId < 0) {
+        node->valueFlag = 1;
+        return;
+    }
+    if (reduce->bodyArgFlag && reduce->argNum != node->childNum + 1)
+        return;
+    if (!handle->pure(handle->arg, reduce->productId))
+        return;
+    for (i = 0; i < node->childNum; i++) {
+        if (!node->childArr[i]->valueFlag)
+            return;
+        bodyArg[i] = node->childArr[i]->value;
+    }
+    if (handle->reduce(handle->arg, reduce->productId, &node->value, NULL,
+                       reduce->bodyArgFlag ? bodyArg : NULL) != 0) {
+        node->value = NULL;
+        return;
+    }
+    node->valueFlag = 1;
+    parser->reduceValueNum++;
+}
+
+/*
+ * 功能：按静态语法分析表中的归约动作归约，构造产生式头的节点。
+ * pNode：输出型参数，接受时返回语法树的根节点
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrIncReduce(LrIncParser *parser, const LrStaticReduce *reduce, LrIncNode **pNode)
+{
+    LrIncNode *node, *child;
+    int base;
+    int entry;
+    int i;
+
+    if (reduce->popNum < 0 || reduce->popNum >= parser->stackTop)
+        return -ENOSTATE;
+    base = parser->stackTop - reduce->popNum;
+    node = LrIncNodeAlloc(reduce->headSymId, parser->stackArr[base - 1].state, reduce->popNum);
+    if (!node)
+        return -ENOMEM;
+    for (i = 0; i < reduce->popNum; i++) {
+        child = parser->stackArr[base + i].node;
+        node->childArr[i] = child;
+        node->tokenNum += child->tokenNum;
+        if (node->firstSymId < 0)
+            node->firstSymId = child->firstSymId;
+    }
+    LrIncReduceValue(parser, reduce, node);
+    parser->stackTop = base;
+    if (reduce->type == LAT_ACCEPT) {
+        *pNode = node;
+        return 0;
+    }
+    entry = LrStaticTableEntry(parser->table, node->state, reduce->headSymId);
+    if (!LR_STATIC_IS_NEXT(entry)) {
+        LrIncNodeRelease(node);
+        return -ESYNTAX;
+    }
+    return LrIncStackPush(parser, LR_STATIC_NEXT_STATE(entry), node);
+}
+
+/*
+ * 功能：移入一个终结符号，旧的叶子节点状态相同时直接复用。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrIncShiftToken(LrIncParser *parser, const LrIncLookahead *la, int top, int next)
+{
+    LrIncNode *node;
+    int error = 0;
+
+    if (la->node && la->node->state == top) {
+        node = la->node;
+        node->refCount++;
+    } else {
+        node = LrIncNodeAlloc(la->symId, top, 0);
+        if (!node)
+            return -ENOMEM;
+        node->tokenNum = 1;
+        node->firstSymId = la->symId;
+        node->valueFlag = parser->handle.reduce != NULL;
+        node->value = la->value;
+    }
+    error = LrIncStackPush(parser, next, node);
+    if (error != -ENOERR)
+        LrIncNodeRelease(node);
+    return error;
+}
+
+/*
+ * 功能：分析旧语法树oldRoot中编辑区域之外的部分和插入的新记号，oldRoot为NULL时是全量分析。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrIncRun(LrIncParser *parser, LrIncNode *oldRoot, int start, int delNum,
+                    const int insSymIdArr[], void *const insValueArr[], int insNum)
+{
+    const LrStaticTable *table = parser->table;
+    const LrStaticReduce *reduce;
+    LrIncStream stream;
+    LrIncLookahead la;
+    LrIncNode *root = NULL;
+    int top;
+    int entry;
+    int error = 0;
+
+    memset(&stream, 0, sizeof (stream));
+    stream.start = start;
+    stream.delEnd = start + delNum;
+    stream.insSymIdArr = insSymIdArr;
+    stream.insValueArr = insValueArr;
+    stream.insNum = insNum;
+    parser->reuseNodeNum = 0;
+    parser->reuseTokenNum = 0;
+    parser->shiftTokenNum = 0;
+    parser->reduceValueNum = 0;
+    parser->pendingTop = 0;
+    if (oldRoot) {
+        error = LrIncPendingPush(parser, oldRoot);
+        if (error != -ENOERR)
+            return error;
+        /*根节点是接受时归约出的节点，不能整体移入*/
+        error = LrIncBreakdown(parser);
+        if (error != -ENOERR)
+            return error;
+    }
+    error = LrIncStackPush(parser, 0, NULL);
+    if (error != -ENOERR)
+        return error;
+
+    while (!root) {
+        top = parser->stackArr[parser->stackTop - 1].state;
+        error = LrIncPeek(parser, &stream, &la);
+        if (error != -ENOERR)
+            goto err;
+
+        if (la.node && !LrIncNodeIsLeaf(la.node)) {
+            /*栈顶状态与子树记录的状态相同时整体移入子树*/
+            entry = LrStaticTableEntry(table, top, la.node->symId);
+            if (la.node->state == top && LR_STATIC_IS_NEXT(entry)) {
+                la.node->refCount++;
+                error = LrIncStackPush(parser, LR_STATIC_NEXT_STATE(entry), la.node);
+                if (error != -ENOERR) {
+                    la.node->refCount--;
+                    goto err;
+                }
+                parser->reuseNodeNum++;
+                parser->reuseTokenNum += la.node->tokenNum;
+                LrIncConsume(parser, &stream, &la);
+                continue;
+            }
+            /*否则按子树的第一个记号归约，不能归约时拆开子树*/
+            entry = LrStaticTableDefault(table, top);
+            if (entry == LR_STATIC_ERROR)
+                entry = LrStaticTableEntry(table, top, la.node->firstSymId);
+            if (entry != LR_STATIC_ERROR && !LR_STATIC_IS_NEXT(entry)
+                    && table->reduceArr[LR_STATIC_REDUCE_IDX(entry)].type == LAT_REDUCT) {
+                error = LrIncReduce(parser, &table->reduceArr[LR_STATIC_REDUCE_IDX(entry)], &root);
+                if (error != -ENOERR)
+                    goto err;
+                continue;
+            }
+            error = LrIncBreakdown(parser);
+            if (error != -ENOERR)
+                goto err;
+            continue;
+        }
+
+        entry = LrStaticTableDefault(table, top);
+        if (entry == LR_STATIC_ERROR)
+            entry = LrStaticTableEntry(table, top, la.symId);
+        if (entry == LR_STATIC_ERROR) {
+            error = -ESYNTAX;
+            goto err;
+        }
+        if (LR_STATIC_IS_NEXT(entry)) {
+            error = LrIncShiftToken(parser, &la, top, LR_STATIC_NEXT_STATE(entry));
+            if (error != -ENOERR)
+                goto err;
+            parser->shiftTokenNum++;
+            LrIncConsume(parser, &stream, &la);
+            continue;
+        }
+        reduce = &table->reduceArr[LR_STATIC_REDUCE_IDX(entry)];
+        error = LrIncReduce(parser, reduce, &root);
+        if (error != -ENOERR)
+            goto err;
+    }
+
+    LrIncStackClear(parser);
+    LrIncNodeRelease(parser->root);
+    parser->root = root;
+    return 0;
+
+err:
+    LrIncStackClear(parser);
+    LrIncNodeRelease(parser->root);
+    parser->root = NULL;
+    return error;
+}
+
+/*
+ * 功能：设置记号序列的一段，用insSymIdArr和insValueArr替换[start, start + delNum)。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LrIncReplaceToken(LrIncParser *parser, int start, int delNum,
+                             const int insSymIdArr[], void *const insValueArr[], int insNum)
+{
+    int *symIdArr;
+    void **valueArr;
+    int num, tail;
+
+    num = parser->symIdNum - delNum + insNum;
+    if (num > parser->symIdSize) {
+        symIdArr = realloc(parser->symIdArr, num * sizeof (*symIdArr));
+        if (!symIdArr)
+            return -ENOMEM;
+        parser->symIdArr = symIdArr;
+        if (parser->handle.reduce) {
+            valueArr = realloc(parser->valueArr, num * sizeof (*valueArr));
+            if (!valueArr)
+                return -ENOMEM;
+            parser->valueArr = valueArr;
+        }
+        parser->symIdSize = num;
+    }
+    tail = parser->symIdNum - start - delNum;
+    memmove(&parser->symIdArr[start + insNum], &parser->symIdArr[start + delNum],
+            tail * sizeof (*parser->symIdArr));
+    if (insNum > 0)
+        memcpy(&parser->symIdArr[start], insSymIdArr, insNum * sizeof (*insSymIdArr));
+    if (parser->handle.reduce) {
+        memmove(&parser->valueArr[start + insNum], &parser->valueArr[start + delNum],
+                tail * sizeof (*parser->valueArr));
+        if (insNum > 0)
+            memcpy(&parser->valueArr[start], insValueArr, insNum * sizeof (*insValueArr));
+    }
+    parser->symIdNum = num;
+    return 0;
+}
+
+/*
+ * 功能：全量分析记号序列，替换保存的记号序列和语法树。
+ * symIdArr：记号的符号id，不包含结束符号
+ * valueArr：记号的语义值，设置了归约句柄时不能为NULL，否则忽略
+ * 返回值：成功时返回0，否则返回错误码，此时不保留语法树，下一次编辑时重新全量分析。
+ **/
+int LrIncParse(LrIncParser *parser, const int symIdArr[], void *const valueArr[], int len)
+{
+    int error = 0;
+
+    if (!parser || (!symIdArr && len > 0) || len < 0
+            || (parser->handle.reduce && !valueArr && len > 0))
+        return -EINVAL;
+
+    error = LrIncReplaceToken(parser, 0, parser->symIdNum, symIdArr, valueArr, len);
+    if (error != -ENOERR)
+        return error;
+    LrIncNodeRelease(parser->root);
+    parser->root = NULL;
+    return LrIncRun(parser, NULL, 0, 0, parser->symIdArr, parser->valueArr, parser->symIdNum);
+}
+
+/*
+ * 功能：编辑记号序列并增量分析，用insSymIdArr替换[start, start + delNum)的记号。
+ *      insValueArr是插入记号的语义值，设置了归约句柄时不能为NULL，编辑区域之外的记号的语义值保持不变。
+ *      上一次分析失败时没有语法树可以复用，做全量分析。
+ * 返回值：成功时返回0，否则返回错误码，此时不保留语法树。
+ **/
+int LrIncEdit(LrIncParser *parser, int start, int delNum,
+              const int insSymIdArr[], void *const insValueArr[], int insNum)
+{
+    LrIncNode *oldRoot;
+    int error = 0;
+
+    if (!parser || start < 0 || delNum < 0 || insNum < 0 || (!insSymIdArr && insNum > 0)
+            || (parser->handle.reduce && !insValueArr && insNum > 0)
+            || start + delNum > parser->symIdNum)
+        return -EINVAL;
+
+    error = LrIncReplaceToken(parser, start, delNum, insSymIdArr, insValueArr, insNum);
+    if (error != -ENOERR)
+        return error;
+    if (!parser->root)
+        return LrIncRun(parser, NULL, 0, 0, parser->symIdArr, parser->valueArr, parser->symIdNum);
+
+    /*旧语法树在分析结束前不能释放，新语法树会共享其中的子树*/
+    oldRoot = parser->root;
+    oldRoot->refCount++;
+    error = LrIncRun(parser, oldRoot, start, delNum, &parser->symIdArr[start],
+                     parser->valueArr ? &parser->valueArr[start] : NULL, insNum);
+    LrIncNodeRelease(oldRoot);
+    return error;
+}
+
+/*
+ * 功能：分配增量语法分析器。
+ * handle：增量分析中执行的归约句柄，为NULL时只构造语法树
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int LrIncParserAlloc(LrIncParser **pParser, const LrStaticTable *table, const LrIncHandle *handle)
+{
+    LrIncParser *parser;
+
+    if (!pParser || !table || (handle && (!handle->pure || !handle->reduce)))
+        return -EINVAL;
+
+    parser = calloc(1, sizeof (*parser));
+    if (!parser)
+        return -ENOMEM;
+    parser->table = table;
+    if (handle)
+        parser->handle = *handle;
+    *pParser = parser;
+    return 0;
+}
+
+void LrIncParserFree(LrIncParser *parser)
+{
+    if (!parser)
+        return;
+    LrIncStackClear(parser);
+    LrIncNodeRelease(parser->root);
+    free(parser->stackArr);
+    free(parser->pendingArr);
+    free(parser->symIdArr);
+    free(parser->valueArr);
+    free(parser);
+}
@@ -0,0 +1,82 @@
+#ifndef __LR_INC_PARSE_H__
+#define __LR_INC_PARSE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lr_static_table.h"
+
+/*
+ * 增量语法分析的语法树节点，节点在新旧语法树之间共享，创建后不再修改。
+ * 叶子节点是终结符号，childNum为0，tokenNum为1，语义值是记号。
+ * 内部节点只保存不依赖环境的归约句柄算出的语义值，子树整体移入时语义值随子树一起复用；
+ * 依赖环境的产生式没有语义值，语义分析和中间代码生成仍然要用BisonCompile全量编译。
+ **/
+typedef struct _LrIncNode {
+    int symId;                      /*文法符号id*/
+    int state;                      /*移入或者归约出这个节点之前的栈顶状态*/
+    int tokenNum;                   /*覆盖的记号数*/
+    int firstSymId;                 /*第一个记号的符号id，没有记号时为-1*/
+    int refCount;                   /*引用计数*/
+    int valueFlag;                  /*为1时value是节点的语义值*/
+    void *value;
+    int childNum;
+    struct _LrIncNode *childArr[];
+} LrIncNode;
+
+/*增量语法分析栈中的元素*/
+typedef struct {
+    int state;
+    LrIncNode *node;
+} LrIncStackElm;
+
+/*
+ * 增量分析中执行的归约句柄。pure判断产生式的归约句柄是否不依赖环境，即语义值只由产生式体的语义值决定，
+ * 只有这样的产生式在归约时调用reduce，参数和LrStaticReduceHandle相同，prevArg总是NULL。
+ * arg是调用者的上下文，reduce申请的语义值要在增量分析器释放之前一直有效。
+ **/
+typedef struct {
+    int (*pure)(void *arg, int productId);
+    int (*reduce)(void *arg, int productId, void **headArg, void *prevArg, void *bodyArg[]);
+    void *arg;
+} LrIncHandle;
+
+/*增量语法分析器，保存上一次分析的记号序列和语法树*/
+typedef struct _LrIncParser {
+    const LrStaticTable *table;
+    LrIncHandle handle;             /*reduce为NULL时只构造语法树，不计算语义值*/
+    int *symIdArr;                  /*当前的记号序列，不包含结束符号*/
+    void **valueArr;                /*记号的语义值，和symIdArr一一对应，没有归约句柄时为NULL*/
+    int symIdNum;
+    int symIdSize;
+    LrIncNode *root;                /*上一次分析成功的语法树，分析失败时为NULL*/
+    LrIncStackElm *stackArr;        /*分析栈*/
+    int stackTop;
+    int stackSize;
+    LrIncNode **pendingArr;         /*待读入的旧语法树节点，栈顶是下一个节点*/
+    int pendingTop;
+    int pendingSize;
+    /*最近一次分析的统计*/
+    unsigned long reuseNodeNum;     /*整体移入的旧子树数*/
+    unsigned long reuseTokenNum;    /*整体移入的旧子树覆盖的记号数*/
+    unsigned long shiftTokenNum;    /*逐个移入的记号数*/
+    unsigned long reduceValueNum;   /*执行的归约句柄数*/
+} LrIncParser;
+
+int LrIncParserAlloc(LrIncParser **pParser, const LrStaticTable *table, const LrIncHandle *handle);
+void LrIncParserFree(LrIncParser *parser);
+int LrIncParse(LrIncParser *parser, const int symIdArr[], void *const valueArr[], int len);
+int LrIncEdit(LrIncParser *parser, int start, int delNum,
+              const int insSymIdArr[], void *const insValueArr[], int insNum);
+
+static inline const LrIncNode *LrIncParserRoot(const LrIncParser *parser)
+{
+    return parser->root;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__LR_INC_PARSE_H__*/
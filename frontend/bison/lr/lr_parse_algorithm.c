@@ -82,6 +82,8 @@ int LrParserAlloc(LrParser **pParser, int (shiftHandle)(void **, LrReader *), Lr
     INIT_LIST_HEAD(&parser->configurationStack);
     parser->errorRecover = errorRecover;
     parser->syntaxErrorFlag = 0;
+    parser->acceptPrintFlag = 1;
+    parser->stat = NULL;
     return 0;
 }
 
@@ -99,6 +101,20 @@ static int LrConfigurationStackGetArg(LrParser *lrParser, void *argArr[], unsign
     return 0;
 }
 
+/*
+ * 功能：获取格局栈的深度，只在错误恢复后用于统计。
+ * 返回值：格局栈中的状态数
+ **/
+static unsigned long LrConfigurationStackDepth(struct list_head *list)
+{
+    struct list_head *pos;
+    unsigned long depth = 0;
+
+    list_for_each(pos, list)
+        depth++;
+    return depth;
+}
+
 static void LrParserFreeStack(struct list_head *list)
 {
     struct list_head *pos;
@@ -136,6 +152,8 @@ int LrParse(LrParser *lrParser, Lalr *lalr, LrReader *reader)
     grammar = lalr->grammar;
     /*向格局栈压入起始状态0。*/
     ConfigurationStackPushState(&lrParser->configurationStack, 0, NULL);
+    if (lrParser->stat)
+        LrParseStatBegin(lrParser->stat);
     while (1) {
         ProductBody *productBody;
         ItemSet *itemSet;
@@ -157,11 +175,13 @@ int LrParse(LrParser *lrParser, Lalr *lalr, LrReader *reader)
         if (error < 0)
             return error;
         action = LalrItemSetGetAction(itemSet, lookahead);
-        if (action == NULL) {   /*未找到合适的动作，该报错，输入不符合LR文法。*/
+        if (action == NULL || action->type == LAT_ERROR) {   /*未找到合适的动作，该报错，输入不符合LR文法。*/
             lrParser->syntaxErrorFlag = 1;
             if (lrParser->errorRecover) {
                 error = lrParser->errorRecover->recoverHandle(lrParser->errorRecover, lalr, lrParser,
                                                        reader);
+                if (lrParser->stat)
+                    LrParseStatRecover(lrParser->stat, LrConfigurationStackDepth(&lrParser->configurationStack));
                 if (error == -ENOERR) {
                     continue;
                 } else {
@@ -184,6 +204,8 @@ int LrParse(LrParser *lrParser, Lalr *lalr, LrReader *reader)
             if (error != -ENOERR) {
                 return error;
             }
+            if (lrParser->stat)
+                LrParseStatShift(lrParser->stat);
             error = reader->inputPosInc(reader);
             if (error != -ENOERR)
                 return error;
@@ -191,6 +213,7 @@ int LrParse(LrParser *lrParser, Lalr *lalr, LrReader *reader)
             Item *item;
             GotoNode *gotoNode;
             void *headArg = NULL;
+            uint64_t start = 0;
 
             /*获取归约项。*/
             item = LalrItemSetGetItem(itemSet, action->itemId);
@@ -205,6 +228,8 @@ int LrParse(LrParser *lrParser, Lalr *lalr, LrReader *reader)
                 return -ENOPDTB;
             }
             //CfgProductBodyPrint(grammar, CfgGetSymbol(grammar, item->productRef.headSymId), productBody);
+            if (lrParser->stat && productBody->handle)
+                start = LrParseStatNow();
             /*弹出格局栈中归约项的产生式体。*/
             if (productBody->handle) {
                 if (CfgProductBodyIsEmpty(grammar, productBody) == 0) {
@@ -246,6 +271,13 @@ int LrParse(LrParser *lrParser, Lalr *lalr, LrReader *reader)
                 if (error != -ENOERR)
                     return error;
             }
+            if (lrParser->stat) {
+                error = LrParseStatReduce(lrParser->stat, item->productRef.headSymId, item->productRef.bodyId,
+                                          item->pos, productBody->handle != NULL,
+                                          productBody->handle ? LrParseStatNow() - start : 0);
+                if (error != -ENOERR)
+                    return error;
+            }
             error = ConfigurationStackPopState(&lrParser->configurationStack, item->pos);
             if (error != -ENOERR)
                 return error;
@@ -267,6 +299,7 @@ int LrParse(LrParser *lrParser, Lalr *lalr, LrReader *reader)
         } else if (action->type == LAT_ACCEPT) {    /*接受*/
             Item *item;
             void *headArg = NULL;
+            uint64_t start;
 
             item = LalrItemSetGetItem(itemSet, action->itemId);
             if (!item) {
@@ -284,9 +317,18 @@ int LrParse(LrParser *lrParser, Lalr *lalr, LrReader *reader)
                 error = LrConfigurationStackGetArg(lrParser, argArr, ARRAY_SIZE(argArr));
                 if (error != -ENOERR)
                     return error;
+                start = lrParser->stat ? LrParseStatNow() : 0;
                 error = productBody->handle(&headArg, argArr[0], &argArr[1]);
             }
-            printf("accept\n");
+            if (lrParser->stat) {
+                error = LrParseStatReduce(lrParser->stat, item->productRef.headSymId, item->productRef.bodyId,
+                                          item->pos, productBody->handle != NULL,
+                                          productBody->handle ? LrParseStatNow() - start : 0);
+                if (error != -ENOERR)
+                    return error;
+            }
+            if (lrParser->acceptPrintFlag)
+                printf("accept\n");
             break;
         }
     }
@@ -294,3 +336,123 @@ int LrParse(LrParser *lrParser, Lalr *lalr, LrReader *reader)
     return 0;
 }
 
+
+/*
+ * 功能：用静态语法分析表执行LR语法分析算法，归约时的参数传递与LrParse相同。
+ * table: 由LalrEmitStaticTable生成的静态语法分析表
+ * reader: 输入
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int LrParseStatic(LrParser *lrParser, const LrStaticTable *table, LrReader *reader)
+{
+    int error = 0;
+    StackStateNode *topState;
+
+    if (!lrParser || !table || !reader)
+        return -EINVAL;
+
+    /*向格局栈压入起始状态0。*/
+    ConfigurationStackPushState(&lrParser->configurationStack, 0, NULL);
+    if (lrParser->stat)
+        LrParseStatBegin(lrParser->stat);
+    while (1) {
+        const LrStaticReduce *reduce;
+        int lookahead;
+        int entry;
+
+        topState = ConfigurationStackTopState(&lrParser->configurationStack, 0);
+        if (!topState)
+            return -ENOSTATE;
+        /*只有一个归约动作的状态直接归约，不需要读取向前看符号。*/
+        entry = LrStaticTableDefault(table, topState->id);
+        if (entry == LR_STATIC_ERROR) {
+            error = lookahead = reader->getCurrentSymId(reader);
+            if (error < 0)
+                return error;
+            entry = LrStaticTableEntry(table, topState->id, lookahead);
+        }
+        if (entry == LR_STATIC_ERROR) {  /*未找到合适的动作，该报错，输入不符合LR文法。*/
+            lrParser->syntaxErrorFlag = 1;
+            if (lrParser->errorRecover) {
+                error = LrErrorRecoverStaticHandle(lrParser->errorRecover, table, lrParser, reader);
+                if (lrParser->stat)
+                    LrParseStatRecover(lrParser->stat, LrConfigurationStackDepth(&lrParser->configurationStack));
+                if (error == -ENOERR)
+                    continue;
+                return error;
+            } else {
+                printf("error: no action node\n");
+                return -ESYNTAX;
+            }
+        }
+        if (LR_STATIC_IS_NEXT(entry)) {    /*移入。*/
+            void *arg;
+
+            error = lrParser->shiftHandle(&arg, reader);
+            if (error != -ENOERR)
+                return error;
+            error = ConfigurationStackPushState(&lrParser->configurationStack, LR_STATIC_NEXT_STATE(entry), arg);
+            if (error != -ENOERR)
+                return error;
+            if (lrParser->stat)
+                LrParseStatShift(lrParser->stat);
+            error = reader->inputPosInc(reader);
+            if (error != -ENOERR)
+                return error;
+            continue;
+        }
+
+        /*归约或者接受*/
+        reduce = &table->reduceArr[LR_STATIC_REDUCE_IDX(entry)];
+        {
+            void *headArg = NULL;
+            uint64_t start = 0;
+
+            if (reduce->productId >= 0) {
+                if (reduce->argNum <= 0)
+                    return -EMISC;
+
+                void *argArr[reduce->argNum];
+
+                error = LrConfigurationStackGetArg(lrParser, argArr, ARRAY_SIZE(argArr));
+                if (error != -ENOERR)
+                    return error;
+                if (lrParser->stat)
+                    start = LrParseStatNow();
+                error = table->reduceHandle(reduce->productId, &headArg, argArr[0],
+                                            reduce->bodyArgFlag ? &argArr[1] : NULL);
+                if (error != -ENOERR)
+                    return error;
+            }
+            if (lrParser->stat) {
+                error = LrParseStatReduce(lrParser->stat, reduce->headSymId, reduce->bodyId, reduce->popNum,
+                                          reduce->productId >= 0,
+                                          reduce->productId >= 0 ? LrParseStatNow() - start : 0);
+                if (error != -ENOERR)
+                    return error;
+            }
+            if (reduce->type == LAT_ACCEPT) {
+                if (lrParser->acceptPrintFlag)
+                    printf("accept\n");
+                break;
+            }
+            error = ConfigurationStackPopState(&lrParser->configurationStack, reduce->popNum);
+            if (error != -ENOERR)
+                return error;
+            /*获取格局栈栈顶状态在归约项产生式头上的下一个状态。*/
+            topState = ConfigurationStackTopState(&lrParser->configurationStack, 0);
+            if (!topState)
+                return -ENOSTATE;
+            entry = LrStaticTableEntry(table, topState->id, reduce->headSymId);
+            if (!LR_STATIC_IS_NEXT(entry)) {
+                printf("error: no goto node\n");
+                return -ESYNTAX;
+            }
+            error = ConfigurationStackPushState(&lrParser->configurationStack, LR_STATIC_NEXT_STATE(entry), headArg);
+            if (error != -ENOERR)
+                return error;
+        }
+    }
+
+    return 0;
+}
@@ -6,6 +6,8 @@ extern "C" {
 #endif
 
 #include "lalr_parse_table.h"
+#include "lr_static_table.h"
+#include "lr_parse_stat.h"
 
 typedef struct {
     struct list_head node;
@@ -26,12 +28,14 @@ typedef struct _LrParser {
     struct list_head configurationStack;
     LrErrorRecover *errorRecover;
     unsigned int syntaxErrorFlag;
-
+    unsigned int acceptPrintFlag;   /*接受时输出accept*/
+    LrParseStat *stat;  /*语法分析统计，为NULL时不统计，由调用者释放*/
 } LrParser;
 
 int LrParserAlloc(LrParser **pParser, int (shiftHandle)(void **, LrReader *), LrErrorRecover *errorRecover);
 void LrParserFree(LrParser *parser);
 int LrParse(LrParser *lrParser, Lalr *lalr, LrReader *);
+int LrParseStatic(LrParser *lrParser, const LrStaticTable *table, LrReader *reader);
 
 int ConfigurationStackPushState(struct list_head *list, int id, void *arg);
 StackStateNode *ConfigurationStackTopState(struct list_head *list, unsigned int idx);
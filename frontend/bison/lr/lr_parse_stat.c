@@ -0,0 +1,211 @@
+#include "lr_parse_stat.h"
+#include "cpl_errno.h"
+#include "cpl_debug.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+#define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
+
+int LrParseStatAlloc(LrParseStat **pStat)
+{
+    LrParseStat *stat;
+
+    if (!pStat)
+        return -EINVAL;
+
+    stat = calloc(1, sizeof (*stat));
+    if (!stat)
+        return -ENOMEM;
+    *pStat = stat;
+    return 0;
+}
+
+void LrParseStatFree(LrParseStat *stat)
+{
+    int i;
+
+    if (!stat)
+        return;
+    for (i = 0; i < stat->symNum; i++) {
+        free(stat->symArr[i].symStr);
+        free(stat->symArr[i].bodyArr);
+    }
+    free(stat->symArr);
+    free(stat);
+}
+
+/*
+ * 功能：设置获取符号字符串的函数，输出统计结果时用符号字符串标识产生式头。
+ * 返回值：无
+ **/
+void LrParseStatSetSymStr(LrParseStat *stat, LrParseStatSymStr *symStr, const void *arg)
+{
+    stat->symStr = symStr;
+    stat->symStrArg = arg;
+}
+
+/*
+ * 功能：获取单调时钟的当前时间，用于统计归约句柄的耗时。
+ * 返回值：纳秒
+ **/
+uint64_t LrParseStatNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void LrParseStatUpdateDepth(LrParseStat *stat, unsigned long stackDepth)
+{
+    stat->stackDepth = stackDepth;
+    if (stackDepth > stat->maxStackDepth)
+        stat->maxStackDepth = stackDepth;
+}
+
+/*
+ * 功能：开始一次语法分析，格局栈中只有起始状态。
+ * 返回值：无
+ **/
+void LrParseStatBegin(LrParseStat *stat)
+{
+    stat->parseNum++;
+    LrParseStatUpdateDepth(stat, 1);
+}
+
+void LrParseStatShift(LrParseStat *stat)
+{
+    stat->shiftNum++;
+    LrParseStatUpdateDepth(stat, stat->stackDepth + 1);
+}
+
+/*
+ * 功能：获取产生式的统计项，按需扩大统计数组。
+ * 返回值：统计项，内存不足时返回NULL。
+ **/
+static LrProductStat *LrParseStatGetProduct(LrParseStat *stat, int headSymId, int bodyId)
+{
+    LrSymStat *symArr, *symStat;
+    LrProductStat *bodyArr;
+    const char *str;
+
+    if (headSymId >= stat->symNum) {
+        symArr = realloc(stat->symArr, (headSymId + 1) * sizeof (*symArr));
+        if (!symArr)
+            return NULL;
+        memset(symArr + stat->symNum, 0, (headSymId + 1 - stat->symNum) * sizeof (*symArr));
+        stat->symArr = symArr;
+        stat->symNum = headSymId + 1;
+    }
+    symStat = &stat->symArr[headSymId];
+    if (bodyId >= symStat->bodyNum) {
+        bodyArr = realloc(symStat->bodyArr, (bodyId + 1) * sizeof (*bodyArr));
+        if (!bodyArr)
+            return NULL;
+        memset(bodyArr + symStat->bodyNum, 0, (bodyId + 1 - symStat->bodyNum) * sizeof (*bodyArr));
+        symStat->bodyArr = bodyArr;
+        symStat->bodyNum = bodyId + 1;
+    }
+    if (!symStat->symStr && stat->symStr) {
+        str = stat->symStr(stat->symStrArg, headSymId);
+        if (str)
+            symStat->symStr = strdup(str);
+    }
+    return &symStat->bodyArr[bodyId];
+}
+
+/*
+ * 功能：记录一次归约，归约弹出popNum个状态后压入GOTO状态。
+ * handleFlag：是否调用了归约句柄
+ * handleNs：归约句柄的耗时
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int LrParseStatReduce(LrParseStat *stat, int headSymId, int bodyId, int popNum,
+                      int handleFlag, uint64_t handleNs)
+{
+    LrProductStat *productStat;
+
+    if (headSymId < 0 || bodyId < 0)
+        return -EINVAL;
+
+    productStat = LrParseStatGetProduct(stat, headSymId, bodyId);
+    if (!productStat)
+        return -ENOMEM;
+    stat->reduceNum++;
+    productStat->reduceNum++;
+    if (handleFlag) {
+        productStat->handleNum++;
+        productStat->handleNs += handleNs;
+    }
+    if (stat->stackDepth >= (unsigned long)popNum)
+        LrParseStatUpdateDepth(stat, stat->stackDepth - popNum + 1);
+    return 0;
+}
+
+/*
+ * 功能：记录一次错误恢复，错误恢复会弹出和压入状态，由调用者给出恢复后的格局栈深度。
+ * 返回值：无
+ **/
+void LrParseStatRecover(LrParseStat *stat, unsigned long stackDepth)
+{
+    stat->recoverNum++;
+    LrParseStatUpdateDepth(stat, stackDepth);
+}
+
+static void LrParseStatDumpStr(const char *str, FILE *fp)
+{
+    fputc('"', fp);
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\')
+            fputc('\\', fp);
+        if ((unsigned char)*str < 0x20)
+            fprintf(fp, "\\u%04x", (unsigned char)*str);
+        else
+            fputc(*str, fp);
+    }
+    fputc('"', fp);
+}
+
+/*
+ * 功能：以JSON格式输出统计结果，产生式按产生式头符号id和产生式体id排列，只输出归约过的产生式。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int LrParseStatDump(const LrParseStat *stat, FILE *fp)
+{
+    const LrSymStat *symStat;
+    const LrProductStat *productStat;
+    int i, j;
+    int first = 1;
+
+    if (!stat || !fp)
+        return -EINVAL;
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"parse\": %lu,\n", stat->parseNum);
+    fprintf(fp, "  \"shift\": %lu,\n", stat->shiftNum);
+    fprintf(fp, "  \"reduce\": %lu,\n", stat->reduceNum);
+    fprintf(fp, "  \"recover\": %lu,\n", stat->recoverNum);
+    fprintf(fp, "  \"maxStackDepth\": %lu,\n", stat->maxStackDepth);
+    fprintf(fp, "  \"products\": [");
+    for (i = 0; i < stat->symNum; i++) {
+        symStat = &stat->symArr[i];
+        for (j = 0; j < symStat->bodyNum; j++) {
+            productStat = &symStat->bodyArr[j];
+            if (productStat->reduceNum == 0)
+                continue;
+            fprintf(fp, "%s\n    {\"head\": ", first ? "" : ",");
+            LrParseStatDumpStr(symStat->symStr ? symStat->symStr : "?", fp);
+            fprintf(fp, ", \"headSymId\": %d, \"bodyId\": %d, \"reduce\": %lu, \"handle\": %lu, "
+                    "\"handleNs\": %llu}", i, j, productStat->reduceNum, productStat->handleNum,
+                    (unsigned long long)productStat->handleNs);
+            first = 0;
+        }
+    }
+    fprintf(fp, "%s]\n}\n", first ? "" : "\n  ");
+    if (ferror(fp)) {
+        PrErr("write parse stat failed\n");
+        return -EMISC;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#ifndef __LR_PARSE_STAT_H__
+#define __LR_PARSE_STAT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdio.h"
+#include "stdint.h"
+
+/*产生式的归约统计*/
+typedef struct {
+    unsigned long reduceNum;    /*归约次数*/
+    unsigned long handleNum;    /*调用归约句柄的次数*/
+    uint64_t handleNs;          /*归约句柄的累计耗时，单位纳秒*/
+} LrProductStat;
+
+/*产生式头符号的归约统计*/
+typedef struct {
+    char *symStr;               /*符号的字符串，第一次归约时记录*/
+    LrProductStat *bodyArr;     /*按产生式体id索引*/
+    int bodyNum;
+} LrSymStat;
+
+/*获取符号字符串的函数，只在第一次归约时调用，返回值会被复制*/
+typedef const char *(LrParseStatSymStr)(const void *arg, int symId);
+
+/*语法分析统计，可以在多次分析之间累计*/
+typedef struct _LrParseStat {
+    unsigned long parseNum;         /*分析次数*/
+    unsigned long shiftNum;         /*移入次数*/
+    unsigned long reduceNum;        /*归约次数，包括接受*/
+    unsigned long recoverNum;       /*错误恢复次数*/
+    unsigned long stackDepth;       /*当前格局栈深度*/
+    unsigned long maxStackDepth;    /*最大格局栈深度*/
+    LrSymStat *symArr;              /*按产生式头符号id索引*/
+    int symNum;
+    LrParseStatSymStr *symStr;
+    const void *symStrArg;
+} LrParseStat;
+
+int LrParseStatAlloc(LrParseStat **pStat);
+void LrParseStatFree(LrParseStat *stat);
+void LrParseStatSetSymStr(LrParseStat *stat, LrParseStatSymStr *symStr, const void *arg);
+
+uint64_t LrParseStatNow(void);
+void LrParseStatBegin(LrParseStat *stat);
+void LrParseStatShift(LrParseStat *stat);
+int LrParseStatReduce(LrParseStat *stat, int headSymId, int bodyId, int popNum,
+                      int handleFlag, uint64_t handleNs);
+void LrParseStatRecover(LrParseStat *stat, unsigned long stackDepth);
+
+int LrParseStatDump(const LrParseStat *stat, FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__LR_PARSE_STAT_H__*/
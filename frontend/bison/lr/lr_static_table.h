@@ -0,0 +1,111 @@
+#ifndef __LR_STATIC_TABLE_H__
+#define __LR_STATIC_TABLE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "lalr_parse_table.h"
+
+/*静态语法分析表中的归约动作*/
+typedef struct {
+    ActionType type;    /*LAT_REDUCT或者LAT_ACCEPT*/
+    int headSymId;      /*产生式头符号id*/
+    int bodyId;         /*产生式体id*/
+    int productId;      /*产生式编号，用于分派归约句柄，没有归约句柄时为-1*/
+    int popNum;         /*弹出格局栈的状态数，即产生式体的长度*/
+    int argNum;         /*传给归约句柄的栈顶参数个数，第一个参数是产生式体前面的参数*/
+    int bodyArgFlag;    /*为0时传给归约句柄的产生式体参数为NULL*/
+} LrStaticReduce;
+
+/*静态语法分析表中状态上的错误恢复目标*/
+typedef struct {
+    int16_t symId;      /*错误恢复非终结符号，没有时为-1*/
+    int16_t nextState;  /*GOTO(state, symId)*/
+} LrStaticRecover;
+
+typedef int (LrStaticReduceHandle)(int productId, void **headArg, void *prevArg, void *bodyArg[]);
+
+/*
+ * 静态语法分析表，由LalrEmitStaticTable生成C源文件，编译进程序的只读数据段。
+ * 符号id是稀疏的，表中只给出现在ACTION、GOTO或者FOLLOW集合中的符号保留一列，
+ * 符号id经symIdxArr映射成稠密的列下标后再查表。
+ **/
+typedef struct _LrStaticTable {
+    int stateNum;                       /*状态数*/
+    int symNum;                         /*符号id的范围[0, symNum)*/
+    int colNum;                         /*表的列数*/
+    int endSymId;                       /*结束符号id*/
+    const int16_t *symIdxArr;           /*[symNum]，符号id对应的列下标，不在表中的符号为-1*/
+    const int16_t *tableArr;            /*[stateNum][colNum]，终结符号上是ACTION，非终结符号上是GOTO*/
+    const LrStaticReduce *reduceArr;    /*归约动作*/
+    const int16_t *defaultArr;          /*[stateNum]，状态的默认归约表项，0表示没有默认归约，可以为NULL*/
+    unsigned int followWords;           /*FOLLOW集合位集合的字数，位集合按列下标编号*/
+    const uint32_t *followArr;          /*[colNum][followWords]，非终结符号的FOLLOW集合*/
+    const LrStaticRecover *recoverArr;  /*[stateNum]，按生成时给定的错误恢复非终结符号计算，
+                                          不为NULL时错误恢复使用它，不再查找LrErrorRecover中的符号*/
+    const char *const *symStrArr;       /*[colNum]，符号的字符串*/
+    LrStaticReduceHandle *reduceHandle; /*按产生式编号分派的归约函数*/
+} LrStaticTable;
+
+/*
+ * 表项编码：
+ *      0：错误；
+ *      大于0：移入或者GOTO，下一个状态是表项值减1；
+ *      小于0：归约或者接受，归约动作下标是-表项值-1。
+ **/
+#define LR_STATIC_ERROR             0
+#define LR_STATIC_IS_NEXT(v)        ((v) > 0)
+#define LR_STATIC_NEXT_STATE(v)     ((v) - 1)
+#define LR_STATIC_REDUCE_IDX(v)     (-(v) - 1)
+
+/*
+ * 功能：获取符号symId在静态语法分析表中的列下标。
+ * 返回值：列下标，符号不在表中时返回-1。
+ **/
+static inline int LrStaticTableSymIdx(const LrStaticTable *table, int symId)
+{
+    if (symId < 0 || symId >= table->symNum)
+        return -1;
+    return table->symIdxArr[symId];
+}
+
+/*
+ * 功能：获取静态语法分析表中状态state在符号symId上的表项。
+ * 返回值：表项值。
+ **/
+static inline int LrStaticTableEntry(const LrStaticTable *table, int state, int symId)
+{
+    int idx = LrStaticTableSymIdx(table, symId);
+
+    if (state < 0 || state >= table->stateNum || idx < 0)
+        return LR_STATIC_ERROR;
+    return table->tableArr[state * table->colNum + idx];
+}
+
+/*
+ * 功能：获取静态语法分析表中状态state的默认归约。
+ * 返回值：默认归约的表项值，没有默认归约时返回LR_STATIC_ERROR。
+ **/
+static inline int LrStaticTableDefault(const LrStaticTable *table, int state)
+{
+    if (!table->defaultArr || state < 0 || state >= table->stateNum)
+        return LR_STATIC_ERROR;
+    return table->defaultArr[state];
+}
+
+static inline const char *LrStaticTableSymStr(const LrStaticTable *table, int symId)
+{
+    int idx = LrStaticTableSymIdx(table, symId);
+
+    if (idx < 0 || !table->symStrArr[idx])
+        return "?";
+    return table->symStrArr[idx];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__LR_STATIC_TABLE_H__*/
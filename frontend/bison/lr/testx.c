@@ -1,5 +1,6 @@
 #include "context_free_grammar.h"
 #include "lalr_parse_table.h"
+#include "lalr_lookahead.h"
 #include "error_recover.h"
 #include "lr_parse_algorithm.h"
 #include "list.h"
@@ -664,6 +665,9 @@ static int BuildRegExTree(Lex *lex)
     CfgPrintProduct(grammar);
     fflush(stdout);
 
+    error = LalrCheckLookahead(grammar, NULL, NULL);
+    if (error != -ENOERR)
+        goto err1;
     error = LalrAlloc(&lalr, grammar, NULL, NULL);
     if (error != -ENOERR)
         goto err1;
@@ -29,7 +29,23 @@ static void *QRMAlloc(size_t size)
     p = CplAlloc(size);
     if (!p) {
         PrErr("no memory");
-        exit(-1);
+        CplExit(-1);
+    }
+    return p;
+}
+
+/*
+ * 功能：从编译单元的区域分配器中分配四元式操作数，如果失败则程序直接退出。
+ * 返回值：
+ **/
+static void *QRArenaAlloc(Bison *ctx, size_t size)
+{
+    void *p;
+
+    p = CplArenaAlloc(ctx->arena, size);
+    if (!p) {
+        PrErr("no memory");
+        CplExit(-1);
     }
     return p;
 }
@@ -135,6 +151,25 @@ int QRRecordAddCondJump(QRRecord *record, QROpCode op, Expr *cond, size_t label)
     return 0;
 }
 
+/*
+ * 功能：添加跳转表跳转。四元式直接引用目标标号数组，数组必须从编译单元的区域分配器中分配。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int QRRecordAddTableJump(QRRecord *record, QROperand *idx, size_t *labelArr, size_t labelNum)
+{
+    QuadRuple *qr;
+
+    if (!record || !idx || !labelArr || labelNum == 0)
+        return -EINVAL;
+
+    qr = QRRecordAllocQuadRuple(record);
+    qr->op = QROC_TABLE_JUMP;
+    qr->tableJump.idx = idx;
+    qr->tableJump.labelArr = labelArr;
+    qr->tableJump.labelNum = labelNum;
+    return 0;
+}
+
 int QRRecordAddReturnVoid(QRRecord *record, Domain *domain)
 {
     QuadRuple *qr;
@@ -290,6 +325,114 @@ int QRRecordAddProgramEnd(QRRecord *record, Domain *domain)
     return 0;
 }
 
+/*
+ * 功能：删除keepArr[i]为0的四元式，剩下的四元式保持原来的顺序。跳转到被删除的四元式的标号
+ *      改成它之后第一条保留的四元式，所以只能删除不改变控制流的四元式或者不可达的四元式。
+ * keepArr：按四元式下标索引，长度为record->idx
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int QRRecordCompact(QRRecord *record, const uint8_t *keepArr)
+{
+    QuadRuple *qr;
+    size_t *mapArr;
+    size_t i, k, num;
+
+    if (!record || !keepArr)
+        return -EINVAL;
+    mapArr = CplAlloc((record->idx + 1) * sizeof (*mapArr));
+    if (!mapArr)
+        return -ENOMEM;
+    num = 0;
+    for (i = 0; i < record->idx; i++) {
+        mapArr[i] = num;
+        num += keepArr[i] ? 1 : 0;
+    }
+    mapArr[record->idx] = num;
+
+    num = 0;
+    for (i = 0; i < record->idx; i++) {
+        if (!keepArr[i])
+            continue;
+        qr = &record->qrArr[i];
+        switch (qr->op) {
+        case QROC_JUMP:
+            qr->uncondJump.dstLabel = mapArr[qr->uncondJump.dstLabel];
+            break;
+        case QROC_TRUE_JUMP:
+        case QROC_FALSE_JUMP:
+            qr->condJump.dstLabel = mapArr[qr->condJump.dstLabel];
+            break;
+        case QROC_TABLE_JUMP:
+            for (k = 0; k < qr->tableJump.labelNum; k++)
+                qr->tableJump.labelArr[k] = mapArr[qr->tableJump.labelArr[k]];
+            break;
+        default:
+            break;
+        }
+        record->qrArr[num++] = *qr;
+    }
+    record->idx = num;
+    CplFree(mapArr);
+    return 0;
+}
+
+static size_t QRMapLabel(size_t label, size_t start, size_t end, const size_t *mapArr)
+{
+    return label >= start && label < end ? mapArr[label - start] : label;
+}
+
+/*
+ * 功能：重排[start, end)中的四元式，orderArr[k]是放到start + k处的四元式原来的下标。
+ *      区间中的跳转标号改成目标四元式的新位置，调用者保证区间外没有跳转到区间中，
+ *      并且重排不改变控制流。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int QRRecordPermute(QRRecord *record, size_t start, size_t end, const size_t *orderArr)
+{
+    QuadRuple *qrArr, *qr;
+    size_t *mapArr;
+    size_t i, k, num;
+
+    if (!record || !orderArr || start > end || end > record->idx)
+        return -EINVAL;
+    num = end - start;
+    if (!num)
+        return 0;
+    qrArr = CplAlloc(num * sizeof (*qrArr));
+    mapArr = CplAlloc(num * sizeof (*mapArr));
+    if (!qrArr || !mapArr) {
+        CplFree(qrArr);
+        CplFree(mapArr);
+        return -ENOMEM;
+    }
+    for (i = 0; i < num; i++) {
+        mapArr[orderArr[i] - start] = start + i;
+        qrArr[i] = record->qrArr[orderArr[i]];
+    }
+    for (i = 0; i < num; i++) {
+        qr = &qrArr[i];
+        switch (qr->op) {
+        case QROC_JUMP:
+            qr->uncondJump.dstLabel = QRMapLabel(qr->uncondJump.dstLabel, start, end, mapArr);
+            break;
+        case QROC_TRUE_JUMP:
+        case QROC_FALSE_JUMP:
+            qr->condJump.dstLabel = QRMapLabel(qr->condJump.dstLabel, start, end, mapArr);
+            break;
+        case QROC_TABLE_JUMP:
+            for (k = 0; k < qr->tableJump.labelNum; k++)
+                qr->tableJump.labelArr[k] = QRMapLabel(qr->tableJump.labelArr[k], start, end, mapArr);
+            break;
+        default:
+            break;
+        }
+    }
+    memcpy(&record->qrArr[start], qrArr, num * sizeof (*qrArr));
+    CplFree(qrArr);
+    CplFree(mapArr);
+    return 0;
+}
+
 size_t QRecordCount(QRRecord *record)
 {
     if (record)
@@ -309,7 +452,7 @@ static void QRStringAppend(CplString *cplString, const char *str)
     error = CplStringAppendString(cplString, str);
     if (error != -ENOERR) {
         PrErr("append string error");
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -343,7 +486,7 @@ static CplString *QRAccessMemOffsetString(const QRAccessMbrOffset *amOffset)
         return QROperandTempString(amOffset->tempOffset.temp);
     default:
         PrErr("amOffset->offsetType error: %d", amOffset->offsetType);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -359,7 +502,7 @@ static CplString *QROperandAccessMemString(const QRAccessMbr *accessMem)
             QRStringAppend(cplString, accessMem->baseId.token->cplString->str);
         } else {
             PrErr("accessMem->baseType error: %d", accessMem->baseType);
-            exit(-1);
+            CplExit(-1);
         }
     } else if (accessMem->type == QRAMT_INDIRECT) {
         if (accessMem->baseType == QRAMBT_ID) {
@@ -375,11 +518,11 @@ static CplString *QROperandAccessMemString(const QRAccessMbr *accessMem)
             QRStringAppend(cplString, ")");
         } else {
             PrErr("accessMem->baseType error: %d", accessMem->baseType);
-            exit(-1);
+            CplExit(-1);
         }
     } else {
         PrErr("accessMem->accessType error: %d", accessMem->type);
-        exit(-1);
+        CplExit(-1);
     }
     QRStringAppend(cplString, ".");
     QRStringAppend(cplString, idxString->str);
@@ -398,7 +541,7 @@ static CplString *QROperandValString(const QRValue *val)
         snprintf(buffer, sizeof (buffer), "%f", val->fval);
     } else {
         PrErr("val->type error: %d", val->type);
-        exit(-1);
+        CplExit(-1);
     }
     QRStringAppend(cplString, buffer);
     return cplString;
@@ -430,7 +573,7 @@ static CplString *QROperandGetAddrString(const QRGetAddr *getAddr)
         break;
     default:
         PrErr("getAddr->type error: %d", getAddr->type);
-        exit(-1);
+        CplExit(-1);
     }
     CplStringAppendString(cplString, tempStr->str);
     CplStringFree(tempStr);
@@ -452,7 +595,7 @@ static CplString *QROperandString(QROperand *operand)
         return QROperandGetAddrString(&operand->getAddr);
     default:
         PrErr("operand->type error: %d", operand->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -480,7 +623,7 @@ void QRPrintBinOp(const QuadRuple *ruple)
         break;
     default:
         PrErr("");
-        exit(-1);
+        CplExit(-1);
     }
     QREmit("%s = %s %s %s\n",
            QROperandString(ruple->binOp.result)->str,
@@ -495,22 +638,32 @@ void QRPrintJump(const QuadRuple *ruple)
     QREmit("goto %u\n", ruple->uncondJump.dstLabel);
 }
 
-void QRPrintCondJump(const QuadRuple *ruple)
+void QRPrintCondJump(Bison *ctx, const QuadRuple *ruple)
 {
     if (ruple->op == QROC_TRUE_JUMP) {
         QREmit("if %s goto %u\n",
-                ATreeExprString(ruple->condJump.cond)->str,
+                ATreeExprString(ctx, ruple->condJump.cond)->str,
                 ruple->condJump.dstLabel);
     } else if (ruple->op == QROC_FALSE_JUMP) {
         QREmit("iffalse %s goto %u\n",
-                ATreeExprString(ruple->condJump.cond)->str,
+                ATreeExprString(ctx, ruple->condJump.cond)->str,
                 ruple->condJump.dstLabel);
     } else {
         PrErr("");
-        exit(-1);
+        CplExit(-1);
     }
 }
 
+void QRPrintTableJump(const QuadRuple *ruple)
+{
+    size_t i;
+
+    QREmit("goto %s of [", QROperandString(ruple->tableJump.idx)->str);
+    for (i = 0; i < ruple->tableJump.labelNum; i++)
+        QREmit("%s%zu", i ? ", " : "", ruple->tableJump.labelArr[i]);
+    QREmit("]\n");
+}
+
 void QRPrintAssign(const QuadRuple *ruple)
 {
     QREmit("%s = %s\n",
@@ -522,7 +675,7 @@ void QRPrintRel(const QuadRuple *ruple)
 {
     (void)ruple;
     PrErr("error");
-    exit(-1);
+    CplExit(-1);
 }
 
 void QRPrintReturnVoid(const QuadRuple *ruple)
@@ -594,7 +747,7 @@ void QRPrintProgramEnd(const QuadRuple *ruple)
     (void)ruple;
 }
 
-void QRQuardRuplePrint(const QuadRuple *ruple)
+void QRQuardRuplePrint(Bison *ctx, const QuadRuple *ruple)
 {
     switch (ruple->op) {
     case QROC_ADD:
@@ -607,7 +760,9 @@ void QRQuardRuplePrint(const QuadRuple *ruple)
         return QRPrintJump(ruple);
     case QROC_TRUE_JUMP:
     case QROC_FALSE_JUMP:
-        return QRPrintCondJump(ruple);
+        return QRPrintCondJump(ctx, ruple);
+    case QROC_TABLE_JUMP:
+        return QRPrintTableJump(ruple);
     case QROC_ASSIGN:
         return QRPrintAssign(ruple);
     case QROC_EQ:
@@ -641,11 +796,11 @@ void QRQuardRuplePrint(const QuadRuple *ruple)
         return QRPrintProgramEnd(ruple);
     default:
         PrErr("unknown ruple->op: %u", ruple->op);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
-void QRPrintRecord(const QRRecord *record)
+void QRPrintRecord(Bison *ctx, const QRRecord *record)
 {
     size_t w;
 
@@ -653,15 +808,15 @@ void QRPrintRecord(const QRRecord *record)
         return;
     for (w = 0; w < record->idx; w++) {
         QREmit("%04u: ", w);
-        QRQuardRuplePrint(&record->qrArr[w]);
+        QRQuardRuplePrint(ctx, &record->qrArr[w]);
     }
 }
 
-QROperand *QRNewIdOperand(Domain *domain, Type *dataType, const Token *token)
+QROperand *QRNewIdOperand(Bison *ctx, Domain *domain, Type *dataType, const Token *token)
 {
     QROperand *operand;
 
-    operand = QRMAlloc(sizeof (*operand));
+    operand = QRArenaAlloc(ctx, sizeof (*operand));
     operand->domain = domain;
     operand->type = QROT_ID;
     operand->id.dataType = dataType;
@@ -669,11 +824,11 @@ QROperand *QRNewIdOperand(Domain *domain, Type *dataType, const Token *token)
     return operand;
 }
 
-QROperand *QRNewAccessMemOperandIdBase(Domain *domain, Type *mbrDataType, const Token *token, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *baseDataType)
+QROperand *QRNewAccessMemOperandIdBase(Bison *ctx, Domain *domain, Type *mbrDataType, const Token *token, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *baseDataType)
 {
     QROperand *operand;
 
-    operand = QRMAlloc(sizeof (*operand));
+    operand = QRArenaAlloc(ctx, sizeof (*operand));
     operand->domain = domain;
     operand->type = QROT_ACCESS_MBR;
     operand->accessMbr.type = accessType;
@@ -685,11 +840,11 @@ QROperand *QRNewAccessMemOperandIdBase(Domain *domain, Type *mbrDataType, const
     return operand;
 }
 
-QROperand *QRNewAccessMemOperandTempBase(Domain *domain, Type *mbrDataType, Temp *temp, QRAccessMbrOffset *offset, QRAccessMbrType accessType)
+QROperand *QRNewAccessMemOperandTempBase(Bison *ctx, Domain *domain, Type *mbrDataType, Temp *temp, QRAccessMbrOffset *offset, QRAccessMbrType accessType)
 {
     QROperand *operand;
 
-    operand = QRMAlloc(sizeof (*operand));
+    operand = QRArenaAlloc(ctx, sizeof (*operand));
     operand->domain = domain;
     operand->type = QROT_ACCESS_MBR;
     operand->accessMbr.type = accessType;
@@ -701,11 +856,11 @@ QROperand *QRNewAccessMemOperandTempBase(Domain *domain, Type *mbrDataType, Temp
     return operand;
 }
 
-QROperand *QRNewValIntOperand(Domain *domain, int val)
+QROperand *QRNewValIntOperand(Bison *ctx, Domain *domain, int val)
 {
     QROperand *operand;
 
-    operand = QRMAlloc(sizeof (*operand));
+    operand = QRArenaAlloc(ctx, sizeof (*operand));
     operand->domain = domain;
     operand->type = QROT_VAL;
     operand->val.type = QRVT_INT;
@@ -713,11 +868,11 @@ QROperand *QRNewValIntOperand(Domain *domain, int val)
     return operand;
 }
 
-QROperand *QRNewValFloatOperand(Domain *domain, float val)
+QROperand *QRNewValFloatOperand(Bison *ctx, Domain *domain, float val)
 {
     QROperand *operand;
 
-    operand = QRMAlloc(sizeof (*operand));
+    operand = QRArenaAlloc(ctx, sizeof (*operand));
     operand->domain = domain;
     operand->type = QROT_VAL;
     operand->val.type = QRVT_FLOAT;
@@ -725,22 +880,35 @@ QROperand *QRNewValFloatOperand(Domain *domain, float val)
     return operand;
 }
 
-QROperand *QRNewTempOperand(Domain *domain, Temp *temp)
+QROperand *QRNewTempOperand(Bison *ctx, Domain *domain, Temp *temp)
 {
     QROperand *operand;
 
-    operand = QRMAlloc(sizeof (*operand));
+    operand = QRArenaAlloc(ctx, sizeof (*operand));
     operand->domain = domain;
     operand->type = QROT_TEMP;
     operand->temp = temp;
     return operand;
 }
 
-QROperand *QRNewGetAddrIdOperand(Domain *domain, Type *idDataType, const Token *token, Type *dataType)
+/*
+ * 功能：复制操作数，修改副本不影响其它四元式引用的操作数。
+ * 返回值：
+ **/
+QROperand *QRCopyOperand(Bison *ctx, const QROperand *operand)
+{
+    QROperand *newOperand;
+
+    newOperand = QRArenaAlloc(ctx, sizeof (*newOperand));
+    *newOperand = *operand;
+    return newOperand;
+}
+
+QROperand *QRNewGetAddrIdOperand(Bison *ctx, Domain *domain, Type *idDataType, const Token *token, Type *dataType)
 {
     QROperand *operand;
 
-    operand = QRMAlloc(sizeof (*operand));
+    operand = QRArenaAlloc(ctx, sizeof (*operand));
     operand->domain = domain;
     operand->type = QROT_GET_ADDR;
     operand->getAddr.dataType = dataType;
@@ -750,11 +918,11 @@ QROperand *QRNewGetAddrIdOperand(Domain *domain, Type *idDataType, const Token *
     return operand;
 }
 
-QROperand *QRNewGetAddrAccessMemOperand(Domain *domain, Type *amDataType, const Token *token, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *dataType)
+QROperand *QRNewGetAddrAccessMemOperand(Bison *ctx, Domain *domain, Type *amDataType, const Token *token, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *dataType)
 {
     QROperand *operand;
 
-    operand = QRMAlloc(sizeof (*operand));
+    operand = QRArenaAlloc(ctx, sizeof (*operand));
     operand->domain = domain;
     operand->type = QROT_GET_ADDR;
     operand->getAddr.type = QRGAT_ACCESS_MEM;
@@ -767,11 +935,11 @@ QROperand *QRNewGetAddrAccessMemOperand(Domain *domain, Type *amDataType, const
     return operand;
 }
 
-QROperand *QRNewGetAddrAccessMemOperandTempBase(Domain *domain, Type *amDataType, Temp *temp, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *dataType)
+QROperand *QRNewGetAddrAccessMemOperandTempBase(Bison *ctx, Domain *domain, Type *amDataType, Temp *temp, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *dataType)
 {
     QROperand *operand;
 
-    operand = QRMAlloc(sizeof (*operand));
+    operand = QRArenaAlloc(ctx, sizeof (*operand));
     operand->domain = domain;
     operand->type = QROT_GET_ADDR;
     operand->getAddr.type = QRGAT_ACCESS_MEM;
@@ -784,21 +952,21 @@ QROperand *QRNewGetAddrAccessMemOperandTempBase(Domain *domain, Type *amDataType
     return operand;
 }
 
-QRAccessMbrOffset *QRNewAccessMemOffsetVal(int val)
+QRAccessMbrOffset *QRNewAccessMemOffsetVal(Bison *ctx, int val)
 {
     QRAccessMbrOffset *amOffset;
 
-    amOffset = QRMAlloc(sizeof (*amOffset));
+    amOffset = QRArenaAlloc(ctx, sizeof (*amOffset));
     amOffset->offsetType = QRAMOT_VAL;
     amOffset->valOffset = val;
     return amOffset;
 }
 
-QRAccessMbrOffset *QRNewAccessMemOffsetId(Domain *domain, Type *dataType, const Token *token)
+QRAccessMbrOffset *QRNewAccessMemOffsetId(Bison *ctx, Domain *domain, Type *dataType, const Token *token)
 {
     QRAccessMbrOffset *amOffset;
 
-    amOffset = QRMAlloc(sizeof (*amOffset));
+    amOffset = QRArenaAlloc(ctx, sizeof (*amOffset));
     amOffset->offsetType = QRAMOT_ID;
     amOffset->idOffset.domain = domain;
     amOffset->idOffset.id.dataType = dataType;
@@ -806,238 +974,246 @@ QRAccessMbrOffset *QRNewAccessMemOffsetId(Domain *domain, Type *dataType, const
     return amOffset;
 }
 
-QRAccessMbrOffset *QRNewAccessMemOffsetTemp(Domain *domain, Temp *temp)
+QRAccessMbrOffset *QRNewAccessMemOffsetTemp(Bison *ctx, Domain *domain, Temp *temp)
 {
     QRAccessMbrOffset *amOffset;
 
-    amOffset = QRMAlloc(sizeof (*amOffset));
+    amOffset = QRArenaAlloc(ctx, sizeof (*amOffset));
     amOffset->offsetType = QRAMOT_TEMP;
     amOffset->tempOffset.domain = domain;
     amOffset->tempOffset.temp = temp;
     return amOffset;
 }
 
-static QRAccessMbrOffset *QRAMOffsetFromConstExpr(CValue *cValue)
+static QRAccessMbrOffset *QRAMOffsetFromConstExpr(Bison *ctx, CValue *cValue)
 {
     switch (cValue->type) {
     case CVT_IDIGIT:
-        return QRNewAccessMemOffsetVal(cValue->token->digit);
+        return QRNewAccessMemOffsetVal(ctx, cValue->token->digit);
     case CVT_TRUE:
-        return QRNewAccessMemOffsetVal(1);
+        return QRNewAccessMemOffsetVal(ctx, 1);
     case CVT_FALSE:
-        return QRNewAccessMemOffsetVal(0);
+        return QRNewAccessMemOffsetVal(ctx, 0);
     default:
         PrErr("cValue->type error: %d", cValue->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
-static QRAccessMbrOffset *QRAMOffsetFromLValueExpr(Domain *domain, LValue *lvalue)
+static QRAccessMbrOffset *QRAMOffsetFromLValueExpr(Bison *ctx, Domain *domain, LValue *lvalue)
 {
     if (lvalue->dims == NULL) {
-        return QRNewAccessMemOffsetId(domain, lvalue->type, lvalue->id);
+        return QRNewAccessMemOffsetId(ctx, domain, lvalue->type, lvalue->id);
     } else {
         PrErr("lvalue->dims error: %p", lvalue->dims);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
-static QRAccessMbrOffset *QRAMOffsetFromIdExpr(Domain *domain, Id *idExpr)
+static QRAccessMbrOffset *QRAMOffsetFromIdExpr(Bison *ctx, Domain *domain, Id *idExpr)
 {
-    return QRNewAccessMemOffsetId(domain, idExpr->type, idExpr->token);
+    return QRNewAccessMemOffsetId(ctx, domain, idExpr->type, idExpr->token);
 }
 
-static QRAccessMbrOffset *QRAMOffsetFromTempExpr(Domain *domain, Temp *temp)
+static QRAccessMbrOffset *QRAMOffsetFromTempExpr(Bison *ctx, Domain *domain, Temp *temp)
 {
-    return QRNewAccessMemOffsetTemp(domain, temp);
+    return QRNewAccessMemOffsetTemp(ctx, domain, temp);
 }
 
-static QRAccessMbrOffset *QRAMOffsetFromConsSpcExpr(CValueSpc *cValueSpc)
+static QRAccessMbrOffset *QRAMOffsetFromConsSpcExpr(Bison *ctx, CValueSpc *cValueSpc)
 {
     switch (cValueSpc->type) {
     case CVTS_IDIGIT:
-        return QRNewAccessMemOffsetVal(cValueSpc->iValue);
+        return QRNewAccessMemOffsetVal(ctx, cValueSpc->iValue);
     case CVTS_TRUE:
-        return QRNewAccessMemOffsetVal(1);
+        return QRNewAccessMemOffsetVal(ctx, 1);
     case CVTS_FALSE:
-        return QRNewAccessMemOffsetVal(0);
+        return QRNewAccessMemOffsetVal(ctx, 0);
     default:
         PrErr("cValue->type error: %d", cValueSpc->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
-static QRAccessMbrOffset *QRAMOffsetFromExpr(Expr *expr)
+static QRAccessMbrOffset *QRAMOffsetFromExpr(Bison *ctx, Expr *expr)
 {
     switch (expr->type) {
     case ET_CONST:
-        return QRAMOffsetFromConstExpr(&expr->cValue);
+        return QRAMOffsetFromConstExpr(ctx, &expr->cValue);
     case ET_TEMP:
-        return QRAMOffsetFromTempExpr(expr->domain, &expr->temp);
+        return QRAMOffsetFromTempExpr(ctx, expr->domain, &expr->temp);
     case ET_CONST_SPC:
-        return QRAMOffsetFromConsSpcExpr(&expr->cValueSpc);
+        return QRAMOffsetFromConsSpcExpr(ctx, &expr->cValueSpc);
     case ET_ID:
-        return QRAMOffsetFromIdExpr(expr->domain, &expr->id);
+        return QRAMOffsetFromIdExpr(ctx, expr->domain, &expr->id);
     default:
         PrErr("expr->type error: %d", expr->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
-static QROperand *QROperandFromConstExpr(Domain *domain, CValue *cValue)
+static QROperand *QROperandFromConstExpr(Bison *ctx, Domain *domain, CValue *cValue)
 {
     switch (cValue->type) {
     case CVT_IDIGIT:
-        return QRNewValIntOperand(domain, cValue->token->digit);
+        return QRNewValIntOperand(ctx, domain, cValue->token->digit);
     case CVT_FDIGIT:
-        return QRNewValFloatOperand(domain, cValue->token->fDigit);
+        return QRNewValFloatOperand(ctx, domain, cValue->token->fDigit);
     case CVT_TRUE:
-        return QRNewValIntOperand(domain, 1);
+        return QRNewValIntOperand(ctx, domain, 1);
     case CVT_FALSE:
-        return QRNewValIntOperand(domain, 0);
+        return QRNewValIntOperand(ctx, domain, 0);
     default:
         PrErr("cValue->type error: %d", cValue->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
-static QROperand *QROperandFromLValueExpr(Domain *domain, LValue *lValue)
+static QROperand *QROperandFromLValueExpr(Bison *ctx, Domain *domain, LValue *lValue)
 {
     if (lValue->dims == NULL) {
-        return QRNewIdOperand(domain, lValue->type, lValue->id);
+        return QRNewIdOperand(ctx, domain, lValue->type, lValue->id);
     } else {
         if (lValue->dims->nextDims == NULL) {
-            return QRNewAccessMemOperandIdBase(domain, lValue->dims->type, lValue->id, QRAMOffsetFromExpr(lValue->dims->idx), QRAMT_DIRECT, lValue->type);
+            return QRNewAccessMemOperandIdBase(ctx, domain, lValue->dims->type, lValue->id, QRAMOffsetFromExpr(ctx, ATreeExpr(ctx, lValue->dims->idx)), QRAMT_DIRECT, lValue->type);
         } else {
             PrErr("lValue->dims->nextDims error: %p", lValue->dims->nextDims);
-            exit(-1);
+            CplExit(-1);
         }
     }
 }
 
-static QROperand *QROperandFromIdExpr(Domain *domain, Id *id)
+static QROperand *QROperandFromIdExpr(Bison *ctx, Domain *domain, Id *id)
 {
-    return QRNewIdOperand(domain, id->type, id->token);
+    return QRNewIdOperand(ctx, domain, id->type, id->token);
 }
 
-static QROperand *QROperandFromTempExpr(Domain *domain, Temp *temp)
+static QROperand *QROperandFromTempExpr(Bison *ctx, Domain *domain, Temp *temp)
 {
-    return QRNewTempOperand(domain, temp);
+    return QRNewTempOperand(ctx, domain, temp);
 }
 
-static QROperand *QROperandFromConstSpcExpr(Domain *domain, CValueSpc *cValueSpc)
+static QROperand *QROperandFromConstSpcExpr(Bison *ctx, Domain *domain, CValueSpc *cValueSpc)
 {
     switch (cValueSpc->type) {
     case CVTS_IDIGIT:
-        return QRNewValIntOperand(domain, cValueSpc->iValue);
+        return QRNewValIntOperand(ctx, domain, cValueSpc->iValue);
     case CVTS_FDIGIT:
-        return QRNewValFloatOperand(domain, cValueSpc->fValue);
+        return QRNewValFloatOperand(ctx, domain, cValueSpc->fValue);
     case CVTS_TRUE:
-        return QRNewValIntOperand(domain, 1);
+        return QRNewValIntOperand(ctx, domain, 1);
     case CVTS_FALSE:
-        return QRNewValIntOperand(domain, 0);
+        return QRNewValIntOperand(ctx, domain, 0);
     default:
         PrErr("cValueSpc->type error: %d", cValueSpc->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
-static QROperand *QROperandFromMemAccessExpr(Domain *domain, AccessMbr *memAccess)
+static QROperand *QROperandFromMemAccessExpr(Bison *ctx, Domain *domain, AccessMbr *memAccess)
 {
+    Expr *base = ATreeExpr(ctx, memAccess->base);
+    Expr *memOffset = ATreeExpr(ctx, memAccess->memOffset);
+
     if (memAccess->type == AMTYPE_DIRECT) {
-        if (memAccess->base->type == ET_ID) {
-            return QRNewAccessMemOperandIdBase(domain, memAccess->memtype, memAccess->base->id.token,
-                                               QRAMOffsetFromExpr(memAccess->memOffset), QRAMT_DIRECT, memAccess->base->id.type);
+        if (base->type == ET_ID) {
+            return QRNewAccessMemOperandIdBase(ctx, domain, memAccess->memtype, base->id.token,
+                                               QRAMOffsetFromExpr(ctx, memOffset), QRAMT_DIRECT, base->id.type);
         } else {
-            PrErr("memAccess->base->type error: %d", memAccess->base->type);
-            exit(-1);
+            PrErr("memAccess->base->type error: %d", base->type);
+            CplExit(-1);
         }
     } else if (memAccess->type == AMTYPE_INDIRECT) {
-        if (memAccess->base->type == ET_ID) {
-            return QRNewAccessMemOperandIdBase(domain, memAccess->memtype, memAccess->base->id.token,
-                                               QRAMOffsetFromExpr(memAccess->memOffset), QRAMT_INDIRECT, memAccess->base->id.type);
-        } else if (memAccess->base->type == ET_TEMP) {
-            return QRNewAccessMemOperandTempBase(domain, memAccess->memtype, &memAccess->base->temp,
-                                               QRAMOffsetFromExpr(memAccess->memOffset), QRAMT_INDIRECT);
+        if (base->type == ET_ID) {
+            return QRNewAccessMemOperandIdBase(ctx, domain, memAccess->memtype, base->id.token,
+                                               QRAMOffsetFromExpr(ctx, memOffset), QRAMT_INDIRECT, base->id.type);
+        } else if (base->type == ET_TEMP) {
+            return QRNewAccessMemOperandTempBase(ctx, domain, memAccess->memtype, &base->temp,
+                                               QRAMOffsetFromExpr(ctx, memOffset), QRAMT_INDIRECT);
         } else {
-            PrErr("memAccess->base->type error: %d", memAccess->base->type);
-            exit(-1);
+            PrErr("memAccess->base->type error: %d", base->type);
+            CplExit(-1);
         }
     } else {
         PrErr("memAccess->type error: %d", memAccess->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
-QROperand *QRNewOpMemVarOperand(Domain *domain, Type *memType, const Token *token, Type *idType)
+QROperand *QRNewOpMemVarOperand(Bison *ctx, Domain *domain, Type *memType, const Token *token, Type *idType)
 {
     QRAccessMbrOffset *offset;
 
-    offset = QRNewAccessMemOffsetVal(0);
-    return QRNewAccessMemOperandIdBase(domain, memType, token, offset, QRAMT_INDIRECT, idType);
+    offset = QRNewAccessMemOffsetVal(ctx, 0);
+    return QRNewAccessMemOperandIdBase(ctx, domain, memType, token, offset, QRAMT_INDIRECT, idType);
 }
 
-QROperand *QRNewOpMemTempOperand(Domain *domain, Type *memType, Temp *temp)
+QROperand *QRNewOpMemTempOperand(Bison *ctx, Domain *domain, Type *memType, Temp *temp)
 {
     QRAccessMbrOffset *offset;
 
-    offset = QRNewAccessMemOffsetVal(0);
-    return QRNewAccessMemOperandTempBase(domain, memType, temp, offset, QRAMT_INDIRECT);
+    offset = QRNewAccessMemOffsetVal(ctx, 0);
+    return QRNewAccessMemOperandTempBase(ctx, domain, memType, temp, offset, QRAMT_INDIRECT);
 }
 
-static QROperand *QROperandFromRefPointerExpr(Domain *domain, UnaryOp *unaryOp)
+static QROperand *QROperandFromRefPointerExpr(Bison *ctx, Domain *domain, UnaryOp *unaryOp)
 {
-    if (unaryOp->expr->type == ET_ID) {
-        return QRNewOpMemVarOperand(domain, unaryOp->type, unaryOp->expr->id.token, unaryOp->expr->id.type);
-    } else if(unaryOp->expr->type == ET_TEMP) {
-        return QRNewOpMemTempOperand(domain, unaryOp->type, &unaryOp->expr->temp);
+    Expr *expr = ATreeExpr(ctx, unaryOp->expr);
+
+    if (expr->type == ET_ID) {
+        return QRNewOpMemVarOperand(ctx, domain, unaryOp->type, expr->id.token, expr->id.type);
+    } else if(expr->type == ET_TEMP) {
+        return QRNewOpMemTempOperand(ctx, domain, unaryOp->type, &expr->temp);
     } else {
-        PrErr("unaryOp->expr->type error: %d", unaryOp->expr->type);
-        exit(-1);
+        PrErr("unaryOp->expr->type error: %d", expr->type);
+        CplExit(-1);
     }
 }
 
-static QROperand *QROperandFromGetAddrExpr(Domain *domain, UnaryOp *unaryOp)
+static QROperand *QROperandFromGetAddrExpr(Bison *ctx, Domain *domain, UnaryOp *unaryOp)
 {
-    if (unaryOp->expr->type == ET_ID) {
-        return QRNewGetAddrIdOperand(domain, unaryOp->expr->id.type, unaryOp->expr->id.token, unaryOp->type);
-    } else if (unaryOp->expr->type == ET_ACCESS_MBR) {
-        Expr *maExpr = unaryOp->expr;
+    Expr *expr = ATreeExpr(ctx, unaryOp->expr);
+
+    if (expr->type == ET_ID) {
+        return QRNewGetAddrIdOperand(ctx, domain, expr->id.type, expr->id.token, unaryOp->type);
+    } else if (expr->type == ET_ACCESS_MBR) {
+        Expr *maExpr = expr;
+        Expr *base = ATreeExpr(ctx, maExpr->accessMbr.base);
 
         if (maExpr->accessMbr.type == AMTYPE_DIRECT) {
-            if (maExpr->accessMbr.base->type == ET_ID) {
-                return QRNewGetAddrAccessMemOperand(domain, maExpr->accessMbr.memtype,
-                                                    maExpr->accessMbr.base->id.token,
-                                                    QRAMOffsetFromExpr(maExpr->accessMbr.memOffset),
+            if (base->type == ET_ID) {
+                return QRNewGetAddrAccessMemOperand(ctx, domain, maExpr->accessMbr.memtype,
+                                                    base->id.token,
+                                                    QRAMOffsetFromExpr(ctx, ATreeExpr(ctx, maExpr->accessMbr.memOffset)),
                                                     QRAMT_DIRECT, unaryOp->type);
             } else {
-                PrErr("maExpr->memAccess.base->type error: %d", maExpr->accessMbr.base->type);
-                exit(-1);
+                PrErr("maExpr->memAccess.base->type error: %d", base->type);
+                CplExit(-1);
             }
         } else if (maExpr->accessMbr.type == AMTYPE_INDIRECT) {
-            if (maExpr->accessMbr.base->type == ET_ID) {
-                return QRNewGetAddrAccessMemOperand(domain, maExpr->accessMbr.memtype,
-                                                    maExpr->accessMbr.base->id.token,
-                                                    QRAMOffsetFromExpr(maExpr->accessMbr.memOffset),
+            if (base->type == ET_ID) {
+                return QRNewGetAddrAccessMemOperand(ctx, domain, maExpr->accessMbr.memtype,
+                                                    base->id.token,
+                                                    QRAMOffsetFromExpr(ctx, ATreeExpr(ctx, maExpr->accessMbr.memOffset)),
                                                     QRAMT_INDIRECT, unaryOp->type);
-            } else if (maExpr->accessMbr.base->type == ET_TEMP) {
-                return QRNewGetAddrAccessMemOperandTempBase(domain, maExpr->accessMbr.memtype,
-                                                            &maExpr->accessMbr.base->temp,
-                                                            QRAMOffsetFromExpr(maExpr->accessMbr.memOffset),
+            } else if (base->type == ET_TEMP) {
+                return QRNewGetAddrAccessMemOperandTempBase(ctx, domain, maExpr->accessMbr.memtype,
+                                                            &base->temp,
+                                                            QRAMOffsetFromExpr(ctx, ATreeExpr(ctx, maExpr->accessMbr.memOffset)),
                                                             QRAMT_INDIRECT, unaryOp->type);
             } else {
-                PrErr("maExpr->memAccess.base->type error: %d", maExpr->accessMbr.base->type);
-                exit(-1);
+                PrErr("maExpr->memAccess.base->type error: %d", base->type);
+                CplExit(-1);
             }
         } else {
             PrErr("maExpr->memAccess.type error: %d", maExpr->accessMbr.type);
-            exit(-1);
+            CplExit(-1);
         }
-    } else if (unaryOp->expr->type == ET_ID) {
-        return QRNewGetAddrIdOperand(domain, unaryOp->expr->id.type, unaryOp->expr->id.token, unaryOp->type);
+    } else if (expr->type == ET_ID) {
+        return QRNewGetAddrIdOperand(ctx, domain, expr->id.type, expr->id.token, unaryOp->type);
     } else {
-        PrErr("unaryOp->expr->type error: %d", unaryOp->expr->type);
-        exit(-1);
+        PrErr("unaryOp->expr->type error: %d", expr->type);
+        CplExit(-1);
     }
 }
 
@@ -1045,41 +1221,41 @@ static QROperand *QROperandFromTypeCastExpr(Domain *domain, UnaryOp *unaryOp)
 {
     (void)domain, (void)unaryOp;
     PrErr("error");
-    exit(-1);
+    CplExit(-1);
 }
 
-QROperand *QROperandFromExpr(Expr *expr)
+QROperand *QROperandFromExpr(Bison *ctx, Expr *expr)
 {
     if (!expr) {
         PrErr("expr: %p", expr);
-        exit(-1);
+        CplExit(-1);
     }
     switch (expr->type) {
     case ET_CONST:
-        return QROperandFromConstExpr(expr->domain, &expr->cValue);
+        return QROperandFromConstExpr(ctx, expr->domain, &expr->cValue);
     case ET_TEMP:
-        return QROperandFromTempExpr(expr->domain, &expr->temp);
+        return QROperandFromTempExpr(ctx, expr->domain, &expr->temp);
     case ET_CONST_SPC:
-        return QROperandFromConstSpcExpr(expr->domain, &expr->cValueSpc);
+        return QROperandFromConstSpcExpr(ctx, expr->domain, &expr->cValueSpc);
     case ET_ACCESS_MBR:
-        return QROperandFromMemAccessExpr(expr->domain, &expr->accessMbr);
+        return QROperandFromMemAccessExpr(ctx, expr->domain, &expr->accessMbr);
     case ET_REF_POINTER:
-        return QROperandFromRefPointerExpr(expr->domain, &expr->unaryOp);
+        return QROperandFromRefPointerExpr(ctx, expr->domain, &expr->unaryOp);
     case ET_GET_ADDR:
-        return QROperandFromGetAddrExpr(expr->domain, &expr->unaryOp);
+        return QROperandFromGetAddrExpr(ctx, expr->domain, &expr->unaryOp);
     case ET_TYPE_CAST:
         return QROperandFromTypeCastExpr(expr->domain, &expr->unaryOp);
     case ET_ID:
-        return QROperandFromIdExpr(expr->domain, &expr->id);
+        return QROperandFromIdExpr(ctx, expr->domain, &expr->id);
     default:
         PrErr("expr->type error: %d", expr->type);
-        exit(-1);
+        CplExit(-1);
     }
 
 }
 
 #if 0
-static Type *QRGetDomainEntryDataType(Domain *domain, const Token *token, Type *type)
+static Type *QRGetDomainEntryDataType(Bison *ctx, Domain *domain, const Token *token, Type *type)
 {
     DomainEntry *entry;
 
@@ -1088,9 +1264,9 @@ static Type *QRGetDomainEntryDataType(Domain *domain, const Token *token, Type *
         return type;
     } else {
         if (type->type == TT_ARRAY) {
-            return ATreeNewPointerType(type->array.type);
+            return ATreeNewPointerType(ctx, type->array.type);
         } else if (type->type == TT_FUNCTION) {
-            return ATreeNewPointerType(type);
+            return ATreeNewPointerType(ctx, type);
         } else {
             return type;
         }
@@ -1098,7 +1274,7 @@ static Type *QRGetDomainEntryDataType(Domain *domain, const Token *token, Type *
 }
 #endif
 
-Type *QROperandDataType(QROperand *operand)
+Type *QROperandDataType(Bison *ctx, QROperand *operand)
 {
     switch (operand->type) {
     case QROT_ID:
@@ -1107,12 +1283,12 @@ Type *QROperandDataType(QROperand *operand)
         return operand->accessMbr.dataType;
     case QROT_VAL:
         if (operand->val.type == QRVT_INT) {
-            return bison->env->intType;
+            return ctx->env->intType;
         } else if (operand->val.type == QRVT_FLOAT) {
-            return bison->env->floatType;
+            return ctx->env->floatType;
         } else {
             PrErr("operand->val.type error: %d", operand->val.type);
-            exit(-1);
+            CplExit(-1);
         }
     case QROT_TEMP:
         return operand->temp->type;
@@ -1120,6 +1296,6 @@ Type *QROperandDataType(QROperand *operand)
         return operand->getAddr.dataType;
     default:
         PrErr("operand->type error: %d", operand->type);
-        exit(-1);
+        CplExit(-1);
     }
 }
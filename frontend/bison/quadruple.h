@@ -20,6 +20,7 @@ typedef enum {
     QROC_JUMP,          /*绝对跳转*/
     QROC_TRUE_JUMP,     /*真时跳转*/
     QROC_FALSE_JUMP,    /*假时跳转*/
+    QROC_TABLE_JUMP,    /*跳转表跳转*/
     QROC_ASSIGN,        /*赋值*/
     QROC_EQ,            /*相等*/
     QROC_NE,            /*不等*/
@@ -60,6 +61,11 @@ typedef struct _QuadRuple {
             Expr *cond;         /*条件表达式*/
             size_t dstLabel;    /*目标标号*/
         } condJump;             /*条件跳转*/
+        struct {
+            QROperand *idx;     /*跳转表下标，调用者保证在[0, labelNum)之内*/
+            size_t *labelArr;   /*目标标号数组*/
+            size_t labelNum;
+        } tableJump;            /*跳转表跳转*/
         struct {
             QROperand *expr;
             Domain *domain;
@@ -109,6 +115,7 @@ int QRRecordAddBin(QRRecord *record, QROpCode op, QROperand *arg1, QROperand *ar
 int QRRecordAddUnary(QRRecord *record, QROpCode op, QROperand *arg1, QROperand *result);
 int QRRecordAddUncondJump(QRRecord *record, size_t label);
 int QRRecordAddCondJump(QRRecord *record, QROpCode op, Expr *cond, size_t label);
+int QRRecordAddTableJump(QRRecord *record, QROperand *idx, size_t *labelArr, size_t labelNum);
 int QRRecordAddReturnVoid(QRRecord *record, Domain *domian);
 int QRRecordAddReturnValue(QRRecord *record, QROperand *expr, Domain *domain);
 int QRRecordAddFunParam(QRRecord *record, QROperand *expr);
@@ -120,8 +127,10 @@ int QRRecordAddBlkStart(QRRecord *record, Domain *domain);
 int QRRecordAddBlkEnd(QRRecord *record, Domain *domain);
 int QRRecordAddProgramStart(QRRecord *record, Domain *domain);
 int QRRecordAddProgramEnd(QRRecord *record, Domain *domain);
+int QRRecordCompact(QRRecord *record, const uint8_t *keepArr);
+int QRRecordPermute(QRRecord *record, size_t start, size_t end, const size_t *orderArr);
 
-void QRPrintRecord(const QRRecord *record);
+void QRPrintRecord(Bison *ctx, const QRRecord *record);
 
 typedef struct {
     Type *dataType;
@@ -224,23 +233,24 @@ typedef struct _QROperand {
     };
 } QROperand;
 
-QROperand *QRNewIdOperand(Domain *domain, Type *dataType, const Token *token);
-QROperand *QRNewAccessMemOperandIdBase(Domain *domain, Type *mbrDataType, const Token *token, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *baseDataType);
-QROperand *QRNewAccessMemOperandTempBase(Domain *domain, Type *mbrDataType, Temp *temp, QRAccessMbrOffset *offset, QRAccessMbrType accessType);
-QROperand *QRNewValIntOperand(Domain *domain, int val);
-QROperand *QRNewValFloatOperand(Domain *domain, float val);
-QROperand *QRNewTempOperand(Domain *domain, Temp *temp);
+QROperand *QRNewIdOperand(Bison *ctx, Domain *domain, Type *dataType, const Token *token);
+QROperand *QRNewAccessMemOperandIdBase(Bison *ctx, Domain *domain, Type *mbrDataType, const Token *token, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *baseDataType);
+QROperand *QRNewAccessMemOperandTempBase(Bison *ctx, Domain *domain, Type *mbrDataType, Temp *temp, QRAccessMbrOffset *offset, QRAccessMbrType accessType);
+QROperand *QRNewValIntOperand(Bison *ctx, Domain *domain, int val);
+QROperand *QRNewValFloatOperand(Bison *ctx, Domain *domain, float val);
+QROperand *QRNewTempOperand(Bison *ctx, Domain *domain, Temp *temp);
+QROperand *QRCopyOperand(Bison *ctx, const QROperand *operand);
 
-QROperand *QRNewGetAddrIdOperand(Domain *domain, Type *idDataType, const Token *token, Type *dataType);
-QROperand *QRNewGetAddrAccessMemOperand(Domain *domain, Type *amDataType, const Token *token, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *dataType);
-QROperand *QRNewGetAddrAccessMemOperandTempBase(Domain *domain, Type *amDataType, Temp *temp, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *dataType);
+QROperand *QRNewGetAddrIdOperand(Bison *ctx, Domain *domain, Type *idDataType, const Token *token, Type *dataType);
+QROperand *QRNewGetAddrAccessMemOperand(Bison *ctx, Domain *domain, Type *amDataType, const Token *token, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *dataType);
+QROperand *QRNewGetAddrAccessMemOperandTempBase(Bison *ctx, Domain *domain, Type *amDataType, Temp *temp, QRAccessMbrOffset *offset, QRAccessMbrType accessType, Type *dataType);
 
-QRAccessMbrOffset *QRNewAccessMemOffsetVal(int val);
-QRAccessMbrOffset *QRNewAccessMemOffsetId(Domain *domain, Type *dataType, const Token *token);
-QRAccessMbrOffset *QRNewAccessMemOffsetTemp(Domain *domain, Temp *temp);
+QRAccessMbrOffset *QRNewAccessMemOffsetVal(Bison *ctx, int val);
+QRAccessMbrOffset *QRNewAccessMemOffsetId(Bison *ctx, Domain *domain, Type *dataType, const Token *token);
+QRAccessMbrOffset *QRNewAccessMemOffsetTemp(Bison *ctx, Domain *domain, Temp *temp);
 
-QROperand *QROperandFromExpr(Expr *expr);
-Type *QROperandDataType(QROperand *operand);
+QROperand *QROperandFromExpr(Bison *ctx, Expr *expr);
+Type *QROperandDataType(Bison *ctx, QROperand *operand);
 
 #ifdef __cplusplus
 }
@@ -5,6 +5,7 @@
 #include "cpl_debug.h"
 #include "cpl_mm.h"
 #include "stdlib.h"
+#include <pthread.h>
 
 
 #define PrErr(fmt, ...)  Pr(__FILE__, __LINE__, __FUNCTION__, "error", fmt, ##__VA_ARGS__)
@@ -44,19 +45,23 @@ static void LexPatternFree(LexPattern *pattern)
     CplFree(pattern);
 }
 
+/*所有词法分析器只读共享的模式匹配器，只构造一次*/
+static pthread_once_t lexPatternOnce = PTHREAD_ONCE_INIT;
+static struct list_head lexPatternList = LIST_HEAD_INIT(lexPatternList);
+
 /*
- * 功能：向词法分析器添加一个词法单元模式匹配器。
- * lex: 词法分析器
+ * 功能：向模式匹配器链表添加一个词法单元模式匹配器。
+ * patterList: 模式匹配器链表
  * patterStr: 模式字符串
  * tag: 令牌标签
  * 返回值：
  **/
-static int LexAddPattern(Lex *lex, const char *patterStr, TokenTag tag)
+static int LexAddPattern(struct list_head *patterList, const char *patterStr, TokenTag tag)
 {
     int error = 0;
     LexPattern *lexPattern;
 
-    if (!lex || !patterStr)
+    if (!patterList || !patterStr)
         return -EINVAL;
 
     lexPattern = LexPatternAlloc();
@@ -70,16 +75,35 @@ static int LexAddPattern(Lex *lex, const char *patterStr, TokenTag tag)
         PrErr("failure %s regex do not generate, error: %d\n", patterStr, error);
         exit(-1);
     }
-    list_add_tail(&lexPattern->node, &lex->patterList);
+    list_add_tail(&lexPattern->node, patterList);
     return 0;
 }
 
 /*
- * 功能：词法分析器初始化
+ * 功能：释放共享的模式匹配器，进程退出时调用。
  * 返回值：
  **/
-static inline void LexInit(Lex *lex)
+static void LexPatternListFree(void)
+{
+    struct list_head *pos;
+    LexPattern *pattern;
+
+    for (pos = lexPatternList.next; pos != &lexPatternList; ) {
+        pattern = container_of(pos, LexPattern, node);
+        pos = pos->next;
+        list_del(&pattern->node);
+        LexPatternFree(pattern);
+    }
+}
+
+/*
+ * 功能：构造共享的模式匹配器，模式的添加顺序就是匹配的优先级。
+ * 返回值：
+ **/
+static void LexPatternListInit(void)
 {
+    struct list_head *patterList = &lexPatternList;
+
 #if 0
     const char *idPattern = "(_|a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|w|x|y|z"
                             "|A|B|C|D|E|F|G|H|I|J|K|L|M|N|O|P|Q|R|S|T|U|V|W|X|Y|Z)"
@@ -103,80 +127,89 @@ static inline void LexInit(Lex *lex)
 
     const char *digitPattern = "(0|1|2|3|4|5|6|7|8|9)(0|1|2|3|4|5|6|7|8|9)*";
 
-    INIT_LIST_HEAD(&lex->patterList);
+    LexAddPattern(patterList, "break", TT_BREAK);
+    LexAddPattern(patterList, "do", TT_DO);
+    LexAddPattern(patterList, "else", TT_ELSE);
+    LexAddPattern(patterList, "false", TT_FALSE);
+    LexAddPattern(patterList, "if", TT_IF);
+    LexAddPattern(patterList, "true", TT_TRUE);
+    LexAddPattern(patterList, "for", TT_FOR);
+    LexAddPattern(patterList, "while", TT_WHILE);
+    LexAddPattern(patterList, "return", TT_RETURN);
+    LexAddPattern(patterList, "struct", TT_STRUCT);
+    LexAddPattern(patterList, "int", TT_INT);
+    LexAddPattern(patterList, "short", TT_SHORT);
+    LexAddPattern(patterList, "char", TT_CHAR);
+    LexAddPattern(patterList, "bool", TT_BOOL);
+    LexAddPattern(patterList, "float", TT_FLOAT);
+    LexAddPattern(patterList, "switch", TT_SWITCH);
+    LexAddPattern(patterList, "case", TT_CASE);
+    LexAddPattern(patterList, "default", TT_DEFAULT);
+    LexAddPattern(patterList, "continue", TT_CONTINUE);
+    LexAddPattern(patterList, "void", TT_VOID);
+
+    LexAddPattern(patterList, idPattern, TT_ID);
+    LexAddPattern(patterList, digitPattern, TT_DIGIT);
+    LexAddPattern(patterList, strPattern, TT_STR);
+
+    LexAddPattern(patterList, "{", TT_LBRACE);
+    LexAddPattern(patterList, "}", TT_RBRACE);
+    LexAddPattern(patterList, "\\(", TT_LBRACKET);
+    LexAddPattern(patterList, "\\)", TT_RBRACKET);
+    LexAddPattern(patterList, "\\[", TT_LSBRACKET);
+    LexAddPattern(patterList, "\\]", TT_RSBRACKET);
+
+    LexAddPattern(patterList, ";", TT_SEMI_COLON);
+    LexAddPattern(patterList, ":", TT_COLON);
+    LexAddPattern(patterList, "#", TT_SHARP);
+    LexAddPattern(patterList, "\\.", TT_DOT);
+    LexAddPattern(patterList, ",", TT_COMMA);
+
+    LexAddPattern(patterList, "\\->", TT_ARROW);
+
+    LexAddPattern(patterList, "\\+", TT_ADD);
+    LexAddPattern(patterList, "\\-", TT_SUB);
+    LexAddPattern(patterList, "\\*", TT_MUL);
+    LexAddPattern(patterList, "/", TT_DIV);
+    LexAddPattern(patterList, "%", TT_MOD);
+
+    LexAddPattern(patterList, "==", TT_EQ);
+    LexAddPattern(patterList, "!=", TT_NE);
+    LexAddPattern(patterList, "<=", TT_LE);
+    LexAddPattern(patterList, "<", TT_LT);
+    LexAddPattern(patterList, ">=", TT_GE);
+    LexAddPattern(patterList, ">", TT_GT);
+
+    LexAddPattern(patterList, "=", TT_ASSIGN);
+
+    LexAddPattern(patterList, "&&", TT_AND);
+    LexAddPattern(patterList, "\\|\\|", TT_OR);
+    LexAddPattern(patterList, "!", TT_NOT);
+
+    LexAddPattern(patterList, "&", TT_BAND);
+    LexAddPattern(patterList, "\\|", TT_BOR);
+    LexAddPattern(patterList, "^", TT_BNOR);
+
+    LexAddPattern(patterList, " ", TT_SPACE);
+    LexAddPattern(patterList, "\\t", TT_TAB);
+    LexAddPattern(patterList, "\\r", TT_CR);
+    LexAddPattern(patterList, "\\n", TT_LN);
+    atexit(LexPatternListFree);
+}
+
+/*
+ * 功能：词法分析器初始化
+ * 返回值：
+ **/
+static inline void LexInit(Lex *lex)
+{
+    pthread_once(&lexPatternOnce, LexPatternListInit);
+    lex->patterList = &lexPatternList;
     lex->reader.arg = NULL;
     lex->reader.getChar = NULL;
     lex->eofToken.tag = TT_EOF;
     lex->curToken = NULL;
     LexWordsInit(lex, &lex->words);
-
-    LexAddPattern(lex, "break", TT_BREAK);
-    LexAddPattern(lex, "do", TT_DO);
-    LexAddPattern(lex, "else", TT_ELSE);
-    LexAddPattern(lex, "false", TT_FALSE);
-    LexAddPattern(lex, "if", TT_IF);
-    LexAddPattern(lex, "true", TT_TRUE);
-    LexAddPattern(lex, "for", TT_FOR);
-    LexAddPattern(lex, "while", TT_WHILE);
-    LexAddPattern(lex, "return", TT_RETURN);
-    LexAddPattern(lex, "struct", TT_STRUCT);
-    LexAddPattern(lex, "int", TT_INT);
-    LexAddPattern(lex, "short", TT_SHORT);
-    LexAddPattern(lex, "char", TT_CHAR);
-    LexAddPattern(lex, "bool", TT_BOOL);
-    LexAddPattern(lex, "float", TT_FLOAT);
-    LexAddPattern(lex, "switch", TT_SWITCH);
-    LexAddPattern(lex, "case", TT_CASE);
-    LexAddPattern(lex, "default", TT_DEFAULT);
-    LexAddPattern(lex, "continue", TT_CONTINUE);
-    LexAddPattern(lex, "void", TT_VOID);
-
-    LexAddPattern(lex, idPattern, TT_ID);
-    LexAddPattern(lex, digitPattern, TT_DIGIT);
-    LexAddPattern(lex, strPattern, TT_STR);
-
-    LexAddPattern(lex, "{", TT_LBRACE);
-    LexAddPattern(lex, "}", TT_RBRACE);
-    LexAddPattern(lex, "\\(", TT_LBRACKET);
-    LexAddPattern(lex, "\\)", TT_RBRACKET);
-    LexAddPattern(lex, "\\[", TT_LSBRACKET);
-    LexAddPattern(lex, "\\]", TT_RSBRACKET);
-
-    LexAddPattern(lex, ";", TT_SEMI_COLON);
-    LexAddPattern(lex, ":", TT_COLON);
-    LexAddPattern(lex, "#", TT_SHARP);
-    LexAddPattern(lex, "\\.", TT_DOT);
-    LexAddPattern(lex, ",", TT_COMMA);
-
-    LexAddPattern(lex, "\\->", TT_ARROW);
-
-    LexAddPattern(lex, "\\+", TT_ADD);
-    LexAddPattern(lex, "\\-", TT_SUB);
-    LexAddPattern(lex, "\\*", TT_MUL);
-    LexAddPattern(lex, "/", TT_DIV);
-    LexAddPattern(lex, "%", TT_MOD);
-
-    LexAddPattern(lex, "==", TT_EQ);
-    LexAddPattern(lex, "!=", TT_NE);
-    LexAddPattern(lex, "<=", TT_LE);
-    LexAddPattern(lex, "<", TT_LT);
-    LexAddPattern(lex, ">=", TT_GE);
-    LexAddPattern(lex, ">", TT_GT);
-
-    LexAddPattern(lex, "=", TT_ASSIGN);
-
-    LexAddPattern(lex, "&&", TT_AND);
-    LexAddPattern(lex, "\\|\\|", TT_OR);
-    LexAddPattern(lex, "!", TT_NOT);
-
-    LexAddPattern(lex, "&", TT_BAND);
-    LexAddPattern(lex, "\\|", TT_BOR);
-    LexAddPattern(lex, "^", TT_BNOR);
-
-    LexAddPattern(lex, " ", TT_SPACE);
-    LexAddPattern(lex, "\\t", TT_TAB);
-    LexAddPattern(lex, "\\r", TT_CR);
-    LexAddPattern(lex, "\\n", TT_LN);
 }
 
 /*
@@ -192,7 +225,7 @@ Lex *LexAlloc(void)
         LexInit(lex);
     } else {
         PrErr("lex alloc fail\n");
-        exit(-1);
+        CplExit(-1);
     }
     return lex;
 }
@@ -210,16 +243,8 @@ void LexFree(Lex *lex)
         fclose(lex->reader.arg);
         lex->reader.arg = NULL;
     }
-
-    struct list_head *pos;
-    LexPattern *pattern;
-
-    for (pos = lex->patterList.next; pos != &lex->patterList; ) {
-        pattern = container_of(pos, LexPattern, node);
-        pos = pos->next;
-        list_del(&pattern->node);
-        LexPatternFree(pattern);
-    }
+    LexWordsFree(&lex->words);
+    CplFree(lex);
 }
 
 /*
@@ -280,6 +305,22 @@ static int ReaderGetChar(struct _RegExReader *reader)
     }
 }
 
+/*
+ * 功能：设置词法分析器的输入流，词法分析器负责关闭输入流。
+ * 返回值：
+ **/
+static void LexSetInStream(Lex *lex, FILE *fp)
+{
+    if (lex->reader.arg) {
+        fclose(lex->reader.arg);
+    }
+    lex->reader.arg = fp;
+    lex->reader.getChar = ReaderGetChar;
+    lex->reader.currentChar = ReaderCurrentChar;
+    lex->reader.incPos = ReaderIncPos;
+    lex->curToken = NULL;
+}
+
 /*
  * 功能：设置词法分析器的读取文件
  * 返回值：
@@ -291,22 +332,38 @@ int LexSetInFile(Lex *lex, const char *inFilename)
     if (!lex || !inFilename)
         return -EINVAL;
 
-    if (lex->reader.arg) {
-        fclose(lex->reader.arg);
-    }
     fp = fopen(inFilename, "rb");
     if (fp) {
-        lex->reader.arg = fp;
-        lex->reader.getChar = ReaderGetChar;
-        lex->reader.currentChar = ReaderCurrentChar;
-        lex->reader.incPos = ReaderIncPos;
+        LexSetInStream(lex, fp);
         return 0;
     } else {
         PrErr("lex set in file fail: %d\n", -EIO);
-        exit(-1);
+        CplExit(-1);
     }
 }
 
+/*
+ * 功能：设置词法分析器的输入缓冲区，从内存中读取源代码。分析结束前缓冲区必须有效。
+ * buf：源代码
+ * len：源代码长度
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int LexSetInBuffer(Lex *lex, const char *buf, size_t len)
+{
+    FILE *fp;
+
+    if (!lex || !buf || len == 0)
+        return -EINVAL;
+
+    fp = fmemopen((void *)buf, len, "rb");
+    if (!fp) {
+        PrErr("lex set in buffer fail: %d\n", -EIO);
+        return -EIO;
+    }
+    LexSetInStream(lex, fp);
+    return 0;
+}
+
 /*
  * 功能：寻找跟模式匹配的输入
  * 返回值：
@@ -331,7 +388,7 @@ static int _LexScan(Lex *lex, LexPattern *pattern, const Token **pToken)
             fclose(lex->reader.arg);
             lex->reader.arg = NULL;
         }
-        exit(-1);
+        CplExit(-1);
     }
 }
 
@@ -350,7 +407,7 @@ const Token *LexScan(Lex *lex)
     if (!lex)
         return NULL;
 
-    list_for_each(pos, &lex->patterList) {
+    list_for_each(pos, lex->patterList) {
         pattern = container_of(pos, LexPattern, node);
         seek = ftell(lex->reader.arg);
         error = _LexScan(lex, pattern, &token);
@@ -379,7 +436,7 @@ const Token *LexScan(Lex *lex)
         PrErr("unscan code [%d], %c\n", ch, ch);
     }
 
-    exit(-1);
+    CplExit(-1);
     return NULL;
 }
 
@@ -402,7 +459,7 @@ const Token *LexCurrent(Lex *lex)
         return lex->curToken;
     }
     PrErr("lex token null\n");
-    exit(-1);
+    CplExit(-1);
 }
 
 /*
@@ -10,7 +10,7 @@ extern "C" {
 #include "lex_words.h"
 
 typedef struct _Lex {
-    struct list_head patterList;    /*节点类型：LexPattern*/
+    const struct list_head *patterList; /*节点类型：LexPattern，所有词法分析器只读共享*/
     RegExReader reader;
     LexWords words;
     Token eofToken;
@@ -21,6 +21,7 @@ Lex *LexAlloc(void);
 void LexFree(Lex *lex);
 
 int LexSetInFile(Lex *lex, const char *inFilename);
+int LexSetInBuffer(Lex *lex, const char *buf, size_t len);
 const Token *LexScan(Lex *lex);
 const Token *LexCurrent(Lex *lex);
 
@@ -40,7 +40,7 @@ static void LexWordFree(LexWord *word)
     if (!word)
         return;
     if (word->key) {
-        CplFree((CplString *)word->key);
+        CplStringFree((CplString *)word->key);
     }
     free(word);
 }
@@ -76,7 +76,7 @@ static LexWord *LexWordsPut(Lex *lex, const CplString *key, TokenTag tag)
     word = LexWordAlloc(tag);
     if (!word) {
         PrErr("no memory\n");
-        exit(-1);
+        CplExit(-1);
     }
     word->key = key;
     word->token.cplString = key;
@@ -100,17 +100,17 @@ static LexWord *LexWordsPutString(Lex *lex, const char *keyStr, TokenTag tag)
     kcString = CplStringAlloc();
     if (!kcString) {
         PrErr("no memory\n");
-        exit(-1);
+        CplExit(-1);
     }
     error = CplStringAppendString(kcString, keyStr);
     if (error != -ENOERR) {
         printf("words put error: %d\n", error);
-        exit(-1);
+        CplExit(-1);
     }
     word = LexWordAlloc(tag);
     if (!word) {
         PrErr("no memory\n");
-        exit(-1);
+        CplExit(-1);
     }
     word->key = kcString;
     word->token.cplString = kcString;
@@ -132,7 +132,7 @@ static LexWord *LexWordsPutDigit(Lex *lex, const CplString *key, TokenTag tag, i
     word = LexWordAlloc(tag);
     if (!word) {
         PrErr("no memory\n");
-        exit(-1);
+        CplExit(-1);
     }
     word->key = key;
     word->token.digit = digit;
@@ -160,7 +160,7 @@ static Token *_LexWordsGet(Lex *lex, const CplString *key)
 
 /*
  * 功能：根据key从字典中获取一个token，如果不存在对应的token，则
- *      向字典中新增一个单词映射。
+ *      向字典中新增一个单词映射。key的所有权转移给字典，已经存在时释放key。
  * 返回值：
  **/
 Token *LexWordsGet(Lex *lex, const CplString *key, TokenTag tag)
@@ -178,6 +178,7 @@ Token *LexWordsGet(Lex *lex, const CplString *key, TokenTag tag)
             return &word->token;
         }
     }
+    CplStringFree((CplString *)key);
     return token;
 }
 
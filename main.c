@@ -1,10 +1,298 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "bison.h"
 #include "gen_code.h"
+#include "compile_server.h"
+#include "flow_graph.h"
+#include "cpl_errno.h"
 
-int main()
+/*
+ * 用法：
+ *   cpl                            编译test.txt，输出中间代码和目标代码，并在虚拟机中执行
+ *   cpl [-j N] [-o dir] [-g] file...
+ *                                  并行编译多个源文件，每个源文件输出一个目标代码映像file.img
+ *   cpl -s sock [-j N]             运行编译服务器，在Unix套接字sock上接受编译请求
+ * -j N：并行编译的线程数，0表示使用CPU核数，默认为1，编译服务器默认使用CPU核数
+ * -o dir：目标代码映像的输出目录，默认和源文件在同一个目录
+ * -g：每个源文件还输出Graphviz格式的控制流图file.dot，和目标代码映像在同一个目录
+ **/
+
+/*批量编译的任务*/
+typedef struct {
+    char **pathArr;         /*源文件路径*/
+    int *errorArr;          /*各源文件的编译结果*/
+    int pathNum;
+    const char *outDir;
+    int dotFlag;            /*是否输出控制流图*/
+    int next;               /*下一个待编译的源文件下标*/
+    pthread_mutex_t mutex;
+} CplBatch;
+
+/*
+ * 功能：把文件读入内存。
+ * pBuf：输出型参数，文件内容，由调用者释放
+ * pLen：输出型参数，文件长度
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CplReadFile(const char *path, char **pBuf, size_t *pLen)
+{
+    FILE *fp;
+    char *buf = NULL, *temp;
+    size_t len = 0, size = 0, n;
+
+    fp = fopen(path, "rb");
+    if (!fp)
+        return -EIO;
+    for (;;) {
+        if (len == size) {
+            size = size ? size * 2 : 4096;
+            temp = realloc(buf, size);
+            if (!temp) {
+                free(buf);
+                fclose(fp);
+                return -ENOMEM;
+            }
+            buf = temp;
+        }
+        n = fread(buf + len, 1, size - len, fp);
+        if (n == 0)
+            break;
+        len += n;
+    }
+    if (ferror(fp)) {
+        free(buf);
+        fclose(fp);
+        return -EIO;
+    }
+    fclose(fp);
+    *pBuf = buf;
+    *pLen = len;
+    return 0;
+}
+
+/*
+ * 功能：生成源文件对应的输出文件路径，源文件路径加上后缀suffix。
+ * 返回值：输出文件路径，由调用者释放，内存不足时返回NULL。
+ **/
+static char *CplOutPath(const char *path, const char *outDir, const char *suffix)
+{
+    const char *name;
+    char *outPath;
+    size_t len;
+
+    name = path;
+    if (outDir) {
+        name = strrchr(path, '/');
+        name = name ? name + 1 : path;
+    }
+    len = (outDir ? strlen(outDir) + 1 : 0) + strlen(name) + strlen(suffix) + 1;
+    outPath = malloc(len);
+    if (!outPath)
+        return NULL;
+    if (outDir)
+        snprintf(outPath, len, "%s/%s%s", outDir, name, suffix);
+    else
+        snprintf(outPath, len, "%s%s", name, suffix);
+    return outPath;
+}
+
+/*
+ * 功能：输出编译单元的控制流图。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CplDumpFlowGraph(Bison *ctx, const char *path, const char *outDir)
+{
+    char *dotPath;
+    FILE *fp;
+    int error = 0;
+
+    dotPath = CplOutPath(path, outDir, ".dot");
+    if (!dotPath)
+        return -ENOMEM;
+    fp = fopen(dotPath, "w");
+    free(dotPath);
+    if (!fp)
+        return -EIO;
+    error = FGDumpRecordDot(ctx->record, fp);
+    if (fclose(fp) != 0 && error == -ENOERR)
+        error = -EIO;
+    return error;
+}
+
+/*
+ * 功能：编译一个源文件，并把目标代码映像写入文件。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CplCompileFile(const char *path, const char *outDir, int dotFlag)
+{
+    int error = 0;
+    char *buf = NULL, *imagePath = NULL;
+    size_t len;
+    Bison *ctx = NULL;
+    GCImage *image = NULL;
+    FILE *fp;
+
+    error = CplReadFile(path, &buf, &len);
+    if (error != -ENOERR)
+        return error;
+    ctx = BisonAlloc();
+    if (!ctx) {
+        error = -ENOMEM;
+        goto err;
+    }
+    error = BisonCompileBuffer(ctx, buf, len);
+    if (error != -ENOERR)
+        goto err;
+    if (dotFlag) {
+        error = CplDumpFlowGraph(ctx, path, outDir);
+        if (error != -ENOERR)
+            goto err;
+    }
+    error = GCGenImage(ctx, &image);
+    if (error != -ENOERR)
+        goto err;
+
+    imagePath = CplOutPath(path, outDir, ".img");
+    if (!imagePath) {
+        error = -ENOMEM;
+        goto err;
+    }
+    fp = fopen(imagePath, "wb");
+    if (!fp) {
+        error = -EIO;
+        goto err;
+    }
+    error = GCImageWrite(image, fp);
+    if (fclose(fp) != 0 && error == -ENOERR)
+        error = -EIO;
+
+err:
+    free(imagePath);
+    GCImageFree(image);
+    BisonFree(ctx);
+    free(buf);
+    return error;
+}
+
+static void *CplBatchWorker(void *arg)
 {
-    BisonExec();
-    GCGenCode(bison->record);
+    CplBatch *batch = arg;
+    int i;
+
+    for (;;) {
+        pthread_mutex_lock(&batch->mutex);
+        i = batch->next++;
+        pthread_mutex_unlock(&batch->mutex);
+        if (i >= batch->pathNum)
+            break;
+        batch->errorArr[i] = CplCompileFile(batch->pathArr[i], batch->outDir, batch->dotFlag);
+    }
+    return NULL;
+}
+
+/*
+ * 功能：用jobNum个线程并行编译多个源文件，当前线程也参与编译。
+ * 返回值：所有源文件都编译成功时返回0，否则返回错误码。
+ **/
+static int CplBatchCompile(char *pathArr[], int pathNum, int jobNum, const char *outDir, int dotFlag)
+{
+    CplBatch batch;
+    pthread_t *threadArr;
+    int threadCnt;
+    int i, t;
+    int error = 0;
+
+    if (jobNum <= 0)
+        jobNum = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobNum <= 0)
+        jobNum = 1;
+    if (jobNum > pathNum)
+        jobNum = pathNum;
+
+    memset(&batch, 0, sizeof (batch));
+    batch.pathArr = pathArr;
+    batch.pathNum = pathNum;
+    batch.outDir = outDir;
+    batch.dotFlag = dotFlag;
+    batch.errorArr = calloc(pathNum, sizeof (*batch.errorArr));
+    threadArr = malloc(jobNum * sizeof (*threadArr));
+    if (!batch.errorArr || !threadArr) {
+        free(batch.errorArr);
+        free(threadArr);
+        return -ENOMEM;
+    }
+    pthread_mutex_init(&batch.mutex, NULL);
+
+    for (t = 0; t < jobNum - 1; t++) {
+        if (pthread_create(&threadArr[t], NULL, CplBatchWorker, &batch) != 0)
+            break;
+    }
+    threadCnt = t;
+    CplBatchWorker(&batch);
+    for (t = 0; t < threadCnt; t++)
+        pthread_join(threadArr[t], NULL);
+
+    for (i = 0; i < pathNum; i++) {
+        if (batch.errorArr[i] != -ENOERR) {
+            fprintf(stderr, "%s: compile failed, error: %d\n", pathArr[i], batch.errorArr[i]);
+            error = batch.errorArr[i];
+        }
+    }
+    pthread_mutex_destroy(&batch.mutex);
+    free(threadArr);
+    free(batch.errorArr);
+    return error;
+}
+
+int main(int argc, char *argv[])
+{
+    Bison *ctx;
+    const char *outDir = NULL, *sockPath = NULL;
+    int jobNum = -1;
+    int dotFlag = 0;
+    int opt;
+
+    if (argc > 1) {
+        while ((opt = getopt(argc, argv, "j:o:s:g")) != -1) {
+            switch (opt) {
+            case 'j':
+                jobNum = atoi(optarg);
+                break;
+            case 'o':
+                outDir = optarg;
+                break;
+            case 's':
+                sockPath = optarg;
+                break;
+            case 'g':
+                dotFlag = 1;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-j N] [-o dir] [-g] file... | -s sock [-j N]\n", argv[0]);
+                return -1;
+            }
+        }
+        if (sockPath)
+            return CSRun(sockPath, jobNum < 0 ? 0 : jobNum) == 0 ? 0 : -1;
+        if (optind >= argc) {
+            fprintf(stderr, "usage: %s [-j N] [-o dir] [-g] file... | -s sock [-j N]\n", argv[0]);
+            return -1;
+        }
+        return CplBatchCompile(&argv[optind], argc - optind, jobNum < 0 ? 1 : jobNum, outDir, dotFlag) == 0 ? 0 : -1;
+    }
+
+    ctx = BisonAlloc();
+    if (!ctx)
+        return -1;
+    ctx->dumpFlag = 1;
+    if (BisonCompile(ctx, "test.txt") != 0) {
+        BisonFree(ctx);
+        return -1;
+    }
+    GCGenCode(ctx);
+    BisonFree(ctx);
     return 0;
 }
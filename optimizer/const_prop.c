@@ -0,0 +1,730 @@
+#include "const_prop.h"
+#include "bison.h"
+#include "abstract_tree.h"
+#include "cpl_errno.h"
+#include "cpl_debug.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
+
+/*格值的类型，按从高到低的顺序排列，求值过程中格值只会降低*/
+typedef enum {
+    CPLT_TOP,       /*还没有求出值*/
+    CPLT_CONST,     /*常量*/
+    CPLT_BOTTOM,    /*不是常量*/
+} CPLatticeType;
+
+typedef struct {
+    CPLatticeType type;
+    int val;
+} CPValue;
+
+/*常量传播过程中的信息*/
+typedef struct {
+    Bison *bison;
+    QRRecord *record;
+    SSAFunction *ssa;
+    FlowGraph *graph;
+    uint8_t *keepArr;
+    CPValue *valArr;        /*变量版本的格值，按valBase[var] + ver索引*/
+    uint32_t *valBase;
+    uint32_t *edgeBase;     /*基本块的入边在edgeExec中的开始位置，入边和predArr一一对应*/
+    uint8_t *edgeExec;      /*入边是否可执行*/
+    uint8_t *visited;       /*基本块是否可执行*/
+    uint32_t *blockWork;    /*新增了可执行入边的基本块*/
+    uint32_t blockTop;
+    SSAName *nameWork;      /*格值降低的变量版本*/
+    uint32_t nameTop;
+    int *localVal;          /*基本块内局部折叠的没有提升的临时变量的值*/
+    uint32_t *localStamp;   /*localVal有效时为所在基本块id加1*/
+    CplArena *arena;
+} CPContext;
+
+static const CPValue cpTop = {CPLT_TOP, 0};
+static const CPValue cpBottom = {CPLT_BOTTOM, 0};
+
+static CPValue CPConst(int val)
+{
+    CPValue value;
+
+    value.type = CPLT_CONST;
+    value.val = val;
+    return value;
+}
+
+static void *CPAlloc(CPContext *ctx, size_t size)
+{
+    return CplArenaCalloc(ctx->arena, size ? size : 1);
+}
+
+/*
+ * 功能：判断常量能否原样存放在type类型的变量中。int可以存放任何常量，不足4字节的整数
+ *      只接受截断和扩展都不改变的非负数，和GCNarrowAssignExact一致，浮点数和其它类型不能是常量。
+ * 返回值：能时返回1，否则返回0。
+ **/
+static int CPTypeHolds(const Type *type, int val)
+{
+    if (type->type != TT_BASE)
+        return 0;
+    switch (type->baseType.type) {
+    case BTT_BOOL:
+        return val >= 0 && val <= 1;
+    case BTT_CHAR:
+        return val >= 0 && val <= 127;
+    case BTT_SHORT:
+        return val >= 0 && val <= 32767;
+    case BTT_INT:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static CPValue CPMeet(CPValue a, CPValue b)
+{
+    if (a.type == CPLT_TOP)
+        return b;
+    if (b.type == CPLT_TOP)
+        return a;
+    if (a.type == CPLT_CONST && b.type == CPLT_CONST && a.val == b.val)
+        return a;
+    return cpBottom;
+}
+
+/*
+ * 功能：按虚拟机的语义计算二目运算，寄存器是32位无符号数，除法和求余也是无符号的。
+ * 返回值：成功时返回0，除数为0时返回-EINVAL。
+ **/
+static int CPFoldBin(QROpCode op, int a, int b, int *pVal)
+{
+    uint32_t x = (uint32_t)a, y = (uint32_t)b;
+
+    switch (op) {
+    case QROC_ADD:
+        *pVal = (int)(x + y);
+        return 0;
+    case QROC_SUB:
+        *pVal = (int)(x - y);
+        return 0;
+    case QROC_MUL:
+        *pVal = (int)(x * y);
+        return 0;
+    case QROC_DIV:
+        if (y == 0)
+            return -EINVAL;
+        *pVal = (int)(x / y);
+        return 0;
+    case QROC_MOD:
+        if (y == 0)
+            return -EINVAL;
+        *pVal = (int)(x % y);
+        return 0;
+    default:
+        return -EINVAL;
+    }
+}
+
+/*
+ * 功能：按虚拟机的语义计算比较，比较的是两边之差的符号。
+ * 返回值：比较成立时返回1，否则返回0。
+ **/
+static int CPFoldRel(ExprType type, int a, int b)
+{
+    int32_t d = (int32_t)((uint32_t)a - (uint32_t)b);
+
+    switch (type) {
+    case ET_EQ:
+        return d == 0;
+    case ET_NE:
+        return d != 0;
+    case ET_GT:
+        return d > 0;
+    case ET_GE:
+        return d >= 0;
+    case ET_LT:
+        return d < 0;
+    case ET_LE:
+        return d <= 0;
+    default:
+        PrErr("expr type error: %d", type);
+        return 0;
+    }
+}
+
+static CPValue CPNameValue(CPContext *ctx, SSAName name)
+{
+    if (name.var == SSA_NONE || name.ver == SSA_NONE)
+        return cpBottom;
+    return ctx->valArr[ctx->valBase[name.var] + name.ver];
+}
+
+static CPValue CPOperandValue(CPContext *ctx, const QROperand *operand, SSAName name)
+{
+    if (operand->type == QROT_VAL)
+        return operand->val.type == QRVT_INT ? CPConst(operand->val.ival) : cpBottom;
+    return CPNameValue(ctx, name);
+}
+
+static CPValue CPExprValue(CPContext *ctx, Expr *expr, SSAName name)
+{
+    if (expr->type == ET_CONST || expr->type == ET_CONST_SPC)
+        return CPOperandValue(ctx, QROperandFromExpr(ctx->bison, expr), name);
+    return CPNameValue(ctx, name);
+}
+
+/*
+ * 功能：求条件跳转是否跳转。
+ * 返回值：跳转时为常量1，不跳转时为常量0。
+ **/
+static CPValue CPEvalCond(CPContext *ctx, const QuadRuple *qr, const SSAInstr *ins)
+{
+    Expr *cond = qr->condJump.cond;
+    CPValue l, r, value;
+    int taken;
+
+    if (SSAUseNum(qr) == 2) {
+        l = CPExprValue(ctx, ATreeExpr(ctx->bison, cond->binOp.lExpr), ins->useArr[0]);
+        r = CPExprValue(ctx, ATreeExpr(ctx->bison, cond->binOp.rExpr), ins->useArr[1]);
+        if (l.type == CPLT_BOTTOM || r.type == CPLT_BOTTOM)
+            return cpBottom;
+        if (l.type == CPLT_TOP || r.type == CPLT_TOP)
+            return cpTop;
+        taken = CPFoldRel(cond->type, l.val, r.val);
+    } else {
+        value = CPExprValue(ctx, cond, ins->useArr[0]);
+        if (value.type != CPLT_CONST)
+            return value;
+        taken = value.val != 0;
+    }
+    if (qr->op == QROC_FALSE_JUMP)
+        taken = !taken;
+    return CPConst(taken);
+}
+
+static CPValue CPEvalBin(QROpCode op, CPValue a, CPValue b)
+{
+    int val;
+
+    if (a.type == CPLT_BOTTOM || b.type == CPLT_BOTTOM)
+        return cpBottom;
+    if (a.type == CPLT_TOP || b.type == CPLT_TOP)
+        return cpTop;
+    if (CPFoldBin(op, a.val, b.val, &val) != -ENOERR)
+        return cpBottom;
+    return CPConst(val);
+}
+
+/*
+ * 功能：降低变量版本的格值，降低时加入工作表。
+ * 返回值：
+ **/
+static void CPSetValue(CPContext *ctx, SSAName name, CPValue value)
+{
+    CPValue *old = &ctx->valArr[ctx->valBase[name.var] + name.ver];
+
+    if (value.type == CPLT_CONST && !CPTypeHolds(ctx->ssa->varArr[name.var].type, value.val))
+        value = cpBottom;
+    if (old->type == CPLT_CONST && value.type == CPLT_CONST && old->val != value.val)
+        value = cpBottom;
+    if (value.type <= old->type)
+        return;
+    *old = value;
+    ctx->nameWork[ctx->nameTop++] = name;
+}
+
+static void CPMarkEdge(CPContext *ctx, uint32_t from, uint32_t to)
+{
+    FGBlock *block = &ctx->graph->blockArr[to];
+    uint32_t j;
+
+    for (j = 0; j < block->predNum; j++) {
+        if (block->predArr[j] != from)
+            continue;
+        if (!ctx->edgeExec[ctx->edgeBase[to] + j]) {
+            ctx->edgeExec[ctx->edgeBase[to] + j] = 1;
+            ctx->blockWork[ctx->blockTop++] = to;
+        }
+        return;
+    }
+}
+
+static void CPMarkAllEdges(CPContext *ctx, uint32_t b)
+{
+    FGBlock *block = &ctx->graph->blockArr[b];
+    uint32_t k;
+
+    for (k = 0; k < block->succNum; k++)
+        CPMarkEdge(ctx, b, block->succArr[k]);
+}
+
+/*
+ * 功能：求基本块末尾的条件跳转和跳转表跳转，只把可能走的出边标记为可执行。
+ * 返回值：
+ **/
+static void CPEvalBranch(CPContext *ctx, uint32_t b, const QuadRuple *qr, const SSAInstr *ins)
+{
+    FlowGraph *graph = ctx->graph;
+    CPValue value;
+
+    if (qr->op == QROC_TABLE_JUMP) {
+        value = CPOperandValue(ctx, qr->tableJump.idx, ins->useArr[0]);
+        if (value.type == CPLT_CONST && (uint32_t)value.val < qr->tableJump.labelNum)
+            CPMarkEdge(ctx, b, FGBlockOf(graph, qr->tableJump.labelArr[value.val]));
+        else if (value.type != CPLT_TOP)
+            CPMarkAllEdges(ctx, b);
+        return;
+    }
+    value = CPEvalCond(ctx, qr, ins);
+    if (value.type == CPLT_CONST && value.val)
+        CPMarkEdge(ctx, b, FGBlockOf(graph, qr->condJump.dstLabel));
+    else if (value.type == CPLT_CONST && b + 1 < graph->blockNum)
+        CPMarkEdge(ctx, b, b + 1);
+    else if (value.type == CPLT_BOTTOM)
+        CPMarkAllEdges(ctx, b);
+}
+
+static int CPIsBranch(QROpCode op)
+{
+    return op == QROC_TRUE_JUMP || op == QROC_FALSE_JUMP || op == QROC_TABLE_JUMP;
+}
+
+static void CPEvalInstr(CPContext *ctx, uint32_t b, size_t i)
+{
+    const QuadRuple *qr = &ctx->record->qrArr[i];
+    SSAInstr *ins = SSAInstrOf(ctx->ssa, i);
+    CPValue value;
+
+    switch (qr->op) {
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+    case QROC_DIV:
+    case QROC_MOD:
+        if (ins->def.var == SSA_NONE)
+            break;
+        value = CPEvalBin(qr->op, CPOperandValue(ctx, qr->binOp.arg1, ins->useArr[0]),
+                          CPOperandValue(ctx, qr->binOp.arg2, ins->useArr[1]));
+        CPSetValue(ctx, ins->def, value);
+        break;
+    case QROC_ASSIGN:
+        if (ins->def.var != SSA_NONE)
+            CPSetValue(ctx, ins->def, CPOperandValue(ctx, qr->unaryOp.arg1, ins->useArr[0]));
+        break;
+    case QROC_FUN_CALL:
+        if (ins->def.var != SSA_NONE)
+            CPSetValue(ctx, ins->def, cpBottom);
+        break;
+    case QROC_TRUE_JUMP:
+    case QROC_FALSE_JUMP:
+    case QROC_TABLE_JUMP:
+        CPEvalBranch(ctx, b, qr, ins);
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * 功能：phi函数的值是所有可执行入边上参数值的交。
+ * 返回值：
+ **/
+static void CPEvalPhi(CPContext *ctx, SSAPhi *phi)
+{
+    FGBlock *block = &ctx->graph->blockArr[phi->block];
+    CPValue value = cpTop;
+    uint32_t j;
+
+    for (j = 0; j < block->predNum; j++) {
+        if (ctx->edgeExec[ctx->edgeBase[phi->block] + j] && phi->argArr[j] != SSA_NONE)
+            value = CPMeet(value, CPNameValue(ctx, (SSAName){phi->def.var, phi->argArr[j]}));
+    }
+    CPSetValue(ctx, phi->def, value);
+}
+
+/*
+ * 功能：基本块新增了可执行的入边，重新求phi函数，第一次执行时求块中的所有四元式。
+ * 返回值：
+ **/
+static void CPVisitBlock(CPContext *ctx, uint32_t b)
+{
+    FGBlock *block = &ctx->graph->blockArr[b];
+    SSAPhi *phi;
+    size_t i;
+
+    for (phi = ctx->ssa->phiArr[b]; phi; phi = phi->next)
+        CPEvalPhi(ctx, phi);
+    if (ctx->visited[b])
+        return;
+    ctx->visited[b] = 1;
+    for (i = block->start; i < block->end; i++)
+        CPEvalInstr(ctx, b, i);
+    if (!CPIsBranch(ctx->record->qrArr[block->end - 1].op))
+        CPMarkAllEdges(ctx, b);
+}
+
+/*
+ * 功能：格值降低后重新求使用它的四元式和phi函数，只求已经可执行的基本块。
+ * 返回值：
+ **/
+static void CPVisitName(CPContext *ctx, SSAName name)
+{
+    SSAUse *use;
+    uint32_t b;
+
+    for (use = ctx->ssa->varArr[name.var].useArr[name.ver]; use; use = use->next) {
+        if (use->phi) {
+            if (ctx->visited[use->phi->block])
+                CPEvalPhi(ctx, use->phi);
+        } else {
+            b = FGBlockOf(ctx->graph, use->idx);
+            if (ctx->visited[b])
+                CPEvalInstr(ctx, b, use->idx);
+        }
+    }
+}
+
+/*
+ * 功能：分配格值、可执行边和工作表。格值初始为TOP，0号版本是函数入口处的值，为BOTTOM。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CPInit(CPContext *ctx)
+{
+    SSAFunction *ssa = ctx->ssa;
+    FlowGraph *graph = ctx->graph;
+    SSAVar *var;
+    uint32_t v, b, total = 0, edgeNum = 0;
+
+    ctx->valBase = CPAlloc(ctx, ssa->varNum * sizeof (*ctx->valBase));
+    ctx->localVal = CPAlloc(ctx, ssa->varNum * sizeof (*ctx->localVal));
+    ctx->localStamp = CPAlloc(ctx, ssa->varNum * sizeof (*ctx->localStamp));
+    ctx->edgeBase = CPAlloc(ctx, graph->blockNum * sizeof (*ctx->edgeBase));
+    ctx->visited = CPAlloc(ctx, graph->blockNum);
+    if (!ctx->valBase || !ctx->localVal || !ctx->localStamp
+            || !ctx->edgeBase || !ctx->visited)
+        return -ENOMEM;
+    for (v = 0; v < ssa->varNum; v++) {
+        var = &ssa->varArr[v];
+        ctx->valBase[v] = total;
+        total += var->versionNum;
+    }
+    for (b = 0; b < graph->blockNum; b++) {
+        ctx->edgeBase[b] = edgeNum;
+        edgeNum += graph->blockArr[b].predNum;
+    }
+    ctx->valArr = CPAlloc(ctx, total * sizeof (*ctx->valArr));
+    ctx->nameWork = CPAlloc(ctx, 2 * total * sizeof (*ctx->nameWork));
+    ctx->edgeExec = CPAlloc(ctx, edgeNum);
+    ctx->blockWork = CPAlloc(ctx, (edgeNum + 1) * sizeof (*ctx->blockWork));
+    if (!ctx->valArr || !ctx->nameWork || !ctx->edgeExec || !ctx->blockWork)
+        return -ENOMEM;
+    for (v = 0; v < ssa->varNum; v++) {
+        if (ssa->varArr[v].versionNum)
+            ctx->valArr[ctx->valBase[v]] = cpBottom;
+    }
+    return 0;
+}
+
+static void CPPropagate(CPContext *ctx)
+{
+    ctx->blockWork[ctx->blockTop++] = 0;
+    while (ctx->blockTop || ctx->nameTop) {
+        if (ctx->blockTop)
+            CPVisitBlock(ctx, ctx->blockWork[--ctx->blockTop]);
+        else
+            CPVisitName(ctx, ctx->nameWork[--ctx->nameTop]);
+    }
+}
+
+/*
+ * 功能：获取没有提升的临时变量在基本块内的常量值。
+ * 返回值：是常量时返回1，否则返回0。
+ **/
+static int CPLocalConst(CPContext *ctx, uint32_t b, uint32_t var, int *pVal)
+{
+    if (var == SSA_NONE || ctx->ssa->varArr[var].kind != SSAVK_TEMP || ctx->localStamp[var] != b + 1)
+        return 0;
+    *pVal = ctx->localVal[var];
+    return 1;
+}
+
+/*
+ * 功能：获取完整操作数的常量值，name是操作数在SSA形式中的版本。
+ * 返回值：是常量时返回1，否则返回0。
+ **/
+static int CPOperandConst(CPContext *ctx, uint32_t b, const QROperand *operand, SSAName name, int *pVal)
+{
+    CPValue value;
+
+    value = CPOperandValue(ctx, operand, name);
+    if (value.type == CPLT_CONST) {
+        *pVal = value.val;
+        return 1;
+    }
+    return CPLocalConst(ctx, b, SSAVarOfOperand(ctx->ssa, operand), pVal);
+}
+
+static int CPExprConst(CPContext *ctx, uint32_t b, Expr *expr, SSAName name, int *pVal)
+{
+    CPValue value;
+
+    value = CPExprValue(ctx, expr, name);
+    if (value.type == CPLT_CONST) {
+        *pVal = value.val;
+        return 1;
+    }
+    return CPLocalConst(ctx, b, SSAVarOfExpr(ctx->ssa, expr), pVal);
+}
+
+/*
+ * 功能：成员访问的偏移量是常量时，复制操作数并把偏移量改成常量。
+ * 返回值：
+ **/
+static void CPSubstOffset(CPContext *ctx, uint32_t b, QROperand **pOperand)
+{
+    QROperand *operand = *pOperand;
+    QRAccessMbr *accessMbr;
+    QRAccessMbrOffset *offset;
+    uint32_t var;
+    int val;
+
+    if (!operand)
+        return;
+    if (operand->type == QROT_ACCESS_MBR)
+        accessMbr = &operand->accessMbr;
+    else if (operand->type == QROT_GET_ADDR && operand->getAddr.type == QRGAT_ACCESS_MEM)
+        accessMbr = &operand->getAddr.accessMbr;
+    else
+        return;
+    offset = accessMbr->offset;
+    if (!offset || offset->offsetType != QRAMOT_TEMP)
+        return;
+    var = SSAVarOfTemp(ctx->ssa, offset->tempOffset.temp);
+    if (!CPLocalConst(ctx, b, var, &val))
+        return;
+    operand = QRCopyOperand(ctx->bison, operand);
+    if (operand->type == QROT_ACCESS_MBR)
+        operand->accessMbr.offset = QRNewAccessMemOffsetVal(ctx->bison, val);
+    else
+        operand->getAddr.accessMbr.offset = QRNewAccessMemOffsetVal(ctx->bison, val);
+    *pOperand = operand;
+}
+
+/*
+ * 功能：把常量使用替换成常量操作数，不是常量时替换成员访问中的常量偏移量。
+ * 返回值：
+ **/
+static void CPSubstOperand(CPContext *ctx, uint32_t b, QROperand **pOperand, SSAName name)
+{
+    int val;
+
+    if (!*pOperand || (*pOperand)->type == QROT_VAL)
+        return;
+    if (CPOperandConst(ctx, b, *pOperand, name, &val))
+        *pOperand = QRNewValIntOperand(ctx->bison, (*pOperand)->domain, val);
+    else
+        CPSubstOffset(ctx, b, pOperand);
+}
+
+static int CPIsIntVal(const QROperand *operand)
+{
+    return operand->type == QROT_VAL && operand->val.type == QRVT_INT;
+}
+
+/*
+ * 功能：改写条件跳转。条件确定时改成绝对跳转或者删除，否则把比较中的常量变量替换成常量。
+ * 返回值：
+ **/
+static void CPRewriteCond(CPContext *ctx, uint32_t b, size_t i, const SSAInstr *ins)
+{
+    QuadRuple *qr = &ctx->record->qrArr[i];
+    Expr *cond = qr->condJump.cond, *lExpr, *rExpr;
+    size_t dstLabel = qr->condJump.dstLabel;
+    int lConst, rConst, l, r, taken;
+
+    if (SSAUseNum(qr) == 2) {
+        lExpr = ATreeExpr(ctx->bison, cond->binOp.lExpr);
+        rExpr = ATreeExpr(ctx->bison, cond->binOp.rExpr);
+        lConst = CPExprConst(ctx, b, lExpr, ins->useArr[0], &l);
+        rConst = CPExprConst(ctx, b, rExpr, ins->useArr[1], &r);
+        if (!lConst || !rConst) {
+            if (lConst && lExpr->type != ET_CONST && lExpr->type != ET_CONST_SPC)
+                lExpr = ATreeNewCValueSpcIntExpr(ctx->bison, lExpr->domain, l);
+            if (rConst && rExpr->type != ET_CONST && rExpr->type != ET_CONST_SPC)
+                rExpr = ATreeNewCValueSpcIntExpr(ctx->bison, rExpr->domain, r);
+            if (lExpr->nodeId != cond->binOp.lExpr || rExpr->nodeId != cond->binOp.rExpr)
+                qr->condJump.cond = ATreeNewBinExpr(ctx->bison, cond->domain, cond->type, cond->binOp.type, lExpr, rExpr);
+            return;
+        }
+        taken = CPFoldRel(cond->type, l, r);
+    } else {
+        if (!CPExprConst(ctx, b, cond, ins->useArr[0], &l))
+            return;
+        taken = l != 0;
+    }
+    if (qr->op == QROC_FALSE_JUMP)
+        taken = !taken;
+    if (taken) {
+        qr->op = QROC_JUMP;
+        qr->uncondJump.dstLabel = dstLabel;
+    } else {
+        ctx->keepArr[i] = 0;
+    }
+}
+
+/*
+ * 功能：判断定义的版本是否是常量，并且所有使用都已经替换成常量。常量版本在四元式中的使用
+ *      都会被替换，流入phi函数的版本仍然需要变量中的值。
+ * 返回值：可以删除定义时返回1，否则返回0。
+ **/
+static int CPDefFolded(CPContext *ctx, const SSAInstr *ins)
+{
+    SSAUse *use;
+
+    if (ins->def.var == SSA_NONE || CPNameValue(ctx, ins->def).type != CPLT_CONST)
+        return 0;
+    for (use = ctx->ssa->varArr[ins->def.var].useArr[ins->def.ver]; use; use = use->next) {
+        if (use->phi)
+            return 0;
+    }
+    return 1;
+}
+
+/*
+ * 功能：改写可执行基本块中的一条四元式，并记录块内没有提升的临时变量的常量值。
+ * 返回值：
+ **/
+static void CPRewriteInstr(CPContext *ctx, uint32_t b, size_t i)
+{
+    QuadRuple *qr = &ctx->record->qrArr[i];
+    SSAInstr *ins = SSAInstrOf(ctx->ssa, i);
+    QROperand *result, *def = NULL;
+    uint32_t var;
+    int val;
+
+    switch (qr->op) {
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+    case QROC_DIV:
+    case QROC_MOD:
+        CPSubstOperand(ctx, b, &qr->binOp.arg1, ins->useArr[0]);
+        CPSubstOperand(ctx, b, &qr->binOp.arg2, ins->useArr[1]);
+        CPSubstOffset(ctx, b, &qr->binOp.result);
+        result = qr->binOp.result;
+        def = result;
+        if (CPIsIntVal(qr->binOp.arg1) && CPIsIntVal(qr->binOp.arg2)
+                && CPFoldBin(qr->op, qr->binOp.arg1->val.ival, qr->binOp.arg2->val.ival, &val) == -ENOERR
+                && CPTypeHolds(QROperandDataType(ctx->bison, result), val)) {
+            qr->op = QROC_ASSIGN;
+            qr->unaryOp.arg1 = QRNewValIntOperand(ctx->bison, result->domain, val);
+            qr->unaryOp.result = result;
+        }
+        break;
+    case QROC_ASSIGN:
+        CPSubstOperand(ctx, b, &qr->unaryOp.arg1, ins->useArr[0]);
+        CPSubstOffset(ctx, b, &qr->unaryOp.result);
+        def = qr->unaryOp.result;
+        break;
+    case QROC_FUN_CALL:
+        def = qr->funCall.result;
+        break;
+    case QROC_TRUE_JUMP:
+    case QROC_FALSE_JUMP:
+        CPRewriteCond(ctx, b, i, ins);
+        break;
+    case QROC_TABLE_JUMP:
+        CPSubstOperand(ctx, b, &qr->tableJump.idx, ins->useArr[0]);
+        if (CPIsIntVal(qr->tableJump.idx) && (uint32_t)qr->tableJump.idx->val.ival < qr->tableJump.labelNum) {
+            val = qr->tableJump.idx->val.ival;
+            qr->op = QROC_JUMP;
+            qr->uncondJump.dstLabel = qr->tableJump.labelArr[val];
+        }
+        break;
+    case QROC_RETURN_VALUE:
+        CPSubstOperand(ctx, b, &qr->returnObj.expr, ins->useArr[0]);
+        break;
+    case QROC_FUN_PARAM:
+        CPSubstOperand(ctx, b, &qr->funParam.expr, ins->useArr[0]);
+        break;
+    default:
+        break;
+    }
+
+    if (CPDefFolded(ctx, ins)) {
+        ctx->keepArr[i] = 0;
+        return;
+    }
+    if (!def || def->type != QROT_TEMP)
+        return;
+    var = SSAVarOfTemp(ctx->ssa, def->temp);
+    if (var == SSA_NONE || ctx->ssa->varArr[var].promoted)
+        return;
+    if (qr->op == QROC_ASSIGN && CPIsIntVal(qr->unaryOp.arg1)
+            && CPTypeHolds(ctx->ssa->varArr[var].type, qr->unaryOp.arg1->val.ival)) {
+        ctx->localVal[var] = qr->unaryOp.arg1->val.ival;
+        ctx->localStamp[var] = b + 1;
+    } else {
+        ctx->localStamp[var] = 0;
+    }
+}
+
+/*
+ * 功能：判断不可达的基本块中必须保留的四元式，函数和块的开始、结束标志决定栈帧的布局。
+ * 返回值：
+ **/
+static int CPIsStructural(QROpCode op)
+{
+    return op == QROC_FUN_START || op == QROC_FUN_END || op == QROC_BLK_START || op == QROC_BLK_END;
+}
+
+static void CPRewrite(CPContext *ctx)
+{
+    FlowGraph *graph = ctx->graph;
+    FGBlock *block;
+    uint32_t b;
+    size_t i;
+
+    for (b = 0; b < graph->blockNum; b++) {
+        block = &graph->blockArr[b];
+        for (i = block->start; i < block->end; i++) {
+            if (ctx->visited[b])
+                CPRewriteInstr(ctx, b, i);
+            else if (!CPIsStructural(ctx->record->qrArr[i].op))
+                ctx->keepArr[i] = 0;
+        }
+    }
+}
+
+/*
+ * 功能：对一个函数做常量传播和常量折叠，ssa是函数当前的SSA形式。
+ *      改写后四元式记录和SSA形式不再一致，调用者要丢弃SSA形式和流图。
+ * keepArr：按四元式下标索引，删除的四元式置为0
+ * 返回值：成功时返回0，否则返回错误码，失败时四元式没有被修改。
+ **/
+int CPFunction(Bison *bison, SSAFunction *ssa, uint8_t *keepArr)
+{
+    CPContext ctx;
+    int error = 0;
+
+    if (!bison || !bison->record || !ssa || !keepArr)
+        return -EINVAL;
+    memset(&ctx, 0, sizeof (ctx));
+    ctx.bison = bison;
+    ctx.record = bison->record;
+    ctx.ssa = ssa;
+    ctx.graph = ssa->graph;
+    ctx.keepArr = keepArr;
+    ctx.arena = CplArenaCreate(0);
+    if (!ctx.arena)
+        return -ENOMEM;
+    error = CPInit(&ctx);
+    if (error != -ENOERR)
+        goto out;
+    CPPropagate(&ctx);
+    CPRewrite(&ctx);
+
+out:
+    CplArenaDestroy(ctx.arena);
+    return error;
+}
@@ -0,0 +1,33 @@
+#ifndef __CONST_PROP_H__
+#define __CONST_PROP_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "quadruple.h"
+#include "ssa.h"
+
+/*
+ * 常量传播和常量折叠。
+ *
+ * 在SSA形式上做稀疏条件常量传播（SCCP）：同时求提升的变量各个版本的格值和流图中可执行的边，
+ * 条件不可能成立的分支不会把常量冲掉。求值按虚拟机的语义进行：整数运算按32位回绕，
+ * 除法和求余是无符号的，比较是对差值的符号判断。
+ *
+ * 没有提升的临时变量（数组访问的偏移量、指针基址等）不在SSA形式中，在基本块内部局部折叠：
+ * 临时变量只能被四元式的结果整体修改，块内赋过常量的临时变量在后面的使用处直接替换成常量。
+ *
+ * 改写四元式：常量使用替换成常量操作数，两个操作数都是常量的运算改成赋值，
+ * 条件确定的条件跳转改成绝对跳转或者删除，不可达的基本块删除。
+ * 删除只在keepArr中标记，由调用者压缩四元式记录。
+ **/
+
+int CPFunction(Bison *bison, SSAFunction *ssa, uint8_t *keepArr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__CONST_PROP_H__*/
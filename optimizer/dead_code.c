@@ -0,0 +1,208 @@
+#include "dead_code.h"
+#include "bison.h"
+#include "cpl_mm.h"
+#include "cpl_errno.h"
+#include "stdlib.h"
+#include "string.h"
+
+/*删除无用定义过程中的信息*/
+typedef struct {
+    Bison *bison;
+    QRRecord *record;
+    SSAFunction *ssa;
+    FlowGraph *graph;
+    uint8_t *keepArr;
+    uint32_t *refArr;       /*各变量被引用的次数*/
+} DCContext;
+
+static void DCRef(DCContext *ctx, uint32_t var, int delta)
+{
+    if (var != SSA_NONE)
+        ctx->refArr[var] += delta;
+}
+
+static void DCRefAccessMbr(DCContext *ctx, Domain *domain, const QRAccessMbr *accessMbr, int delta)
+{
+    const QRAccessMbrOffset *offset = accessMbr->offset;
+
+    if (accessMbr->baseType == QRAMBT_ID)
+        DCRef(ctx, SSAVarOfId(ctx->ssa, domain, accessMbr->baseId.token), delta);
+    else
+        DCRef(ctx, SSAVarOfTemp(ctx->ssa, accessMbr->baseTemp), delta);
+    if (!offset)
+        return;
+    if (offset->offsetType == QRAMOT_ID)
+        DCRef(ctx, SSAVarOfId(ctx->ssa, offset->idOffset.domain, offset->idOffset.id.token), delta);
+    else if (offset->offsetType == QRAMOT_TEMP)
+        DCRef(ctx, SSAVarOfTemp(ctx->ssa, offset->tempOffset.temp), delta);
+}
+
+/*
+ * 功能：统计操作数引用的变量。isDef为1时操作数是四元式的结果，只统计成员访问中读取的变量。
+ * 返回值：
+ **/
+static void DCRefOperand(DCContext *ctx, const QROperand *operand, int isDef, int delta)
+{
+    if (!operand)
+        return;
+    switch (operand->type) {
+    case QROT_ID:
+    case QROT_TEMP:
+        if (!isDef)
+            DCRef(ctx, SSAVarOfOperand(ctx->ssa, operand), delta);
+        break;
+    case QROT_ACCESS_MBR:
+        DCRefAccessMbr(ctx, operand->domain, &operand->accessMbr, delta);
+        break;
+    case QROT_GET_ADDR:
+        if (operand->getAddr.type == QRGAT_ACCESS_MEM)
+            DCRefAccessMbr(ctx, operand->domain, &operand->getAddr.accessMbr, delta);
+        else
+            DCRef(ctx, SSAVarOfId(ctx->ssa, operand->domain, operand->getAddr.id.token), delta);
+        break;
+    default:
+        break;
+    }
+}
+
+static void DCRefExpr(DCContext *ctx, Expr *expr, int delta)
+{
+    switch (expr->type) {
+    case ET_ID:
+    case ET_TEMP:
+        DCRef(ctx, SSAVarOfExpr(ctx->ssa, expr), delta);
+        break;
+    case ET_CONST:
+    case ET_CONST_SPC:
+        break;
+    default:
+        DCRefOperand(ctx, QROperandFromExpr(ctx->bison, expr), 0, delta);
+        break;
+    }
+}
+
+static void DCRefInstr(DCContext *ctx, const QuadRuple *qr, int delta)
+{
+    switch (qr->op) {
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+    case QROC_DIV:
+    case QROC_MOD:
+        DCRefOperand(ctx, qr->binOp.arg1, 0, delta);
+        DCRefOperand(ctx, qr->binOp.arg2, 0, delta);
+        DCRefOperand(ctx, qr->binOp.result, 1, delta);
+        break;
+    case QROC_ASSIGN:
+        DCRefOperand(ctx, qr->unaryOp.arg1, 0, delta);
+        DCRefOperand(ctx, qr->unaryOp.result, 1, delta);
+        break;
+    case QROC_TRUE_JUMP:
+    case QROC_FALSE_JUMP:
+        if (SSAUseNum(qr) == 2) {
+            DCRefExpr(ctx, ATreeExpr(ctx->bison, qr->condJump.cond->binOp.lExpr), delta);
+            DCRefExpr(ctx, ATreeExpr(ctx->bison, qr->condJump.cond->binOp.rExpr), delta);
+        } else {
+            DCRefExpr(ctx, qr->condJump.cond, delta);
+        }
+        break;
+    case QROC_TABLE_JUMP:
+        DCRefOperand(ctx, qr->tableJump.idx, 0, delta);
+        break;
+    case QROC_RETURN_VALUE:
+        DCRefOperand(ctx, qr->returnObj.expr, 0, delta);
+        break;
+    case QROC_FUN_PARAM:
+        DCRefOperand(ctx, qr->funParam.expr, 0, delta);
+        break;
+    case QROC_FUN_CALL:
+        DCRefOperand(ctx, qr->funCall.result, 1, delta);
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * 功能：获取运算和赋值四元式定义的局部变量或者临时变量，函数调用有副作用，不算在内。
+ * 返回值：变量编号，否则返回SSA_NONE。
+ **/
+static uint32_t DCPureDefVar(DCContext *ctx, const QuadRuple *qr)
+{
+    QROperand *result;
+
+    switch (qr->op) {
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+    case QROC_DIV:
+    case QROC_MOD:
+        result = qr->binOp.result;
+        break;
+    case QROC_ASSIGN:
+        result = qr->unaryOp.result;
+        break;
+    default:
+        return SSA_NONE;
+    }
+    return SSAVarOfOperand(ctx->ssa, result);
+}
+
+/*
+ * 功能：删除结果在函数中不再被引用的定义。取过地址或者作为成员访问基址的变量都算作被引用，
+ *      所以删除的只是没有人读取的变量的赋值。从后向前扫描，删除定义后它使用的变量的引用次数减少，
+ *      直到没有可以删除的定义为止。
+ * 返回值：
+ **/
+static void DCRemoveDeadDefs(DCContext *ctx)
+{
+    FlowGraph *graph = ctx->graph;
+    const QuadRuple *qr;
+    uint32_t var;
+    size_t i;
+    int changed;
+
+    for (i = graph->start; i < graph->end; i++) {
+        if (ctx->keepArr[i])
+            DCRefInstr(ctx, &ctx->record->qrArr[i], 1);
+    }
+    do {
+        changed = 0;
+        for (i = graph->end; i-- > graph->start;) {
+            qr = &ctx->record->qrArr[i];
+            if (!ctx->keepArr[i])
+                continue;
+            var = DCPureDefVar(ctx, qr);
+            if (var == SSA_NONE || ctx->refArr[var])
+                continue;
+            ctx->keepArr[i] = 0;
+            DCRefInstr(ctx, qr, -1);
+            changed = 1;
+        }
+    } while (changed);
+}
+
+/*
+ * 功能：删除一个函数中的无用定义。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int DCFunction(Bison *bison, SSAFunction *ssa, uint8_t *keepArr)
+{
+    DCContext ctx;
+
+    if (!bison || !bison->record || !ssa || !keepArr)
+        return -EINVAL;
+    memset(&ctx, 0, sizeof (ctx));
+    ctx.bison = bison;
+    ctx.record = bison->record;
+    ctx.ssa = ssa;
+    ctx.graph = ssa->graph;
+    ctx.keepArr = keepArr;
+    ctx.refArr = CplAlloc((ssa->varNum ? ssa->varNum : 1) * sizeof (*ctx.refArr));
+    if (!ctx.refArr)
+        return -ENOMEM;
+    memset(ctx.refArr, 0, (ssa->varNum ? ssa->varNum : 1) * sizeof (*ctx.refArr));
+    DCRemoveDeadDefs(&ctx);
+    CplFree(ctx.refArr);
+    return 0;
+}
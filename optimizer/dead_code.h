@@ -0,0 +1,27 @@
+#ifndef __DEAD_CODE_H__
+#define __DEAD_CODE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "quadruple.h"
+#include "ssa.h"
+
+/*
+ * 删除无用定义。
+ *
+ * 运算和赋值四元式的结果是局部变量或者临时变量，并且这个变量在函数中不再被引用时，
+ * 删除这条四元式。变量只按SSA形式中的变量编号查找，不使用版本，
+ * 所以其它优化修改了四元式之后仍然可以使用原来的SSA形式。
+ * 删除只在keepArr中标记，由调用者压缩四元式记录。
+ **/
+
+int DCFunction(Bison *bison, SSAFunction *ssa, uint8_t *keepArr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__DEAD_CODE_H__*/
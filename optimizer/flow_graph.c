@@ -0,0 +1,633 @@
+#include "flow_graph.h"
+#include "cpl_errno.h"
+#include "cpl_debug.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
+
+static void *FGAlloc(FlowGraph *graph, size_t size)
+{
+    return CplArenaCalloc(graph->arena, size ? size : 1);
+}
+
+/*
+ * 功能：获取四元式的跳转目标数量。
+ * 返回值：跳转目标数量，不是跳转指令时返回0。
+ **/
+static size_t FGTargetNum(const QuadRuple *qr)
+{
+    switch (qr->op) {
+    case QROC_JUMP:
+    case QROC_TRUE_JUMP:
+    case QROC_FALSE_JUMP:
+        return 1;
+    case QROC_TABLE_JUMP:
+        return qr->tableJump.labelNum;
+    default:
+        return 0;
+    }
+}
+
+static size_t FGTarget(const QuadRuple *qr, size_t i)
+{
+    switch (qr->op) {
+    case QROC_JUMP:
+        return qr->uncondJump.dstLabel;
+    case QROC_TRUE_JUMP:
+    case QROC_FALSE_JUMP:
+        return qr->condJump.dstLabel;
+    default:
+        return qr->tableJump.labelArr[i];
+    }
+}
+
+/*
+ * 功能：判断执行完四元式之后是否可能继续执行下一条四元式。
+ * 返回值：可能时返回1，否则返回0。
+ **/
+static int FGFallThrough(QROpCode op)
+{
+    switch (op) {
+    case QROC_JUMP:
+    case QROC_TABLE_JUMP:
+    case QROC_RETURN_VOID:
+    case QROC_RETURN_VALUE:
+    case QROC_FUN_END:
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+/*
+ * 功能：把函数的四元式划分成基本块。跳转目标和跳转、返回之后的四元式是基本块的首指令。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int FGSplitBlocks(FlowGraph *graph)
+{
+    const QRRecord *record = graph->record;
+    const QuadRuple *qr;
+    size_t num = graph->end - graph->start;
+    uint8_t *leader;
+    size_t i, k, targetNum, label;
+    uint32_t id;
+
+    leader = FGAlloc(graph, num);
+    graph->blockMap = FGAlloc(graph, num * sizeof (*graph->blockMap));
+    if (!leader || !graph->blockMap)
+        return -ENOMEM;
+
+    leader[0] = 1;
+    for (i = graph->start; i < graph->end; i++) {
+        qr = &record->qrArr[i];
+        targetNum = FGTargetNum(qr);
+        for (k = 0; k < targetNum; k++) {
+            label = FGTarget(qr, k);
+            if (label < graph->start || label >= graph->end) {
+                PrErr("jump target out of function: %zu -> %zu", i, label);
+                return -EINVAL;
+            }
+            leader[label - graph->start] = 1;
+        }
+        if ((targetNum > 0 || !FGFallThrough(qr->op)) && i + 1 < graph->end)
+            leader[i + 1 - graph->start] = 1;
+    }
+
+    for (i = 0; i < num; i++)
+        graph->blockNum += leader[i];
+    graph->blockArr = FGAlloc(graph, graph->blockNum * sizeof (*graph->blockArr));
+    if (!graph->blockArr)
+        return -ENOMEM;
+    id = 0;
+    for (i = 0; i < num; i++) {
+        if (leader[i] && i > 0) {
+            graph->blockArr[id].end = graph->start + i;
+            id++;
+        }
+        if (leader[i]) {
+            graph->blockArr[id].id = id;
+            graph->blockArr[id].start = graph->start + i;
+        }
+        graph->blockMap[i] = id;
+    }
+    graph->blockArr[id].end = graph->end;
+    return 0;
+}
+
+/*
+ * 功能：根据基本块的最后一条四元式建立前驱后继关系，重复的边只保留一条。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int FGLinkBlocks(FlowGraph *graph)
+{
+    const QuadRuple *qr;
+    FGBlock *block, *succ;
+    uint32_t *buf, *mark;
+    uint32_t b, s, num;
+    size_t k, targetNum;
+
+    buf = FGAlloc(graph, graph->blockNum * sizeof (*buf));
+    mark = FGAlloc(graph, graph->blockNum * sizeof (*mark));
+    if (!buf || !mark)
+        return -ENOMEM;
+    memset(mark, 0xff, graph->blockNum * sizeof (*mark));
+
+    for (b = 0; b < graph->blockNum; b++) {
+        block = &graph->blockArr[b];
+        qr = &graph->record->qrArr[block->end - 1];
+        num = 0;
+        targetNum = FGTargetNum(qr);
+        for (k = 0; k < targetNum; k++) {
+            s = FGBlockOf(graph, FGTarget(qr, k));
+            if (mark[s] != b) {
+                mark[s] = b;
+                buf[num++] = s;
+            }
+        }
+        if (FGFallThrough(qr->op) && b + 1 < graph->blockNum && mark[b + 1] != b) {
+            mark[b + 1] = b;
+            buf[num++] = b + 1;
+        }
+        block->succArr = FGAlloc(graph, num * sizeof (*block->succArr));
+        if (!block->succArr)
+            return -ENOMEM;
+        memcpy(block->succArr, buf, num * sizeof (*buf));
+        block->succNum = num;
+        for (k = 0; k < num; k++)
+            graph->blockArr[buf[k]].predNum++;
+    }
+
+    for (b = 0; b < graph->blockNum; b++) {
+        block = &graph->blockArr[b];
+        block->predArr = FGAlloc(graph, block->predNum * sizeof (*block->predArr));
+        if (!block->predArr)
+            return -ENOMEM;
+        block->predNum = 0;
+    }
+    for (b = 0; b < graph->blockNum; b++) {
+        block = &graph->blockArr[b];
+        for (k = 0; k < block->succNum; k++) {
+            succ = &graph->blockArr[block->succArr[k]];
+            succ->predArr[succ->predNum++] = b;
+        }
+    }
+    return 0;
+}
+
+/*
+ * 功能：从入口块深度优先遍历流图，计算可达基本块的逆后序。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int FGOrderBlocks(FlowGraph *graph)
+{
+    FGBlock *block;
+    uint32_t *stack, *nextArr, *postArr;
+    uint8_t *visited;
+    uint32_t top, postNum = 0, b, s, i;
+
+    stack = FGAlloc(graph, graph->blockNum * sizeof (*stack));
+    nextArr = FGAlloc(graph, graph->blockNum * sizeof (*nextArr));
+    postArr = FGAlloc(graph, graph->blockNum * sizeof (*postArr));
+    visited = FGAlloc(graph, graph->blockNum);
+    if (!stack || !nextArr || !postArr || !visited)
+        return -ENOMEM;
+
+    top = 0;
+    stack[top++] = 0;
+    visited[0] = 1;
+    while (top > 0) {
+        b = stack[top - 1];
+        block = &graph->blockArr[b];
+        if (nextArr[b] < block->succNum) {
+            s = block->succArr[nextArr[b]++];
+            if (!visited[s]) {
+                visited[s] = 1;
+                stack[top++] = s;
+            }
+        } else {
+            top--;
+            postArr[postNum++] = b;
+        }
+    }
+
+    for (b = 0; b < graph->blockNum; b++)
+        graph->blockArr[b].rpoIdx = FG_NONE;
+    graph->rpoArr = postArr;
+    graph->rpoNum = postNum;
+    for (i = 0; i < postNum / 2; i++) {
+        s = postArr[i];
+        postArr[i] = postArr[postNum - 1 - i];
+        postArr[postNum - 1 - i] = s;
+    }
+    for (i = 0; i < postNum; i++)
+        graph->blockArr[postArr[i]].rpoIdx = i;
+    return 0;
+}
+
+static uint32_t FGIntersect(const FlowGraph *graph, uint32_t a, uint32_t b)
+{
+    while (a != b) {
+        while (graph->blockArr[a].rpoIdx > graph->blockArr[b].rpoIdx)
+            a = graph->blockArr[a].idom;
+        while (graph->blockArr[b].rpoIdx > graph->blockArr[a].rpoIdx)
+            b = graph->blockArr[b].idom;
+    }
+    return a;
+}
+
+/*
+ * 功能：按逆后序迭代计算直接支配者，算法见Cooper、Harvey和Kennedy的
+ *      "A Simple, Fast Dominance Algorithm"。
+ * 返回值：无
+ **/
+static void FGComputeDominators(FlowGraph *graph)
+{
+    FGBlock *block;
+    uint32_t i, k, p, newIdom;
+    int changed = 1;
+
+    for (i = 0; i < graph->blockNum; i++)
+        graph->blockArr[i].idom = FG_NONE;
+    graph->blockArr[0].idom = 0;
+    while (changed) {
+        changed = 0;
+        for (i = 1; i < graph->rpoNum; i++) {
+            block = &graph->blockArr[graph->rpoArr[i]];
+            newIdom = FG_NONE;
+            for (k = 0; k < block->predNum; k++) {
+                p = block->predArr[k];
+                if (graph->blockArr[p].idom == FG_NONE)
+                    continue;
+                newIdom = newIdom == FG_NONE ? p : FGIntersect(graph, p, newIdom);
+            }
+            if (block->idom != newIdom) {
+                block->idom = newIdom;
+                changed = 1;
+            }
+        }
+    }
+    graph->blockArr[0].idom = FG_NONE;
+}
+
+/*
+ * 功能：根据直接支配者建立支配树，并计算支配边界，算法见Cooper、Harvey和Kennedy的论文。
+ *      有多个前驱的基本块b是从前驱到b的直接支配者路径上（不含b的直接支配者）
+ *      各基本块的支配边界。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int FGComputeFrontiers(FlowGraph *graph)
+{
+    FGBlock *block, *runner;
+    uint32_t *mark;
+    uint32_t b, k, r;
+    int pass;
+
+    mark = FGAlloc(graph, graph->blockNum * sizeof (*mark));
+    if (!mark)
+        return -ENOMEM;
+    for (b = 0; b < graph->blockNum; b++) {
+        block = &graph->blockArr[b];
+        if (block->idom != FG_NONE)
+            graph->blockArr[block->idom].domChildNum++;
+    }
+
+    /*第一遍计数，第二遍填写*/
+    for (pass = 0; pass < 2; pass++) {
+        for (b = 0; b < graph->blockNum; b++) {
+            block = &graph->blockArr[b];
+            if (pass == 1) {
+                block->domChildArr = FGAlloc(graph, block->domChildNum * sizeof (*block->domChildArr));
+                block->dfArr = FGAlloc(graph, block->dfNum * sizeof (*block->dfArr));
+                if (!block->domChildArr || !block->dfArr)
+                    return -ENOMEM;
+                block->domChildNum = 0;
+                block->dfNum = 0;
+            }
+        }
+        memset(mark, 0xff, graph->blockNum * sizeof (*mark));
+        for (b = 0; b < graph->blockNum; b++) {
+            block = &graph->blockArr[b];
+            if (pass == 1 && block->idom != FG_NONE) {
+                runner = &graph->blockArr[block->idom];
+                runner->domChildArr[runner->domChildNum++] = b;
+            }
+            if (block->rpoIdx == FG_NONE || block->predNum < 2)
+                continue;
+            for (k = 0; k < block->predNum; k++) {
+                r = block->predArr[k];
+                if (graph->blockArr[r].rpoIdx == FG_NONE)
+                    continue;
+                while (r != block->idom) {
+                    runner = &graph->blockArr[r];
+                    if (mark[r] != b) {
+                        mark[r] = b;
+                        if (pass == 1)
+                            runner->dfArr[runner->dfNum] = b;
+                        runner->dfNum++;
+                    }
+                    r = runner->idom;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int FGIdCmp(const void *a, const void *b)
+{
+    uint32_t l = *(const uint32_t *)a, r = *(const uint32_t *)b;
+
+    return l < r ? -1 : l > r;
+}
+
+/*
+ * 功能：收集头块为header的自然循环，循环体是不经过头块就能到达回边起点的基本块。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int FGCollectLoop(FlowGraph *graph, FGLoop *loop, uint32_t header,
+                         uint32_t *mark, uint32_t stamp, uint32_t *stack)
+{
+    FGBlock *block = &graph->blockArr[header];
+    uint32_t top = 0, num = 0, b, k, p;
+
+    loop->header = header;
+    loop->latchArr = FGAlloc(graph, block->predNum * sizeof (*loop->latchArr));
+    if (!loop->latchArr)
+        return -ENOMEM;
+    mark[header] = stamp;
+    num++;
+    for (k = 0; k < block->predNum; k++) {
+        p = block->predArr[k];
+        if (!FGDominates(graph, header, p))
+            continue;
+        loop->latchArr[loop->latchNum++] = p;
+        if (mark[p] != stamp) {
+            mark[p] = stamp;
+            stack[top++] = p;
+            num++;
+        }
+    }
+    while (top > 0) {
+        b = stack[--top];
+        block = &graph->blockArr[b];
+        for (k = 0; k < block->predNum; k++) {
+            p = block->predArr[k];
+            if (mark[p] != stamp && graph->blockArr[p].rpoIdx != FG_NONE) {
+                mark[p] = stamp;
+                stack[top++] = p;
+                num++;
+            }
+        }
+    }
+
+    loop->blockArr = FGAlloc(graph, num * sizeof (*loop->blockArr));
+    if (!loop->blockArr)
+        return -ENOMEM;
+    loop->blockNum = 0;
+    for (k = 0; k < graph->rpoNum; k++) {
+        b = graph->rpoArr[k];
+        if (mark[b] == stamp)
+            loop->blockArr[loop->blockNum++] = b;
+    }
+    qsort(loop->blockArr, loop->blockNum, sizeof (*loop->blockArr), FGIdCmp);
+    return 0;
+}
+
+/*
+ * 功能：查找自然循环，回边的终点支配起点，并计算循环的嵌套关系。
+ *      循环按头块的逆后序处理，外层循环的头块支配内层循环的头块，所以先处理外层循环。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int FGFindLoops(FlowGraph *graph)
+{
+    FGBlock *block;
+    FGLoop *loop;
+    uint32_t *mark, *stack;
+    uint32_t i, k, h;
+    int error = 0;
+
+    for (i = 0; i < graph->rpoNum; i++) {
+        block = &graph->blockArr[graph->rpoArr[i]];
+        for (k = 0; k < block->predNum; k++) {
+            if (FGDominates(graph, block->id, block->predArr[k])) {
+                graph->loopNum++;
+                break;
+            }
+        }
+    }
+    for (i = 0; i < graph->blockNum; i++) {
+        graph->blockArr[i].loop = FG_NONE;
+        graph->blockArr[i].loopDepth = 0;
+    }
+    if (graph->loopNum == 0)
+        return 0;
+
+    graph->loopArr = FGAlloc(graph, graph->loopNum * sizeof (*graph->loopArr));
+    mark = FGAlloc(graph, graph->blockNum * sizeof (*mark));
+    stack = FGAlloc(graph, graph->blockNum * sizeof (*stack));
+    if (!graph->loopArr || !mark || !stack)
+        return -ENOMEM;
+    memset(mark, 0xff, graph->blockNum * sizeof (*mark));
+
+    h = 0;
+    for (i = 0; i < graph->rpoNum; i++) {
+        block = &graph->blockArr[graph->rpoArr[i]];
+        for (k = 0; k < block->predNum; k++) {
+            if (FGDominates(graph, block->id, block->predArr[k]))
+                break;
+        }
+        if (k == block->predNum)
+            continue;
+        loop = &graph->loopArr[h];
+        error = FGCollectLoop(graph, loop, block->id, mark, h, stack);
+        if (error != -ENOERR)
+            return error;
+        loop->parent = block->loop;
+        loop->depth = loop->parent == FG_NONE ? 1 : graph->loopArr[loop->parent].depth + 1;
+        for (k = 0; k < loop->blockNum; k++) {
+            graph->blockArr[loop->blockArr[k]].loop = h;
+            graph->blockArr[loop->blockArr[k]].loopDepth = loop->depth;
+        }
+        h++;
+    }
+    return 0;
+}
+
+/*
+ * 功能：为从start开始的函数定义构造控制流图，start处的四元式必须是fun start。
+ * pGraph：输出型参数，控制流图，由调用者用FGFree释放
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int FGBuild(const QRRecord *record, size_t start, FlowGraph **pGraph)
+{
+    FlowGraph *graph;
+    CplArena *arena;
+    size_t end;
+    int error = 0;
+
+    if (!record || !pGraph || start >= record->idx || record->qrArr[start].op != QROC_FUN_START)
+        return -EINVAL;
+    for (end = start + 1; end < record->idx; end++) {
+        if (record->qrArr[end].op == QROC_FUN_END)
+            break;
+    }
+    if (end == record->idx) {
+        PrErr("fun end not found, start: %zu", start);
+        return -EINVAL;
+    }
+
+    arena = CplArenaCreate(0);
+    if (!arena)
+        return -ENOMEM;
+    graph = CplArenaCalloc(arena, sizeof (*graph));
+    if (!graph) {
+        error = -ENOMEM;
+        goto err;
+    }
+    graph->arena = arena;
+    graph->record = record;
+    graph->start = start;
+    graph->end = end + 1;
+
+    error = FGSplitBlocks(graph);
+    if (error != -ENOERR)
+        goto err;
+    error = FGLinkBlocks(graph);
+    if (error != -ENOERR)
+        goto err;
+    error = FGOrderBlocks(graph);
+    if (error != -ENOERR)
+        goto err;
+    FGComputeDominators(graph);
+    error = FGComputeFrontiers(graph);
+    if (error != -ENOERR)
+        goto err;
+    error = FGFindLoops(graph);
+    if (error != -ENOERR)
+        goto err;
+    *pGraph = graph;
+    return 0;
+
+err:
+    CplArenaDestroy(arena);
+    return error;
+}
+
+void FGFree(FlowGraph *graph)
+{
+    if (graph)
+        CplArenaDestroy(graph->arena);
+}
+
+/*
+ * 功能：获取四元式所在的基本块。
+ * 返回值：基本块id，四元式不在函数中时返回FG_NONE。
+ **/
+uint32_t FGBlockOf(const FlowGraph *graph, size_t idx)
+{
+    if (idx < graph->start || idx >= graph->end)
+        return FG_NONE;
+    return graph->blockMap[idx - graph->start];
+}
+
+/*
+ * 功能：判断基本块a是否支配基本块b，基本块支配自身。
+ * 返回值：支配时返回1，否则返回0，b不可达时返回0。
+ **/
+int FGDominates(const FlowGraph *graph, uint32_t a, uint32_t b)
+{
+    if (graph->blockArr[b].rpoIdx == FG_NONE)
+        return 0;
+    while (b != FG_NONE) {
+        if (b == a)
+            return 1;
+        b = graph->blockArr[b].idom;
+    }
+    return 0;
+}
+
+/*
+ * 功能：以Graphviz子图的格式输出控制流图，结点用首指令的下标命名，在一个文件中输出多个
+ *      函数时结点名不会冲突。实线是控制流边，虚线从直接支配者指向基本块，
+ *      双线框是循环头块，点线框是不可达的基本块。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int FGDumpDot(const FlowGraph *graph, FILE *fp)
+{
+    const FGBlock *block;
+    const char *name;
+    uint32_t b, k;
+
+    if (!graph || !fp)
+        return -EINVAL;
+
+    name = graph->record->qrArr[graph->start].funStartFlag.id->cplString->str;
+    fprintf(fp, "    subgraph \"cluster_%s\" {\n", name);
+    fprintf(fp, "        label=\"%s\";\n", name);
+    for (b = 0; b < graph->blockNum; b++) {
+        block = &graph->blockArr[b];
+        fprintf(fp, "        n%zu [label=\"B%u\\n%04zu-%04zu", block->start, b,
+                block->start, block->end - 1);
+        if (block->loopDepth)
+            fprintf(fp, "\\nloop depth %u", block->loopDepth);
+        fprintf(fp, "\"");
+        if (block->rpoIdx == FG_NONE)
+            fprintf(fp, ", style=dotted");
+        else if (block->loop != FG_NONE && graph->loopArr[block->loop].header == b)
+            fprintf(fp, ", peripheries=2");
+        fprintf(fp, "];\n");
+    }
+    for (b = 0; b < graph->blockNum; b++) {
+        block = &graph->blockArr[b];
+        for (k = 0; k < block->succNum; k++)
+            fprintf(fp, "        n%zu -> n%zu;\n", block->start,
+                    graph->blockArr[block->succArr[k]].start);
+        if (block->idom != FG_NONE)
+            fprintf(fp, "        n%zu -> n%zu [style=dashed, color=gray, constraint=false];\n",
+                    graph->blockArr[block->idom].start, block->start);
+    }
+    fprintf(fp, "    }\n");
+    if (ferror(fp)) {
+        PrErr("write flow graph failed\n");
+        return -EMISC;
+    }
+    return 0;
+}
+
+/*
+ * 功能：为四元式记录中的每个函数定义构造控制流图，以Graphviz格式输出到一个图中。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int FGDumpRecordDot(const QRRecord *record, FILE *fp)
+{
+    FlowGraph *graph;
+    size_t i;
+    int error = 0;
+
+    if (!record || !fp)
+        return -EINVAL;
+
+    fprintf(fp, "digraph cfg {\n");
+    fprintf(fp, "    node [shape=box];\n");
+    for (i = 0; i < record->idx; ) {
+        if (record->qrArr[i].op != QROC_FUN_START) {
+            i++;
+            continue;
+        }
+        error = FGBuild(record, i, &graph);
+        if (error != -ENOERR)
+            return error;
+        error = FGDumpDot(graph, fp);
+        i = graph->end;
+        FGFree(graph);
+        if (error != -ENOERR)
+            return error;
+    }
+    fprintf(fp, "}\n");
+    if (ferror(fp)) {
+        PrErr("write flow graph failed\n");
+        return -EMISC;
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#ifndef __FLOW_GRAPH_H__
+#define __FLOW_GRAPH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdio.h"
+#include "stdint.h"
+#include "quadruple.h"
+#include "cpl_mm.h"
+
+/*
+ * 四元式的控制流图。每个函数定义（从fun start到fun end）单独构造一个流图，
+ * 四元式划分成基本块，基本块之间是前驱后继关系，并计算支配树、支配边界和自然循环。
+ * 流图只引用四元式下标，不修改四元式记录，记录变化后需要重新构造。
+ **/
+
+#define FG_NONE     ((uint32_t)-1)
+
+/*基本块，包含四元式下标区间[start, end)*/
+typedef struct {
+    uint32_t id;
+    size_t start;
+    size_t end;
+    uint32_t *succArr;      /*后继基本块id*/
+    uint32_t succNum;
+    uint32_t *predArr;      /*前驱基本块id*/
+    uint32_t predNum;
+    uint32_t rpoIdx;        /*在逆后序中的位置，不可达的基本块为FG_NONE*/
+    uint32_t idom;          /*直接支配者，入口块和不可达的基本块为FG_NONE*/
+    uint32_t *domChildArr;  /*支配树上的子结点，按id升序排列*/
+    uint32_t domChildNum;
+    uint32_t *dfArr;        /*支配边界*/
+    uint32_t dfNum;
+    uint32_t loop;          /*包含基本块的最内层循环，不在循环中时为FG_NONE*/
+    uint32_t loopDepth;     /*循环嵌套深度，不在循环中时为0*/
+} FGBlock;
+
+/*自然循环，头块相同的回边合并成一个循环*/
+typedef struct {
+    uint32_t header;        /*头块id*/
+    uint32_t parent;        /*外层循环，最外层循环为FG_NONE*/
+    uint32_t depth;         /*嵌套深度，最外层循环为1*/
+    uint32_t *blockArr;     /*循环中的基本块id，包括头块，按id升序排列*/
+    uint32_t blockNum;
+    uint32_t *latchArr;     /*回边的起点*/
+    uint32_t latchNum;
+} FGLoop;
+
+typedef struct _FlowGraph {
+    const QRRecord *record;
+    size_t start;           /*函数的四元式下标区间[start, end)*/
+    size_t end;
+    FGBlock *blockArr;      /*按四元式顺序排列，0号是入口块*/
+    uint32_t blockNum;
+    uint32_t *blockMap;     /*四元式下标减去start得到的下标到基本块id的映射*/
+    uint32_t *rpoArr;       /*可达基本块的逆后序*/
+    uint32_t rpoNum;
+    FGLoop *loopArr;        /*按头块的逆后序排列，外层循环在内层循环之前*/
+    uint32_t loopNum;
+    CplArena *arena;        /*流图的所有内存*/
+} FlowGraph;
+
+int FGBuild(const QRRecord *record, size_t start, FlowGraph **pGraph);
+void FGFree(FlowGraph *graph);
+
+uint32_t FGBlockOf(const FlowGraph *graph, size_t idx);
+int FGDominates(const FlowGraph *graph, uint32_t a, uint32_t b);
+
+int FGDumpDot(const FlowGraph *graph, FILE *fp);
+int FGDumpRecordDot(const QRRecord *record, FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__FLOW_GRAPH_H__*/
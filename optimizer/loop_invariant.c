@@ -0,0 +1,765 @@
+#include "loop_invariant.h"
+#include "bison.h"
+#include "environ.h"
+#include "cpl_errno.h"
+#include "cpl_debug.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
+
+/*循环中直接写入的一段内存：变量、数组或者结构体中的字节范围[start, end)*/
+typedef struct {
+    const DomainEntry *entry;
+    size_t start;
+    size_t end;     /*写入整个变量或者偏移量不是常量时范围是[0, SIZE_MAX)*/
+} LIStore;
+
+/*循环不变量外提过程中的信息*/
+typedef struct {
+    Bison *bison;
+    QRRecord *record;
+    SSAFunction *ssa;
+    FlowGraph *graph;
+    uint8_t *keepArr;
+    uint32_t *defNum;       /*临时变量的定义次数*/
+    size_t *defIdx;         /*临时变量最后一次定义的四元式下标*/
+    uint8_t *fixedDomain;   /*临时变量出现在条件或者成员访问的基址中，不能改变所在的作用域*/
+    Domain **newDomain;     /*外提后改到的作用域，不改变时为NULL*/
+    Domain **domainArr;     /*四元式执行前所在的作用域，块中的四元式取块外的作用域，按四元式下标减去graph->start索引*/
+    uint32_t *hoistArr;     /*四元式外提到的循环，没有外提时为FG_NONE，按四元式下标减去graph->start索引*/
+    uint32_t *loopAt;       /*以这条四元式开始的循环头所在的循环*/
+    uint8_t *inLoop;        /*按基本块id索引，是否在当前处理的循环中*/
+    LIStore *storeArr;      /*当前循环中直接写入的内存*/
+    uint32_t storeNum;
+    int storeAny;           /*当前循环中有间接写内存或者函数调用*/
+    CplArena *arena;
+} LIContext;
+
+static void *LIAlloc(LIContext *ctx, size_t size)
+{
+    return CplArenaCalloc(ctx->arena, size ? size : 1);
+}
+
+static uint32_t *LIHoist(LIContext *ctx, size_t idx)
+{
+    return &ctx->hoistArr[idx - ctx->graph->start];
+}
+
+/*
+ * 功能：获取四元式当前所在的基本块，外提的四元式在前置块中，即循环头之前的基本块。
+ * 返回值：
+ **/
+static uint32_t LIBlockOf(LIContext *ctx, size_t idx)
+{
+    FlowGraph *graph = ctx->graph;
+    uint32_t l = *LIHoist(ctx, idx);
+
+    if (l == FG_NONE)
+        return FGBlockOf(graph, idx);
+    return FGBlockOf(graph, graph->blockArr[graph->loopArr[l].header].start - 1);
+}
+
+/*
+ * 功能：判断domain作用域中的变量在at作用域中是否可以访问，全局变量总是可以访问。
+ * 返回值：可以访问时返回1，否则返回0。
+ **/
+static int LIVisible(const Domain *domain, const Domain *at)
+{
+    if (domain->type == DT_GLOBAL)
+        return 1;
+    for (; at; at = at->prev) {
+        if (at == domain)
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * 功能：判断循环中读取的变量、数组或者结构体中的字节范围[start, end)在循环中是否不变，
+ *      循环只写入同一个变量的其他成员时仍然不变。
+ * 返回值：不变时返回1，否则返回0。
+ **/
+static int LIEntryInvariant(LIContext *ctx, const DomainEntry *entry, size_t start, size_t end,
+                            const Domain *at)
+{
+    const LIStore *store;
+    uint32_t k;
+
+    if (!entry || ctx->storeAny || !LIVisible(entry->domain, at))
+        return 0;
+    for (k = 0; k < ctx->storeNum; k++) {
+        store = &ctx->storeArr[k];
+        if (store->entry == entry && store->start < end && start < store->end)
+            return 0;
+    }
+    return 1;
+}
+
+/*
+ * 功能：判断定义在下标defIdx处的值对于下标useIdx处的使用是否是循环不变量。
+ *      定义在循环之外，或者已经外提并且在使用之前，外提后仍然在使用之前。
+ * 返回值：是时返回1，否则返回0。
+ **/
+static int LIDefInvariant(LIContext *ctx, size_t defIdx, size_t useIdx)
+{
+    if (*LIHoist(ctx, defIdx) != FG_NONE && defIdx < useIdx)
+        return 1;
+    return !ctx->inLoop[LIBlockOf(ctx, defIdx)];
+}
+
+/*
+ * 功能：判断提升的变量的一个版本在循环中是否不变。
+ * 返回值：不变时返回1，否则返回0。
+ **/
+static int LINameInvariant(LIContext *ctx, SSAName name, size_t useIdx)
+{
+    const SSADef *def;
+
+    if (name.var == SSA_NONE)
+        return 0;
+    def = &ctx->ssa->varArr[name.var].defArr[name.ver];
+    if (def->phi || name.ver == 0)
+        return !ctx->inLoop[def->block];
+    return LIDefInvariant(ctx, def->idx, useIdx);
+}
+
+/*
+ * 功能：判断临时变量在循环中是否不变，只定义一次的临时变量的定义在循环之外或者已经外提。
+ * 返回值：不变时返回1，否则返回0。
+ **/
+static int LITempInvariant(LIContext *ctx, const Temp *temp, const Domain *domain,
+                           size_t useIdx, const Domain *at)
+{
+    uint32_t var;
+    size_t defIdx;
+
+    var = SSAVarOfTemp(ctx->ssa, temp);
+    if (var == SSA_NONE || ctx->defNum[var] != 1)
+        return 0;
+    defIdx = ctx->defIdx[var];
+    if (defIdx >= useIdx)
+        return 0;
+    if (*LIHoist(ctx, defIdx) != FG_NONE)
+        return 1;
+    return LIVisible(domain, at) && LIDefInvariant(ctx, defIdx, useIdx);
+}
+
+/*
+ * 功能：判断成员访问的偏移量是否是常量。
+ * 返回值：
+ **/
+static int LIConstOffset(const QRAccessMbr *accessMbr)
+{
+    return !accessMbr->offset || accessMbr->offset->offsetType == QRAMOT_VAL;
+}
+
+/*
+ * 功能：计算偏移量是常量的成员访问读写的字节范围，偏移量不是常量时是整个变量。
+ * 返回值：
+ **/
+static void LIAccessRange(const QRAccessMbr *accessMbr, size_t *pStart, size_t *pEnd)
+{
+    if (!LIConstOffset(accessMbr) || (accessMbr->offset && accessMbr->offset->valOffset < 0)) {
+        *pStart = 0;
+        *pEnd = SIZE_MAX;
+        return;
+    }
+    *pStart = accessMbr->offset ? (size_t)accessMbr->offset->valOffset : 0;
+    *pEnd = *pStart + ATreeTypeSize(accessMbr->dataType);
+}
+
+/*
+ * 功能：判断操作数在循环中是否不变，并且提前读取不会出错。name是操作数在SSA形式中的版本。
+ * 返回值：不变时返回1，否则返回0。
+ **/
+static int LIOperandInvariant(LIContext *ctx, const QROperand *operand, SSAName name,
+                              size_t useIdx, const Domain *at)
+{
+    const QRAccessMbr *accessMbr;
+    const SSAVar *var;
+    size_t start, end;
+    uint32_t v;
+
+    if (!operand)
+        return 1;
+    switch (operand->type) {
+    case QROT_VAL:
+        return 1;
+    case QROT_ID:
+    case QROT_TEMP:
+        v = SSAVarOfOperand(ctx->ssa, operand);
+        if (v != SSA_NONE && ctx->ssa->varArr[v].promoted) {
+            var = &ctx->ssa->varArr[v];
+            if (var->kind == SSAVK_ID && !LIVisible(var->entry->domain, at))
+                return 0;
+            if (var->kind == SSAVK_TEMP && ctx->defNum[v] == 1 && *LIHoist(ctx, ctx->defIdx[v]) != FG_NONE)
+                return ctx->defIdx[v] < useIdx;
+            if (var->kind == SSAVK_TEMP && !LIVisible(operand->domain, at))
+                return 0;
+            return LINameInvariant(ctx, name, useIdx);
+        }
+        if (operand->type == QROT_TEMP)
+            return LITempInvariant(ctx, operand->temp, operand->domain, useIdx, at);
+        return LIEntryInvariant(ctx, EnvDomainGetEntry(operand->domain, operand->id.token), 0, SIZE_MAX, at);
+    case QROT_ACCESS_MBR:
+        /*
+         * 偏移量不是常量的数组元素不外提：循环一次也不执行时前置块中的读取仍然执行，
+         * 这时下标可能越界，虚拟机不检查访问的地址。
+         **/
+        accessMbr = &operand->accessMbr;
+        if (accessMbr->type != QRAMT_DIRECT || accessMbr->baseType != QRAMBT_ID || !LIConstOffset(accessMbr))
+            return 0;
+        LIAccessRange(accessMbr, &start, &end);
+        return LIEntryInvariant(ctx, EnvDomainGetEntry(operand->domain, accessMbr->baseId.token), start, end, at);
+    case QROT_GET_ADDR:
+        if (operand->getAddr.type == QRGAT_ID)
+            return LIVisible(EnvDomainGetEntry(operand->domain, operand->getAddr.id.token)->domain, at);
+        accessMbr = &operand->getAddr.accessMbr;
+        if (accessMbr->type != QRAMT_DIRECT || accessMbr->baseType != QRAMBT_ID || !LIConstOffset(accessMbr))
+            return 0;
+        return LIVisible(EnvDomainGetEntry(operand->domain, accessMbr->baseId.token)->domain, at);
+    default:
+        return 0;
+    }
+}
+
+/*
+ * 功能：判断四元式是否可以外提到作用域为at的前置块。
+ * 返回值：可以时返回1，否则返回0。
+ **/
+static int LIInstrInvariant(LIContext *ctx, size_t idx, const Domain *at)
+{
+    const QuadRuple *qr = &ctx->record->qrArr[idx];
+    const SSAInstr *ins = SSAInstrOf(ctx->ssa, idx);
+    const QROperand *result;
+    uint32_t var;
+
+    switch (qr->op) {
+    case QROC_DIV:
+    case QROC_MOD:
+        if (qr->binOp.arg2->type != QROT_VAL || qr->binOp.arg2->val.type != QRVT_INT
+                || qr->binOp.arg2->val.ival == 0)
+            return 0;
+        /*fall through*/
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+        if (!LIOperandInvariant(ctx, qr->binOp.arg1, ins->useArr[0], idx, at)
+                || !LIOperandInvariant(ctx, qr->binOp.arg2, ins->useArr[1], idx, at))
+            return 0;
+        result = qr->binOp.result;
+        break;
+    case QROC_ASSIGN:
+        if (!LIOperandInvariant(ctx, qr->unaryOp.arg1, ins->useArr[0], idx, at))
+            return 0;
+        result = qr->unaryOp.result;
+        break;
+    default:
+        return 0;
+    }
+    if (result->type != QROT_TEMP)
+        return 0;
+    var = SSAVarOfTemp(ctx->ssa, result->temp);
+    if (var == SSA_NONE || ctx->defNum[var] != 1)
+        return 0;
+    return LIVisible(result->domain, at) || !ctx->fixedDomain[var];
+}
+
+/*
+ * 功能：判断是否是算术运算四元式，结果在binOp.result中。
+ * 返回值：是时返回1，否则返回0。
+ **/
+static int LIArithOp(QROpCode op)
+{
+    switch (op) {
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+    case QROC_DIV:
+    case QROC_MOD:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void LIAddStore(LIContext *ctx, const DomainEntry *entry, size_t start, size_t end)
+{
+    LIStore *store = &ctx->storeArr[ctx->storeNum++];
+
+    store->entry = entry;
+    store->start = start;
+    store->end = end;
+}
+
+/*
+ * 功能：记录循环中写入的内存。直接写入变量的成员时只记录写入的字节范围，
+ *      间接写内存和函数调用可能写入任何内存。
+ * 返回值：
+ **/
+static void LIScanStores(LIContext *ctx, const FGLoop *loop)
+{
+    const FGBlock *block;
+    const QuadRuple *qr;
+    const QROperand *result;
+    const QRAccessMbr *accessMbr;
+    uint32_t k, var;
+    size_t i, start, end;
+
+    ctx->storeNum = 0;
+    ctx->storeAny = 0;
+    for (k = 0; k < loop->blockNum; k++) {
+        block = &ctx->graph->blockArr[loop->blockArr[k]];
+        for (i = block->start; i < block->end; i++) {
+            qr = &ctx->record->qrArr[i];
+            if (!ctx->keepArr[i])
+                continue;
+            if (qr->op == QROC_FUN_CALL || qr->op == QROC_FUN_CALL_NRV) {
+                ctx->storeAny = 1;
+                continue;
+            }
+            if (LIArithOp(qr->op))
+                result = qr->binOp.result;
+            else if (qr->op == QROC_ASSIGN)
+                result = qr->unaryOp.result;
+            else
+                continue;
+            var = SSAVarOfOperand(ctx->ssa, result);
+            if (result->type == QROT_ID && var != SSA_NONE && ctx->ssa->varArr[var].promoted)
+                continue;
+            if (result->type == QROT_ID) {
+                LIAddStore(ctx, EnvDomainGetEntry(result->domain, result->id.token), 0, SIZE_MAX);
+            } else if (result->type == QROT_ACCESS_MBR) {
+                accessMbr = &result->accessMbr;
+                if (accessMbr->type == QRAMT_DIRECT && accessMbr->baseType == QRAMBT_ID) {
+                    LIAccessRange(accessMbr, &start, &end);
+                    LIAddStore(ctx, EnvDomainGetEntry(result->domain, accessMbr->baseId.token), start, end);
+                } else {
+                    ctx->storeAny = 1;
+                }
+            }
+        }
+    }
+}
+
+static void LIMarkLoop(LIContext *ctx, const FGLoop *loop, uint8_t mark)
+{
+    uint32_t k;
+
+    for (k = 0; k < loop->blockNum; k++)
+        ctx->inLoop[loop->blockArr[k]] = mark;
+}
+
+/*
+ * 功能：找出循环l中可以外提的四元式，包括已经外提到内层循环前置块中的四元式。
+ *      循环头之前的四元式要在循环之外，前置块才能插在它和循环头之间。
+ * 返回值：
+ **/
+static void LIHoistLoop(LIContext *ctx, uint32_t l)
+{
+    FlowGraph *graph = ctx->graph;
+    const FGLoop *loop = &graph->loopArr[l];
+    const FGBlock *block;
+    const Domain *at;
+    size_t h = graph->blockArr[loop->header].start, i;
+    uint32_t k;
+    int changed;
+
+    if (h <= graph->start)
+        return;
+    at = ctx->domainArr[h - graph->start];
+    LIMarkLoop(ctx, loop, 1);
+    if (!at || ctx->inLoop[FGBlockOf(graph, h - 1)])
+        goto out;
+    LIScanStores(ctx, loop);
+    do {
+        changed = 0;
+        for (k = 0; k < loop->blockNum; k++) {
+            block = &graph->blockArr[loop->blockArr[k]];
+            for (i = block->start; i < block->end; i++) {
+                if (!ctx->keepArr[i] || *LIHoist(ctx, i) == l || !ctx->inLoop[LIBlockOf(ctx, i)])
+                    continue;
+                if (LIInstrInvariant(ctx, i, at)) {
+                    *LIHoist(ctx, i) = l;
+                    changed = 1;
+                }
+            }
+        }
+    } while (changed);
+out:
+    LIMarkLoop(ctx, loop, 0);
+}
+
+/*
+ * 功能：登记临时变量的定义，以及出现在条件或者成员访问基址中的临时变量。
+ * 返回值：
+ **/
+static void LIScanTemp(LIContext *ctx, const Temp *temp, int fixed, size_t defIdx)
+{
+    uint32_t var;
+
+    var = SSAVarOfTemp(ctx->ssa, temp);
+    if (var == SSA_NONE)
+        return;
+    if (fixed)
+        ctx->fixedDomain[var] = 1;
+    if (defIdx != SIZE_MAX) {
+        ctx->defNum[var]++;
+        ctx->defIdx[var] = defIdx;
+    }
+}
+
+static void LIScanAccessMbr(LIContext *ctx, const QRAccessMbr *accessMbr, int fixed)
+{
+    if (accessMbr->baseType == QRAMBT_TEMP)
+        LIScanTemp(ctx, accessMbr->baseTemp, 1, SIZE_MAX);
+    if (accessMbr->offset && accessMbr->offset->offsetType == QRAMOT_TEMP)
+        LIScanTemp(ctx, accessMbr->offset->tempOffset.temp, fixed, SIZE_MAX);
+}
+
+/*
+ * 功能：登记操作数中的临时变量。defIdx不是SIZE_MAX时操作数是下标defIdx处四元式的结果，
+ *      fixed为1时操作数出现在条件中。
+ * 返回值：
+ **/
+static void LIScanOperand(LIContext *ctx, const QROperand *operand, int fixed, size_t defIdx)
+{
+    if (!operand)
+        return;
+    if (operand->type == QROT_TEMP)
+        LIScanTemp(ctx, operand->temp, fixed, defIdx);
+    else if (operand->type == QROT_ACCESS_MBR)
+        LIScanAccessMbr(ctx, &operand->accessMbr, fixed);
+    else if (operand->type == QROT_GET_ADDR && operand->getAddr.type == QRGAT_ACCESS_MEM)
+        LIScanAccessMbr(ctx, &operand->getAddr.accessMbr, fixed);
+}
+
+static void LIScanExpr(LIContext *ctx, Expr *expr)
+{
+    if (expr->type == ET_TEMP)
+        LIScanTemp(ctx, &expr->temp, 1, SIZE_MAX);
+    else if (expr->type != ET_ID && expr->type != ET_CONST && expr->type != ET_CONST_SPC)
+        LIScanOperand(ctx, QROperandFromExpr(ctx->bison, expr), 1, SIZE_MAX);
+}
+
+static void LIScanInstr(LIContext *ctx, size_t i)
+{
+    const QuadRuple *qr = &ctx->record->qrArr[i];
+
+    switch (qr->op) {
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+    case QROC_DIV:
+    case QROC_MOD:
+        LIScanOperand(ctx, qr->binOp.arg1, 0, SIZE_MAX);
+        LIScanOperand(ctx, qr->binOp.arg2, 0, SIZE_MAX);
+        LIScanOperand(ctx, qr->binOp.result, 0, i);
+        break;
+    case QROC_ASSIGN:
+        LIScanOperand(ctx, qr->unaryOp.arg1, 0, SIZE_MAX);
+        LIScanOperand(ctx, qr->unaryOp.result, 0, i);
+        break;
+    case QROC_TRUE_JUMP:
+    case QROC_FALSE_JUMP:
+        if (SSAUseNum(qr) == 2) {
+            LIScanExpr(ctx, ATreeExpr(ctx->bison, qr->condJump.cond->binOp.lExpr));
+            LIScanExpr(ctx, ATreeExpr(ctx->bison, qr->condJump.cond->binOp.rExpr));
+        } else {
+            LIScanExpr(ctx, qr->condJump.cond);
+        }
+        break;
+    case QROC_TABLE_JUMP:
+        LIScanOperand(ctx, qr->tableJump.idx, 0, SIZE_MAX);
+        break;
+    case QROC_RETURN_VALUE:
+        LIScanOperand(ctx, qr->returnObj.expr, 0, SIZE_MAX);
+        break;
+    case QROC_FUN_PARAM:
+        LIScanOperand(ctx, qr->funParam.expr, 0, SIZE_MAX);
+        break;
+    case QROC_FUN_CALL:
+        LIScanOperand(ctx, qr->funCall.result, 0, i);
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * 功能：分配工作数组，登记临时变量，记录每条四元式执行前所在的作用域。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LIInit(LIContext *ctx)
+{
+    SSAFunction *ssa = ctx->ssa;
+    FlowGraph *graph = ctx->graph;
+    const QuadRuple *qr;
+    Domain *domain = NULL;
+    size_t num = graph->end - graph->start, i;
+    uint32_t l;
+
+    ctx->defNum = LIAlloc(ctx, ssa->varNum * sizeof (*ctx->defNum));
+    ctx->defIdx = LIAlloc(ctx, ssa->varNum * sizeof (*ctx->defIdx));
+    ctx->fixedDomain = LIAlloc(ctx, ssa->varNum);
+    ctx->newDomain = LIAlloc(ctx, ssa->varNum * sizeof (*ctx->newDomain));
+    ctx->domainArr = LIAlloc(ctx, num * sizeof (*ctx->domainArr));
+    ctx->hoistArr = LIAlloc(ctx, num * sizeof (*ctx->hoistArr));
+    ctx->loopAt = LIAlloc(ctx, num * sizeof (*ctx->loopAt));
+    ctx->inLoop = LIAlloc(ctx, graph->blockNum);
+    ctx->storeArr = LIAlloc(ctx, num * sizeof (*ctx->storeArr));
+    if (!ctx->defNum || !ctx->defIdx || !ctx->fixedDomain || !ctx->newDomain || !ctx->domainArr
+            || !ctx->hoistArr || !ctx->loopAt || !ctx->inLoop || !ctx->storeArr)
+        return -ENOMEM;
+    for (i = graph->start; i < graph->end; i++) {
+        ctx->domainArr[i - graph->start] = domain;
+        ctx->hoistArr[i - graph->start] = FG_NONE;
+        ctx->loopAt[i - graph->start] = FG_NONE;
+        qr = &ctx->record->qrArr[i];
+        /*块语句在块的作用域结束之后构造，记录的是块外的作用域，块中的局部名字因此不可见*/
+        if (qr->op == QROC_BLK_START)
+            domain = qr->blkStart.domain;
+        else if (qr->op == QROC_BLK_END)
+            domain = qr->blkEnd.domain;
+        if (ctx->keepArr[i])
+            LIScanInstr(ctx, i);
+    }
+    for (l = 0; l < graph->loopNum; l++)
+        ctx->loopAt[graph->blockArr[graph->loopArr[l].header].start - graph->start] = l;
+    return 0;
+}
+
+/*
+ * 功能：判断下标idx处的四元式是否在循环l中。
+ * 返回值：
+ **/
+static int LIInLoop(LIContext *ctx, size_t idx, uint32_t l)
+{
+    FlowGraph *graph = ctx->graph;
+    uint32_t b = FGBlockOf(graph, idx), m;
+
+    for (m = graph->blockArr[b].loop; m != FG_NONE; m = graph->loopArr[m].parent) {
+        if (m == l)
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * 功能：计算下标src处的跳转改写后的目标。跳转到外提的四元式改成跳转到它之后留下的四元式，
+ *      从循环之外跳转到循环头改成跳转到前置块中的第一条四元式。
+ * firstArr：按循环索引，前置块中第一条四元式原来的下标，前置块为空时为SIZE_MAX
+ * 返回值：改写后的目标，仍然是四元式原来的下标。
+ **/
+static size_t LITarget(LIContext *ctx, size_t src, size_t label, const size_t *firstArr)
+{
+    FlowGraph *graph = ctx->graph;
+    uint32_t l;
+
+    if (label < graph->start || label >= graph->end)
+        return label;
+    while (*LIHoist(ctx, label) != FG_NONE)
+        label++;
+    l = ctx->loopAt[label - graph->start];
+    if (l != FG_NONE && firstArr[l] != SIZE_MAX && !LIInLoop(ctx, src, l))
+        return firstArr[l];
+    return label;
+}
+
+static void LIRetargetInstr(LIContext *ctx, size_t i, const size_t *firstArr)
+{
+    QuadRuple *qr = &ctx->record->qrArr[i];
+    size_t k;
+
+    switch (qr->op) {
+    case QROC_JUMP:
+        qr->uncondJump.dstLabel = LITarget(ctx, i, qr->uncondJump.dstLabel, firstArr);
+        break;
+    case QROC_TRUE_JUMP:
+    case QROC_FALSE_JUMP:
+        qr->condJump.dstLabel = LITarget(ctx, i, qr->condJump.dstLabel, firstArr);
+        break;
+    case QROC_TABLE_JUMP:
+        for (k = 0; k < qr->tableJump.labelNum; k++)
+            qr->tableJump.labelArr[k] = LITarget(ctx, i, qr->tableJump.labelArr[k], firstArr);
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * 功能：把改变了作用域的临时变量的引用改到新的作用域，引用可能被其它四元式共享，改写时复制。
+ * 返回值：
+ **/
+static void LIRedomainOperand(LIContext *ctx, QROperand **pOperand)
+{
+    QROperand *operand = *pOperand;
+    QRAccessMbr *accessMbr;
+    QRAccessMbrOffset *offset;
+    Domain *domain;
+    uint32_t var;
+
+    if (!operand)
+        return;
+    if (operand->type == QROT_TEMP) {
+        var = SSAVarOfTemp(ctx->ssa, operand->temp);
+        if (var != SSA_NONE && ctx->newDomain[var])
+            *pOperand = QRNewTempOperand(ctx->bison, ctx->newDomain[var], operand->temp);
+        return;
+    }
+    if (operand->type == QROT_ACCESS_MBR)
+        accessMbr = &operand->accessMbr;
+    else if (operand->type == QROT_GET_ADDR && operand->getAddr.type == QRGAT_ACCESS_MEM)
+        accessMbr = &operand->getAddr.accessMbr;
+    else
+        return;
+    offset = accessMbr->offset;
+    if (!offset || offset->offsetType != QRAMOT_TEMP)
+        return;
+    var = SSAVarOfTemp(ctx->ssa, offset->tempOffset.temp);
+    if (var == SSA_NONE || !ctx->newDomain[var])
+        return;
+    domain = ctx->newDomain[var];
+    operand = QRCopyOperand(ctx->bison, operand);
+    if (operand->type == QROT_ACCESS_MBR)
+        operand->accessMbr.offset = QRNewAccessMemOffsetTemp(ctx->bison, domain, offset->tempOffset.temp);
+    else
+        operand->getAddr.accessMbr.offset = QRNewAccessMemOffsetTemp(ctx->bison, domain, offset->tempOffset.temp);
+    *pOperand = operand;
+}
+
+static void LIRedomainInstr(LIContext *ctx, size_t i)
+{
+    QuadRuple *qr = &ctx->record->qrArr[i];
+
+    switch (qr->op) {
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+    case QROC_DIV:
+    case QROC_MOD:
+        LIRedomainOperand(ctx, &qr->binOp.arg1);
+        LIRedomainOperand(ctx, &qr->binOp.arg2);
+        LIRedomainOperand(ctx, &qr->binOp.result);
+        break;
+    case QROC_ASSIGN:
+        LIRedomainOperand(ctx, &qr->unaryOp.arg1);
+        LIRedomainOperand(ctx, &qr->unaryOp.result);
+        break;
+    case QROC_TABLE_JUMP:
+        LIRedomainOperand(ctx, &qr->tableJump.idx);
+        break;
+    case QROC_RETURN_VALUE:
+        LIRedomainOperand(ctx, &qr->returnObj.expr);
+        break;
+    case QROC_FUN_PARAM:
+        LIRedomainOperand(ctx, &qr->funParam.expr);
+        break;
+    case QROC_FUN_CALL:
+        LIRedomainOperand(ctx, &qr->funCall.result);
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * 功能：把外提的四元式移到前置块：改写跳转目标和临时变量的作用域，然后重排函数中的四元式，
+ *      前置块中的四元式保持原来的相对顺序。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int LIApply(LIContext *ctx)
+{
+    FlowGraph *graph = ctx->graph;
+    const QuadRuple *qr;
+    const QROperand *result;
+    Domain *domain;
+    size_t *firstArr, *orderArr;
+    size_t num = graph->end - graph->start, i, j, k = 0, h;
+    uint32_t l, var;
+
+    firstArr = LIAlloc(ctx, graph->loopNum * sizeof (*firstArr));
+    orderArr = LIAlloc(ctx, num * sizeof (*orderArr));
+    if (!firstArr || !orderArr)
+        return -ENOMEM;
+    for (l = 0; l < graph->loopNum; l++)
+        firstArr[l] = SIZE_MAX;
+    for (i = graph->start; i < graph->end; i++) {
+        l = *LIHoist(ctx, i);
+        if (l == FG_NONE)
+            continue;
+        if (firstArr[l] == SIZE_MAX)
+            firstArr[l] = i;
+        h = graph->blockArr[graph->loopArr[l].header].start;
+        domain = ctx->domainArr[h - graph->start];
+        qr = &ctx->record->qrArr[i];
+        result = qr->op == QROC_ASSIGN ? qr->unaryOp.result : qr->binOp.result;
+        var = SSAVarOfTemp(ctx->ssa, result->temp);
+        if (!LIVisible(result->domain, domain))
+            ctx->newDomain[var] = domain;
+    }
+    for (i = graph->start; i < graph->end; i++) {
+        LIRetargetInstr(ctx, i, firstArr);
+        LIRedomainInstr(ctx, i);
+    }
+
+    for (i = graph->start; i < graph->end; i++) {
+        l = ctx->loopAt[i - graph->start];
+        if (l != FG_NONE && firstArr[l] != SIZE_MAX) {
+            for (j = firstArr[l]; j < graph->end; j++) {
+                if (*LIHoist(ctx, j) == l)
+                    orderArr[k++] = j;
+            }
+        }
+        if (*LIHoist(ctx, i) == FG_NONE)
+            orderArr[k++] = i;
+    }
+    return QRRecordPermute(ctx->record, graph->start, graph->end, orderArr);
+}
+
+/*
+ * 功能：对一个函数做循环不变量外提，ssa是函数当前的SSA形式。
+ *      外提后四元式记录和SSA形式不再一致，调用者要丢弃SSA形式和流图。
+ * keepArr：按四元式下标索引，只外提保留的四元式，外提不删除四元式
+ * 返回值：成功时返回0，否则返回错误码，失败时四元式没有被修改。
+ **/
+int LIFunction(Bison *bison, SSAFunction *ssa, uint8_t *keepArr)
+{
+    LIContext ctx;
+    FlowGraph *graph;
+    uint32_t l;
+    int hoisted = 0;
+    size_t i;
+    int error = 0;
+
+    if (!bison || !bison->record || !ssa || !keepArr)
+        return -EINVAL;
+    graph = ssa->graph;
+    if (!graph->loopNum)
+        return 0;
+    memset(&ctx, 0, sizeof (ctx));
+    ctx.bison = bison;
+    ctx.record = bison->record;
+    ctx.ssa = ssa;
+    ctx.graph = graph;
+    ctx.keepArr = keepArr;
+    ctx.arena = CplArenaCreate(0);
+    if (!ctx.arena)
+        return -ENOMEM;
+    error = LIInit(&ctx);
+    if (error != -ENOERR)
+        goto out;
+    /*内层循环在外层循环之后，外提到内层循环前置块的四元式还可以继续外提*/
+    for (l = graph->loopNum; l-- > 0;)
+        LIHoistLoop(&ctx, l);
+    for (i = graph->start; i < graph->end; i++)
+        hoisted |= *LIHoist(&ctx, i) != FG_NONE;
+    if (hoisted)
+        error = LIApply(&ctx);
+
+out:
+    CplArenaDestroy(ctx.arena);
+    return error;
+}
@@ -0,0 +1,34 @@
+#ifndef __LOOP_INVARIANT_H__
+#define __LOOP_INVARIANT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "quadruple.h"
+#include "ssa.h"
+
+/*
+ * 循环不变量外提。
+ *
+ * 对流图中的自然循环从内到外处理，把循环中操作数都不随迭代变化的运算和赋值移到循环的前置块：
+ * 在循环头之前插入外提的四元式，循环外跳转到循环头的标号改成跳转到前置块，回边仍然跳转到循环头。
+ * 外提的四元式会在循环一次都不执行时多执行一次，所以只外提没有副作用、不会出错的四元式：
+ * 结果是只定义一次的临时变量，除法和求余的除数是非零常量，读取内存只读取
+ * 直接访问的变量、数组和结构体中的常量偏移位置。
+ *
+ * 循环中有间接写内存（*p = e、通过指针访问成员）或者函数调用时，循环中读取的内存都不是不变量；
+ * 否则只有被循环直接写入的变量、数组和结构体的读取不是不变量。
+ *
+ * 临时变量在栈帧中的位置由所在的作用域决定，外提到循环的块作用域之外的临时变量
+ * 改到前置块所在的作用域。四元式在函数内部重排，不删除四元式。
+ **/
+
+int LIFunction(Bison *bison, SSAFunction *ssa, uint8_t *keepArr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__LOOP_INVARIANT_H__*/
@@ -0,0 +1,121 @@
+#include "optimizer.h"
+#include "bison.h"
+#include "flow_graph.h"
+#include "ssa.h"
+#include "const_prop.h"
+#include "value_number.h"
+#include "loop_invariant.h"
+#include "dead_code.h"
+#include "cpl_common.h"
+#include "cpl_mm.h"
+#include "cpl_errno.h"
+#include "stdlib.h"
+#include "string.h"
+
+/*函数上的一个优化，删除的四元式在keepArr中置为0*/
+typedef int (*OptPass)(Bison *bison, SSAFunction *ssa, uint8_t *keepArr);
+
+typedef struct {
+    OptPass pass;
+    int deadCode;   /*之后是否删除无用定义，重排四元式的优化之后SSA形式不再可用*/
+} OptPassEntry;
+
+/*依次运行的优化，每个优化之后压缩四元式记录，下一个优化重新构造流图和SSA形式*/
+static const OptPassEntry optPassArr[] = {
+    {CPFunction, 1},
+    {VNFunction, 1},
+    {LIFunction, 0},
+};
+
+/*
+ * 功能：对从start开始的函数运行一个优化，需要时删除无用定义。
+ * 返回值：
+ **/
+static void OptFunction(Bison *bison, size_t start, const OptPassEntry *entry, uint8_t *keepArr)
+{
+    FlowGraph *graph;
+    SSAFunction *ssa;
+
+    if (FGBuild(bison->record, start, &graph) != -ENOERR)
+        return;
+    if (SSABuild(bison, graph, &ssa) == -ENOERR) {
+        if (entry->pass(bison, ssa, keepArr) == -ENOERR && entry->deadCode)
+            DCFunction(bison, ssa, keepArr);
+        SSAFree(ssa);
+    }
+    FGFree(graph);
+}
+
+/*
+ * 功能：对所有函数运行一个优化并压缩四元式记录。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int OptRunPass(Bison *bison, const OptPassEntry *entry, uint8_t *keepArr)
+{
+    QRRecord *record = bison->record;
+    size_t i;
+
+    memset(keepArr, 1, record->idx);
+    for (i = 0; i < record->idx; i++) {
+        if (record->qrArr[i].op == QROC_FUN_START)
+            OptFunction(bison, i, entry, keepArr);
+    }
+    return QRRecordCompact(record, keepArr);
+}
+
+/*
+ * 功能：删除跳转到下一条四元式的跳转。删除一条跳转可能让前面的跳转也变成跳转到下一条，
+ *      重复到没有可以删除的跳转为止。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int OptRemoveNextJumps(QRRecord *record, uint8_t *keepArr)
+{
+    const QuadRuple *qr;
+    size_t i, dstLabel;
+    int changed, error = 0;
+
+    do {
+        changed = 0;
+        for (i = 0; i < record->idx; i++) {
+            qr = &record->qrArr[i];
+            if (qr->op == QROC_JUMP)
+                dstLabel = qr->uncondJump.dstLabel;
+            else if (qr->op == QROC_TRUE_JUMP || qr->op == QROC_FALSE_JUMP)
+                dstLabel = qr->condJump.dstLabel;
+            else
+                dstLabel = 0;
+            keepArr[i] = dstLabel != i + 1;
+            changed |= !keepArr[i];
+        }
+        if (changed)
+            error = QRRecordCompact(record, keepArr);
+    } while (changed && error == -ENOERR);
+    return error;
+}
+
+/*
+ * 功能：优化四元式记录。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int OptRecord(Bison *bison)
+{
+    QRRecord *record;
+    uint8_t *keepArr;
+    size_t k;
+    int error = 0;
+
+    if (!bison || !bison->record)
+        return -EINVAL;
+    record = bison->record;
+    if (!record->idx)
+        return 0;
+    keepArr = CplAlloc(record->idx);
+    if (!keepArr)
+        return -ENOMEM;
+    for (k = 0; k < ARRAY_SIZE(optPassArr) && error == -ENOERR; k++)
+        error = OptRunPass(bison, &optPassArr[k], keepArr);
+    if (error == -ENOERR)
+        error = OptRemoveNextJumps(record, keepArr);
+    CplFree(keepArr);
+    return error;
+}
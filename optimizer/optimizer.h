@@ -0,0 +1,24 @@
+#ifndef __OPTIMIZER_H__
+#define __OPTIMIZER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "quadruple.h"
+
+/*
+ * 四元式的机器无关优化。语法制导翻译生成四元式之后、生成目标代码之前运行，
+ * 依次运行各个优化，每个优化对每个函数单独构造流图和SSA形式，之后删除无用定义并压缩四元式记录
+ * （循环不变量外提重排四元式，之后不删除），
+ * 最后删除跳转到下一条四元式的跳转。
+ * 某个函数构造流图或者SSA形式失败时跳过这个函数，四元式保持原样。
+ **/
+
+int OptRecord(Bison *bison);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__OPTIMIZER_H__*/
@@ -0,0 +1,793 @@
+#include "ssa.h"
+#include "bison.h"
+#include "cpl_errno.h"
+#include "cpl_debug.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
+
+/*变量查找表的表项，key是局部变量的声明条目或者临时变量*/
+typedef struct {
+    const void *key;
+    uint32_t var;
+} SSAHashEntry;
+
+/*构造SSA形式过程中的临时信息*/
+typedef struct {
+    Bison *bison;
+    SSAFunction *ssa;
+    uint32_t varSize;       /*varArr的容量*/
+    uint32_t *stackBase;    /*各变量的版本栈在verStack中的开始位置*/
+    uint32_t *stackTop;     /*各变量的版本栈中的版本个数*/
+    uint32_t *verStack;
+    uint32_t *logArr;       /*按压栈顺序记录的变量，退出基本块时按它弹栈*/
+    uint32_t logNum;
+} SSABuilder;
+
+static void *SSAAlloc(SSAFunction *ssa, size_t size)
+{
+    return CplArenaCalloc(ssa->arena, size ? size : 1);
+}
+
+static uint32_t SSAHashKey(const void *key, uint32_t size)
+{
+    uintptr_t k = (uintptr_t)key;
+
+    k ^= k >> 17;
+    k *= 0x9e3779b1u;
+    return (uint32_t)(k ^ (k >> 15)) & (size - 1);
+}
+
+static SSAHashEntry *SSAHashFind(const SSAFunction *ssa, const void *key)
+{
+    SSAHashEntry *hashArr = ssa->hashArr;
+    uint32_t h;
+
+    if (!ssa->hashSize)
+        return NULL;
+    for (h = SSAHashKey(key, ssa->hashSize); hashArr[h].key; h = (h + 1) & (ssa->hashSize - 1)) {
+        if (hashArr[h].key == key)
+            return &hashArr[h];
+    }
+    return &hashArr[h];
+}
+
+/*
+ * 功能：扩大变量查找表，旧表的内存留在区域分配器中。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int SSAHashGrow(SSAFunction *ssa)
+{
+    SSAHashEntry *oldArr = ssa->hashArr, *entry;
+    uint32_t oldSize = ssa->hashSize, i;
+
+    ssa->hashSize = oldSize ? oldSize * 2 : 64;
+    ssa->hashArr = SSAAlloc(ssa, ssa->hashSize * sizeof (SSAHashEntry));
+    if (!ssa->hashArr)
+        return -ENOMEM;
+    for (i = 0; i < oldSize; i++) {
+        if (oldArr[i].key) {
+            entry = SSAHashFind(ssa, oldArr[i].key);
+            *entry = oldArr[i];
+        }
+    }
+    return 0;
+}
+
+/*
+ * 功能：获取局部变量的声明条目，全局变量返回NULL。
+ * 返回值：
+ **/
+static DomainEntry *SSALocalEntry(Domain *domain, const Token *token)
+{
+    DomainEntry *entry;
+
+    entry = EnvDomainGetEntry(domain, token);
+    if (!entry || (entry->domain->type != DT_FUN && entry->domain->type != DT_BLK))
+        return NULL;
+    return entry;
+}
+
+static int SSATypePromotable(const Type *type)
+{
+    return type->type == TT_BASE || type->type == TT_POINTER;
+}
+
+/*
+ * 功能：登记四元式中出现的变量。whole为0表示变量出现在成员访问或者取地址中，
+ *      这样的变量不能提升。
+ * pVar：输出型参数，变量编号
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int SSAAddVar(SSABuilder *builder, SSAVarKind kind, void *key, int whole, uint32_t *pVar)
+{
+    SSAFunction *ssa = builder->ssa;
+    SSAHashEntry *entry;
+    SSAVar *var, *varArr;
+    int error = 0;
+
+    if (ssa->varNum * 2 >= ssa->hashSize) {
+        error = SSAHashGrow(ssa);
+        if (error != -ENOERR)
+            return error;
+    }
+    entry = SSAHashFind(ssa, key);
+    if (entry->key) {
+        var = &ssa->varArr[entry->var];
+        if (!whole)
+            var->promoted = 0;
+        *pVar = entry->var;
+        return 0;
+    }
+
+    if (ssa->varNum == builder->varSize) {
+        builder->varSize = builder->varSize ? builder->varSize * 2 : 32;
+        varArr = SSAAlloc(ssa, builder->varSize * sizeof (*varArr));
+        if (!varArr)
+            return -ENOMEM;
+        if (ssa->varNum)
+            memcpy(varArr, ssa->varArr, ssa->varNum * sizeof (*varArr));
+        ssa->varArr = varArr;
+    }
+    var = &ssa->varArr[ssa->varNum];
+    var->kind = kind;
+    if (kind == SSAVK_ID) {
+        var->entry = key;
+        var->type = var->entry->type;
+        var->param = var->entry->funArgFlag;
+    } else {
+        var->temp = key;
+        var->type = var->temp->type;
+    }
+    var->promoted = whole && SSATypePromotable(var->type);
+    entry->key = key;
+    entry->var = ssa->varNum;
+    *pVar = ssa->varNum++;
+    return 0;
+}
+
+/*
+ * 功能：登记成员访问中出现的基址变量和偏移量变量。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int SSAScanAccessMbr(SSABuilder *builder, Domain *domain, const QRAccessMbr *accessMbr)
+{
+    const QRAccessMbrOffset *offset = accessMbr->offset;
+    DomainEntry *entry;
+    uint32_t var;
+    int error = 0;
+
+    if (accessMbr->baseType == QRAMBT_ID) {
+        entry = SSALocalEntry(domain, accessMbr->baseId.token);
+        if (entry)
+            error = SSAAddVar(builder, SSAVK_ID, entry, 0, &var);
+    } else {
+        error = SSAAddVar(builder, SSAVK_TEMP, accessMbr->baseTemp, 0, &var);
+    }
+    if (error != -ENOERR || !offset)
+        return error;
+    if (offset->offsetType == QRAMOT_ID) {
+        entry = SSALocalEntry(offset->idOffset.domain, offset->idOffset.id.token);
+        if (entry)
+            error = SSAAddVar(builder, SSAVK_ID, entry, 0, &var);
+    } else if (offset->offsetType == QRAMOT_TEMP) {
+        error = SSAAddVar(builder, SSAVK_TEMP, offset->tempOffset.temp, 0, &var);
+    }
+    return error;
+}
+
+/*
+ * 功能：登记操作数中出现的变量。
+ * pVar：输出型参数，操作数是完整的局部变量或者临时变量时为变量编号，否则为SSA_NONE
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int SSAScanOperand(SSABuilder *builder, QROperand *operand, uint32_t *pVar)
+{
+    DomainEntry *entry;
+    uint32_t var;
+
+    *pVar = SSA_NONE;
+    if (!operand)
+        return 0;
+    switch (operand->type) {
+    case QROT_ID:
+        entry = SSALocalEntry(operand->domain, operand->id.token);
+        if (!entry)
+            return 0;
+        return SSAAddVar(builder, SSAVK_ID, entry, 1, pVar);
+    case QROT_TEMP:
+        return SSAAddVar(builder, SSAVK_TEMP, operand->temp, 1, pVar);
+    case QROT_ACCESS_MBR:
+        return SSAScanAccessMbr(builder, operand->domain, &operand->accessMbr);
+    case QROT_GET_ADDR:
+        if (operand->getAddr.type == QRGAT_ACCESS_MEM)
+            return SSAScanAccessMbr(builder, operand->domain, &operand->getAddr.accessMbr);
+        entry = SSALocalEntry(operand->domain, operand->getAddr.id.token);
+        if (!entry)
+            return 0;
+        return SSAAddVar(builder, SSAVK_ID, entry, 0, &var);
+    default:
+        return 0;
+    }
+}
+
+/*
+ * 功能：登记条件表达式的操作数中出现的变量，变量和常量之外的表达式转换成操作数处理。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int SSAScanExpr(SSABuilder *builder, Expr *expr, uint32_t *pVar)
+{
+    DomainEntry *entry;
+
+    *pVar = SSA_NONE;
+    switch (expr->type) {
+    case ET_ID:
+        entry = SSALocalEntry(expr->domain, expr->id.token);
+        if (!entry)
+            return 0;
+        return SSAAddVar(builder, SSAVK_ID, entry, 1, pVar);
+    case ET_TEMP:
+        return SSAAddVar(builder, SSAVK_TEMP, &expr->temp, 1, pVar);
+    case ET_CONST:
+    case ET_CONST_SPC:
+        return 0;
+    default:
+        return SSAScanOperand(builder, QROperandFromExpr(builder->bison, expr), pVar);
+    }
+}
+
+static int SSAIsRelExpr(const Expr *expr)
+{
+    switch (expr->type) {
+    case ET_EQ:
+    case ET_NE:
+    case ET_GT:
+    case ET_GE:
+    case ET_LT:
+    case ET_LE:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * 功能：获取四元式使用的操作数个数。二目运算使用arg1、arg2，条件跳转使用比较的左右两边
+ *      或者条件本身，赋值、跳转表、返回值和实际参数使用唯一的操作数。
+ * 返回值：
+ **/
+uint32_t SSAUseNum(const QuadRuple *qr)
+{
+    switch (qr->op) {
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+    case QROC_DIV:
+    case QROC_MOD:
+        return 2;
+    case QROC_TRUE_JUMP:
+    case QROC_FALSE_JUMP:
+        return SSAIsRelExpr(qr->condJump.cond) ? 2 : 1;
+    case QROC_ASSIGN:
+    case QROC_TABLE_JUMP:
+    case QROC_RETURN_VALUE:
+    case QROC_FUN_PARAM:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static QROperand *SSADefOperand(const QuadRuple *qr)
+{
+    switch (qr->op) {
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+    case QROC_DIV:
+    case QROC_MOD:
+        return qr->binOp.result;
+    case QROC_ASSIGN:
+        return qr->unaryOp.result;
+    case QROC_FUN_CALL:
+        return qr->funCall.result;
+    default:
+        return NULL;
+    }
+}
+
+/*
+ * 功能：登记四元式中的变量，记录定义和使用的变量编号。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int SSAScanInstr(SSABuilder *builder, const QuadRuple *qr, SSAInstr *ins)
+{
+    Expr *cond;
+    int error = 0;
+
+    ins->useArr[0].var = SSA_NONE;
+    ins->useArr[1].var = SSA_NONE;
+    switch (qr->op) {
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+    case QROC_DIV:
+    case QROC_MOD:
+        error = SSAScanOperand(builder, qr->binOp.arg1, &ins->useArr[0].var);
+        if (error == -ENOERR)
+            error = SSAScanOperand(builder, qr->binOp.arg2, &ins->useArr[1].var);
+        break;
+    case QROC_ASSIGN:
+        error = SSAScanOperand(builder, qr->unaryOp.arg1, &ins->useArr[0].var);
+        break;
+    case QROC_TRUE_JUMP:
+    case QROC_FALSE_JUMP:
+        cond = qr->condJump.cond;
+        if (SSAIsRelExpr(cond)) {
+            error = SSAScanExpr(builder, ATreeExpr(builder->bison, cond->binOp.lExpr), &ins->useArr[0].var);
+            if (error == -ENOERR)
+                error = SSAScanExpr(builder, ATreeExpr(builder->bison, cond->binOp.rExpr), &ins->useArr[1].var);
+        } else {
+            error = SSAScanExpr(builder, cond, &ins->useArr[0].var);
+        }
+        break;
+    case QROC_TABLE_JUMP:
+        error = SSAScanOperand(builder, qr->tableJump.idx, &ins->useArr[0].var);
+        break;
+    case QROC_RETURN_VALUE:
+        error = SSAScanOperand(builder, qr->returnObj.expr, &ins->useArr[0].var);
+        break;
+    case QROC_FUN_PARAM:
+        error = SSAScanOperand(builder, qr->funParam.expr, &ins->useArr[0].var);
+        break;
+    default:
+        break;
+    }
+    if (error != -ENOERR)
+        return error;
+    return SSAScanOperand(builder, SSADefOperand(qr), &ins->def.var);
+}
+
+/*
+ * 功能：登记函数中的所有变量，确定提升的变量，并把没有提升的变量从四元式的旁表中去掉。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int SSAScanVars(SSABuilder *builder)
+{
+    SSAFunction *ssa = builder->ssa;
+    FlowGraph *graph = ssa->graph;
+    SSAInstr *ins;
+    size_t i;
+    uint32_t k;
+    int error = 0;
+
+    for (i = graph->start; i < graph->end; i++) {
+        error = SSAScanInstr(builder, &graph->record->qrArr[i], SSAInstrOf(ssa, i));
+        if (error != -ENOERR)
+            return error;
+    }
+    for (i = graph->start; i < graph->end; i++) {
+        ins = SSAInstrOf(ssa, i);
+        if (ins->def.var != SSA_NONE && !ssa->varArr[ins->def.var].promoted)
+            ins->def.var = SSA_NONE;
+        ins->def.ver = SSA_NONE;
+        for (k = 0; k < SSA_USE_MAX; k++) {
+            if (ins->useArr[k].var != SSA_NONE && !ssa->varArr[ins->useArr[k].var].promoted)
+                ins->useArr[k].var = SSA_NONE;
+            ins->useArr[k].ver = SSA_NONE;
+        }
+    }
+    return 0;
+}
+
+/*
+ * 功能：在支配边界上插入phi函数。只为在某个基本块中先使用后定义的变量插入phi函数
+ *      （semi-pruned SSA），只在一个基本块中使用的变量不需要phi函数。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int SSAInsertPhis(SSABuilder *builder)
+{
+    SSAFunction *ssa = builder->ssa;
+    FlowGraph *graph = ssa->graph;
+    FGBlock *block;
+    SSAInstr *ins;
+    SSAPhi *phi;
+    uint32_t *defStart, *defBlockArr, *lastDef, *hasPhi, *inWork, *work;
+    uint8_t *global;
+    uint32_t b, v, k, d, top, y;
+    size_t i;
+
+    defStart = SSAAlloc(ssa, (ssa->varNum + 1) * sizeof (*defStart));
+    lastDef = SSAAlloc(ssa, ssa->varNum * sizeof (*lastDef));
+    global = SSAAlloc(ssa, ssa->varNum);
+    hasPhi = SSAAlloc(ssa, graph->blockNum * sizeof (*hasPhi));
+    inWork = SSAAlloc(ssa, graph->blockNum * sizeof (*inWork));
+    work = SSAAlloc(ssa, graph->blockNum * sizeof (*work));
+    if (!defStart || !lastDef || !global || !hasPhi || !inWork || !work)
+        return -ENOMEM;
+
+    /*统计每个变量的定义块，同一个基本块只记一次，并找出跨基本块使用的变量*/
+    memset(lastDef, 0xff, ssa->varNum * sizeof (*lastDef));
+    for (b = 0; b < graph->blockNum; b++) {
+        block = &graph->blockArr[b];
+        if (block->rpoIdx == FG_NONE)
+            continue;
+        for (i = block->start; i < block->end; i++) {
+            ins = SSAInstrOf(ssa, i);
+            for (k = 0; k < SSA_USE_MAX; k++) {
+                v = ins->useArr[k].var;
+                if (v != SSA_NONE && lastDef[v] != b)
+                    global[v] = 1;
+            }
+            v = ins->def.var;
+            if (v != SSA_NONE && lastDef[v] != b) {
+                lastDef[v] = b;
+                defStart[v + 1]++;
+            }
+        }
+    }
+    for (v = 0; v < ssa->varNum; v++)
+        defStart[v + 1] += defStart[v];
+    defBlockArr = SSAAlloc(ssa, defStart[ssa->varNum] * sizeof (*defBlockArr));
+    if (!defBlockArr)
+        return -ENOMEM;
+    memset(lastDef, 0xff, ssa->varNum * sizeof (*lastDef));
+    for (b = 0; b < graph->blockNum; b++) {
+        block = &graph->blockArr[b];
+        if (block->rpoIdx == FG_NONE)
+            continue;
+        for (i = block->start; i < block->end; i++) {
+            v = SSAInstrOf(ssa, i)->def.var;
+            if (v != SSA_NONE && lastDef[v] != b) {
+                lastDef[v] = b;
+                defBlockArr[defStart[v]++] = b;
+            }
+        }
+    }
+    for (v = ssa->varNum; v > 0; v--)
+        defStart[v] = defStart[v - 1];
+    defStart[0] = 0;
+
+    /*对每个变量从定义块出发，沿着迭代的支配边界插入phi函数*/
+    memset(hasPhi, 0xff, graph->blockNum * sizeof (*hasPhi));
+    memset(inWork, 0xff, graph->blockNum * sizeof (*inWork));
+    for (v = 0; v < ssa->varNum; v++) {
+        if (!global[v])
+            continue;
+        top = 0;
+        for (d = defStart[v]; d < defStart[v + 1]; d++) {
+            inWork[defBlockArr[d]] = v;
+            work[top++] = defBlockArr[d];
+        }
+        while (top > 0) {
+            block = &graph->blockArr[work[--top]];
+            for (k = 0; k < block->dfNum; k++) {
+                y = block->dfArr[k];
+                if (hasPhi[y] == v)
+                    continue;
+                hasPhi[y] = v;
+                phi = SSAAlloc(ssa, sizeof (*phi));
+                if (!phi)
+                    return -ENOMEM;
+                phi->argArr = SSAAlloc(ssa, graph->blockArr[y].predNum * sizeof (*phi->argArr));
+                if (!phi->argArr)
+                    return -ENOMEM;
+                memset(phi->argArr, 0xff, graph->blockArr[y].predNum * sizeof (*phi->argArr));
+                phi->block = y;
+                phi->def.var = v;
+                phi->def.ver = SSA_NONE;
+                phi->next = ssa->phiArr[y];
+                ssa->phiArr[y] = phi;
+                if (inWork[y] != v) {
+                    inWork[y] = v;
+                    work[top++] = y;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * 功能：统计每个变量的版本数，分配定义位置、使用链表和重命名用的版本栈。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int SSAAllocVersions(SSABuilder *builder)
+{
+    SSAFunction *ssa = builder->ssa;
+    FlowGraph *graph = ssa->graph;
+    FGBlock *block;
+    SSAPhi *phi;
+    SSAVar *var;
+    uint32_t b, v, total = 0, logSize = 0;
+    size_t i;
+
+    for (v = 0; v < ssa->varNum; v++)
+        ssa->varArr[v].versionNum = ssa->varArr[v].promoted ? 1 : 0;
+    for (b = 0; b < graph->blockNum; b++) {
+        block = &graph->blockArr[b];
+        if (block->rpoIdx == FG_NONE)
+            continue;
+        for (phi = ssa->phiArr[b]; phi; phi = phi->next)
+            ssa->varArr[phi->def.var].versionNum++;
+        for (i = block->start; i < block->end; i++) {
+            v = SSAInstrOf(ssa, i)->def.var;
+            if (v != SSA_NONE)
+                ssa->varArr[v].versionNum++;
+        }
+    }
+
+    builder->stackBase = SSAAlloc(ssa, ssa->varNum * sizeof (*builder->stackBase));
+    builder->stackTop = SSAAlloc(ssa, ssa->varNum * sizeof (*builder->stackTop));
+    if (!builder->stackBase || !builder->stackTop)
+        return -ENOMEM;
+    for (v = 0; v < ssa->varNum; v++) {
+        var = &ssa->varArr[v];
+        if (!var->promoted)
+            continue;
+        var->defArr = SSAAlloc(ssa, var->versionNum * sizeof (*var->defArr));
+        var->useArr = SSAAlloc(ssa, var->versionNum * sizeof (*var->useArr));
+        if (!var->defArr || !var->useArr)
+            return -ENOMEM;
+        var->defArr[0].block = 0;
+        var->defArr[0].idx = graph->start;
+        builder->stackBase[v] = total;
+        builder->stackTop[v] = 1;
+        total += var->versionNum;
+        logSize += var->versionNum - 1;
+        var->versionNum = 1;
+    }
+    builder->verStack = SSAAlloc(ssa, total * sizeof (*builder->verStack));
+    builder->logArr = SSAAlloc(ssa, logSize * sizeof (*builder->logArr));
+    if (!builder->verStack || !builder->logArr)
+        return -ENOMEM;
+    for (v = 0; v < ssa->varNum; v++) {
+        if (ssa->varArr[v].promoted)
+            builder->verStack[builder->stackBase[v]] = 0;
+    }
+    return 0;
+}
+
+static uint32_t SSATopVersion(SSABuilder *builder, uint32_t v)
+{
+    return builder->verStack[builder->stackBase[v] + builder->stackTop[v] - 1];
+}
+
+/*
+ * 功能：为变量v生成新版本并压栈。
+ * 返回值：新版本号
+ **/
+static uint32_t SSAPushVersion(SSABuilder *builder, uint32_t v, uint32_t block, size_t idx, SSAPhi *phi)
+{
+    SSAVar *var = &builder->ssa->varArr[v];
+    uint32_t ver = var->versionNum++;
+
+    var->defArr[ver].block = block;
+    var->defArr[ver].idx = idx;
+    var->defArr[ver].phi = phi;
+    builder->verStack[builder->stackBase[v] + builder->stackTop[v]++] = ver;
+    builder->logArr[builder->logNum++] = v;
+    return ver;
+}
+
+static int SSAAddUse(SSAFunction *ssa, SSAName name, size_t idx, SSAPhi *phi, uint32_t slot)
+{
+    SSAVar *var = &ssa->varArr[name.var];
+    SSAUse *use;
+
+    use = SSAAlloc(ssa, sizeof (*use));
+    if (!use)
+        return -ENOMEM;
+    use->idx = idx;
+    use->phi = phi;
+    use->slot = slot;
+    use->next = var->useArr[name.ver];
+    var->useArr[name.ver] = use;
+    return 0;
+}
+
+/*
+ * 功能：重命名基本块中的定义和使用，并填写后继基本块中phi函数对应的参数。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int SSARenameBlock(SSABuilder *builder, uint32_t b)
+{
+    SSAFunction *ssa = builder->ssa;
+    FlowGraph *graph = ssa->graph;
+    FGBlock *block = &graph->blockArr[b], *succ;
+    SSAInstr *ins;
+    SSAPhi *phi;
+    uint32_t k, j;
+    size_t i;
+    int error = 0;
+
+    for (phi = ssa->phiArr[b]; phi; phi = phi->next)
+        phi->def.ver = SSAPushVersion(builder, phi->def.var, b, graph->start, phi);
+    for (i = block->start; i < block->end; i++) {
+        ins = SSAInstrOf(ssa, i);
+        for (k = 0; k < SSA_USE_MAX; k++) {
+            if (ins->useArr[k].var == SSA_NONE)
+                continue;
+            ins->useArr[k].ver = SSATopVersion(builder, ins->useArr[k].var);
+            error = SSAAddUse(ssa, ins->useArr[k], i, NULL, k);
+            if (error != -ENOERR)
+                return error;
+        }
+        if (ins->def.var != SSA_NONE)
+            ins->def.ver = SSAPushVersion(builder, ins->def.var, b, i, NULL);
+    }
+    for (k = 0; k < block->succNum; k++) {
+        succ = &graph->blockArr[block->succArr[k]];
+        for (j = 0; succ->predArr[j] != b; j++)
+            ;
+        for (phi = ssa->phiArr[succ->id]; phi; phi = phi->next) {
+            phi->argArr[j] = SSATopVersion(builder, phi->def.var);
+            error = SSAAddUse(ssa, (SSAName){phi->def.var, phi->argArr[j]}, SIZE_MAX, phi, j);
+            if (error != -ENOERR)
+                return error;
+        }
+    }
+    return 0;
+}
+
+/*
+ * 功能：沿支配树深度优先重命名，用显式栈代替递归。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int SSARename(SSABuilder *builder)
+{
+    SSAFunction *ssa = builder->ssa;
+    FlowGraph *graph = ssa->graph;
+    FGBlock *block;
+    uint32_t *stack, *nextArr, *logMark;
+    uint32_t top, b, v;
+    int error = 0;
+
+    stack = SSAAlloc(ssa, graph->blockNum * sizeof (*stack));
+    nextArr = SSAAlloc(ssa, graph->blockNum * sizeof (*nextArr));
+    logMark = SSAAlloc(ssa, graph->blockNum * sizeof (*logMark));
+    if (!stack || !nextArr || !logMark)
+        return -ENOMEM;
+
+    top = 0;
+    stack[top++] = 0;
+    logMark[0] = builder->logNum;
+    error = SSARenameBlock(builder, 0);
+    if (error != -ENOERR)
+        return error;
+    while (top > 0) {
+        b = stack[top - 1];
+        block = &graph->blockArr[b];
+        if (nextArr[b] < block->domChildNum) {
+            b = block->domChildArr[nextArr[b]++];
+            stack[top++] = b;
+            logMark[b] = builder->logNum;
+            error = SSARenameBlock(builder, b);
+            if (error != -ENOERR)
+                return error;
+        } else {
+            top--;
+            while (builder->logNum > logMark[b]) {
+                v = builder->logArr[--builder->logNum];
+                builder->stackTop[v]--;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * 功能：为流图对应的函数构造SSA形式。构造过程中不修改四元式和流图。
+ * pSsa：输出型参数，SSA形式，由调用者用SSAFree释放，流图要在SSA形式之后释放
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+int SSABuild(Bison *bison, FlowGraph *graph, SSAFunction **pSsa)
+{
+    SSABuilder builder;
+    SSAFunction *ssa;
+    CplArena *arena;
+    int error = 0;
+
+    if (!graph || !pSsa)
+        return -EINVAL;
+    arena = CplArenaCreate(0);
+    if (!arena)
+        return -ENOMEM;
+    ssa = CplArenaCalloc(arena, sizeof (*ssa));
+    if (!ssa) {
+        error = -ENOMEM;
+        goto err;
+    }
+    ssa->arena = arena;
+    ssa->graph = graph;
+    ssa->insArr = SSAAlloc(ssa, (graph->end - graph->start) * sizeof (*ssa->insArr));
+    ssa->phiArr = SSAAlloc(ssa, graph->blockNum * sizeof (*ssa->phiArr));
+    if (!ssa->insArr || !ssa->phiArr) {
+        error = -ENOMEM;
+        goto err;
+    }
+
+    memset(&builder, 0, sizeof (builder));
+    builder.bison = bison;
+    builder.ssa = ssa;
+    error = SSAScanVars(&builder);
+    if (error != -ENOERR)
+        goto err;
+    error = SSAInsertPhis(&builder);
+    if (error != -ENOERR)
+        goto err;
+    error = SSAAllocVersions(&builder);
+    if (error != -ENOERR)
+        goto err;
+    error = SSARename(&builder);
+    if (error != -ENOERR)
+        goto err;
+    *pSsa = ssa;
+    return 0;
+
+err:
+    CplArenaDestroy(arena);
+    return error;
+}
+
+void SSAFree(SSAFunction *ssa)
+{
+    if (ssa)
+        CplArenaDestroy(ssa->arena);
+}
+
+/*
+ * 功能：获取四元式的SSA旁表，idx是四元式在记录中的下标。
+ * 返回值：
+ **/
+SSAInstr *SSAInstrOf(const SSAFunction *ssa, size_t idx)
+{
+    return &ssa->insArr[idx - ssa->graph->start];
+}
+
+static uint32_t SSAVarOfKey(const SSAFunction *ssa, const void *key)
+{
+    SSAHashEntry *entry;
+
+    if (!key)
+        return SSA_NONE;
+    entry = SSAHashFind(ssa, key);
+    return entry && entry->key ? entry->var : SSA_NONE;
+}
+
+/*
+ * 功能：查找局部变量，包括成员访问中的基址和偏移量变量。
+ * 返回值：变量编号，全局变量或者变量没有在函数中出现时返回SSA_NONE。
+ **/
+uint32_t SSAVarOfId(const SSAFunction *ssa, Domain *domain, const Token *token)
+{
+    return SSAVarOfKey(ssa, SSALocalEntry(domain, token));
+}
+
+uint32_t SSAVarOfTemp(const SSAFunction *ssa, const Temp *temp)
+{
+    return SSAVarOfKey(ssa, temp);
+}
+
+/*
+ * 功能：查找作为完整操作数出现的变量。
+ * 返回值：变量编号，操作数不是局部变量或者临时变量，或者变量没有在函数中出现时返回SSA_NONE。
+ **/
+uint32_t SSAVarOfOperand(const SSAFunction *ssa, const QROperand *operand)
+{
+    if (operand->type == QROT_ID)
+        return SSAVarOfId(ssa, operand->domain, operand->id.token);
+    if (operand->type == QROT_TEMP)
+        return SSAVarOfTemp(ssa, operand->temp);
+    return SSA_NONE;
+}
+
+uint32_t SSAVarOfExpr(const SSAFunction *ssa, const Expr *expr)
+{
+    if (expr->type == ET_ID)
+        return SSAVarOfId(ssa, expr->domain, expr->id.token);
+    if (expr->type == ET_TEMP)
+        return SSAVarOfTemp(ssa, &expr->temp);
+    return SSA_NONE;
+}
@@ -0,0 +1,110 @@
+#ifndef __SSA_H__
+#define __SSA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "quadruple.h"
+#include "environ.h"
+#include "flow_graph.h"
+#include "cpl_mm.h"
+
+/*
+ * 四元式的静态单赋值（SSA）形式。四元式仍然使用原来的变量名，SSA形式以旁表的方式记录：
+ * 每条四元式定义和使用的变量版本、基本块开头的phi函数、每个版本的定义位置和使用链表。
+ *
+ * 只有提升的变量才有版本，提升的变量是函数的局部变量、形式参数和临时变量中，
+ * 类型是基本类型或者指针，并且只作为完整的操作数出现的变量：没有被取地址，
+ * 没有作为数组、成员访问的基址或者偏移量，所以只能被四元式的结果直接修改。
+ * 全局变量和其它局部变量仍然是内存中的变量，不在SSA形式中。
+ *
+ * 变换SSA形式的优化只做在原来的变量名上也成立的修改（替换成常量、删除四元式等），
+ * 同一个变量的各个版本的生存期互不重叠，所以退出SSA形式时不需要插入复制，
+ * 丢弃旁表即可，各个版本合并回原来的变量，由后端把变量分配到寄存器或者栈上。
+ **/
+
+#define SSA_NONE        ((uint32_t)-1)
+#define SSA_USE_MAX     (2)     /*一条四元式最多使用的操作数个数*/
+
+typedef enum {
+    SSAVK_ID,       /*局部变量或者形式参数*/
+    SSAVK_TEMP,     /*临时变量*/
+} SSAVarKind;
+
+/*变量的一个版本，var为SSA_NONE时不是提升的变量*/
+typedef struct {
+    uint32_t var;
+    uint32_t ver;
+} SSAName;
+
+/*四元式的定义和使用，使用的位置见SSAUseNum*/
+typedef struct {
+    SSAName def;
+    SSAName useArr[SSA_USE_MAX];
+} SSAInstr;
+
+/*基本块开头的phi函数*/
+typedef struct _SSAPhi {
+    uint32_t block;
+    SSAName def;
+    uint32_t *argArr;       /*参数版本，和基本块的predArr一一对应，不可达的前驱为SSA_NONE*/
+    struct _SSAPhi *next;
+} SSAPhi;
+
+/*版本的定义位置，0号版本是变量在函数入口处的值*/
+typedef struct {
+    uint32_t block;         /*定义所在的基本块，0号版本为入口块*/
+    size_t idx;             /*定义的四元式下标，phi定义和0号版本为函数的start*/
+    SSAPhi *phi;            /*phi定义，否则为NULL*/
+} SSADef;
+
+/*版本的使用位置*/
+typedef struct _SSAUse {
+    size_t idx;             /*使用的四元式下标，phi参数为SIZE_MAX*/
+    SSAPhi *phi;            /*使用版本的phi函数，否则为NULL*/
+    uint32_t slot;          /*四元式中的使用位置，或者phi参数的下标*/
+    struct _SSAUse *next;
+} SSAUse;
+
+typedef struct {
+    SSAVarKind kind;
+    union {
+        DomainEntry *entry;
+        Temp *temp;
+    };
+    Type *type;
+    uint32_t promoted: 1;   /*是否提升到SSA形式*/
+    uint32_t param: 1;      /*是否是形式参数，0号版本是实际参数的值*/
+    uint32_t versionNum;
+    SSADef *defArr;         /*按版本号索引*/
+    SSAUse **useArr;        /*按版本号索引的使用链表*/
+} SSAVar;
+
+typedef struct _SSAFunction {
+    FlowGraph *graph;
+    SSAVar *varArr;         /*函数中出现的所有局部变量和临时变量*/
+    uint32_t varNum;
+    SSAInstr *insArr;       /*四元式下标减去graph->start得到的下标索引*/
+    SSAPhi **phiArr;        /*按基本块id索引的phi链表*/
+    void *hashArr;          /*变量查找表*/
+    uint32_t hashSize;
+    CplArena *arena;        /*SSA形式的所有内存*/
+} SSAFunction;
+
+int SSABuild(Bison *bison, FlowGraph *graph, SSAFunction **pSsa);
+void SSAFree(SSAFunction *ssa);
+
+uint32_t SSAUseNum(const QuadRuple *qr);
+uint32_t SSAVarOfId(const SSAFunction *ssa, Domain *domain, const Token *token);
+uint32_t SSAVarOfTemp(const SSAFunction *ssa, const Temp *temp);
+uint32_t SSAVarOfOperand(const SSAFunction *ssa, const QROperand *operand);
+uint32_t SSAVarOfExpr(const SSAFunction *ssa, const Expr *expr);
+SSAInstr *SSAInstrOf(const SSAFunction *ssa, size_t idx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__SSA_H__*/
@@ -0,0 +1,593 @@
+#include "value_number.h"
+#include "bison.h"
+#include "environ.h"
+#include "cpl_errno.h"
+#include "cpl_debug.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
+
+#define VN_NONE     (0)     /*没有值编号，值编号从1开始分配*/
+
+/*常量和读取内存的操作码，接在四元式操作码之后*/
+enum {
+    VNOP_CONST = QROC_PROGRAM_END + 1,  /*整数常量*/
+    VNOP_LOAD_ID,                       /*读取内存中的变量*/
+    VNOP_LOAD_DIRECT,                   /*直接成员访问*/
+    VNOP_LOAD_INDIRECT,                 /*间接成员访问*/
+};
+
+/*
+ * 值表达式。运算和常量的值与位置无关，表项一直保留；读取内存的表项带有内存版本epoch，
+ * 写内存之后epoch增加，旧的表项不会再被查到。
+ **/
+typedef struct _VNExpr {
+    uint32_t op;
+    uint32_t arg1;
+    uint32_t arg2;
+    const void *base;       /*读取的变量或者成员访问基址的声明条目*/
+    uint32_t epoch;
+    uint32_t vn;
+    struct _VNExpr *next;
+} VNExpr;
+
+/*值的代表，只定义一次的临时变量*/
+typedef struct {
+    Temp *temp;
+    Domain *domain;         /*临时变量所在的作用域，决定它在栈帧中的位置*/
+} VNLeader;
+
+/*值编号过程中的信息*/
+typedef struct {
+    Bison *bison;
+    QRRecord *record;
+    SSAFunction *ssa;
+    FlowGraph *graph;
+    uint8_t *keepArr;
+    uint32_t *nameBase;     /*变量的值编号在nameVn中的开始位置，提升的变量按版本号索引*/
+    uint32_t *nameVn;       /*变量的值编号，VN_NONE表示还没有编号*/
+    uint8_t *single;        /*只定义一次的临时变量，没有提升的在定义之前被使用时清零*/
+    VNLeader *leaderArr;    /*按值编号索引的代表*/
+    uint32_t vnNum;
+    uint32_t vnSize;
+    VNExpr **bucketArr;
+    uint32_t bucketMask;
+    uint32_t *leaderLog;    /*按设置顺序记录的值编号，退出基本块时按它撤销代表*/
+    uint32_t leaderNum;
+    uint32_t epoch;         /*内存版本*/
+    CplArena *arena;
+} VNContext;
+
+static void *VNAlloc(VNContext *ctx, size_t size)
+{
+    return CplArenaCalloc(ctx->arena, size ? size : 1);
+}
+
+/*
+ * 功能：判断值编号是否处理type类型的值，只处理int和指针。
+ * 返回值：处理时返回1，否则返回0。
+ **/
+static int VNWordType(const Type *type)
+{
+    return type->type == TT_POINTER || (type->type == TT_BASE && type->baseType.type == BTT_INT);
+}
+
+static uint32_t VNFresh(VNContext *ctx)
+{
+    if (ctx->vnNum + 1 >= ctx->vnSize)
+        return VN_NONE;
+    return ++ctx->vnNum;
+}
+
+static uint32_t VNHashKey(uint32_t op, uint32_t arg1, uint32_t arg2, const void *base, uint32_t epoch)
+{
+    uint32_t key;
+
+    key = op * 0x9e3779b1u;
+    key = (key ^ arg1) * 0x85ebca6bu;
+    key = (key ^ arg2) * 0xc2b2ae35u;
+    key = (key ^ (uint32_t)(uintptr_t)base) * 0x27d4eb2fu;
+    key = (key ^ epoch) * 0x165667b1u;
+    return key ^ (key >> 15);
+}
+
+/*
+ * 功能：查找值表达式，不存在时分配新的值编号并插入散列表。
+ * 返回值：值编号，内存不足时返回VN_NONE。
+ **/
+static uint32_t VNLookup(VNContext *ctx, uint32_t op, uint32_t arg1, uint32_t arg2, const void *base, uint32_t epoch)
+{
+    VNExpr **bucket, *expr;
+
+    bucket = &ctx->bucketArr[VNHashKey(op, arg1, arg2, base, epoch) & ctx->bucketMask];
+    for (expr = *bucket; expr; expr = expr->next) {
+        if (expr->op == op && expr->arg1 == arg1 && expr->arg2 == arg2
+                && expr->base == base && expr->epoch == epoch)
+            return expr->vn;
+    }
+    expr = VNAlloc(ctx, sizeof (*expr));
+    if (!expr)
+        return VN_NONE;
+    expr->vn = VNFresh(ctx);
+    if (expr->vn == VN_NONE)
+        return VN_NONE;
+    expr->op = op;
+    expr->arg1 = arg1;
+    expr->arg2 = arg2;
+    expr->base = base;
+    expr->epoch = epoch;
+    expr->next = *bucket;
+    *bucket = expr;
+    return expr->vn;
+}
+
+static uint32_t VNConst(VNContext *ctx, int val)
+{
+    return VNLookup(ctx, VNOP_CONST, (uint32_t)val, 0, NULL, 0);
+}
+
+/*
+ * 功能：获取提升的变量的一个版本的值编号，phi定义和0号版本在第一次使用时分配新的值编号。
+ * 返回值：
+ **/
+static uint32_t VNNameVn(VNContext *ctx, SSAName name)
+{
+    uint32_t *vn = &ctx->nameVn[ctx->nameBase[name.var] + name.ver];
+
+    if (*vn == VN_NONE)
+        *vn = VNFresh(ctx);
+    return *vn;
+}
+
+/*
+ * 功能：获取没有提升的临时变量的值编号。只有定义支配所有使用的临时变量才有值编号，
+ *      沿支配树遍历时先遇到使用的临时变量不再参与值编号。
+ * 返回值：
+ **/
+static uint32_t VNTempVn(VNContext *ctx, const Temp *temp)
+{
+    uint32_t var;
+
+    var = SSAVarOfTemp(ctx->ssa, temp);
+    if (var == SSA_NONE || !ctx->single[var])
+        return VN_NONE;
+    if (ctx->nameVn[ctx->nameBase[var]] == VN_NONE)
+        ctx->single[var] = 0;
+    return ctx->nameVn[ctx->nameBase[var]];
+}
+
+/*
+ * 功能：获取读取内存中的变量得到的值编号。
+ * 返回值：
+ **/
+static uint32_t VNIdLoad(VNContext *ctx, Domain *domain, const Token *token)
+{
+    DomainEntry *entry;
+
+    entry = EnvDomainGetEntry(domain, token);
+    if (!entry)
+        return VN_NONE;
+    return VNLookup(ctx, VNOP_LOAD_ID, 0, 0, entry, ctx->epoch);
+}
+
+/*
+ * 功能：获取成员访问读取的值的编号，按基址、偏移量和内存版本查找。
+ * 返回值：
+ **/
+static uint32_t VNAccessMbrVn(VNContext *ctx, Domain *domain, const QRAccessMbr *accessMbr)
+{
+    const QRAccessMbrOffset *offset = accessMbr->offset;
+    const void *base = NULL;
+    uint32_t op, arg1 = 0, arg2;
+
+    if (!VNWordType(accessMbr->dataType))
+        return VN_NONE;
+    if (accessMbr->baseType == QRAMBT_ID) {
+        base = EnvDomainGetEntry(domain, accessMbr->baseId.token);
+        if (!base)
+            return VN_NONE;
+    } else {
+        arg1 = VNTempVn(ctx, accessMbr->baseTemp);
+        if (arg1 == VN_NONE)
+            return VN_NONE;
+    }
+    if (!offset)
+        arg2 = VNConst(ctx, 0);
+    else if (offset->offsetType == QRAMOT_VAL)
+        arg2 = VNConst(ctx, offset->valOffset);
+    else if (offset->offsetType == QRAMOT_ID)
+        arg2 = VNIdLoad(ctx, offset->idOffset.domain, offset->idOffset.id.token);
+    else
+        arg2 = VNTempVn(ctx, offset->tempOffset.temp);
+    if (arg2 == VN_NONE)
+        return VN_NONE;
+    op = accessMbr->type == QRAMT_DIRECT ? VNOP_LOAD_DIRECT : VNOP_LOAD_INDIRECT;
+    return VNLookup(ctx, op, arg1, arg2, base, ctx->epoch);
+}
+
+static int VNPromoted(VNContext *ctx, const QROperand *operand)
+{
+    uint32_t var;
+
+    var = SSAVarOfOperand(ctx->ssa, operand);
+    return var != SSA_NONE && ctx->ssa->varArr[var].promoted;
+}
+
+/*
+ * 功能：获取使用的操作数的值编号，name是操作数在SSA形式中的版本。
+ * 返回值：
+ **/
+static uint32_t VNUse(VNContext *ctx, const QROperand *operand, SSAName name)
+{
+    if (!operand)
+        return VN_NONE;
+    switch (operand->type) {
+    case QROT_VAL:
+        return operand->val.type == QRVT_INT ? VNConst(ctx, operand->val.ival) : VN_NONE;
+    case QROT_ID:
+        if (VNPromoted(ctx, operand))
+            return name.var == SSA_NONE ? VN_NONE : VNNameVn(ctx, name);
+        return VNIdLoad(ctx, operand->domain, operand->id.token);
+    case QROT_TEMP:
+        if (VNPromoted(ctx, operand))
+            return name.var == SSA_NONE ? VN_NONE : VNNameVn(ctx, name);
+        return VNTempVn(ctx, operand->temp);
+    case QROT_ACCESS_MBR:
+        return VNAccessMbrVn(ctx, operand->domain, &operand->accessMbr);
+    default:
+        return VN_NONE;
+    }
+}
+
+/*
+ * 功能：查找值在domain作用域中可以使用的代表。代表所在的作用域必须是domain或者它的上级，
+ *      临时变量在栈帧中的位置才有效。
+ * pDomain：输出型参数，代表所在的作用域
+ * 返回值：代表的临时变量，没有时返回NULL。
+ **/
+static Temp *VNLeaderOf(VNContext *ctx, uint32_t vn, Domain *domain, Domain **pDomain)
+{
+    VNLeader *leader;
+
+    if (vn == VN_NONE || !ctx->leaderArr[vn].temp)
+        return NULL;
+    leader = &ctx->leaderArr[vn];
+    for (; domain; domain = domain->prev) {
+        if (domain == leader->domain) {
+            *pDomain = domain;
+            return leader->temp;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 功能：成员访问的偏移量是有代表的临时变量时，复制操作数并把偏移量改成代表。
+ * 返回值：
+ **/
+static void VNSubstOffset(VNContext *ctx, QROperand **pOperand)
+{
+    QROperand *operand = *pOperand;
+    QRAccessMbr *accessMbr;
+    QRAccessMbrOffset *offset;
+    Domain *domain;
+    Temp *temp;
+
+    if (!operand)
+        return;
+    if (operand->type == QROT_ACCESS_MBR)
+        accessMbr = &operand->accessMbr;
+    else if (operand->type == QROT_GET_ADDR && operand->getAddr.type == QRGAT_ACCESS_MEM)
+        accessMbr = &operand->getAddr.accessMbr;
+    else
+        return;
+    offset = accessMbr->offset;
+    if (!offset || offset->offsetType != QRAMOT_TEMP)
+        return;
+    temp = VNLeaderOf(ctx, VNTempVn(ctx, offset->tempOffset.temp), offset->tempOffset.domain, &domain);
+    if (!temp || temp == offset->tempOffset.temp)
+        return;
+    operand = QRCopyOperand(ctx->bison, operand);
+    if (operand->type == QROT_ACCESS_MBR)
+        operand->accessMbr.offset = QRNewAccessMemOffsetTemp(ctx->bison, domain, temp);
+    else
+        operand->getAddr.accessMbr.offset = QRNewAccessMemOffsetTemp(ctx->bison, domain, temp);
+    *pOperand = operand;
+}
+
+/*
+ * 功能：把临时变量的使用和读取内存替换成值的代表，提升的局部变量保持不变。
+ *      不能整体替换时替换成员访问中的偏移量。
+ * 返回值：
+ **/
+static void VNSubstUse(VNContext *ctx, QROperand **pOperand, uint32_t vn)
+{
+    QROperand *operand = *pOperand;
+    Domain *domain;
+    Temp *temp;
+
+    if (!operand)
+        return;
+    if ((operand->type == QROT_TEMP || operand->type == QROT_ACCESS_MBR
+                || (operand->type == QROT_ID && !VNPromoted(ctx, operand)))
+            && VNWordType(QROperandDataType(ctx->bison, operand))) {
+        temp = VNLeaderOf(ctx, vn, operand->domain, &domain);
+        if (temp && !(operand->type == QROT_TEMP && operand->temp == temp)) {
+            *pOperand = QRNewTempOperand(ctx->bison, domain, temp);
+            return;
+        }
+    }
+    VNSubstOffset(ctx, pOperand);
+}
+
+/*
+ * 功能：记录四元式结果的值编号。写内存时增加内存版本，只定义一次的临时变量
+ *      是它的值的第一个存放位置时成为代表。
+ * 返回值：
+ **/
+static void VNDefine(VNContext *ctx, QROperand *result, SSAName def, uint32_t vn)
+{
+    VNLeader *leader;
+    uint32_t var;
+
+    if (!result)
+        return;
+    if (result->type != QROT_ID && result->type != QROT_TEMP) {
+        ctx->epoch++;
+        return;
+    }
+    if (vn == VN_NONE || !VNWordType(QROperandDataType(ctx->bison, result)))
+        vn = VNFresh(ctx);
+    var = SSAVarOfOperand(ctx->ssa, result);
+    if (var != SSA_NONE && ctx->ssa->varArr[var].promoted) {
+        if (def.var == var)
+            ctx->nameVn[ctx->nameBase[var] + def.ver] = vn;
+    } else if (result->type == QROT_ID) {
+        ctx->epoch++;
+        return;
+    } else if (var != SSA_NONE && ctx->single[var]) {
+        ctx->nameVn[ctx->nameBase[var]] = vn;
+    }
+    if (result->type != QROT_TEMP || var == SSA_NONE || !ctx->single[var]
+            || vn == VN_NONE || !VNWordType(result->temp->type))
+        return;
+    leader = &ctx->leaderArr[vn];
+    if (leader->temp)
+        return;
+    leader->temp = result->temp;
+    leader->domain = result->domain;
+    ctx->leaderLog[ctx->leaderNum++] = vn;
+}
+
+static int VNCommutative(QROpCode op)
+{
+    return op == QROC_ADD || op == QROC_MUL;
+}
+
+/*
+ * 功能：对运算四元式编号，结果已经有代表时改成从代表赋值。
+ * 返回值：
+ **/
+static void VNVisitBin(VNContext *ctx, QuadRuple *qr, const SSAInstr *ins)
+{
+    QROperand *result;
+    Domain *domain;
+    Temp *temp;
+    uint32_t arg1, arg2, swap, vn = VN_NONE;
+
+    arg1 = VNUse(ctx, qr->binOp.arg1, ins->useArr[0]);
+    arg2 = VNUse(ctx, qr->binOp.arg2, ins->useArr[1]);
+    VNSubstUse(ctx, &qr->binOp.arg1, arg1);
+    VNSubstUse(ctx, &qr->binOp.arg2, arg2);
+    VNSubstOffset(ctx, &qr->binOp.result);
+    result = qr->binOp.result;
+    if (arg1 != VN_NONE && arg2 != VN_NONE && VNWordType(QROperandDataType(ctx->bison, result))) {
+        if (VNCommutative(qr->op) && arg1 > arg2) {
+            swap = arg1;
+            arg1 = arg2;
+            arg2 = swap;
+        }
+        vn = VNLookup(ctx, qr->op, arg1, arg2, NULL, 0);
+        temp = VNLeaderOf(ctx, vn, result->domain, &domain);
+        if (temp && !(result->type == QROT_TEMP && result->temp == temp)) {
+            qr->op = QROC_ASSIGN;
+            qr->unaryOp.arg1 = QRNewTempOperand(ctx->bison, domain, temp);
+            qr->unaryOp.result = result;
+        }
+    }
+    VNDefine(ctx, result, ins->def, vn);
+}
+
+/*
+ * 功能：对赋值四元式编号，int和指针之间的复制结果和参数的值编号相同。
+ * 返回值：
+ **/
+static void VNVisitAssign(VNContext *ctx, QuadRuple *qr, const SSAInstr *ins)
+{
+    uint32_t arg, vn = VN_NONE;
+
+    arg = VNUse(ctx, qr->unaryOp.arg1, ins->useArr[0]);
+    if (VNWordType(QROperandDataType(ctx->bison, qr->unaryOp.arg1)))
+        vn = arg;
+    VNSubstUse(ctx, &qr->unaryOp.arg1, arg);
+    VNSubstOffset(ctx, &qr->unaryOp.result);
+    VNDefine(ctx, qr->unaryOp.result, ins->def, vn);
+}
+
+static void VNVisitInstr(VNContext *ctx, size_t i)
+{
+    QuadRuple *qr = &ctx->record->qrArr[i];
+    SSAInstr *ins = SSAInstrOf(ctx->ssa, i);
+
+    switch (qr->op) {
+    case QROC_ADD:
+    case QROC_SUB:
+    case QROC_MUL:
+    case QROC_DIV:
+    case QROC_MOD:
+        VNVisitBin(ctx, qr, ins);
+        break;
+    case QROC_ASSIGN:
+        VNVisitAssign(ctx, qr, ins);
+        break;
+    case QROC_TABLE_JUMP:
+        VNSubstUse(ctx, &qr->tableJump.idx, VNUse(ctx, qr->tableJump.idx, ins->useArr[0]));
+        break;
+    case QROC_RETURN_VALUE:
+        VNSubstUse(ctx, &qr->returnObj.expr, VNUse(ctx, qr->returnObj.expr, ins->useArr[0]));
+        break;
+    case QROC_FUN_PARAM:
+        VNSubstUse(ctx, &qr->funParam.expr, VNUse(ctx, qr->funParam.expr, ins->useArr[0]));
+        break;
+    case QROC_FUN_CALL:
+        ctx->epoch++;
+        VNDefine(ctx, qr->funCall.result, ins->def, VN_NONE);
+        break;
+    case QROC_FUN_CALL_NRV:
+        ctx->epoch++;
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * 功能：编号基本块中的四元式，进入基本块时增加内存版本，读取内存只在块内复用。
+ * 返回值：
+ **/
+static void VNVisitBlock(VNContext *ctx, uint32_t b)
+{
+    FGBlock *block = &ctx->graph->blockArr[b];
+    size_t i;
+
+    ctx->epoch++;
+    for (i = block->start; i < block->end; i++) {
+        if (ctx->keepArr[i])
+            VNVisitInstr(ctx, i);
+    }
+}
+
+/*
+ * 功能：统计临时变量的定义次数，找出只定义一次的临时变量，并分配各变量的值编号。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int VNInit(VNContext *ctx)
+{
+    SSAFunction *ssa = ctx->ssa;
+    FlowGraph *graph = ctx->graph;
+    const QuadRuple *qr;
+    QROperand *result;
+    uint32_t *defNum;
+    uint32_t v, total = 0, bucketNum;
+    size_t i;
+
+    ctx->nameBase = VNAlloc(ctx, ssa->varNum * sizeof (*ctx->nameBase));
+    ctx->single = VNAlloc(ctx, ssa->varNum);
+    defNum = VNAlloc(ctx, ssa->varNum * sizeof (*defNum));
+    if (!ctx->nameBase || !ctx->single || !defNum)
+        return -ENOMEM;
+    for (i = graph->start; i < graph->end; i++) {
+        qr = &ctx->record->qrArr[i];
+        if (!ctx->keepArr[i])
+            continue;
+        if (qr->op == QROC_ASSIGN)
+            result = qr->unaryOp.result;
+        else if (qr->op == QROC_FUN_CALL)
+            result = qr->funCall.result;
+        else if (qr->op <= QROC_MOD)
+            result = qr->binOp.result;
+        else
+            continue;
+        if (result && result->type == QROT_TEMP) {
+            v = SSAVarOfTemp(ssa, result->temp);
+            if (v != SSA_NONE)
+                defNum[v]++;
+        }
+    }
+    for (v = 0; v < ssa->varNum; v++) {
+        ctx->nameBase[v] = total;
+        total += ssa->varArr[v].promoted ? ssa->varArr[v].versionNum : 1;
+        ctx->single[v] = ssa->varArr[v].kind == SSAVK_TEMP && defNum[v] == 1;
+    }
+
+    /*每条四元式最多分配8个新的值编号：两个操作数各自的常量偏移、读取偏移量变量和读取，运算和结果*/
+    ctx->vnSize = total + 8 * (uint32_t)(graph->end - graph->start) + 2;
+    for (bucketNum = 64; bucketNum < ctx->vnSize; bucketNum *= 2)
+        ;
+    ctx->bucketMask = bucketNum - 1;
+    ctx->nameVn = VNAlloc(ctx, total * sizeof (*ctx->nameVn));
+    ctx->leaderArr = VNAlloc(ctx, ctx->vnSize * sizeof (*ctx->leaderArr));
+    ctx->leaderLog = VNAlloc(ctx, ctx->vnSize * sizeof (*ctx->leaderLog));
+    ctx->bucketArr = VNAlloc(ctx, bucketNum * sizeof (*ctx->bucketArr));
+    if (!ctx->nameVn || !ctx->leaderArr || !ctx->leaderLog || !ctx->bucketArr)
+        return -ENOMEM;
+    return 0;
+}
+
+/*
+ * 功能：沿支配树深度优先编号，用显式栈代替递归，退出子树时撤销子树中设置的代表。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int VNWalk(VNContext *ctx)
+{
+    FlowGraph *graph = ctx->graph;
+    FGBlock *block;
+    uint32_t *stack, *nextArr, *logMark;
+    uint32_t top, b;
+
+    stack = VNAlloc(ctx, graph->blockNum * sizeof (*stack));
+    nextArr = VNAlloc(ctx, graph->blockNum * sizeof (*nextArr));
+    logMark = VNAlloc(ctx, graph->blockNum * sizeof (*logMark));
+    if (!stack || !nextArr || !logMark)
+        return -ENOMEM;
+
+    top = 0;
+    stack[top++] = 0;
+    logMark[0] = ctx->leaderNum;
+    VNVisitBlock(ctx, 0);
+    while (top > 0) {
+        b = stack[top - 1];
+        block = &graph->blockArr[b];
+        if (nextArr[b] < block->domChildNum) {
+            b = block->domChildArr[nextArr[b]++];
+            stack[top++] = b;
+            logMark[b] = ctx->leaderNum;
+            VNVisitBlock(ctx, b);
+        } else {
+            top--;
+            while (ctx->leaderNum > logMark[b])
+                ctx->leaderArr[ctx->leaderLog[--ctx->leaderNum]].temp = NULL;
+        }
+    }
+    return 0;
+}
+
+/*
+ * 功能：对一个函数做值编号和公共子表达式删除，ssa是函数当前的SSA形式。
+ *      改写后四元式记录和SSA形式不再一致，调用者要丢弃SSA形式和流图。
+ * keepArr：按四元式下标索引，值编号不删除四元式，只跳过已经删除的四元式
+ * 返回值：成功时返回0，否则返回错误码，失败时四元式没有被修改。
+ **/
+int VNFunction(Bison *bison, SSAFunction *ssa, uint8_t *keepArr)
+{
+    VNContext ctx;
+    int error = 0;
+
+    if (!bison || !bison->record || !ssa || !keepArr)
+        return -EINVAL;
+    memset(&ctx, 0, sizeof (ctx));
+    ctx.bison = bison;
+    ctx.record = bison->record;
+    ctx.ssa = ssa;
+    ctx.graph = ssa->graph;
+    ctx.keepArr = keepArr;
+    ctx.arena = CplArenaCreate(0);
+    if (!ctx.arena)
+        return -ENOMEM;
+    error = VNInit(&ctx);
+    if (error == -ENOERR)
+        error = VNWalk(&ctx);
+    CplArenaDestroy(ctx.arena);
+    return error;
+}
@@ -0,0 +1,35 @@
+#ifndef __VALUE_NUMBER_H__
+#define __VALUE_NUMBER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "quadruple.h"
+#include "ssa.h"
+
+/*
+ * 值编号和公共子表达式删除。
+ *
+ * 沿支配树深度优先给四元式计算的值编号：提升的变量按SSA版本编号，只定义一次的临时变量
+ * 按变量编号，运算按操作码和操作数的值编号查散列表，值相同的运算得到相同的编号。
+ * 一个值第一次存放到只定义一次的临时变量中时，这个临时变量成为它的代表，
+ * 代表只在定义所在的基本块中定义之后的部分和被支配的基本块中有效。
+ *
+ * 改写四元式：结果已经有有效代表的运算改成从代表赋值，临时变量的使用替换成它的代表，
+ * 被替换的临时变量的定义留给删除无用定义删除。数组下标的地址运算i * elemSize
+ * 在同一个循环体中重复出现时只计算一次。
+ *
+ * 读取内存（成员访问和没有提升的变量）只在基本块内部按值编号：写内存和函数调用之后
+ * 之前读取的值都作废，读取同一位置时直接使用之前读取到的临时变量。
+ * 只处理int和指针这样的4字节的值，不足4字节的整数和浮点数每次都是新的值。
+ **/
+
+int VNFunction(Bison *bison, SSAFunction *ssa, uint8_t *keepArr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__VALUE_NUMBER_H__*/
@@ -0,0 +1,368 @@
+#include "compile_server.h"
+#include "bison.h"
+#include "gen_code.h"
+#include "list.h"
+#include "cpl_errno.h"
+#include "cpl_debug.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#define PrErr(...)      Pr(__FILE__, __LINE__, __FUNCTION__, "error", __VA_ARGS__)
+
+/*accept因为描述符或者内存不足失败时的等待时间，微秒，每次失败加倍，直到CS_ACCEPT_BACKOFF_MAX*/
+#define CS_ACCEPT_BACKOFF       10000
+#define CS_ACCEPT_BACKOFF_MAX   1000000
+
+/*等待处理的连接*/
+typedef struct {
+    struct list_head node;
+    int fd;
+} CSConn;
+
+/*编译服务器*/
+typedef struct {
+    struct list_head connList;  /*等待处理的连接队列，节点类型：CSConn*/
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} CSServer;
+
+/*工作线程一直运行到进程退出，服务器使用静态存储*/
+static CSServer csServer;
+
+/*
+ * 功能：从套接字读取len字节，被信号中断时继续读取。
+ * 返回值：成功时返回0，对端关闭连接时返回-EEOF，超时返回-ETIMEDOUT，否则返回错误码。
+ **/
+static int CSRead(int fd, void *buf, size_t len)
+{
+    ssize_t n;
+    size_t done = 0;
+
+    while (done < len) {
+        n = read(fd, (char *)buf + done, len - done);
+        if (n == 0)
+            return -EEOF;
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return -ETIMEDOUT;
+            return -EIO;
+        }
+        done += n;
+    }
+    return 0;
+}
+
+/*
+ * 功能：向套接字写入len字节，被信号中断时继续写入。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CSWrite(int fd, const void *buf, size_t len)
+{
+    ssize_t n;
+    size_t done = 0;
+
+    while (done < len) {
+        n = send(fd, (const char *)buf + done, len - done, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -EIO;
+        done += n;
+    }
+    return 0;
+}
+
+static uint32_t CSGetWord(const unsigned char buf[4])
+{
+    return buf[0] | buf[1] << 8 | buf[2] << 16 | (uint32_t)buf[3] << 24;
+}
+
+static void CSPutWord(unsigned char buf[4], uint32_t word)
+{
+    buf[0] = word & 0xff;
+    buf[1] = (word >> 8) & 0xff;
+    buf[2] = (word >> 16) & 0xff;
+    buf[3] = (word >> 24) & 0xff;
+}
+
+/*
+ * 功能：发送应答。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CSReply(int fd, int status, const char *payload, size_t len)
+{
+    unsigned char head[8];
+    int error = 0;
+
+    CSPutWord(head, (uint32_t)status);
+    CSPutWord(head + 4, (uint32_t)len);
+    error = CSWrite(fd, head, sizeof (head));
+    if (error == -ENOERR && len)
+        error = CSWrite(fd, payload, len);
+    return error;
+}
+
+/*
+ * 功能：编译一个请求的源代码，诊断信息写入diagFp。cplPrStream是线程局部的，
+ *      各个工作线程的诊断信息只写入自己正在处理的请求。
+ * pImage：输出型参数，目标代码映像，由调用者释放
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CSCompile(const char *src, size_t len, FILE *diagFp, GCImage **pImage)
+{
+    Bison *ctx;
+    FILE *prevFp;
+    int error = 0;
+
+    ctx = BisonAlloc();
+    if (!ctx)
+        return -ENOMEM;
+    prevFp = cplPrStream;
+    cplPrStream = diagFp;
+    error = BisonCompileBuffer(ctx, src, len);
+    if (error == -ENOERR)
+        error = GCGenImage(ctx, pImage);
+    cplPrStream = prevFp;
+    BisonFree(ctx);
+    return error;
+}
+
+/*
+ * 功能：处理一个编译请求并发送应答。
+ * 返回值：成功时返回0，否则返回错误码，发生错误时关闭连接。
+ **/
+static int CSHandleRequest(int fd, const char *src, size_t len)
+{
+    GCImage *image = NULL;
+    char *payload = NULL;
+    size_t payloadLen = 0;
+    FILE *fp;
+    int status, error = 0;
+
+    fp = open_memstream(&payload, &payloadLen);
+    if (!fp)
+        return -ENOMEM;
+    status = CSCompile(src, len, fp, &image);
+    if (status == -ENOERR) {
+        /*编译成功时丢弃诊断信息，负载是目标代码映像*/
+        fflush(fp);
+        rewind(fp);
+        status = GCImageWrite(image, fp);
+        GCImageFree(image);
+    }
+    if (fclose(fp) != 0) {
+        free(payload);
+        return -ENOMEM;
+    }
+    error = CSReply(fd, status, payload, payloadLen);
+    free(payload);
+    return error;
+}
+
+/*
+ * 功能：处理一个连接上的所有请求，直到对端关闭连接、读写超时或者发生错误。
+ * 返回值：无
+ **/
+static void CSHandleConn(int fd)
+{
+    unsigned char head[4];
+    char *src = NULL, *temp;
+    size_t size = 0;
+    uint32_t len;
+    int error = 0;
+
+    for (;;) {
+        error = CSRead(fd, head, sizeof (head));
+        if (error != -ENOERR)
+            break;
+        len = CSGetWord(head);
+        if (len == 0 || len > CS_MAX_SOURCE_SIZE) {
+            CSReply(fd, -EINVAL, NULL, 0);
+            break;
+        }
+        if (len > size) {
+            temp = realloc(src, len);
+            if (!temp)
+                break;
+            src = temp;
+            size = len;
+        }
+        error = CSRead(fd, src, len);
+        if (error != -ENOERR)
+            break;
+        error = CSHandleRequest(fd, src, len);
+        if (error != -ENOERR)
+            break;
+    }
+    free(src);
+    close(fd);
+}
+
+static void *CSWorker(void *arg)
+{
+    CSServer *server = arg;
+    CSConn *conn;
+    int fd;
+
+    for (;;) {
+        pthread_mutex_lock(&server->mutex);
+        while (list_empty(&server->connList))
+            pthread_cond_wait(&server->cond, &server->mutex);
+        conn = container_of(server->connList.next, CSConn, node);
+        list_del(&conn->node);
+        pthread_mutex_unlock(&server->mutex);
+
+        fd = conn->fd;
+        free(conn);
+        CSHandleConn(fd);
+    }
+    return NULL;
+}
+
+/*
+ * 功能：创建监听套接字，已经存在的套接字文件会被删除。
+ * 返回值：成功时返回套接字，否则返回错误码。
+ **/
+static int CSListen(const char *sockPath)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(sockPath) >= sizeof (addr.sun_path))
+        return -EINVAL;
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -EIO;
+    memset(&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, sockPath);
+    unlink(sockPath);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof (addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -EIO;
+    }
+    return fd;
+}
+
+/*
+ * 功能：等待下一个连接。被信号中断或者连接在接受前中止时重试；描述符或者内存不足时
+ *      等待一段时间再重试，不空转；其他错误说明监听套接字不可用。
+ * 返回值：成功时返回连接的套接字，否则返回错误码。
+ **/
+static int CSAccept(int listenFd)
+{
+    useconds_t backoff = CS_ACCEPT_BACKOFF;
+    int fd;
+
+    for (;;) {
+        fd = accept(listenFd, NULL, NULL);
+        if (fd >= 0)
+            return fd;
+        switch (errno) {
+        case EINTR:
+        case ECONNABORTED:
+            break;
+        case EMFILE:
+        case ENFILE:
+        case ENOBUFS:
+        case ENOMEM:
+            PrErr("accept failed: %d, retry after %u us\n", errno, (unsigned int)backoff);
+            usleep(backoff);
+            if (backoff < CS_ACCEPT_BACKOFF_MAX)
+                backoff *= 2;
+            break;
+        default:
+            PrErr("accept failed: %d\n", errno);
+            return -EIO;
+        }
+    }
+}
+
+/*
+ * 功能：设置连接的读写超时时间，对端不发送请求或者不读取应答时，工作线程在超时后关闭连接。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CSSetTimeout(int fd)
+{
+    struct timeval tv;
+
+    tv.tv_sec = CS_IO_TIMEOUT;
+    tv.tv_usec = 0;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof (tv)) != 0
+            || setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof (tv)) != 0)
+        return -EIO;
+    return 0;
+}
+
+/*
+ * 功能：运行编译服务器，正常情况下不返回。
+ * sockPath：Unix套接字路径
+ * threadNum：工作线程数，0表示使用CPU核数
+ * 返回值：发生错误时返回错误码。
+ **/
+int CSRun(const char *sockPath, int threadNum)
+{
+    CSServer *server = &csServer;
+    CSConn *conn;
+    pthread_t thread;
+    int listenFd, fd;
+    int t;
+    int error = 0;
+
+    if (!sockPath)
+        return -EINVAL;
+    if (threadNum <= 0)
+        threadNum = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threadNum <= 0)
+        threadNum = 1;
+
+    /*在接受请求之前构造共享的自动机和语法分析表*/
+    error = BisonPrepare();
+    if (error != -ENOERR)
+        return error;
+
+    INIT_LIST_HEAD(&server->connList);
+    pthread_mutex_init(&server->mutex, NULL);
+    pthread_cond_init(&server->cond, NULL);
+    listenFd = CSListen(sockPath);
+    if (listenFd < 0) {
+        PrErr("listen %s failed\n", sockPath);
+        return listenFd;
+    }
+    for (t = 0; t < threadNum; t++) {
+        if (pthread_create(&thread, NULL, CSWorker, server) != 0)
+            break;
+        pthread_detach(thread);
+    }
+    if (t == 0) {
+        close(listenFd);
+        return -EMISC;
+    }
+
+    for (;;) {
+        fd = CSAccept(listenFd);
+        if (fd < 0) {
+            close(listenFd);
+            return fd;
+        }
+        conn = CSSetTimeout(fd) == -ENOERR ? malloc(sizeof (*conn)) : NULL;
+        if (!conn) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        pthread_mutex_lock(&server->mutex);
+        list_add_tail(&conn->node, &server->connList);
+        pthread_cond_signal(&server->cond);
+        pthread_mutex_unlock(&server->mutex);
+    }
+    return 0;
+}
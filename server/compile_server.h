@@ -0,0 +1,33 @@
+#ifndef __COMPILE_SERVER_H__
+#define __COMPILE_SERVER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 编译服务器，在本地Unix套接字上接受编译请求。词法分析器的自动机和语法分析表在启动时构造，
+ * 常驻内存，请求由工作线程并发处理。一个连接上可以依次发送多个请求。
+ *
+ * 协议中的整数都是按小端序存储的32位整数：
+ *   请求：源代码长度len，len字节源代码
+ *   应答：状态status，负载长度len，len字节负载
+ * status为0时负载是目标代码映像，格式和GCImageWrite写入的文件相同；
+ * 否则status是错误码，负载是诊断信息文本。
+ * 长度为0或者超过CS_MAX_SOURCE_SIZE时应答-EINVAL并关闭连接。
+ * 连接上超过CS_IO_TIMEOUT秒收不到数据或者发不出应答时，服务器关闭连接，
+ * 空闲的连接不会一直占用工作线程。
+ **/
+
+#define CS_MAX_SOURCE_SIZE      (16 * 1024 * 1024)  /*一个请求的源代码最大长度*/
+#ifndef CS_IO_TIMEOUT
+#define CS_IO_TIMEOUT           5                   /*连接上读写的超时时间，秒*/
+#endif
+
+int CSRun(const char *sockPath, int threadNum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__COMPILE_SERVER_H__*/
@@ -0,0 +1,438 @@
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "compile_server.h"
+#include "gen_code.h"
+#include "cpl_errno.h"
+
+/*
+ * 编译服务器的协议测试，替代main.c和其他源文件一起编译：
+ *      gcc [-DCS_IO_TIMEOUT=1] ... tests/compile_server_test.c -o compile_server_test
+ *      ./compile_server_test [source [sock]]
+ * 在同一个进程中启动CS_TEST_WORKER_NUM个工作线程的服务器，依次检查：
+ * 编译成功时应答目标代码映像；编译失败时应答错误码和诊断信息，连接仍然可用；
+ * 长度为0和超过CS_MAX_SOURCE_SIZE的请求应答-EINVAL并关闭连接；
+ * 多个连接并发发送请求时，应答和单独发送时相同；
+ * 空闲连接占满所有工作线程时，超时关闭后其他连接的请求仍然得到应答。
+ * 空闲连接的检查要等待CS_IO_TIMEOUT秒，编译时可以把它定义得小一些。
+ * 全部通过时返回0，否则输出第一个失败的检查并返回-1。
+ **/
+
+#define CS_TEST_WORKER_NUM      2
+#define CS_TEST_CLIENT_NUM      8       /*并发检查的连接数，多于工作线程数*/
+#define CS_TEST_REQUEST_NUM     4       /*并发检查中每个连接发送的请求数*/
+#define CS_TEST_CLIENT_TIMEOUT  (CS_IO_TIMEOUT * 3 + 5)     /*客户端等待应答的时间，秒*/
+
+/*一次请求的应答*/
+typedef struct {
+    int status;
+    char *payload;
+    size_t len;
+} CSTestReply;
+
+/*并发检查中一个连接的参数*/
+typedef struct {
+    pthread_t thread;
+    int id;
+    int error;
+} CSTestClient;
+
+static const char *csTestSockPath;
+static char *csTestSrc;                 /*编译成功的源代码*/
+static size_t csTestSrcLen;
+static const char csTestBadSrc[] = "int main(void)\n{\n\tint ;\n\treturn 0;\n}\n";
+static CSTestReply csTestGood;          /*csTestSrc的应答，并发检查以它为准*/
+static CSTestReply csTestBad;           /*csTestBadSrc的应答*/
+
+static int CSTestReadAll(int fd, void *buf, size_t len)
+{
+    ssize_t n;
+    size_t done = 0;
+
+    while (done < len) {
+        n = read(fd, (char *)buf + done, len - done);
+        if (n == 0)
+            return -EEOF;
+        if (n < 0)
+            return errno == EINTR ? 0 : -EIO;
+        done += n;
+    }
+    return 0;
+}
+
+static int CSTestWriteAll(int fd, const void *buf, size_t len)
+{
+    ssize_t n;
+    size_t done = 0;
+
+    while (done < len) {
+        n = send(fd, (const char *)buf + done, len - done, MSG_NOSIGNAL);
+        if (n <= 0)
+            return -EIO;
+        done += n;
+    }
+    return 0;
+}
+
+static uint32_t CSTestGetWord(const unsigned char buf[4])
+{
+    return buf[0] | buf[1] << 8 | buf[2] << 16 | (uint32_t)buf[3] << 24;
+}
+
+static void CSTestPutWord(unsigned char buf[4], uint32_t word)
+{
+    buf[0] = word & 0xff;
+    buf[1] = (word >> 8) & 0xff;
+    buf[2] = (word >> 16) & 0xff;
+    buf[3] = (word >> 24) & 0xff;
+}
+
+/*
+ * 功能：连接服务器，设置等待应答的超时时间，服务器没有应答时检查失败而不是一直等待。
+ * 返回值：成功时返回套接字，否则返回错误码。
+ **/
+static int CSTestConnect(void)
+{
+    struct sockaddr_un addr;
+    struct timeval tv;
+    int fd;
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -EIO;
+    memset(&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, csTestSockPath, sizeof (addr.sun_path) - 1);
+    tv.tv_sec = CS_TEST_CLIENT_TIMEOUT;
+    tv.tv_usec = 0;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof (addr)) != 0
+            || setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof (tv)) != 0) {
+        close(fd);
+        return -EIO;
+    }
+    return fd;
+}
+
+/*
+ * 功能：读取一个应答，负载由调用者释放。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CSTestRecvReply(int fd, CSTestReply *reply)
+{
+    unsigned char head[8];
+    int error = 0;
+
+    memset(reply, 0, sizeof (*reply));
+    error = CSTestReadAll(fd, head, sizeof (head));
+    if (error != -ENOERR)
+        return error;
+    reply->status = (int)CSTestGetWord(head);
+    reply->len = CSTestGetWord(head + 4);
+    if (!reply->len)
+        return 0;
+    reply->payload = malloc(reply->len);
+    if (!reply->payload)
+        return -ENOMEM;
+    error = CSTestReadAll(fd, reply->payload, reply->len);
+    if (error != -ENOERR) {
+        free(reply->payload);
+        reply->payload = NULL;
+    }
+    return error;
+}
+
+/*
+ * 功能：发送长度为len的请求头和源代码，读取应答。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CSTestRequest(int fd, uint32_t len, const char *src, size_t srcLen, CSTestReply *reply)
+{
+    unsigned char head[4];
+    int error = 0;
+
+    CSTestPutWord(head, len);
+    error = CSTestWriteAll(fd, head, sizeof (head));
+    if (error == -ENOERR && srcLen)
+        error = CSTestWriteAll(fd, src, srcLen);
+    if (error == -ENOERR)
+        error = CSTestRecvReply(fd, reply);
+    return error;
+}
+
+static int CSTestReplyEqual(const CSTestReply *a, const CSTestReply *b)
+{
+    return a->status == b->status && a->len == b->len
+           && (!a->len || memcmp(a->payload, b->payload, a->len) == 0);
+}
+
+/*
+ * 功能：检查服务器是否已经关闭连接。
+ * 返回值：已经关闭时返回1，否则返回0。
+ **/
+static int CSTestClosed(int fd)
+{
+    char c;
+
+    return read(fd, &c, 1) == 0;
+}
+
+static void *CSTestServer(void *arg)
+{
+    int error = 0;
+
+    error = CSRun(csTestSockPath, CS_TEST_WORKER_NUM);
+    printf("server exit: %d\n", error);
+    return NULL;
+}
+
+/*
+ * 功能：启动服务器线程，等待监听套接字可以连接。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CSTestStart(void)
+{
+    pthread_t thread;
+    int fd, i;
+
+    if (pthread_create(&thread, NULL, CSTestServer, NULL) != 0)
+        return -EMISC;
+    pthread_detach(thread);
+    /*服务器启动时要构造词法分析器和语法分析表*/
+    for (i = 0; i < 500; i++) {
+        fd = CSTestConnect();
+        if (fd >= 0) {
+            close(fd);
+            return 0;
+        }
+        usleep(10000);
+    }
+    return -EIO;
+}
+
+/*
+ * 功能：检查编译成功和编译失败的请求，记录两者的应答供并发检查比较。
+ * 返回值：通过时返回0，否则返回错误码。
+ **/
+static int CSTestCompile(void)
+{
+    CSTestReply reply;
+    int fd;
+    int error = 0;
+
+    fd = CSTestConnect();
+    if (fd < 0)
+        return fd;
+    error = CSTestRequest(fd, csTestSrcLen, csTestSrc, csTestSrcLen, &csTestGood);
+    if (error != -ENOERR || csTestGood.status != 0 || csTestGood.len < 12
+            || CSTestGetWord((unsigned char *)csTestGood.payload) != GC_IMAGE_MAGIC) {
+        printf("compile check fail: %d, status %d, len %zu\n", error, csTestGood.status, csTestGood.len);
+        error = -EMISC;
+        goto out;
+    }
+    error = CSTestRequest(fd, sizeof (csTestBadSrc) - 1, csTestBadSrc, sizeof (csTestBadSrc) - 1, &csTestBad);
+    if (error != -ENOERR || csTestBad.status == 0 || csTestBad.len == 0) {
+        printf("diagnostic check fail: %d, status %d, len %zu\n", error, csTestBad.status, csTestBad.len);
+        error = -EMISC;
+        goto out;
+    }
+    /*编译失败后连接仍然可用*/
+    error = CSTestRequest(fd, csTestSrcLen, csTestSrc, csTestSrcLen, &reply);
+    if (error != -ENOERR || !CSTestReplyEqual(&reply, &csTestGood)) {
+        printf("request after diagnostic fail: %d, status %d\n", error, reply.status);
+        error = -EMISC;
+    }
+    free(reply.payload);
+out:
+    close(fd);
+    return error;
+}
+
+/*
+ * 功能：检查长度为len的请求头被拒绝，服务器应答-EINVAL并关闭连接。
+ * 返回值：通过时返回0，否则返回错误码。
+ **/
+static int CSTestBadLength(uint32_t len)
+{
+    CSTestReply reply;
+    int fd;
+    int error = 0;
+
+    fd = CSTestConnect();
+    if (fd < 0)
+        return fd;
+    error = CSTestRequest(fd, len, NULL, 0, &reply);
+    if (error != -ENOERR || reply.status != -EINVAL || reply.len != 0 || !CSTestClosed(fd)) {
+        printf("length %u check fail: %d, status %d, len %zu\n", len, error, reply.status, reply.len);
+        error = -EMISC;
+    }
+    free(reply.payload);
+    close(fd);
+    return error;
+}
+
+static void *CSTestClientRun(void *arg)
+{
+    CSTestClient *client = arg;
+    CSTestReply reply;
+    const CSTestReply *expect;
+    int fd, r;
+
+    fd = CSTestConnect();
+    if (fd < 0) {
+        client->error = fd;
+        return NULL;
+    }
+    for (r = 0; r < CS_TEST_REQUEST_NUM && client->error == -ENOERR; r++) {
+        if ((client->id + r) % 2 == 0) {
+            expect = &csTestGood;
+            client->error = CSTestRequest(fd, csTestSrcLen, csTestSrc, csTestSrcLen, &reply);
+        } else {
+            expect = &csTestBad;
+            client->error = CSTestRequest(fd, sizeof (csTestBadSrc) - 1, csTestBadSrc,
+                                          sizeof (csTestBadSrc) - 1, &reply);
+        }
+        if (client->error == -ENOERR && !CSTestReplyEqual(&reply, expect))
+            client->error = -EMISC;
+        free(reply.payload);
+    }
+    close(fd);
+    return NULL;
+}
+
+/*
+ * 功能：多个连接同时发送请求，每个应答都和单独发送时相同。
+ * 返回值：通过时返回0，否则返回错误码。
+ **/
+static int CSTestConcurrent(void)
+{
+    CSTestClient clientArr[CS_TEST_CLIENT_NUM];
+    int i, num;
+    int error = 0;
+
+    for (num = 0; num < CS_TEST_CLIENT_NUM; num++) {
+        clientArr[num].id = num;
+        clientArr[num].error = 0;
+        if (pthread_create(&clientArr[num].thread, NULL, CSTestClientRun, &clientArr[num]) != 0) {
+            error = -EMISC;
+            break;
+        }
+    }
+    for (i = 0; i < num; i++) {
+        pthread_join(clientArr[i].thread, NULL);
+        if (clientArr[i].error != -ENOERR) {
+            printf("concurrent client %d fail: %d\n", i, clientArr[i].error);
+            error = -EMISC;
+        }
+    }
+    return error;
+}
+
+/*
+ * 功能：用不发送请求的连接占满所有工作线程，再发送一个请求，
+ *      服务器超时关闭空闲连接后应答这个请求。
+ * 返回值：通过时返回0，否则返回错误码。
+ **/
+static int CSTestIdle(void)
+{
+    int idleArr[CS_TEST_WORKER_NUM];
+    CSTestReply reply;
+    int i, fd;
+    int error = 0;
+
+    for (i = 0; i < CS_TEST_WORKER_NUM; i++)
+        idleArr[i] = CSTestConnect();
+    /*等待工作线程取走空闲连接*/
+    usleep(100000);
+    fd = CSTestConnect();
+    if (fd >= 0) {
+        error = CSTestRequest(fd, csTestSrcLen, csTestSrc, csTestSrcLen, &reply);
+        if (error != -ENOERR || !CSTestReplyEqual(&reply, &csTestGood)) {
+            printf("request behind idle connections fail: %d\n", error);
+            error = -EMISC;
+        }
+        free(reply.payload);
+        close(fd);
+    } else {
+        error = fd;
+    }
+    for (i = 0; i < CS_TEST_WORKER_NUM; i++) {
+        if (idleArr[i] < 0 || !CSTestClosed(idleArr[i])) {
+            printf("idle connection %d not closed\n", i);
+            error = -EMISC;
+        }
+        if (idleArr[i] >= 0)
+            close(idleArr[i]);
+    }
+    return error;
+}
+
+/*
+ * 功能：读取源文件。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int CSTestLoad(const char *path)
+{
+    FILE *fp;
+    long len;
+
+    fp = fopen(path, "rb");
+    if (!fp)
+        return -EIO;
+    if (fseek(fp, 0, SEEK_END) != 0 || (len = ftell(fp)) <= 0 || fseek(fp, 0, SEEK_SET) != 0) {
+        fclose(fp);
+        return -EIO;
+    }
+    csTestSrc = malloc(len);
+    if (!csTestSrc || fread(csTestSrc, 1, len, fp) != (size_t)len) {
+        fclose(fp);
+        return -EIO;
+    }
+    fclose(fp);
+    csTestSrcLen = len;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = "test.txt";
+    char sockPath[64];
+    int error = 0;
+
+    if (argc > 1)
+        path = argv[1];
+    snprintf(sockPath, sizeof (sockPath), "/tmp/cs_test.%d.sock", (int)getpid());
+    csTestSockPath = argc > 2 ? argv[2] : sockPath;
+
+    error = CSTestLoad(path);
+    if (error != -ENOERR) {
+        printf("load %s fail: %d\n", path, error);
+        return -1;
+    }
+    error = CSTestStart();
+    if (error != -ENOERR)
+        printf("server start fail: %d\n", error);
+    if (error == -ENOERR)
+        error = CSTestCompile();
+    if (error == -ENOERR)
+        error = CSTestBadLength(0);
+    if (error == -ENOERR)
+        error = CSTestBadLength(CS_MAX_SOURCE_SIZE + 1);
+    if (error == -ENOERR)
+        error = CSTestConcurrent();
+    if (error == -ENOERR)
+        error = CSTestIdle();
+    if (error == -ENOERR)
+        printf("%d workers, %d concurrent clients, idle timeout %d s: pass\n",
+               CS_TEST_WORKER_NUM, CS_TEST_CLIENT_NUM, CS_IO_TIMEOUT);
+
+    unlink(csTestSockPath);
+    free(csTestGood.payload);
+    free(csTestBad.payload);
+    free(csTestSrc);
+    return error == -ENOERR ? 0 : -1;
+}
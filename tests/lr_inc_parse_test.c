@@ -0,0 +1,212 @@
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "bison.h"
+#include "lex.h"
+#include "lr_inc_parse.h"
+#include "cpl_errno.h"
+
+/*
+ * 增量语法分析的差分测试，替代main.c和其他源文件一起编译：
+ *      gcc ... tests/lr_inc_parse_test.c -o lr_inc_parse_test
+ *      ./lr_inc_parse_test [source [editNum [seed]]]
+ * 把源文件的记号序列做editNum次随机编辑，每次编辑后用增量分析的结果和全量分析的结果比较：
+ * 分析结果相同，成功时语法树的形状和每个节点记录的状态也相同，有语义值的节点也相同，
+ * 记号的语义值是同一个记号。增量分析复用旧子树的语义值，执行的归约句柄比全量分析少。
+ * 编辑有三种：把一个记号替换成同样的记号、用序列中其他位置的记号替换一段记号、
+ * 撤销上一次失败的编辑，使每次随机编辑都从一棵完整的语法树开始。
+ * 全部相同时返回0，否则输出第一个不同的编辑并返回-1。
+ **/
+
+#define INC_TEST_EDIT_NUM       5000
+#define INC_TEST_SEED           1
+#define INC_TEST_SPAN_MAX       4       /*一次编辑删除或者插入的最多记号数*/
+
+/*一次编辑，撤销时用删除的记号替换插入的记号*/
+typedef struct {
+    int start;
+    int delNum;
+    int insNum;
+    int delArr[INC_TEST_SPAN_MAX];
+    int insArr[INC_TEST_SPAN_MAX];
+    void *delValueArr[INC_TEST_SPAN_MAX];
+    void *insValueArr[INC_TEST_SPAN_MAX];
+} IncTestEdit;
+
+static unsigned int incTestSeed = INC_TEST_SEED;
+
+static unsigned int IncTestRand(void)
+{
+    incTestSeed = incTestSeed * 1103515245 + 12345;
+    return (incTestSeed >> 16) & 0x7fff;
+}
+
+/*
+ * 功能：比较两棵语法树。
+ * 返回值：相同时返回1，否则返回0。
+ **/
+static int IncTestNodeEqual(const LrIncNode *a, const LrIncNode *b)
+{
+    int i;
+
+    if (!a || !b)
+        return a == b;
+    if (a == b)
+        return 1;
+    if (a->symId != b->symId || a->state != b->state || a->tokenNum != b->tokenNum
+            || a->firstSymId != b->firstSymId || a->childNum != b->childNum || a->valueFlag != b->valueFlag)
+        return 0;
+    if (a->childNum == 0 && a->value != b->value)
+        return 0;
+    for (i = 0; i < a->childNum; i++) {
+        if (!IncTestNodeEqual(a->childArr[i], b->childArr[i]))
+            return 0;
+    }
+    return 1;
+}
+
+/*
+ * 功能：生成一次随机编辑，记号从序列中随机选取。
+ * 返回值：无
+ **/
+static void IncTestRandEdit(const LrIncParser *parser, IncTestEdit *edit)
+{
+    int num = parser->symIdNum;
+    int k, pos;
+
+    edit->start = num ? IncTestRand() % num : 0;
+    if (num && IncTestRand() % 2 == 0) {
+        edit->delNum = edit->insNum = 1;
+        edit->insArr[0] = parser->symIdArr[edit->start];
+        edit->insValueArr[0] = parser->valueArr[edit->start];
+    } else {
+        edit->delNum = IncTestRand() % (INC_TEST_SPAN_MAX + 1);
+        if (edit->delNum > num - edit->start)
+            edit->delNum = num - edit->start;
+        edit->insNum = num ? IncTestRand() % (INC_TEST_SPAN_MAX + 1) : 0;
+        for (k = 0; k < edit->insNum; k++) {
+            pos = IncTestRand() % num;
+            edit->insArr[k] = parser->symIdArr[pos];
+            edit->insValueArr[k] = parser->valueArr[pos];
+        }
+    }
+    memcpy(edit->delArr, &parser->symIdArr[edit->start], edit->delNum * sizeof (edit->delArr[0]));
+    memcpy(edit->delValueArr, &parser->valueArr[edit->start], edit->delNum * sizeof (edit->delValueArr[0]));
+}
+
+static void IncTestUndoEdit(IncTestEdit *edit)
+{
+    int tempArr[INC_TEST_SPAN_MAX];
+    void *tempValueArr[INC_TEST_SPAN_MAX];
+    int tempNum;
+
+    tempNum = edit->insNum;
+    memcpy(tempArr, edit->insArr, sizeof (tempArr));
+    memcpy(tempValueArr, edit->insValueArr, sizeof (tempValueArr));
+    edit->insNum = edit->delNum;
+    memcpy(edit->insArr, edit->delArr, sizeof (tempArr));
+    memcpy(edit->insValueArr, edit->delValueArr, sizeof (tempValueArr));
+    edit->delNum = tempNum;
+    memcpy(edit->delArr, tempArr, sizeof (tempArr));
+    memcpy(edit->delValueArr, tempValueArr, sizeof (tempValueArr));
+}
+
+/*
+ * 功能：读取源文件的记号序列，记号在词法分析器中，测试结束时释放词法分析器。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int IncTestLoad(const char *path, Lex **pLex, int **pSymIdArr, void ***pTokenArr, int *pLen)
+{
+    Lex *lex;
+    int error = 0;
+
+    lex = LexAlloc();
+    if (!lex)
+        return -ENOMEM;
+    error = LexSetInFile(lex, path);
+    if (error == -ENOERR)
+        error = BisonLexSymIdArr(lex, pSymIdArr, pTokenArr, pLen);
+    if (error != -ENOERR) {
+        LexFree(lex);
+        return error;
+    }
+    *pLex = lex;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = "test.txt";
+    int editNum = INC_TEST_EDIT_NUM;
+    LrIncParser *incParser = NULL, *fullParser = NULL;
+    IncTestEdit edit;
+    Lex *lex = NULL;
+    int *symIdArr = NULL;
+    void **tokenArr = NULL;
+    int len, i;
+    int incError, fullError, undo = 0, okNum = 0;
+    unsigned long reuseTokenNum = 0, tokenNum = 0, incValueNum = 0, fullValueNum = 0;
+    int error = 0;
+
+    if (argc > 1)
+        path = argv[1];
+    if (argc > 2)
+        editNum = atoi(argv[2]);
+    if (argc > 3)
+        incTestSeed = (unsigned int)strtoul(argv[3], NULL, 0);
+
+    error = IncTestLoad(path, &lex, &symIdArr, &tokenArr, &len);
+    if (error != -ENOERR) {
+        printf("load %s fail: %d\n", path, error);
+        return -1;
+    }
+    error = BisonIncParserAlloc(&incParser);
+    if (error == -ENOERR)
+        error = BisonIncParserAlloc(&fullParser);
+    if (error == -ENOERR)
+        error = LrIncParse(incParser, symIdArr, tokenArr, len);
+    if (error != -ENOERR) {
+        printf("initial parse of %s fail: %d\n", path, error);
+        goto out;
+    }
+
+    for (i = 0; i < editNum; i++) {
+        if (undo)
+            IncTestUndoEdit(&edit);
+        else
+            IncTestRandEdit(incParser, &edit);
+        incError = LrIncEdit(incParser, edit.start, edit.delNum, edit.insArr, edit.insValueArr, edit.insNum);
+        fullError = LrIncParse(fullParser, incParser->symIdArr, incParser->valueArr, incParser->symIdNum);
+        if (incError != fullError
+                || !IncTestNodeEqual(LrIncParserRoot(incParser), LrIncParserRoot(fullParser))) {
+            printf("edit %d mismatch: start %d, delete %d, insert %d, incremental %d, full %d\n",
+                   i, edit.start, edit.delNum, edit.insNum, incError, fullError);
+            error = -EMISC;
+            goto out;
+        }
+        if (incError == -ENOERR) {
+            okNum++;
+            reuseTokenNum += incParser->reuseTokenNum;
+            tokenNum += incParser->reuseTokenNum + incParser->shiftTokenNum;
+            incValueNum += incParser->reduceValueNum;
+            fullValueNum += fullParser->reduceValueNum;
+        }
+        /*撤销失败的编辑，回到可以分析的记号序列*/
+        undo = !undo && incError != -ENOERR;
+    }
+    if (fullValueNum == 0 || incValueNum >= fullValueNum) {
+        printf("no reduce value reused: incremental %lu, full %lu\n", incValueNum, fullValueNum);
+        error = -EMISC;
+        goto out;
+    }
+    printf("%d edits, %d parsed, %.1f%% tokens reused, %.1f%% reduce values reused: pass\n", editNum, okNum,
+           tokenNum ? reuseTokenNum * 100.0 / tokenNum : 0.0, 100.0 - incValueNum * 100.0 / fullValueNum);
+
+out:
+    BisonIncParserFree(fullParser);
+    BisonIncParserFree(incParser);
+    LexFree(lex);
+    free(symIdArr);
+    free(tokenArr);
+    return error == -ENOERR ? 0 : -1;
+}
@@ -0,0 +1,133 @@
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include <unistd.h>
+#include "bison.h"
+#include "gen_code.h"
+#include "virtual_machine.h"
+#include "cpl_errno.h"
+
+/*
+ * 优化器的回归测试，替代main.c和其他源文件一起编译：
+ *      gcc ... tests/opt_test.c -o opt_test
+ *      ./opt_test source.txt...
+ * 回归程序在tests/opt目录下。每个源文件经过完整的编译流程（包括常量传播、值编号、循环不变量外提和常驻寄存器分配），
+ * 在虚拟机中执行，程序的输出和同名的.out文件比较。
+ * 全部相同时返回0，否则输出不同的源文件并返回-1。
+ **/
+
+#define OPT_TEST_OUT_MAX        4096    /*程序输出的最大长度*/
+
+static const char optTestRunBanner[] = "\n------virtual machine run-----------\n";
+static const char optTestEndBanner[] = "\nvirtual machine normal termination.\n";
+
+/*
+ * 功能：读取文件，最多读取size - 1字节，结果以'\0'结尾。
+ * 返回值：读取的长度，打开文件失败时返回-1。
+ **/
+static long OptTestReadFile(const char *path, char *buf, size_t size)
+{
+    FILE *fp;
+    size_t len;
+
+    fp = fopen(path, "rb");
+    if (!fp)
+        return -1;
+    len = fread(buf, 1, size - 1, fp);
+    buf[len] = '\0';
+    fclose(fp);
+    return (long)len;
+}
+
+/*
+ * 功能：编译源文件并在虚拟机中执行，程序的输出去掉虚拟机的开始和结束提示后保存在buf中。
+ *      虚拟机输出到标准输出，执行期间把标准输出重定向到临时文件。
+ * 返回值：成功时返回0，否则返回错误码。
+ **/
+static int OptTestRun(const char *path, char *buf, size_t size)
+{
+    Bison *ctx;
+    GCImage *image = NULL;
+    VMachine *vm;
+    FILE *fp;
+    size_t len, runLen = sizeof (optTestRunBanner) - 1, endLen = sizeof (optTestEndBanner) - 1;
+    int stdoutFd;
+    int error = 0;
+
+    ctx = BisonAlloc();
+    if (!ctx)
+        return -ENOMEM;
+    error = BisonCompile(ctx, path);
+    if (error == -ENOERR)
+        error = GCGenImage(ctx, &image);
+    BisonFree(ctx);
+    if (error != -ENOERR)
+        return error;
+
+    vm = VMAllocMachine();
+    fp = tmpfile();
+    if (!vm || !fp) {
+        error = -ENOMEM;
+        goto out;
+    }
+    fflush(stdout);
+    stdoutFd = dup(STDOUT_FILENO);
+    dup2(fileno(fp), STDOUT_FILENO);
+    VMachineExec(vm, image->insArr, image->insNum);
+    fflush(stdout);
+    dup2(stdoutFd, STDOUT_FILENO);
+    close(stdoutFd);
+
+    rewind(fp);
+    len = fread(buf, 1, size - 1, fp);
+    buf[len] = '\0';
+    if (len < runLen + endLen || memcmp(buf, optTestRunBanner, runLen) != 0
+            || memcmp(buf + len - endLen, optTestEndBanner, endLen) != 0) {
+        error = -EMISC;
+        goto out;
+    }
+    len -= runLen + endLen;
+    memmove(buf, buf + runLen, len);
+    buf[len] = '\0';
+
+out:
+    if (fp)
+        fclose(fp);
+    VMFreeMachine(vm);
+    GCImageFree(image);
+    return error;
+}
+
+int main(int argc, char *argv[])
+{
+    char outPath[1024];
+    char expect[OPT_TEST_OUT_MAX], actual[OPT_TEST_OUT_MAX];
+    const char *dot;
+    int i, failNum = 0;
+    int error = 0;
+
+    if (argc < 2) {
+        printf("usage: %s source.txt...\n", argv[0]);
+        return -1;
+    }
+    for (i = 1; i < argc; i++) {
+        dot = strrchr(argv[i], '.');
+        snprintf(outPath, sizeof (outPath), "%.*s.out",
+                 dot ? (int)(dot - argv[i]) : (int)strlen(argv[i]), argv[i]);
+        if (OptTestReadFile(outPath, expect, sizeof (expect)) < 0) {
+            printf("%s: no %s\n", argv[i], outPath);
+            failNum++;
+            continue;
+        }
+        error = OptTestRun(argv[i], actual, sizeof (actual));
+        if (error != -ENOERR) {
+            printf("%s: run fail: %d\n", argv[i], error);
+            failNum++;
+        } else if (strcmp(expect, actual) != 0) {
+            printf("%s: mismatch\nexpect:\n%s\nactual:\n%s\n", argv[i], expect, actual);
+            failNum++;
+        }
+    }
+    printf("%d programs, %d failed: %s\n", argc - 1, failNum, failNum ? "fail" : "pass");
+    return failNum ? -1 : 0;
+}